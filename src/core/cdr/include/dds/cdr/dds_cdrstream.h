@@ -109,6 +109,22 @@ typedef struct dds_cdrstream_desc_op_seq {
   uint32_t *ops;    /* Marshalling meta data */
 } dds_cdrstream_desc_op_seq_t;
 
+/* Type-specialised (de)serializers generated by idlc ("-f gen-serializers"). These
+   are only generated for types where the result is guaranteed to be identical to that
+   of interpreting the ops, and they operate on the native byte order only. The
+   functions have the same semantics as the corresponding interpreter functions:
+   - write: dds_stream_write_sample for the native byte order
+   - read: dds_stream_read_sample
+   - normalize: normalizing the data (not the key) in dds_stream_normalize, with
+     *off the offset in data (updated to the end of the sample)
+   - extract_key_from_data: dds_stream_extract_key_from_data, may be NULL */
+struct dds_cdrstream_gen_ops {
+  bool (*write) (dds_ostream_t *os, const struct dds_cdrstream_allocator *allocator, const void *sample);
+  void (*read) (dds_istream_t *is, void *sample, const struct dds_cdrstream_allocator *allocator);
+  bool (*normalize) (char *data, uint32_t *off, uint32_t size, bool bswap, uint32_t xcdr_version);
+  bool (*extract_key_from_data) (dds_istream_t *is, dds_ostream_t *os, const struct dds_cdrstream_allocator *allocator);
+};
+
 struct dds_cdrstream_desc {
   uint32_t size;    /* Size of type */
   uint32_t align;   /* Alignment of top-level type */
@@ -117,6 +133,7 @@ struct dds_cdrstream_desc {
   dds_cdrstream_desc_op_seq_t ops;
   size_t opt_size_xcdr1;
   size_t opt_size_xcdr2;
+  const struct dds_cdrstream_gen_ops *gen_ops; /* Generated serializers, NULL if not available */
 };
 
 
@@ -210,6 +227,9 @@ DDS_EXPORT void dds_stream_free_sample (void *data, const struct dds_cdrstream_a
 /** @component cdr_serializer */
 DDS_EXPORT uint32_t dds_stream_countops (const uint32_t *ops, uint32_t nkeys, const dds_key_descriptor_t *keys);
 
+/** @component cdr_serializer */
+const uint32_t *dds_stream_skip_adr (uint32_t insn, const uint32_t *ops);
+
 /** @component cdr_serializer */
 size_t dds_stream_check_optimize (const struct dds_cdrstream_desc *desc, uint32_t xcdr_version);
 
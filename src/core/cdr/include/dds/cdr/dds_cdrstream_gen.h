@@ -0,0 +1,422 @@
+// Copyright(c) 2025 ZettaScale Technology and others
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License v. 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Eclipse Distribution License
+// v. 1.0 which is available at
+// http://www.eclipse.org/org/documents/edl-v10.php.
+//
+// SPDX-License-Identifier: EPL-2.0 OR BSD-3-Clause
+
+#ifndef DDS_CDRSTREAM_GEN_H
+#define DDS_CDRSTREAM_GEN_H
+
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "dds/ddsrt/attributes.h"
+#include "dds/ddsrt/bswap.h"
+#include "dds/cdr/dds_cdrstream.h"
+
+#if defined (__cplusplus)
+extern "C" {
+#endif
+
+/* Building blocks for the type-specialised serializers generated by idlc when invoked
+   with "-f gen-serializers". They exactly mirror what the ops interpreter in
+   dds_cdrstream.c does for final types in the native byte order, including the
+   handling of sequence buffers and strings when reading into an existing sample.
+
+   These are not intended to be used for anything but generated code: there is no
+   compatibility guarantee beyond that of the topic descriptor itself. */
+
+static inline uint32_t dds_cdrstream_gen_align (uint32_t xcdr_version, uint32_t size)
+{
+  return (size > 4) ? ((xcdr_version == DDSI_RTPS_CDR_ENC_VERSION_2) ? 4 : 8) : size;
+}
+
+/*******************************************************************************************
+ **
+ **  Writing
+ **
+ *******************************************************************************************/
+
+static inline void dds_cdrstream_gen_os_align (dds_ostream_t *os, const struct dds_cdrstream_allocator *allocator, uint32_t align, uint32_t extra)
+{
+  const uint32_t pad = (align - (os->m_index % align)) % align;
+  const uint32_t needed = os->m_index + pad + extra;
+  if (needed > os->m_size)
+  {
+    const uint32_t new_size = (needed & ~(uint32_t) 0xfff) + 0x1000;
+    os->m_buffer = allocator->realloc (os->m_buffer, new_size);
+    os->m_size = new_size;
+  }
+  for (uint32_t i = 0; i < pad; i++)
+    os->m_buffer[os->m_index++] = 0;
+}
+
+/* Writes a primitive of size 1, 2, 4 or 8 from memory, the in-memory representation in
+   the native byte order is the CDR representation */
+static inline void dds_cdrstream_gen_put_prim (dds_ostream_t *os, const struct dds_cdrstream_allocator *allocator, const void *src, uint32_t size)
+{
+  dds_cdrstream_gen_os_align (os, allocator, dds_cdrstream_gen_align (os->m_xcdr_version, size), size);
+  memcpy (os->m_buffer + os->m_index, src, size);
+  os->m_index += size;
+}
+
+static inline void dds_cdrstream_gen_put1 (dds_ostream_t *os, const struct dds_cdrstream_allocator *allocator, uint8_t v)
+{
+  dds_cdrstream_gen_put_prim (os, allocator, &v, 1);
+}
+
+static inline void dds_cdrstream_gen_put2 (dds_ostream_t *os, const struct dds_cdrstream_allocator *allocator, uint16_t v)
+{
+  dds_cdrstream_gen_put_prim (os, allocator, &v, 2);
+}
+
+static inline void dds_cdrstream_gen_put4 (dds_ostream_t *os, const struct dds_cdrstream_allocator *allocator, uint32_t v)
+{
+  dds_cdrstream_gen_put_prim (os, allocator, &v, 4);
+}
+
+static inline void dds_cdrstream_gen_put_prim_array (dds_ostream_t *os, const struct dds_cdrstream_allocator *allocator, const void *src, uint32_t num, uint32_t elem_size)
+{
+  const uint32_t sz = num * elem_size;
+  dds_cdrstream_gen_os_align (os, allocator, dds_cdrstream_gen_align (os->m_xcdr_version, elem_size), sz);
+  memcpy (os->m_buffer + os->m_index, src, sz);
+  os->m_index += sz;
+}
+
+static inline void dds_cdrstream_gen_put_bool_array (dds_ostream_t *os, const struct dds_cdrstream_allocator *allocator, const bool *src, uint32_t num)
+{
+  dds_cdrstream_gen_os_align (os, allocator, 1, num);
+  for (uint32_t i = 0; i < num; i++)
+    os->m_buffer[os->m_index++] = (src[i] != 0);
+}
+
+ddsrt_attribute_warn_unused_result
+static inline bool dds_cdrstream_gen_put_enum (dds_ostream_t *os, const struct dds_cdrstream_allocator *allocator, uint32_t val, uint32_t enum_sz, uint32_t max)
+{
+  if (val > max)
+    return false;
+  switch (enum_sz)
+  {
+    case 1: dds_cdrstream_gen_put1 (os, allocator, (uint8_t) val); break;
+    case 2: dds_cdrstream_gen_put2 (os, allocator, (uint16_t) val); break;
+    default: dds_cdrstream_gen_put4 (os, allocator, val); break;
+  }
+  return true;
+}
+
+static inline void dds_cdrstream_gen_put_string (dds_ostream_t *os, const struct dds_cdrstream_allocator *allocator, const char *val)
+{
+  const uint32_t sz = val ? (uint32_t) strlen (val) + 1 : 1;
+  dds_cdrstream_gen_os_align (os, allocator, 4, 4 + sz);
+  memcpy (os->m_buffer + os->m_index, &sz, 4);
+  os->m_index += 4;
+  if (val)
+    memcpy (os->m_buffer + os->m_index, val, sz);
+  else
+    os->m_buffer[os->m_index] = 0;
+  os->m_index += sz;
+}
+
+/* Reserves space for a DHEADER, returns the offset to pass to dds_cdrstream_gen_dheader_end */
+static inline uint32_t dds_cdrstream_gen_dheader_begin (dds_ostream_t *os, const struct dds_cdrstream_allocator *allocator)
+{
+  dds_cdrstream_gen_os_align (os, allocator, 4, 4);
+  os->m_index += 4;
+  return os->m_index;
+}
+
+static inline void dds_cdrstream_gen_dheader_end (dds_ostream_t *os, uint32_t offs)
+{
+  const uint32_t sz = os->m_index - offs;
+  memcpy (os->m_buffer + offs - 4, &sz, 4);
+}
+
+/*******************************************************************************************
+ **
+ **  Reading (input has been normalized)
+ **
+ *******************************************************************************************/
+
+static inline void dds_cdrstream_gen_is_align (dds_istream_t *is, uint32_t align)
+{
+  is->m_index = (is->m_index + align - 1) & ~(align - 1);
+}
+
+static inline void dds_cdrstream_gen_get_prim (dds_istream_t *is, void *dst, uint32_t size)
+{
+  dds_cdrstream_gen_is_align (is, dds_cdrstream_gen_align (is->m_xcdr_version, size));
+  memcpy (dst, is->m_buffer + is->m_index, size);
+  is->m_index += size;
+}
+
+static inline uint8_t dds_cdrstream_gen_get1 (dds_istream_t *is)
+{
+  return is->m_buffer[is->m_index++];
+}
+
+static inline uint16_t dds_cdrstream_gen_get2 (dds_istream_t *is)
+{
+  uint16_t v;
+  dds_cdrstream_gen_get_prim (is, &v, 2);
+  return v;
+}
+
+static inline uint32_t dds_cdrstream_gen_get4 (dds_istream_t *is)
+{
+  uint32_t v;
+  dds_cdrstream_gen_get_prim (is, &v, 4);
+  return v;
+}
+
+static inline void dds_cdrstream_gen_get_prim_array (dds_istream_t *is, void *dst, uint32_t num, uint32_t elem_size)
+{
+  dds_cdrstream_gen_is_align (is, dds_cdrstream_gen_align (is->m_xcdr_version, elem_size));
+  memcpy (dst, is->m_buffer + is->m_index, num * elem_size);
+  is->m_index += num * elem_size;
+}
+
+static inline uint32_t dds_cdrstream_gen_get_enum (dds_istream_t *is, uint32_t enum_sz)
+{
+  switch (enum_sz)
+  {
+    case 1: return dds_cdrstream_gen_get1 (is);
+    case 2: return dds_cdrstream_gen_get2 (is);
+    default: return dds_cdrstream_gen_get4 (is);
+  }
+}
+
+static inline void dds_cdrstream_gen_get_enum_array (dds_istream_t *is, uint32_t *dst, uint32_t num, uint32_t enum_sz)
+{
+  if (enum_sz == 4)
+    dds_cdrstream_gen_get_prim_array (is, dst, num, 4);
+  else
+  {
+    for (uint32_t i = 0; i < num; i++)
+      dst[i] = dds_cdrstream_gen_get_enum (is, enum_sz);
+  }
+}
+
+static inline char *dds_cdrstream_gen_get_string (dds_istream_t *is, char *str, const struct dds_cdrstream_allocator *allocator)
+{
+  const uint32_t length = dds_cdrstream_gen_get4 (is);
+  const void *src = is->m_buffer + is->m_index;
+  is->m_index += length;
+  if (str != NULL)
+  {
+    if (length == 1 && str[0] == '\0')
+      return str;
+    allocator->free (str);
+  }
+  str = allocator->malloc (length);
+  memcpy (str, src, length);
+  return str;
+}
+
+static inline void dds_cdrstream_gen_get_string_bound (dds_istream_t *is, char *str, uint32_t size)
+{
+  const uint32_t length = dds_cdrstream_gen_get4 (is);
+  memcpy (str, is->m_buffer + is->m_index, length > size ? size : length);
+  if (length > size)
+    str[size - 1] = '\0';
+  is->m_index += length;
+}
+
+static inline void dds_cdrstream_gen_skip_string (dds_istream_t *is)
+{
+  const uint32_t length = dds_cdrstream_gen_get4 (is);
+  is->m_index += length;
+}
+
+/* Prepares a sequence for receiving num > 0 elements: takes ownership of the buffer if
+   it needs to be (re)allocated, optionally zero-initializing the new elements. Returns
+   the number of elements that fit, the remainder must be skipped. */
+static inline uint32_t dds_cdrstream_gen_seq_adjust (void *vseq, const struct dds_cdrstream_allocator *allocator, uint32_t num, uint32_t elem_size, bool initialize)
+{
+  dds_sequence_t * const seq = vseq;
+  if (seq->_length > seq->_maximum)
+    seq->_maximum = seq->_length;
+  if (num > seq->_maximum && (seq->_release || seq->_maximum == 0))
+  {
+    if (initialize)
+    {
+      const uint32_t off = seq->_maximum * elem_size;
+      seq->_buffer = allocator->realloc (seq->_buffer, num * elem_size);
+      memset (seq->_buffer + off, 0, num * elem_size - off);
+    }
+    else
+    {
+      allocator->free (seq->_buffer);
+      seq->_buffer = allocator->malloc (num * elem_size);
+    }
+    seq->_release = true;
+    seq->_maximum = num;
+  }
+  seq->_length = (num <= seq->_maximum) ? num : seq->_maximum;
+  return seq->_length;
+}
+
+/*******************************************************************************************
+ **
+ **  Normalization (validation + byte swapping in-place)
+ **
+ *******************************************************************************************/
+
+static inline bool dds_cdrstream_gen_norm_align (uint32_t *off, uint32_t size, uint32_t align, uint32_t elem_size, uint32_t num)
+{
+  const uint32_t off1 = (*off + align - 1) & ~(align - 1);
+  if (size < off1 || (size - off1) / elem_size < num)
+    return false;
+  *off = off1;
+  return true;
+}
+
+ddsrt_attribute_warn_unused_result
+static inline bool dds_cdrstream_gen_norm_prim_array (char *data, uint32_t *off, uint32_t size, bool bswap, uint32_t num, uint32_t elem_size, uint32_t xcdr_version)
+{
+  if (!dds_cdrstream_gen_norm_align (off, size, dds_cdrstream_gen_align (xcdr_version, elem_size), elem_size, num))
+    return false;
+  if (bswap)
+  {
+    switch (elem_size)
+    {
+      case 2: {
+        uint16_t *xs = (uint16_t *) (data + *off);
+        for (uint32_t i = 0; i < num; i++)
+          xs[i] = ddsrt_bswap2u (xs[i]);
+        break;
+      }
+      case 4: {
+        uint32_t *xs = (uint32_t *) (data + *off);
+        for (uint32_t i = 0; i < num; i++)
+          xs[i] = ddsrt_bswap4u (xs[i]);
+        break;
+      }
+      case 8: {
+        // 64-bit values in XCDR2 are only 4-byte aligned
+        uint32_t *xs = (uint32_t *) (data + *off);
+        for (uint32_t i = 0; i < num; i++)
+        {
+          const uint32_t a = ddsrt_bswap4u (xs[2*i]);
+          xs[2*i] = ddsrt_bswap4u (xs[2*i+1]);
+          xs[2*i+1] = a;
+        }
+        break;
+      }
+    }
+  }
+  *off += num * elem_size;
+  return true;
+}
+
+ddsrt_attribute_warn_unused_result
+static inline bool dds_cdrstream_gen_norm_prim (char *data, uint32_t *off, uint32_t size, bool bswap, uint32_t elem_size, uint32_t xcdr_version)
+{
+  return dds_cdrstream_gen_norm_prim_array (data, off, size, bswap, 1, elem_size, xcdr_version);
+}
+
+ddsrt_attribute_warn_unused_result
+static inline bool dds_cdrstream_gen_read_norm4 (uint32_t *val, char *data, uint32_t *off, uint32_t size, bool bswap)
+{
+  if (!dds_cdrstream_gen_norm_prim (data, off, size, bswap, 4, DDSI_RTPS_CDR_ENC_VERSION_2))
+    return false;
+  memcpy (val, data + *off - 4, 4);
+  return true;
+}
+
+/* Booleans are normalized to 0/1, except in sequences where the interpreter validates
+   them as if it were an enum with 2 values */
+ddsrt_attribute_warn_unused_result
+static inline bool dds_cdrstream_gen_norm_bool_array (char *data, uint32_t *off, uint32_t size, uint32_t num)
+{
+  if (size - *off < num)
+    return false;
+  uint8_t * const xs = (uint8_t *) (data + *off);
+  for (uint32_t i = 0; i < num; i++)
+    if (xs[i] > 1)
+      xs[i] = 1;
+  *off += num;
+  return true;
+}
+
+ddsrt_attribute_warn_unused_result
+static inline bool dds_cdrstream_gen_norm_enum_array (char *data, uint32_t *off, uint32_t size, bool bswap, uint32_t num, uint32_t enum_sz, uint32_t max)
+{
+  if (!dds_cdrstream_gen_norm_prim_array (data, off, size, bswap, num, enum_sz, DDSI_RTPS_CDR_ENC_VERSION_2))
+    return false;
+  const char *p = data + *off - num * enum_sz;
+  for (uint32_t i = 0; i < num; i++)
+  {
+    uint32_t v;
+    switch (enum_sz)
+    {
+      case 1: v = ((const uint8_t *) p)[i]; break;
+      case 2: v = ((const uint16_t *) p)[i]; break;
+      default: v = ((const uint32_t *) p)[i]; break;
+    }
+    if (v > max)
+      return false;
+  }
+  return true;
+}
+
+ddsrt_attribute_warn_unused_result
+static inline bool dds_cdrstream_gen_norm_enum (char *data, uint32_t *off, uint32_t size, bool bswap, uint32_t enum_sz, uint32_t max)
+{
+  return dds_cdrstream_gen_norm_enum_array (data, off, size, bswap, 1, enum_sz, max);
+}
+
+/* maxsz includes the terminating 0, SIZE_MAX for unbounded strings */
+ddsrt_attribute_warn_unused_result
+static inline bool dds_cdrstream_gen_norm_string (char *data, uint32_t *off, uint32_t size, bool bswap, size_t maxsz)
+{
+  uint32_t sz;
+  if (!dds_cdrstream_gen_read_norm4 (&sz, data, off, size, bswap))
+    return false;
+  if (sz == 0 || size - *off < sz || maxsz < sz)
+    return false;
+  if (data[*off + sz - 1] != 0)
+    return false;
+  *off += sz;
+  return true;
+}
+
+/* Reads the DHEADER of a collection and sets *size1 to the end of the collection */
+ddsrt_attribute_warn_unused_result
+static inline bool dds_cdrstream_gen_norm_dheader (uint32_t *size1, char *data, uint32_t *off, uint32_t size, bool bswap)
+{
+  if (!dds_cdrstream_gen_read_norm4 (size1, data, off, size, bswap))
+    return false;
+  if (*size1 > size - *off)
+    return false;
+  *size1 += *off;
+  return true;
+}
+
+/* Copies a primitive value from the input stream to the (key) output stream */
+static inline void dds_cdrstream_gen_copy_prim (dds_istream_t *is, dds_ostream_t *os, const struct dds_cdrstream_allocator *allocator, uint32_t size)
+{
+  dds_cdrstream_gen_is_align (is, dds_cdrstream_gen_align (is->m_xcdr_version, size));
+  dds_cdrstream_gen_put_prim (os, allocator, is->m_buffer + is->m_index, size);
+  is->m_index += size;
+}
+
+/* Copies a string from the input stream to the (key) output stream */
+static inline void dds_cdrstream_gen_copy_string (dds_istream_t *is, dds_ostream_t *os, const struct dds_cdrstream_allocator *allocator)
+{
+  const uint32_t sz = dds_cdrstream_gen_get4 (is);
+  dds_cdrstream_gen_put4 (os, allocator, sz);
+  dds_cdrstream_gen_os_align (os, allocator, 1, sz);
+  memcpy (os->m_buffer + os->m_index, is->m_buffer + is->m_index, sz);
+  os->m_index += sz;
+  is->m_index += sz;
+}
+
+#if defined (__cplusplus)
+}
+#endif
+
+#endif /* DDS_CDRSTREAM_GEN_H */
@@ -96,6 +96,7 @@ typedef struct restrict_ostreamLE {
 #define dds_os_put8BO                                 NAME_BYTE_ORDER(dds_os_put8)
 #define dds_os_reserve4BO                             NAME_BYTE_ORDER(dds_os_reserve4)
 #define dds_os_reserve8BO                             NAME_BYTE_ORDER(dds_os_reserve8)
+#define dds_os_put_prims_alignedBO                    NAME_BYTE_ORDER(dds_os_put_prims_aligned)
 #define dds_ostreamBO_fini                            NAME2_BYTE_ORDER(dds_ostream, _fini)
 #define dds_stream_write_stringBO                     NAME_BYTE_ORDER(dds_stream_write_string)
 #define dds_stream_write_wstringBO                    NAME_BYTE_ORDER(dds_stream_write_wstring)
@@ -120,7 +121,6 @@ typedef struct restrict_ostreamLE {
 #define dds_stream_write_keyBO                        NAME_BYTE_ORDER(dds_stream_write_key)
 #define dds_stream_write_keyBO_restrict               NAME2_BYTE_ORDER(dds_stream_write_key, _restrict)
 #define dds_stream_write_keyBO_impl                   NAME2_BYTE_ORDER(dds_stream_write_key, _impl)
-#define dds_stream_to_BO_insitu                       NAME2_BYTE_ORDER(dds_stream_to_, _insitu)
 #define dds_stream_extract_keyBO_from_data_restrict   NAME2_BYTE_ORDER(dds_stream_extract_key, _from_data_restrict)
 #define dds_stream_extract_keyBO_from_data            NAME2_BYTE_ORDER(dds_stream_extract_key, _from_data)
 #define dds_stream_extract_keyBO_from_data1           NAME2_BYTE_ORDER(dds_stream_extract_key, _from_data1)
@@ -170,7 +170,6 @@ struct dds_cdrstream_ops_info {
   dds_data_type_properties_t data_types;
 };
 
-static const uint32_t *dds_stream_skip_adr (uint32_t insn, const uint32_t *ops);
 static const uint32_t *dds_stream_skip_default (char * restrict data, const struct dds_cdrstream_allocator *allocator, const uint32_t *ops, enum sample_data_state sample_state);
 static const uint32_t *dds_stream_extract_key_from_data1 (dds_istream_t *is, restrict_ostream_t *os, const struct dds_cdrstream_allocator *allocator,
   const uint32_t * const op0, const uint32_t *ops, bool mutable_member, bool mutable_member_or_parent,
@@ -433,38 +432,7 @@ static uint32_t dds_os_reserve8BE (restrict_ostreamBE_t *os, const struct dds_cd
 static void dds_stream_swap (void *vbuf, uint32_t size, uint32_t num)
 {
   assert (size == 1 || size == 2 || size == 4 || size == 8);
-  switch (size)
-  {
-    case 1:
-      break;
-    case 2: {
-      uint16_t *buf = vbuf;
-      for (uint32_t i = 0; i < num; i++)
-        buf[i] = ddsrt_bswap2u (buf[i]);
-      break;
-    }
-    case 4: {
-      uint32_t *buf = vbuf;
-      for (uint32_t i = 0; i < num; i++)
-        buf[i] = ddsrt_bswap4u (buf[i]);
-      break;
-    }
-    case 8: {
-      uint32_t *buf = vbuf;
-      // max size of sample is 4GB or thereabouts, so a 64-bit int or double
-      // array or sequence can never have more than 0.5G elements
-      //
-      // need to byte-swap using 32-bit elements because of XCDR2 droping the
-      // natural alignment requirement
-      for (uint32_t i = 0; i < num; i++) {
-        uint32_t a = ddsrt_bswap4u (buf[2*i]);
-        uint32_t b = ddsrt_bswap4u (buf[2*i+1]);
-        buf[2*i] = b;
-        buf[2*i+1] = a;
-      }
-      break;
-    }
-  }
+  ddsrt_bswap_array (vbuf, size, num);
 }
 
 static void dds_os_put_bytes_base (restrict_ostream_base_t *os, const struct dds_cdrstream_allocator *allocator, const void *b, uint32_t l)
@@ -474,16 +442,21 @@ static void dds_os_put_bytes_base (restrict_ostream_base_t *os, const struct dds
   os->m_index += l;
 }
 
-static void dds_os_put_bytes_aligned_base (restrict_ostream_base_t *os, const struct dds_cdrstream_allocator *allocator, const void *data, uint32_t num, uint32_t elem_sz, align_t cdr_align, void **dst)
+static void dds_os_put_prims_aligned_base (restrict_ostream_base_t *os, const struct dds_cdrstream_allocator *allocator, const void *data, uint32_t num, uint32_t elem_sz, align_t cdr_align, bool bswap)
 {
   const uint32_t sz = num * elem_sz;
   dds_cdr_alignto_clear_and_resize_base (os, allocator, cdr_align, sz);
-  if (dst)
-    *dst = os->m_buffer + os->m_index;
-  memcpy (os->m_buffer + os->m_index, data, sz);
+  if (bswap)
+    ddsrt_bswap_array_copy (os->m_buffer + os->m_index, data, elem_sz, num);
+  else
+    memcpy (os->m_buffer + os->m_index, data, sz);
   os->m_index += sz;
 }
 
+static void dds_os_put_prims_aligned (restrict_ostream_t *os, const struct dds_cdrstream_allocator *allocator, const void *data, uint32_t num, uint32_t elem_sz, align_t cdr_align) { dds_os_put_prims_aligned_base (&os->x, allocator, data, num, elem_sz, cdr_align, false); }
+static void dds_os_put_prims_alignedLE (restrict_ostreamLE_t *os, const struct dds_cdrstream_allocator *allocator, const void *data, uint32_t num, uint32_t elem_sz, align_t cdr_align) { dds_os_put_prims_aligned_base (&os->x, allocator, data, num, elem_sz, cdr_align, DDSRT_ENDIAN != DDSRT_LITTLE_ENDIAN); }
+static void dds_os_put_prims_alignedBE (restrict_ostreamBE_t *os, const struct dds_cdrstream_allocator *allocator, const void *data, uint32_t num, uint32_t elem_sz, align_t cdr_align) { dds_os_put_prims_aligned_base (&os->x, allocator, data, num, elem_sz, cdr_align, DDSRT_ENDIAN == DDSRT_LITTLE_ENDIAN); }
+
 static inline bool is_primitive_type (enum dds_stream_typecode type)
 {
   return type <= DDS_OP_VAL_8BY || type == DDS_OP_VAL_BLN || type == DDS_OP_VAL_WCHAR;
@@ -1617,32 +1590,6 @@ static bool is_member_present (const char *data, const uint32_t *ops)
   return false;
 }
 
-#if DDSRT_ENDIAN == DDSRT_LITTLE_ENDIAN
-static inline void dds_stream_to_BE_insitu (void *vbuf, uint32_t size, uint32_t num)
-{
-  dds_stream_swap (vbuf, size, num);
-}
-static inline void dds_stream_to_LE_insitu (void *vbuf, uint32_t size, uint32_t num)
-{
-  (void) vbuf;
-  (void) size;
-  (void) num;
-}
-#define dds_stream_to__insitu dds_stream_to_LE_insitu
-#else /* if DDSRT_ENDIAN == DDSRT_LITTLE_ENDIAN */
-static inline void dds_stream_to_BE_insitu (void *vbuf, uint32_t size, uint32_t num)
-{
-  (void) vbuf;
-  (void) size;
-  (void) num;
-}
-static inline void dds_stream_to_LE_insitu (void *vbuf, uint32_t size, uint32_t num)
-{
-  dds_stream_swap (vbuf, size, num);
-}
-#define dds_stream_to__insitu dds_stream_to_BE_insitu
-#endif /* if DDSRT_ENDIAN == DDSRT_LITTLE_ENDIAN */
-
 // Little-endian
 #define NAME_BYTE_ORDER_EXT LE
 #include "dds_cdrstream_write.part.h"
@@ -1687,6 +1634,8 @@ bool dds_stream_write_sampleLE (dds_ostreamLE_t *os, const struct dds_cdrstream_
   if (opt_size && desc->align && (os->x.m_index % desc->align) == 0) {
     dds_os_put_bytes_base ((restrict_ostream_base_t *) &os->x, allocator, data, (uint32_t) opt_size);
     res = true;
+  } else if (desc->gen_ops) {
+    res = desc->gen_ops->write (&os->x, allocator, data);
   } else {
     res = dds_stream_writeLE (os, allocator, data, desc->ops.ops) != NULL;
   }
@@ -1728,6 +1677,8 @@ bool dds_stream_write_sampleBE (dds_ostreamBE_t *os, const struct dds_cdrstream_
   if (opt_size && desc->align && (os->x.m_index % desc->align) == 0) {
     dds_os_put_bytes_base ((restrict_ostream_base_t *) &os->x, allocator, data, (uint32_t) opt_size);
     res = true;
+  } else if (desc->gen_ops) {
+    res = desc->gen_ops->write (&os->x, allocator, data);
   } else {
     res = dds_stream_writeBE (os, allocator, data, desc->ops.ops) != NULL;
   }
@@ -2793,7 +2744,7 @@ static inline const uint32_t *dds_stream_read_adr (uint32_t insn, dds_istream_t
   return ops;
 }
 
-static const uint32_t *dds_stream_skip_adr (uint32_t insn, const uint32_t *ops)
+const uint32_t *dds_stream_skip_adr (uint32_t insn, const uint32_t *ops)
 {
   switch (DDS_OP_TYPE (insn))
   {
@@ -3532,8 +3483,10 @@ static bool normalize_enumarray (char * restrict data, uint32_t * restrict off,
       if ((*off = check_align_prim_many (*off, size, 1, 1, num)) == UINT32_MAX)
         return false;
       uint16_t * const xs = (uint16_t *) (data + *off);
+      if (bswap)
+        dds_stream_swap (xs, 2, num);
       for (uint32_t i = 0; i < num; i++)
-        if ((uint16_t) (bswap ? (xs[i] = ddsrt_bswap2u (xs[i])) : xs[i]) > max)
+        if (xs[i] > max)
           return normalize_error_bool ();
       *off += 2 * num;
       break;
@@ -3542,8 +3495,10 @@ static bool normalize_enumarray (char * restrict data, uint32_t * restrict off,
       if ((*off = check_align_prim_many (*off, size, 2, 2, num)) == UINT32_MAX)
         return false;
       uint32_t * const xs = (uint32_t *) (data + *off);
+      if (bswap)
+        dds_stream_swap (xs, 4, num);
       for (uint32_t i = 0; i < num; i++)
-        if ((uint32_t) (bswap ? (xs[i] = ddsrt_bswap4u (xs[i])) : xs[i]) > max)
+        if (xs[i] > max)
           return normalize_error_bool ();
       *off += 4 * num;
       break;
@@ -3573,8 +3528,10 @@ static bool normalize_bitmaskarray (char * restrict data, uint32_t * restrict of
       if ((*off = check_align_prim_many (*off, size, 1, 1, num)) == UINT32_MAX)
         return false;
       uint16_t * const xs = (uint16_t *) (data + *off);
+      if (bswap)
+        dds_stream_swap (xs, 2, num);
       for (uint32_t i = 0; i < num; i++)
-        if (!bitmask_value_valid (bswap ? (xs[i] = ddsrt_bswap2u (xs[i])) : xs[i], bits_h, bits_l))
+        if (!bitmask_value_valid (xs[i], bits_h, bits_l))
           return normalize_error_bool ();
       *off += 2 * num;
       break;
@@ -3583,8 +3540,10 @@ static bool normalize_bitmaskarray (char * restrict data, uint32_t * restrict of
       if ((*off = check_align_prim_many (*off, size, 2, 2, num)) == UINT32_MAX)
         return false;
       uint32_t * const xs = (uint32_t *) (data + *off);
+      if (bswap)
+        dds_stream_swap (xs, 4, num);
       for (uint32_t i = 0; i < num; i++)
-        if (!bitmask_value_valid (bswap ? (xs[i] = ddsrt_bswap4u (xs[i])) : xs[i], bits_h, bits_l))
+        if (!bitmask_value_valid (xs[i], bits_h, bits_l))
           return normalize_error_bool ();
       *off += 4 * num;
       break;
@@ -3593,17 +3552,11 @@ static bool normalize_bitmaskarray (char * restrict data, uint32_t * restrict of
       if ((*off = check_align_prim_many (*off, size, xcdr_version == DDSI_RTPS_CDR_ENC_VERSION_2 ? 2 : 3, 3, num)) == UINT32_MAX)
         return false;
       uint64_t * const xs = (uint64_t *) (data + *off);
+      if (bswap)
+        dds_stream_swap (xs, 8, num);
       for (uint32_t i = 0; i < num; i++)
-      {
-        if (bswap)
-        {
-          uint32_t x = ddsrt_bswap4u (* (uint32_t *) &xs[i]);
-          *(uint32_t *) &xs[i] = ddsrt_bswap4u (* (((uint32_t *) &xs[i]) + 1));
-          *(((uint32_t *) &xs[i]) + 1) = x;
-        }
         if (!bitmask_value_valid (xs[i], bits_h, bits_l))
           return normalize_error_bool ();
-      }
       *off += 8 * num;
       break;
     }
@@ -4232,6 +4185,13 @@ bool dds_stream_normalize (void *data, uint32_t size, bool bswap, uint32_t xcdr_
     return normalize_error_bool ();
   else if (just_key)
     return stream_normalize_key (data, size, bswap, xcdr_version, desc, actual_size);
+  else if (desc->gen_ops)
+  {
+    if (!desc->gen_ops->normalize (data, &off, size, bswap, xcdr_version))
+      return false;
+    *actual_size = off;
+    return true;
+  }
   else if (!stream_normalize_data_impl (data, &off, size, bswap, xcdr_version, desc->ops.ops, false, CDR_KIND_DATA))
     return false;
   else
@@ -4613,36 +4573,7 @@ static void dds_stream_extract_key_from_key_prim_op (dds_istream_t *is, restrict
 static void dds_stream_swap_copy (void * restrict vdst, const void *vsrc, uint32_t size, uint32_t num)
 {
   assert (size == 1 || size == 2 || size == 4 || size == 8);
-  switch (size)
-  {
-    case 1:
-      memcpy (vdst, vsrc, num);
-      break;
-    case 2: {
-      const uint16_t *src = vsrc;
-      uint16_t *dst = vdst;
-      for (uint32_t i = 0; i < num; i++)
-        dst[i] = ddsrt_bswap2u (src[i]);
-      break;
-    }
-    case 4: {
-      const uint32_t *src = vsrc;
-      uint32_t *dst = vdst;
-      for (uint32_t i = 0; i < num; i++)
-        dst[i] = ddsrt_bswap4u (src[i]);
-      break;
-    }
-    case 8: {
-      const uint64_t *src = vsrc;
-      uint64_t *dst = vdst;
-      for (uint32_t i = 0; i < num; i++)
-      {
-        *(uint32_t *) &dst[i] = ddsrt_bswap4u (* (((uint32_t *) &src[i]) + 1));
-        *(((uint32_t *) &dst[i]) + 1) = ddsrt_bswap4u (* (uint32_t *) &src[i]);
-      }
-      break;
-    }
-  }
+  ddsrt_bswap_array_copy (vdst, vsrc, size, num);
 }
 
 static void dds_stream_extract_keyBE_from_key_prim_op (dds_istream_t *is, restrict_ostreamBE_t *os, const struct dds_cdrstream_allocator *allocator, const uint32_t *ops, uint16_t key_offset_count, const uint32_t * key_offset_insn)
@@ -4872,6 +4803,10 @@ void dds_stream_read_sample (dds_istream_t *is, void *data, const struct dds_cdr
        potential out-of-bounds read */
     dds_is_get_bytes (is, data, (uint32_t) opt_size, 1);
   }
+  else if (desc->gen_ops)
+  {
+    desc->gen_ops->read (is, data, allocator);
+  }
   else
   {
     (void) dds_stream_read_impl (is, data, allocator, desc->ops.ops, false, CDR_KIND_DATA, SAMPLE_DATA_INITIALIZED);
@@ -5003,7 +4938,9 @@ void dds_stream_read_key (dds_istream_t *is, char *sample, const struct dds_cdrs
 
 // Native endianness
 #define NAME_BYTE_ORDER_EXT
+#define NAME_BYTE_ORDER_NATIVE
 #include "dds_cdrstream_keys.part.h"
+#undef NAME_BYTE_ORDER_NATIVE
 #undef NAME_BYTE_ORDER_EXT
 
 #if DDSRT_ENDIAN == DDSRT_LITTLE_ENDIAN
@@ -6189,6 +6126,12 @@ void dds_cdrstream_desc_init (struct dds_cdrstream_desc *desc, const struct dds_
      using the CDR stream serializer */
   desc->flagset = flagset & ~DDS_CDR_CALCULATED_FLAGS;
   desc->flagset |= dds_stream_key_flags (desc, NULL, NULL);
+
+  /* Generated serializers are not a property of the type and they are not part of
+     the arguments taken from the topic descriptor: the caller sets gen_ops when they
+     are available, the flag itself is not retained so it doesn't affect type equality */
+  desc->flagset &= ~DDS_TOPIC_GEN_SERIALIZERS;
+  desc->gen_ops = NULL;
 }
 
 void dds_cdrstream_desc_fini (struct dds_cdrstream_desc *desc, const struct dds_cdrstream_allocator *allocator)
@@ -348,6 +348,13 @@ static bool dds_stream_extract_keyBO_from_data_restrict (dds_istream_t *is, REST
   if (keys_remaining == 0)
     return ret;
 
+#ifdef NAME_BYTE_ORDER_NATIVE
+  /* generated key extraction only exists for final types with all keys in the top-level
+     type, and it only does the native byte order */
+  if (desc->gen_ops && desc->gen_ops->extract_key_from_data)
+    return desc->gen_ops->extract_key_from_data (is, (dds_ostream_t *) &os->x, allocator);
+#endif
+
   if (desc->flagset & (DDS_TOPIC_KEY_APPENDABLE | DDS_TOPIC_KEY_MUTABLE | DDS_TOPIC_KEY_SEQUENCE | DDS_TOPIC_KEY_ARRAY_NONPRIM))
   {
     /* In case the type or any subtype has non-final extensibility, read the sample
@@ -262,13 +262,8 @@ static const uint32_t *dds_stream_write_seqBO (RESTRICT_OSTREAM_T *os, const str
       case DDS_OP_VAL_1BY: case DDS_OP_VAL_2BY: case DDS_OP_VAL_4BY: case DDS_OP_VAL_8BY: {
         const uint32_t elem_size = get_primitive_size (subtype);
         const align_t cdr_align = dds_cdr_get_align (xcdrv, elem_size);
-        void * dst;
-        /* Combining put bytes and swap into a single step would improve the performance
-           of writing data in non-native endianess. But in most cases the data will
-           be written in native endianess, and in that case the swap is a no-op (for writing
-           keys a separate function is used). */
-        dds_os_put_bytes_aligned_base (&os->x, allocator, seq->_buffer, num, elem_size, cdr_align, &dst);
-        dds_stream_to_BO_insitu (dst, elem_size, num);
+        /* Copies and (for non-native endianness) swaps in a single pass */
+        dds_os_put_prims_alignedBO (os, allocator, seq->_buffer, num, elem_size, cdr_align);
         ops += 2 + bound_op;
         break;
       }
@@ -366,10 +361,7 @@ static const uint32_t *dds_stream_write_arrBO (RESTRICT_OSTREAM_T *os, const str
     case DDS_OP_VAL_1BY: case DDS_OP_VAL_2BY: case DDS_OP_VAL_4BY: case DDS_OP_VAL_8BY: {
       const uint32_t elem_size = get_primitive_size (subtype);
       const align_t cdr_align = dds_cdr_get_align (xcdrv, elem_size);
-      void * dst;
-      /* See comment for stream_write_seq, swap is a no-op in most cases */
-      dds_os_put_bytes_aligned_base (&os->x, allocator, addr, num, elem_size, cdr_align, &dst);
-      dds_stream_to_BO_insitu (dst, elem_size, num);
+      dds_os_put_prims_alignedBO (os, allocator, addr, num, elem_size, cdr_align);
       ops += 3;
       break;
     }
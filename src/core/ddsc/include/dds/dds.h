@@ -1736,6 +1736,49 @@ dds_get_topic_filter_extended (
   dds_entity_t topic,
   struct dds_topic_filter *filter);
 
+/**
+ * @anchor dds_set_topic_filter_expression
+ * @brief Sets a DDS SQL filter expression on a topic.
+ * @ingroup topic_filter
+ * @component topic
+ * @warning Unstable API
+ *
+ * The filter expression follows the DDS specification (e.g., "id BETWEEN %0 AND %1
+ * AND name LIKE 'x%'") and is applied in addition to the filter function set using
+ * @ref dds_set_topic_filter_extended. The expression is compiled to a program that
+ * is evaluated on the serialized key of the samples, and so field names can only
+ * refer to key fields (nested key fields using "a.b"), and only for types where
+ * all key fields are in types with final extensibility. Parameters are literals,
+ * strings must be enclosed in single quotes.
+ *
+ * Readers created after the expression has been set advertise it in discovery, so
+ * that remote writers can avoid sending data none of their readers are interested
+ * in.
+ *
+ * Not thread-safe with respect to data being read/written using readers/writers
+ * using this topic.  Be sure to create a topic entity specific to the reader you
+ * want to filter, then set the filter expression, and only then create the reader.
+ *
+ * @param[in]  topic       The topic on which the filter expression is set.
+ * @param[in]  expression  The filter expression, or NULL to remove the expression.
+ * @param[in]  nparams     The number of parameters (at most 100).
+ * @param[in]  params      The parameters, referenced in the expression as %0 .. %99.
+ *
+ * @returns A dds_return_t indicating success or failure.
+ *
+ * @retval DDS_RETCODE_OK  Filter expression set successfully
+ * @retval DDS_RETCODE_BAD_PARAMETER  The topic handle is invalid, the expression or
+ *   one of the parameters is invalid, or it refers to an unknown field
+ * @retval DDS_RETCODE_UNSUPPORTED  The expression refers to fields that can't be
+ *   accessed for this type
+ */
+DDS_EXPORT dds_return_t
+dds_set_topic_filter_expression (
+  dds_entity_t topic,
+  const char *expression,
+  uint32_t nparams,
+  const char * const *params);
+
 /**
  * @defgroup subscriber (Subscriber)
  * @ingroup subscription
@@ -2532,6 +2575,52 @@ dds_write_ts(
   const void *data,
   dds_time_t timestamp);
 
+/**
+ * @brief Write the values of a sequence of data instances
+ * @ingroup writing
+ * @component write_data
+ *
+ * This operation is equivalent to calling dds_write_ts() for each of the samples in
+ * turn, but it amortizes the cost of locking the writer over all samples and packs the
+ * samples into as few network messages as possible, followed by a single heartbeat.
+ * Unless write batching is enabled, the messages are sent before it returns.
+ *
+ * Samples that are rejected by the topic filter are not written, but are considered
+ * successfully written.
+ *
+ * @param[in]  writer The writer entity.
+ * @param[in]  samples Pointers to the values to be written.
+ * @param[in]  n Number of samples.
+ * @param[in]  timestamps Source timestamps (>= 0) for the samples or NULL to use the
+ *                        current time for all samples.
+ * @param[out] results Result for each sample (may be NULL), as would have been returned
+ *                     by dds_write_ts().
+ *
+ * @returns A dds_return_t indicating success or failure.
+ *
+ * @retval DDS_RETCODE_OK
+ *             All samples were written successfully.
+ * @retval DDS_RETCODE_BAD_PARAMETER
+ *             One of the arguments or one of the samples is invalid.
+ * @retval DDS_RETCODE_ILLEGAL_OPERATION
+ *             The operation is invoked on an inappropriate object.
+ * @retval DDS_RETCODE_ALREADY_DELETED
+ *             The entity has already been deleted.
+ * @retval DDS_RETCODE_TIMEOUT
+ *             At least one sample could not be written reliably within the specified
+ *             max_blocking_time.
+ *
+ * If the writer could be accessed, the return value is the first failure of the
+ * individual samples.
+ */
+DDS_EXPORT dds_return_t
+dds_write_batch(
+  dds_entity_t writer,
+  const void * const *samples,
+  uint32_t n,
+  const dds_time_t *timestamps,
+  dds_return_t *results);
+
 /**
  * @defgroup readcondition (ReadCondition)
  * @ingroup condition
@@ -677,6 +677,15 @@ enum dds_stream_typecode_subtype {
  */
 #define DDS_TOPIC_KEY_ARRAY_NONPRIM             (1u << 12)
 
+/**
+ * @anchor DDS_TOPIC_GEN_SERIALIZERS
+ * @ingroup topic_flags
+ * @brief Set if the topic descriptor contains type-specialised serializers
+ * generated by the IDL compiler (m_gen_ops), which are then used instead
+ * of interpreting the marshalling ops.
+ */
+#define DDS_TOPIC_GEN_SERIALIZERS               (1u << 13)
+
 /**
  * @anchor DDS_FIXED_KEY_MAX_SIZE
  * @ingroup topic_flags
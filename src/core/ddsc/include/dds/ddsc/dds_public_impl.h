@@ -145,6 +145,9 @@ struct dds_type_meta_ser
  */
 #define DDS_DATA_REPRESENTATION_RESTRICT_DEFAULT  (DDS_DATA_REPRESENTATION_FLAG_XCDR1 | DDS_DATA_REPRESENTATION_FLAG_XCDR2)
 
+/* Generated (de)serializers, defined in dds/cdr/dds_cdrstream.h */
+struct dds_cdrstream_gen_ops;
+
 /**
  * @brief Topic Descriptor
  * @ingroup topic_definition
@@ -168,6 +171,7 @@ typedef struct dds_topic_descriptor
                                                    only present if flag DDS_TOPIC_XTYPES_METADATA is set */
   const uint32_t restrict_data_representation; /**< restrictions on the data representations allowed for the top-level type for this topic,
                                            only present if flag DDS_TOPIC_RESTRICT_DATA_REPRESENTATION */
+  const struct dds_cdrstream_gen_ops *m_gen_ops; /**< generated type-specific (de)serializers, only present if flag DDS_TOPIC_GEN_SERIALIZERS is set */
 }
 dds_topic_descriptor_t;
 
@@ -39,8 +39,9 @@ struct dds_entity;
  * handle. This will not remove any information within the handleserver, it just prevents
  * new claims. The delete will actually free handleserver internal memory.
  *
- * There's currently a global lock in the handle server that is used with every API call.
- * Maybe the internals can be improved to circumvent the need for that...
+ * Claiming and releasing a handle doesn't require any locks: the handles are stored in a
+ * concurrent hash table and the claims are tracked using atomic operations.  Only creating
+ * and deleting handles, as well as waiting for the claims to be released, use a lock.
  */
 
 
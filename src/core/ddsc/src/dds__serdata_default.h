@@ -14,7 +14,7 @@
 #include "dds/ddsrt/endian.h"
 #include "dds/ddsrt/avl.h"
 #include "dds/ddsi/ddsi_protocol.h"
-#include "dds/ddsi/ddsi_freelist.h"
+#include "dds/ddsi/ddsi_mempool.h"
 #include "dds/ddsi/ddsi_serdata.h"
 #include "dds/ddsi/ddsi_typelib.h"
 #include "dds/cdr/dds_cdrstream.h"
@@ -55,7 +55,7 @@ struct dds_serdata_default_key {
 };
 
 struct dds_serdatapool {
-  struct ddsi_freelist freelist;
+  struct ddsi_mempool *mempool;
 };
 
 /* Debug builds may want to keep some additional state */
@@ -76,8 +76,7 @@ struct dds_serdatapool {
   uint32_t size;                      \
   DDS_SERDATA_DEFAULT_DEBUG_FIELDS    \
   struct dds_serdata_default_key key; \
-  struct dds_serdatapool *serpool;    \
-  struct dds_serdata_default *next /* in pool->freelist */
+  struct dds_serdatapool *serpool
 /* We suppress the zero-array warning (MSVC C4200) here ONLY for MSVC
    and ONLY if it is being compiled as C++ code, as it only causes
    issues there */
@@ -127,7 +126,9 @@ struct dds_sertype_default {
   uint16_t encoding_format; /* DDSI_RTPS_CDR_ENC_FORMAT_(PLAIN|DELIMITED|PL) - CDR encoding format for the top-level type in this sertype */
   uint16_t write_encoding_version; /* DDSI_RTPS_CDR_ENC_VERSION_(1|2) - CDR encoding version used for writing data using this sertype */
   struct dds_serdatapool *serpool;
+  uint32_t serdata_init_size; /* initial size of the CDR buffer for serialising a sample */
   struct dds_cdrstream_desc type;
+  char **key_names; /* names of the key fields in definition order, for content filter expressions */
   struct dds_sertype_default_cdr_data typeinfo_ser;
   struct dds_sertype_default_cdr_data typemap_ser;
 };
@@ -146,6 +147,9 @@ struct dds_serdatapool * dds_serdatapool_new (void);
 /** @component typesupport_c */
 void dds_serdatapool_free (struct dds_serdatapool * pool);
 
+/** @component typesupport_c */
+void dds_serdatapool_reserve (struct dds_serdatapool * pool, uint32_t size, uint32_t n);
+
 /** @component typesupport_c */
 dds_return_t dds_sertype_default_init (const struct dds_domain *domain, struct dds_sertype_default *st, const dds_topic_descriptor_t *desc, uint16_t min_xcdrv, dds_data_representation_id_t data_representation);
 
@@ -0,0 +1,81 @@
+// Copyright(c) 2025 ZettaScale Technology and others
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License v. 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Eclipse Distribution License
+// v. 1.0 which is available at
+// http://www.eclipse.org/org/documents/edl-v10.php.
+//
+// SPDX-License-Identifier: EPL-2.0 OR BSD-3-Clause
+
+#ifndef DDS__SQLFILTER_H
+#define DDS__SQLFILTER_H
+
+#include "dds/ddsi/ddsi_content_filter_if.h"
+#include "dds/ddsi/ddsi_plist.h"
+#include "dds__types.h"
+
+#if defined (__cplusplus)
+extern "C" {
+#endif
+
+/* Filter class name for DDS SQL filter expressions in the ContentFilterProperty */
+#define DDS_SQLFILTER_CLASS_NAME "DDSSQL"
+
+struct dds_sqlfilter;
+
+/* Content filter interface used by writers for evaluating the filter expressions of
+   matched remote readers (see ddsi_content_filter_if.h) */
+extern const struct ddsi_content_filter_interface dds_sqlfilter_interface;
+
+/**
+ * @brief Compile a filter expression for a type
+ * @component sqlfilter
+ *
+ * The expression is compiled into a program that operates directly on the serialized
+ * key and data in the serdata. Field names in the expression can refer to key fields
+ * of types for which the key fields are all in types with final extensibility, and
+ * (if the type information is available) to top-level members of primitive, enum,
+ * bitmask and string types of final and appendable types.
+ *
+ * @param[out] filter       compiled filter
+ * @param[in]  type         type the expression is evaluated on
+ * @param[in]  topic_name   name of the topic, used in the content filter property
+ * @param[in]  expression   filter expression
+ * @param[in]  nparams      number of expression parameters
+ * @param[in]  params       expression parameters (%0 .. %99), each a literal
+ *
+ * @returns a DDS return code
+ * @retval DDS_RETCODE_OK             filter compiled successfully
+ * @retval DDS_RETCODE_BAD_PARAMETER  syntax error, unknown field or type mismatch
+ * @retval DDS_RETCODE_UNSUPPORTED    expression refers to fields that can't be accessed,
+ *                                    or to members while there is no type information
+ */
+dds_return_t dds_sqlfilter_new (struct dds_sqlfilter **filter, const struct ddsi_sertype *type, const char *topic_name, const char *expression, uint32_t nparams, const char * const *params);
+
+/** @component sqlfilter */
+void dds_sqlfilter_free (struct dds_sqlfilter *filter);
+
+/**
+ * @brief Evaluate a compiled filter on a sample
+ * @component sqlfilter
+ *
+ * @param[in] filter   compiled filter
+ * @param[in] serdata  sample, must be of the type the filter was compiled for
+ *
+ * @returns true iff the sample passes the filter; samples without data and samples
+ *   in raw PSMX loans for a filter on members always pass, samples with a malformed
+ *   key or data or in which a referenced optional member is absent never do
+ */
+bool dds_sqlfilter_accepts (const struct dds_sqlfilter *filter, const struct ddsi_serdata *serdata);
+
+/**
+ * @brief The content filter property to advertise in discovery for readers using the filter
+ * @component sqlfilter
+ */
+const struct ddsi_content_filter_property *dds_sqlfilter_property (const struct dds_sqlfilter *filter);
+
+#if defined (__cplusplus)
+}
+#endif
+#endif /* DDS__SQLFILTER_H */
@@ -44,6 +44,7 @@ struct dds_readcond;
 struct dds_guardcond;
 struct dds_statuscond;
 struct dds_loan_pool;
+struct dds_sqlfilter;
 
 struct ddsi_sertype;
 struct ddsi_rhc;
@@ -439,6 +440,7 @@ typedef struct dds_topic {
   struct ddsi_sertype *m_stype;
   struct dds_ktopic *m_ktopic; /* refc'd, constant */
   struct dds_topic_filter m_filter;
+  struct dds_sqlfilter *m_sqlfilter; /* filter expression, also advertised for readers */
   dds_inconsistent_topic_status_t m_inconsistent_topic_status; /* Status metrics */
 } dds_topic;
 
@@ -0,0 +1,40 @@
+// Copyright(c) 2025 ZettaScale Technology and others
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License v. 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Eclipse Distribution License
+// v. 1.0 which is available at
+// http://www.eclipse.org/org/documents/edl-v10.php.
+//
+// SPDX-License-Identifier: EPL-2.0 OR BSD-3-Clause
+
+#ifndef DDS__WHC_RING_H
+#define DDS__WHC_RING_H
+
+#include "dds/ddsi/ddsi_whc.h"
+
+#if defined (__cplusplus)
+extern "C" {
+#endif
+
+struct ddsi_domaingv;
+
+/**
+ * @brief Creates a WHC that stores the samples in a ring indexed by sequence number
+ * @component whc
+ *
+ * This is only suitable for volatile writers of topics without a key and without
+ * a deadline: it does not maintain an instance index and so can't provide
+ * transient-local data nor keep per-instance histories.
+ *
+ * @param[in] gv      domain
+ * @param[in] hdepth  history depth, 0 for KEEP_ALL
+ * @returns a new WHC
+ */
+struct ddsi_whc *dds_whc_ring_new (struct ddsi_domaingv *gv, uint32_t hdepth);
+
+#if defined (__cplusplus)
+}
+#endif
+
+#endif /* DDS__WHC_RING_H */
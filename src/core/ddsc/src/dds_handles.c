@@ -15,6 +15,7 @@
 #include "dds/ddsrt/heap.h"
 #include "dds/ddsrt/random.h"
 #include "dds/ddsrt/hopscotch.h"
+#include "dds/ddsrt/threads.h"
 #include "dds/ddsi/ddsi_thread.h"
 #include "dds__handles.h"
 #include "dds__types.h"
@@ -51,14 +52,97 @@ built-in topics:
    reasonable */
 #define MAX_HANDLES (INT32_MAX / 128)
 
+/* Looking up a handle doesn't involve any locks: the table is a concurrent hash table
+   and the pin/unpin operations manipulate the handle's cnt_flags atomically.  That means
+   a lookup may be accessing a handle link (or an old bucket array of the hash table)
+   while it is being removed, and so the memory can't be freed until all lookups that
+   could still be looking at it have completed.
+
+   That is tracked by counting the lookups in progress.  A single counter would be as
+   much of a bottleneck as the lock it replaces, so there are a number of them, each
+   thread using one of them, each in its own cache line.  Once a link has been removed
+   from the table, any lookup that may still reference it is accounted for in one of
+   the counters.
+
+   Waiting for a counter to be zero would never end if lookups keep overlapping, so
+   each counter is split in two, one for each value of a global epoch bit: a lookup
+   counts itself in the current epoch, and waiting for the lookups means switching
+   the epoch and waiting for the counters of the old one to drain.  New lookups don't
+   add to those, so that is guaranteed to happen.  Before switching, the counters of
+   the other epoch must be drained, too, because a lookup may have read the epoch just
+   before the previous switch and incremented the counter after the waiting for it had
+   already finished.  Only lookups that read the epoch before the previous switch can
+   add to those, so that, too, is guaranteed to finish. */
+#define N_LOOKUP_COUNTERS 64
+
+struct dds_handle_lookup_counter {
+  ddsrt_atomic_uint32_t n[2];
+  char pad[64 - 2 * sizeof (ddsrt_atomic_uint32_t)];
+};
+
 struct dds_handle_server {
-  struct ddsrt_hh *ht;
-  size_t count;
-  ddsrt_mutex_t lock;
+  struct ddsrt_chh *ht;
+  size_t count; /* protected by lock */
+  ddsrt_mutex_t lock; /* serializes create/delete, also used for waiting on cond */
   ddsrt_cond_t cond;
+  ddsrt_atomic_uint32_t lookup_counter_seq;
+  ddsrt_atomic_uint32_t lookup_epoch;
+  ddsrt_mutex_t lookup_wait_lock; /* serializes switching the epoch & waiting for lookups */
+  struct dds_handle_lookup_counter lookups[N_LOOKUP_COUNTERS];
 };
 
 static struct dds_handle_server handles;
+static ddsrt_thread_local uint32_t lookup_counter_idx;
+
+static ddsrt_atomic_uint32_t *lookup_begin (void)
+{
+  if (lookup_counter_idx == 0)
+    lookup_counter_idx = ddsrt_atomic_inc32_nv (&handles.lookup_counter_seq);
+  const uint32_t epoch = ddsrt_atomic_ld32 (&handles.lookup_epoch);
+  ddsrt_atomic_uint32_t * const lc = &handles.lookups[lookup_counter_idx % N_LOOKUP_COUNTERS].n[epoch];
+  ddsrt_atomic_inc32 (lc);
+  /* increment must be visible before the lookup accesses the table, pairs with
+     the fence in wait_for_lookups */
+  ddsrt_atomic_fence ();
+  return lc;
+}
+
+static void lookup_end (ddsrt_atomic_uint32_t *lc)
+{
+  ddsrt_atomic_fence_rel ();
+  ddsrt_atomic_dec32 (lc);
+}
+
+static void drain_lookups (uint32_t epoch)
+{
+  for (uint32_t i = 0; i < N_LOOKUP_COUNTERS; i++)
+  {
+    while (ddsrt_atomic_ld32 (&handles.lookups[i].n[epoch]) != 0)
+      dds_sleepfor (DDS_USECS (10));
+  }
+}
+
+static void wait_for_lookups (void)
+{
+  /* removal from the table must be visible before checking the counters: any
+     lookup starting later can no longer find the removed element */
+  ddsrt_atomic_fence ();
+  ddsrt_mutex_lock (&handles.lookup_wait_lock);
+  const uint32_t epoch = ddsrt_atomic_ld32 (&handles.lookup_epoch);
+  drain_lookups (epoch ^ 1);
+  ddsrt_atomic_st32 (&handles.lookup_epoch, epoch ^ 1);
+  ddsrt_atomic_fence ();
+  drain_lookups (epoch);
+  ddsrt_mutex_unlock (&handles.lookup_wait_lock);
+  ddsrt_atomic_fence_acq ();
+}
+
+static void gc_buckets (void *bs, void *varg)
+{
+  (void) varg;
+  wait_for_lookups ();
+  ddsrt_free (bs);
+}
 
 static uint32_t handle_hash (const void *va)
 {
@@ -79,7 +163,8 @@ dds_return_t dds_handle_server_init (void)
   /* called with ddsrt's singleton mutex held (see dds_init/fini) */
   if (handles.ht == NULL)
   {
-    handles.ht = ddsrt_hh_new (128, handle_hash, handle_equal);
+    ddsrt_mutex_init (&handles.lookup_wait_lock);
+    handles.ht = ddsrt_chh_new (128, handle_hash, handle_equal, gc_buckets, NULL);
     handles.count = 0;
     ddsrt_mutex_init (&handles.lock);
     ddsrt_cond_init (&handles.cond);
@@ -93,8 +178,8 @@ void dds_handle_server_fini (void)
   if (handles.ht != NULL)
   {
 #ifndef NDEBUG
-    struct ddsrt_hh_iter it;
-    for (struct dds_handle_link *link = ddsrt_hh_iter_first (handles.ht, &it); link != NULL; link = ddsrt_hh_iter_next (&it))
+    struct ddsrt_chh_iter it;
+    for (struct dds_handle_link *link = ddsrt_chh_iter_first (handles.ht, &it); link != NULL; link = ddsrt_chh_iter_next (&it))
     {
       uintptr_t cf = ddsrt_atomic_ldptr (&link->cnt_flags);
       DDS_ERROR ("handle %"PRId32" pin %"PRIuPTR" refc %"PRIuPTR"%s%s%s\n", link->hdl,
@@ -104,11 +189,12 @@ void dds_handle_server_fini (void)
                  cf & HDL_FLAG_CLOSING ? " closing" : "",
                  cf & HDL_FLAG_DELETE_DEFERRED ? " delete-deferred" : "");
     }
-    assert (ddsrt_hh_iter_first (handles.ht, &it) == NULL);
+    assert (ddsrt_chh_iter_first (handles.ht, &it) == NULL);
 #endif
-    ddsrt_hh_free (handles.ht);
+    ddsrt_chh_free (handles.ht);
     ddsrt_cond_destroy (&handles.cond);
     ddsrt_mutex_destroy (&handles.lock);
+    ddsrt_mutex_destroy (&handles.lookup_wait_lock);
     handles.ht = NULL;
   }
 }
@@ -124,7 +210,7 @@ static dds_handle_t dds_handle_create_int (struct dds_handle_link *link, bool im
     do {
       link->hdl = (int32_t) (ddsrt_random () & INT32_MAX);
     } while (link->hdl == 0 || link->hdl >= DDS_MIN_PSEUDO_HANDLE);
-  } while (!ddsrt_hh_add (handles.ht, link));
+  } while (!ddsrt_chh_add (handles.ht, link));
   return link->hdl;
 }
 
@@ -163,7 +249,7 @@ dds_return_t dds_handle_register_special (struct dds_handle_link *link, bool imp
     handles.count++;
     ddsrt_atomic_stptr (&link->cnt_flags, HDL_FLAG_PENDING | (implicit ? HDL_FLAG_IMPLICIT : HDL_REFCOUNT_UNIT) | (allow_children ? HDL_FLAG_ALLOW_CHILDREN : 0) | 1u);
     link->hdl = handle;
-    if (ddsrt_hh_add (handles.ht, link))
+    if (ddsrt_chh_add (handles.ht, link))
       ret = handle;
     else
       ret = DDS_RETCODE_BAD_PARAMETER;
@@ -199,10 +285,14 @@ int32_t dds_handle_delete (struct dds_handle_link *link)
   assert ((cf & HDL_PINCOUNT_MASK) == 1u);
 #endif
   ddsrt_mutex_lock (&handles.lock);
-  ddsrt_hh_remove_present (handles.ht, link);
+  bool present = ddsrt_chh_remove (handles.ht, link);
+  assert (present);
+  (void) present;
   assert (handles.count > 0);
   handles.count--;
   ddsrt_mutex_unlock (&handles.lock);
+  /* caller frees the link once this returns */
+  wait_for_lookups ();
   return DDS_RETCODE_OK;
 }
 
@@ -221,8 +311,8 @@ static int32_t dds_handle_pin_int (dds_handle_t hdl, uintptr_t delta, bool from_
   if (handles.ht == NULL)
     return DDS_RETCODE_PRECONDITION_NOT_MET;
 
-  ddsrt_mutex_lock (&handles.lock);
-  *link = ddsrt_hh_lookup (handles.ht, &dummy);
+  ddsrt_atomic_uint32_t * const lc = lookup_begin ();
+  *link = ddsrt_chh_lookup (handles.ht, &dummy);
   if (*link == NULL)
     rc = DDS_RETCODE_BAD_PARAMETER;
   else
@@ -248,7 +338,7 @@ static int32_t dds_handle_pin_int (dds_handle_t hdl, uintptr_t delta, bool from_
       }
     } while (!ddsrt_atomic_casptr (&(*link)->cnt_flags, cf, cf + delta));
   }
-  ddsrt_mutex_unlock (&handles.lock);
+  lookup_end (lc);
   return rc;
 }
 
@@ -277,8 +367,8 @@ int32_t dds_handle_pin_for_delete (dds_handle_t hdl, bool explicit, bool from_us
   if (handles.ht == NULL)
     return DDS_RETCODE_PRECONDITION_NOT_MET;
 
-  ddsrt_mutex_lock (&handles.lock);
-  *link = ddsrt_hh_lookup (handles.ht, &dummy);
+  ddsrt_atomic_uint32_t * const lc = lookup_begin ();
+  *link = ddsrt_chh_lookup (handles.ht, &dummy);
   if (*link == NULL)
     rc = DDS_RETCODE_BAD_PARAMETER;
   else
@@ -382,14 +472,13 @@ int32_t dds_handle_pin_for_delete (dds_handle_t hdl, bool explicit, bool from_us
       rc = ((cf1 & HDL_REFCOUNT_MASK) == 0 || (cf1 & HDL_FLAG_ALLOW_CHILDREN)) ? DDS_RETCODE_OK : DDS_RETCODE_TRY_AGAIN;
     } while (!ddsrt_atomic_casptr (&(*link)->cnt_flags, cf, cf1));
   }
-  ddsrt_mutex_unlock (&handles.lock);
+  lookup_end (lc);
   return rc;
 }
 
 bool dds_handle_drop_childref_and_pin (struct dds_handle_link *link, bool may_delete_parent)
 {
   bool del_parent = false;
-  ddsrt_mutex_lock (&handles.lock);
   uintptr_t cf, cf1;
   do {
     cf = ddsrt_atomic_ldptr (&link->cnt_flags);
@@ -427,7 +516,6 @@ bool dds_handle_drop_childref_and_pin (struct dds_handle_link *link, bool may_de
       }
     }
   } while (!ddsrt_atomic_casptr (&link->cnt_flags, cf, cf1));
-  ddsrt_mutex_unlock (&handles.lock);
   return del_parent;
 }
 
@@ -436,6 +524,15 @@ int32_t dds_handle_pin_and_ref_with_origin (dds_handle_t hdl, bool from_user, st
   return dds_handle_pin_int (hdl, HDL_REFCOUNT_UNIT + 1u, from_user, link);
 }
 
+static void wakeup_close_wait (void)
+{
+  /* close_wait checks the pin count with the lock held, and the pin count has
+     been updated before taking the lock here, so the wakeup can't get lost */
+  ddsrt_mutex_lock (&handles.lock);
+  ddsrt_cond_broadcast (&handles.cond);
+  ddsrt_mutex_unlock (&handles.lock);
+}
+
 void dds_handle_repin (struct dds_handle_link *link)
 {
   uintptr_t x = ddsrt_atomic_incptr_nv (&link->cnt_flags);
@@ -451,12 +548,8 @@ void dds_handle_unpin (struct dds_handle_link *link)
   else
     assert ((cf & HDL_PINCOUNT_MASK) >= 1u);
 #endif
-  ddsrt_mutex_lock (&handles.lock);
   if ((ddsrt_atomic_decptr_nv (&link->cnt_flags) & (HDL_FLAG_CLOSING | HDL_PINCOUNT_MASK)) == (HDL_FLAG_CLOSING | 1u))
-  {
-    ddsrt_cond_broadcast (&handles.cond);
-  }
-  ddsrt_mutex_unlock (&handles.lock);
+    wakeup_close_wait ();
 }
 
 void dds_handle_add_ref (struct dds_handle_link *link)
@@ -472,12 +565,8 @@ bool dds_handle_drop_ref (struct dds_handle_link *link)
     assert ((old & HDL_REFCOUNT_MASK) > 0);
     new = old - HDL_REFCOUNT_UNIT;
   } while (!ddsrt_atomic_casptr (&link->cnt_flags, old, new));
-  ddsrt_mutex_lock (&handles.lock);
   if ((new & (HDL_FLAG_CLOSING | HDL_PINCOUNT_MASK)) == (HDL_FLAG_CLOSING | 1u))
-  {
-    ddsrt_cond_broadcast (&handles.cond);
-  }
-  ddsrt_mutex_unlock (&handles.lock);
+    wakeup_close_wait ();
   return ((new & HDL_REFCOUNT_MASK) == 0);
 }
 
@@ -490,12 +579,8 @@ bool dds_handle_unpin_and_drop_ref (struct dds_handle_link *link)
     assert ((old & HDL_PINCOUNT_MASK) > 0);
     new = old - HDL_REFCOUNT_UNIT - 1u;
   } while (!ddsrt_atomic_casptr (&link->cnt_flags, old, new));
-  ddsrt_mutex_lock (&handles.lock);
   if ((new & (HDL_FLAG_CLOSING | HDL_PINCOUNT_MASK)) == (HDL_FLAG_CLOSING | 1u))
-  {
-    ddsrt_cond_broadcast (&handles.cond);
-  }
-  ddsrt_mutex_unlock (&handles.lock);
+    wakeup_close_wait ();
   return ((new & HDL_REFCOUNT_MASK) == 0);
 }
 
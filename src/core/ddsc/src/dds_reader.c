@@ -41,6 +41,7 @@
 #include "dds__statistics.h"
 #include "dds__psmx.h"
 #include "dds__guid.h"
+#include "dds__sqlfilter.h"
 
 DECL_ENTITY_LOCK_UNLOCK (dds_reader)
 
@@ -446,7 +447,8 @@ void dds_reader_invoke_cbs_for_pending_events(struct dds_entity *e, uint32_t sta
 }
 
 static const struct dds_stat_keyvalue_descriptor dds_reader_statistics_kv[] = {
-  { "discarded_bytes", DDS_STAT_KIND_UINT64 }
+  { "discarded_bytes", DDS_STAT_KIND_UINT64 },
+  { "recovered_bytes", DDS_STAT_KIND_UINT64 }
 };
 
 static const struct dds_stat_descriptor dds_reader_statistics_desc = {
@@ -463,7 +465,7 @@ static void dds_reader_refresh_statistics (const struct dds_entity *entity, stru
 {
   const struct dds_reader *rd = (const struct dds_reader *) entity;
   if (rd->m_rd)
-    ddsi_get_reader_stats (rd->m_rd, &stat->kv[0].u.u64);
+    ddsi_get_reader_stats (rd->m_rd, &stat->kv[0].u.u64, &stat->kv[1].u.u64);
 }
 
 const struct dds_entity_deriver dds_entity_deriver_reader = {
@@ -657,7 +659,8 @@ static dds_entity_t dds_create_reader_int (dds_entity_t participant_or_subscribe
 
   /* Reader gets the sertype from the topic, as the serdata functions the reader uses are
      not specific for a data representation (the representation can be retrieved from the cdr header) */
-  rc = ddsi_new_reader (&rd->m_rd, &rd->m_entity.m_guid, NULL, pp, tp->m_name, tp->m_stype, rqos, &rd->m_rhc->common.rhc, dds_reader_status_cb, rd, vl_set);
+  const struct ddsi_content_filter_property *content_filter = tp->m_sqlfilter ? dds_sqlfilter_property (tp->m_sqlfilter) : NULL;
+  rc = ddsi_new_reader (&rd->m_rd, &rd->m_entity.m_guid, NULL, pp, tp->m_name, tp->m_stype, rqos, &rd->m_rhc->common.rhc, dds_reader_status_cb, rd, vl_set, content_filter);
   if (rc != DDS_RETCODE_OK)
   {
     /* FIXME: can be out-of-resources at the very least; would leak allocated entity id */
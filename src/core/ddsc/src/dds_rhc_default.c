@@ -28,6 +28,7 @@
 #include "dds__loaned_sample.h"
 #include "dds/ddsc/dds_rhc.h"
 #include "dds__rhc_default.h"
+#include "dds__sqlfilter.h"
 #include "dds/ddsi/ddsi_tkmap.h"
 #include "dds/ddsrt/hopscotch.h"
 #include "dds/ddsrt/avl.h"
@@ -148,6 +149,28 @@
    which then runs over the array of attached read conditions and updates
    the trigger. It returns whether or not a trigger changed
    from 0 to 1, as this indicates the attached waitsets must be signalled.
+
+   CONCURRENCY
+   ===========
+
+   By default, a single lock protects the entire RHC.  With
+   Internal/ConcurrentReaderHistoryCache set, that lock is replaced by a
+   reader-writer lock and a fixed set of instance locks (instances are mapped
+   to them by instance id).  Anything that is not limited to a single existing
+   instance (creating and dropping instances, registering and unregistering
+   writers, reading or taking across all instances, read conditions, lifespan,
+   deadline, the max_samples resource limit) requires exclusive access, just
+   as it required the single lock.
+
+   Storing an ordinary write for an alive instance by the writer that last
+   updated it, and reading or taking a specific instance, only need shared
+   access plus the instance lock, so those can proceed in parallel for
+   different instances.  Under shared access the instance hash table and the
+   set of read conditions are stable, and the only state outside the
+   instance that gets updated are the counters in the RHC (which are therefore
+   updated atomically in this mode) and the list of non-empty instances
+   (which then has a lock of its own).  Threads waiting for exclusive access
+   prevent new shared access, which otherwise could starve them.
 */
 
 /* FIXME: tkmap should perhaps retain data with timestamp set to invalid
@@ -158,6 +181,8 @@
 
 #define MAX_ATTACHED_QUERYCONDS (CHAR_BIT * sizeof (dds_querycond_mask_t))
 
+#define RHC_INST_LOCKS 64
+
 #define INCLUDE_TRACE 1
 #if INCLUDE_TRACE
 #define TRACE(...) DDS_CLOG (DDS_LC_RHC, &rhc->gv->logconfig, __VA_ARGS__)
@@ -299,20 +324,21 @@ struct dds_rhc_default {
   int32_t max_samples_per_instance; /* FIXME: probably better as uint32_t with MAX_UINT32 for unlimited */
   dds_duration_t minimum_separation; /* derived from the time_based_filter QoSPolicy */
 
-  uint32_t n_instances;              /* # instances, including empty */
-  uint32_t n_nonempty_instances;     /* # non-empty instances */
-  uint32_t n_not_alive_disposed;     /* # disposed, non-empty instances */
-  uint32_t n_not_alive_no_writers;   /* # not-alive-no-writers, non-empty instances */
-  uint32_t n_new;                    /* # new, non-empty instances */
-  uint32_t n_vsamples;               /* # "valid" samples over all instances */
-  uint32_t n_vread;                  /* # read "valid" samples over all instances */
-  uint32_t n_invsamples;             /* # invalid samples over all instances */
-  uint32_t n_invread;                /* # read invalid samples over all instances */
+  uint32_t n_instances;                         /* # instances, including empty */
+  ddsrt_atomic_uint32_t n_nonempty_instances;   /* # non-empty instances */
+  ddsrt_atomic_uint32_t n_not_alive_disposed;   /* # disposed, non-empty instances */
+  ddsrt_atomic_uint32_t n_not_alive_no_writers; /* # not-alive-no-writers, non-empty instances */
+  ddsrt_atomic_uint32_t n_new;                  /* # new, non-empty instances */
+  ddsrt_atomic_uint32_t n_vsamples;             /* # "valid" samples over all instances */
+  ddsrt_atomic_uint32_t n_vread;                /* # read "valid" samples over all instances */
+  ddsrt_atomic_uint32_t n_invsamples;           /* # invalid samples over all instances */
+  ddsrt_atomic_uint32_t n_invread;              /* # read invalid samples over all instances */
 
   bool by_source_ordering;           /* true if BY_SOURCE, false if BY_RECEPTION */
   bool exclusive_ownership;          /* true if EXCLUSIVE, false if SHARED */
   bool reliable;                     /* true if reliability RELIABLE */
   bool xchecks;                      /* whether to do expensive checking if checking at all */
+  bool concurrent;                   /* whether to use "rwlock" and "inst_locks" instead of "lock" */
 
   dds_reader *reader;                /* reader -- may be NULL (used by rhc_torture) */
   struct ddsi_tkmap *tkmap;          /* back pointer to tkmap */
@@ -321,6 +347,10 @@ struct dds_rhc_default {
   uint32_t history_depth;            /* depth, 1 for KEEP_LAST_1, 2**32-1 for KEEP_ALL */
 
   ddsrt_mutex_t lock;
+  ddsrt_rwlock_t rwlock;             /* concurrent: exclusive where otherwise "lock", shared for single instance ops */
+  ddsrt_atomic_uint32_t excl_waiting; /* concurrent: # threads waiting for exclusive access to rwlock */
+  ddsrt_mutex_t nonempty_lock;       /* concurrent: protects nonempty_instances while rwlock is shared */
+  ddsrt_mutex_t *inst_locks;         /* concurrent: instance locks, RHC_INST_LOCKS of them, indexed by iid */
   dds_readcond * conds;              /* List of associated read conditions */
   uint32_t nconds;                   /* Number of associated read conditions */
   uint32_t nqconds;                  /* Number of associated query conditions */
@@ -363,6 +393,88 @@ struct trigger_info_post {
 
 static const struct dds_rhc_ops dds_rhc_default_ops;
 
+static uint32_t rhc_cnt (const ddsrt_atomic_uint32_t *cnt)
+{
+  return ddsrt_atomic_ld32 (cnt);
+}
+
+static void rhc_cnt_add (const struct dds_rhc_default *rhc, ddsrt_atomic_uint32_t *cnt, uint32_t v)
+{
+  /* only concurrent updates require an atomic increment, avoid paying the price otherwise */
+  if (rhc->concurrent)
+    ddsrt_atomic_add32 (cnt, v);
+  else
+    ddsrt_atomic_st32 (cnt, ddsrt_atomic_ld32 (cnt) + v);
+}
+
+static void rhc_cnt_sub (const struct dds_rhc_default *rhc, ddsrt_atomic_uint32_t *cnt, uint32_t v)
+{
+  if (rhc->concurrent)
+    ddsrt_atomic_sub32 (cnt, v);
+  else
+    ddsrt_atomic_st32 (cnt, ddsrt_atomic_ld32 (cnt) - v);
+}
+
+static void rhc_cnt_inc (const struct dds_rhc_default *rhc, ddsrt_atomic_uint32_t *cnt)
+{
+  rhc_cnt_add (rhc, cnt, 1);
+}
+
+static void rhc_cnt_dec (const struct dds_rhc_default *rhc, ddsrt_atomic_uint32_t *cnt)
+{
+  rhc_cnt_sub (rhc, cnt, 1);
+}
+
+static void rhc_lock (struct dds_rhc_default *rhc)
+{
+  if (!rhc->concurrent)
+    ddsrt_mutex_lock (&rhc->lock);
+  else
+  {
+    ddsrt_atomic_inc32 (&rhc->excl_waiting);
+    ddsrt_rwlock_write (&rhc->rwlock);
+    ddsrt_atomic_dec32 (&rhc->excl_waiting);
+  }
+}
+
+static void rhc_unlock (struct dds_rhc_default *rhc)
+{
+  if (!rhc->concurrent)
+    ddsrt_mutex_unlock (&rhc->lock);
+  else
+    ddsrt_rwlock_unlock (&rhc->rwlock);
+}
+
+static bool rhc_lock_shared (struct dds_rhc_default *rhc)
+{
+  /* Returns false if shared access is not an option, either because it is not
+     supported or because the state of the RHC requires exclusive access for
+     everything: read conditions track the state of all instances, samples with
+     a lifespan are in a single heap.  Both only get added with exclusive access,
+     so it suffices to check once. */
+  if (!rhc->concurrent || ddsrt_atomic_ld32 (&rhc->excl_waiting) > 0)
+    return false;
+  ddsrt_rwlock_read (&rhc->rwlock);
+  bool ok = (rhc->nconds == 0);
+#ifdef DDS_HAS_LIFESPAN
+  ok = ok && ddsi_lifespan_empty_locked (&rhc->lifespan);
+#endif
+  if (!ok)
+    ddsrt_rwlock_unlock (&rhc->rwlock);
+  return ok;
+}
+
+static ddsrt_mutex_t *rhc_inst_lock (const struct dds_rhc_default *rhc, const struct rhc_instance *inst)
+{
+  return &rhc->inst_locks[inst->iid % RHC_INST_LOCKS];
+}
+
+static void rhc_unlock_shared (struct dds_rhc_default *rhc, ddsrt_mutex_t *inst_lock)
+{
+  ddsrt_mutex_unlock (inst_lock);
+  ddsrt_rwlock_unlock (&rhc->rwlock);
+}
+
 static uint32_t qmask_of_sample (const struct rhc_sample *s)
 {
   return s->isread ? DDS_READ_SAMPLE_STATE : DDS_NOT_READ_SAMPLE_STATE;
@@ -435,16 +547,24 @@ static bool instance_iid_eq (const void *va, const void *vb)
 
 static void add_inst_to_nonempty_list (struct dds_rhc_default *rhc, struct rhc_instance *inst)
 {
+  if (rhc->concurrent)
+    ddsrt_mutex_lock (&rhc->nonempty_lock);
   ddsrt_circlist_append (&rhc->nonempty_instances, &inst->nonempty_list);
-  rhc->n_nonempty_instances++;
+  if (rhc->concurrent)
+    ddsrt_mutex_unlock (&rhc->nonempty_lock);
+  rhc_cnt_inc (rhc, &rhc->n_nonempty_instances);
 }
 
 static void remove_inst_from_nonempty_list (struct dds_rhc_default *rhc, struct rhc_instance *inst)
 {
   assert (inst_is_empty (inst));
+  if (rhc->concurrent)
+    ddsrt_mutex_lock (&rhc->nonempty_lock);
   ddsrt_circlist_remove (&rhc->nonempty_instances, &inst->nonempty_list);
-  assert (rhc->n_nonempty_instances > 0);
-  rhc->n_nonempty_instances--;
+  if (rhc->concurrent)
+    ddsrt_mutex_unlock (&rhc->nonempty_lock);
+  assert (rhc_cnt (&rhc->n_nonempty_instances) > 0);
+  rhc_cnt_dec (rhc, &rhc->n_nonempty_instances);
 }
 
 static struct rhc_instance *oldest_nonempty_instance (const struct dds_rhc_default *rhc)
@@ -488,11 +608,11 @@ static void drop_expired_samples (struct dds_rhc_default *rhc, struct rhc_sample
   while (psample->next != sample)
     psample = psample->next;
 
-  rhc->n_vsamples--;
+  rhc_cnt_dec (rhc, &rhc->n_vsamples);
   if (sample->isread)
   {
     inst->nvread--;
-    rhc->n_vread--;
+    rhc_cnt_dec (rhc, &rhc->n_vread);
     trig_qc.dec_sample_read = true;
   }
   if (--inst->nvsamples > 0)
@@ -519,10 +639,10 @@ ddsrt_mtime_t dds_rhc_default_sample_expired_cb(void *hc, ddsrt_mtime_t tnow)
   struct dds_rhc_default *rhc = hc;
   struct rhc_sample *sample;
   ddsrt_mtime_t tnext;
-  ddsrt_mutex_lock (&rhc->lock);
+  rhc_lock (rhc);
   while ((tnext = ddsi_lifespan_next_expired_locked (&rhc->lifespan, tnow, (void **)&sample)).v == 0)
     drop_expired_samples (rhc, sample);
-  ddsrt_mutex_unlock (&rhc->lock);
+  rhc_unlock (rhc);
   return tnext;
 }
 #endif /* DDS_HAS_LIFESPAN */
@@ -534,7 +654,7 @@ ddsrt_mtime_t dds_rhc_default_deadline_missed_cb(void *hc, ddsrt_mtime_t tnow)
   ddsrt_mtime_t tnext = {0};
   uint32_t ninst = 0;
   void *vinst;
-  ddsrt_mutex_lock (&rhc->lock);
+  rhc_lock (rhc);
   // stop after touching all instances to somewhat gracefully handle cases where we can't keep up
   // alternatively one could do at most a fixed number at the time
   while (ninst++ < rhc->n_instances && (tnext = ddsi_deadline_next_missed_locked (&rhc->deadline, tnow, &vinst)).v == 0)
@@ -550,13 +670,13 @@ ddsrt_mtime_t dds_rhc_default_deadline_missed_cb(void *hc, ddsrt_mtime_t tnow)
     cb_data.extra = deadlines_expired;
     cb_data.handle = inst->iid;
     cb_data.add = true;
-    ddsrt_mutex_unlock (&rhc->lock);
+    rhc_unlock (rhc);
     dds_reader_status_cb (&rhc->reader->m_entity, &cb_data);
-    ddsrt_mutex_lock (&rhc->lock);
+    rhc_lock (rhc);
 
     tnow = ddsrt_time_monotonic ();
   }
-  ddsrt_mutex_unlock (&rhc->lock);
+  rhc_unlock (rhc);
   return tnext;
 }
 #endif /* DDS_HAS_DEADLINE_MISSED */
@@ -576,6 +696,15 @@ struct dds_rhc *dds_rhc_default_new_xchecks (dds_reader *reader, struct ddsi_dom
   rhc->tkmap = gv->m_tkmap;
   rhc->gv = gv;
   rhc->xchecks = xchecks;
+  rhc->concurrent = gv->config.concurrent_rhc;
+  if (rhc->concurrent)
+  {
+    ddsrt_rwlock_init (&rhc->rwlock);
+    ddsrt_mutex_init (&rhc->nonempty_lock);
+    rhc->inst_locks = ddsrt_malloc (RHC_INST_LOCKS * sizeof (*rhc->inst_locks));
+    for (uint32_t i = 0; i < RHC_INST_LOCKS; i++)
+      ddsrt_mutex_init (&rhc->inst_locks[i]);
+  }
 
 #ifdef DDS_HAS_LIFESPAN
   ddsi_lifespan_init (gv, &rhc->lifespan, offsetof(struct dds_rhc_default, lifespan), offsetof(struct rhc_sample, lifespan), dds_rhc_default_sample_expired_cb);
@@ -691,9 +820,9 @@ static void inst_clear_invsample (struct dds_rhc_default *rhc, struct rhc_instan
   if (inst->inv_isread)
   {
     trig_qc->dec_invsample_read = true;
-    rhc->n_invread--;
+    rhc_cnt_dec (rhc, &rhc->n_invread);
   }
-  rhc->n_invsamples--;
+  rhc_cnt_dec (rhc, &rhc->n_invsamples);
 }
 
 static void inst_clear_invsample_if_exists (struct dds_rhc_default *rhc, struct rhc_instance *inst, struct trigger_info_qcond *trig_qc)
@@ -717,7 +846,7 @@ static void inst_set_invsample (struct dds_rhc_default *rhc, struct rhc_instance
     trig_qc->inc_conds_invsample = inst->conds;
     inst->inv_exists = 1;
     inst->inv_isread = 0;
-    rhc->n_invsamples++;
+    rhc_cnt_inc (rhc, &rhc->n_invsamples);
     *nda = true;
   }
 }
@@ -746,8 +875,8 @@ static void free_instance_rhc_free (struct rhc_instance *inst, struct dds_rhc_de
       free_sample (rhc, inst, s);
       s = s1;
     } while (s != inst->latest);
-    rhc->n_vsamples -= inst->nvsamples;
-    rhc->n_vread -= inst->nvread;
+    rhc_cnt_sub (rhc, &rhc->n_vsamples, inst->nvsamples);
+    rhc_cnt_sub (rhc, &rhc->n_vread, inst->nvread);
     inst->nvsamples = 0;
     inst->nvread = 0;
   }
@@ -758,7 +887,7 @@ static void free_instance_rhc_free (struct rhc_instance *inst, struct dds_rhc_de
   if (!was_empty)
     remove_inst_from_nonempty_list (rhc, inst);
   if (inst->isnew)
-    rhc->n_new--;
+    rhc_cnt_dec (rhc, &rhc->n_new);
   free_empty_instance(inst, rhc);
 }
 
@@ -786,6 +915,14 @@ static void dds_rhc_default_free (struct ddsi_rhc *rhc_common)
   lwregs_fini (&rhc->registrations);
   if (rhc->qcond_eval_samplebuf != NULL)
     ddsi_sertype_free_sample (rhc->type, rhc->qcond_eval_samplebuf, DDS_FREE_ALL);
+  if (rhc->concurrent)
+  {
+    for (uint32_t i = 0; i < RHC_INST_LOCKS; i++)
+      ddsrt_mutex_destroy (&rhc->inst_locks[i]);
+    ddsrt_free (rhc->inst_locks);
+    ddsrt_mutex_destroy (&rhc->nonempty_lock);
+    ddsrt_rwlock_destroy (&rhc->rwlock);
+  }
   ddsrt_mutex_destroy (&rhc->lock);
   ddsrt_free (rhc);
 }
@@ -868,13 +1005,13 @@ static bool add_sample (struct dds_rhc_default *rhc, struct rhc_instance *inst,
     if (s->isread)
     {
       inst->nvread--;
-      rhc->n_vread--;
+      rhc_cnt_dec (rhc, &rhc->n_vread);
     }
   }
   else
   {
     /* Check if resource max_samples QoS exceeded */
-    if (rhc->reader && rhc->max_samples != DDS_LENGTH_UNLIMITED && rhc->n_vsamples >= (uint32_t) rhc->max_samples)
+    if (rhc->reader && rhc->max_samples != DDS_LENGTH_UNLIMITED && rhc_cnt (&rhc->n_vsamples) >= (uint32_t) rhc->max_samples)
     {
       cb_data->raw_status_id = (int) DDS_SAMPLE_REJECTED_STATUS_ID;
       cb_data->extra = DDS_REJECTED_BY_SAMPLES_LIMIT;
@@ -906,7 +1043,7 @@ static bool add_sample (struct dds_rhc_default *rhc, struct rhc_instance *inst,
       inst->latest->next = s;
     }
     inst->nvsamples++;
-    rhc->n_vsamples++;
+    rhc_cnt_inc (rhc, &rhc->n_vsamples);
   }
 
   s->sample = ddsi_serdata_ref (sample); /* drops const (tho refcount does change) */
@@ -967,6 +1104,8 @@ static bool content_filter_accepts (const dds_reader *reader, const struct ddsi_
   if (reader)
   {
     const struct dds_topic *tp = reader->m_topic;
+    if (tp->m_sqlfilter && !dds_sqlfilter_accepts (tp->m_sqlfilter, sample))
+      return false;
     switch (tp->m_filter.mode)
     {
       case DDS_TOPIC_FILTER_NONE:
@@ -1096,7 +1235,7 @@ static void drop_instance_noupdate_no_writers (struct dds_rhc_default *rhc, stru
 
   rhc->n_instances--;
   if (inst->isnew)
-    rhc->n_new--;
+    rhc_cnt_dec (rhc, &rhc->n_new);
 
   ddsrt_hh_remove_present (rhc->instances, inst);
   free_empty_instance (inst, rhc);
@@ -1146,7 +1285,7 @@ static void dds_rhc_register (struct dds_rhc_default *rhc, struct rhc_instance *
     TRACE ("new1");
 
     if (!inst_is_empty (inst) && !inst->isdisposed)
-      rhc->n_not_alive_no_writers--;
+      rhc_cnt_dec (rhc, &rhc->n_not_alive_no_writers);
     *nda = true;
   }
   else if (inst_wr_iid == 0 && inst->wrcount == 1)
@@ -1230,9 +1369,9 @@ static void account_for_empty_to_nonempty_transition (struct dds_rhc_default *rh
   assert (inst_nsamples (inst) == 1);
   add_inst_to_nonempty_list (rhc, inst);
   if (inst->isdisposed)
-    rhc->n_not_alive_disposed++;
+    rhc_cnt_inc (rhc, &rhc->n_not_alive_disposed);
   else if (inst->wrcount == 0)
-    rhc->n_not_alive_no_writers++;
+    rhc_cnt_inc (rhc, &rhc->n_not_alive_no_writers);
 }
 
 static void account_for_nonempty_to_empty_transition (struct dds_rhc_default *rhc, struct rhc_instance **instptr, const char *traceprefix)
@@ -1241,14 +1380,14 @@ static void account_for_nonempty_to_empty_transition (struct dds_rhc_default *rh
   assert (inst_is_empty (inst));
   remove_inst_from_nonempty_list (rhc, inst);
   if (inst->isdisposed)
-    rhc->n_not_alive_disposed--;
+    rhc_cnt_dec (rhc, &rhc->n_not_alive_disposed);
   if (inst->wrcount == 0)
   {
     TRACE ("%siid %"PRIx64" #0,empty,drop\n", traceprefix, inst->iid);
     if (!inst->isdisposed)
     {
       /* disposed has priority over no writers (why not just 2 bits?) */
-      rhc->n_not_alive_no_writers--;
+      rhc_cnt_dec (rhc, &rhc->n_not_alive_no_writers);
     }
     drop_instance_noupdate_no_writers (rhc, instptr);
   }
@@ -1338,12 +1477,12 @@ static bool rhc_unregister_updateinst (struct dds_rhc_default *rhc, struct rhc_i
           update_inst_no_wr_iid (inst, wrinfo, tstamp);
         }
         if (!inst->autodispose)
-          rhc->n_not_alive_no_writers++;
+          rhc_cnt_inc (rhc, &rhc->n_not_alive_no_writers);
         else
         {
           TRACE (",autodispose");
           inst->isdisposed = 1;
-          rhc->n_not_alive_disposed++;
+          rhc_cnt_inc (rhc, &rhc->n_not_alive_disposed);
         }
         *nda = true;
       }
@@ -1483,7 +1622,7 @@ static rhc_store_result_t rhc_store_new_instance (struct rhc_instance **out_inst
   assert (ret);
   (void) ret;
   rhc->n_instances++;
-  rhc->n_new++;
+  rhc_cnt_inc (rhc, &rhc->n_new);
 
   *out_inst = inst;
   return RHC_STORED;
@@ -1523,8 +1662,6 @@ static void postprocess_instance_update (struct dds_rhc_default *rhc, struct rhc
 
   if (trigger_info_differs (rhc, pre, post, trig_qc))
     update_conditions_locked (rhc, true, pre, post, trig_qc, *instptr);
-
-  assert (rhc_check_counts_locked (rhc, true, true));
 }
 
 static void update_viewstate_and_disposedness (struct dds_rhc_default *rhc, struct rhc_instance *inst, bool has_data, bool not_alive, bool is_dispose, bool *nda)
@@ -1564,6 +1701,57 @@ static void update_viewstate_and_disposedness (struct dds_rhc_default *rhc, stru
   }
 }
 
+static bool store_may_be_confined_to_instance (const struct dds_rhc_default *rhc, const struct ddsi_writer_info *wrinfo, const struct ddsi_serdata *sample)
+{
+  /* Only an ordinary write can be confined to a single instance, and then only if
+     it doesn't involve RHC-wide administration for resource limits, lifespan or
+     deadline */
+  if (sample->statusinfo != 0 || sample->kind != SDK_DATA)
+    return false;
+  if (rhc->max_samples != DDS_LENGTH_UNLIMITED)
+    return false;
+#ifdef DDS_HAS_LIFESPAN
+  if (wrinfo->lifespan_exp.v != DDS_NEVER)
+    return false;
+#else
+  (void) wrinfo;
+#endif
+#ifdef DDS_HAS_DEADLINE_MISSED
+  if (rhc->deadline.dur != DDS_INFINITY)
+    return false;
+#endif
+  return true;
+}
+
+static struct rhc_instance *lock_and_lookup_for_store (struct dds_rhc_default *rhc, const struct ddsi_writer_info *wrinfo, const struct ddsi_serdata *sample, const struct rhc_instance *template, ddsrt_mutex_t **inst_lock)
+{
+  /* Sets *inst_lock to the instance lock if shared access suffices, else to NULL
+     and the RHC is locked exclusively */
+  if (store_may_be_confined_to_instance (rhc, wrinfo, sample) && rhc_lock_shared (rhc))
+  {
+    /* A write by the writer that last updated the instance requires no change to
+       the registrations, and if the instance is alive, neither to the instance
+       state nor to the view state */
+    struct rhc_instance *inst;
+    if ((inst = ddsrt_hh_lookup (rhc->instances, template)) != NULL)
+    {
+      ddsrt_mutex_t * const lock = rhc_inst_lock (rhc, inst);
+      ddsrt_mutex_lock (lock);
+      if (inst->wr_iid_islive && inst->wr_iid == wrinfo->iid && !inst->isdisposed)
+      {
+        assert (inst->wrcount > 0);
+        *inst_lock = lock;
+        return inst;
+      }
+      ddsrt_mutex_unlock (lock);
+    }
+    ddsrt_rwlock_unlock (&rhc->rwlock);
+  }
+  *inst_lock = NULL;
+  rhc_lock (rhc);
+  return ddsrt_hh_lookup (rhc->instances, template);
+}
+
 /*
   dds_rhc_store: DDSI up call into read cache to store new sample. Returns whether sample
   delivered (true unless a reliable sample rejected).
@@ -1578,6 +1766,7 @@ static bool dds_rhc_default_store (struct ddsi_rhc *rhc_common, const struct dds
   const int is_dispose = (statusinfo & DDSI_STATUSINFO_DISPOSE) != 0;
   struct rhc_instance dummy_instance;
   struct rhc_instance *inst;
+  ddsrt_mutex_t *inst_lock;
   struct trigger_info_pre pre;
   struct trigger_info_post post;
   struct trigger_info_qcond trig_qc;
@@ -1602,9 +1791,7 @@ static bool dds_rhc_default_store (struct ddsi_rhc *rhc_common, const struct dds
 
   init_trigger_info_qcond (&trig_qc);
 
-  ddsrt_mutex_lock (&rhc->lock);
-
-  inst = ddsrt_hh_lookup (rhc->instances, &dummy_instance);
+  inst = lock_and_lookup_for_store (rhc, wrinfo, sample, &dummy_instance, &inst_lock);
   if (inst == NULL)
   {
     /* New instance for this reader.  If no data content -- not (also)
@@ -1720,8 +1907,8 @@ static bool dds_rhc_default_store (struct ddsi_rhc *rhc_common, const struct dds
         if (was_empty)
           account_for_empty_to_nonempty_transition (rhc, inst);
         else
-          rhc->n_not_alive_disposed += (uint32_t)(inst->isdisposed - old_isdisposed);
-        rhc->n_new += (uint32_t)(inst->isnew - old_isnew);
+          rhc_cnt_add (rhc, &rhc->n_not_alive_disposed, (uint32_t)(inst->isdisposed - old_isdisposed));
+        rhc_cnt_add (rhc, &rhc->n_new, (uint32_t)(inst->isnew - old_isnew));
       }
       else
       {
@@ -1730,7 +1917,7 @@ static bool dds_rhc_default_store (struct ddsi_rhc *rhc_common, const struct dds
     }
 
     TRACE(" nda=%d\n", notify_data_available);
-    assert (rhc_check_counts_locked (rhc, false, false));
+    assert (inst_lock != NULL || rhc_check_counts_locked (rhc, false, false));
   }
 
   if (statusinfo & DDSI_STATUSINFO_UNREGISTER)
@@ -1756,9 +1943,13 @@ static bool dds_rhc_default_store (struct ddsi_rhc *rhc_common, const struct dds
   }
 
   postprocess_instance_update (rhc, &inst, &pre, &post, &trig_qc);
+  assert (inst_lock != NULL || rhc_check_counts_locked (rhc, true, true));
 
 error_or_nochange:
-  ddsrt_mutex_unlock (&rhc->lock);
+  if (inst_lock)
+    rhc_unlock_shared (rhc, inst_lock);
+  else
+    rhc_unlock (rhc);
 
   if (rhc->reader)
   {
@@ -1793,7 +1984,7 @@ static void dds_rhc_default_unregister_wr (struct ddsi_rhc *rhc_common, const st
   struct ddsrt_hh_iter iter;
   const uint64_t wr_iid = wrinfo->iid;
 
-  ddsrt_mutex_lock (&rhc->lock);
+  rhc_lock (rhc);
   TRACE ("rhc_unregister_wr_iid %"PRIx64",%d:\n", wr_iid, wrinfo->auto_dispose);
   for (inst = ddsrt_hh_iter_first (rhc->instances, &iter); inst; inst = ddsrt_hh_iter_next (&iter))
   {
@@ -1808,10 +1999,11 @@ static void dds_rhc_default_unregister_wr (struct ddsi_rhc *rhc_common, const st
       TRACE ("  %"PRIx64":", inst->iid);
       dds_rhc_unregister (rhc, inst, wrinfo, inst->tstamp, &post, &trig_qc, &notify_data_available);
       postprocess_instance_update (rhc, &inst, &pre, &post, &trig_qc);
+      assert (rhc_check_counts_locked (rhc, true, true));
       TRACE ("\n");
     }
   }
-  ddsrt_mutex_unlock (&rhc->lock);
+  rhc_unlock (rhc);
 
   if (rhc->reader && notify_data_available)
     dds_reader_data_available_cb (rhc->reader);
@@ -1822,7 +2014,7 @@ static void dds_rhc_default_relinquish_ownership (struct ddsi_rhc *rhc_common, c
   struct dds_rhc_default *const rhc = (struct dds_rhc_default *) rhc_common;
   struct rhc_instance *inst;
   struct ddsrt_hh_iter iter;
-  ddsrt_mutex_lock (&rhc->lock);
+  rhc_lock (rhc);
   TRACE ("rhc_relinquish_ownership(%"PRIx64":\n", wr_iid);
   for (inst = ddsrt_hh_iter_first (rhc->instances, &iter); inst; inst = ddsrt_hh_iter_next (&iter))
   {
@@ -1833,7 +2025,7 @@ static void dds_rhc_default_relinquish_ownership (struct ddsi_rhc *rhc_common, c
   }
   TRACE (")\n");
   assert (rhc_check_counts_locked (rhc, true, false));
-  ddsrt_mutex_unlock (&rhc->lock);
+  rhc_unlock (rhc);
 }
 
 /* STATUSES:
@@ -2146,7 +2338,7 @@ static int32_t read_w_qminv_inst_validsamples (const struct readtake_w_qminv_ins
         read_sample_update_conditions (state->rhc, pre, post, trig_qc, inst, sample->conds, false);
         sample->isread = true;
         inst->nvread++;
-        state->rhc->n_vread++;
+        rhc_cnt_inc (state->rhc, &state->rhc->n_vread);
       }
       (*state->limit)--;
     }
@@ -2188,11 +2380,11 @@ static int32_t take_w_qminv_inst_validsamples (const struct readtake_w_qminv_ins
       if (rc < 0)
         return rc;
       take_sample_update_conditions (state->rhc, pre, post, trig_qc, inst, sample->conds, sample->isread);
-      state->rhc->n_vsamples--;
+      rhc_cnt_dec (state->rhc, &state->rhc->n_vsamples);
       if (sample->isread)
       {
         inst->nvread--;
-        state->rhc->n_vread--;
+        rhc_cnt_dec (state->rhc, &state->rhc->n_vread);
       }
       if (--inst->nvsamples == 0)
         inst->latest = NULL;
@@ -2247,7 +2439,7 @@ static int32_t read_w_qminv_inst (const struct readtake_w_qminv_inst_state *stat
     {
       read_sample_update_conditions (state->rhc, &pre, &post, &trig_qc, inst, inst->conds, false);
       inst->inv_isread = 1;
-      state->rhc->n_invread++;
+      rhc_cnt_inc (state->rhc, &state->rhc->n_invread);
     }
     (*state->limit)--;
   }
@@ -2258,7 +2450,7 @@ abort_on_error: ;
   {
     inst_became_old = true;
     inst->isnew = 0;
-    state->rhc->n_new--;
+    rhc_cnt_dec (state->rhc, &state->rhc->n_new);
   }
   if (nread != inst_nread (inst) || inst_became_old)
   {
@@ -2314,7 +2506,7 @@ abort_on_error: ;
     if (inst->isnew)
     {
       inst->isnew = 0;
-      state->rhc->n_new--;
+      rhc_cnt_dec (state->rhc, &state->rhc->n_new);
     }
     /* if nsamples = 0, it won't match anything, so no need to do anything here for drop_instance_noupdate_no_writers */
     get_trigger_info_cmn (&post.c, inst);
@@ -2330,29 +2522,59 @@ abort_on_error: ;
   return rc;
 }
 
+static struct rhc_instance *lock_and_lookup_for_readtake (struct dds_rhc_default *rhc, dds_instance_handle_t handle, bool take, ddsrt_mutex_t **inst_lock)
+{
+  /* Sets *inst_lock to the instance lock if shared access suffices, else to NULL
+     and the RHC is locked exclusively */
+  struct rhc_instance template, *inst;
+  template.iid = handle;
+  if (rhc_lock_shared (rhc))
+  {
+    if ((inst = ddsrt_hh_lookup (rhc->instances, &template)) != NULL)
+    {
+      ddsrt_mutex_t * const lock = rhc_inst_lock (rhc, inst);
+      ddsrt_mutex_lock (lock);
+      /* taking all samples of an instance without writers drops the instance */
+      if (!take || inst->wrcount > 0)
+      {
+        *inst_lock = lock;
+        return inst;
+      }
+      ddsrt_mutex_unlock (lock);
+    }
+    ddsrt_rwlock_unlock (&rhc->rwlock);
+  }
+  *inst_lock = NULL;
+  rhc_lock (rhc);
+  return ddsrt_hh_lookup (rhc->instances, &template);
+}
+
 static dds_return_t read_w_qminv (const struct readtake_w_qminv_inst_state *state, bool mark_as_read, dds_instance_handle_t handle)
 {
   struct dds_rhc_default * const rhc = state->rhc;
   dds_return_t rc = DDS_RETCODE_OK;
+  struct rhc_instance *inst = NULL;
+  ddsrt_mutex_t *inst_lock = NULL;
   assert (0 < *state->limit && *state->limit <= INT32_MAX);
-  ddsrt_mutex_lock (&rhc->lock);
+  if (handle)
+    inst = lock_and_lookup_for_readtake (rhc, handle, false, &inst_lock);
+  else
+    rhc_lock (rhc);
 
   TRACE ("read_w_qminv(%p,%"PRId32",%"PRIx32",%"PRIx64") - inst %"PRIu32" nonempty %"PRIu32" disp %"PRIu32" nowr %"PRIu32" new %"PRIu32" samples %"PRIu32"+%"PRIu32" read %"PRIu32"+%"PRIu32"\n", (void*) rhc, *state->limit, state->qminv, handle,
-    rhc->n_instances, rhc->n_nonempty_instances, rhc->n_not_alive_disposed,
-    rhc->n_not_alive_no_writers, rhc->n_new, rhc->n_vsamples, rhc->n_invsamples,
-    rhc->n_vread, rhc->n_invread);
+    rhc->n_instances, rhc_cnt (&rhc->n_nonempty_instances), rhc_cnt (&rhc->n_not_alive_disposed),
+    rhc_cnt (&rhc->n_not_alive_no_writers), rhc_cnt (&rhc->n_new), rhc_cnt (&rhc->n_vsamples), rhc_cnt (&rhc->n_invsamples),
+    rhc_cnt (&rhc->n_vread), rhc_cnt (&rhc->n_invread));
   if (handle)
   {
-    struct rhc_instance template, *inst;
-    template.iid = handle;
-    if ((inst = ddsrt_hh_lookup (rhc->instances, &template)) != NULL)
+    if (inst != NULL)
       rc = read_w_qminv_inst (state, mark_as_read, inst);
     else
       rc = DDS_RETCODE_PRECONDITION_NOT_MET;
   }
   else if (!ddsrt_circlist_isempty (&rhc->nonempty_instances))
   {
-    struct rhc_instance * inst = oldest_nonempty_instance (rhc);
+    inst = oldest_nonempty_instance (rhc);
     struct rhc_instance * const end = inst;
     do {
       rc = read_w_qminv_inst (state, mark_as_read, inst);
@@ -2360,8 +2582,13 @@ static dds_return_t read_w_qminv (const struct readtake_w_qminv_inst_state *stat
     } while (rc >= 0 && inst != end && *state->limit > 0);
   }
   TRACE ("read: returning %"PRId32" with remaining limit %"PRId32"\n", rc, *state->limit);
-  assert (rhc_check_counts_locked (rhc, true, false));
-  ddsrt_mutex_unlock (&rhc->lock);
+  if (inst_lock)
+    rhc_unlock_shared (rhc, inst_lock);
+  else
+  {
+    assert (rhc_check_counts_locked (rhc, true, false));
+    rhc_unlock (rhc);
+  }
   return rc;
 }
 
@@ -2369,26 +2596,29 @@ static dds_return_t take_w_qminv (const struct readtake_w_qminv_inst_state *stat
 {
   struct dds_rhc_default * const rhc = state->rhc;
   dds_return_t rc = DDS_RETCODE_OK;
+  struct rhc_instance *inst = NULL;
+  ddsrt_mutex_t *inst_lock = NULL;
   assert (0 < *state->limit && *state->limit <= INT32_MAX);
-  ddsrt_mutex_lock (&rhc->lock);
+  if (handle)
+    inst = lock_and_lookup_for_readtake (rhc, handle, true, &inst_lock);
+  else
+    rhc_lock (rhc);
 
   TRACE ("take_w_qminv(%p,%"PRId32",%"PRIx32",%"PRIx64") - inst %"PRIu32" nonempty %"PRIu32" disp %"PRIu32" nowr %"PRIu32" new %"PRIu32" samples %"PRIu32"+%"PRIu32" read %"PRIu32"+%"PRIu32"\n", (void*) rhc, *state->limit, state->qminv, handle,
-    rhc->n_instances, rhc->n_nonempty_instances, rhc->n_not_alive_disposed,
-    rhc->n_not_alive_no_writers, rhc->n_new, rhc->n_vsamples,
-    rhc->n_invsamples, rhc->n_vread, rhc->n_invread);
+    rhc->n_instances, rhc_cnt (&rhc->n_nonempty_instances), rhc_cnt (&rhc->n_not_alive_disposed),
+    rhc_cnt (&rhc->n_not_alive_no_writers), rhc_cnt (&rhc->n_new), rhc_cnt (&rhc->n_vsamples),
+    rhc_cnt (&rhc->n_invsamples), rhc_cnt (&rhc->n_vread), rhc_cnt (&rhc->n_invread));
   if (handle)
   {
-    struct rhc_instance template, *inst;
-    template.iid = handle;
-    if ((inst = ddsrt_hh_lookup (rhc->instances, &template)) != NULL)
+    if (inst != NULL)
       rc = take_w_qminv_inst (state, &inst);
     else
       rc = DDS_RETCODE_PRECONDITION_NOT_MET;
   }
   else if (!ddsrt_circlist_isempty (&rhc->nonempty_instances))
   {
-    struct rhc_instance *inst = oldest_nonempty_instance (rhc);
-    uint32_t n_insts = rhc->n_nonempty_instances;
+    inst = oldest_nonempty_instance (rhc);
+    uint32_t n_insts = rhc_cnt (&rhc->n_nonempty_instances);
     while (rc >= 0 && n_insts-- > 0 && *state->limit > 0)
     {
       struct rhc_instance * const inst1 = next_nonempty_instance (inst);
@@ -2397,8 +2627,13 @@ static dds_return_t take_w_qminv (const struct readtake_w_qminv_inst_state *stat
     }
   }
   TRACE ("take: returning %"PRId32" with remaining limit %"PRId32"\n", rc, *state->limit);
-  assert (rhc_check_counts_locked (rhc, true, false));
-  ddsrt_mutex_unlock (&rhc->lock);
+  if (inst_lock)
+    rhc_unlock_shared (rhc, inst_lock);
+  else
+  {
+    assert (rhc_check_counts_locked (rhc, true, false));
+    rhc_unlock (rhc);
+  }
   return rc;
 }
 
@@ -2461,7 +2696,7 @@ static bool dds_rhc_default_add_readcondition (struct dds_rhc *rhc_common, dds_r
 
   cond->m_qminv = qmask_from_dcpsquery (cond->m_sample_states, cond->m_view_states, cond->m_instance_states);
 
-  ddsrt_mutex_lock (&rhc->lock);
+  rhc_lock (rhc);
 
   /* Allocate a slot in the condition bitmasks; return an error no more slots are available */
   if (cond->m_query.m_filter != NULL)
@@ -2475,7 +2710,7 @@ static bool dds_rhc_default_add_readcondition (struct dds_rhc *rhc_common, dds_r
     if (avail_qcmask == 0)
     {
       /* no available indices */
-      ddsrt_mutex_unlock (&rhc->lock);
+      rhc_unlock (rhc);
       return false;
     }
 
@@ -2547,7 +2782,7 @@ static bool dds_rhc_default_add_readcondition (struct dds_rhc *rhc_common, dds_r
     (void *) rhc, cond->m_sample_states, cond->m_view_states,
     cond->m_instance_states, (void *) cond, cond->m_qminv, rhc->nconds);
 
-  ddsrt_mutex_unlock (&rhc->lock);
+  rhc_unlock (rhc);
   return true;
 }
 
@@ -2555,7 +2790,7 @@ static void dds_rhc_default_remove_readcondition (struct dds_rhc *rhc_common, dd
 {
   struct dds_rhc_default * const rhc = (struct dds_rhc_default *) rhc_common;
   dds_readcond **ptr;
-  ddsrt_mutex_lock (&rhc->lock);
+  rhc_lock (rhc);
   ptr = &rhc->conds;
   while (*ptr != cond)
     ptr = &(*ptr)->m_next;
@@ -2573,7 +2808,7 @@ static void dds_rhc_default_remove_readcondition (struct dds_rhc *rhc_common, dd
       rhc->qcond_eval_samplebuf = NULL;
     }
   }
-  ddsrt_mutex_unlock (&rhc->lock);
+  rhc_unlock (rhc);
 }
 
 static bool update_conditions_locked (struct dds_rhc_default *rhc, bool called_from_insert, const struct trigger_info_pre *pre, const struct trigger_info_post *post, const struct trigger_info_qcond *trig_qc, const struct rhc_instance *inst)
@@ -2584,21 +2819,23 @@ static bool update_conditions_locked (struct dds_rhc_default *rhc, bool called_f
   bool m_pre, m_post;
 
   TRACE ("update_conditions_locked(%p %p) - inst %"PRIu32" nonempty %"PRIu32" disp %"PRIu32" nowr %"PRIu32" new %"PRIu32" samples %"PRIu32" read %"PRIu32"\n",
-         (void *) rhc, (void *) inst, rhc->n_instances, rhc->n_nonempty_instances, rhc->n_not_alive_disposed,
-         rhc->n_not_alive_no_writers, rhc->n_new, rhc->n_vsamples, rhc->n_vread);
+         (void *) rhc, (void *) inst, rhc->n_instances, rhc_cnt (&rhc->n_nonempty_instances), rhc_cnt (&rhc->n_not_alive_disposed),
+         rhc_cnt (&rhc->n_not_alive_no_writers), rhc_cnt (&rhc->n_new), rhc_cnt (&rhc->n_vsamples), rhc_cnt (&rhc->n_vread));
   TRACE ("  pre (%"PRIx32",%d,%d) post (%"PRIx32",%d,%d) read -[%d,%d]+[%d,%d] qcmask -[%"PRIx32",%"PRIx32"]+[%"PRIx32",%"PRIx32"]\n",
          pre->c.qminst, pre->c.has_read, pre->c.has_not_read,
          post->c.qminst, post->c.has_read, post->c.has_not_read,
          trig_qc->dec_invsample_read, trig_qc->dec_sample_read, trig_qc->inc_invsample_read, trig_qc->inc_sample_read,
          trig_qc->dec_conds_invsample, trig_qc->dec_conds_sample, trig_qc->inc_conds_invsample, trig_qc->inc_conds_sample);
 
-  assert (rhc->n_nonempty_instances >= rhc->n_not_alive_disposed + rhc->n_not_alive_no_writers);
+  /* The counters are not necessarily mutually consistent while they are
+     being updated concurrently */
+  assert (rhc->concurrent || rhc_cnt (&rhc->n_nonempty_instances) >= rhc_cnt (&rhc->n_not_alive_disposed) + rhc_cnt (&rhc->n_not_alive_no_writers));
 #ifndef DDS_HAS_LIFESPAN
   /* If lifespan is disabled, samples cannot expire and therefore
      empty instances cannot be in the 'new' state. */
-  assert (rhc->n_nonempty_instances >= rhc->n_new);
+  assert (rhc->concurrent || rhc_cnt (&rhc->n_nonempty_instances) >= rhc_cnt (&rhc->n_new));
 #endif
-  assert (rhc->n_vsamples >= rhc->n_vread);
+  assert (rhc->concurrent || rhc_cnt (&rhc->n_vsamples) >= rhc_cnt (&rhc->n_vread));
 
   iter = rhc->conds;
   while (iter)
@@ -2959,14 +3196,14 @@ static bool rhc_check_counts_locked (struct dds_rhc_default *rhc, bool check_con
   }
 
   assert (rhc->n_instances == n_instances);
-  assert (rhc->n_nonempty_instances == n_nonempty_instances);
-  assert (rhc->n_not_alive_disposed == n_not_alive_disposed);
-  assert (rhc->n_not_alive_no_writers == n_not_alive_no_writers);
-  assert (rhc->n_new == n_new);
-  assert (rhc->n_vsamples == n_vsamples);
-  assert (rhc->n_vread == n_vread);
-  assert (rhc->n_invsamples == n_invsamples);
-  assert (rhc->n_invread == n_invread);
+  assert (rhc_cnt (&rhc->n_nonempty_instances) == n_nonempty_instances);
+  assert (rhc_cnt (&rhc->n_not_alive_disposed) == n_not_alive_disposed);
+  assert (rhc_cnt (&rhc->n_not_alive_no_writers) == n_not_alive_no_writers);
+  assert (rhc_cnt (&rhc->n_new) == n_new);
+  assert (rhc_cnt (&rhc->n_vsamples) == n_vsamples);
+  assert (rhc_cnt (&rhc->n_vread) == n_vread);
+  assert (rhc_cnt (&rhc->n_invsamples) == n_invsamples);
+  assert (rhc_cnt (&rhc->n_invread) == n_invread);
 
   if (check_conds)
   {
@@ -2974,7 +3211,7 @@ static bool rhc_check_counts_locked (struct dds_rhc_default *rhc, bool check_con
       assert (cond_match_count[i] == ddsrt_atomic_ld32 (&rciter->m_entity.m_status.m_trigger));
   }
 
-  if (rhc->n_nonempty_instances == 0)
+  if (rhc_cnt (&rhc->n_nonempty_instances) == 0)
   {
     assert (ddsrt_circlist_isempty (&rhc->nonempty_instances));
   }
@@ -2993,7 +3230,7 @@ static bool rhc_check_counts_locked (struct dds_rhc_default *rhc, bool check_con
       inst = next_nonempty_instance (inst);
       n_nonempty_instances++;
     } while (inst != end);
-    assert (rhc->n_nonempty_instances == n_nonempty_instances);
+    assert (rhc_cnt (&rhc->n_nonempty_instances) == n_nonempty_instances);
   }
 
   return true;
@@ -17,7 +17,6 @@
 #include "dds/ddsrt/log.h"
 #include "dds/ddsrt/md5.h"
 #include "dds/ddsrt/mh3.h"
-#include "dds/ddsi/ddsi_freelist.h"
 #include "dds/ddsi/ddsi_tkmap.h"
 #include "dds/cdr/dds_cdrstream.h"
 #include "dds/ddsi/ddsi_radmin.h" /* sampleinfo */
@@ -65,12 +64,15 @@
 */
 
 
-/* 8k entries in the freelist seems to be roughly the amount needed to send
+/* 8k entries in the pool seems to be roughly the amount needed to send
    minimum-size (well, 4 bytes) samples as fast as possible over loopback
    while using large messages -- actually, it stands to reason that this would
-   be the same as the WHC node pool size */
+   be the same as the WHC node pool size.  For larger samples the number is
+   limited by the amount of memory held by a size class. */
 #define MAX_POOL_SIZE 8192
-#define MAX_SIZE_FOR_POOL 256
+#define MAX_POOL_BYTES_PER_CLASS (8 * 1024 * 1024)
+#define MIN_SIZE_FOR_POOL 128
+#define MAX_SIZE_FOR_POOL 65536
 #define DEFAULT_NEW_SIZE 128
 #define CHUNK_SIZE 128
 
@@ -83,14 +85,6 @@ static int ispowerof2_size (size_t x)
 }
 #endif
 
-struct dds_serdatapool * dds_serdatapool_new (void)
-{
-  struct dds_serdatapool * pool;
-  pool = ddsrt_malloc (sizeof (*pool));
-  ddsi_freelist_init (&pool->freelist, MAX_POOL_SIZE, offsetof (struct dds_serdata_default, next));
-  return pool;
-}
-
 static void serdata_free_wrap (void *elem)
 {
 #ifndef NDEBUG
@@ -100,12 +94,41 @@ static void serdata_free_wrap (void *elem)
   dds_free(elem);
 }
 
+struct dds_serdatapool * dds_serdatapool_new (void)
+{
+  struct dds_serdatapool * pool;
+  pool = ddsrt_malloc (sizeof (*pool));
+  pool->mempool = ddsi_mempool_new (MIN_SIZE_FOR_POOL, MAX_SIZE_FOR_POOL, MAX_POOL_SIZE, MAX_POOL_BYTES_PER_CLASS, serdata_free_wrap);
+  return pool;
+}
+
 void dds_serdatapool_free (struct dds_serdatapool * pool)
 {
-  ddsi_freelist_fini (&pool->freelist, serdata_free_wrap);
+  ddsi_mempool_free (pool->mempool);
   ddsrt_free (pool);
 }
 
+void dds_serdatapool_reserve (struct dds_serdatapool * pool, uint32_t size, uint32_t n)
+{
+  /* Objects put in the pool end up in the magazine of the calling thread first,
+     which is usually the thread that will be writing the data */
+  size = ddsi_mempool_class_size (pool->mempool, size);
+  if (size > MAX_SIZE_FOR_POOL)
+    return;
+  for (uint32_t i = 0; i < n; i++)
+  {
+    struct dds_serdata_default *d = ddsrt_malloc (offsetof (struct dds_serdata_default, data) + size);
+    d->size = size;
+    d->serpool = pool;
+    ddsrt_atomic_st32 (&d->c.refc, 0);
+    if (!ddsi_mempool_put (pool->mempool, d, size))
+    {
+      ddsrt_free (d);
+      break;
+    }
+  }
+}
+
 static size_t alignup_size (size_t x, size_t a)
 {
   size_t m = a-1;
@@ -182,7 +205,7 @@ static void serdata_default_free(struct ddsi_serdata *dcmn)
     ddsrt_free (d->key.u.dynbuf);
   if (d->c.loan)
     dds_loaned_sample_unref (d->c.loan);
-  if (d->size > MAX_SIZE_FOR_POOL || !ddsi_freelist_push (&d->serpool->freelist, d))
+  if (!ddsi_mempool_put (d->serpool->mempool, d, d->size))
     dds_free (d);
 }
 
@@ -213,8 +236,13 @@ static struct dds_serdata_default *serdata_default_allocnew (struct dds_serdatap
 static struct dds_serdata_default *serdata_default_new_size (const struct dds_sertype_default *tp, enum ddsi_serdata_kind kind, uint32_t size, uint32_t xcdr_version)
 {
   struct dds_serdata_default *d;
-  if (size <= MAX_SIZE_FOR_POOL && (d = ddsi_freelist_pop (&tp->serpool->freelist)) != NULL)
+  // the pool rounds the size up to that of the size class, a cached object may
+  // be larger than the size class but never smaller
+  if ((d = ddsi_mempool_get (tp->serpool->mempool, &size)) != NULL)
+  {
+    d->size = size;
     ddsrt_atomic_st32 (&d->c.refc, 1);
+  }
   else if ((d = serdata_default_allocnew (tp->serpool, size)) == NULL)
     return NULL;
   serdata_default_init (d, tp, kind, xcdr_version);
@@ -568,7 +596,7 @@ static void ostream_add_to_serdata_default (dds_ostream_t *s, struct dds_serdata
 static struct dds_serdata_default *serdata_default_from_sample_cdr_common (const struct ddsi_sertype *tpcmn, enum ddsi_serdata_kind kind, uint32_t xcdr_version, const void *sample)
 {
   const struct dds_sertype_default *tp = (const struct dds_sertype_default *)tpcmn;
-  struct dds_serdata_default *d = serdata_default_new(tp, kind, xcdr_version);
+  struct dds_serdata_default *d = serdata_default_new_size (tp, kind, (kind == SDK_DATA && tp->serdata_init_size > 0) ? tp->serdata_init_size : DEFAULT_NEW_SIZE, xcdr_version);
   if (d == NULL)
     return NULL;
 
@@ -28,6 +28,10 @@
 #include "dds__serdata_default.h"
 #include "dds__psmx.h"
 
+/* Number of serdata added to the pool when creating a type with a fixed serialised
+   size, this is the size of the per-thread magazines in the pool */
+#define SERDATA_RESERVE 32
+
 static bool sertype_default_equal (const struct ddsi_sertype *acmn, const struct ddsi_sertype *bcmn)
 {
   const struct dds_sertype_default *a = (struct dds_sertype_default *) acmn;
@@ -112,6 +116,9 @@ static void sertype_default_free (struct ddsi_sertype *tpcmn)
   struct dds_sertype_default *tp = (struct dds_sertype_default *) tpcmn;
   if (tp->type.keys.nkeys > 0)
   {
+    for (uint32_t i = 0; i < tp->type.keys.nkeys; i++)
+      dds_free (tp->key_names[i]);
+    dds_free (tp->key_names);
     dds_free (tp->type.keys.keys);
     dds_free (tp->type.keys.keys_definition_order);
   }
@@ -301,6 +308,15 @@ dds_return_t dds_sertype_default_init (const struct dds_domain *domain, struct d
   st->serpool = domain->serpool;
 
   dds_cdrstream_desc_init (&st->type, &dds_cdrstream_default_allocator, desc->m_size, desc->m_align, desc->m_flagset, desc->m_ops, desc->m_keys, desc->m_nkeys);
+  if (desc->m_flagset & DDS_TOPIC_GEN_SERIALIZERS)
+    st->type.gen_ops = desc->m_gen_ops;
+  st->key_names = NULL;
+  if (desc->m_nkeys > 0)
+  {
+    st->key_names = ddsrt_malloc (desc->m_nkeys * sizeof (*st->key_names));
+    for (uint32_t i = 0; i < desc->m_nkeys; i++)
+      st->key_names[desc->m_keys[i].m_idx] = ddsrt_strdup (desc->m_keys[i].m_name);
+  }
 
   if (min_xcdrv == DDSI_RTPS_CDR_ENC_VERSION_2 && dds_stream_type_nesting_depth (desc->m_ops) > DDS_CDRSTREAM_MAX_NESTING_DEPTH)
   {
@@ -339,5 +355,16 @@ dds_return_t dds_sertype_default_init (const struct dds_domain *domain, struct d
   if (st->type.opt_size_xcdr2 > 0)
     GVTRACE ("Marshalling XCDR2 for type: %s is %soptimised\n", st->c.type_name, st->type.opt_size_xcdr2 ? "" : "not ");
 
+  /* If the serialised size is fixed, allocate that much when serialising a sample so
+     it never needs to be reallocated, and pre-populate the serdata pool so that even
+     the first samples don't require an allocation. 0 means use the default size. */
+  const size_t opt_size = (st->write_encoding_version == DDSI_RTPS_CDR_ENC_VERSION_1) ? st->type.opt_size_xcdr1 : st->type.opt_size_xcdr2;
+  if (opt_size == 0 || opt_size > UINT32_MAX - 3)
+    st->serdata_init_size = 0;
+  else
+  {
+    st->serdata_init_size = ((uint32_t) opt_size + 3) & ~(uint32_t) 3;
+    dds_serdatapool_reserve (st->serpool, st->serdata_init_size, SERDATA_RESERVE);
+  }
   return DDS_RETCODE_OK;
 }
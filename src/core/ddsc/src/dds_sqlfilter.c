@@ -0,0 +1,1413 @@
+// Copyright(c) 2025 ZettaScale Technology and others
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License v. 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Eclipse Distribution License
+// v. 1.0 which is available at
+// http://www.eclipse.org/org/documents/edl-v10.php.
+//
+// SPDX-License-Identifier: EPL-2.0 OR BSD-3-Clause
+
+#include <assert.h>
+#include <string.h>
+#include <ctype.h>
+
+#include "dds/ddsrt/heap.h"
+#include "dds/ddsrt/string.h"
+#include "dds/ddsrt/strtol.h"
+#include "dds/ddsrt/strtod.h"
+#include "dds/ddsi/ddsi_serdata.h"
+#include "dds/ddsi/ddsi_sertype.h"
+#include "dds/ddsi/ddsi_typelib.h"
+#include "dds/ddsc/dds_opcodes.h"
+#include "dds/ddsc/dds_loaned_sample.h"
+#include "dds/cdr/dds_cdrstream.h"
+#include "dds__serdata_default.h"
+#include "dds__sqlfilter.h"
+
+/* Filter expressions (DDS spec, annex B) are compiled into a short program that
+ * is evaluated on the serialized sample.  Key fields are taken from the serialized
+ * key, which is native-endian XCDR2 and, for types where all key fields are in
+ * types with final extensibility, simply the key fields in definition order.
+ * Other top-level members of final and appendable types are taken from the
+ * serialized data, which is native-endian XCDR1 or XCDR2.  Their names are looked
+ * up in the type information, where the members are in the same order as in the
+ * serializer instructions.  So evaluating the filter requires no
+ * deserialisation, just walking the fields of the key and the members in the
+ * data up to the last one referenced in the expression.
+ *
+ * Comparisons and LIKE set a single boolean register, NOT inverts it, and AND and
+ * OR short-circuit by conditionally jumping over the right-hand side.  That means
+ * the program needs no stack.
+ *
+ * Literals and parameters are converted to constants at compile time, and type
+ * errors (comparing a string with a number, for example) are detected then as
+ * well. */
+
+#define MAX_PARAMS 100
+#define MAX_NESTING 64
+#define MAX_STACK_FIELDS 16
+
+enum sqlf_vtype {
+  VT_BOOL,
+  VT_INT,
+  VT_UINT,
+  VT_DOUBLE,
+  VT_STRING
+};
+
+struct sqlf_value {
+  enum sqlf_vtype t;
+  union {
+    bool b;
+    int64_t i;
+    uint64_t u;
+    double d;
+    struct { const char *s; uint32_t n; } s; /* n excludes the terminating 0 */
+  } u;
+};
+
+enum sqlf_cmpop { CMP_EQ, CMP_NE, CMP_LT, CMP_LE, CMP_GT, CMP_GE };
+
+enum sqlf_opcode {
+  SQLF_CONST, /* r = b */
+  SQLF_CMP,   /* r = a cmp b */
+  SQLF_LIKE,  /* r = a LIKE b */
+  SQLF_NOT,   /* r = !r */
+  SQLF_JF,    /* if !r goto target */
+  SQLF_JT     /* if r goto target */
+};
+
+enum sqlf_opndkind {
+  OPND_CONST,  /* constant */
+  OPND_KEY,    /* key field, taken from the serialized key */
+  OPND_MEMBER  /* top-level member, taken from the serialized data */
+};
+
+struct sqlf_operand {
+  enum sqlf_opndkind kind;
+  uint32_t idx; /* key field index in definition order, member index, or index in constants */
+  enum sqlf_vtype t;
+};
+
+struct sqlf_insn {
+  enum sqlf_opcode opc;
+  enum sqlf_cmpop cmp;
+  bool b;
+  uint32_t target;
+  struct sqlf_operand a, b_opnd;
+};
+
+struct dds_sqlfilter {
+  struct ddsi_content_filter_property prop;
+  uint32_t nfields;     /* number of key fields to extract: highest one referenced + 1 */
+  uint32_t *field_insn; /* serializer instruction for each of these key fields */
+  uint32_t nmembers;    /* number of members to extract: highest one referenced + 1 */
+  bool *member_ref;     /* whether each of these members is referenced or only skipped */
+  bool delimited;       /* whether the data starts with a DHEADER (appendable type) */
+  const uint32_t *member_ops; /* serializer instructions of the members, owned by the type */
+  uint32_t nconsts;
+  struct sqlf_value *consts;
+  uint32_t ninsns;
+  struct sqlf_insn *insns;
+};
+
+enum sqlf_tokkind {
+  TK_END,
+  TK_IDENT,
+  TK_CONST,
+  TK_CMP,
+  TK_AND,
+  TK_OR,
+  TK_NOT,
+  TK_BETWEEN,
+  TK_LIKE,
+  TK_LPAREN,
+  TK_RPAREN
+};
+
+struct sqlf_token {
+  enum sqlf_tokkind kind;
+  const char *s;        /* start of identifier */
+  size_t len;           /* length of identifier */
+  uint32_t idx;         /* index in constants */
+  enum sqlf_cmpop cmp;
+};
+
+struct sqlf_parser {
+  const struct dds_sertype_default *type; /* NULL if not a default sertype */
+  uint32_t nparams;
+  const char * const *params;
+  const char *src;
+  struct sqlf_token tok;
+  uint32_t depth;
+  struct dds_sqlfilter *f;
+  uint32_t maxconsts, maxinsns;
+#ifdef DDS_HAS_TYPELIB
+  bool typemap_loaded;
+  ddsi_typemap_t *typemap;
+  const struct DDS_XTypes_CompleteStructType *struct_type; /* NULL if no type information */
+#endif
+};
+
+static bool get_field_vtype (uint32_t insn, enum sqlf_vtype *t)
+{
+  switch (DDS_OP_TYPE (insn))
+  {
+    case DDS_OP_VAL_BLN:
+      *t = VT_BOOL;
+      return true;
+    case DDS_OP_VAL_1BY: case DDS_OP_VAL_2BY: case DDS_OP_VAL_4BY: case DDS_OP_VAL_8BY:
+      *t = (insn & DDS_OP_FLAG_FP) ? VT_DOUBLE : (insn & DDS_OP_FLAG_SGN) ? VT_INT : VT_UINT;
+      return true;
+    case DDS_OP_VAL_ENU: case DDS_OP_VAL_BMK:
+      *t = VT_UINT;
+      return true;
+    case DDS_OP_VAL_STR: case DDS_OP_VAL_BST:
+      *t = VT_STRING;
+      return true;
+    default:
+      /* arrays and wide strings are not supported */
+      return false;
+  }
+}
+
+static bool is_numeric (enum sqlf_vtype t)
+{
+  return t == VT_INT || t == VT_UINT || t == VT_DOUBLE;
+}
+
+static bool compatible_types (enum sqlf_vtype a, enum sqlf_vtype b)
+{
+  return (a == b) || (is_numeric (a) && is_numeric (b));
+}
+
+static double value_as_double (const struct sqlf_value *v)
+{
+  switch (v->t)
+  {
+    case VT_INT: return (double) v->u.i;
+    case VT_UINT: return (double) v->u.u;
+    case VT_DOUBLE: return v->u.d;
+    default: assert (0); return 0.0;
+  }
+}
+
+/* returns -1, 0, 1, or 2 if unordered (NaN); types must be compatible */
+static int compare_values (const struct sqlf_value *a, const struct sqlf_value *b)
+{
+  if (a->t == VT_DOUBLE || b->t == VT_DOUBLE)
+  {
+    const double x = value_as_double (a), y = value_as_double (b);
+    return (x < y) ? -1 : (x > y) ? 1 : (x == y) ? 0 : 2;
+  }
+  switch (a->t)
+  {
+    case VT_BOOL:
+      assert (b->t == VT_BOOL);
+      return (a->u.b == b->u.b) ? 0 : a->u.b ? 1 : -1;
+    case VT_INT:
+      if (b->t == VT_INT)
+        return (a->u.i < b->u.i) ? -1 : (a->u.i > b->u.i);
+      assert (b->t == VT_UINT);
+      return (a->u.i < 0) ? -1 : ((uint64_t) a->u.i < b->u.u) ? -1 : ((uint64_t) a->u.i > b->u.u);
+    case VT_UINT:
+      if (b->t == VT_UINT)
+        return (a->u.u < b->u.u) ? -1 : (a->u.u > b->u.u);
+      assert (b->t == VT_INT);
+      return (b->u.i < 0) ? 1 : (a->u.u < (uint64_t) b->u.i) ? -1 : (a->u.u > (uint64_t) b->u.i);
+    case VT_STRING: {
+      assert (b->t == VT_STRING);
+      const uint32_t n = (a->u.s.n < b->u.s.n) ? a->u.s.n : b->u.s.n;
+      const int c = memcmp (a->u.s.s, b->u.s.s, n);
+      if (c != 0)
+        return (c < 0) ? -1 : 1;
+      return (a->u.s.n < b->u.s.n) ? -1 : (a->u.s.n > b->u.s.n);
+    }
+    case VT_DOUBLE:
+      break;
+  }
+  assert (0);
+  return 2;
+}
+
+static bool eval_cmp (enum sqlf_cmpop op, const struct sqlf_value *a, const struct sqlf_value *b)
+{
+  const int c = compare_values (a, b);
+  switch (op)
+  {
+    case CMP_EQ: return c == 0;
+    case CMP_NE: return c != 0;
+    case CMP_LT: return c == -1;
+    case CMP_LE: return c == -1 || c == 0;
+    case CMP_GT: return c == 1;
+    case CMP_GE: return c == 1 || c == 0;
+  }
+  return false;
+}
+
+/* '%' matches any sequence of characters, '_' any single character */
+static bool eval_like (const struct sqlf_value *a, const struct sqlf_value *pat)
+{
+  const char *s = a->u.s.s, *p = pat->u.s.s;
+  const uint32_t n = a->u.s.n, m = pat->u.s.n;
+  uint32_t si = 0, pi = 0, star_pi = UINT32_MAX, star_si = 0;
+  while (si < n)
+  {
+    if (pi < m && p[pi] == '%')
+    {
+      star_pi = pi++;
+      star_si = si;
+    }
+    else if (pi < m && (p[pi] == '_' || p[pi] == s[si]))
+    {
+      si++;
+      pi++;
+    }
+    else if (star_pi != UINT32_MAX)
+    {
+      pi = star_pi + 1;
+      si = ++star_si;
+    }
+    else
+    {
+      return false;
+    }
+  }
+  while (pi < m && p[pi] == '%')
+    pi++;
+  return pi == m;
+}
+
+/*************************************
+ * Tokenizer
+ *************************************/
+
+static uint32_t add_const (struct sqlf_parser *p, const struct sqlf_value *v)
+{
+  struct dds_sqlfilter * const f = p->f;
+  if (f->nconsts == p->maxconsts)
+  {
+    p->maxconsts = (p->maxconsts == 0) ? 4 : 2 * p->maxconsts;
+    f->consts = ddsrt_realloc (f->consts, p->maxconsts * sizeof (*f->consts));
+  }
+  f->consts[f->nconsts] = *v;
+  return f->nconsts++;
+}
+
+static bool is_ident_start (char c)
+{
+  return isalpha ((unsigned char) c) || c == '_';
+}
+
+static bool is_ident_char (char c)
+{
+  return isalnum ((unsigned char) c) || c == '_' || c == '.';
+}
+
+static bool is_keyword (const struct sqlf_token *tok, const char *kw)
+{
+  return strlen (kw) == tok->len && ddsrt_strncasecmp (tok->s, kw, tok->len) == 0;
+}
+
+static dds_return_t lex_string (struct sqlf_parser *p, const char **src, struct sqlf_token *tok)
+{
+  const char *s = *src + 1;
+  size_t n = 0;
+  // first pass: find the end and the length after replacing '' by '
+  for (const char *q = s; ; q++)
+  {
+    if (*q == 0)
+      return DDS_RETCODE_BAD_PARAMETER;
+    else if (*q == '\'' && q[1] == '\'')
+      q++;
+    else if (*q == '\'')
+      break;
+    n++;
+  }
+  if (n >= UINT32_MAX)
+    return DDS_RETCODE_BAD_PARAMETER;
+  char *str = ddsrt_malloc (n + 1);
+  size_t i = 0;
+  while (!(s[0] == '\'' && s[1] != '\''))
+  {
+    str[i++] = *s;
+    s += (s[0] == '\'') ? 2 : 1;
+  }
+  str[i] = 0;
+  *src = s + 1;
+  struct sqlf_value v = { .t = VT_STRING, .u = { .s = { .s = str, .n = (uint32_t) n } } };
+  tok->kind = TK_CONST;
+  tok->idx = add_const (p, &v);
+  return DDS_RETCODE_OK;
+}
+
+static dds_return_t lex_number (struct sqlf_parser *p, const char **src, struct sqlf_token *tok)
+{
+  const char *s = *src, *q = s;
+  const bool neg = (*q == '-');
+  bool hex = false, fp = false;
+  struct sqlf_value v;
+  char *end;
+  if (neg)
+    q++;
+  if (q[0] == '0' && (q[1] == 'x' || q[1] == 'X'))
+  {
+    hex = true;
+    q += 2;
+    if (!isxdigit ((unsigned char) *q))
+      return DDS_RETCODE_BAD_PARAMETER;
+    while (isxdigit ((unsigned char) *q))
+      q++;
+  }
+  else
+  {
+    while (isdigit ((unsigned char) *q))
+      q++;
+    if (*q == '.' && isdigit ((unsigned char) q[1]))
+    {
+      fp = true;
+      q++;
+      while (isdigit ((unsigned char) *q))
+        q++;
+    }
+    if ((*q == 'e' || *q == 'E') && (isdigit ((unsigned char) q[1]) || ((q[1] == '-' || q[1] == '+') && isdigit ((unsigned char) q[2]))))
+    {
+      fp = true;
+      q += 2;
+      while (isdigit ((unsigned char) *q))
+        q++;
+    }
+  }
+  if (is_ident_char (*q))
+    return DDS_RETCODE_BAD_PARAMETER;
+
+  if (fp)
+  {
+    v.t = VT_DOUBLE;
+    if (ddsrt_strtod (s, &end, &v.u.d) != DDS_RETCODE_OK || end != q)
+      return DDS_RETCODE_BAD_PARAMETER;
+  }
+  else if (neg)
+  {
+    long long x;
+    v.t = VT_INT;
+    if (ddsrt_strtoll (s, &end, hex ? 16 : 10, &x) != DDS_RETCODE_OK || end != q)
+      return DDS_RETCODE_BAD_PARAMETER;
+    v.u.i = (int64_t) x;
+  }
+  else
+  {
+    unsigned long long x;
+    v.t = VT_UINT;
+    if (ddsrt_strtoull (s, &end, hex ? 16 : 10, &x) != DDS_RETCODE_OK || end != q)
+      return DDS_RETCODE_BAD_PARAMETER;
+    v.u.u = (uint64_t) x;
+  }
+  *src = q;
+  tok->kind = TK_CONST;
+  tok->idx = add_const (p, &v);
+  return DDS_RETCODE_OK;
+}
+
+static dds_return_t lex_param (struct sqlf_parser *p, const char *param, struct sqlf_token *tok);
+
+static dds_return_t lex (struct sqlf_parser *p, const char **src, struct sqlf_token *tok, bool in_param)
+{
+  const char *s = *src;
+  while (isspace ((unsigned char) *s))
+    s++;
+  *src = s;
+  if (*s == 0)
+  {
+    tok->kind = TK_END;
+    return DDS_RETCODE_OK;
+  }
+  else if (is_ident_start (*s))
+  {
+    const char *q = s + 1;
+    while (is_ident_char (*q))
+      q++;
+    *src = q;
+    tok->kind = TK_IDENT;
+    tok->s = s;
+    tok->len = (size_t) (q - s);
+    if (is_keyword (tok, "AND"))
+      tok->kind = TK_AND;
+    else if (is_keyword (tok, "OR"))
+      tok->kind = TK_OR;
+    else if (is_keyword (tok, "NOT"))
+      tok->kind = TK_NOT;
+    else if (is_keyword (tok, "BETWEEN"))
+      tok->kind = TK_BETWEEN;
+    else if (is_keyword (tok, "LIKE"))
+      tok->kind = TK_LIKE;
+    else if (is_keyword (tok, "TRUE") || is_keyword (tok, "FALSE"))
+    {
+      struct sqlf_value v = { .t = VT_BOOL, .u = { .b = is_keyword (tok, "TRUE") } };
+      tok->kind = TK_CONST;
+      tok->idx = add_const (p, &v);
+    }
+    return DDS_RETCODE_OK;
+  }
+  else if (isdigit ((unsigned char) *s) || (*s == '-' && isdigit ((unsigned char) s[1])))
+  {
+    return lex_number (p, src, tok);
+  }
+  else if (*s == '\'')
+  {
+    return lex_string (p, src, tok);
+  }
+  else if (*s == '%' && !in_param && isdigit ((unsigned char) s[1]))
+  {
+    uint32_t n = (uint32_t) (s[1] - '0');
+    s += 2;
+    if (isdigit ((unsigned char) *s))
+      n = 10 * n + (uint32_t) (*s++ - '0');
+    if (isdigit ((unsigned char) *s) || n >= p->nparams)
+      return DDS_RETCODE_BAD_PARAMETER;
+    *src = s;
+    return lex_param (p, p->params[n], tok);
+  }
+
+  tok->kind = TK_CMP;
+  switch (*s++)
+  {
+    case '(': tok->kind = TK_LPAREN; break;
+    case ')': tok->kind = TK_RPAREN; break;
+    case '=': tok->cmp = CMP_EQ; break;
+    case '<':
+      if (*s == '=') { tok->cmp = CMP_LE; s++; }
+      else if (*s == '>') { tok->cmp = CMP_NE; s++; }
+      else { tok->cmp = CMP_LT; }
+      break;
+    case '>':
+      if (*s == '=') { tok->cmp = CMP_GE; s++; }
+      else { tok->cmp = CMP_GT; }
+      break;
+    case '!':
+      if (*s++ != '=')
+        return DDS_RETCODE_BAD_PARAMETER;
+      tok->cmp = CMP_NE;
+      break;
+    default:
+      return DDS_RETCODE_BAD_PARAMETER;
+  }
+  *src = s;
+  return DDS_RETCODE_OK;
+}
+
+/* A parameter must be a single literal */
+static dds_return_t lex_param (struct sqlf_parser *p, const char *param, struct sqlf_token *tok)
+{
+  struct sqlf_token end;
+  dds_return_t rc;
+  if (param == NULL)
+    return DDS_RETCODE_BAD_PARAMETER;
+  if ((rc = lex (p, &param, tok, true)) != DDS_RETCODE_OK)
+    return rc;
+  if (tok->kind != TK_CONST)
+    return DDS_RETCODE_BAD_PARAMETER;
+  if ((rc = lex (p, &param, &end, true)) != DDS_RETCODE_OK)
+    return rc;
+  return (end.kind == TK_END) ? DDS_RETCODE_OK : DDS_RETCODE_BAD_PARAMETER;
+}
+
+static dds_return_t next (struct sqlf_parser *p)
+{
+  return lex (p, &p->src, &p->tok, false);
+}
+
+/*************************************
+ * Parser/code generator
+ *************************************/
+
+static uint32_t emit (struct sqlf_parser *p, const struct sqlf_insn *insn)
+{
+  struct dds_sqlfilter * const f = p->f;
+  if (f->ninsns == p->maxinsns)
+  {
+    p->maxinsns = (p->maxinsns == 0) ? 8 : 2 * p->maxinsns;
+    f->insns = ddsrt_realloc (f->insns, p->maxinsns * sizeof (*f->insns));
+  }
+  f->insns[f->ninsns] = *insn;
+  return f->ninsns++;
+}
+
+static uint32_t emit_simple (struct sqlf_parser *p, enum sqlf_opcode opc)
+{
+  return emit (p, &(struct sqlf_insn){ .opc = opc });
+}
+
+static void patch_jump (struct sqlf_parser *p, uint32_t at)
+{
+  assert (p->f->insns[at].opc == SQLF_JF || p->f->insns[at].opc == SQLF_JT);
+  p->f->insns[at].target = p->f->ninsns;
+}
+
+static const struct sqlf_value *operand_value (const struct dds_sqlfilter *f, const struct sqlf_value *fields, const struct sqlf_value *members, const struct sqlf_operand *o)
+{
+  switch (o->kind)
+  {
+    case OPND_KEY: return &fields[o->idx];
+    case OPND_MEMBER: return &members[o->idx];
+    case OPND_CONST: break;
+  }
+  return &f->consts[o->idx];
+}
+
+static dds_return_t emit_cmp (struct sqlf_parser *p, enum sqlf_opcode opc, enum sqlf_cmpop cmp, const struct sqlf_operand *a, const struct sqlf_operand *b)
+{
+  if (opc == SQLF_LIKE ? (a->t != VT_STRING || b->t != VT_STRING) : !compatible_types (a->t, b->t))
+    return DDS_RETCODE_BAD_PARAMETER;
+  if (a->kind == OPND_CONST && b->kind == OPND_CONST)
+  {
+    const struct sqlf_value *x = operand_value (p->f, NULL, NULL, a), *y = operand_value (p->f, NULL, NULL, b);
+    const bool r = (opc == SQLF_LIKE) ? eval_like (x, y) : eval_cmp (cmp, x, y);
+    (void) emit (p, &(struct sqlf_insn){ .opc = SQLF_CONST, .b = r });
+  }
+  else
+  {
+    (void) emit (p, &(struct sqlf_insn){ .opc = opc, .cmp = cmp, .a = *a, .b_opnd = *b });
+  }
+  return DDS_RETCODE_OK;
+}
+
+static bool is_base (uint32_t insn)
+{
+  return DDS_OP_TYPE (insn) == DDS_OP_VAL_EXT && (insn & DDS_OP_FLAG_BASE);
+}
+
+/* Serializer instructions of the members of the top-level type, skipping the DLC
+   of an appendable type; NULL for a mutable type */
+static const uint32_t *top_level_member_ops (const struct dds_sertype_default *tp, bool *delimited)
+{
+  const uint32_t *ops = tp->type.ops.ops;
+  *delimited = (*ops == DDS_OP_DLC);
+  if (*ops == DDS_OP_PLC)
+    return NULL;
+  return *delimited ? ops + 1 : ops;
+}
+
+/* Instruction of top-level member m, not counting the base type's instruction */
+static const uint32_t *member_op (const uint32_t *ops, uint32_t m)
+{
+  while (is_base (*ops) || m > 0)
+  {
+    if (!is_base (*ops))
+      m--;
+    ops = dds_stream_skip_adr (*ops, ops);
+  }
+  return ops;
+}
+
+#ifdef DDS_HAS_TYPELIB
+static const struct DDS_XTypes_CompleteStructType *get_struct_type (struct sqlf_parser *p)
+{
+  if (!p->typemap_loaded)
+  {
+    ddsi_typeid_t *type_id;
+    p->typemap_loaded = true;
+    if ((p->typemap = ddsi_sertype_typemap (&p->type->c)) == NULL)
+      return NULL;
+    if ((type_id = ddsi_sertype_typeid (&p->type->c, DDSI_TYPEID_KIND_COMPLETE)) != NULL)
+    {
+      const struct DDS_XTypes_TypeObject *type_obj = ddsi_typemap_get_typeobj (p->typemap, type_id);
+      if (type_obj && type_obj->_d == DDS_XTypes_EK_COMPLETE && type_obj->_u.complete._d == DDS_XTypes_TK_STRUCTURE)
+        p->struct_type = &type_obj->_u.complete._u.struct_type;
+      ddsi_typeid_fini (type_id);
+      ddsrt_free (type_id);
+    }
+  }
+  return p->struct_type;
+}
+
+static bool find_member (const struct DDS_XTypes_CompleteStructType *st, const char *name, size_t len, uint32_t *m)
+{
+  for (*m = 0; *m < st->member_seq._length; (*m)++)
+  {
+    const char *n = st->member_seq._buffer[*m].detail.name;
+    if (strlen (n) == len && memcmp (n, name, len) == 0)
+      return true;
+  }
+  return false;
+}
+#endif
+
+/* Looks up a top-level member by name in the complete type object, the members
+   in there are in the same order as the serializer instructions */
+static dds_return_t lookup_member (struct sqlf_parser *p, const struct sqlf_token *tok, uint32_t nmembers, uint32_t *m)
+{
+#ifdef DDS_HAS_TYPELIB
+  const struct DDS_XTypes_CompleteStructType *st = get_struct_type (p);
+  const char *dot;
+  if (st == NULL || st->member_seq._length != nmembers)
+    return DDS_RETCODE_UNSUPPORTED;
+  if (find_member (st, tok->s, tok->len, m))
+    return DDS_RETCODE_OK;
+  // members of a base type or of a nested struct may exist, but are not supported
+  if (st->header.base_type._d != DDS_XTypes_TK_NONE)
+    return DDS_RETCODE_UNSUPPORTED;
+  if ((dot = memchr (tok->s, '.', tok->len)) != NULL && find_member (st, tok->s, (size_t) (dot - tok->s), m))
+    return DDS_RETCODE_UNSUPPORTED;
+  return DDS_RETCODE_BAD_PARAMETER;
+#else
+  (void) p; (void) tok; (void) nmembers; (void) m;
+  return DDS_RETCODE_UNSUPPORTED;
+#endif
+}
+
+static dds_return_t resolve_member (struct sqlf_parser *p, const struct sqlf_token *tok, struct sqlf_operand *o)
+{
+  struct dds_sqlfilter * const f = p->f;
+  const uint32_t *ops, *op;
+  uint32_t m, nmembers = 0;
+  bool delimited;
+  dds_return_t rc;
+  if (p->type == NULL || (ops = top_level_member_ops (p->type, &delimited)) == NULL)
+    return DDS_RETCODE_UNSUPPORTED;
+  for (op = ops; *op != DDS_OP_RTS; op = dds_stream_skip_adr (*op, op))
+  {
+    if (DDS_OP (*op) != DDS_OP_ADR)
+      return DDS_RETCODE_UNSUPPORTED;
+    if (!is_base (*op))
+      nmembers++;
+  }
+  if ((rc = lookup_member (p, tok, nmembers, &m)) != DDS_RETCODE_OK)
+    return rc;
+  op = member_op (ops, m);
+  if (DDS_OP_TYPE (*op) == DDS_OP_VAL_EXT)
+    return DDS_RETCODE_BAD_PARAMETER;
+  if (!get_field_vtype (*op, &o->t))
+    return DDS_RETCODE_UNSUPPORTED;
+  if (m >= f->nmembers)
+    f->nmembers = m + 1;
+  f->member_ops = ops;
+  f->delimited = delimited;
+  o->kind = OPND_MEMBER;
+  o->idx = m;
+  return DDS_RETCODE_OK;
+}
+
+static dds_return_t resolve_field (struct sqlf_parser *p, const struct sqlf_token *tok, struct sqlf_operand *o)
+{
+  const struct dds_sertype_default * const tp = p->type;
+  uint32_t k;
+  if (tp == NULL)
+    return DDS_RETCODE_UNSUPPORTED;
+  for (k = 0; k < tp->type.keys.nkeys; k++)
+    if (strlen (tp->key_names[k]) == tok->len && memcmp (tp->key_names[k], tok->s, tok->len) == 0)
+      break;
+  // key fields are taken from the key if possible, for (top-level) key fields in
+  // other types, the data has to be used
+  if (k == tp->type.keys.nkeys || (tp->type.flagset & (DDS_TOPIC_KEY_APPENDABLE | DDS_TOPIC_KEY_MUTABLE | DDS_TOPIC_KEY_SEQUENCE | DDS_TOPIC_KEY_ARRAY_NONPRIM)))
+    return resolve_member (p, tok, o);
+  if (k >= p->f->nfields)
+    p->f->nfields = k + 1;
+  o->kind = OPND_KEY;
+  o->idx = k;
+  // type gets filled in once all fields are known
+  return DDS_RETCODE_OK;
+}
+
+static dds_return_t parse_operand (struct sqlf_parser *p, struct sqlf_operand *o)
+{
+  dds_return_t rc;
+  switch (p->tok.kind)
+  {
+    case TK_IDENT:
+      if ((rc = resolve_field (p, &p->tok, o)) != DDS_RETCODE_OK)
+        return rc;
+      break;
+    case TK_CONST:
+      o->kind = OPND_CONST;
+      o->idx = p->tok.idx;
+      o->t = p->f->consts[o->idx].t;
+      break;
+    default:
+      return DDS_RETCODE_BAD_PARAMETER;
+  }
+  return next (p);
+}
+
+/* Leaf instruction of key field k (definition order), following the key offset
+   path through nested (final) structs */
+static uint32_t key_field_insn (const struct dds_cdrstream_desc *desc, uint32_t k)
+{
+  const uint32_t *op = desc->ops.ops + desc->keys.keys_definition_order[k].ops_offs;
+  if (DDS_OP (*op) == DDS_OP_KOF)
+  {
+    const uint32_t *offs = op + 2;
+    op = desc->ops.ops + op[1];
+    while (DDS_OP_TYPE (*op) == DDS_OP_VAL_EXT)
+      op = op + DDS_OP_ADR_JSR (op[2]) + *offs++;
+  }
+  assert (DDS_OP (*op) == DDS_OP_ADR);
+  return *op;
+}
+
+static dds_return_t field_type (struct sqlf_parser *p, struct sqlf_operand *o)
+{
+  if (o->kind == OPND_KEY && !get_field_vtype (key_field_insn (&p->type->type, o->idx), &o->t))
+    return DDS_RETCODE_UNSUPPORTED;
+  return DDS_RETCODE_OK;
+}
+
+static dds_return_t parse_predicate (struct sqlf_parser *p)
+{
+  struct sqlf_operand a, b, c;
+  dds_return_t rc;
+  bool negate = false;
+  if ((rc = parse_operand (p, &a)) != DDS_RETCODE_OK || (rc = field_type (p, &a)) != DDS_RETCODE_OK)
+    return rc;
+  if (p->tok.kind == TK_CMP)
+  {
+    const enum sqlf_cmpop cmp = p->tok.cmp;
+    if ((rc = next (p)) != DDS_RETCODE_OK)
+      return rc;
+    if ((rc = parse_operand (p, &b)) != DDS_RETCODE_OK || (rc = field_type (p, &b)) != DDS_RETCODE_OK)
+      return rc;
+    return emit_cmp (p, SQLF_CMP, cmp, &a, &b);
+  }
+
+  if (p->tok.kind == TK_NOT)
+  {
+    negate = true;
+    if ((rc = next (p)) != DDS_RETCODE_OK)
+      return rc;
+  }
+  if (p->tok.kind == TK_BETWEEN)
+  {
+    if ((rc = next (p)) != DDS_RETCODE_OK)
+      return rc;
+    if ((rc = parse_operand (p, &b)) != DDS_RETCODE_OK || (rc = field_type (p, &b)) != DDS_RETCODE_OK)
+      return rc;
+    if (p->tok.kind != TK_AND)
+      return DDS_RETCODE_BAD_PARAMETER;
+    if ((rc = next (p)) != DDS_RETCODE_OK)
+      return rc;
+    if ((rc = parse_operand (p, &c)) != DDS_RETCODE_OK || (rc = field_type (p, &c)) != DDS_RETCODE_OK)
+      return rc;
+    if ((rc = emit_cmp (p, SQLF_CMP, CMP_GE, &a, &b)) != DDS_RETCODE_OK)
+      return rc;
+    const uint32_t j = emit_simple (p, SQLF_JF);
+    if ((rc = emit_cmp (p, SQLF_CMP, CMP_LE, &a, &c)) != DDS_RETCODE_OK)
+      return rc;
+    patch_jump (p, j);
+  }
+  else if (p->tok.kind == TK_LIKE)
+  {
+    if ((rc = next (p)) != DDS_RETCODE_OK)
+      return rc;
+    if ((rc = parse_operand (p, &b)) != DDS_RETCODE_OK || (rc = field_type (p, &b)) != DDS_RETCODE_OK)
+      return rc;
+    if ((rc = emit_cmp (p, SQLF_LIKE, CMP_EQ, &a, &b)) != DDS_RETCODE_OK)
+      return rc;
+  }
+  else
+  {
+    return DDS_RETCODE_BAD_PARAMETER;
+  }
+  if (negate)
+    (void) emit_simple (p, SQLF_NOT);
+  return DDS_RETCODE_OK;
+}
+
+static dds_return_t parse_or (struct sqlf_parser *p);
+
+static dds_return_t parse_not (struct sqlf_parser *p)
+{
+  dds_return_t rc;
+  if (++p->depth > MAX_NESTING)
+    return DDS_RETCODE_BAD_PARAMETER;
+  if (p->tok.kind == TK_NOT)
+  {
+    if ((rc = next (p)) != DDS_RETCODE_OK || (rc = parse_not (p)) != DDS_RETCODE_OK)
+      return rc;
+    (void) emit_simple (p, SQLF_NOT);
+  }
+  else if (p->tok.kind == TK_LPAREN)
+  {
+    if ((rc = next (p)) != DDS_RETCODE_OK || (rc = parse_or (p)) != DDS_RETCODE_OK)
+      return rc;
+    if (p->tok.kind != TK_RPAREN)
+      return DDS_RETCODE_BAD_PARAMETER;
+    if ((rc = next (p)) != DDS_RETCODE_OK)
+      return rc;
+  }
+  else if ((rc = parse_predicate (p)) != DDS_RETCODE_OK)
+  {
+    return rc;
+  }
+  p->depth--;
+  return DDS_RETCODE_OK;
+}
+
+static dds_return_t parse_and (struct sqlf_parser *p)
+{
+  dds_return_t rc;
+  if ((rc = parse_not (p)) != DDS_RETCODE_OK)
+    return rc;
+  while (p->tok.kind == TK_AND)
+  {
+    const uint32_t j = emit_simple (p, SQLF_JF);
+    if ((rc = next (p)) != DDS_RETCODE_OK || (rc = parse_not (p)) != DDS_RETCODE_OK)
+      return rc;
+    patch_jump (p, j);
+  }
+  return DDS_RETCODE_OK;
+}
+
+static dds_return_t parse_or (struct sqlf_parser *p)
+{
+  dds_return_t rc;
+  if ((rc = parse_and (p)) != DDS_RETCODE_OK)
+    return rc;
+  while (p->tok.kind == TK_OR)
+  {
+    const uint32_t j = emit_simple (p, SQLF_JT);
+    if ((rc = next (p)) != DDS_RETCODE_OK || (rc = parse_and (p)) != DDS_RETCODE_OK)
+      return rc;
+    patch_jump (p, j);
+  }
+  return DDS_RETCODE_OK;
+}
+
+static dds_return_t check_fields (struct sqlf_parser *p)
+{
+  // all key fields up to the last referenced one must be walked at run-time,
+  // so must all be of a supported type
+  struct dds_sqlfilter * const f = p->f;
+  if (f->nfields == 0)
+    return DDS_RETCODE_OK;
+  f->field_insn = ddsrt_malloc (f->nfields * sizeof (*f->field_insn));
+  for (uint32_t k = 0; k < f->nfields; k++)
+  {
+    enum sqlf_vtype t;
+    f->field_insn[k] = key_field_insn (&p->type->type, k);
+    if (!get_field_vtype (f->field_insn[k], &t))
+      return DDS_RETCODE_UNSUPPORTED;
+  }
+  return DDS_RETCODE_OK;
+}
+
+/* Members preceding the last referenced one are skipped at run-time, which is
+   possible for anything except unions and wide strings, unless the data is XCDR2
+   and they are in a type or collection that is preceded by a DHEADER.  Recursive
+   types are not supported either. */
+struct sqlf_ops_path {
+  const struct sqlf_ops_path *up;
+  const uint32_t *ops;
+};
+
+static bool can_skip_struct (const uint32_t *ops, const struct sqlf_ops_path *up);
+
+static bool can_skip_member (uint32_t insn, const uint32_t *ops, const struct sqlf_ops_path *up)
+{
+  switch (DDS_OP_TYPE (insn))
+  {
+    case DDS_OP_VAL_WSTR: case DDS_OP_VAL_BWSTR: case DDS_OP_VAL_UNI:
+      return false;
+    case DDS_OP_VAL_EXT: {
+      const uint32_t *jsr_ops = ops + DDS_OP_ADR_JSR (ops[2]);
+      if (is_base (insn) && jsr_ops[0] == DDS_OP_DLC)
+        jsr_ops++;
+      return can_skip_struct (jsr_ops, up);
+    }
+    case DDS_OP_VAL_SEQ: case DDS_OP_VAL_BSQ: case DDS_OP_VAL_ARR:
+      switch (DDS_OP_SUBTYPE (insn))
+      {
+        case DDS_OP_VAL_WSTR: case DDS_OP_VAL_BWSTR: case DDS_OP_VAL_UNI:
+          return false;
+        case DDS_OP_VAL_SEQ: case DDS_OP_VAL_BSQ: case DDS_OP_VAL_ARR: case DDS_OP_VAL_STU: {
+          const uint32_t jsr = (DDS_OP_TYPE (insn) == DDS_OP_VAL_ARR) ? ops[3] : ops[(DDS_OP_TYPE (insn) == DDS_OP_VAL_BSQ) ? 4 : 3];
+          return can_skip_struct (ops + DDS_OP_ADR_JSR (jsr), up);
+        }
+        default:
+          return true;
+      }
+    default:
+      return true;
+  }
+}
+
+static bool can_skip_struct (const uint32_t *ops, const struct sqlf_ops_path *up)
+{
+  for (const struct sqlf_ops_path *q = up; q; q = q->up)
+    if (q->ops == ops)
+      return false;
+  const struct sqlf_ops_path path = { .up = up, .ops = ops };
+  if (*ops == DDS_OP_DLC || *ops == DDS_OP_PLC)
+    return true;
+  for (uint32_t insn; (insn = *ops) != DDS_OP_RTS; ops = dds_stream_skip_adr (insn, ops))
+    if (DDS_OP (insn) != DDS_OP_ADR || !can_skip_member (insn, ops, &path))
+      return false;
+  return true;
+}
+
+static dds_return_t check_members (struct sqlf_parser *p)
+{
+  struct dds_sqlfilter * const f = p->f;
+  if (f->nmembers == 0)
+    return DDS_RETCODE_OK;
+  f->member_ref = ddsrt_malloc (f->nmembers * sizeof (*f->member_ref));
+  memset (f->member_ref, 0, f->nmembers * sizeof (*f->member_ref));
+  for (uint32_t i = 0; i < f->ninsns; i++)
+  {
+    const struct sqlf_insn * const insn = &f->insns[i];
+    if (insn->a.kind == OPND_MEMBER)
+      f->member_ref[insn->a.idx] = true;
+    if (insn->b_opnd.kind == OPND_MEMBER)
+      f->member_ref[insn->b_opnd.idx] = true;
+  }
+  const uint32_t *last = member_op (f->member_ops, f->nmembers - 1);
+  for (const uint32_t *op = f->member_ops; op != last; op = dds_stream_skip_adr (*op, op))
+    if (!can_skip_member (*op, op, NULL))
+      return DDS_RETCODE_UNSUPPORTED;
+  return DDS_RETCODE_OK;
+}
+
+static void init_property (struct ddsi_content_filter_property *prop, const char *topic_name, const char *expression, uint32_t nparams, const char * const *params)
+{
+  prop->content_filtered_topic_name = ddsrt_strdup (topic_name);
+  prop->related_topic_name = ddsrt_strdup (topic_name);
+  prop->filter_class_name = ddsrt_strdup (DDS_SQLFILTER_CLASS_NAME);
+  prop->filter_expression = ddsrt_strdup (expression);
+  prop->expression_parameters.n = nparams;
+  prop->expression_parameters.strs = NULL;
+  if (nparams > 0)
+  {
+    prop->expression_parameters.strs = ddsrt_malloc (nparams * sizeof (*prop->expression_parameters.strs));
+    for (uint32_t i = 0; i < nparams; i++)
+      prop->expression_parameters.strs[i] = ddsrt_strdup (params[i]);
+  }
+}
+
+static void fini_parser (struct sqlf_parser *p)
+{
+#ifdef DDS_HAS_TYPELIB
+  if (p->typemap)
+  {
+    ddsi_typemap_fini (p->typemap);
+    ddsrt_free (p->typemap);
+  }
+#else
+  (void) p;
+#endif
+}
+
+dds_return_t dds_sqlfilter_new (struct dds_sqlfilter **filter, const struct ddsi_sertype *type, const char *topic_name, const char *expression, uint32_t nparams, const char * const *params)
+{
+  dds_return_t rc;
+  if (expression == NULL || nparams > MAX_PARAMS || (nparams > 0 && params == NULL))
+    return DDS_RETCODE_BAD_PARAMETER;
+  for (uint32_t i = 0; i < nparams; i++)
+    if (params[i] == NULL)
+      return DDS_RETCODE_BAD_PARAMETER;
+
+  struct dds_sqlfilter *f = ddsrt_malloc (sizeof (*f));
+  memset (f, 0, sizeof (*f));
+  struct sqlf_parser p = {
+    .type = (type->ops == &dds_sertype_ops_default) ? (const struct dds_sertype_default *) type : NULL,
+    .nparams = nparams,
+    .params = params,
+    .src = expression,
+    .depth = 0,
+    .f = f,
+    .maxconsts = 0,
+    .maxinsns = 0
+  };
+  if ((rc = next (&p)) != DDS_RETCODE_OK || (rc = parse_or (&p)) != DDS_RETCODE_OK)
+    goto err;
+  if (p.tok.kind != TK_END)
+  {
+    rc = DDS_RETCODE_BAD_PARAMETER;
+    goto err;
+  }
+  if ((rc = check_fields (&p)) != DDS_RETCODE_OK || (rc = check_members (&p)) != DDS_RETCODE_OK)
+    goto err;
+  init_property (&f->prop, topic_name, expression, nparams, params);
+  *filter = f;
+  fini_parser (&p);
+  return DDS_RETCODE_OK;
+
+err:
+  fini_parser (&p);
+  dds_sqlfilter_free (f);
+  return rc;
+}
+
+void dds_sqlfilter_free (struct dds_sqlfilter *filter)
+{
+  struct ddsi_content_filter_property * const prop = &filter->prop;
+  for (uint32_t i = 0; i < prop->expression_parameters.n; i++)
+    ddsrt_free (prop->expression_parameters.strs[i]);
+  ddsrt_free (prop->expression_parameters.strs);
+  ddsrt_free (prop->filter_expression);
+  ddsrt_free (prop->filter_class_name);
+  ddsrt_free (prop->related_topic_name);
+  ddsrt_free (prop->content_filtered_topic_name);
+  for (uint32_t i = 0; i < filter->nconsts; i++)
+    if (filter->consts[i].t == VT_STRING)
+      ddsrt_free ((char *) filter->consts[i].u.s.s);
+  ddsrt_free (filter->consts);
+  ddsrt_free (filter->insns);
+  ddsrt_free (filter->field_insn);
+  ddsrt_free (filter->member_ref);
+  ddsrt_free (filter);
+}
+
+const struct ddsi_content_filter_property *dds_sqlfilter_property (const struct dds_sqlfilter *filter)
+{
+  return &filter->prop;
+}
+
+/*************************************
+ * Evaluation
+ *************************************/
+
+/* Serialized key or data, native-endian */
+struct sqlf_cdr {
+  const unsigned char *buf;
+  uint32_t size;     /* end of the data or of the enclosing delimited type */
+  uint32_t pos;
+  bool xcdr2;        /* the key is always XCDR2 */
+};
+
+static bool cdr_skip (struct sqlf_cdr *in, uint32_t align, uint64_t n)
+{
+  // XCDR2: alignment is capped at 4
+  const uint32_t a = (in->xcdr2 && align > 4) ? 4 : align;
+  const uint32_t p = (in->pos + a - 1) & ~(a - 1);
+  if (p > in->size || in->size - p < n)
+    return false;
+  in->pos = p + (uint32_t) n;
+  return true;
+}
+
+static bool get_prim (struct sqlf_cdr *in, uint32_t sz, uint64_t *x)
+{
+  if (sz != 1 && sz != 2 && sz != 4 && sz != 8)
+    return false;
+  if (!cdr_skip (in, sz, sz))
+    return false;
+  const unsigned char *b = in->buf + in->pos - sz;
+  switch (sz)
+  {
+    case 1: *x = *b; break;
+    case 2: { uint16_t v; memcpy (&v, b, 2); *x = v; break; }
+    case 4: { uint32_t v; memcpy (&v, b, 4); *x = v; break; }
+    default: { uint64_t v; memcpy (&v, b, 8); *x = v; break; }
+  }
+  return true;
+}
+
+/* strings and delimited types: a 4-byte length followed by that many bytes */
+static bool skip_sized (struct sqlf_cdr *in)
+{
+  uint64_t n;
+  return get_prim (in, 4, &n) && cdr_skip (in, 1, n);
+}
+
+static int64_t sign_extend (uint64_t x, uint32_t sz)
+{
+  switch (sz)
+  {
+    case 1: return (int8_t) x;
+    case 2: return (int16_t) x;
+    case 4: return (int32_t) x;
+    default: return (int64_t) x;
+  }
+}
+
+static bool read_value (struct sqlf_cdr *in, uint32_t insn, struct sqlf_value *v)
+{
+  uint32_t sz = 0;
+  uint64_t x;
+  switch (DDS_OP_TYPE (insn))
+  {
+    case DDS_OP_VAL_BLN: case DDS_OP_VAL_1BY: sz = 1; break;
+    case DDS_OP_VAL_2BY: sz = 2; break;
+    case DDS_OP_VAL_4BY: sz = 4; break;
+    case DDS_OP_VAL_8BY: sz = 8; break;
+    case DDS_OP_VAL_ENU: case DDS_OP_VAL_BMK: sz = DDS_OP_TYPE_SZ (insn); break;
+    case DDS_OP_VAL_STR: case DDS_OP_VAL_BST: {
+      if (!get_prim (in, 4, &x) || x == 0 || in->size - in->pos < x || in->buf[in->pos + x - 1] != 0)
+        return false;
+      v->t = VT_STRING;
+      v->u.s.s = (const char *) in->buf + in->pos;
+      v->u.s.n = (uint32_t) x - 1;
+      in->pos += (uint32_t) x;
+      return true;
+    }
+    default:
+      return false;
+  }
+  if (!get_prim (in, sz, &x))
+    return false;
+  switch (DDS_OP_TYPE (insn))
+  {
+    case DDS_OP_VAL_BLN:
+      v->t = VT_BOOL;
+      v->u.b = (x != 0);
+      break;
+    case DDS_OP_VAL_ENU: case DDS_OP_VAL_BMK:
+      v->t = VT_UINT;
+      v->u.u = x;
+      break;
+    default:
+      if (insn & DDS_OP_FLAG_FP)
+      {
+        v->t = VT_DOUBLE;
+        if (sz == 4)
+        {
+          float f; uint32_t y = (uint32_t) x;
+          memcpy (&f, &y, sizeof (f));
+          v->u.d = f;
+        }
+        else
+        {
+          memcpy (&v->u.d, &x, sizeof (v->u.d));
+        }
+      }
+      else if (insn & DDS_OP_FLAG_SGN)
+      {
+        v->t = VT_INT;
+        v->u.i = sign_extend (x, sz);
+      }
+      else
+      {
+        v->t = VT_UINT;
+        v->u.u = x;
+      }
+      break;
+  }
+  return true;
+}
+
+static bool extract_fields (struct sqlf_value *fv, uint32_t nfields, const uint32_t *field_insn, struct sqlf_cdr *in)
+{
+  for (uint32_t k = 0; k < nfields; k++)
+    if (!read_value (in, field_insn[k], &fv[k]))
+      return false;
+  return true;
+}
+
+static bool skip_struct (struct sqlf_cdr *in, const uint32_t *ops);
+
+static bool skip_collection (struct sqlf_cdr *in, uint32_t insn, const uint32_t *ops)
+{
+  const enum dds_stream_typecode subtype = DDS_OP_SUBTYPE (insn);
+  uint64_t n;
+  // in XCDR2, collections of anything but primitive types are preceded by a DHEADER
+  if (in->xcdr2 && !(subtype <= DDS_OP_VAL_8BY || subtype == DDS_OP_VAL_BLN || subtype == DDS_OP_VAL_WCHAR))
+    return skip_sized (in);
+  if (DDS_OP_TYPE (insn) == DDS_OP_VAL_ARR)
+    n = ops[2];
+  else if (!get_prim (in, 4, &n))
+    return false;
+  switch (subtype)
+  {
+    case DDS_OP_VAL_BLN: case DDS_OP_VAL_1BY: return cdr_skip (in, 1, n);
+    case DDS_OP_VAL_2BY: case DDS_OP_VAL_WCHAR: return cdr_skip (in, 2, 2 * n);
+    case DDS_OP_VAL_4BY: return cdr_skip (in, 4, 4 * n);
+    case DDS_OP_VAL_8BY: return cdr_skip (in, 8, 8 * n);
+    case DDS_OP_VAL_ENU: case DDS_OP_VAL_BMK: return cdr_skip (in, DDS_OP_TYPE_SZ (insn), DDS_OP_TYPE_SZ (insn) * n);
+    case DDS_OP_VAL_STR: case DDS_OP_VAL_BST:
+      for (uint64_t i = 0; i < n; i++)
+        if (!skip_sized (in))
+          return false;
+      return true;
+    case DDS_OP_VAL_SEQ: case DDS_OP_VAL_BSQ: case DDS_OP_VAL_ARR: case DDS_OP_VAL_STU: {
+      const uint32_t jsr = (DDS_OP_TYPE (insn) == DDS_OP_VAL_ARR) ? ops[3] : ops[(DDS_OP_TYPE (insn) == DDS_OP_VAL_BSQ) ? 4 : 3];
+      for (uint64_t i = 0; i < n; i++)
+        if (!skip_struct (in, ops + DDS_OP_ADR_JSR (jsr)))
+          return false;
+      return true;
+    }
+    default:
+      return false;
+  }
+}
+
+static bool skip_present_flag (struct sqlf_cdr *in, uint32_t insn, bool *present)
+{
+  uint64_t x;
+  // optional members in final and appendable types (only in XCDR2) are preceded by a boolean
+  if (!(insn & DDS_OP_FLAG_OPT))
+    *present = true;
+  else if (!in->xcdr2 || !get_prim (in, 1, &x))
+    return false;
+  else
+    *present = (x != 0);
+  return true;
+}
+
+static bool skip_member (struct sqlf_cdr *in, uint32_t insn, const uint32_t *ops)
+{
+  bool present;
+  if (!skip_present_flag (in, insn, &present))
+    return false;
+  if (!present)
+    return true;
+  switch (DDS_OP_TYPE (insn))
+  {
+    case DDS_OP_VAL_BLN: case DDS_OP_VAL_1BY: return cdr_skip (in, 1, 1);
+    case DDS_OP_VAL_2BY: case DDS_OP_VAL_WCHAR: return cdr_skip (in, 2, 2);
+    case DDS_OP_VAL_4BY: return cdr_skip (in, 4, 4);
+    case DDS_OP_VAL_8BY: return cdr_skip (in, 8, 8);
+    case DDS_OP_VAL_ENU: case DDS_OP_VAL_BMK: return cdr_skip (in, DDS_OP_TYPE_SZ (insn), DDS_OP_TYPE_SZ (insn));
+    case DDS_OP_VAL_STR: case DDS_OP_VAL_BST: return skip_sized (in);
+    case DDS_OP_VAL_SEQ: case DDS_OP_VAL_BSQ: case DDS_OP_VAL_ARR: return skip_collection (in, insn, ops);
+    case DDS_OP_VAL_EXT: {
+      // the members of a base type precede those of the derived type, without a DHEADER
+      const uint32_t *jsr_ops = ops + DDS_OP_ADR_JSR (ops[2]);
+      if (is_base (insn) && jsr_ops[0] == DDS_OP_DLC)
+        jsr_ops++;
+      return skip_struct (in, jsr_ops);
+    }
+    default:
+      return false;
+  }
+}
+
+static bool skip_struct (struct sqlf_cdr *in, const uint32_t *ops)
+{
+  if (*ops == DDS_OP_DLC || *ops == DDS_OP_PLC)
+    return in->xcdr2 && skip_sized (in);
+  for (uint32_t insn; (insn = *ops) != DDS_OP_RTS; ops = dds_stream_skip_adr (insn, ops))
+    if (!skip_member (in, insn, ops))
+      return false;
+  return true;
+}
+
+/* A sample in which a referenced optional member is absent doesn't match */
+static bool extract_members (const struct dds_sqlfilter *f, struct sqlf_value *mv, struct sqlf_cdr *in)
+{
+  const uint32_t *ops = f->member_ops;
+  if (f->delimited)
+  {
+    uint64_t dheader;
+    if (!in->xcdr2 || !get_prim (in, 4, &dheader) || in->size - in->pos < dheader)
+      return false;
+    in->size = in->pos + (uint32_t) dheader;
+  }
+  for (uint32_t m = 0; m < f->nmembers; ops = dds_stream_skip_adr (*ops, ops))
+  {
+    bool present;
+    if (is_base (*ops) || !f->member_ref[m])
+    {
+      if (!skip_member (in, *ops, ops))
+        return false;
+    }
+    else if (!skip_present_flag (in, *ops, &present) || !present || !read_value (in, *ops, &mv[m]))
+    {
+      return false;
+    }
+    if (!is_base (*ops))
+      m++;
+  }
+  return true;
+}
+
+static bool run (const struct dds_sqlfilter *f, const struct sqlf_value *fv, const struct sqlf_value *mv)
+{
+  bool r = false;
+  uint32_t pc = 0;
+  while (pc < f->ninsns)
+  {
+    const struct sqlf_insn * const insn = &f->insns[pc++];
+    switch (insn->opc)
+    {
+      case SQLF_CONST: r = insn->b; break;
+      case SQLF_CMP: r = eval_cmp (insn->cmp, operand_value (f, fv, mv, &insn->a), operand_value (f, fv, mv, &insn->b_opnd)); break;
+      case SQLF_LIKE: r = eval_like (operand_value (f, fv, mv, &insn->a), operand_value (f, fv, mv, &insn->b_opnd)); break;
+      case SQLF_NOT: r = !r; break;
+      case SQLF_JF: if (!r) pc = insn->target; break;
+      case SQLF_JT: if (r) pc = insn->target; break;
+    }
+  }
+  return r;
+}
+
+static bool accepts_raw_loan (const struct dds_serdata_default *d)
+{
+  // the data of a sample in a raw PSMX loan is not serialized, so it can only be
+  // filtered on the key fields
+  return d->c.loan != NULL && d->c.loan->metadata->sample_state == DDS_LOANED_SAMPLE_STATE_RAW_DATA;
+}
+
+bool dds_sqlfilter_accepts (const struct dds_sqlfilter *filter, const struct ddsi_serdata *serdata)
+{
+  if (serdata->kind != SDK_DATA)
+    return true;
+  if (filter->nfields == 0 && filter->nmembers == 0)
+    return run (filter, NULL, NULL);
+
+  const struct dds_serdata_default *d = (const struct dds_serdata_default *) serdata;
+  assert (serdata->type->ops == &dds_sertype_ops_default);
+  assert (d->key.buftype != KEYBUFTYPE_UNSET);
+  if (filter->nmembers > 0 && accepts_raw_loan (d))
+    return true;
+  struct sqlf_value fvbuf[MAX_STACK_FIELDS], mvbuf[MAX_STACK_FIELDS];
+  struct sqlf_value *fv = (filter->nfields <= MAX_STACK_FIELDS) ? fvbuf : ddsrt_malloc (filter->nfields * sizeof (*fv));
+  struct sqlf_value *mv = (filter->nmembers <= MAX_STACK_FIELDS) ? mvbuf : ddsrt_malloc (filter->nmembers * sizeof (*mv));
+  struct sqlf_cdr key = {
+    .buf = (d->key.buftype == KEYBUFTYPE_STATIC) ? d->key.u.stbuf : d->key.u.dynbuf,
+    .size = d->key.keysize,
+    .pos = 0,
+    .xcdr2 = true
+  };
+  struct sqlf_cdr data = {
+    .buf = (const unsigned char *) d->data,
+    .size = d->pos,
+    .pos = 0,
+    .xcdr2 = (ddsi_sertype_enc_id_xcdr_version (d->hdr.identifier) == DDSI_RTPS_CDR_ENC_VERSION_2)
+  };
+  bool r;
+  if (!extract_fields (fv, filter->nfields, filter->field_insn, &key))
+    r = false;
+  else if (filter->nmembers > 0 && !extract_members (filter, mv, &data))
+    r = false;
+  else
+    r = run (filter, fv, mv);
+  if (fv != fvbuf)
+    ddsrt_free (fv);
+  if (mv != mvbuf)
+    ddsrt_free (mv);
+  return r;
+}
+
+/*************************************
+ * Writer-side filtering of remote readers
+ *************************************/
+
+static void *sqlfilter_if_compile (const struct ddsi_sertype *type, const struct ddsi_content_filter_property *cfp, void *arg)
+{
+  struct dds_sqlfilter *filter;
+  (void) arg;
+  if (strcmp (cfp->filter_class_name, DDS_SQLFILTER_CLASS_NAME) != 0)
+    return NULL;
+  if (dds_sqlfilter_new (&filter, type, cfp->related_topic_name, cfp->filter_expression, cfp->expression_parameters.n, (const char * const *) cfp->expression_parameters.strs) != DDS_RETCODE_OK)
+    return NULL;
+  return filter;
+}
+
+static bool sqlfilter_if_accepts (const void *filter, const struct ddsi_serdata *serdata, void *arg)
+{
+  (void) arg;
+  return dds_sqlfilter_accepts (filter, serdata);
+}
+
+static void sqlfilter_if_free (void *filter, void *arg)
+{
+  (void) arg;
+  dds_sqlfilter_free (filter);
+}
+
+const struct ddsi_content_filter_interface dds_sqlfilter_interface = {
+  .arg = NULL,
+  .compile = sqlfilter_if_compile,
+  .accepts = sqlfilter_if_accepts,
+  .free = sqlfilter_if_free
+};
@@ -39,6 +39,7 @@
 #include "dds/cdr/dds_cdrstream.h"
 #include "dds__serdata_builtintopic.h"
 #include "dds__serdata_default.h"
+#include "dds__sqlfilter.h"
 #include "dds__psmx.h"
 
 DECL_ENTITY_LOCK_UNLOCK (dds_topic)
@@ -239,6 +240,8 @@ static void dds_topic_close (dds_entity *e)
   ddsi_type_unref_sertype (&e->m_domain->gv, tp->m_stype);
 #endif
   dds_free (tp->m_name);
+  if (tp->m_sqlfilter)
+    dds_sqlfilter_free (tp->m_sqlfilter);
 
   ddsrt_mutex_lock (&pp->m_entity.m_mutex);
 
@@ -1058,6 +1061,26 @@ dds_return_t dds_get_topic_filter_and_arg (dds_entity_t topic, dds_topic_filter_
   return rc;
 }
 
+dds_return_t dds_set_topic_filter_expression (dds_entity_t topic, const char *expression, uint32_t nparams, const char * const *params)
+{
+  struct dds_sqlfilter *filter = NULL, *old;
+  dds_topic *t;
+  dds_return_t rc;
+  if ((rc = dds_topic_lock (topic, &t)) != DDS_RETCODE_OK)
+    return rc;
+  if (expression != NULL && (rc = dds_sqlfilter_new (&filter, t->m_stype, t->m_name, expression, nparams, params)) != DDS_RETCODE_OK)
+  {
+    dds_topic_unlock (t);
+    return rc;
+  }
+  old = t->m_sqlfilter;
+  t->m_sqlfilter = filter;
+  dds_topic_unlock (t);
+  if (old)
+    dds_sqlfilter_free (old);
+  return DDS_RETCODE_OK;
+}
+
 dds_return_t dds_get_name (dds_entity_t topic, char *name, size_t size)
 {
   dds_topic *t;
@@ -1173,4 +1196,6 @@ void dds_cdrstream_desc_from_topic_desc (struct dds_cdrstream_desc *desc, const
   memset (desc, 0, sizeof (*desc));
   dds_cdrstream_desc_init (desc, &dds_cdrstream_default_allocator, topic_desc->m_size, topic_desc->m_align, topic_desc->m_flagset,
       topic_desc->m_ops, topic_desc->m_keys, topic_desc->m_nkeys);
+  if (topic_desc->m_flagset & DDS_TOPIC_GEN_SERIALIZERS)
+    desc->gen_ops = topic_desc->m_gen_ops;
 }
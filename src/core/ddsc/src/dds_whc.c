@@ -32,6 +32,7 @@
 #include "dds/ddsi/ddsi_domaingv.h"
 #include "dds/ddsi/ddsi_entity.h"
 #include "dds__whc.h"
+#include "dds__whc_ring.h"
 #include "dds__entity.h"
 #include "dds__writer.h"
 
@@ -87,6 +88,7 @@ struct whc_writer_info {
   dds_writer * writer; /* can be NULL, eg in case of whc for built-in writers */
   unsigned is_transient_local: 1;
   unsigned has_deadline: 1;
+  unsigned has_key: 1; /* built-in writers are treated as keyed */
   uint32_t hdepth; /* 0 = unlimited */
   uint32_t tldepth; /* 0 = disabled/unlimited (no need to maintain an index if KEEP_ALL <=> is_transient_local + tldepth=0) */
   uint32_t idxdepth; /* = max (hdepth, tldepth) */
@@ -428,6 +430,7 @@ struct whc_writer_info *dds_whc_make_wrinfo (struct dds_writer *wr, const dds_qo
   wrinfo->writer = wr;
   wrinfo->is_transient_local = (qos->durability.kind == DDS_DURABILITY_TRANSIENT_LOCAL);
   wrinfo->has_deadline = (qos->deadline.deadline != DDS_INFINITY);
+  wrinfo->has_key = (wr == NULL || wr->m_topic->m_stype->has_key);
   wrinfo->hdepth = (qos->history.kind == DDS_HISTORY_KEEP_ALL) ? 0 : (unsigned) qos->history.depth;
   if (!wrinfo->is_transient_local)
     wrinfo->tldepth = 0;
@@ -450,6 +453,11 @@ struct ddsi_whc *dds_whc_new (struct ddsi_domaingv *gv, const struct whc_writer_
 
   assert ((wrinfo->hdepth == 0 || wrinfo->tldepth <= wrinfo->hdepth) || wrinfo->is_transient_local);
 
+  /* Volatile writers without a key or a deadline need neither the instance index
+     nor the interval tree, a ring indexed by sequence number suffices */
+  if (gv->config.ring_whc && !wrinfo->is_transient_local && !wrinfo->has_deadline && !wrinfo->has_key)
+    return dds_whc_ring_new (gv, wrinfo->hdepth);
+
   whc = ddsrt_malloc (sizeof (*whc));
   whc->common.ops = &whc_ops;
   ddsrt_mutex_init (&whc->lock);
@@ -0,0 +1,584 @@
+// Copyright(c) 2025 ZettaScale Technology and others
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License v. 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Eclipse Distribution License
+// v. 1.0 which is available at
+// http://www.eclipse.org/org/documents/edl-v10.php.
+//
+// SPDX-License-Identifier: EPL-2.0 OR BSD-3-Clause
+
+#include <assert.h>
+#include <stddef.h>
+#include <string.h>
+#include "dds/ddsrt/heap.h"
+#include "dds/ddsrt/sync.h"
+#include "dds/ddsrt/misc.h"
+#include "dds/ddsi/ddsi_serdata.h"
+#include "dds/features.h"
+#ifdef DDS_HAS_LIFESPAN
+#include "dds/ddsi/ddsi_lifespan.h"
+#endif
+#include "dds/ddsi/ddsi_unused.h"
+#include "dds/ddsi/ddsi_domaingv.h"
+#include "dds__whc_ring.h"
+
+/* The samples in the WHC are stored in a power-of-two sized array indexed by
+ * sequence number, covering [min_seq,maxp1).  The sequence numbers of the samples
+ * in the WHC are nearly always consecutive, but the history depth and unregisters
+ * can create holes, which are simply empty slots.  Looking up a sample is then a
+ * matter of indexing the array, and dropping acknowledged samples a matter of
+ * clearing a prefix of the range.  If a new sample doesn't fit in the array, the
+ * array is doubled in size.
+ *
+ * Without a key there is only one instance, and its history is a small ring of
+ * sequence numbers of which the oldest is dropped from the WHC when a new sample is
+ * added, much like the instance index of the default WHC does it for each
+ * instance.  Entries referring to samples that are no longer present are simply
+ * skipped. */
+
+#define WHC_RING_MIN_SIZE 32
+
+struct whc_ring_slot {
+  struct ddsi_serdata *serdata; /* NULL if slot is empty */
+  ddsi_seqno_t seq;
+  size_t size;
+  unsigned unacked: 1; /* counted in whc_ring::unacked_bytes iff 1 */
+  unsigned borrowed: 1; /* at most one can borrow it at any time */
+  ddsrt_mtime_t last_rexmit_ts;
+  uint32_t rexmit_count;
+#ifdef DDS_HAS_LIFESPAN
+  struct ddsi_lifespan_fhnode lifespan; /* fibheap node for lifespan */
+#endif
+};
+
+/* Samples dropped because they have been acknowledged by all readers are released
+   after the writer's lock has been released, which for this WHC means releasing the
+   references to their serdata */
+struct whc_ring_deferred_free {
+  struct ddsi_whc_node common;
+  uint32_t n;
+  struct ddsi_serdata *serdata[];
+};
+
+struct whc_ring {
+  struct ddsi_whc common;
+  ddsrt_mutex_t lock;
+  struct ddsi_domaingv *gv;
+  unsigned xchecks: 1;
+  uint32_t hdepth; /* 0 = KEEP_ALL */
+  size_t sample_overhead;
+  uint32_t fragment_size;
+  size_t unacked_bytes;
+  ddsi_seqno_t max_drop_seq;
+  ddsi_seqno_t min_seq; /* lowest seq present if count > 0 */
+  ddsi_seqno_t maxp1; /* highest seq present + 1 if count > 0, = min_seq otherwise */
+  uint32_t count; /* number of samples present */
+  uint32_t mask; /* size of slots - 1 */
+  struct whc_ring_slot *slots;
+  ddsi_seqno_t latest_seq; /* most recent sample of the instance, 0 if none/unregistered */
+  uint32_t headidx; /* index in hist of latest_seq */
+  ddsi_seqno_t *hist; /* history of the instance if hdepth > 0, 0 = empty */
+#ifdef DDS_HAS_LIFESPAN
+  struct ddsi_lifespan_adm lifespan; /* Lifespan administration */
+#endif
+};
+
+struct whc_ring_sample_iter {
+  struct ddsi_whc_sample_iter_base c;
+  bool first;
+};
+
+/* check that our definition of whc_sample_iter fits in the type that callers allocate */
+DDSRT_STATIC_ASSERT (sizeof (struct whc_ring_sample_iter) <= sizeof (struct ddsi_whc_sample_iter));
+
+#define TRACE(...) DDS_CLOG (DDS_LC_WHC, &whc->gv->logconfig, __VA_ARGS__)
+
+static struct whc_ring_slot *whc_ring_slot (const struct whc_ring *whc, ddsi_seqno_t seq)
+{
+  return &whc->slots[(uint32_t) seq & whc->mask];
+}
+
+static struct whc_ring_slot *whc_ring_lookup (const struct whc_ring *whc, ddsi_seqno_t seq)
+{
+  if (seq < whc->min_seq || seq >= whc->maxp1)
+    return NULL;
+  struct whc_ring_slot * const s = whc_ring_slot (whc, seq);
+  assert (s->serdata == NULL || s->seq == seq);
+  return (s->serdata != NULL) ? s : NULL;
+}
+
+static void check_whc_ring (const struct whc_ring *whc)
+{
+  (void) whc;
+  assert (whc->min_seq <= whc->maxp1);
+  assert (whc->maxp1 - whc->min_seq <= (ddsi_seqno_t) whc->mask + 1);
+  assert ((whc->count == 0) == (whc->min_seq == whc->maxp1));
+  assert (whc->count == 0 || whc_ring_lookup (whc, whc->min_seq) != NULL);
+  assert (whc->count == 0 || whc_ring_lookup (whc, whc->maxp1 - 1) != NULL);
+#ifndef NDEBUG
+  if (whc->xchecks)
+  {
+    uint32_t count = 0;
+    size_t unacked_bytes = 0;
+    for (ddsi_seqno_t seq = whc->min_seq; seq < whc->maxp1; seq++)
+    {
+      const struct whc_ring_slot *s;
+      if ((s = whc_ring_lookup (whc, seq)) != NULL)
+      {
+        count++;
+        if (s->unacked)
+          unacked_bytes += s->size;
+      }
+    }
+    assert (count == whc->count);
+    assert (unacked_bytes == whc->unacked_bytes);
+  }
+#endif
+}
+
+static void whc_ring_grow (struct whc_ring *whc, ddsi_seqno_t need)
+{
+  uint32_t size = whc->mask + 1;
+  while ((ddsi_seqno_t) size < need)
+    size *= 2;
+  TRACE ("  grow %"PRIu32" -> %"PRIu32"\n", whc->mask + 1, size);
+  struct whc_ring_slot *slots = ddsrt_malloc (size * sizeof (*slots));
+  for (uint32_t i = 0; i < size; i++)
+    slots[i].serdata = NULL;
+  for (ddsi_seqno_t seq = whc->min_seq; seq < whc->maxp1; seq++)
+  {
+    struct whc_ring_slot *s;
+    if ((s = whc_ring_lookup (whc, seq)) == NULL)
+      continue;
+    struct whc_ring_slot * const ns = &slots[(uint32_t) seq & (size - 1)];
+#ifdef DDS_HAS_LIFESPAN
+    /* the lifespan administration references the slot, so it needs to be moved
+       along with it */
+    ddsi_lifespan_unregister_sample_locked (&whc->lifespan, &s->lifespan);
+    *ns = *s;
+    ddsi_lifespan_register_sample_locked (&whc->lifespan, &ns->lifespan);
+#else
+    *ns = *s;
+#endif
+  }
+  ddsrt_free (whc->slots);
+  whc->slots = slots;
+  whc->mask = size - 1;
+}
+
+static void whc_ring_remove_slot (struct whc_ring *whc, struct whc_ring_slot *s)
+{
+  /* removes the sample from the administration, releasing the serdata is left to
+     the caller (unless it is borrowed, then it is released when it is returned) */
+  assert (s->serdata != NULL);
+  if (s->unacked)
+  {
+    assert (whc->unacked_bytes >= s->size);
+    whc->unacked_bytes -= s->size;
+  }
+#ifdef DDS_HAS_LIFESPAN
+  ddsi_lifespan_unregister_sample_locked (&whc->lifespan, &s->lifespan);
+#endif
+  s->serdata = NULL;
+  whc->count--;
+}
+
+static void whc_ring_adjust_bounds (struct whc_ring *whc)
+{
+  if (whc->count == 0)
+    whc->min_seq = whc->maxp1;
+  else
+  {
+    while (whc_ring_lookup (whc, whc->min_seq) == NULL)
+      whc->min_seq++;
+    while (whc_ring_lookup (whc, whc->maxp1 - 1) == NULL)
+      whc->maxp1--;
+  }
+}
+
+static void whc_ring_delete_one (struct whc_ring *whc, struct whc_ring_slot *s)
+{
+  struct ddsi_serdata * const serdata = s->serdata;
+  const bool borrowed = s->borrowed;
+  whc_ring_remove_slot (whc, s);
+  whc_ring_adjust_bounds (whc);
+  if (!borrowed)
+    ddsi_serdata_unref (serdata);
+}
+
+#ifdef DDS_HAS_LIFESPAN
+static ddsrt_mtime_t whc_ring_sample_expired_cb (void *hc, ddsrt_mtime_t tnow)
+{
+  struct whc_ring *whc = hc;
+  void *sample;
+  ddsrt_mtime_t tnext;
+  ddsrt_mutex_lock (&whc->lock);
+  while ((tnext = ddsi_lifespan_next_expired_locked (&whc->lifespan, tnow, &sample)).v == 0)
+    whc_ring_delete_one (whc, sample);
+  ddsrt_mutex_unlock (&whc->lock);
+  return tnext;
+}
+#endif
+
+static void get_state_locked (const struct whc_ring *whc, struct ddsi_whc_state *st)
+{
+  if (whc->count == 0)
+  {
+    st->min_seq = st->max_seq = 0;
+    st->unacked_bytes = 0;
+  }
+  else
+  {
+    st->min_seq = whc->min_seq;
+    st->max_seq = whc->maxp1 - 1;
+    st->unacked_bytes = whc->unacked_bytes;
+  }
+}
+
+static void whc_ring_get_state (const struct ddsi_whc *whc_generic, struct ddsi_whc_state *st)
+{
+  const struct whc_ring * const whc = (const struct whc_ring *) whc_generic;
+  ddsrt_mutex_lock ((ddsrt_mutex_t *) &whc->lock);
+  check_whc_ring (whc);
+  get_state_locked (whc, st);
+  ddsrt_mutex_unlock ((ddsrt_mutex_t *) &whc->lock);
+}
+
+static ddsi_seqno_t next_seq_locked (const struct whc_ring *whc, ddsi_seqno_t seq)
+{
+  ddsi_seqno_t nseq = (seq < whc->min_seq) ? whc->min_seq : seq + 1;
+  while (nseq < whc->maxp1 && whc_ring_lookup (whc, nseq) == NULL)
+    nseq++;
+  return (nseq < whc->maxp1) ? nseq : DDSI_MAX_SEQ_NUMBER;
+}
+
+static ddsi_seqno_t whc_ring_next_seq (const struct ddsi_whc *whc_generic, ddsi_seqno_t seq)
+{
+  const struct whc_ring * const whc = (const struct whc_ring *) whc_generic;
+  ddsi_seqno_t nseq;
+  ddsrt_mutex_lock ((ddsrt_mutex_t *) &whc->lock);
+  check_whc_ring (whc);
+  nseq = next_seq_locked (whc, seq);
+  ddsrt_mutex_unlock ((ddsrt_mutex_t *) &whc->lock);
+  return nseq;
+}
+
+static void whc_ring_free_deferred_free_list (struct ddsi_whc *whc_generic, struct ddsi_whc_node *deferred_free_list)
+{
+  (void) whc_generic;
+  if (deferred_free_list)
+  {
+    struct whc_ring_deferred_free * const dfl = (struct whc_ring_deferred_free *) deferred_free_list;
+    for (uint32_t i = 0; i < dfl->n; i++)
+      ddsi_serdata_unref (dfl->serdata[i]);
+    ddsrt_free (dfl);
+  }
+}
+
+static uint32_t whc_ring_remove_acked_messages (struct ddsi_whc *whc_generic, ddsi_seqno_t max_drop_seq, struct ddsi_whc_state *whcst, struct ddsi_whc_node **deferred_free_list)
+{
+  struct whc_ring * const whc = (struct whc_ring *) whc_generic;
+  struct whc_ring_deferred_free *dfl = NULL;
+  uint32_t ndropped = 0;
+
+  ddsrt_mutex_lock (&whc->lock);
+  assert (max_drop_seq < DDSI_MAX_SEQ_NUMBER);
+  assert (max_drop_seq >= whc->max_drop_seq);
+  check_whc_ring (whc);
+  TRACE ("whc_ring_remove_acked_messages(%p max_drop_seq %"PRIu64")\n", (void *) whc, max_drop_seq);
+  TRACE ("  whc: [%"PRIu64",%"PRIu64") max_drop_seq %"PRIu64" h %"PRIu32"\n", whc->min_seq, whc->maxp1, whc->max_drop_seq, whc->hdepth);
+
+  if (whc->count > 0 && max_drop_seq >= whc->min_seq)
+  {
+    const ddsi_seqno_t endp1 = (max_drop_seq < whc->maxp1) ? max_drop_seq + 1 : whc->maxp1;
+    dfl = ddsrt_malloc (sizeof (*dfl) + (size_t) (endp1 - whc->min_seq) * sizeof (dfl->serdata[0]));
+    dfl->n = 0;
+    for (ddsi_seqno_t seq = whc->min_seq; seq < endp1; seq++)
+    {
+      struct whc_ring_slot *s;
+      if ((s = whc_ring_lookup (whc, seq)) == NULL)
+        continue;
+      if (!s->borrowed)
+        dfl->serdata[dfl->n++] = s->serdata;
+      whc_ring_remove_slot (whc, s);
+      ndropped++;
+    }
+    whc->min_seq = endp1;
+    whc_ring_adjust_bounds (whc);
+    if (dfl->n == 0)
+    {
+      ddsrt_free (dfl);
+      dfl = NULL;
+    }
+  }
+  whc->max_drop_seq = max_drop_seq;
+  *deferred_free_list = (struct ddsi_whc_node *) dfl;
+  get_state_locked (whc, whcst);
+  ddsrt_mutex_unlock (&whc->lock);
+  return ndropped;
+}
+
+static int whc_ring_insert (struct ddsi_whc *whc_generic, ddsi_seqno_t max_drop_seq, ddsi_seqno_t seq, ddsrt_mtime_t exp, struct ddsi_serdata *serdata, struct ddsi_tkmap_instance *tk)
+{
+  struct whc_ring * const whc = (struct whc_ring *) whc_generic;
+  DDSRT_UNUSED_ARG (tk);
+#ifndef DDS_HAS_LIFESPAN
+  DDSRT_UNUSED_ARG (exp);
+#endif
+
+  ddsrt_mutex_lock (&whc->lock);
+  check_whc_ring (whc);
+  TRACE ("whc_ring_insert(%p max_drop_seq %"PRIu64" seq %"PRIu64" exp %"PRId64" serdata %p:%"PRIx32")\n",
+         (void *) whc, max_drop_seq, seq, exp.v, (void *) serdata, serdata->hash);
+
+  assert (max_drop_seq < DDSI_MAX_SEQ_NUMBER);
+  assert (max_drop_seq >= whc->max_drop_seq);
+  assert (whc->count == 0 || seq >= whc->maxp1);
+
+  if (whc->count == 0)
+    whc->min_seq = whc->maxp1 = seq;
+  else if (seq - whc->min_seq >= (ddsi_seqno_t) whc->mask + 1)
+    whc_ring_grow (whc, seq - whc->min_seq + 1);
+
+  struct whc_ring_slot * const s = whc_ring_slot (whc, seq);
+  assert (s->serdata == NULL);
+  s->serdata = ddsi_serdata_ref (serdata);
+  s->seq = seq;
+  s->unacked = (seq > max_drop_seq);
+  s->borrowed = 0;
+  s->last_rexmit_ts.v = 0;
+  s->rexmit_count = 0;
+  const size_t sz = ddsi_serdata_size (serdata);
+  s->size = sz + ((sz + whc->fragment_size - 1) / whc->fragment_size) * whc->sample_overhead;
+  if (s->unacked)
+    whc->unacked_bytes += s->size;
+#ifdef DDS_HAS_LIFESPAN
+  s->lifespan.t_expire = exp;
+  ddsi_lifespan_register_sample_locked (&whc->lifespan, &s->lifespan);
+#endif
+  whc->maxp1 = seq + 1;
+  whc->count++;
+
+  /* Special case of empty data (such as commit messages) doesn't affect the instance */
+  if (serdata->kind != SDK_EMPTY)
+  {
+    if (serdata->statusinfo & DDSI_STATUSINFO_UNREGISTER)
+    {
+      TRACE ("  unreg\n");
+      whc->latest_seq = 0;
+      for (uint32_t i = 0; i < whc->hdepth; i++)
+        whc->hist[i] = 0;
+      if (seq <= max_drop_seq)
+        whc_ring_delete_one (whc, s);
+    }
+    else
+    {
+      whc->latest_seq = seq;
+      if (whc->hdepth > 0)
+      {
+        struct whc_ring_slot *olds;
+        if (++whc->headidx == whc->hdepth)
+          whc->headidx = 0;
+        if (whc->hist[whc->headidx] != 0 && (olds = whc_ring_lookup (whc, whc->hist[whc->headidx])) != NULL)
+        {
+          TRACE ("  prune %"PRIu64"\n", olds->seq);
+          whc_ring_delete_one (whc, olds);
+        }
+        whc->hist[whc->headidx] = seq;
+      }
+    }
+  }
+  ddsrt_mutex_unlock (&whc->lock);
+  return 0;
+}
+
+static void make_borrowed_sample (struct ddsi_whc_borrowed_sample *sample, struct whc_ring_slot *s)
+{
+  assert (!s->borrowed);
+  s->borrowed = 1;
+  sample->seq = s->seq;
+  sample->serdata = s->serdata;
+  sample->unacked = s->unacked;
+  sample->rexmit_count = s->rexmit_count;
+  sample->last_rexmit_ts = s->last_rexmit_ts;
+}
+
+static bool whc_ring_borrow_sample (const struct ddsi_whc *whc_generic, ddsi_seqno_t seq, struct ddsi_whc_borrowed_sample *sample)
+{
+  const struct whc_ring * const whc = (const struct whc_ring *) whc_generic;
+  struct whc_ring_slot *s;
+  bool found;
+  ddsrt_mutex_lock ((ddsrt_mutex_t *) &whc->lock);
+  if ((s = whc_ring_lookup (whc, seq)) == NULL)
+    found = false;
+  else
+  {
+    make_borrowed_sample (sample, s);
+    found = true;
+  }
+  ddsrt_mutex_unlock ((ddsrt_mutex_t *) &whc->lock);
+  return found;
+}
+
+static bool whc_ring_borrow_sample_key (const struct ddsi_whc *whc_generic, const struct ddsi_serdata *serdata_key, struct ddsi_whc_borrowed_sample *sample)
+{
+  /* there is but one instance */
+  const struct whc_ring * const whc = (const struct whc_ring *) whc_generic;
+  struct whc_ring_slot *s;
+  bool found;
+  DDSRT_UNUSED_ARG (serdata_key);
+  ddsrt_mutex_lock ((ddsrt_mutex_t *) &whc->lock);
+  if (whc->latest_seq == 0 || (s = whc_ring_lookup (whc, whc->latest_seq)) == NULL)
+    found = false;
+  else
+  {
+    make_borrowed_sample (sample, s);
+    found = true;
+  }
+  ddsrt_mutex_unlock ((ddsrt_mutex_t *) &whc->lock);
+  return found;
+}
+
+static void return_sample_locked (struct whc_ring *whc, struct ddsi_whc_borrowed_sample *sample, bool update_retransmit_info)
+{
+  struct whc_ring_slot *s;
+  if ((s = whc_ring_lookup (whc, sample->seq)) == NULL)
+  {
+    /* data no longer present in WHC */
+    ddsi_serdata_unref (sample->serdata);
+  }
+  else
+  {
+    assert (s->borrowed);
+    s->borrowed = 0;
+    if (update_retransmit_info)
+    {
+      s->rexmit_count = sample->rexmit_count;
+      s->last_rexmit_ts = sample->last_rexmit_ts;
+    }
+  }
+}
+
+static void whc_ring_return_sample (struct ddsi_whc *whc_generic, struct ddsi_whc_borrowed_sample *sample, bool update_retransmit_info)
+{
+  struct whc_ring * const whc = (struct whc_ring *) whc_generic;
+  ddsrt_mutex_lock (&whc->lock);
+  return_sample_locked (whc, sample, update_retransmit_info);
+  ddsrt_mutex_unlock (&whc->lock);
+}
+
+static void whc_ring_sample_iter_init (const struct ddsi_whc *whc_generic, struct ddsi_whc_sample_iter *opaque_it)
+{
+  struct whc_ring_sample_iter *it = (struct whc_ring_sample_iter *) opaque_it;
+  it->c.whc = (struct ddsi_whc *) whc_generic;
+  it->first = true;
+}
+
+static bool whc_ring_sample_iter_borrow_next (struct ddsi_whc_sample_iter *opaque_it, struct ddsi_whc_borrowed_sample *sample)
+{
+  struct whc_ring_sample_iter * const it = (struct whc_ring_sample_iter *) opaque_it;
+  struct whc_ring * const whc = (struct whc_ring *) it->c.whc;
+  ddsi_seqno_t seq;
+  bool valid;
+  ddsrt_mutex_lock (&whc->lock);
+  check_whc_ring (whc);
+  if (!it->first)
+  {
+    seq = sample->seq;
+    return_sample_locked (whc, sample, false);
+  }
+  else
+  {
+    it->first = false;
+    seq = 0;
+  }
+  if ((seq = next_seq_locked (whc, seq)) == DDSI_MAX_SEQ_NUMBER)
+    valid = false;
+  else
+  {
+    make_borrowed_sample (sample, whc_ring_lookup (whc, seq));
+    valid = true;
+  }
+  ddsrt_mutex_unlock (&whc->lock);
+  return valid;
+}
+
+static void whc_ring_free (struct ddsi_whc *whc_generic)
+{
+  struct whc_ring * const whc = (struct whc_ring *) whc_generic;
+  check_whc_ring (whc);
+
+#ifdef DDS_HAS_LIFESPAN
+  whc_ring_sample_expired_cb (whc, DDSRT_MTIME_NEVER);
+  ddsi_lifespan_fini (&whc->lifespan);
+#endif
+
+  for (ddsi_seqno_t seq = whc->min_seq; seq < whc->maxp1; seq++)
+  {
+    struct whc_ring_slot *s;
+    if ((s = whc_ring_lookup (whc, seq)) != NULL)
+      ddsi_serdata_unref (s->serdata);
+  }
+  ddsrt_free (whc->slots);
+  ddsrt_free (whc->hist);
+  ddsrt_mutex_destroy (&whc->lock);
+  ddsrt_free (whc);
+}
+
+static const struct ddsi_whc_ops whc_ring_ops = {
+  .insert = whc_ring_insert,
+  .remove_acked_messages = whc_ring_remove_acked_messages,
+  .free_deferred_free_list = whc_ring_free_deferred_free_list,
+  .get_state = whc_ring_get_state,
+  .next_seq = whc_ring_next_seq,
+  .borrow_sample = whc_ring_borrow_sample,
+  .borrow_sample_key = whc_ring_borrow_sample_key,
+  .return_sample = whc_ring_return_sample,
+  .sample_iter_init = whc_ring_sample_iter_init,
+  .sample_iter_borrow_next = whc_ring_sample_iter_borrow_next,
+  .free = whc_ring_free
+};
+
+struct ddsi_whc *dds_whc_ring_new (struct ddsi_domaingv *gv, uint32_t hdepth)
+{
+  struct whc_ring *whc = ddsrt_malloc (sizeof (*whc));
+  whc->common.ops = &whc_ring_ops;
+  ddsrt_mutex_init (&whc->lock);
+  whc->gv = gv;
+  whc->xchecks = (gv->config.enabled_xchecks & DDSI_XCHECK_WHC) != 0;
+  whc->hdepth = hdepth;
+  whc->sample_overhead = 80; /* INFO_TS, DATA (estimate), inline QoS */
+  whc->fragment_size = gv->config.fragment_size;
+  whc->unacked_bytes = 0;
+  whc->max_drop_seq = 0;
+  whc->min_seq = whc->maxp1 = 1;
+  whc->count = 0;
+
+  /* large enough for the history if that is reasonably small, additional samples
+     exist only while waiting for acknowledgements and that's what growing is for */
+  uint32_t size = WHC_RING_MIN_SIZE;
+  while (size < hdepth && size < 65536)
+    size *= 2;
+  whc->mask = size - 1;
+  whc->slots = ddsrt_malloc (size * sizeof (*whc->slots));
+  for (uint32_t i = 0; i < size; i++)
+    whc->slots[i].serdata = NULL;
+
+  whc->latest_seq = 0;
+  whc->headidx = 0;
+  whc->hist = NULL;
+  if (hdepth > 0)
+  {
+    whc->hist = ddsrt_malloc (hdepth * sizeof (*whc->hist));
+    for (uint32_t i = 0; i < hdepth; i++)
+      whc->hist[i] = 0;
+  }
+
+#ifdef DDS_HAS_LIFESPAN
+  ddsi_lifespan_init (gv, &whc->lifespan, offsetof (struct whc_ring, lifespan), offsetof (struct whc_ring_slot, lifespan), whc_ring_sample_expired_cb);
+#endif
+
+  check_whc_ring (whc);
+  return (struct ddsi_whc *) whc;
+}
@@ -34,6 +34,10 @@
 
 extern inline bool dds_source_timestamp_is_valid_ddsi_time (dds_time_t timestamp, ddsi_protocol_version_t protover);
 
+/* dds_write_batch processes the samples in chunks of at most this many, to bound the
+   amount of stack space needed for keeping track of them */
+#define DDS_WRITE_BATCH_CHUNK 64
+
 struct ddsi_serdata_plain { struct ddsi_serdata p; };
 struct ddsi_serdata_any   { struct ddsi_serdata a; };
 
@@ -170,6 +174,43 @@ dds_return_t dds_write_ts (dds_entity_t writer, const void *data, dds_time_t tim
   return ret;
 }
 
+static void dds_write_batch_impl (dds_writer *wr, const void * const *samples, uint32_t n, const dds_time_t *timestamps, dds_time_t tnow, dds_return_t *results);
+
+dds_return_t dds_write_batch (dds_entity_t writer, const void * const *samples, uint32_t n, const dds_time_t *timestamps, dds_return_t *results)
+{
+  dds_return_t ret;
+  dds_writer *wr;
+
+  if (n > 0 && samples == NULL)
+    return DDS_RETCODE_BAD_PARAMETER;
+
+  if ((ret = dds_writer_lock (writer, &wr)) != DDS_RETCODE_OK)
+    return ret;
+  const dds_time_t tnow = dds_time ();
+  for (uint32_t i = 0; i < n; i += DDS_WRITE_BATCH_CHUNK)
+  {
+    const uint32_t m = (n - i < DDS_WRITE_BATCH_CHUNK) ? n - i : DDS_WRITE_BATCH_CHUNK;
+    dds_return_t rcs[DDS_WRITE_BATCH_CHUNK];
+    dds_write_batch_impl (wr, samples + i, m, timestamps ? timestamps + i : NULL, tnow, rcs);
+    for (uint32_t j = 0; j < m; j++)
+    {
+      if (results)
+        results[i + j] = rcs[j];
+      if (ret == DDS_RETCODE_OK && rcs[j] != DDS_RETCODE_OK)
+        ret = rcs[j];
+    }
+  }
+  if (!wr->whc_batch)
+  {
+    struct ddsi_thread_state * const thrst = ddsi_lookup_thread_state ();
+    ddsi_thread_state_awake (thrst, &wr->m_entity.m_domain->gv);
+    ddsi_xpack_send (wr->m_xp, false);
+    ddsi_thread_state_asleep (thrst);
+  }
+  dds_writer_unlock (wr);
+  return ret;
+}
+
 struct local_sourceinfo {
   const struct ddsi_sertype *src_type;
   struct ddsi_serdata *src_payload;
@@ -943,6 +984,67 @@ dds_return_t dds_write_impl (dds_writer *wr, const void *data, dds_time_t timest
   return ret;
 }
 
+static void dds_write_batch_impl (dds_writer *wr, const void * const *samples, uint32_t n, const dds_time_t *timestamps, dds_time_t tnow, dds_return_t *results)
+{
+  assert (n <= DDS_WRITE_BATCH_CHUNK);
+  if (wr->m_endpoint.psmx_endpoints.length > 0 || wr->m_loans->n_samples > 0)
+  {
+    // PSMX and loans have their own paths through dds_write_impl, writing them one
+    // at a time still avoids having to pin and lock the writer for each sample
+    for (uint32_t i = 0; i < n; i++)
+    {
+      if (samples[i] == NULL)
+        results[i] = DDS_RETCODE_BAD_PARAMETER;
+      else
+        results[i] = dds_write_impl (wr, samples[i], timestamps ? timestamps[i] : tnow, 0);
+    }
+    return;
+  }
+
+  struct ddsi_thread_state * const thrst = ddsi_lookup_thread_state ();
+  struct ddsi_domaingv * const gv = &wr->m_entity.m_domain->gv;
+  struct ddsi_writer * const ddsi_wr = wr->m_wr;
+  struct ddsi_serdata *serdata[DDS_WRITE_BATCH_CHUNK];
+  struct ddsi_tkmap_instance *tk[DDS_WRITE_BATCH_CHUNK];
+  int wrres[DDS_WRITE_BATCH_CHUNK];
+  uint32_t idx[DDS_WRITE_BATCH_CHUNK];
+  uint32_t m = 0;
+
+  ddsi_thread_state_awake (thrst, gv);
+  for (uint32_t i = 0; i < n; i++)
+  {
+    const dds_time_t timestamp = timestamps ? timestamps[i] : tnow;
+    results[i] = DDS_RETCODE_OK;
+    if (samples[i] == NULL || !dds_source_timestamp_is_valid_ddsi_time (timestamp, wr->protocol_version))
+      results[i] = DDS_RETCODE_BAD_PARAMETER;
+    else if (!evaluate_topic_filter (wr, samples[i], SDK_DATA))
+      continue;
+    else if ((serdata[m] = dds_write_impl_make_serdata (ddsi_wr->type, SDK_DATA, samples[i], NULL, timestamp, 0)) == NULL)
+      results[i] = DDS_RETCODE_BAD_PARAMETER;
+    else
+    {
+      tk[m] = ddsi_tkmap_lookup_instance_ref (gv->m_tkmap, serdata[m]);
+      // one reference for ddsi_write_samples_gc to consume, one for local delivery
+      (void) ddsi_serdata_ref (serdata[m]);
+      idx[m++] = i;
+    }
+  }
+
+  ddsi_write_samples_gc (thrst, wr->m_xp, ddsi_wr, m, serdata, tk, wrres);
+  for (uint32_t j = 0; j < m; j++)
+  {
+    dds_return_t ret;
+    if (wrres[j] >= 0)
+      ret = deliver_locally (ddsi_wr, serdata[j], tk[j]);
+    else
+      ret = (wrres[j] == DDS_RETCODE_TIMEOUT) ? DDS_RETCODE_TIMEOUT : DDS_RETCODE_ERROR;
+    results[idx[j]] = ret;
+    ddsi_tkmap_instance_unref (gv->m_tkmap, tk[j]);
+    ddsi_serdata_unref (serdata[j]);
+  }
+  ddsi_thread_state_asleep (thrst);
+}
+
 dds_return_t dds_writecdr_impl (dds_writer *wr, struct ddsi_xpack *xp, struct ddsi_serdata *d, bool flush)
 {
   dds_return_t ret = dds_writecdr_impl_common (wr, wr->m_wr, xp, (struct ddsi_serdata_any *) d, flush);
@@ -266,7 +266,11 @@ static const struct dds_stat_keyvalue_descriptor dds_writer_statistics_kv[] = {
   { "rexmit_bytes", DDS_STAT_KIND_UINT64 },
   { "throttle_count", DDS_STAT_KIND_UINT32 },
   { "time_throttle", DDS_STAT_KIND_UINT64 },
-  { "time_rexmit", DDS_STAT_KIND_UINT64 }
+  { "time_rexmit", DDS_STAT_KIND_UINT64 },
+  { "pacing_rate", DDS_STAT_KIND_UINT64 },
+  { "pacing_decrease_count", DDS_STAT_KIND_UINT32 },
+  { "time_pacing", DDS_STAT_KIND_UINT64 },
+  { "filtered_samples", DDS_STAT_KIND_UINT64 }
 };
 
 static const struct dds_stat_descriptor dds_writer_statistics_desc = {
@@ -283,7 +287,7 @@ static void dds_writer_refresh_statistics (const struct dds_entity *entity, stru
 {
   const struct dds_writer *wr = (const struct dds_writer *) entity;
   if (wr->m_wr)
-    ddsi_get_writer_stats (wr->m_wr, &stat->kv[0].u.u64, &stat->kv[1].u.u32, &stat->kv[2].u.u64, &stat->kv[3].u.u64);
+    ddsi_get_writer_stats (wr->m_wr, &stat->kv[0].u.u64, &stat->kv[1].u.u32, &stat->kv[2].u.u64, &stat->kv[3].u.u64, &stat->kv[4].u.u64, &stat->kv[5].u.u32, &stat->kv[6].u.u64, &stat->kv[7].u.u64);
 }
 
 const struct dds_entity_deriver dds_entity_deriver_writer = {
@@ -33,6 +33,7 @@
 #include "CdrStreamDataTypeInfo.h"
 #include "CdrStreamChecking.h"
 #include "CdrStreamWstring.h"
+#include "CdrStreamGenSer.h"
 #include "mem_ser.h"
 
 #define DDS_DOMAINID1 0
@@ -2667,3 +2668,147 @@ CU_Test (ddsc_cdrstream, check_wstring_normalize)
     dds_cdrstream_desc_fini (&desc, &dds_cdrstream_default_allocator);
   }
 }
+
+static void check_gen_serializers (const dds_topic_descriptor_t *topic_desc, const void *sample, uint32_t xcdrv)
+{
+  struct dds_cdrstream_desc desc, desc_interp;
+  dds_cdrstream_desc_from_topic_desc (&desc, topic_desc);
+  CU_ASSERT_FATAL (desc.gen_ops != NULL);
+  desc_interp = desc;
+  desc_interp.gen_ops = NULL;
+
+  // generated write must produce the same CDR as the interpreter
+  dds_ostream_t os, os_interp;
+  dds_ostream_init (&os, &dds_cdrstream_default_allocator, 0, xcdrv);
+  dds_ostream_init (&os_interp, &dds_cdrstream_default_allocator, 0, xcdrv);
+  CU_ASSERT_FATAL (dds_stream_write_sample (&os, &dds_cdrstream_default_allocator, sample, &desc));
+  CU_ASSERT_FATAL (dds_stream_write_sample (&os_interp, &dds_cdrstream_default_allocator, sample, &desc_interp));
+  CU_ASSERT_FATAL (os.m_index == os_interp.m_index);
+  CU_ASSERT_FATAL (memcmp (os.m_buffer, os_interp.m_buffer, os.m_index) == 0);
+
+  // normalize: accept the valid input and reject every truncation of it, like the interpreter does
+  for (uint32_t sz = 0; sz <= os.m_index; sz++)
+  {
+    void *cdr = ddsrt_memdup (os.m_buffer, os.m_index);
+    void *cdr_interp = ddsrt_memdup (os.m_buffer, os.m_index);
+    uint32_t act_size, act_size_interp;
+    const bool nok = dds_stream_normalize (cdr, sz, false, xcdrv, &desc, false, &act_size);
+    const bool nok_interp = dds_stream_normalize (cdr_interp, sz, false, xcdrv, &desc_interp, false, &act_size_interp);
+    CU_ASSERT_FATAL (nok == nok_interp);
+    if (nok)
+      CU_ASSERT_FATAL (act_size == act_size_interp);
+    ddsrt_free (cdr);
+    ddsrt_free (cdr_interp);
+  }
+
+  // normalize byte-swapped input, written by the interpreter in the non-native byte order
+  {
+    dds_ostream_t os_swapped;
+    dds_ostream_init (&os_swapped, &dds_cdrstream_default_allocator, 0, xcdrv);
+#if DDSRT_ENDIAN == DDSRT_LITTLE_ENDIAN
+    CU_ASSERT_FATAL (dds_stream_write_sampleBE ((dds_ostreamBE_t *) &os_swapped, &dds_cdrstream_default_allocator, sample, &desc));
+#else
+    CU_ASSERT_FATAL (dds_stream_write_sampleLE ((dds_ostreamLE_t *) &os_swapped, &dds_cdrstream_default_allocator, sample, &desc));
+#endif
+    uint32_t act_size;
+    CU_ASSERT_FATAL (dds_stream_normalize (os_swapped.m_buffer, os_swapped.m_index, true, xcdrv, &desc, false, &act_size));
+    CU_ASSERT_FATAL (act_size == os.m_index);
+    CU_ASSERT_FATAL (memcmp (os_swapped.m_buffer, os.m_buffer, os.m_index) == 0);
+    dds_ostream_fini (&os_swapped, &dds_cdrstream_default_allocator);
+  }
+
+  // key extraction
+  {
+    dds_istream_t is, is_interp;
+    dds_ostream_t osk, osk_interp;
+    dds_istream_init (&is, os.m_index, os.m_buffer, xcdrv);
+    dds_istream_init (&is_interp, os.m_index, os.m_buffer, xcdrv);
+    dds_ostream_init (&osk, &dds_cdrstream_default_allocator, 0, DDSI_RTPS_CDR_ENC_VERSION_2);
+    dds_ostream_init (&osk_interp, &dds_cdrstream_default_allocator, 0, DDSI_RTPS_CDR_ENC_VERSION_2);
+    CU_ASSERT_FATAL (dds_stream_extract_key_from_data (&is, &osk, &dds_cdrstream_default_allocator, &desc));
+    CU_ASSERT_FATAL (dds_stream_extract_key_from_data (&is_interp, &osk_interp, &dds_cdrstream_default_allocator, &desc_interp));
+    CU_ASSERT_FATAL (osk.m_index == osk_interp.m_index);
+    CU_ASSERT_FATAL (memcmp (osk.m_buffer, osk_interp.m_buffer, osk.m_index) == 0);
+    dds_ostream_fini (&osk, &dds_cdrstream_default_allocator);
+    dds_ostream_fini (&osk_interp, &dds_cdrstream_default_allocator);
+  }
+
+  // read twice into the same sample (second time with buffers already allocated), then
+  // check the result by writing it again
+  void *data = dds_alloc (desc.size);
+  for (int i = 0; i < 2; i++)
+  {
+    dds_istream_t is;
+    dds_istream_init (&is, os.m_index, os.m_buffer, xcdrv);
+    dds_stream_read_sample (&is, data, &dds_cdrstream_default_allocator, &desc);
+    CU_ASSERT_FATAL (is.m_index == os.m_index);
+  }
+  dds_ostream_t os_read;
+  dds_ostream_init (&os_read, &dds_cdrstream_default_allocator, 0, xcdrv);
+  CU_ASSERT_FATAL (dds_stream_write_sample (&os_read, &dds_cdrstream_default_allocator, data, &desc_interp));
+  CU_ASSERT_FATAL (os_read.m_index == os.m_index);
+  CU_ASSERT_FATAL (memcmp (os_read.m_buffer, os.m_buffer, os.m_index) == 0);
+  dds_ostream_fini (&os_read, &dds_cdrstream_default_allocator);
+  dds_stream_free_sample (data, &dds_cdrstream_default_allocator, desc.ops.ops);
+  dds_free (data);
+
+  dds_ostream_fini (&os, &dds_cdrstream_default_allocator);
+  dds_ostream_fini (&os_interp, &dds_cdrstream_default_allocator);
+  dds_cdrstream_desc_fini (&desc, &dds_cdrstream_default_allocator);
+}
+
+CU_Test (ddsc_cdrstream, gen_serializers)
+{
+  CdrStreamGenSer_prims prims = {
+    .k1 = -3, .b = true, .o = 0xfe, .c = 'x', .s = -5, .us = 0xfedc, .k2 = "key", .ul = 0xfedcba98,
+    .ll = -7, .ull = UINT64_C (0xfedcba9876543210), .f = 1.5f, .d = -2.25,
+    .e8 = CdrStreamGenSer_F1, .e16 = CdrStreamGenSer_G3, .e32 = CdrStreamGenSer_E2
+  };
+
+  int32_t lseq[] = { 1, -2, 3, -4 };
+  bool bseq[] = { true, false, true };
+  CdrStreamGenSer_en16 eseq[] = { CdrStreamGenSer_G2, CdrStreamGenSer_G0 };
+  char *strseq[] = { "a", "", "bcd" };
+  char bstrseq[][5] = { "abcd", "e" };
+  CdrStreamGenSer_inner inseq[] = { { 1, "ab", CdrStreamGenSer_E1 }, { 2, "", CdrStreamGenSer_E2 }, { 3, "abcde", CdrStreamGenSer_E0 } };
+  CdrStreamGenSer_collections coll = {
+    .k = 11, .str = "string", .bstr = "bounded", .arr = { { 1, 2, 3 }, { 4, 5, 6 } },
+    .barr = { true, false, true }, .earr = { CdrStreamGenSer_E2, CdrStreamGenSer_E1 },
+    .sarr_ = { "x", "yz" }, .inarr = { { 7, "c", CdrStreamGenSer_E2 }, { 8, "de", CdrStreamGenSer_E0 } },
+    .tdarr = { { 1, 2, 3 }, { -1, -2, -3 } },
+    .tdiarr = { { { 10, "g", CdrStreamGenSer_E0 }, { 11, "hi", CdrStreamGenSer_E1 } }, { { 12, "", CdrStreamGenSer_E2 }, { 13, "jkl", CdrStreamGenSer_E0 } } },
+    .lseq = { ._length = 4, ._maximum = 4, ._buffer = lseq },
+    .blseq = { ._length = 3, ._maximum = 3, ._buffer = lseq },
+    .bseq = { ._length = 3, ._maximum = 3, ._buffer = bseq },
+    .eseq = { ._length = 2, ._maximum = 2, ._buffer = eseq },
+    .strseq = { ._length = 3, ._maximum = 3, ._buffer = strseq },
+    .bstrseq = { ._length = 2, ._maximum = 2, ._buffer = bstrseq },
+    .inseq = { ._length = 3, ._maximum = 3, ._buffer = inseq },
+    .binseq = { ._length = 1, ._maximum = 1, ._buffer = inseq },
+    .in = { 9, "f", CdrStreamGenSer_E1 },
+    .tail = 3.5
+  };
+  CdrStreamGenSer_collections coll_empty = { .str = "", .sarr_ = { "", "" } };
+
+  const struct {
+    const dds_topic_descriptor_t *desc;
+    const void *sample;
+  } tests[] = {
+    { &CdrStreamGenSer_inner_desc, &inseq[0] },
+    { &CdrStreamGenSer_prims_desc, &prims },
+    { &CdrStreamGenSer_collections_desc, &coll },
+    { &CdrStreamGenSer_collections_desc, &coll_empty }
+  };
+
+  for (uint32_t i = 0; i < sizeof (tests) / sizeof (tests[0]); i++)
+  {
+    for (uint32_t xcdrv = DDSI_RTPS_CDR_ENC_VERSION_1; xcdrv <= DDSI_RTPS_CDR_ENC_VERSION_2; xcdrv++)
+    {
+      printf ("running test %"PRIu32" for desc %s xcdr%"PRIu32"\n", i, tests[i].desc->m_typename, xcdrv == DDSI_RTPS_CDR_ENC_VERSION_1 ? 1 : 2);
+      check_gen_serializers (tests[i].desc, tests[i].sample, xcdrv);
+    }
+  }
+
+  // types that can't be done by the generated code must not have the flag set
+  CU_ASSERT_FATAL (!(CdrStreamGenSer_unsupported_desc.m_flagset & DDS_TOPIC_GEN_SERIALIZERS));
+}
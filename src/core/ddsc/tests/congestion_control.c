@@ -0,0 +1,318 @@
+// Copyright(c) 2025 ZettaScale Technology and others
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License v. 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Eclipse Distribution License
+// v. 1.0 which is available at
+// http://www.eclipse.org/org/documents/edl-v10.php.
+//
+// SPDX-License-Identifier: EPL-2.0 OR BSD-3-Clause
+
+#include <string.h>
+#include <inttypes.h>
+
+#include "CUnit/Test.h"
+#include "RoundTrip.h"
+#include "test_util.h"
+
+#include "dds/dds.h"
+#include "dds/ddsc/dds_statistics.h"
+#include "dds/ddsrt/heap.h"
+#include "dds/ddsrt/environ.h"
+#include "dds/ddsrt/threads.h"
+
+#define NSAMPLES 1000
+#define PAYLOAD_SIZE 1024
+
+#define MIN_RATE (256 * 1024)
+#define MAX_RATE (16 * 1024 * 1024)
+
+// 10% of the packets get dropped in both directions, so that data, heartbeats
+// and acknacks all get lost
+#define DDS_CONFIG_LOSSY "${CYCLONEDDS_URI}${CYCLONEDDS_URI:+,}\
+<Discovery><ExternalDomainId>0</ExternalDomainId></Discovery>\
+<Internal><Test><XmitLossiness>100</XmitLossiness></Test></Internal>"
+
+#define DDS_CONFIG_CC "<Internal>\
+  <CongestionControl>\
+    <Enable>true</Enable>\
+    <InitialRate>2 MiB</InitialRate>\
+    <MinRate>256 KiB</MinRate>\
+    <MaxRate>16 MiB</MaxRate>\
+  </CongestionControl>\
+</Internal>"
+
+static uint64_t get_stat_u64 (struct dds_statistics *stat, const char *name)
+{
+  const struct dds_stat_keyvalue *kv = dds_lookup_statistic (stat, name);
+  CU_ASSERT_FATAL (kv != NULL && kv->kind == DDS_STAT_KIND_UINT64);
+  return kv->u.u64;
+}
+
+static uint32_t get_stat_u32 (struct dds_statistics *stat, const char *name)
+{
+  const struct dds_stat_keyvalue *kv = dds_lookup_statistic (stat, name);
+  CU_ASSERT_FATAL (kv != NULL && kv->kind == DDS_STAT_KIND_UINT32);
+  return kv->u.u32;
+}
+
+CU_Test (ddsc_congestion_control, lossy_link, .timeout = 60)
+{
+  dds_return_t rc;
+  char *config_pub = ddsrt_expand_envvars (DDS_CONFIG_LOSSY DDS_CONFIG_CC, 0);
+  char *config_sub = ddsrt_expand_envvars (DDS_CONFIG_LOSSY, 1);
+  const dds_entity_t dom_pub = dds_create_domain (0, config_pub);
+  CU_ASSERT_FATAL (dom_pub > 0);
+  const dds_entity_t dom_sub = dds_create_domain (1, config_sub);
+  CU_ASSERT_FATAL (dom_sub > 0);
+  ddsrt_free (config_pub);
+  ddsrt_free (config_sub);
+
+  char topicname[100];
+  create_unique_topic_name ("ddsc_congestion_control", topicname, sizeof (topicname));
+  dds_qos_t *qos = dds_create_qos ();
+  dds_qset_reliability (qos, DDS_RELIABILITY_RELIABLE, DDS_SECS (10));
+  dds_qset_history (qos, DDS_HISTORY_KEEP_ALL, 0);
+  const dds_entity_t pp_pub = dds_create_participant (0, NULL, NULL);
+  CU_ASSERT_FATAL (pp_pub > 0);
+  const dds_entity_t pp_sub = dds_create_participant (1, NULL, NULL);
+  CU_ASSERT_FATAL (pp_sub > 0);
+  const dds_entity_t tp_pub = dds_create_topic (pp_pub, &RoundTripModule_DataType_desc, topicname, qos, NULL);
+  CU_ASSERT_FATAL (tp_pub > 0);
+  const dds_entity_t tp_sub = dds_create_topic (pp_sub, &RoundTripModule_DataType_desc, topicname, qos, NULL);
+  CU_ASSERT_FATAL (tp_sub > 0);
+  const dds_entity_t rd = dds_create_reader (pp_sub, tp_sub, qos, NULL);
+  CU_ASSERT_FATAL (rd > 0);
+  const dds_entity_t wr = dds_create_writer (pp_pub, tp_pub, qos, NULL);
+  CU_ASSERT_FATAL (wr > 0);
+  sync_reader_writer (pp_sub, rd, pp_pub, wr);
+
+  // only reliable writers are paced
+  dds_qset_reliability (qos, DDS_RELIABILITY_BEST_EFFORT, 0);
+  const dds_entity_t wr_be = dds_create_writer (pp_pub, tp_pub, qos, NULL);
+  CU_ASSERT_FATAL (wr_be > 0);
+  dds_delete_qos (qos);
+
+  unsigned char payload[PAYLOAD_SIZE];
+  memset (payload, 0, sizeof (payload));
+  const RoundTripModule_DataType sample = {
+    .payload = { ._length = PAYLOAD_SIZE, ._maximum = PAYLOAD_SIZE, ._buffer = payload }
+  };
+  const dds_time_t tstart = dds_time ();
+  for (uint32_t i = 0; i < NSAMPLES; i++)
+  {
+    memcpy (payload, &i, sizeof (i));
+    rc = dds_write (wr, &sample);
+    CU_ASSERT_FATAL (rc == 0);
+  }
+  const dds_time_t twritten = dds_time ();
+
+  // everything must arrive, in order, despite the losses
+  uint32_t count = 0;
+  const dds_time_t tend = dds_time () + DDS_SECS (30);
+  while (count < NSAMPLES && dds_time () < tend)
+  {
+    void *raw[10] = { NULL };
+    dds_sample_info_t si[10];
+    int32_t nread;
+    while ((nread = dds_take (rd, raw, si, 10, 10)) > 0)
+    {
+      for (int32_t k = 0; k < nread; k++)
+      {
+        if (!si[k].valid_data)
+          continue;
+        const RoundTripModule_DataType *s = raw[k];
+        uint32_t seq;
+        CU_ASSERT_FATAL (s->payload._length == PAYLOAD_SIZE);
+        memcpy (&seq, s->payload._buffer, sizeof (seq));
+        CU_ASSERT_FATAL (seq == count);
+        count++;
+      }
+      (void) dds_return_loan (rd, raw, nread);
+    }
+    dds_sleepfor (DDS_MSECS (10));
+  }
+  CU_ASSERT_FATAL (count == NSAMPLES);
+
+  struct dds_statistics *stat = dds_create_statistics (wr);
+  CU_ASSERT_FATAL (stat != NULL);
+  rc = dds_refresh_statistics (stat);
+  CU_ASSERT_FATAL (rc == 0);
+  const uint64_t rate = get_stat_u64 (stat, "pacing_rate");
+  const uint32_t decreases = get_stat_u32 (stat, "pacing_decrease_count");
+  const uint64_t time_pacing = get_stat_u64 (stat, "time_pacing");
+  const uint64_t rexmit_bytes = get_stat_u64 (stat, "rexmit_bytes");
+  tprintf ("wrote %d bytes in %.3fs: rate %"PRIu64" B/s decreases %"PRIu32" paced %.3fs rexmit %"PRIu64" bytes\n",
+           NSAMPLES * PAYLOAD_SIZE, (double) (twritten - tstart) / 1e9, rate, decreases, (double) time_pacing / 1e9, rexmit_bytes);
+  dds_delete_statistics (stat);
+
+  // the writer can't get through a megabyte without waiting at these rates,
+  // and 10% loss means there must have been retransmit requests that lowered
+  // the rate
+  CU_ASSERT (rate >= MIN_RATE && rate <= MAX_RATE);
+  CU_ASSERT (time_pacing > 0);
+  CU_ASSERT (decreases > 0);
+  CU_ASSERT (rexmit_bytes > 0);
+
+  stat = dds_create_statistics (wr_be);
+  CU_ASSERT_FATAL (stat != NULL);
+  rc = dds_refresh_statistics (stat);
+  CU_ASSERT_FATAL (rc == 0);
+  CU_ASSERT (get_stat_u64 (stat, "pacing_rate") == 0);
+  CU_ASSERT (get_stat_u64 (stat, "time_pacing") == 0);
+  dds_delete_statistics (stat);
+
+  rc = dds_delete (dom_pub);
+  CU_ASSERT_FATAL (rc == 0);
+  rc = dds_delete (dom_sub);
+  CU_ASSERT_FATAL (rc == 0);
+}
+
+#define NTHREADS 4
+#define NSAMPLES_PER_THREAD 100
+
+// low maximum rate so that the writing threads have to wait for each other
+#define DDS_CONFIG_CC_SLOW "<Internal>\
+  <CongestionControl>\
+    <Enable>true</Enable>\
+    <InitialRate>256 KiB</InitialRate>\
+    <MinRate>64 KiB</MinRate>\
+    <MaxRate>512 KiB</MaxRate>\
+  </CongestionControl>\
+</Internal>"
+
+struct write_thread_arg {
+  dds_entity_t wr;
+  uint32_t id;
+};
+
+static uint32_t write_thread (void *varg)
+{
+  const struct write_thread_arg *arg = varg;
+  unsigned char payload[PAYLOAD_SIZE];
+  memset (payload, 0, sizeof (payload));
+  const RoundTripModule_DataType sample = {
+    .payload = { ._length = PAYLOAD_SIZE, ._maximum = PAYLOAD_SIZE, ._buffer = payload }
+  };
+  memcpy (payload, &arg->id, sizeof (arg->id));
+  for (uint32_t i = 0; i < NSAMPLES_PER_THREAD; i++)
+  {
+    memcpy (payload + sizeof (arg->id), &i, sizeof (i));
+    if (dds_write (arg->wr, &sample) != 0)
+      return 1;
+  }
+  return 0;
+}
+
+static void write_concurrently (dds_entity_t wr)
+{
+  struct write_thread_arg args[NTHREADS];
+  ddsrt_thread_t tids[NTHREADS];
+  ddsrt_threadattr_t tattr;
+  ddsrt_threadattr_init (&tattr);
+  for (uint32_t i = 0; i < NTHREADS; i++)
+  {
+    args[i] = (struct write_thread_arg) { .wr = wr, .id = i };
+    dds_return_t rc = ddsrt_thread_create (&tids[i], "writer", &tattr, write_thread, &args[i]);
+    CU_ASSERT_FATAL (rc == 0);
+  }
+  for (uint32_t i = 0; i < NTHREADS; i++)
+  {
+    uint32_t retval;
+    dds_return_t rc = ddsrt_thread_join (tids[i], &retval);
+    CU_ASSERT_FATAL (rc == 0);
+    CU_ASSERT (retval == 0);
+  }
+}
+
+static uint64_t get_time_pacing (dds_entity_t wr)
+{
+  struct dds_statistics *stat = dds_create_statistics (wr);
+  CU_ASSERT_FATAL (stat != NULL);
+  dds_return_t rc = dds_refresh_statistics (stat);
+  CU_ASSERT_FATAL (rc == 0);
+  const uint64_t time_pacing = get_stat_u64 (stat, "time_pacing");
+  dds_delete_statistics (stat);
+  return time_pacing;
+}
+
+CU_Test (ddsc_congestion_control, concurrent_writes, .timeout = 60)
+{
+  dds_return_t rc;
+  char *config_pub = ddsrt_expand_envvars ("${CYCLONEDDS_URI}${CYCLONEDDS_URI:+,}<Discovery><ExternalDomainId>0</ExternalDomainId></Discovery>" DDS_CONFIG_CC_SLOW, 0);
+  char *config_sub = ddsrt_expand_envvars ("${CYCLONEDDS_URI}${CYCLONEDDS_URI:+,}<Discovery><ExternalDomainId>0</ExternalDomainId></Discovery>", 1);
+  const dds_entity_t dom_pub = dds_create_domain (0, config_pub);
+  CU_ASSERT_FATAL (dom_pub > 0);
+  const dds_entity_t dom_sub = dds_create_domain (1, config_sub);
+  CU_ASSERT_FATAL (dom_sub > 0);
+  ddsrt_free (config_pub);
+  ddsrt_free (config_sub);
+
+  char topicname[100], topicname_unmatched[100];
+  create_unique_topic_name ("ddsc_congestion_control", topicname, sizeof (topicname));
+  create_unique_topic_name ("ddsc_congestion_control_unmatched", topicname_unmatched, sizeof (topicname_unmatched));
+  dds_qos_t *qos = dds_create_qos ();
+  dds_qset_reliability (qos, DDS_RELIABILITY_RELIABLE, DDS_SECS (10));
+  dds_qset_history (qos, DDS_HISTORY_KEEP_ALL, 0);
+  const dds_entity_t pp_pub = dds_create_participant (0, NULL, NULL);
+  CU_ASSERT_FATAL (pp_pub > 0);
+  const dds_entity_t pp_sub = dds_create_participant (1, NULL, NULL);
+  CU_ASSERT_FATAL (pp_sub > 0);
+  const dds_entity_t tp_pub = dds_create_topic (pp_pub, &RoundTripModule_DataType_desc, topicname, qos, NULL);
+  CU_ASSERT_FATAL (tp_pub > 0);
+  const dds_entity_t tp_sub = dds_create_topic (pp_sub, &RoundTripModule_DataType_desc, topicname, qos, NULL);
+  CU_ASSERT_FATAL (tp_sub > 0);
+  const dds_entity_t tp_unmatched = dds_create_topic (pp_pub, &RoundTripModule_DataType_desc, topicname_unmatched, qos, NULL);
+  CU_ASSERT_FATAL (tp_unmatched > 0);
+  const dds_entity_t rd = dds_create_reader (pp_sub, tp_sub, qos, NULL);
+  CU_ASSERT_FATAL (rd > 0);
+  const dds_entity_t wr = dds_create_writer (pp_pub, tp_pub, qos, NULL);
+  CU_ASSERT_FATAL (wr > 0);
+  const dds_entity_t wr_unmatched = dds_create_writer (pp_pub, tp_unmatched, qos, NULL);
+  CU_ASSERT_FATAL (wr_unmatched > 0);
+  dds_delete_qos (qos);
+  sync_reader_writer (pp_sub, rd, pp_pub, wr);
+
+  // a reliable writer without readers has no reason to slow down
+  write_concurrently (wr_unmatched);
+  CU_ASSERT (get_time_pacing (wr_unmatched) == 0);
+
+  // several threads may be waiting for the pacer of the same writer at the
+  // same time, and every sample must still arrive
+  write_concurrently (wr);
+  uint32_t next[NTHREADS] = { 0 };
+  uint32_t count = 0;
+  const dds_time_t tend = dds_time () + DDS_SECS (30);
+  while (count < NTHREADS * NSAMPLES_PER_THREAD && dds_time () < tend)
+  {
+    void *raw[10] = { NULL };
+    dds_sample_info_t si[10];
+    int32_t nread;
+    while ((nread = dds_take (rd, raw, si, 10, 10)) > 0)
+    {
+      for (int32_t k = 0; k < nread; k++)
+      {
+        if (!si[k].valid_data)
+          continue;
+        const RoundTripModule_DataType *s = raw[k];
+        uint32_t id, seq;
+        CU_ASSERT_FATAL (s->payload._length == PAYLOAD_SIZE);
+        memcpy (&id, s->payload._buffer, sizeof (id));
+        memcpy (&seq, s->payload._buffer + sizeof (id), sizeof (seq));
+        CU_ASSERT_FATAL (id < NTHREADS);
+        CU_ASSERT_FATAL (seq == next[id]);
+        next[id]++;
+        count++;
+      }
+      (void) dds_return_loan (rd, raw, nread);
+    }
+    dds_sleepfor (DDS_MSECS (10));
+  }
+  CU_ASSERT_FATAL (count == NTHREADS * NSAMPLES_PER_THREAD);
+  CU_ASSERT (get_time_pacing (wr) > 0);
+
+  rc = dds_delete (dom_pub);
+  CU_ASSERT_FATAL (rc == 0);
+  rc = dds_delete (dom_sub);
+  CU_ASSERT_FATAL (rc == 0);
+}
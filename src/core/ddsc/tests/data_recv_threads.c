@@ -0,0 +1,142 @@
+// Copyright(c) 2025 ZettaScale Technology and others
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License v. 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Eclipse Distribution License
+// v. 1.0 which is available at
+// http://www.eclipse.org/org/documents/edl-v10.php.
+//
+// SPDX-License-Identifier: EPL-2.0 OR BSD-3-Clause
+
+#include <string.h>
+
+#include "CUnit/Theory.h"
+#include "Space.h"
+#include "test_util.h"
+
+#include "dds/dds.h"
+#include "dds/ddsrt/heap.h"
+#include "dds/ddsrt/io.h"
+#include "dds/ddsrt/environ.h"
+#include "dds/ddsrt/sockets.h"
+#include "dds/ddsi/ddsi_domaingv.h"
+#include "ddsi__tran.h"
+
+#define NWRITERS 4
+#define NSAMPLES 100
+
+#define DDS_CONFIG_NO_PORT_GAIN "${CYCLONEDDS_URI}${CYCLONEDDS_URI:+,}<Discovery><ExternalDomainId>0</ExternalDomainId></Discovery>"
+
+CU_TheoryDataPoints (ddsc_data_recv_threads, in_order) = {
+  CU_DataPoints (const char *, "none",   "auto",   "auto"),      // participant index
+  CU_DataPoints (const char *, "kernel", "kernel", "guidprefix") // steering
+};
+
+CU_Theory ((const char *pistr, const char *steering), ddsc_data_recv_threads, in_order, .timeout = 30)
+{
+  dds_return_t rc;
+  char *config_sub_raw = NULL;
+  (void) ddsrt_asprintf (&config_sub_raw,
+    "%s"
+    "<Discovery><ParticipantIndex>%s</ParticipantIndex></Discovery>"
+    "<Compatibility><ManySocketsMode>single</ManySocketsMode></Compatibility>"
+    "<Internal>"
+    "  <MultipleReceiveThreads>true</MultipleReceiveThreads>"
+    "  <DataReceiveThreads steering=\"%s\">4</DataReceiveThreads>"
+    "</Internal>",
+    DDS_CONFIG_NO_PORT_GAIN, pistr, steering);
+  char *config_pub = ddsrt_expand_envvars (DDS_CONFIG_NO_PORT_GAIN, 0);
+  char *config_sub = ddsrt_expand_envvars (config_sub_raw, 1);
+  ddsrt_free (config_sub_raw);
+  const dds_entity_t dom_pub = dds_create_domain (0, config_pub);
+  CU_ASSERT_FATAL (dom_pub > 0);
+  const dds_entity_t dom_sub = dds_create_domain (1, config_sub);
+  CU_ASSERT_FATAL (dom_sub > 0);
+  ddsrt_free (config_pub);
+  ddsrt_free (config_sub);
+
+  // each data receive thread has its own socket, all bound to the same port
+  const struct ddsi_domaingv *gv = get_domaingv (dom_sub);
+  CU_ASSERT_FATAL (gv != NULL);
+#ifdef SO_REUSEPORT
+  const uint32_t nthreads = 4;
+#else
+  const uint32_t nthreads = 1;
+#endif
+  uint32_t n = 0;
+  for (uint32_t i = 0; i < gv->n_recv_threads; i++)
+    if (strncmp (gv->recv_threads[i].name, "recvUC", 6) == 0)
+      n++;
+  CU_ASSERT_FATAL (n == nthreads);
+  CU_ASSERT_FATAL (gv->n_data_conn_uc_shards + 1 == nthreads);
+  CU_ASSERT_FATAL (gv->data_conn_uc != gv->disc_conn_uc);
+  for (uint32_t i = 0; i < gv->n_data_conn_uc_shards; i++)
+    CU_ASSERT_FATAL (ddsi_conn_port (gv->data_conn_uc_shards[i]) == ddsi_conn_port (gv->data_conn_uc));
+
+  char topicname[100];
+  create_unique_topic_name ("ddsc_data_recv_threads", topicname, sizeof (topicname));
+  dds_qos_t *qos = dds_create_qos ();
+  dds_qset_reliability (qos, DDS_RELIABILITY_RELIABLE, DDS_INFINITY);
+  dds_qset_history (qos, DDS_HISTORY_KEEP_ALL, 0);
+  const dds_entity_t pp_sub = dds_create_participant (1, NULL, NULL);
+  CU_ASSERT_FATAL (pp_sub > 0);
+  const dds_entity_t tp_sub = dds_create_topic (pp_sub, &Space_Type1_desc, topicname, qos, NULL);
+  CU_ASSERT_FATAL (tp_sub > 0);
+  const dds_entity_t rd = dds_create_reader (pp_sub, tp_sub, qos, NULL);
+  CU_ASSERT_FATAL (rd > 0);
+
+  // multiple participants so that steering by GUID prefix spreads them over the threads
+  dds_entity_t wrs[NWRITERS];
+  for (int i = 0; i < NWRITERS; i++)
+  {
+    const dds_entity_t pp = dds_create_participant (0, NULL, NULL);
+    CU_ASSERT_FATAL (pp > 0);
+    const dds_entity_t tp = dds_create_topic (pp, &Space_Type1_desc, topicname, qos, NULL);
+    CU_ASSERT_FATAL (tp > 0);
+    wrs[i] = dds_create_writer (pp, tp, qos, NULL);
+    CU_ASSERT_FATAL (wrs[i] > 0);
+    sync_reader_writer (pp_sub, rd, pp, wrs[i]);
+  }
+  dds_delete_qos (qos);
+
+  for (int32_t j = 0; j < NSAMPLES; j++)
+  {
+    for (int i = 0; i < NWRITERS; i++)
+    {
+      rc = dds_write (wrs[i], &(Space_Type1){ .long_1 = i, .long_2 = j, .long_3 = 0 });
+      CU_ASSERT_FATAL (rc == 0);
+    }
+  }
+
+  // everything must arrive, and in order for each writer
+  int32_t next[NWRITERS] = { 0 };
+  int32_t count = 0;
+  const dds_time_t tend = dds_time () + DDS_SECS (10);
+  while (count < NWRITERS * NSAMPLES && dds_time () < tend)
+  {
+    void *raw[10] = { NULL };
+    dds_sample_info_t si[10];
+    int32_t nread;
+    while ((nread = dds_take (rd, raw, si, 10, 10)) > 0)
+    {
+      for (int32_t k = 0; k < nread; k++)
+      {
+        if (!si[k].valid_data)
+          continue;
+        const Space_Type1 *s = raw[k];
+        CU_ASSERT_FATAL (s->long_1 >= 0 && s->long_1 < NWRITERS);
+        CU_ASSERT_FATAL (s->long_2 == next[s->long_1]);
+        next[s->long_1]++;
+        count++;
+      }
+      (void) dds_return_loan (rd, raw, nread);
+    }
+    dds_sleepfor (DDS_MSECS (10));
+  }
+  CU_ASSERT_FATAL (count == NWRITERS * NSAMPLES);
+
+  rc = dds_delete (dom_pub);
+  CU_ASSERT_FATAL (rc == 0);
+  rc = dds_delete (dom_sub);
+  CU_ASSERT_FATAL (rc == 0);
+}
@@ -0,0 +1,141 @@
+// Copyright(c) 2025 ZettaScale Technology and others
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License v. 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Eclipse Distribution License
+// v. 1.0 which is available at
+// http://www.eclipse.org/org/documents/edl-v10.php.
+//
+// SPDX-License-Identifier: EPL-2.0 OR BSD-3-Clause
+
+#include <string.h>
+#include <inttypes.h>
+
+#include "CUnit/Test.h"
+#include "RoundTrip.h"
+#include "test_util.h"
+
+#include "dds/dds.h"
+#include "dds/ddsc/dds_statistics.h"
+#include "dds/ddsrt/heap.h"
+#include "dds/ddsrt/environ.h"
+
+#define NSAMPLES 200
+#define PAYLOAD_SIZE (64 * 1024)
+
+// 5% of the packets get dropped by the publishing side, which for a sample
+// spread over a handful of packets means a significant fraction is lost
+#define DDS_CONFIG_LOSSY "${CYCLONEDDS_URI}${CYCLONEDDS_URI:+,}\
+<Discovery><ExternalDomainId>0</ExternalDomainId></Discovery>\
+<Internal><Test><XmitLossiness>50</XmitLossiness></Test></Internal>"
+
+#define DDS_CONFIG "${CYCLONEDDS_URI}${CYCLONEDDS_URI:+,}\
+<Discovery><ExternalDomainId>0</ExternalDomainId></Discovery>"
+
+#define DDS_CONFIG_FEC "<Internal>\
+  <ForwardErrorCorrection>\
+    <Enable>true</Enable>\
+    <GroupSize>8</GroupSize>\
+  </ForwardErrorCorrection>\
+</Internal>"
+
+static uint64_t get_reader_recovered_bytes (dds_entity_t rd)
+{
+  struct dds_statistics *stat = dds_create_statistics (rd);
+  CU_ASSERT_FATAL (stat != NULL);
+  dds_return_t rc = dds_refresh_statistics (stat);
+  CU_ASSERT_FATAL (rc == 0);
+  const struct dds_stat_keyvalue *kv = dds_lookup_statistic (stat, "recovered_bytes");
+  CU_ASSERT_FATAL (kv != NULL && kv->kind == DDS_STAT_KIND_UINT64);
+  const uint64_t v = kv->u.u64;
+  dds_delete_statistics (stat);
+  return v;
+}
+
+static uint32_t run_lossy (bool fec, uint64_t *recovered_bytes)
+{
+  dds_return_t rc;
+  char *config_pub = ddsrt_expand_envvars (fec ? DDS_CONFIG_LOSSY DDS_CONFIG_FEC : DDS_CONFIG_LOSSY, 0);
+  char *config_sub = ddsrt_expand_envvars (fec ? DDS_CONFIG DDS_CONFIG_FEC : DDS_CONFIG, 1);
+  const dds_entity_t dom_pub = dds_create_domain (0, config_pub);
+  CU_ASSERT_FATAL (dom_pub > 0);
+  const dds_entity_t dom_sub = dds_create_domain (1, config_sub);
+  CU_ASSERT_FATAL (dom_sub > 0);
+  ddsrt_free (config_pub);
+  ddsrt_free (config_sub);
+
+  char topicname[100];
+  create_unique_topic_name ("ddsc_fec", topicname, sizeof (topicname));
+  dds_qos_t *qos = dds_create_qos ();
+  // best-effort so that lost fragments stay lost unless parity restores them
+  dds_qset_reliability (qos, DDS_RELIABILITY_BEST_EFFORT, 0);
+  dds_qset_history (qos, DDS_HISTORY_KEEP_ALL, 0);
+  const dds_entity_t pp_pub = dds_create_participant (0, NULL, NULL);
+  CU_ASSERT_FATAL (pp_pub > 0);
+  const dds_entity_t pp_sub = dds_create_participant (1, NULL, NULL);
+  CU_ASSERT_FATAL (pp_sub > 0);
+  const dds_entity_t tp_pub = dds_create_topic (pp_pub, &RoundTripModule_DataType_desc, topicname, qos, NULL);
+  CU_ASSERT_FATAL (tp_pub > 0);
+  const dds_entity_t tp_sub = dds_create_topic (pp_sub, &RoundTripModule_DataType_desc, topicname, qos, NULL);
+  CU_ASSERT_FATAL (tp_sub > 0);
+  const dds_entity_t rd = dds_create_reader (pp_sub, tp_sub, qos, NULL);
+  CU_ASSERT_FATAL (rd > 0);
+  const dds_entity_t wr = dds_create_writer (pp_pub, tp_pub, qos, NULL);
+  CU_ASSERT_FATAL (wr > 0);
+  dds_delete_qos (qos);
+  sync_reader_writer (pp_sub, rd, pp_pub, wr);
+
+  unsigned char *payload = ddsrt_malloc (PAYLOAD_SIZE);
+  for (uint32_t i = 0; i < PAYLOAD_SIZE; i++)
+    payload[i] = (unsigned char) (i * 7);
+  const RoundTripModule_DataType sample = {
+    .payload = { ._length = PAYLOAD_SIZE, ._maximum = PAYLOAD_SIZE, ._buffer = payload }
+  };
+  for (uint32_t i = 0; i < NSAMPLES; i++)
+  {
+    rc = dds_write (wr, &sample);
+    CU_ASSERT_FATAL (rc == 0);
+    // don't let socket buffers overflow, the only losses should be the simulated ones
+    dds_sleepfor (DDS_MSECS (2));
+  }
+  dds_sleepfor (DDS_MSECS (500));
+
+  // samples either arrive intact or not at all
+  uint32_t count = 0;
+  void *raw[10] = { NULL };
+  dds_sample_info_t si[10];
+  int32_t nread;
+  while ((nread = dds_take (rd, raw, si, 10, 10)) > 0)
+  {
+    for (int32_t k = 0; k < nread; k++)
+    {
+      if (!si[k].valid_data)
+        continue;
+      const RoundTripModule_DataType *s = raw[k];
+      CU_ASSERT_FATAL (s->payload._length == PAYLOAD_SIZE);
+      CU_ASSERT_FATAL (memcmp (s->payload._buffer, payload, PAYLOAD_SIZE) == 0);
+      count++;
+    }
+    (void) dds_return_loan (rd, raw, nread);
+  }
+  ddsrt_free (payload);
+
+  *recovered_bytes = get_reader_recovered_bytes (rd);
+  rc = dds_delete (dom_pub);
+  CU_ASSERT_FATAL (rc == 0);
+  rc = dds_delete (dom_sub);
+  CU_ASSERT_FATAL (rc == 0);
+  return count;
+}
+
+CU_Test (ddsc_fec, lossy_link, .timeout = 60)
+{
+  uint64_t recovered_plain, recovered_fec;
+  const uint32_t count_plain = run_lossy (false, &recovered_plain);
+  const uint32_t count_fec = run_lossy (true, &recovered_fec);
+  tprintf ("received %"PRIu32"/%d without FEC, %"PRIu32"/%d with FEC (recovered %"PRIu64" bytes)\n",
+           count_plain, NSAMPLES, count_fec, NSAMPLES, recovered_fec);
+  CU_ASSERT (recovered_plain == 0);
+  CU_ASSERT (recovered_fec > 0);
+  CU_ASSERT (count_fec > count_plain);
+}
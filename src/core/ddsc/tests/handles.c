@@ -0,0 +1,212 @@
+// Copyright(c) 2025 ZettaScale Technology and others
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License v. 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Eclipse Distribution License
+// v. 1.0 which is available at
+// http://www.eclipse.org/org/documents/edl-v10.php.
+//
+// SPDX-License-Identifier: EPL-2.0 OR BSD-3-Clause
+
+#include <string.h>
+
+#include "CUnit/Theory.h"
+#include "test_util.h"
+
+#include "dds/dds.h"
+#include "dds/ddsrt/heap.h"
+#include "dds/ddsrt/atomics.h"
+#include "dds/ddsrt/threads.h"
+#include "dds/ddsrt/random.h"
+#include "dds__handles.h"
+
+#define N_HANDLES 1000
+#define N_CHURN_HANDLES 16
+#define MAX_THREADS 16
+
+static const dds_duration_t BENCH_DURATION = DDS_MSECS (500);
+
+struct pin_unpin_arg {
+  uint32_t seed;
+  ddsrt_atomic_uint32_t *stop;
+  const dds_handle_t *hdls;
+  ddsrt_atomic_uint32_t *churn_hdls;
+  uint64_t nops;
+  uint32_t nfailed_churn;
+};
+
+struct churn_arg {
+  ddsrt_atomic_uint32_t *stop;
+  ddsrt_atomic_uint32_t *churn_hdls;
+  uint32_t ncycles;
+};
+
+static uint32_t pin_unpin_thread (void *varg)
+{
+  struct pin_unpin_arg * const arg = varg;
+  ddsrt_prng_t prng;
+  ddsrt_prng_init_simple (&prng, arg->seed);
+  uint64_t nops = 0;
+  while (!ddsrt_atomic_ld32 (arg->stop))
+  {
+    for (int i = 0; i < 1000; i++)
+    {
+      const uint32_t r = ddsrt_prng_random (&prng);
+      struct dds_handle_link *link;
+      if (arg->churn_hdls && (r % 64) == 0)
+      {
+        // the handle may well have been deleted in the mean time, but if the pin
+        // succeeds it must be the one asked for
+        const dds_handle_t hdl = (dds_handle_t) ddsrt_atomic_ld32 (&arg->churn_hdls[(r >> 8) % N_CHURN_HANDLES]);
+        if (hdl == 0 || dds_handle_pin (hdl, &link) != DDS_RETCODE_OK)
+          arg->nfailed_churn++;
+        else
+        {
+          if (link->hdl != hdl)
+            return 1;
+          dds_handle_unpin (link);
+        }
+      }
+      else
+      {
+        const dds_handle_t hdl = arg->hdls[(r >> 8) % N_HANDLES];
+        if (dds_handle_pin (hdl, &link) != DDS_RETCODE_OK || link->hdl != hdl)
+          return 1;
+        dds_handle_unpin (link);
+      }
+    }
+    nops += 1000;
+  }
+  arg->nops = nops;
+  return 0;
+}
+
+static uint32_t churn_thread (void *varg)
+{
+  struct churn_arg * const arg = varg;
+  struct dds_handle_link *links[N_CHURN_HANDLES] = { NULL };
+  uint32_t i = 0;
+  while (!ddsrt_atomic_ld32 (arg->stop))
+  {
+    // delete the handle following the protocol dds_delete uses, then poison the
+    // memory before freeing it, so that a lookup that still uses it is likely to
+    // trip the assertions in the pin operations
+    if (links[i])
+    {
+      struct dds_handle_link *link;
+      const dds_handle_t hdl = links[i]->hdl;
+      ddsrt_atomic_st32 (&arg->churn_hdls[i], 0);
+      if (dds_handle_pin_for_delete (hdl, true, true, &link) != DDS_RETCODE_OK || link != links[i])
+        return 1;
+      dds_handle_close_wait (link);
+      (void) dds_handle_delete (link);
+      memset (link, 0xee, sizeof (*link));
+      ddsrt_free (link);
+    }
+    links[i] = ddsrt_malloc (sizeof (*links[i]));
+    const dds_handle_t hdl = dds_handle_create (links[i], false, false, true);
+    if (hdl <= 0)
+      return 1;
+    dds_handle_unpend (links[i]);
+    ddsrt_atomic_st32 (&arg->churn_hdls[i], (uint32_t) hdl);
+    i = (i + 1) % N_CHURN_HANDLES;
+    arg->ncycles++;
+  }
+  for (i = 0; i < N_CHURN_HANDLES; i++)
+  {
+    if (links[i] == NULL)
+      continue;
+    struct dds_handle_link *link;
+    if (dds_handle_pin_for_delete (links[i]->hdl, true, true, &link) != DDS_RETCODE_OK)
+      return 1;
+    dds_handle_close_wait (link);
+    (void) dds_handle_delete (link);
+    ddsrt_free (link);
+  }
+  return 0;
+}
+
+CU_TheoryDataPoints (ddsc_handles, pin_unpin) = {
+  CU_DataPoints (uint32_t, 1,     4,     16,    4,    16),   // number of pin/unpin threads
+  CU_DataPoints (bool,     false, false, false, true, true)  // concurrent create/delete
+};
+
+CU_Theory ((uint32_t nthreads, bool churn), ddsc_handles, pin_unpin, .timeout = 20)
+{
+  // The handle server is initialized when creating the first entity, and it is used
+  // without any further dependencies on the rest of the library
+  const dds_entity_t pp = dds_create_participant (DDS_DOMAIN_DEFAULT, NULL, NULL);
+  CU_ASSERT_FATAL (pp > 0);
+
+  static struct dds_handle_link links[N_HANDLES];
+  dds_handle_t hdls[N_HANDLES];
+  for (int i = 0; i < N_HANDLES; i++)
+  {
+    hdls[i] = dds_handle_create (&links[i], false, false, true);
+    CU_ASSERT_FATAL (hdls[i] > 0);
+    dds_handle_unpend (&links[i]);
+  }
+
+  ddsrt_atomic_uint32_t stop = DDSRT_ATOMIC_UINT32_INIT (0);
+  ddsrt_atomic_uint32_t churn_hdls[N_CHURN_HANDLES];
+  for (int i = 0; i < N_CHURN_HANDLES; i++)
+    ddsrt_atomic_st32 (&churn_hdls[i], 0);
+  ddsrt_threadattr_t tattr;
+  ddsrt_threadattr_init (&tattr);
+  ddsrt_thread_t tids[MAX_THREADS], churn_tid;
+  struct pin_unpin_arg args[MAX_THREADS];
+  struct churn_arg churnarg = { .stop = &stop, .churn_hdls = churn_hdls, .ncycles = 0 };
+  dds_return_t rc;
+  CU_ASSERT_FATAL (nthreads <= MAX_THREADS);
+  if (churn)
+  {
+    rc = ddsrt_thread_create (&churn_tid, "churn", &tattr, churn_thread, &churnarg);
+    CU_ASSERT_FATAL (rc == DDS_RETCODE_OK);
+  }
+  const dds_time_t tstart = dds_time ();
+  for (uint32_t i = 0; i < nthreads; i++)
+  {
+    args[i] = (struct pin_unpin_arg) { .seed = i + 1, .stop = &stop, .hdls = hdls, .churn_hdls = churn ? churn_hdls : NULL };
+    rc = ddsrt_thread_create (&tids[i], "pin_unpin", &tattr, pin_unpin_thread, &args[i]);
+    CU_ASSERT_FATAL (rc == DDS_RETCODE_OK);
+  }
+  dds_sleepfor (BENCH_DURATION);
+  ddsrt_atomic_st32 (&stop, 1);
+  uint64_t nops = 0;
+  uint32_t nfailed_churn = 0;
+  for (uint32_t i = 0; i < nthreads; i++)
+  {
+    uint32_t retval;
+    rc = ddsrt_thread_join (tids[i], &retval);
+    CU_ASSERT_FATAL (rc == DDS_RETCODE_OK);
+    CU_ASSERT_FATAL (retval == 0);
+    nops += args[i].nops;
+    nfailed_churn += args[i].nfailed_churn;
+  }
+  const dds_time_t tend = dds_time ();
+  if (churn)
+  {
+    uint32_t retval;
+    rc = ddsrt_thread_join (churn_tid, &retval);
+    CU_ASSERT_FATAL (rc == DDS_RETCODE_OK);
+    CU_ASSERT_FATAL (retval == 0);
+  }
+
+  tprintf ("pin/unpin: %"PRIu32" threads%s: %.2f Mops/s (%"PRIu32" create/delete cycles, %"PRIu32" failed pins of deleted handles)\n",
+           nthreads, churn ? " with create/delete" : "", (double) nops / (double) (tend - tstart) * 1e3,
+           churnarg.ncycles, nfailed_churn);
+
+  // all pins must have been undone
+  for (int i = 0; i < N_HANDLES; i++)
+  {
+    CU_ASSERT_FATAL ((ddsrt_atomic_ldptr (&links[i].cnt_flags) & HDL_PINCOUNT_MASK) == 0);
+    struct dds_handle_link *link;
+    rc = dds_handle_pin_for_delete (hdls[i], true, true, &link);
+    CU_ASSERT_FATAL (rc == DDS_RETCODE_OK && link == &links[i]);
+    dds_handle_close_wait (link);
+    (void) dds_handle_delete (link);
+  }
+
+  rc = dds_delete (pp);
+  CU_ASSERT_FATAL (rc == DDS_RETCODE_OK);
+}
@@ -13,6 +13,7 @@
 
 #include "dds/dds.h"
 #include "dds/ddsrt/bswap.h"
+#include "dds/ddsrt/threads.h"
 
 #include "test_common.h"
 #include "InstanceHandleTypes.h"
@@ -220,3 +221,113 @@ CU_Test (ddsc_instance_handle, md5)
   CU_ASSERT_FATAL (rc == 0);
 #undef N
 }
+
+CU_Test (ddsc_instance_handle, thread_cache)
+{
+  // cache much smaller than the number of instances, so that there are plenty of evictions
+#define N 100
+  const char *config = "<Internal><InstanceMapShards>4</InstanceMapShards><ThreadInstanceCacheSize>8</ThreadInstanceCacheSize></Internal>";
+  char topicname[100];
+  dds_return_t rc;
+
+  const dds_entity_t dom = dds_create_domain (0, config);
+  CU_ASSERT_FATAL (dom > 0);
+  dp = dds_create_participant (0, NULL, NULL);
+  CU_ASSERT_FATAL (dp > 0);
+  dds_qos_t *qos = dds_create_qos ();
+  CU_ASSERT_FATAL (qos != NULL);
+  dds_qset_history (qos, DDS_HISTORY_KEEP_LAST, 1);
+  dds_qset_reliability (qos, DDS_RELIABILITY_RELIABLE, DDS_INFINITY);
+  create_unique_topic_name ("instance_handle", topicname, sizeof (topicname));
+  tp[0] = dds_create_topic (dp, &InstanceHandleTypes_A_desc, topicname, qos, NULL);
+  CU_ASSERT_FATAL (tp[0] > 0);
+  dds_delete_qos (qos);
+  rd[0] = dds_create_reader (dp, tp[0], NULL, NULL);
+  CU_ASSERT_FATAL (rd[0] > 0);
+  wr[0] = dds_create_writer (dp, tp[0], NULL, NULL);
+  CU_ASSERT_FATAL (wr[0] > 0);
+
+  // write each instance a few times, interleaved, the handles must be the same as those
+  // returned by lookup_instance on the writer and the reader
+  dds_instance_handle_t ih[N];
+  for (uint32_t r = 0; r < 3; r++)
+  {
+    for (uint32_t k = 0; k < N; k++)
+    {
+      InstanceHandleTypes_A a = { .k = k, .v = r };
+      rc = dds_write (wr[0], &a);
+      CU_ASSERT_FATAL (rc == 0);
+      const dds_instance_handle_t h = dds_lookup_instance (wr[0], &a);
+      CU_ASSERT_FATAL (h != 0);
+      if (r == 0)
+        ih[k] = h;
+      else
+        CU_ASSERT (h == ih[k]);
+    }
+  }
+  for (uint32_t k = 0; k < N; k++)
+  {
+    InstanceHandleTypes_A a = { .k = k, .v = 0 }, b;
+    void *raw = &b;
+    dds_sample_info_t si;
+    CU_ASSERT (dds_lookup_instance (rd[0], &a) == ih[k]);
+    rc = dds_take_instance (rd[0], &raw, &si, 1, 1, ih[k]);
+    CU_ASSERT_FATAL (rc == 1);
+    CU_ASSERT (b.k == k && b.v == 2);
+    CU_ASSERT (si.instance_handle == ih[k]);
+  }
+
+  rc = dds_delete (dom);
+  CU_ASSERT_FATAL (rc == 0);
+#undef N
+}
+
+static uint32_t thread_cache_writer (void *varg)
+{
+  const dds_entity_t *writer = varg;
+  for (uint32_t k = 0; k < 10; k++)
+  {
+    InstanceHandleTypes_A a = { .k = k, .v = 0 };
+    if (dds_write (*writer, &a) != 0 || dds_unregister_instance (*writer, &a) != 0)
+      return 1;
+  }
+  return 0;
+}
+
+CU_Test (ddsc_instance_handle, thread_cache_exit)
+{
+  // a thread's cache keeps the instances it references alive, but only for as long
+  // as the thread exists
+  const char *config = "<Internal><ThreadInstanceCacheSize>16</ThreadInstanceCacheSize></Internal>";
+  char topicname[100];
+  dds_return_t rc;
+
+  const dds_entity_t dom = dds_create_domain (0, config);
+  CU_ASSERT_FATAL (dom > 0);
+  dp = dds_create_participant (0, NULL, NULL);
+  CU_ASSERT_FATAL (dp > 0);
+  create_unique_topic_name ("instance_handle", topicname, sizeof (topicname));
+  tp[0] = dds_create_topic (dp, &InstanceHandleTypes_A_desc, topicname, NULL, NULL);
+  CU_ASSERT_FATAL (tp[0] > 0);
+  wr[0] = dds_create_writer (dp, tp[0], NULL, NULL);
+  CU_ASSERT_FATAL (wr[0] > 0);
+
+  ddsrt_thread_t tid;
+  ddsrt_threadattr_t tattr;
+  ddsrt_threadattr_init (&tattr);
+  rc = ddsrt_thread_create (&tid, "thread_cache_writer", &tattr, thread_cache_writer, &wr[0]);
+  CU_ASSERT_FATAL (rc == 0);
+  uint32_t retval;
+  rc = ddsrt_thread_join (tid, &retval);
+  CU_ASSERT_FATAL (rc == 0);
+  CU_ASSERT_FATAL (retval == 0);
+
+  for (uint32_t k = 0; k < 10; k++)
+  {
+    InstanceHandleTypes_A a = { .k = k, .v = 0 };
+    CU_ASSERT (dds_lookup_instance (wr[0], &a) == 0);
+  }
+
+  rc = dds_delete (dom);
+  CU_ASSERT_FATAL (rc == 0);
+}
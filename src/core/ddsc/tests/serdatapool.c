@@ -0,0 +1,117 @@
+// Copyright(c) 2025 ZettaScale Technology and others
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License v. 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Eclipse Distribution License
+// v. 1.0 which is available at
+// http://www.eclipse.org/org/documents/edl-v10.php.
+//
+// SPDX-License-Identifier: EPL-2.0 OR BSD-3-Clause
+
+#include <inttypes.h>
+
+#include "CUnit/Test.h"
+#include "Space.h"
+#include "test_common.h"
+
+#include "dds/dds.h"
+#include "dds/ddsi/ddsi_mempool.h"
+#include "dds__entity.h"
+#include "dds__serdata_default.h"
+
+static void get_serdatapool_stats (dds_entity_t e, struct ddsi_mempool_stats *stats)
+{
+  struct dds_entity *x;
+  dds_return_t rc = dds_entity_pin (e, &x);
+  CU_ASSERT_FATAL (rc == 0);
+  ddsi_mempool_get_stats (x->m_domain->serpool->mempool, stats);
+  dds_entity_unpin (x);
+}
+
+static void write_take (dds_entity_t wr, dds_entity_t rd, int32_t n)
+{
+  for (int32_t i = 0; i < n; i++)
+  {
+    Space_Type1 s = { .long_1 = i % 10, .long_2 = i, .long_3 = 0 };
+    dds_return_t rc = dds_write (wr, &s);
+    CU_ASSERT_FATAL (rc == 0);
+    if (i % 100 == 99)
+    {
+      void *raw[10] = { NULL };
+      dds_sample_info_t si[10];
+      int32_t nread;
+      while ((nread = dds_take (rd, raw, si, 10, 10)) > 0)
+        (void) dds_return_loan (rd, raw, nread);
+    }
+  }
+}
+
+CU_Test (ddsc_serdatapool, steady_state)
+{
+  // Writing and taking samples of a type with a fixed serialised size over and
+  // over again must be served entirely from the serdata pool, no matter in which
+  // thread the samples get freed
+  const dds_entity_t pp = dds_create_participant (DDS_DOMAIN_DEFAULT, NULL, NULL);
+  CU_ASSERT_FATAL (pp > 0);
+  char topicname[100];
+  create_unique_topic_name ("ddsc_serdatapool", topicname, sizeof (topicname));
+  const dds_entity_t tp = dds_create_topic (pp, &Space_Type1_desc, topicname, NULL, NULL);
+  CU_ASSERT_FATAL (tp > 0);
+  dds_qos_t *qos = dds_create_qos ();
+  dds_qset_reliability (qos, DDS_RELIABILITY_RELIABLE, DDS_INFINITY);
+  dds_qset_history (qos, DDS_HISTORY_KEEP_LAST, 1);
+  const dds_entity_t rd = dds_create_reader (pp, tp, qos, NULL);
+  CU_ASSERT_FATAL (rd > 0);
+  const dds_entity_t wr = dds_create_writer (pp, tp, qos, NULL);
+  CU_ASSERT_FATAL (wr > 0);
+  dds_delete_qos (qos);
+
+  // warm-up, this also covers the instances getting created in the reader
+  write_take (wr, rd, 1000);
+
+  struct ddsi_mempool_stats st0, st1;
+  get_serdatapool_stats (pp, &st0);
+  write_take (wr, rd, 10000);
+  get_serdatapool_stats (pp, &st1);
+  const uint64_t gets = st1.gets - st0.gets, misses = gets - (st1.hits - st0.hits);
+  tprintf ("serdata pool: %"PRIu64" gets, %"PRIu64" misses, %"PRIu64" rejects, %"PRIu64" exchanges\n",
+           gets, misses, st1.rejects - st0.rejects, st1.exchanges - st0.exchanges);
+  CU_ASSERT (gets >= 10000);
+  CU_ASSERT (misses == 0);
+  CU_ASSERT (st1.rejects == st0.rejects);
+
+  dds_return_t rc = dds_delete (pp);
+  CU_ASSERT_FATAL (rc == 0);
+}
+
+CU_Test (ddsc_serdatapool, reserve)
+{
+  // Creating a topic of a type with a fixed serialised size puts objects in the
+  // serdata pool in advance, creating it again must add as many without taking any
+  // out of it
+  const dds_entity_t pp = dds_create_participant (DDS_DOMAIN_DEFAULT, NULL, NULL);
+  CU_ASSERT_FATAL (pp > 0);
+  char topicname[100];
+  create_unique_topic_name ("ddsc_serdatapool", topicname, sizeof (topicname));
+
+  struct ddsi_mempool_stats st[3];
+  dds_entity_t tp[2];
+  get_serdatapool_stats (pp, &st[0]);
+  for (int i = 0; i < 2; i++)
+  {
+    tp[i] = dds_create_topic (pp, &Space_Type1_desc, topicname, NULL, NULL);
+    CU_ASSERT_FATAL (tp[i] > 0);
+    get_serdatapool_stats (pp, &st[i + 1]);
+  }
+  CU_ASSERT (tp[0] != tp[1]);
+  CU_ASSERT (st[2].gets == st[0].gets);
+  CU_ASSERT (st[2].hits == st[0].hits);
+  const uint64_t nobjs0 = st[0].puts - st[0].hits;
+  const uint64_t nobjs1 = st[1].puts - st[1].hits;
+  const uint64_t nobjs2 = st[2].puts - st[2].hits;
+  CU_ASSERT (nobjs1 > nobjs0);
+  CU_ASSERT (nobjs2 - nobjs1 == nobjs1 - nobjs0);
+
+  dds_return_t rc = dds_delete (pp);
+  CU_ASSERT_FATAL (rc == 0);
+}
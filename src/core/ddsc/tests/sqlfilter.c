@@ -0,0 +1,487 @@
+// Copyright(c) 2025 ZettaScale Technology and others
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License v. 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Eclipse Distribution License
+// v. 1.0 which is available at
+// http://www.eclipse.org/org/documents/edl-v10.php.
+//
+// SPDX-License-Identifier: EPL-2.0 OR BSD-3-Clause
+
+#include <string.h>
+#include <inttypes.h>
+
+#include "CUnit/Test.h"
+#include "CUnit/Theory.h"
+#include "Space.h"
+#include "TypesArrayKey.h"
+#include "test_util.h"
+
+#include "dds/dds.h"
+#include "dds/ddsc/dds_statistics.h"
+#include "dds/ddsrt/heap.h"
+#include "dds/ddsrt/environ.h"
+
+#define DDS_CONFIG "${CYCLONEDDS_URI}${CYCLONEDDS_URI:+,}\
+<Discovery><ExternalDomainId>0</ExternalDomainId></Discovery>"
+
+#define NSAMPLES 8
+static const char *names[NSAMPLES] = { "alpha", "beta", "gamma", "delta", "alphabet", "b", "", "x'y" };
+
+static Space_filtertypes make_sample (int32_t id)
+{
+  Space_filtertypes s = {
+    .id = id,
+    .name = (char *) names[id % NSAMPLES],
+    .us = (uint16_t) (1000 * (id % NSAMPLES)),
+    .b = (id % 2) != 0,
+    .k = { .x = id, .y = -id },
+    .value = 10 * id
+  };
+  return s;
+}
+
+CU_Test (ddsc_sqlfilter, compile)
+{
+  char topicname[100];
+  const dds_entity_t pp = dds_create_participant (DDS_DOMAIN_DEFAULT, NULL, NULL);
+  CU_ASSERT_FATAL (pp > 0);
+  create_unique_topic_name ("ddsc_sqlfilter", topicname, sizeof (topicname));
+  const dds_entity_t tp = dds_create_topic (pp, &Space_filtertypes_desc, topicname, NULL, NULL);
+  CU_ASSERT_FATAL (tp > 0);
+
+  static const struct {
+    const char *expr;
+    uint32_t nparams;
+    const char *params[2];
+    dds_return_t rc;
+  } cases[] = {
+    { "id = 1", 0, { NULL }, DDS_RETCODE_OK },
+    { "id = %0 and name like %1", 2, { "3", "'x%'" }, DDS_RETCODE_OK },
+    { "NOT (k.x BETWEEN -1 AND 0x10) OR b = TRUE", 0, { NULL }, DDS_RETCODE_OK },
+    { "us <> 1.5e3", 0, { NULL }, DDS_RETCODE_OK },
+    { "1 = 1", 0, { NULL }, DDS_RETCODE_OK },
+    { "", 0, { NULL }, DDS_RETCODE_BAD_PARAMETER },
+    { "id =", 0, { NULL }, DDS_RETCODE_BAD_PARAMETER },
+    { "(id = 1", 0, { NULL }, DDS_RETCODE_BAD_PARAMETER },
+    { "id = 1 id", 0, { NULL }, DDS_RETCODE_BAD_PARAMETER },
+    { "id = 'abc", 0, { NULL }, DDS_RETCODE_BAD_PARAMETER },
+    { "id = 12abc", 0, { NULL }, DDS_RETCODE_BAD_PARAMETER },
+#ifdef DDS_HAS_TYPELIB
+    { "value = 1", 0, { NULL }, DDS_RETCODE_OK },
+    { "k.z = 1", 0, { NULL }, DDS_RETCODE_UNSUPPORTED },
+    { "nosuch = 1", 0, { NULL }, DDS_RETCODE_BAD_PARAMETER },
+    { "value = 'a'", 0, { NULL }, DDS_RETCODE_BAD_PARAMETER },
+#else
+    { "value = 1", 0, { NULL }, DDS_RETCODE_UNSUPPORTED },
+#endif
+    { "k = 1", 0, { NULL }, DDS_RETCODE_BAD_PARAMETER },
+    { "name = 1", 0, { NULL }, DDS_RETCODE_BAD_PARAMETER },
+    { "id LIKE 'a'", 0, { NULL }, DDS_RETCODE_BAD_PARAMETER },
+    { "b = 1", 0, { NULL }, DDS_RETCODE_BAD_PARAMETER },
+    { "id = %1", 1, { "1" }, DDS_RETCODE_BAD_PARAMETER },
+    { "id = %0", 1, { "1 2" }, DDS_RETCODE_BAD_PARAMETER },
+    { "id = %0", 1, { "id" }, DDS_RETCODE_BAD_PARAMETER },
+    { "id = 99999999999999999999", 0, { NULL }, DDS_RETCODE_BAD_PARAMETER }
+  };
+  for (size_t i = 0; i < sizeof (cases) / sizeof (cases[0]); i++)
+  {
+    dds_return_t rc = dds_set_topic_filter_expression (tp, cases[i].expr, cases[i].nparams, cases[i].params);
+    tprintf ("%s: %"PRId32" (expected %"PRId32")\n", cases[i].expr, rc, cases[i].rc);
+    CU_ASSERT (rc == cases[i].rc);
+  }
+  CU_ASSERT (dds_set_topic_filter_expression (tp, NULL, 0, NULL) == DDS_RETCODE_OK);
+
+  // array key fields are not supported
+  create_unique_topic_name ("ddsc_sqlfilter", topicname, sizeof (topicname));
+  const dds_entity_t tp_arr = dds_create_topic (pp, &TypesArrayKey_long_arraytypekey_desc, topicname, NULL, NULL);
+  CU_ASSERT_FATAL (tp_arr > 0);
+  CU_ASSERT (dds_set_topic_filter_expression (tp_arr, "key = 1", 0, NULL) == DDS_RETCODE_UNSUPPORTED);
+  CU_ASSERT (dds_set_topic_filter_expression (tp_arr, "2 > 1", 0, NULL) == DDS_RETCODE_OK);
+
+  dds_return_t rc = dds_delete (pp);
+  CU_ASSERT_FATAL (rc == 0);
+}
+
+static uint32_t read_ids (dds_entity_t rd)
+{
+  uint32_t mask = 0;
+  void *raw[NSAMPLES] = { NULL };
+  dds_sample_info_t si[NSAMPLES];
+  int32_t n;
+  while ((n = dds_take (rd, raw, si, NSAMPLES, NSAMPLES)) > 0)
+  {
+    for (int32_t i = 0; i < n; i++)
+    {
+      // id is the first member of all types used here
+      const int32_t *id = raw[i];
+      if (si[i].valid_data)
+        mask |= 1u << (*id % 32);
+    }
+    (void) dds_return_loan (rd, raw, n);
+  }
+  return mask;
+}
+
+CU_TheoryDataPoints (ddsc_sqlfilter, reader) = {
+  CU_DataPoints (const char *,
+    "id = 3",
+    "id BETWEEN %0 AND %1",
+    "id NOT BETWEEN 2 AND 4",
+    "name LIKE 'alpha%'",
+    "name LIKE '_'",
+    "name = 'x''y'",
+    "name NOT LIKE '%a%'",
+    "us >= 5000 OR b = TRUE",
+    "NOT (id < 6 AND b = FALSE)",
+    "k.y < -5",
+    "k.y > %0",
+    "id <> k.x",
+    "1 = 1",
+    "id > 4294967296",
+    "(id = 1 OR id = 2) AND name LIKE '%e%'"
+#ifdef DDS_HAS_TYPELIB
+    , "value BETWEEN 30 AND %0",
+    "b = TRUE AND value > 20"
+#endif
+    ),
+  CU_DataPoints (const char *,
+    NULL,  "2",   NULL,  NULL,  NULL,  NULL,  NULL,  NULL,  NULL,  NULL,  "-2.5", NULL,  NULL,  NULL,  NULL
+#ifdef DDS_HAS_TYPELIB
+    , "50", NULL
+#endif
+    ),
+  CU_DataPoints (const char *,
+    NULL,  "4",   NULL,  NULL,  NULL,  NULL,  NULL,  NULL,  NULL,  NULL,  NULL,   NULL,  NULL,  NULL,  NULL
+#ifdef DDS_HAS_TYPELIB
+    , NULL, NULL
+#endif
+    ),
+  CU_DataPoints (uint32_t,
+    0x08,  0x1c,  0xe3,  0x11,  0x20,  0x80,  0xe0,  0xea,  0xea,  0xc0,  0x07,   0x00,  0xff,  0x00,  0x02
+#ifdef DDS_HAS_TYPELIB
+    , 0x38, 0xa8
+#endif
+    )
+};
+
+CU_Theory ((const char *expr, const char *par0, const char *par1, uint32_t expected), ddsc_sqlfilter, reader)
+{
+  char topicname[100];
+  dds_return_t rc;
+  const dds_entity_t pp = dds_create_participant (DDS_DOMAIN_DEFAULT, NULL, NULL);
+  CU_ASSERT_FATAL (pp > 0);
+  create_unique_topic_name ("ddsc_sqlfilter", topicname, sizeof (topicname));
+  dds_qos_t *qos = dds_create_qos ();
+  dds_qset_reliability (qos, DDS_RELIABILITY_RELIABLE, DDS_INFINITY);
+  dds_qset_history (qos, DDS_HISTORY_KEEP_ALL, 0);
+  const dds_entity_t tp = dds_create_topic (pp, &Space_filtertypes_desc, topicname, qos, NULL);
+  CU_ASSERT_FATAL (tp > 0);
+  const char *params[] = { par0, par1 };
+  const uint32_t nparams = par1 ? 2 : par0 ? 1 : 0;
+  rc = dds_set_topic_filter_expression (tp, expr, nparams, params);
+  CU_ASSERT_FATAL (rc == 0);
+  const dds_entity_t rd = dds_create_reader (pp, tp, qos, NULL);
+  CU_ASSERT_FATAL (rd > 0);
+  const dds_entity_t wr = dds_create_writer (pp, tp, qos, NULL);
+  CU_ASSERT_FATAL (wr > 0);
+  dds_delete_qos (qos);
+
+  for (int32_t i = 0; i < NSAMPLES; i++)
+  {
+    const Space_filtertypes s = make_sample (i);
+    rc = dds_write (wr, &s);
+    CU_ASSERT_FATAL (rc == 0);
+  }
+  // invalid samples are not subject to the filter
+  const Space_filtertypes s = make_sample (0);
+  rc = dds_unregister_instance (wr, &s);
+  CU_ASSERT_FATAL (rc == 0);
+  const uint32_t mask = read_ids (rd);
+  tprintf ("%s: %"PRIx32" (expected %"PRIx32")\n", expr, mask, expected);
+  CU_ASSERT (mask == expected);
+  rc = dds_delete (pp);
+  CU_ASSERT_FATAL (rc == 0);
+}
+
+#ifdef DDS_HAS_TYPELIB
+static void write_members (dds_entity_t wr, int32_t id)
+{
+  int32_t seq[NSAMPLES];
+  char *strs[NSAMPLES];
+  Space_filterinner inners[NSAMPLES];
+  for (int32_t i = 0; i < id; i++)
+  {
+    seq[i] = i;
+    strs[i] = (char *) names[i];
+    inners[i] = (Space_filterinner) { .a = i, .t = (char *) names[i] };
+  }
+  const Space_filtermembers s = {
+    .id = id,
+    .seq = { ._length = (uint32_t) id, ._buffer = seq },
+    .name = (char *) names[id % NSAMPLES],
+    .inner = { .a = id, .t = (char *) names[id % NSAMPLES] },
+    .arr = { id, -id, id },
+    .strs = { ._length = (uint32_t) id, ._buffer = strs },
+    .inners = { ._length = (uint32_t) id, ._buffer = inners },
+    .o = (uint8_t) id,
+    .x = 1.25 * id
+  };
+  dds_return_t rc = dds_write (wr, &s);
+  CU_ASSERT_FATAL (rc == 0);
+}
+
+static void write_appendable (dds_entity_t wr, int32_t id)
+{
+  Space_filterinner inners[NSAMPLES];
+  for (int32_t i = 0; i < id; i++)
+    inners[i] = (Space_filterinner) { .a = i, .t = (char *) names[i] };
+  int32_t opt = id;
+  const Space_filterappendable s = {
+    .id = id,
+    .inners = { ._length = (uint32_t) id, ._buffer = inners },
+    .opt = (id % 2) == 0 ? &opt : NULL,
+    .s = (int16_t) (100 * id)
+  };
+  dds_return_t rc = dds_write (wr, &s);
+  CU_ASSERT_FATAL (rc == 0);
+}
+
+static uint32_t filter_members (const dds_topic_descriptor_t *desc, void (*write) (dds_entity_t wr, int32_t id), dds_data_representation_id_t datarep, const char *expr)
+{
+  char topicname[100];
+  dds_return_t rc;
+  const dds_entity_t pp = dds_create_participant (DDS_DOMAIN_DEFAULT, NULL, NULL);
+  CU_ASSERT_FATAL (pp > 0);
+  create_unique_topic_name ("ddsc_sqlfilter", topicname, sizeof (topicname));
+  dds_qos_t *qos = dds_create_qos ();
+  dds_qset_reliability (qos, DDS_RELIABILITY_RELIABLE, DDS_INFINITY);
+  dds_qset_history (qos, DDS_HISTORY_KEEP_ALL, 0);
+  dds_qset_data_representation (qos, 1, &datarep);
+  const dds_entity_t tp = dds_create_topic (pp, desc, topicname, qos, NULL);
+  CU_ASSERT_FATAL (tp > 0);
+  rc = dds_set_topic_filter_expression (tp, expr, 0, NULL);
+  CU_ASSERT_FATAL (rc == 0);
+  const dds_entity_t rd = dds_create_reader (pp, tp, qos, NULL);
+  CU_ASSERT_FATAL (rd > 0);
+  const dds_entity_t wr = dds_create_writer (pp, tp, qos, NULL);
+  CU_ASSERT_FATAL (wr > 0);
+  dds_delete_qos (qos);
+  for (int32_t i = 0; i < NSAMPLES; i++)
+    write (wr, i);
+  const uint32_t mask = read_ids (rd);
+  rc = dds_delete (pp);
+  CU_ASSERT_FATAL (rc == 0);
+  return mask;
+}
+
+CU_Test (ddsc_sqlfilter, members_compile)
+{
+  char topicname[100];
+  const dds_entity_t pp = dds_create_participant (DDS_DOMAIN_DEFAULT, NULL, NULL);
+  CU_ASSERT_FATAL (pp > 0);
+  create_unique_topic_name ("ddsc_sqlfilter", topicname, sizeof (topicname));
+  const dds_entity_t tp = dds_create_topic (pp, &Space_filtermembers_desc, topicname, NULL, NULL);
+  CU_ASSERT_FATAL (tp > 0);
+
+  static const struct {
+    const char *expr;
+    dds_return_t rc;
+  } cases[] = {
+    { "o = 1 AND name LIKE 'a%' AND x < 1e3", DDS_RETCODE_OK },
+    { "inner = 1", DDS_RETCODE_BAD_PARAMETER },
+    { "nosuch = 1", DDS_RETCODE_BAD_PARAMETER },
+    { "name = o", DDS_RETCODE_BAD_PARAMETER },
+    { "seq = 1", DDS_RETCODE_UNSUPPORTED },
+    { "arr = 1", DDS_RETCODE_UNSUPPORTED },
+    { "inner.a = 1", DDS_RETCODE_UNSUPPORTED }
+  };
+  for (size_t i = 0; i < sizeof (cases) / sizeof (cases[0]); i++)
+  {
+    dds_return_t rc = dds_set_topic_filter_expression (tp, cases[i].expr, 0, NULL);
+    tprintf ("%s: %"PRId32" (expected %"PRId32")\n", cases[i].expr, rc, cases[i].rc);
+    CU_ASSERT (rc == cases[i].rc);
+  }
+
+  dds_return_t rc = dds_delete (pp);
+  CU_ASSERT_FATAL (rc == 0);
+}
+
+CU_TheoryDataPoints (ddsc_sqlfilter, members) = {
+  CU_DataPoints (const char *,
+    "o = 3",
+    "x > 2.5",
+    "name LIKE 'alpha%' AND o < 4",
+    "id = 1 OR x = 8.75"),
+  CU_DataPoints (uint32_t,
+    0x08,  0xf8,  0x01,  0x82)
+};
+
+CU_Theory ((const char *expr, uint32_t expected), ddsc_sqlfilter, members)
+{
+  // the members follow sequences of strings and structs, which get walked in XCDR1
+  // and skipped using the DHEADER in XCDR2
+  static const dds_data_representation_id_t datareps[] = { DDS_DATA_REPRESENTATION_XCDR1, DDS_DATA_REPRESENTATION_XCDR2 };
+  for (size_t i = 0; i < sizeof (datareps) / sizeof (datareps[0]); i++)
+  {
+    const uint32_t mask = filter_members (&Space_filtermembers_desc, write_members, datareps[i], expr);
+    tprintf ("%s (XCDR%d): %"PRIx32" (expected %"PRIx32")\n", expr, (datareps[i] == DDS_DATA_REPRESENTATION_XCDR1) ? 1 : 2, mask, expected);
+    CU_ASSERT (mask == expected);
+  }
+}
+
+CU_TheoryDataPoints (ddsc_sqlfilter, members_appendable) = {
+  CU_DataPoints (const char *,
+    "s = 300",
+    "opt >= 4",
+    "opt = 2 OR id = 1",
+    "id BETWEEN 2 AND 3"),
+  CU_DataPoints (uint32_t,
+    0x08,  0x50,  0x04,  0x0c)
+};
+
+CU_Theory ((const char *expr, uint32_t expected), ddsc_sqlfilter, members_appendable)
+{
+  // opt is only present for even ids, samples without it never match if it is
+  // referenced; key fields of appendable types are taken from the data
+  const uint32_t mask = filter_members (&Space_filterappendable_desc, write_appendable, DDS_DATA_REPRESENTATION_XCDR2, expr);
+  tprintf ("%s: %"PRIx32" (expected %"PRIx32")\n", expr, mask, expected);
+  CU_ASSERT (mask == expected);
+}
+#endif
+
+static uint64_t get_writer_filtered_samples (dds_entity_t wr)
+{
+  struct dds_statistics *stat = dds_create_statistics (wr);
+  CU_ASSERT_FATAL (stat != NULL);
+  dds_return_t rc = dds_refresh_statistics (stat);
+  CU_ASSERT_FATAL (rc == 0);
+  const struct dds_stat_keyvalue *kv = dds_lookup_statistic (stat, "filtered_samples");
+  CU_ASSERT_FATAL (kv != NULL && kv->kind == DDS_STAT_KIND_UINT64);
+  const uint64_t v = kv->u.u64;
+  dds_delete_statistics (stat);
+  return v;
+}
+
+static void write_samples_mixed (dds_entity_t wr)
+{
+  // filtered, filtered + accepted, accepted, filtered: alternating between plain
+  // writes and batches, so that each starts with a GAP for filtered samples pending
+  const int32_t ids[][4] = { { 0 }, { 1, 2 }, { 3 }, { 4, 5, 6, 7 } };
+  const uint32_t nids[] = { 1, 2, 1, 4 };
+  for (size_t i = 0; i < sizeof (nids) / sizeof (nids[0]); i++)
+  {
+    Space_filtertypes s[4];
+    const void *ptrs[4];
+    dds_return_t rc;
+    for (uint32_t j = 0; j < nids[i]; j++)
+    {
+      s[j] = make_sample (ids[i][j]);
+      ptrs[j] = &s[j];
+    }
+    if (nids[i] == 1)
+      rc = dds_write (wr, ptrs[0]);
+    else
+      rc = dds_write_batch (wr, ptrs, nids[i], NULL, NULL);
+    CU_ASSERT_FATAL (rc == 0);
+  }
+}
+
+static void do_writer_side (bool unfiltered_reader, bool batch)
+{
+  dds_return_t rc;
+  char *config_pub = ddsrt_expand_envvars (DDS_CONFIG, 0);
+  char *config_sub = ddsrt_expand_envvars (DDS_CONFIG, 1);
+  const dds_entity_t dom_pub = dds_create_domain (0, config_pub);
+  CU_ASSERT_FATAL (dom_pub > 0);
+  const dds_entity_t dom_sub = dds_create_domain (1, config_sub);
+  CU_ASSERT_FATAL (dom_sub > 0);
+  ddsrt_free (config_pub);
+  ddsrt_free (config_sub);
+
+  char topicname[100];
+  create_unique_topic_name ("ddsc_sqlfilter", topicname, sizeof (topicname));
+  dds_qos_t *qos = dds_create_qos ();
+  dds_qset_reliability (qos, DDS_RELIABILITY_RELIABLE, DDS_INFINITY);
+  dds_qset_history (qos, DDS_HISTORY_KEEP_ALL, 0);
+  const dds_entity_t pp_pub = dds_create_participant (0, NULL, NULL);
+  CU_ASSERT_FATAL (pp_pub > 0);
+  const dds_entity_t pp_sub = dds_create_participant (1, NULL, NULL);
+  CU_ASSERT_FATAL (pp_sub > 0);
+  const dds_entity_t tp_pub = dds_create_topic (pp_pub, &Space_filtertypes_desc, topicname, qos, NULL);
+  CU_ASSERT_FATAL (tp_pub > 0);
+  const dds_entity_t tp_sub = dds_create_topic (pp_sub, &Space_filtertypes_desc, topicname, qos, NULL);
+  CU_ASSERT_FATAL (tp_sub > 0);
+  const char *params[] = { "2", "3" };
+  rc = dds_set_topic_filter_expression (tp_sub, "id BETWEEN %0 AND %1", 2, params);
+  CU_ASSERT_FATAL (rc == 0);
+  const dds_entity_t rd = dds_create_reader (pp_sub, tp_sub, qos, NULL);
+  CU_ASSERT_FATAL (rd > 0);
+  const dds_entity_t wr = dds_create_writer (pp_pub, tp_pub, qos, NULL);
+  CU_ASSERT_FATAL (wr > 0);
+  sync_reader_writer (pp_sub, rd, pp_pub, wr);
+  dds_entity_t rd_all = 0;
+  if (unfiltered_reader)
+  {
+    const dds_entity_t tp_sub_all = dds_create_topic (pp_sub, &Space_filtertypes_desc, topicname, qos, NULL);
+    CU_ASSERT_FATAL (tp_sub_all > 0);
+    rd_all = dds_create_reader (pp_sub, tp_sub_all, qos, NULL);
+    CU_ASSERT_FATAL (rd_all > 0);
+    sync_reader_writer (pp_sub, rd_all, pp_pub, wr);
+    // the writer's matched status is still set because of the first reader
+    dds_publication_matched_status_t st;
+    const dds_time_t tend = dds_time () + DDS_SECS (5);
+    while ((rc = dds_get_publication_matched_status (wr, &st)) == 0 && st.current_count < 2 && dds_time () < tend)
+      dds_sleepfor (DDS_MSECS (10));
+    CU_ASSERT_FATAL (rc == 0 && st.current_count == 2);
+  }
+  dds_delete_qos (qos);
+
+  // the last samples are filtered, so the readers must be informed through
+  // the retransmit mechanism that they will never arrive
+  if (batch)
+    write_samples_mixed (wr);
+  else
+  {
+    for (int32_t i = 0; i < NSAMPLES; i++)
+    {
+      const Space_filtertypes s = make_sample (i);
+      rc = dds_write (wr, &s);
+      CU_ASSERT_FATAL (rc == 0);
+    }
+  }
+  rc = dds_wait_for_acks (wr, DDS_SECS (10));
+  CU_ASSERT_FATAL (rc == 0);
+
+  // data is only guaranteed to be delivered once the reader acknowledged it
+  const uint32_t mask = read_ids (rd);
+  CU_ASSERT (mask == 0x0c);
+  if (unfiltered_reader)
+  {
+    const uint32_t mask_all = read_ids (rd_all);
+    CU_ASSERT (mask_all == 0xff);
+  }
+  const uint64_t filtered = get_writer_filtered_samples (wr);
+  tprintf ("filtered %"PRIu64"\n", filtered);
+  CU_ASSERT (filtered == (unfiltered_reader ? 0 : NSAMPLES - 2));
+
+  rc = dds_delete (dom_pub);
+  CU_ASSERT_FATAL (rc == 0);
+  rc = dds_delete (dom_sub);
+  CU_ASSERT_FATAL (rc == 0);
+}
+
+CU_Test (ddsc_sqlfilter, writer_side, .timeout = 30)
+{
+  do_writer_side (false, false);
+}
+
+CU_Test (ddsc_sqlfilter, writer_side_mixed, .timeout = 30)
+{
+  do_writer_side (true, false);
+}
+
+CU_Test (ddsc_sqlfilter, writer_side_batch, .timeout = 30)
+{
+  do_writer_side (false, true);
+}
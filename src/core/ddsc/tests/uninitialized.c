@@ -116,6 +116,7 @@ CU_Test (ddsc_uninitialized, various)
 
   check (dds_get_topic_filter_and_arg (1, NULL, NULL));
   check (dds_get_topic_filter_extended (1, &filter));
+  check (dds_set_topic_filter_expression (1, "x = 1", 0, NULL));
 
   check (dds_create_subscriber (1, NULL, NULL));
   check (dds_create_publisher (1, NULL, NULL));
@@ -147,6 +148,7 @@ CU_Test (ddsc_uninitialized, various)
   check (dds_writecdr (1, &serdata));
   check (dds_forwardcdr (1, &serdata));
   check (dds_write_ts (1, &data, 1));
+  check (dds_write_batch (1, (const void *[]) { &data }, 1, NULL, NULL));
 
   check (dds_create_readcondition (1, DDS_ANY_STATE));
   check (dds_create_querycondition (1, DDS_ANY_STATE, filter_fn));
@@ -17,8 +17,10 @@
 #include "dds/ddsrt/environ.h"
 #include "dds/ddsi/ddsi_entity_index.h"
 #include "dds/ddsi/ddsi_entity.h"
+#include "dds/ddsi/ddsi_serdata.h"
 #include "ddsi__whc.h"
 #include "dds__entity.h"
+#include "dds__whc_ring.h"
 
 #include "test_common.h"
 
@@ -300,3 +302,120 @@ CU_Test(ddsc_whc, check_end_state, .init=whc_init, .fini=whc_fini, .timeout=30)
 #undef BE
 #undef KA
 #undef KL
+
+static struct ddsi_serdata *ring_make_sample (const struct ddsi_sertype *type, int32_t v, uint32_t statusinfo)
+{
+  const Space_Type3 sample = { v, 0, 0 };
+  struct ddsi_serdata *sd = ddsi_serdata_from_sample (type, statusinfo ? SDK_KEY : SDK_DATA, &sample);
+  CU_ASSERT_FATAL (sd != NULL);
+  sd->statusinfo = statusinfo;
+  return sd;
+}
+
+static void ring_insert (struct ddsi_whc *whc, const struct ddsi_sertype *type, ddsi_seqno_t max_drop_seq, ddsi_seqno_t seq, uint32_t statusinfo)
+{
+  struct ddsi_serdata *sd = ring_make_sample (type, (int32_t) seq, statusinfo);
+  int ret = ddsi_whc_insert (whc, max_drop_seq, seq, DDSRT_MTIME_NEVER, sd, NULL);
+  CU_ASSERT_FATAL (ret == 0);
+  ddsi_serdata_unref (sd);
+}
+
+static uint32_t ring_remove_acked (struct ddsi_whc *whc, ddsi_seqno_t max_drop_seq, struct ddsi_whc_state *whcst)
+{
+  struct ddsi_whc_node *deferred_free_list;
+  uint32_t n = ddsi_whc_remove_acked_messages (whc, max_drop_seq, whcst, &deferred_free_list);
+  ddsi_whc_free_deferred_free_list (whc, deferred_free_list);
+  return n;
+}
+
+static uint32_t ring_count (struct ddsi_whc *whc)
+{
+  struct ddsi_whc_sample_iter it;
+  struct ddsi_whc_borrowed_sample sample;
+  ddsi_seqno_t prev = 0;
+  uint32_t n = 0;
+  ddsi_whc_sample_iter_init (whc, &it);
+  while (ddsi_whc_sample_iter_borrow_next (&it, &sample))
+  {
+    CU_ASSERT_FATAL (sample.seq > prev);
+    CU_ASSERT_FATAL (ddsi_whc_next_seq (whc, prev) == sample.seq);
+    prev = sample.seq;
+    n++;
+  }
+  CU_ASSERT_FATAL (ddsi_whc_next_seq (whc, prev) == DDSI_MAX_SEQ_NUMBER);
+  return n;
+}
+
+CU_Test(ddsc_whc, ring, .init=whc_init, .fini=whc_fini, .timeout=30)
+{
+  char name[100];
+  struct ddsi_whc_state whcst;
+  struct ddsi_whc_borrowed_sample sample;
+  struct ddsi_whc *whc;
+  struct dds_entity *x;
+  uint32_t n;
+
+  create_unique_topic_name ("ddsc_whc_ring", name, sizeof name);
+  const dds_entity_t topic = dds_create_topic (g_participant, &Space_Type3_desc, name, NULL, NULL);
+  CU_ASSERT_FATAL (topic > 0);
+  dds_return_t ret = dds_entity_pin (topic, &x);
+  CU_ASSERT_FATAL (ret == DDS_RETCODE_OK);
+  const struct ddsi_sertype *type = ((struct dds_topic *) x)->m_stype;
+  struct ddsi_domaingv * const gv = &x->m_domain->gv;
+
+  /* KEEP_ALL: must grow beyond the initial size and retain everything until acked */
+  whc = dds_whc_ring_new (gv, 0);
+  for (ddsi_seqno_t seq = 1; seq <= 100; seq++)
+    ring_insert (whc, type, 0, seq, 0);
+  ddsi_whc_get_state (whc, &whcst);
+  CU_ASSERT_FATAL (whcst.min_seq == 1 && whcst.max_seq == 100 && whcst.unacked_bytes > 0);
+  CU_ASSERT_FATAL (ring_count (whc) == 100);
+  CU_ASSERT_FATAL (ddsi_whc_borrow_sample (whc, 50, &sample) && sample.seq == 50 && sample.unacked);
+  n = ring_remove_acked (whc, 60, &whcst);
+  CU_ASSERT_FATAL (n == 60 && whcst.min_seq == 61 && whcst.max_seq == 100);
+  /* the borrowed sample is gone, returning it must release it */
+  ddsi_whc_return_sample (whc, &sample, false);
+  CU_ASSERT_FATAL (!ddsi_whc_borrow_sample (whc, 50, &sample));
+  CU_ASSERT_FATAL (ddsi_whc_next_seq (whc, 10) == 61);
+  CU_ASSERT_FATAL (ring_count (whc) == 40);
+  /* wrapping around without growing */
+  for (ddsi_seqno_t seq = 101; seq <= 150; seq++)
+    ring_insert (whc, type, 60, seq, 0);
+  CU_ASSERT_FATAL (ring_count (whc) == 90);
+  CU_ASSERT_FATAL (ddsi_whc_borrow_sample_key (whc, NULL, &sample) && sample.seq == 150);
+  ddsi_whc_return_sample (whc, &sample, false);
+  n = ring_remove_acked (whc, 150, &whcst);
+  CU_ASSERT_FATAL (n == 90 && DDSI_WHCST_ISEMPTY (&whcst) && whcst.unacked_bytes == 0);
+  /* a gap in sequence numbers once empty */
+  ring_insert (whc, type, 150, 1000, 0);
+  ddsi_whc_get_state (whc, &whcst);
+  CU_ASSERT_FATAL (whcst.min_seq == 1000 && whcst.max_seq == 1000);
+  ddsi_whc_free (whc);
+
+  /* KEEP_LAST 3: oldest samples get pruned even when unacked, but not after an
+     unregister has ended the instance's history */
+  whc = dds_whc_ring_new (gv, 3);
+  for (ddsi_seqno_t seq = 1; seq <= 10; seq++)
+    ring_insert (whc, type, 0, seq, 0);
+  ddsi_whc_get_state (whc, &whcst);
+  CU_ASSERT_FATAL (whcst.min_seq == 8 && whcst.max_seq == 10);
+  CU_ASSERT_FATAL (ring_count (whc) == 3);
+  ring_insert (whc, type, 0, 11, DDSI_STATUSINFO_UNREGISTER);
+  CU_ASSERT_FATAL (!ddsi_whc_borrow_sample_key (whc, NULL, &sample));
+  ring_insert (whc, type, 0, 12, 0);
+  ring_insert (whc, type, 0, 13, 0);
+  CU_ASSERT_FATAL (ring_count (whc) == 6);
+  ring_insert (whc, type, 0, 14, 0);
+  ring_insert (whc, type, 0, 15, 0);
+  ddsi_whc_get_state (whc, &whcst);
+  CU_ASSERT_FATAL (whcst.min_seq == 8 && whcst.max_seq == 15);
+  CU_ASSERT_FATAL (ring_count (whc) == 7);
+  CU_ASSERT_FATAL (!ddsi_whc_borrow_sample (whc, 12, &sample));
+  CU_ASSERT_FATAL (ddsi_whc_next_seq (whc, 11) == 13);
+  n = ring_remove_acked (whc, 13, &whcst);
+  CU_ASSERT_FATAL (n == 5 && whcst.min_seq == 14 && whcst.max_seq == 15);
+  ddsi_whc_free (whc);
+
+  dds_entity_unpin (x);
+  dds_delete (topic);
+}
@@ -20,6 +20,7 @@
 #include "dds/ddsrt/io.h"
 #include "dds/ddsrt/misc.h"
 #include "dds/ddsrt/heap.h"
+#include "dds/ddsrt/environ.h"
 
 /* Tests in this file only concern themselves with very basic api tests of
    dds_write and dds_write_ts */
@@ -355,3 +356,131 @@ CU_Test(ddsc_write, async_one_unrel_sample)
   CU_ASSERT_FATAL (result > 0);
 }
 
+
+#define DDS_CONFIG_NO_PORT_GAIN "${CYCLONEDDS_URI}${CYCLONEDDS_URI:+,}<Discovery><ExternalDomainId>0</ExternalDomainId></Discovery>"
+
+static void batch_set_payload (RoundTripModule_DataType *s, uint32_t seq, uint32_t size)
+{
+  s->payload._length = s->payload._maximum = size;
+  s->payload._buffer = ddsrt_malloc (size);
+  s->payload._release = true;
+  memset (s->payload._buffer, (int) (seq & 0xff), size);
+  memcpy (s->payload._buffer, &seq, sizeof (seq));
+}
+
+static void batch_check_received (dds_entity_t rd, uint32_t nexpected, const bool *skipped)
+{
+  uint32_t next = 0, count = 0;
+  const dds_time_t tend = dds_time () + DDS_SECS (10);
+  while (count < nexpected && dds_time () < tend)
+  {
+    void *raw[10] = { NULL };
+    dds_sample_info_t si[10];
+    int32_t n;
+    while ((n = dds_take (rd, raw, si, 10, 10)) > 0)
+    {
+      for (int32_t k = 0; k < n; k++)
+      {
+        if (!si[k].valid_data)
+          continue;
+        const RoundTripModule_DataType *s = raw[k];
+        uint32_t seq;
+        CU_ASSERT_FATAL (s->payload._length >= sizeof (seq));
+        memcpy (&seq, s->payload._buffer, sizeof (seq));
+        while (skipped[next])
+          next++;
+        CU_ASSERT_FATAL (seq == next);
+        next++;
+        count++;
+      }
+      (void) dds_return_loan (rd, raw, n);
+    }
+    dds_sleepfor (DDS_MSECS (10));
+  }
+  CU_ASSERT_FATAL (count == nexpected);
+}
+
+CU_Test(ddsc_write_batch, samples_and_results)
+{
+  // more samples than what gets processed in one go, some large ones that need to
+  // be fragmented and some invalid ones
+#define BATCH_N 150
+  dds_return_t rc;
+  char *config_pub = ddsrt_expand_envvars (DDS_CONFIG_NO_PORT_GAIN, 0);
+  char *config_sub = ddsrt_expand_envvars (DDS_CONFIG_NO_PORT_GAIN, 1);
+  const dds_entity_t dom_pub = dds_create_domain (0, config_pub);
+  CU_ASSERT_FATAL (dom_pub > 0);
+  const dds_entity_t dom_sub = dds_create_domain (1, config_sub);
+  CU_ASSERT_FATAL (dom_sub > 0);
+  ddsrt_free (config_pub);
+  ddsrt_free (config_sub);
+
+  char topicname[100];
+  create_unique_topic_name ("ddsc_write_batch", topicname, sizeof (topicname));
+  dds_qos_t *qos = dds_create_qos ();
+  dds_qset_reliability (qos, DDS_RELIABILITY_RELIABLE, DDS_INFINITY);
+  dds_qset_history (qos, DDS_HISTORY_KEEP_ALL, 0);
+  const dds_entity_t pp_sub = dds_create_participant (1, NULL, NULL);
+  CU_ASSERT_FATAL (pp_sub > 0);
+  const dds_entity_t tp_sub = dds_create_topic (pp_sub, &RoundTripModule_DataType_desc, topicname, qos, NULL);
+  CU_ASSERT_FATAL (tp_sub > 0);
+  const dds_entity_t rd_remote = dds_create_reader (pp_sub, tp_sub, qos, NULL);
+  CU_ASSERT_FATAL (rd_remote > 0);
+  const dds_entity_t pp_pub = dds_create_participant (0, NULL, NULL);
+  CU_ASSERT_FATAL (pp_pub > 0);
+  const dds_entity_t tp_pub = dds_create_topic (pp_pub, &RoundTripModule_DataType_desc, topicname, qos, NULL);
+  CU_ASSERT_FATAL (tp_pub > 0);
+  const dds_entity_t wr = dds_create_writer (pp_pub, tp_pub, qos, NULL);
+  CU_ASSERT_FATAL (wr > 0);
+  sync_reader_writer (pp_sub, rd_remote, pp_pub, wr);
+  // a local reader matches immediately, creating it before the writer has matched the
+  // remote reader would make the sync return early and the (volatile) remote reader
+  // then only gets the samples written after it matched
+  const dds_entity_t rd_local = dds_create_reader (pp_pub, tp_pub, qos, NULL);
+  CU_ASSERT_FATAL (rd_local > 0);
+  dds_delete_qos (qos);
+
+  RoundTripModule_DataType samples[BATCH_N];
+  const void *ptrs[BATCH_N];
+  dds_time_t tstamps[BATCH_N];
+  dds_return_t results[BATCH_N];
+  bool skipped[BATCH_N + 1] = { false };
+  uint32_t nvalid = 0;
+  const dds_time_t tnow = dds_time ();
+  for (uint32_t i = 0; i < BATCH_N; i++)
+  {
+    batch_set_payload (&samples[i], i, (i % 37) == 5 ? 20000 : 16);
+    ptrs[i] = &samples[i];
+    tstamps[i] = tnow + i;
+  }
+  ptrs[10] = NULL;
+  tstamps[70] = -1;
+  skipped[10] = skipped[70] = true;
+  rc = dds_write_batch (wr, ptrs, BATCH_N, tstamps, results);
+  CU_ASSERT_FATAL (rc == DDS_RETCODE_BAD_PARAMETER);
+  for (uint32_t i = 0; i < BATCH_N; i++)
+  {
+    CU_ASSERT_FATAL (results[i] == (skipped[i] ? DDS_RETCODE_BAD_PARAMETER : DDS_RETCODE_OK));
+    if (!skipped[i])
+      nvalid++;
+  }
+  for (uint32_t i = 0; i < BATCH_N; i++)
+    RoundTripModule_DataType_free (&samples[i], DDS_FREE_CONTENTS);
+
+  batch_check_received (rd_local, nvalid, skipped);
+  batch_check_received (rd_remote, nvalid, skipped);
+
+  // no samples, no results
+  rc = dds_write_batch (wr, NULL, 0, NULL, NULL);
+  CU_ASSERT_FATAL (rc == DDS_RETCODE_OK);
+  rc = dds_write_batch (wr, NULL, 1, NULL, NULL);
+  CU_ASSERT_FATAL (rc == DDS_RETCODE_BAD_PARAMETER);
+  rc = dds_write_batch (pp_pub, ptrs, 1, NULL, NULL);
+  CU_ASSERT_FATAL (rc == DDS_RETCODE_ILLEGAL_OPERATION);
+
+  rc = dds_delete (dom_pub);
+  CU_ASSERT_FATAL (rc == 0);
+  rc = dds_delete (dom_sub);
+  CU_ASSERT_FATAL (rc == 0);
+#undef BATCH_N
+}
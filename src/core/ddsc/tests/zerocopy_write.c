@@ -0,0 +1,152 @@
+// Copyright(c) 2025 ZettaScale Technology and others
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License v. 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Eclipse Distribution License
+// v. 1.0 which is available at
+// http://www.eclipse.org/org/documents/edl-v10.php.
+//
+// SPDX-License-Identifier: EPL-2.0 OR BSD-3-Clause
+
+#include <string.h>
+
+#include "CUnit/Theory.h"
+#include "RoundTrip.h"
+#include "test_util.h"
+
+#include "dds/dds.h"
+#include "dds/ddsrt/heap.h"
+#include "dds/ddsrt/io.h"
+#include "dds/ddsrt/environ.h"
+#include "dds/ddsi/ddsi_domaingv.h"
+#include "ddsi__xmsg.h"
+
+#define NSAMPLES 20
+#define SAMPLE_SIZE 100000
+
+#define DDS_CONFIG_NO_PORT_GAIN "${CYCLONEDDS_URI}${CYCLONEDDS_URI:+,}<Discovery><ExternalDomainId>0</ExternalDomainId></Discovery>"
+
+static void fill_payload (RoundTripModule_DataType *s, uint32_t seed)
+{
+  for (uint32_t k = 0; k < s->payload._length; k++)
+    s->payload._buffer[k] = (uint8_t) (seed + k * 7);
+}
+
+static bool check_payload (const RoundTripModule_DataType *s, uint32_t seed)
+{
+  if (s->payload._length != SAMPLE_SIZE)
+    return false;
+  for (uint32_t k = 0; k < s->payload._length; k++)
+    if (s->payload._buffer[k] != (uint8_t) (seed + k * 7))
+      return false;
+  return true;
+}
+
+CU_TheoryDataPoints (ddsc_zerocopy_write, large_samples) = {
+  CU_DataPoints (const char *, "0 B", "1 kB", "1 kB"), // threshold
+  CU_DataPoints (int,          1,     1,      4)       // send batch size
+};
+
+CU_Theory ((const char *threshold, int batch_size), ddsc_zerocopy_write, large_samples, .timeout = 30)
+{
+  dds_return_t rc;
+  char *config_pub_raw = NULL;
+  (void) ddsrt_asprintf (&config_pub_raw,
+    "%s"
+    "<Internal>"
+    "  <ZeroCopySendThreshold>%s</ZeroCopySendThreshold>"
+    "  <SendBatchSize>%d</SendBatchSize>"
+    "</Internal>",
+    DDS_CONFIG_NO_PORT_GAIN, threshold, batch_size);
+  char *config_pub = ddsrt_expand_envvars (config_pub_raw, 0);
+  char *config_sub = ddsrt_expand_envvars (DDS_CONFIG_NO_PORT_GAIN, 1);
+  ddsrt_free (config_pub_raw);
+  const dds_entity_t dom_pub = dds_create_domain (0, config_pub);
+  CU_ASSERT_FATAL (dom_pub > 0);
+  const dds_entity_t dom_sub = dds_create_domain (1, config_sub);
+  CU_ASSERT_FATAL (dom_sub > 0);
+  ddsrt_free (config_pub);
+  ddsrt_free (config_sub);
+
+  char topicname[100];
+  create_unique_topic_name ("ddsc_zerocopy_write", topicname, sizeof (topicname));
+  dds_qos_t *qos = dds_create_qos ();
+  dds_qset_reliability (qos, DDS_RELIABILITY_RELIABLE, DDS_INFINITY);
+  dds_qset_history (qos, DDS_HISTORY_KEEP_ALL, 0);
+  const dds_entity_t pp_sub = dds_create_participant (1, NULL, NULL);
+  CU_ASSERT_FATAL (pp_sub > 0);
+  const dds_entity_t tp_sub = dds_create_topic (pp_sub, &RoundTripModule_DataType_desc, topicname, qos, NULL);
+  CU_ASSERT_FATAL (tp_sub > 0);
+  const dds_entity_t rd = dds_create_reader (pp_sub, tp_sub, qos, NULL);
+  CU_ASSERT_FATAL (rd > 0);
+  const dds_entity_t pp_pub = dds_create_participant (0, NULL, NULL);
+  CU_ASSERT_FATAL (pp_pub > 0);
+  const dds_entity_t tp_pub = dds_create_topic (pp_pub, &RoundTripModule_DataType_desc, topicname, qos, NULL);
+  CU_ASSERT_FATAL (tp_pub > 0);
+  const dds_entity_t wr = dds_create_writer (pp_pub, tp_pub, qos, NULL);
+  CU_ASSERT_FATAL (wr > 0);
+  dds_delete_qos (qos);
+  sync_reader_writer (pp_sub, rd, pp_pub, wr);
+
+  // the serialised samples get freed while the kernel may still be sending them if
+  // the references get dropped too early, so change the contents for every sample
+  RoundTripModule_DataType s;
+  s.payload._length = s.payload._maximum = SAMPLE_SIZE;
+  s.payload._buffer = ddsrt_malloc (SAMPLE_SIZE);
+  s.payload._release = false;
+  for (uint32_t j = 0; j < NSAMPLES; j++)
+  {
+    fill_payload (&s, j);
+    rc = dds_write (wr, &s);
+    CU_ASSERT_FATAL (rc == 0);
+  }
+  ddsrt_free (s.payload._buffer);
+
+  uint32_t count = 0;
+  const dds_time_t tend = dds_time () + DDS_SECS (10);
+  while (count < NSAMPLES && dds_time () < tend)
+  {
+    void *raw[1] = { NULL };
+    dds_sample_info_t si;
+    while (dds_take (rd, raw, &si, 1, 1) > 0)
+    {
+      if (si.valid_data)
+      {
+        CU_ASSERT_FATAL (check_payload (raw[0], count));
+        count++;
+      }
+      (void) dds_return_loan (rd, raw, 1);
+    }
+    dds_sleepfor (DDS_MSECS (10));
+  }
+  CU_ASSERT_FATAL (count == NSAMPLES);
+
+  // all writes complete eventually, and then every packet is accounted for
+  const struct ddsi_domaingv *gv = get_domaingv (dom_pub);
+  CU_ASSERT_FATAL (gv != NULL);
+  struct ddsi_xpack_zerocopy_stats st;
+  ddsi_xpack_zerocopy_stats (gv, &st);
+  while (st.pending > 0 && dds_time () < tend)
+  {
+    dds_sleepfor (DDS_MSECS (10));
+    ddsi_xpack_zerocopy_stats (gv, &st);
+  }
+  CU_ASSERT_FATAL (st.pending == 0);
+  if (strcmp (threshold, "0 B") == 0)
+  {
+    CU_ASSERT_FATAL (st.sent == 0 && st.copied == 0);
+  }
+  else
+  {
+#if defined __linux
+    // the samples are fragmented, so each one takes many packets
+    CU_ASSERT_FATAL (st.sent + st.copied >= NSAMPLES * (SAMPLE_SIZE / gv->config.max_msg_size));
+    CU_ASSERT_FATAL (st.bytes_saved + st.bytes_copied >= (uint64_t) NSAMPLES * SAMPLE_SIZE);
+#endif
+  }
+
+  rc = dds_delete (dom_pub);
+  CU_ASSERT_FATAL (rc == 0);
+  rc = dds_delete (dom_sub);
+  CU_ASSERT_FATAL (rc == 0);
+}
@@ -73,12 +73,17 @@ void ddsi_config_init_default (struct ddsi_config *cfg)
   cfg->ack_delay = INT64_C (10000000);
   cfg->auto_resched_nack_delay = INT64_C (3000000000);
   cfg->preemptive_ack_delay = INT64_C (10000000);
+  cfg->ring_whc = INT32_C (1);
   cfg->max_sample_size = UINT32_C (2147483647);
   cfg->noprogress_log_stacktraces = INT32_C (1);
   cfg->liveliness_monitoring_interval = INT64_C (1000000000);
   cfg->monitor_port = INT32_C (-1);
   cfg->prioritize_retransmit = INT32_C (1);
   cfg->recv_thread_stop_maxretries = UINT32_C (4294967295);
+  cfg->data_recv_threads = INT32_C (1);
+  cfg->recv_batch_size = INT32_C (1);
+  cfg->send_batch_size = INT32_C (1);
+  cfg->tkmap_shards = INT32_C (16);
   cfg->whc_lowwater_mark = UINT32_C (1024);
   cfg->whc_highwater_mark = UINT32_C (512000);
   cfg->whc_init_highwater_mark.isdefault = 0;
@@ -87,6 +92,10 @@ void ddsi_config_init_default (struct ddsi_config *cfg)
   cfg->max_rexmit_burst_size = UINT32_C (1048576);
   cfg->init_transmit_extra_pct = UINT32_C (4294967295);
   cfg->max_frags_in_rexmit_of_sample = UINT32_C (1);
+  cfg->cc_initial_rate = UINT32_C (16777216);
+  cfg->cc_min_rate = UINT32_C (1048576);
+  cfg->cc_max_rate = UINT32_C (1073741824);
+  cfg->fec_group_size = UINT32_C (8);
   cfg->extended_packet_info = INT32_C (1);
   cfg->tcp_nodelay = INT32_C (1);
   cfg->tcp_port = INT32_C (-1);
@@ -103,14 +112,14 @@ void ddsi_config_init_default (struct ddsi_config *cfg)
   cfg->ssl_min_version.minor = 3;
 #endif /* DDS_HAS_TCP_TLS */
 }
-/* generated from ddsi_config.h[d7db98ce697e409412ec7fb0b900e10261a66c44] */
-/* generated from ddsi_config.c[184d7299baad5acc9b96884de77770aac009a11a] */
-/* generated from ddsi__cfgelems.h[741151ccf40cab43638e8c32cac3a4b9c3e73566] */
+/* generated from ddsi_config.h[b966082e60a83f6a2c0b760c2b50a44862e4c097] */
+/* generated from ddsi_config.c[71bfd4c7afa173cb7a0be80229f83727d7a37b98] */
+/* generated from ddsi__cfgelems.h[ae6368d954ea997195dfb821f0319de4b81388d1] */
 /* generated from cfgunits.h[05f093223fce107d24dd157ebaafa351dc9df752] */
-/* generated from _confgen.h[fd29634526c05c3237dbc3f785030fe022eb7875] */
+/* generated from _confgen.h[4af840163a5467b4c19e8f3d5b804990fa21a878] */
 /* generated from _confgen.c[0d833a6f2c98902f1249e63aed03a6164f0791d6] */
 /* generated from generate_rnc.c[b50e4b7ab1d04b2bc1d361a0811247c337b74934] */
 /* generated from generate_md.c[789b92e422631684352909cfb8bf43f6ceb16a01] */
 /* generated from generate_rst.c[3c4b523fbb57c8e4a7e247379d06a8021ccc21c4] */
 /* generated from generate_xsd.c[9bb91084fff7495aee9c025db3108549a0141957] */
-/* generated from generate_defconfig.c[ba599ccf70b6f1929c08a597a6c555ff2375e458] */
+/* generated from generate_defconfig.c[8e4285c477e1a693355976df6af3992c706e61c9] */
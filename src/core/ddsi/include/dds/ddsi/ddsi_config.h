@@ -48,6 +48,21 @@ enum ddsi_retransmit_merging {
   DDSI_REXMIT_MERGE_ALWAYS
 };
 
+enum ddsi_xeventq_impl {
+  DDSI_XEVQ_HEAP,
+  DDSI_XEVQ_WHEEL
+};
+
+enum ddsi_sock_waitset_impl {
+  DDSI_SOCKWS_DEFAULT,
+  DDSI_SOCKWS_IO_URING
+};
+
+enum ddsi_recv_steering {
+  DDSI_RECV_STEERING_KERNEL,
+  DDSI_RECV_STEERING_GUIDPREFIX
+};
+
 enum ddsi_boolean_default {
   DDSI_BOOLDEF_DEFAULT,
   DDSI_BOOLDEF_FALSE,
@@ -321,6 +336,16 @@ struct ddsi_config
   int64_t liveliness_monitoring_interval;
   int prioritize_retransmit;
   enum ddsi_boolean_default multiple_recv_threads;
+  int data_recv_threads;
+  enum ddsi_recv_steering data_recv_steering;
+  int recv_batch_size;
+  int send_batch_size;
+  uint32_t zerocopy_send_threshold;
+  enum ddsi_sock_waitset_impl sock_waitset_impl;
+  enum ddsi_xeventq_impl xeventq_impl;
+  int xeventq_shards;
+  int tkmap_shards;
+  int tkmap_cache_size;
   unsigned recv_thread_stop_maxretries;
 
   unsigned primary_reorder_maxsamples;
@@ -389,6 +414,14 @@ struct ddsi_config
   struct ddsi_config_maybe_uint32 whc_init_highwater_mark;
   int whc_adaptive;
 
+  int congestion_control;
+  uint32_t cc_initial_rate;
+  uint32_t cc_min_rate;
+  uint32_t cc_max_rate;
+
+  int fec;
+  uint32_t fec_group_size;
+
   unsigned defrag_unreliable_maxsamples;
   unsigned defrag_reliable_maxsamples;
   unsigned accelerate_rexmit_block_size;
@@ -407,6 +440,8 @@ struct ddsi_config
   unsigned max_queued_rexmit_msgs;
   int late_ack_mode;
   int retry_on_reject_besteffort;
+  int concurrent_rhc;
+  int ring_whc;
   int generate_keyhash;
   uint32_t max_sample_size;
   int extended_packet_info;
@@ -0,0 +1,59 @@
+// Copyright(c) 2025 ZettaScale Technology and others
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License v. 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Eclipse Distribution License
+// v. 1.0 which is available at
+// http://www.eclipse.org/org/documents/edl-v10.php.
+//
+// SPDX-License-Identifier: EPL-2.0 OR BSD-3-Clause
+
+#ifndef DDSI_CONTENT_FILTER_IF_H
+#define DDSI_CONTENT_FILTER_IF_H
+
+#include <stdbool.h>
+
+#if defined (__cplusplus)
+extern "C" {
+#endif
+
+struct ddsi_sertype;
+struct ddsi_serdata;
+struct ddsi_content_filter_property;
+
+/* Content filters advertised by remote readers are evaluated by writers to avoid
+   sending samples that no matched reader is interested in.  DDSI only knows the
+   filter as a string, the type-specific compilation and evaluation are provided
+   by the layer above.
+
+   - compile returns NULL if the filter can't be evaluated for the type, in which
+     case all samples are considered to pass the filter
+   - accepts must not block, it is called with the writer lock held */
+struct ddsi_content_filter_interface {
+  void *arg;
+
+  void * (*compile) (const struct ddsi_sertype *type, const struct ddsi_content_filter_property *cfp, void *arg);
+  bool (*accepts) (const void *filter, const struct ddsi_serdata *serdata, void *arg);
+  void (*free) (void *filter, void *arg);
+};
+
+/** @component content_filter_if */
+inline void *ddsi_content_filter_compile (const struct ddsi_content_filter_interface *cfif, const struct ddsi_sertype *type, const struct ddsi_content_filter_property *cfp) {
+  return cfif ? cfif->compile (type, cfp, cfif->arg) : NULL;
+}
+
+/** @component content_filter_if */
+inline bool ddsi_content_filter_accepts (const struct ddsi_content_filter_interface *cfif, const void *filter, const struct ddsi_serdata *serdata) {
+  return (cfif && filter) ? cfif->accepts (filter, serdata, cfif->arg) : true;
+}
+
+/** @component content_filter_if */
+inline void ddsi_content_filter_free (const struct ddsi_content_filter_interface *cfif, void *filter) {
+  if (cfif && filter) cfif->free (filter, cfif->arg);
+}
+
+#if defined (__cplusplus)
+}
+#endif
+
+#endif
@@ -38,6 +38,7 @@ struct ddsi_reorder;
 struct ddsi_defrag;
 struct ddsi_addrset;
 struct ddsi_xeventq;
+struct ddsi_xpack_sendq;
 struct ddsi_gcreq_queue;
 struct ddsi_entity_index;
 struct ddsi_lease;
@@ -80,6 +81,7 @@ struct ddsi_recv_thread_arg {
     } single;
     struct {
       struct ddsi_sock_waitset *ws;
+      struct ddsi_tran_conn *conn; // only this one if non-null, else all that are not handled elsewhere
     } many;
   } u;
 };
@@ -103,6 +105,13 @@ struct ddsi_domaingv {
   /* Timed events admin */
   struct ddsi_xeventq *xevents;
 
+  /* Additional timed event queues, each with its own thread, over which
+     the events of user writers and proxy writers are spread by GUID
+     (see ddsi_xeventq_for_guid); xevents handles everything if there
+     are none */
+  uint32_t n_xevent_shards;
+  struct ddsi_xeventq **xevent_shards;
+
   /* Queue for garbage collection requests */
   struct ddsi_gcreq_queue *gcreq_queue;
 
@@ -124,6 +133,13 @@ struct ddsi_domaingv {
   struct ddsi_tran_conn * disc_conn_uc;
   struct ddsi_tran_conn * data_conn_uc;
 
+  /* Additional sockets bound to the data unicast port, each handled by its
+     own receive thread (see Internal/DataReceiveThreads); data_conn_uc is
+     the first one and isn't repeated here */
+#define MAX_DATA_RECV_THREADS 16
+  uint32_t n_data_conn_uc_shards;
+  struct ddsi_tran_conn * data_conn_uc_shards[MAX_DATA_RECV_THREADS - 1];
+
   /* Connection used for all output (for connectionless transports), this
      used to simply be data_conn_uc, but:
 
@@ -205,10 +221,11 @@ struct ddsi_domaingv {
      trigger socket.) Receive buffer pool is per receive thread,
      it is only a global variable because it needs to be freed way later
      than the receive thread itself terminates */
-#define MAX_RECV_THREADS 3
+#define MAX_RECV_THREADS (2 + MAX_DATA_RECV_THREADS)
   uint32_t n_recv_threads;
   struct recv_thread {
     const char *name;
+    char namebuf[16];
     struct ddsi_thread_state *thrst;
     struct ddsi_recv_thread_arg arg;
   } recv_threads[MAX_RECV_THREADS];
@@ -283,21 +300,26 @@ struct ddsi_domaingv {
   struct ddsi_sertype *pgm_volatile_type; /* participant generic message */
 #endif
 
-  ddsrt_mutex_t sendq_lock;
-  ddsrt_cond_t sendq_cond;
-  unsigned sendq_length;
-  struct ddsi_xpack *sendq_head;
-  struct ddsi_xpack *sendq_tail;
-  int sendq_stop;
+  struct ddsi_xpack_sendq *sendq;
   struct ddsi_thread_state *sendq_ts;
   bool sendq_running;
   ddsrt_mutex_t sendq_running_lock;
 
+  /* Counters for packets sent using zero-copy writes (see ddsi_xpack_zerocopy_stats):
+     number of writes the transport hasn't completed yet, number of writes and bytes
+     for which the kernel did and didn't copy the data */
+  ddsrt_atomic_uint32_t zerocopy_pending;
+  ddsrt_atomic_uint32_t zerocopy_sent;
+  ddsrt_atomic_uint32_t zerocopy_copied;
+  ddsrt_atomic_uint64_t zerocopy_bytes_saved;
+  ddsrt_atomic_uint64_t zerocopy_bytes_copied;
+
   /* File for dumping captured packets, NULL if disabled */
   FILE *pcap_fp;
   ddsrt_mutex_t pcap_lock;
 
   struct ddsi_builtin_topic_interface *builtin_topic_interface;
+  const struct ddsi_content_filter_interface *content_filter_interface;
 
   struct ddsi_mcgroup_membership *mship;
 
@@ -17,6 +17,7 @@
 #include "dds/ddsrt/fibheap.h"
 #include "dds/ddsi/ddsi_entity.h"
 #include "dds/ddsi/ddsi_hbcontrol.h"
+#include "dds/ddsi/ddsi_pacing.h"
 #include "dds/dds.h"
 
 #if defined (__cplusplus)
@@ -30,6 +31,8 @@ struct ddsi_entity_common;
 struct ddsi_endpoint_common;
 struct ddsi_ldur_fhnode;
 struct ddsi_entity_index;
+struct ddsi_wraddrset_cache;
+struct ddsi_content_filter_property;
 struct dds_qos;
 
 /* Liveliness changed is more complicated than just add/remove. Encode the event
@@ -92,6 +95,7 @@ struct ddsi_writer
   unsigned test_suppress_heartbeat : 1; /* iff 1, the writer suppresses all periodic heartbeats */
   unsigned test_suppress_flush_on_sync_heartbeat : 1; /* iff 1, the writer never flushes because of a piggy-backed heartbeat */
   unsigned test_drop_outgoing_data : 1; /* iff 1, the writer drops outgoing data, forcing the readers to request a retransmit */
+  unsigned fec: 1; /* iff 1, parity submessages are sent for fragmented samples if a matched reader accepts them */
 #ifdef DDSRT_HAVE_SSM
   unsigned supports_ssm: 1;
   struct ddsi_addrset *ssm_as;
@@ -99,6 +103,7 @@ struct ddsi_writer
   uint32_t alive_vclock; /* virtual clock counting transitions between alive/not-alive */
   const struct ddsi_sertype * type; /* type of the data written by this writer */
   struct ddsi_addrset *as; /* set of addresses to publish to */
+  struct ddsi_wraddrset_cache *as_cache; /* assignment of readers to addresses in "as" for incremental updates, NULL if none */
   struct ddsi_xevent *heartbeat_xevent; /* timed event for "periodically" publishing heartbeats when unack'd data present, NULL <=> unreliable */
   struct ddsi_ldur_fhnode *lease_duration; /* fibheap node to keep lease duration for this writer, NULL in case of automatic liveliness with inifite duration  */
   struct ddsi_whc *whc; /* WHC tracking history, T-L durability service history + samples by sequence number for retransmit */
@@ -106,11 +111,16 @@ struct ddsi_writer
   ddsrt_etime_t t_rexmit_start;
   ddsrt_etime_t t_rexmit_end; /* time of last 1->0 transition of "retransmitting" */
   ddsrt_etime_t t_whc_high_upd; /* time "whc_high" was last updated for controlled ramp-up of throughput */
+  uint32_t min_receive_buffer_size; /* smallest receive_buffer_size of the readers, may be smaller than actual */
   uint32_t init_burst_size_limit; /* derived from reader's receive_buffer_size */
   uint32_t rexmit_burst_size_limit; /* derived from reader's receive_buffer_size */
   uint32_t num_readers; /* total number of matching PROXY readers */
   uint32_t num_reliable_readers; /* number of matching reliable PROXY readers */
   uint32_t num_readers_requesting_keyhash; /* also +1 for protected keys and config override for generating keyhash */
+  uint32_t num_readers_accepting_fec; /* number of matching PROXY readers that can use parity submessages */
+  uint32_t num_readers_content_filtered; /* number of matching PROXY readers with a content filter this writer can evaluate */
+  ddsi_seqno_t filtered_gap_start; /* first of the samples not sent since the last one that was, because all readers rejected them; 0 if none */
+  uint64_t filtered_count; /* cum samples not sent because all readers rejected them */
   ddsrt_avl_tree_t readers; /* all matching PROXY readers, see struct ddsi_wr_prd_match */
   ddsrt_avl_tree_t local_readers; /* all matching LOCAL readers, see struct ddsi_wr_rd_match */
 #ifdef DDS_HAS_NETWORK_PARTITIONS
@@ -125,6 +135,7 @@ struct ddsi_writer
   uint64_t rexmit_bytes; /* cum bytes queued for retransmit */
   uint64_t time_throttled; /* cum time in throttled state */
   uint64_t time_retransmit; /* cum time in retransmitting state */
+  struct ddsi_pacing pacing; /* rate-based congestion control, only enabled for reliable application writers */
   struct ddsi_xeventq *evq; /* timed event queue to be used by this writer */
   struct ddsi_local_reader_ary rdary; /* LOCAL readers for fast-pathing; if not fast-pathed, fall back to scanning local_readers */
   struct ddsi_lease *lease; /* for liveliness administration (writer can only become inactive when using manual liveliness) */
@@ -160,6 +171,7 @@ struct ddsi_reader
   uint32_t num_writers; /* total number of matching PROXY writers */
   ddsrt_avl_tree_t writers; /* all matching PROXY writers, see struct ddsi_rd_pwr_match */
   ddsrt_avl_tree_t local_writers; /* all matching LOCAL writers, see struct ddsi_rd_wr_match */
+  struct ddsi_content_filter_property *content_filter; /* content filter advertised in discovery, NULL if none */
 #ifdef DDS_HAS_SECURITY
   struct ddsi_reader_sec_attributes *sec_attr;
 #endif
@@ -223,7 +235,7 @@ struct ddsi_reader *ddsi_writer_next_in_sync_reader (struct ddsi_entity_index *e
 dds_return_t ddsi_generate_reader_guid (struct ddsi_guid *rdguid, struct ddsi_participant *participant, const struct ddsi_sertype *sertype);
 
 /** @component ddsi_endpoint */
-dds_return_t ddsi_new_reader (struct ddsi_reader **rd_out, const struct ddsi_guid *guid, const struct ddsi_guid *group_guid, struct ddsi_participant *pp, const char *topic_name, const struct ddsi_sertype *type, const struct dds_qos *xqos, struct ddsi_rhc *rhc, ddsi_status_cb_t status_cb, void * status_entity, struct ddsi_psmx_locators_set *psmx_locators);
+dds_return_t ddsi_new_reader (struct ddsi_reader **rd_out, const struct ddsi_guid *guid, const struct ddsi_guid *group_guid, struct ddsi_participant *pp, const char *topic_name, const struct ddsi_sertype *type, const struct dds_qos *xqos, struct ddsi_rhc *rhc, ddsi_status_cb_t status_cb, void * status_entity, struct ddsi_psmx_locators_set *psmx_locators, const struct ddsi_content_filter_property *content_filter);
 
 /** @component ddsi_endpoint */
 void ddsi_update_reader_qos (struct ddsi_reader *rd, const struct dds_qos *xqos);
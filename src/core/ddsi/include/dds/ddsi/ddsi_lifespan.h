@@ -43,6 +43,9 @@ void ddsi_lifespan_fini (const struct ddsi_lifespan_adm *lifespan_adm);
 /** @component lifespan_qos */
 ddsrt_mtime_t ddsi_lifespan_next_expired_locked (const struct ddsi_lifespan_adm *lifespan_adm, ddsrt_mtime_t tnow, void **sample);
 
+/** @component lifespan_qos */
+bool ddsi_lifespan_empty_locked (const struct ddsi_lifespan_adm *lifespan_adm);
+
 /** @component lifespan_qos */
 void ddsi_lifespan_register_sample_real (struct ddsi_lifespan_adm *lifespan_adm, struct ddsi_lifespan_fhnode *node);
 
@@ -0,0 +1,113 @@
+// Copyright(c) 2025 ZettaScale Technology and others
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License v. 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Eclipse Distribution License
+// v. 1.0 which is available at
+// http://www.eclipse.org/org/documents/edl-v10.php.
+//
+// SPDX-License-Identifier: EPL-2.0 OR BSD-3-Clause
+
+#ifndef DDSI_MEMPOOL_H
+#define DDSI_MEMPOOL_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+#if defined (__cplusplus)
+extern "C" {
+#endif
+
+/* A cache of free objects of varying sizes, grouped in power-of-two size
+   classes.  Like the freelist, it only caches objects, the allocation of new
+   ones is left to the user: a "get" either returns a cached object or nothing,
+   and a "put" either accepts the object or leaves it to the caller to free it.
+
+   Each thread has, per size class, a "magazine" of objects it can take from
+   and return to without any synchronisation.  Full and empty magazines are
+   exchanged with a per-class depot protected by a mutex, so that objects
+   allocated in one thread and freed in another (e.g., a sample serialised by
+   the application and freed by the delivery thread) still get recycled. */
+
+struct ddsi_mempool;
+
+struct ddsi_mempool_stats {
+  uint64_t gets;      /* number of calls to get */
+  uint64_t hits;      /* number of gets that returned an object */
+  uint64_t puts;      /* number of objects accepted */
+  uint64_t rejects;   /* number of objects not accepted (too large, or cache full) */
+  uint64_t exchanges; /* number of magazines exchanged with the depots */
+};
+
+/** @brief Create a new pool
+ * @component ddsi_mempool
+ *
+ * @param[in] min_size smallest size class, rounded up to a power of 2
+ * @param[in] max_size largest size class, rounded up to a power of 2
+ * @param[in] max_objs maximum number of objects in a size class in the depot
+ * @param[in] max_bytes maximum number of bytes in a size class in the depot,
+ *   the smaller of this and max_objs applies, but at least two magazines are
+ *   always allowed
+ * @param[in] free function for freeing cached objects that no longer fit in the
+ *   depot when a thread terminates, or remain when the pool is freed
+ */
+struct ddsi_mempool *ddsi_mempool_new (uint32_t min_size, uint32_t max_size, uint32_t max_objs, size_t max_bytes, void (*free) (void *obj));
+
+/** @brief Free a pool and all objects cached in it
+ * @component ddsi_mempool
+ *
+ * @param[in] pool pool to free, no thread may be operating on it
+ */
+void ddsi_mempool_free (struct ddsi_mempool *pool);
+
+/** @brief Get a cached object
+ * @component ddsi_mempool
+ *
+ * @param[in] pool pool to get an object from
+ * @param[in,out] size on input, the required size; on output, the size of the
+ *   size class, which is also the size to use for allocating a new object if
+ *   no object is returned. If the required size exceeds the largest size class
+ *   it is left unchanged.
+ * @return a cached object of at least `*size` bytes (on output), or NULL
+ */
+void *ddsi_mempool_get (struct ddsi_mempool *pool, uint32_t *size);
+
+/** @brief Get the size of the size class for a required size
+ * @component ddsi_mempool
+ *
+ * Performs the same rounding as @ref ddsi_mempool_get, without taking an object
+ * from the pool or updating the statistics.
+ *
+ * @param[in] pool pool
+ * @param[in] size required size
+ * @return the size of the smallest size class of at least `size` bytes, or
+ *   `size` itself if it exceeds the largest size class
+ */
+uint32_t ddsi_mempool_class_size (const struct ddsi_mempool *pool, uint32_t size);
+
+/** @brief Return an object to the pool
+ * @component ddsi_mempool
+ *
+ * @param[in] pool pool to return the object to
+ * @param[in] obj object
+ * @param[in] size size of the object, it gets cached in the largest size class
+ *   not exceeding it
+ * @return true if the object was accepted, false if the caller must free it
+ */
+bool ddsi_mempool_put (struct ddsi_mempool *pool, void *obj, uint32_t size);
+
+/** @brief Get the statistics, summed over all threads
+ * @component ddsi_mempool
+ *
+ * The counters are updated without synchronisation by the threads using the
+ * pool, the result is only guaranteed to be accurate if no other thread is
+ * using the pool at the same time.
+ */
+void ddsi_mempool_get_stats (struct ddsi_mempool *pool, struct ddsi_mempool_stats *stats);
+
+#if defined (__cplusplus)
+}
+#endif
+
+#endif /* DDSI_MEMPOOL_H */
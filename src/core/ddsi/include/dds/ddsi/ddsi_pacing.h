@@ -0,0 +1,52 @@
+// Copyright(c) 2025 ZettaScale Technology and others
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License v. 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Eclipse Distribution License
+// v. 1.0 which is available at
+// http://www.eclipse.org/org/documents/edl-v10.php.
+//
+// SPDX-License-Identifier: EPL-2.0 OR BSD-3-Clause
+
+#ifndef DDSI_PACING_H
+#define DDSI_PACING_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "dds/ddsrt/time.h"
+#include "dds/ddsi/ddsi_lat_estim.h"
+
+#if defined (__cplusplus)
+extern "C" {
+#endif
+
+/// @brief Rate-based congestion control state (per reliable writer)
+///
+/// New data is paced by a token bucket that fills at `rate` bytes per second. The rate
+/// follows an AIMD scheme: it increases by the configured minimum rate for every round-trip
+/// in which readers acknowledge new data without requesting a retransmit, and decreases by
+/// a quarter when a retransmit is requested, at most once per round-trip. The round-trip
+/// time is estimated from the time between sending a heartbeat that requires a response
+/// and receiving an ACKNACK.
+///
+/// Retransmits take tokens from the bucket but are never delayed by it, so that a lossy
+/// link slows down the transmission of new data rather than that of repairs.
+struct ddsi_pacing {
+  bool enabled;                  ///< Whether pacing is active for this writer
+  uint64_t rate;                 ///< Current rate in bytes/s
+  int64_t tokens;                ///< Bytes that may be sent without delay, negative when in debt
+  ddsrt_mtime_t t_refill;        ///< Time tokens were last added
+  ddsrt_mtime_t t_rate_upd;      ///< Time the rate was last changed
+  ddsrt_mtime_t t_decrease;      ///< Time the rate was last decreased
+  struct ddsi_lat_estim rtt;     ///< Round-trip time estimate
+  uint32_t decrease_count;       ///< Number of times the rate was decreased
+  uint64_t time_paced;           ///< Cumulative time writes were delayed, in ns
+  uint32_t waiters;              ///< Number of threads waiting for tokens
+};
+
+#if defined (__cplusplus)
+}
+#endif
+
+#endif /* DDSI_PACING_H */
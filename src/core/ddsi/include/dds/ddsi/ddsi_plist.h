@@ -93,6 +93,16 @@ typedef struct ddsi_reader_favours_ssm {
 #endif /* DDSRT_HAVE_SSM */
 
 
+/* Content filter advertised by a reader in discovery (DDSI 9.6.3.1), the
+   expression parameters are in expression_parameters.strs[0 .. n-1]. */
+typedef struct ddsi_content_filter_property {
+  char *content_filtered_topic_name;
+  char *related_topic_name;
+  char *filter_class_name;
+  char *filter_expression;
+  ddsi_stringseq_t expression_parameters;
+} ddsi_content_filter_property_t;
+
 typedef struct ddsi_adlink_participant_version_info
 {
   uint32_t version;
@@ -119,7 +129,7 @@ typedef struct ddsi_plist {
   unsigned char expects_inline_qos;
   ddsi_count_t participant_manual_liveliness_count;
   uint32_t participant_builtin_endpoints;
-  /* ddsi_content_filter_property_t content_filter_property; */
+  ddsi_content_filter_property_t content_filter_property;
   ddsi_guid_t participant_guid;
   ddsi_guid_t endpoint_guid;
   ddsi_guid_t group_guid;
@@ -149,6 +159,7 @@ typedef struct ddsi_plist {
   uint32_t cyclone_receive_buffer_size;
   unsigned char cyclone_requests_keyhash;
   unsigned char cyclone_redundant_networking;
+  unsigned char cyclone_accepts_fec;
 } ddsi_plist_t;
 
 /**
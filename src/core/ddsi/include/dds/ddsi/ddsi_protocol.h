@@ -98,7 +98,8 @@ typedef enum ddsi_rtps_submessage_kind {
   DDSI_RTPS_SMID_SRTPS_POSTFIX = 0x34,
   /* vendor-specific sub messages (0x80 .. 0xff) */
   DDSI_RTPS_SMID_ADLINK_MSG_LEN = 0x81,
-  DDSI_RTPS_SMID_ADLINK_ENTITY_ID = 0x82
+  DDSI_RTPS_SMID_ADLINK_ENTITY_ID = 0x82,
+  DDSI_RTPS_SMID_CYCLONE_DATAFRAG_PARITY = 0x83
 } ddsi_rtps_submessage_kind_t;
 
 typedef struct ddsi_rtps_info_src {
@@ -29,6 +29,7 @@ struct ddsi_writer;
 struct dds_qos;
 struct ddsi_addrset;
 struct ddsi_serdata;
+struct ddsi_content_filter_property;
 
 struct ddsi_proxy_endpoint_common
 {
@@ -92,6 +93,7 @@ struct ddsi_proxy_reader {
   unsigned deleting: 1; /* set when being deleted */
   unsigned is_fict_trans_reader: 1; /* only true when it is certain that is a fictitious transient data reader (affects built-in topic generation) */
   unsigned requests_keyhash: 1; /* 1 iff this reader would like to receive keyhashes */
+  unsigned accepts_fec: 1; /* 1 iff this reader can use parity submessages to recover lost fragments */
   unsigned redundant_networking: 1; /* 1 iff requests receiving data on all advertised interfaces */
 #ifdef DDSRT_HAVE_SSM
   unsigned favours_ssm: 1; /* iff 1, this proxy reader favours SSM when available */
@@ -100,6 +102,7 @@ struct ddsi_proxy_reader {
   ddsrt_avl_tree_t writers; /* matching LOCAL writers */
   uint32_t receive_buffer_size; /* assumed receive buffer size inherited from proxypp */
   ddsi_filter_fn_t filter;
+  struct ddsi_content_filter_property *content_filter; /* content filter advertised by the reader, NULL if none */
 };
 
 
@@ -21,10 +21,10 @@ struct ddsi_reader;
 struct ddsi_writer;
 
 /** @component ddsi_statistics */
-void ddsi_get_writer_stats (struct ddsi_writer *wr, uint64_t *rexmit_bytes, uint32_t *throttle_count, uint64_t *time_throttled, uint64_t *time_retransmit);
+void ddsi_get_writer_stats (struct ddsi_writer *wr, uint64_t *rexmit_bytes, uint32_t *throttle_count, uint64_t *time_throttled, uint64_t *time_retransmit, uint64_t *pacing_rate, uint32_t *pacing_decrease_count, uint64_t *time_paced, uint64_t *filtered_count);
 
 /** @component ddsi_statistics */
-void ddsi_get_reader_stats (struct ddsi_reader *rd, uint64_t *discarded_bytes);
+void ddsi_get_reader_stats (struct ddsi_reader *rd, uint64_t *discarded_bytes, uint64_t *recovered_bytes);
 
 #if defined (__cplusplus)
 }
@@ -37,6 +37,23 @@ struct ddsi_thread_state;
  */
 DDS_EXPORT int ddsi_write_sample_gc (struct ddsi_thread_state * const thrst, struct ddsi_xpack *xp, struct ddsi_writer *wr, struct ddsi_serdata *serdata, struct ddsi_tkmap_instance *tk);
 
+/**
+ * @component outgoing_rtps
+ *
+ * Writing a sequence of new samples, equivalent to calling @ref ddsi_write_sample_gc for
+ * each of them, but locking the writer only once for a run of samples that fit in a single
+ * message and following the run with a single heartbeat.  All serdatas are unref'd.
+ *
+ * @param thrst     Thread state
+ * @param xp        xpack
+ * @param wr        writer
+ * @param n         number of samples
+ * @param serdata   serialized sample data for each sample
+ * @param tk        key-instance map instance for each sample
+ * @param results   result for each sample, as returned by @ref ddsi_write_sample_gc
+ */
+DDS_EXPORT void ddsi_write_samples_gc (struct ddsi_thread_state * const thrst, struct ddsi_xpack *xp, struct ddsi_writer *wr, uint32_t n, struct ddsi_serdata * const *serdata, struct ddsi_tkmap_instance * const *tk, int *results);
+
 /**
  * @component outgoing_rtps
  *
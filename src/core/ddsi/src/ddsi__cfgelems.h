@@ -1060,6 +1060,68 @@ static struct cfgelem internal_burstsize_cfgelems[] = {
   END_MARKER
 };
 
+static struct cfgelem internal_congestion_control_cfgelems[] = {
+  BOOL("Enable", NULL, 1, "false",
+    MEMBER(congestion_control),
+    FUNCTIONS(0, uf_boolean, 0, pf_boolean),
+    DESCRIPTION(
+      "<p>This element enables rate-based congestion control for reliable "
+      "application writers. Each writer paces its transmissions using a "
+      "token bucket, the rate of which is increased additively for every "
+      "round-trip without loss and decreased multiplicatively when readers "
+      "request retransmits. Throttling on the WHC watermarks remains in "
+      "effect.</p>")),
+  STRING("InitialRate", NULL, 1, "16 MiB",
+    MEMBER(cc_initial_rate),
+    FUNCTIONS(0, uf_memsize, 0, pf_memsize),
+    DESCRIPTION(
+      "<p>This element sets the initial transmit rate of a writer, expressed "
+      "in bytes per second.</p>"),
+    UNIT("memsize")),
+  STRING("MinRate", NULL, 1, "1 MiB",
+    MEMBER(cc_min_rate),
+    FUNCTIONS(0, uf_memsize, 0, pf_memsize),
+    DESCRIPTION(
+      "<p>This element sets the rate below which a writer's transmit rate is "
+      "never reduced, expressed in bytes per second. It is also the amount "
+      "by which the rate increases per round-trip without loss.</p>"),
+    UNIT("memsize")),
+  STRING("MaxRate", NULL, 1, "1 GiB",
+    MEMBER(cc_max_rate),
+    FUNCTIONS(0, uf_memsize, 0, pf_memsize),
+    DESCRIPTION(
+      "<p>This element sets the rate above which a writer's transmit rate is "
+      "never increased, expressed in bytes per second.</p>"),
+    UNIT("memsize")),
+  END_MARKER
+};
+
+static struct cfgelem internal_fec_cfgelems[] = {
+  BOOL("Enable", NULL, 1, "false",
+    MEMBER(fec),
+    FUNCTIONS(0, uf_boolean, 0, pf_boolean),
+    DESCRIPTION(
+      "<p>This element enables forward error correction for fragmented "
+      "samples. Readers advertise in discovery that they can use parity "
+      "data, and writers that have such a reader matched send a parity "
+      "submessage after every group of DATAFRAG submessages. A reader can "
+      "then reconstruct one lost DATAFRAG per group without a "
+      "retransmit. This is primarily of interest for best-effort and "
+      "multicast data, where retransmits are not available or costly.</p>")),
+  INT("GroupSize", NULL, 1, "8",
+    MEMBER(fec_group_size),
+    FUNCTIONS(0, uf_pos_uint, 0, pf_uint),
+    DESCRIPTION(
+      "<p>This element sets the maximum number of DATAFRAG submessages "
+      "covered by one parity submessage, and hence the bandwidth overhead "
+      "as well as the number of losses that can be repaired (one per "
+      "group). The DATAFRAG submessages of a sample are divided over as "
+      "few groups of as equal size as possible. Samples that fit in a "
+      "single DATAFRAG submessage are sent without parity.</p>"),
+    RANGE("1;65535")),
+  END_MARKER
+};
+
 static struct cfgelem control_topic_cfgattrs[] = {
   BOOL(DEPRECATED("Enable"), NULL, 1, "false",
     MEMBER(enable_control_topic),
@@ -1167,6 +1229,26 @@ static struct cfgelem multiple_recv_threads_attrs[] = {
   END_MARKER
 };
 
+static struct cfgelem data_recv_threads_attrs[] = {
+  ENUM("steering", NULL, 1, "kernel",
+    MEMBER(data_recv_steering),
+    FUNCTIONS(0, uf_recv_steering, 0, pf_recv_steering),
+    DESCRIPTION(
+      "<p>This attribute selects how the incoming datagrams are distributed "
+      "over the data receive threads. Possible values are:</p>\n"
+      "<ul><li><i>kernel</i>: the kernel's default hash over the source and "
+      "destination addresses and ports, so that all traffic from a single "
+      "remote socket is handled by the same thread;</li>\n"
+      "<li><i>guidprefix</i>: (Linux only) a hash over the GUID prefix in the "
+      "RTPS header, so that all traffic from a single remote participant is "
+      "handled by the same thread, even when many participants share a "
+      "socket.</li></ul>\n"
+      "<p>Either way, the data of a remote writer is always received by a "
+      "single thread, preserving its order.</p>"),
+    VALUES("kernel","guidprefix")),
+  END_MARKER
+};
+
 static struct cfgelem sock_rcvbuf_size_attrs[] = {
   STRING("min", NULL, 1, "default",
     MEMBER(socket_rcvbuf_size.min),
@@ -1472,6 +1554,27 @@ static struct cfgelem internal_cfgelems[] = {
     DESCRIPTION(
       "<p>Whether or not to locally retry pushing a received best-effort "
       "sample into the reader caches when resource limits are reached.</p>")),
+  BOOL("ConcurrentReaderHistoryCache", NULL, 1, "false",
+    MEMBER(concurrent_rhc),
+    FUNCTIONS(0, uf_boolean, 0, pf_boolean),
+    DESCRIPTION(
+      "<p>This element enables finer-grained locking in the reader history "
+      "caches. Storing samples in existing instances and reading or taking "
+      "a specific instance then only lock that instance, so that these "
+      "operations can proceed in parallel for different instances. "
+      "Operations that create or delete instances, change the set of "
+      "writers of an instance, or involve read conditions, lifespan, "
+      "deadline or a limit on the total number of samples still lock the "
+      "entire cache.</p>")),
+  BOOL("RingWriterHistoryCache", NULL, 1, "true",
+    MEMBER(ring_whc),
+    FUNCTIONS(0, uf_boolean, 0, pf_boolean),
+    DESCRIPTION(
+      "<p>This element enables a simpler writer history cache for volatile "
+      "writers of topics without a key and without a deadline, which keeps "
+      "the samples in an array indexed by sequence number rather than in "
+      "the combination of hash tables and trees needed for the general "
+      "case.</p>")),
   BOOL("GenerateKeyhash", NULL, 1, "false",
     MEMBER(generate_keyhash),
     FUNCTIONS(0, uf_boolean, 0, pf_boolean),
@@ -1569,6 +1672,134 @@ static struct cfgelem internal_cfgelems[] = {
     "transport (e.g., UDP) and ManySocketsMode not set to single (the "
     "default).</p>"),
     VALUES("false","true","default")),
+  INT("DataReceiveThreads", data_recv_threads_attrs, 1, "1",
+    MEMBER(data_recv_threads),
+    FUNCTIONS(0, uf_data_recv_threads, 0, pf_int),
+    DESCRIPTION(
+      "<p>This element sets the number of threads (named recvUC.<i>N</i>) "
+      "that receive the unicast data when Internal/MultipleReceiveThreads is "
+      "enabled and Compatibility/ManySocketsMode is set to <i>single</i>. "
+      "Each thread has its own socket bound to the data port using "
+      "SO_REUSEPORT and its own receive buffers, which allows the handling "
+      "of incoming data to use multiple cores. This requires the discovery "
+      "and data ports to be different and a platform that supports "
+      "SO_REUSEPORT; otherwise a single thread is used.</p>"),
+    RANGE("1;16")),
+  INT("ReceiveBatchSize", NULL, 1, "1",
+    MEMBER(recv_batch_size),
+    FUNCTIONS(0, uf_batch_size, 0, pf_int),
+    DESCRIPTION(
+      "<p>This element sets the maximum number of datagrams a receive thread "
+      "reads from a socket in a single system call (using recvmmsg where the "
+      "platform supports it). Larger values reduce the number of system calls "
+      "when many small packets arrive in quick succession. The number actually "
+      "used is limited by the number of maximum-sized messages (see "
+      "Sizing/ReceiveBufferChunkSize) that fit in a receive buffer (see "
+      "Sizing/ReceiveBufferSize). A value of 1 disables batching.</p>\n"
+      "<p>Batching is only used for connectionless transports (e.g., UDP).</p>"),
+    RANGE("1;64")),
+  INT("SendBatchSize", NULL, 1, "1",
+    MEMBER(send_batch_size),
+    FUNCTIONS(0, uf_batch_size, 0, pf_int),
+    DESCRIPTION(
+      "<p>This element sets the maximum number of destinations to which a "
+      "packet is sent in a single system call (using sendmmsg where the "
+      "platform supports it) when the same packet has to be sent to multiple "
+      "addresses, as happens when unicasting to many readers. A value of 1 "
+      "disables batching.</p>\n"
+      "<p>Batching is only used for connectionless transports (e.g., UDP) and "
+      "not for packets that are protected by DDS Security.</p>"),
+    RANGE("1;64")),
+  STRING("ZeroCopySendThreshold", NULL, 1, "0 B",
+    MEMBER(zerocopy_send_threshold),
+    FUNCTIONS(0, uf_memsize, 0, pf_memsize),
+    DESCRIPTION(
+      "<p>This element sets the minimum size of a (fragment of a) "
+      "serialised sample for a packet containing it to be sent without "
+      "copying the data into the kernel (using MSG_ZEROCOPY on Linux). The sample data, as well as "
+      "the rest of the packet, then remain in use until the kernel reports "
+      "that it is done with them, which takes extra bookkeeping and only "
+      "pays off for large samples. The kernel copies the data anyway if the "
+      "network interface can't transmit directly from application memory, "
+      "which is always the case for the loopback interface and for "
+      "datagrams that require IP fragmentation (see "
+      "General/MaxMessageSize).</p>\n"
+      "<p>Zero-copy transmission is only used for UDP, not for packets that "
+      "are protected by DDS Security, and each destination of such a packet "
+      "is sent to separately (see Internal/SendBatchSize). A value of 0 "
+      "disables it.</p>"),
+    UNIT("memsize")),
+  ENUM("SocketWaitset", NULL, 1, "default",
+    MEMBER(sock_waitset_impl),
+    FUNCTIONS(0, uf_sock_waitset_impl, 0, pf_sock_waitset_impl),
+    DESCRIPTION(
+      "<p>This element selects the mechanism the receive thread that "
+      "monitors many sockets (see Internal/MultipleReceiveThreads and "
+      "Compatibility/ManySocketsMode) uses for receiving data. Possible values "
+      "are:</p>\n"
+      "<ul><li><i>default</i>: wait for sockets to become readable (using "
+      "epoll on Linux) and then read from each of them;</li>\n"
+      "<li><i>io_uring</i>: (Linux only) keep a multishot receive request "
+      "pending on every socket using io_uring, so that the datagrams "
+      "received on all sockets can be harvested in a single system call. "
+      "If io_uring is not supported by the kernel, the default mechanism is "
+      "used instead.</li></ul>\n"
+      "<p>The default is <i>default</i>.</p>"),
+    VALUES("default","io_uring")),
+  ENUM("TimedEventQueue", NULL, 1, "heap",
+    MEMBER(xeventq_impl),
+    FUNCTIONS(0, uf_xeventq_impl, 0, pf_xeventq_impl),
+    DESCRIPTION(
+      "<p>This element selects the data structure used for keeping track of "
+      "timed events, such as heartbeats, acknowledgements and lease "
+      "expiries. Possible values are:</p>\n"
+      "<ul><li><i>heap</i>: a priority queue, the events are handled in order "
+      "of their scheduled time;</li>\n"
+      "<li><i>wheel</i>: a hierarchical timing wheel, where scheduling and "
+      "rescheduling an event takes constant time, which makes it a better "
+      "choice when there are very many events. Events that are due at the "
+      "same time are not necessarily handled in order of their scheduled "
+      "time.</li></ul>\n"
+      "<p>The default is <i>heap</i>.</p>"),
+    VALUES("heap","wheel")),
+  INT("TimedEventQueueShards", NULL, 1, "0",
+    MEMBER(xeventq_shards),
+    FUNCTIONS(0, uf_natint_255, 0, pf_int),
+    DESCRIPTION(
+      "<p>This element sets the number of additional timed event queues, "
+      "each with its own thread (named tev.<i>N</i>), over which the "
+      "heartbeats, acknowledgements and retransmits of the application's "
+      "writers and of the remote writers are spread by hashing their GUIDs. "
+      "This allows the processing for large numbers of writers to use "
+      "multiple cores. Discovery and other housekeeping remain on the "
+      "default queue. The limits on queued retransmits (see "
+      "Internal/MaxQueuedRexmitBytes and Internal/MaxQueuedRexmitMessages) "
+      "apply to each queue separately. A value of 0 means all events are "
+      "handled by the default queue.</p>"),
+    RANGE("0;255")),
+  INT("InstanceMapShards", NULL, 1, "16",
+    MEMBER(tkmap_shards),
+    FUNCTIONS(0, uf_natint, 0, pf_int),
+    DESCRIPTION(
+      "<p>This element sets the number of independent hash tables over which "
+      "the domain-wide map from key values to instance handles is spread, "
+      "based on the hash of the key value. Spreading the instances reduces "
+      "the contention between threads writing or receiving samples of "
+      "different instances. Values above 256 are treated as 256.</p>"),
+    RANGE("1;256")),
+  INT("ThreadInstanceCacheSize", NULL, 1, "0",
+    MEMBER(tkmap_cache_size),
+    FUNCTIONS(0, uf_natint, 0, pf_int),
+    DESCRIPTION(
+      "<p>This element sets the number of entries in a small cache of "
+      "instances maintained by each thread that writes or receives keyed "
+      "samples, allowing repeatedly written instances to be found without "
+      "consulting the domain-wide map. The size is rounded up to a power of "
+      "two with a maximum of 65536, and 0 disables the cache. An instance in "
+      "a cache is retained (and so keeps its instance handle) until it is "
+      "evicted by another instance, even if no reader or writer references "
+      "it anymore. Hit rates and lookup latencies are traced.</p>"),
+    RANGE("0;65536")),
   GROUP("ControlTopic", control_topic_cfgelems, control_topic_cfgattrs, 1,
     NOMEMBER,
     NOFUNCTIONS,
@@ -1588,6 +1819,14 @@ static struct cfgelem internal_cfgelems[] = {
     NOMEMBER,
     NOFUNCTIONS,
     DESCRIPTION("<p>Setting for controlling the size of transmitting bursts.</p>")),
+  GROUP("CongestionControl", internal_congestion_control_cfgelems, NULL, 1,
+    NOMEMBER,
+    NOFUNCTIONS,
+    DESCRIPTION("<p>Settings for rate-based congestion control of reliable writers.</p>")),
+  GROUP("ForwardErrorCorrection", internal_fec_cfgelems, NULL, 1,
+    NOMEMBER,
+    NOFUNCTIONS,
+    DESCRIPTION("<p>Settings for forward error correction of fragmented samples.</p>")),
   BOOL("ExtendedPacketInfo", NULL, 1, "true",
     MEMBER(extended_packet_info),
     FUNCTIONS(0, uf_boolean, 0, pf_boolean),
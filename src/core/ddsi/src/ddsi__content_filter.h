@@ -0,0 +1,77 @@
+// Copyright(c) 2025 ZettaScale Technology and others
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License v. 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Eclipse Distribution License
+// v. 1.0 which is available at
+// http://www.eclipse.org/org/documents/edl-v10.php.
+//
+// SPDX-License-Identifier: EPL-2.0 OR BSD-3-Clause
+
+#ifndef DDSI__CONTENT_FILTER_H
+#define DDSI__CONTENT_FILTER_H
+
+#include "dds/ddsi/ddsi_plist.h"
+#include "dds/ddsi/ddsi_content_filter_if.h"
+
+#if defined (__cplusplus)
+extern "C" {
+#endif
+
+struct ddsi_writer;
+struct ddsi_proxy_reader;
+struct ddsi_serdata;
+
+/** @component content_filter_if */
+void ddsi_content_filter_property_copy (ddsi_content_filter_property_t *dst, const ddsi_content_filter_property_t *src);
+
+/** @component content_filter_if */
+ddsi_content_filter_property_t *ddsi_content_filter_property_dup (const ddsi_content_filter_property_t *cfp);
+
+/** @component content_filter_if */
+void ddsi_content_filter_property_free (ddsi_content_filter_property_t *cfp);
+
+/**
+ * @brief Proxy reader filter function for readers with a content filter
+ * @component content_filter_if
+ *
+ * A GAP is applied to the proxy writer (and so to all readers in the remote
+ * participant that are in sync), therefore this only rejects the sample if the
+ * content filters of all matched readers in the proxy reader's participant
+ * reject it.
+ *
+ * @param[in] wr       writer, lock must be held
+ * @param[in] prd      proxy reader
+ * @param[in] serdata  sample
+ * @returns 0 if a GAP may be sent instead of the sample, 1 otherwise
+ */
+int ddsi_content_filter_prd_filter (struct ddsi_writer *wr, struct ddsi_proxy_reader *prd, struct ddsi_serdata *serdata);
+
+/**
+ * @brief Whether none of the matched proxy readers is interested in the sample
+ * @component content_filter_if
+ *
+ * @param[in] wr       writer, lock must be held
+ * @param[in] serdata  sample
+ * @returns true iff all matched proxy readers have a content filter and all of them
+ *   reject the sample
+ */
+bool ddsi_writer_content_filter_rejects (const struct ddsi_writer *wr, const struct ddsi_serdata *serdata);
+
+/**
+ * @brief Queue GAPs for the samples not sent because all readers rejected them
+ * @component content_filter_if
+ *
+ * Sends a GAP for [wr->filtered_gap_start, seq) to one reliable proxy reader in each
+ * of the remote participants and resets wr->filtered_gap_start.
+ *
+ * @param[in] wr   writer, lock must be held
+ * @param[in] seq  sequence number of the sample about to be sent
+ */
+void ddsi_writer_send_filtered_gaps (struct ddsi_writer *wr, ddsi_seqno_t seq);
+
+#if defined (__cplusplus)
+}
+#endif
+
+#endif
@@ -27,6 +27,8 @@ struct ddsi_type_pair;
 struct ddsi_entity_common;
 struct ddsi_endpoint_common;
 struct ddsi_alive_state;
+struct ddsi_wr_prd_match;
+struct ddsi_proxy_reader;
 struct dds_qos;
 
 struct ddsi_ldur_fhnode {
@@ -89,6 +91,20 @@ void ddsi_writer_get_alive_state (struct ddsi_writer *wr, struct ddsi_alive_stat
 /** @component ddsi_endpoint */
 void ddsi_rebuild_writer_addrset (struct ddsi_writer *wr);
 
+/**
+ * @component ddsi_endpoint
+ * @brief Update the writer's address set after matching or unmatching a single proxy reader
+ *
+ * Only touches the addresses affected by the change when possible, and falls back
+ * to @ref ddsi_rebuild_writer_addrset otherwise.
+ *
+ * @param[in] wr writer, with `wr->e.lock` held
+ * @param[in] m match object, already inserted in or removed from `wr->readers`
+ * @param[in] prd the proxy reader
+ * @param[in] added true if the reader was added, false if it was removed
+ */
+void ddsi_update_writer_addrset (struct ddsi_writer *wr, struct ddsi_wr_prd_match *m, const struct ddsi_proxy_reader *prd, bool added);
+
 /** @component ddsi_endpoint */
 void ddsi_writer_set_alive_may_unlock (struct ddsi_writer *wr, bool notify);
 
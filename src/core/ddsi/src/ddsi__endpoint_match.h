@@ -109,6 +109,8 @@ struct ddsi_wr_prd_match {
   ddsrt_wctime_t hb_to_ack_latency_tlastlog;
   uint32_t non_responsive_count;
   uint32_t rexmit_requests;
+  ddsi_xlocator_t cover_loc; /* locator in writer's address set this reader is assigned to, unspecified if unknown */
+  void *content_filter; /* reader's content filter compiled for the writer's type, NULL if none or unsupported */
 #ifdef DDS_HAS_SECURITY
   int64_t crypto_handle;
 #endif
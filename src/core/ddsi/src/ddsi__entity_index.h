@@ -53,6 +53,15 @@ struct ddsi_entity_enum_proxy_reader { struct ddsi_entity_enum st; };
 /** @component entity_index */
 struct ddsi_entity_index *ddsi_entity_index_new (struct ddsi_domaingv *gv) ddsrt_nonnull_all;
 
+/**
+ * @brief Hash of a GUID as used by the entity index
+ * @component entity_index
+ *
+ * @param[in] guid  GUID to hash
+ * @returns a 32-bit hash of the GUID
+ */
+uint32_t ddsi_entidx_guid_hash (const ddsi_guid_t *guid) ddsrt_nonnull_all;
+
 /** @component entity_index */
 void ddsi_entity_index_free (struct ddsi_entity_index *ei) ddsrt_nonnull_all;
 
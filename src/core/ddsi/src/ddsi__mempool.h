@@ -0,0 +1,35 @@
+// Copyright(c) 2025 ZettaScale Technology and others
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License v. 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Eclipse Distribution License
+// v. 1.0 which is available at
+// http://www.eclipse.org/org/documents/edl-v10.php.
+//
+// SPDX-License-Identifier: EPL-2.0 OR BSD-3-Clause
+
+#ifndef DDSI__MEMPOOL_H
+#define DDSI__MEMPOOL_H
+
+#include "dds/ddsi/ddsi_mempool.h"
+
+#if defined (__cplusplus)
+extern "C" {
+#endif
+
+/**
+ * @brief Release the calling thread's state in all pools
+ * @component ddsi_mempool
+ *
+ * Moves the objects in the calling thread's magazines to the depots, as far as the
+ * limits on the depots allow, frees the remainder and the per-thread state itself,
+ * to be called when the thread terminates.  The statistics of the thread are retained
+ * in the pool.
+ */
+void ddsi_mempool_thread_fini (void);
+
+#if defined (__cplusplus)
+}
+#endif
+
+#endif /* DDSI__MEMPOOL_H */
@@ -0,0 +1,65 @@
+// Copyright(c) 2025 ZettaScale Technology and others
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License v. 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Eclipse Distribution License
+// v. 1.0 which is available at
+// http://www.eclipse.org/org/documents/edl-v10.php.
+//
+// SPDX-License-Identifier: EPL-2.0 OR BSD-3-Clause
+
+#ifndef DDSI__PACING_H
+#define DDSI__PACING_H
+
+#include "dds/ddsi/ddsi_pacing.h"
+
+#if defined (__cplusplus)
+extern "C" {
+#endif
+
+struct ddsi_domaingv;
+
+/** @component outgoing_rtps */
+void ddsi_pacing_init (struct ddsi_pacing *p, const struct ddsi_domaingv *gv, bool enabled);
+
+/** @component outgoing_rtps */
+void ddsi_pacing_fini (struct ddsi_pacing *p);
+
+/**
+ * @brief Time to wait before new data may be sent
+ * @component outgoing_rtps
+ *
+ * @param[in,out] p  pacing state
+ * @param[in] gv     domain globals
+ * @param[in] tnow   current time
+ * @returns 0 if data may be sent now, else the time in ns until the bucket is no longer in debt
+ */
+int64_t ddsi_pacing_delay (struct ddsi_pacing *p, const struct ddsi_domaingv *gv, ddsrt_mtime_t tnow);
+
+/**
+ * @brief Take tokens for sending (or retransmitting) data, without waiting
+ * @component outgoing_rtps
+ *
+ * @param[in,out] p  pacing state
+ * @param[in] size   number of bytes sent
+ */
+void ddsi_pacing_consume (struct ddsi_pacing *p, uint32_t size);
+
+/**
+ * @brief Update the rate for a received ACKNACK or NACKFRAG
+ * @component outgoing_rtps
+ *
+ * @param[in,out] p   pacing state
+ * @param[in] gv      domain globals
+ * @param[in] tnow    current time
+ * @param[in] t_ackhb time the heartbeat that this is (presumably) a response to was sent, 0 if unknown
+ * @param[in] progress whether the reader acknowledged new data
+ * @param[in] loss    whether the reader requested a retransmit
+ */
+void ddsi_pacing_note_acknack (struct ddsi_pacing *p, const struct ddsi_domaingv *gv, ddsrt_mtime_t tnow, ddsrt_mtime_t t_ackhb, bool progress, bool loss);
+
+#if defined (__cplusplus)
+}
+#endif
+
+#endif /* DDSI__PACING_H */
@@ -147,6 +147,19 @@ typedef struct ddsi_rtps_datafrag {
 #define DDSI_DATAFRAG_FLAG_INLINE_QOS 0x02u
 #define DDSI_DATAFRAG_FLAG_KEYFLAG 0x04u
 
+/* Cyclone-specific: XOR of unitsInGroup consecutive blocks of
+   fragmentsInSubmessage fragments, the first one starting at
+   fragmentStartingNum, with the last block zero-padded.  Up to and
+   including sampleSize it is laid out as a DataFrag, and the flags and
+   inline QoS are those of the DataFrag of the first block, so that once
+   the payload has been turned into the one missing block it can be
+   processed as if it were that DataFrag. */
+typedef struct ddsi_rtps_datafrag_parity {
+  ddsi_rtps_datafrag_t frag;
+  uint16_t unitsInGroup;
+  uint16_t unused;
+} ddsi_rtps_datafrag_parity_t;
+
 DDSRT_WARNING_MSVC_OFF(4200)
 typedef struct ddsi_rtps_acknack {
   ddsi_rtps_submessage_header_t smhdr;
@@ -219,6 +232,7 @@ typedef union ddsi_rtps_submessage {
   ddsi_rtps_acknack_t acknack;
   ddsi_rtps_data_t data;
   ddsi_rtps_datafrag_t datafrag;
+  ddsi_rtps_datafrag_parity_t datafrag_parity;
   ddsi_rtps_info_ts_t infots;
   ddsi_rtps_info_dst_t infodst;
   ddsi_rtps_info_src_t infosrc;
@@ -364,6 +378,7 @@ typedef union ddsi_rtps_submessage {
 #define DDSI_PID_CYCLONE_TOPIC_GUID                  (DDSI_PID_VENDORSPECIFIC_FLAG | 0x1bu)
 #define DDSI_PID_CYCLONE_REQUESTS_KEYHASH            (DDSI_PID_VENDORSPECIFIC_FLAG | 0x1cu)
 #define DDSI_PID_CYCLONE_REDUNDANT_NETWORKING        (DDSI_PID_VENDORSPECIFIC_FLAG | 0x1du)
+#define DDSI_PID_CYCLONE_ACCEPTS_FEC                 (DDSI_PID_VENDORSPECIFIC_FLAG | 0x1eu)
 
 
 #if defined (__cplusplus)
@@ -134,6 +134,12 @@ struct ddsi_rmsg *ddsi_rmsg_new (struct ddsi_rbufpool *rbufpool);
 /** @component receive_buffers */
 void ddsi_rmsg_setsize (struct ddsi_rmsg *rmsg, uint32_t size);
 
+/** @component receive_buffers */
+uint32_t ddsi_rmsg_new_batch (struct ddsi_rbufpool *rbufpool, uint32_t n, struct ddsi_rmsg **rmsgs);
+
+/** @component receive_buffers */
+void ddsi_rbufpool_end_batch (struct ddsi_rbufpool *rbufpool);
+
 /** @component receive_buffers */
 void ddsi_rmsg_commit (struct ddsi_rmsg *rmsg);
 
@@ -168,6 +174,29 @@ struct ddsi_rsample *ddsi_defrag_rsample (struct ddsi_defrag *defrag, struct dds
 /** @component receive_buffers */
 void ddsi_defrag_notegap (struct ddsi_defrag *defrag, ddsi_seqno_t min, ddsi_seqno_t maxp1);
 
+/**
+ * @brief Reconstructs the one block of a group that is missing from a sample using parity data
+ * @component receive_buffers
+ *
+ * The group consists of @p nunits blocks of @p unitsize bytes starting at byte offset @p min
+ * of sample @p seq of @p size bytes (the last block possibly shorter), and @p parity is the
+ * XOR of these blocks.  If all but one of the blocks have been received, the others are
+ * XOR'd into @p parity in place, leaving the contents of the missing one.
+ *
+ * @param[in] defrag defragmenter
+ * @param[in] seq sequence number of the sample
+ * @param[in] size size of the sample
+ * @param[in] min offset of the first byte of the group
+ * @param[in] unitsize size of a block
+ * @param[in] nunits number of blocks in the group
+ * @param[in,out] parity parity data, on success replaced by the missing block
+ * @param[in] paritysize number of bytes available in @p parity
+ * @param[out] rmin offset of the first byte of the reconstructed block
+ * @param[out] rmaxp1 offset one past the last byte of the reconstructed block
+ * @returns true iff a block was reconstructed
+ */
+bool ddsi_defrag_fec_recover (struct ddsi_defrag *defrag, ddsi_seqno_t seq, uint32_t size, uint32_t min, uint32_t unitsize, uint32_t nunits, unsigned char *parity, uint32_t paritysize, uint32_t *rmin, uint32_t *rmaxp1);
+
 /** @component receive_buffers */
 enum ddsi_defrag_nackmap_result ddsi_defrag_nackmap (struct ddsi_defrag *defrag, ddsi_seqno_t seq, uint32_t maxfragnum, struct ddsi_fragment_number_set_header *map, uint32_t *mapbits, uint32_t maxsz);
 
@@ -250,7 +279,7 @@ bool ddsi_dqueue_step_deaf (struct ddsi_dqueue *q);
 
 
 /** @component receive_buffers */
-void ddsi_defrag_stats (struct ddsi_defrag *defrag, uint64_t *discarded_bytes);
+void ddsi_defrag_stats (struct ddsi_defrag *defrag, uint64_t *discarded_bytes, uint64_t *recovered_bytes);
 
 /** @component receive_buffers */
 void ddsi_reorder_stats (struct ddsi_reorder *reorder, uint64_t *discarded_bytes);
@@ -11,6 +11,8 @@
 #ifndef DDSI__SOCKWAITSET_H
 #define DDSI__SOCKWAITSET_H
 
+#include <stdbool.h>
+#include "dds/ddsrt/sockets.h"
 #include "dds/ddsi/ddsi_sockwaitset.h"
 
 #if defined (__cplusplus)
@@ -19,6 +21,14 @@ extern "C" {
 
 struct ddsi_tran_conn;
 
+/** @brief A datagram received by the waitset on behalf of a connection */
+struct ddsi_sock_waitset_dgram {
+  ddsrt_msghdr_t *msghdr; ///< Source address, control messages and flags as filled in by the kernel
+  unsigned char *buf;     ///< Contents of the datagram
+  size_t len;             ///< Size of the buffer the datagram was received in
+  size_t sz;              ///< Size of the datagram, at most len
+};
+
 /**
  * @brief Allocates a new connection waitset.
  * @component socket_waitset
@@ -32,6 +42,25 @@ struct ddsi_tran_conn;
  */
 struct ddsi_sock_waitset * ddsi_sock_waitset_new (void);
 
+/**
+ * @brief Allocates a new connection waitset that uses io_uring to receive data.
+ * @component socket_waitset
+ *
+ * Same as ddsi_sock_waitset_new, but instead of waiting for connections to become
+ * readable, a multishot receive is kept pending on each connectionless connection
+ * that supports ddsi_conn_read_done, and the datagrams are received into a ring of
+ * buffers owned by the waitset.  The datagrams for all connections are then obtained
+ * in a single system call.  Other connections are polled for readability.
+ *
+ * Only one datagram buffer is in use by the thread processing the events at any one
+ * time, it is returned to the kernel on the next call to ddsi_sock_waitset_next_event.
+ *
+ * @param nbufs   Number of datagram buffers, a power of 2
+ * @param maxdgram Maximum size of a datagram
+ * @return struct ddsi_sock_waitset*, or a null pointer if io_uring is not supported
+ */
+struct ddsi_sock_waitset * ddsi_sock_waitset_new_io_uring (uint32_t nbufs, size_t maxdgram);
+
 /**
  * @brief Frees the waitset
  * @component socket_waitset
@@ -131,6 +160,24 @@ struct ddsi_sock_waitset_ctx * ddsi_sock_waitset_wait (struct ddsi_sock_waitset
  */
 int ddsi_sock_waitset_next_event (struct ddsi_sock_waitset_ctx * ctx, struct ddsi_tran_conn ** conn);
 
+/**
+ * @component socket_waitset
+ *
+ * Returns whether the event most recently returned by ddsi_sock_waitset_next_event
+ * is a datagram that has already been received from the connection's socket, in
+ * which case dgram describes it, rather than the connection having become readable.
+ * The datagram remains valid until the next call to ddsi_sock_waitset_next_event.
+ *
+ * A datagram is only ever returned by a waitset created by
+ * ddsi_sock_waitset_new_io_uring, and only for connections that support
+ * ddsi_conn_read_done.
+ *
+ * @param ctx   Socket waitset context
+ * @param dgram Datagram
+ * @return true iff a datagram was received
+ */
+bool ddsi_sock_waitset_event_dgram (const struct ddsi_sock_waitset_ctx * ctx, struct ddsi_sock_waitset_dgram * dgram);
+
 /**
  * @brief Remove connection
  * @component socket_waitset
@@ -0,0 +1,49 @@
+// Copyright(c) 2025 ZettaScale Technology and others
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License v. 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Eclipse Distribution License
+// v. 1.0 which is available at
+// http://www.eclipse.org/org/documents/edl-v10.php.
+//
+// SPDX-License-Identifier: EPL-2.0 OR BSD-3-Clause
+
+#ifndef DDSI__TKMAP_H
+#define DDSI__TKMAP_H
+
+#include "dds/ddsi/ddsi_tkmap.h"
+
+#if defined (__cplusplus)
+extern "C" {
+#endif
+
+struct ddsi_thread_state;
+
+/**
+ * @brief Stop using per-thread caches of instances for this map
+ * @component key_instance_map
+ *
+ * Detaches the existing caches, so that the instances they reference are only freed
+ * with the map, and have any further lookups bypass the caches.  Releasing a reference
+ * may require the garbage collector, so this must be called before that is stopped.
+ *
+ * @param[in] map  instance map
+ */
+void ddsi_tkmap_close_caches (struct ddsi_tkmap *map);
+
+/**
+ * @brief Release the calling thread's caches of instances
+ * @component key_instance_map
+ *
+ * Drops the references to the instances in all caches of the calling thread and frees
+ * them, to be called when the thread terminates.
+ *
+ * @param[in] thrst  thread state of the calling thread, asleep
+ */
+void ddsi_tkmap_thread_caches_fini (struct ddsi_thread_state *thrst);
+
+#if defined (__cplusplus)
+}
+#endif
+
+#endif /* DDSI__TKMAP_H */
@@ -101,9 +101,35 @@ struct ddsi_network_packet_info {
   uint32_t if_index;      ///< Interface over which packet was received, 0 if unknown
 };
 
+/// @brief Maximum number of datagrams read in one call to ddsi_conn_read_batch
+#define DDSI_TRAN_MAX_READ_BATCH 64
+
+/// @brief Buffer and result for one datagram in a batched read
+struct ddsi_tran_read_batch_elem {
+  unsigned char *buf;     ///< Buffer to receive the datagram in (input)
+  size_t len;             ///< Size of buf (input)
+  size_t sz;              ///< Size of the datagram received (output)
+  struct ddsi_network_packet_info pktinfo; ///< Packet info (output)
+};
+
+/// @brief Maximum number of destinations in one call to ddsi_conn_write_multi
+#define DDSI_TRAN_MAX_WRITE_BATCH 64
+
+/// @brief Memory passed to ddsi_conn_write_zerocopy, for learning when the transport is done with it
+struct ddsi_tran_zerocopy_ref {
+  /// Called once the transport no longer references the message, with `copied` set if
+  /// the data was copied after all. It may be called before the write returns and from
+  /// any thread, and must not use the connection.
+  void (*done) (struct ddsi_tran_zerocopy_ref *ref, bool copied);
+};
+
 /* Function pointer types */
 typedef ssize_t (*ddsi_tran_read_fn_t) (struct ddsi_tran_conn *, unsigned char *, size_t, bool, struct ddsi_network_packet_info *pktinfo);
+typedef ssize_t (*ddsi_tran_read_batch_fn_t) (struct ddsi_tran_conn *, struct ddsi_tran_read_batch_elem *elems, size_t n);
+typedef void (*ddsi_tran_read_done_fn_t) (struct ddsi_tran_conn *, ddsrt_msghdr_t *msghdr, unsigned char *buf, size_t len, size_t nrecv, struct ddsi_network_packet_info *pktinfo);
 typedef ssize_t (*ddsi_tran_write_fn_t) (struct ddsi_tran_conn *, const ddsi_locator_t *, const ddsi_tran_write_msgfrags_t *, uint32_t);
+typedef size_t (*ddsi_tran_write_multi_fn_t) (struct ddsi_tran_conn *, size_t ndst, const ddsi_locator_t *dsts, const ddsi_tran_write_msgfrags_t *, uint32_t);
+typedef ssize_t (*ddsi_tran_write_zerocopy_fn_t) (struct ddsi_tran_conn *, const ddsi_locator_t *, const ddsi_tran_write_msgfrags_t *, uint32_t, struct ddsi_tran_zerocopy_ref *ref);
 typedef int (*ddsi_tran_locator_fn_t) (struct ddsi_tran_factory *, struct ddsi_tran_base *, ddsi_locator_t *);
 typedef bool (*ddsi_tran_supports_fn_t) (const struct ddsi_tran_factory *, int32_t);
 typedef ddsrt_socket_t (*ddsi_tran_handle_fn_t) (struct ddsi_tran_base *);
@@ -176,7 +202,11 @@ struct ddsi_tran_conn
   /* Functions */
 
   ddsi_tran_read_fn_t m_read_fn;
+  ddsi_tran_read_batch_fn_t m_read_batch_fn; ///< may be a null pointer if unsupported
+  ddsi_tran_read_done_fn_t m_read_done_fn; ///< may be a null pointer if unsupported
   ddsi_tran_write_fn_t m_write_fn;
+  ddsi_tran_write_multi_fn_t m_write_multi_fn; ///< may be a null pointer if unsupported
+  ddsi_tran_write_zerocopy_fn_t m_write_zerocopy_fn; ///< may be a null pointer if unsupported
   ddsi_tran_peer_locator_fn_t m_peer_locator_fn;
   ddsi_tran_disable_multiplexing_fn_t m_disable_multiplexing_fn;
   ddsi_tran_locator_fn_t m_locator_fn;
@@ -281,6 +311,8 @@ struct ddsi_tran_qos
   enum ddsi_tran_qos_purpose m_purpose;
   int m_diffserv;
   struct ddsi_network_interface *m_interface; // only for purpose = XMIT
+  bool m_reuseport; // only for purpose = RECV_UC with UDP: allow binding multiple sockets to the port
+  bool m_zerocopy; // only for purpose = XMIT with UDP: enable zero-copy writes if supported
 };
 
 /** @component transport */
@@ -392,11 +424,89 @@ inline ssize_t ddsi_conn_write (struct ddsi_tran_conn * conn, const ddsi_locator
   return conn->m_closed ? -1 : (conn->m_write_fn) (conn, dst, msgfrags, flags);
 }
 
+/** @brief Writes the same message to multiple destinations in one call
+ * @component transport
+ *
+ * Only connectionless transports that provide a "write multi" function support this,
+ * for others the caller must use ddsi_conn_write for each destination. A failure to
+ * send to one destination does not prevent sending to the remaining ones.
+ *
+ * @param[in] conn connection to write on
+ * @param[in] ndst number of destinations, 0 < ndst <= DDSI_TRAN_MAX_WRITE_BATCH
+ * @param[in] dsts destination addresses
+ * @param[in] msgfrags message to send
+ * @param[in] flags as for ddsi_conn_write
+ * @return number of destinations the message was sent to
+ */
+inline size_t ddsi_conn_write_multi (struct ddsi_tran_conn * conn, size_t ndst, const ddsi_locator_t *dsts, const ddsi_tran_write_msgfrags_t *msgfrags, uint32_t flags) {
+  assert (conn->m_write_multi_fn != NULL);
+  return conn->m_closed ? 0 : conn->m_write_multi_fn (conn, ndst, dsts, msgfrags, flags);
+}
+
+/** @brief Writes a message without copying the data, if the transport is able to
+ * @component transport
+ *
+ * Only transports that provide a "write zerocopy" function support this. The memory
+ * referenced by the message must remain valid and unchanged until the transport
+ * calls `ref->done`, which it does exactly once if the write succeeds and not at all
+ * if it fails. A transport may fall back to copying the data, for example when too
+ * many writes are pending.
+ *
+ * @param[in] conn connection to write on
+ * @param[in] dst destination address
+ * @param[in] msgfrags message to send
+ * @param[in] flags as for ddsi_conn_write
+ * @param[in] ref callback for signalling completion
+ * @return number of bytes written, -1 on failure
+ */
+inline ssize_t ddsi_conn_write_zerocopy (struct ddsi_tran_conn * conn, const ddsi_locator_t *dst, const ddsi_tran_write_msgfrags_t *msgfrags, uint32_t flags, struct ddsi_tran_zerocopy_ref *ref) {
+  assert (conn->m_write_zerocopy_fn != NULL);
+  return conn->m_closed ? -1 : conn->m_write_zerocopy_fn (conn, dst, msgfrags, flags, ref);
+}
+
 /** @component transport */
 inline ssize_t ddsi_conn_read (struct ddsi_tran_conn * conn, unsigned char * buf, size_t len, bool allow_spurious, struct ddsi_network_packet_info *pktinfo) {
   return conn->m_closed ? -1 : conn->m_read_fn (conn, buf, len, allow_spurious, pktinfo);
 }
 
+/** @brief Reads up to n datagrams in one call
+ * @component transport
+ *
+ * Blocks until at least one datagram is available, then reads as many more as are
+ * immediately available. Only connectionless transports that provide a "read batch"
+ * function support this, for others the caller must use ddsi_conn_read.
+ *
+ * @param[in] conn connection to read from
+ * @param[in,out] elems buffers to read into and the results
+ * @param[in] n number of elements in elems, 0 < n <= DDSI_TRAN_MAX_READ_BATCH
+ * @return number of datagrams read, or -1 on error
+ */
+inline ssize_t ddsi_conn_read_batch (struct ddsi_tran_conn * conn, struct ddsi_tran_read_batch_elem *elems, size_t n) {
+  assert (conn->m_read_batch_fn != NULL);
+  return conn->m_closed ? -1 : conn->m_read_batch_fn (conn, elems, n);
+}
+
+/** @brief Completes the reception of a datagram that was read from the socket elsewhere
+ * @component transport
+ *
+ * For use when the datagram was received on the connection's socket without going
+ * through the transport, e.g., by an io_uring-based socket waitset.  It extracts the
+ * packet info from the source address and control messages in msghdr and does the
+ * same bookkeeping as a regular read.  Only connectionless transports that provide a
+ * "read done" function support this.
+ *
+ * @param[in] conn connection on whose socket the datagram was received
+ * @param[in] msghdr message header describing the datagram as filled in by the kernel
+ * @param[in] buf received datagram
+ * @param[in] len size of the buffer the datagram was received in
+ * @param[in] nrecv size of the datagram
+ * @param[out] pktinfo packet info
+ */
+inline void ddsi_conn_read_done (struct ddsi_tran_conn * conn, ddsrt_msghdr_t *msghdr, unsigned char *buf, size_t len, size_t nrecv, struct ddsi_network_packet_info *pktinfo) {
+  assert (conn->m_read_done_fn != NULL);
+  conn->m_read_done_fn (conn, msghdr, buf, len, nrecv, pktinfo);
+}
+
 /** @component transport */
 bool ddsi_conn_peer_locator (struct ddsi_tran_conn * conn, ddsi_locator_t * loc);
 
@@ -11,12 +11,15 @@
 #ifndef DDSI__UDP_H
 #define DDSI__UDP_H
 
+#include "dds/ddsrt/retcode.h"
+
 #if defined (__cplusplus)
 extern "C" {
 #endif
 
 struct in_addr;
 struct ddsi_domaingv;
+struct ddsi_tran_conn;
 
 typedef struct ddsi_udpv4mcgen_address {
   /* base IPv4 MC address is ipv4, host bits are bits base .. base+count-1, this machine is bit idx */
@@ -29,6 +32,16 @@ typedef struct ddsi_udpv4mcgen_address {
 /** @component udp_transport */
 int ddsi_udp_init (struct ddsi_domaingv *gv);
 
+/**
+ * @brief Distribute the datagrams over the sockets sharing a port by the GUID prefix in the RTPS header
+ * @component udp_transport
+ *
+ * @param conn one of the connections bound to the port with SO_REUSEPORT
+ * @param nconns number of connections bound to the port
+ * @return DDS_RETCODE_OK on success, DDS_RETCODE_UNSUPPORTED if the platform doesn't support it
+ */
+dds_return_t ddsi_udp_conn_steer_by_guid_prefix (struct ddsi_tran_conn *conn, uint32_t nconns);
+
 #if defined (__cplusplus)
 }
 #endif
@@ -20,10 +20,50 @@ extern "C" {
 #endif
 
 struct ddsi_writer;
+struct ddsi_wr_prd_match;
+struct ddsi_proxy_reader;
+struct ddsi_wraddrset_cache;
 
 /** @component locators */
 struct ddsi_addrset *ddsi_compute_writer_addrset (const struct ddsi_writer *wr);
 
+/**
+ * @component locators
+ * @brief Construct the state for incremental updates of the writer's address set
+ *
+ * Assigns each matched proxy reader to a locator in the writer's address set, the
+ * latter should have been computed using @ref ddsi_compute_writer_addrset.
+ *
+ * @param[in] wr writer, with `wr->e.lock` held
+ * @returns the new state, or NULL if incremental updates are not possible for this
+ *   set of readers
+ */
+struct ddsi_wraddrset_cache *ddsi_wraddrset_cache_new (struct ddsi_writer *wr);
+
+/** @component locators */
+void ddsi_wraddrset_cache_free (struct ddsi_wraddrset_cache *cache);
+
+/**
+ * @component locators
+ * @brief Incrementally update the writer's address set for a newly matched reader
+ *
+ * @param[in] wr writer, with `wr->e.lock` held
+ * @param[in] m match object for the reader, already in `wr->readers`
+ * @param[in] prd the proxy reader
+ * @returns false if the address set must be recomputed from scratch instead
+ */
+bool ddsi_wraddrset_add_reader (struct ddsi_writer *wr, struct ddsi_wr_prd_match *m, const struct ddsi_proxy_reader *prd);
+
+/**
+ * @component locators
+ * @brief Incrementally update the writer's address set for a reader that no longer matches
+ *
+ * @param[in] wr writer, with `wr->e.lock` held
+ * @param[in] m match object for the reader, already removed from `wr->readers`
+ * @returns false if the address set must be recomputed from scratch instead
+ */
+bool ddsi_wraddrset_remove_reader (struct ddsi_writer *wr, const struct ddsi_wr_prd_match *m);
+
 #if defined (__cplusplus)
 }
 #endif
@@ -52,6 +52,20 @@ void ddsi_xeventq_step (struct ddsi_xeventq *evq);
  */
 void ddsi_xeventq_free (struct ddsi_xeventq *evq);
 
+/**
+ * @component timed_events
+ *
+ * Returns the event queue for the timed events and messages of an endpoint: one of
+ * the shards if the endpoint is a user endpoint and there are shards, else the
+ * domain's default queue.  Always returns the same queue for the same GUID.
+ *
+ * @param gv domain
+ * @param guid GUID of the endpoint
+ * @return the event queue
+ */
+struct ddsi_xeventq *ddsi_xeventq_for_guid (const struct ddsi_domaingv *gv, const ddsi_guid_t *guid)
+  ddsrt_nonnull_all;
+
 /** @component timed_events */
 dds_return_t ddsi_xeventq_start (struct ddsi_xeventq *evq, const char *name); /* <0 => error, =0 => ok */
 
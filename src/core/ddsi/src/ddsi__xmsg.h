@@ -315,10 +315,49 @@ int64_t ddsi_xpack_maxdelay (const struct ddsi_xpack *xp)
 unsigned ddsi_xpack_packetid (const struct ddsi_xpack *xp)
   ddsrt_nonnull_all;
 
+/** @brief Number of packets the queue of the send thread can hold */
+#define DDSI_XPACK_SENDQ_SIZE 256u
+
+/** @brief Statistics of the queue of the send thread
+ *
+ * The counters are 32-bit and wrap around.  A "flush" is the sequence of packets
+ * the send thread transmits before it finds the queue empty.
+ */
+struct ddsi_xpack_sendq_stats {
+  uint32_t enqueued;      /**< number of packets queued */
+  uint32_t sent;          /**< number of packets taken from the queue and sent */
+  uint32_t depth;         /**< number of packets currently in the queue */
+  uint32_t max_depth;     /**< maximum number of packets seen in the queue */
+  uint32_t enqueue_waits; /**< number of times a writer had to wait because the queue was full */
+  uint32_t flushes;       /**< number of flushes */
+  uint32_t max_flush;     /**< maximum number of packets sent in a single flush */
+};
+
 /** @component rtps_msg */
 void ddsi_xpack_sendq_stop (struct ddsi_domaingv *gv)
   ddsrt_nonnull_all;
 
+/** @component rtps_msg */
+void ddsi_xpack_sendq_stats (const struct ddsi_domaingv *gv, struct ddsi_xpack_sendq_stats *st)
+  ddsrt_nonnull_all;
+
+/** @brief Statistics of zero-copy writes (see Internal/ZeroCopySendThreshold)
+ *
+ * The packet counters are 32-bit and wrap around.  A packet sent to multiple
+ * destinations is counted once for each destination.
+ */
+struct ddsi_xpack_zerocopy_stats {
+  uint32_t pending;       /**< number of writes the transport has not yet completed */
+  uint32_t sent;          /**< number of packets sent without copying the data */
+  uint32_t copied;        /**< number of packets for which the kernel copied the data after all */
+  uint64_t bytes_saved;   /**< number of bytes sent without copying them */
+  uint64_t bytes_copied;  /**< number of bytes the kernel copied after all */
+};
+
+/** @component rtps_msg */
+void ddsi_xpack_zerocopy_stats (const struct ddsi_domaingv *gv, struct ddsi_xpack_zerocopy_stats *st)
+  ddsrt_nonnull_all;
+
 /** @component rtps_msg */
 void ddsi_xpack_sendq_fini (struct ddsi_domaingv *gv)
   ddsrt_nonnull_all;
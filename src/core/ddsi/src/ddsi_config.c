@@ -163,6 +163,8 @@ DUPF(uint32);
 #endif
 DU(natint);
 DU(natint_255);
+DU(batch_size);
+DU(data_recv_threads);
 DU(pos_uint);
 DUPF(participantIndex);
 DU(dyn_port);
@@ -181,6 +183,9 @@ PF(maybe_duration);
 DUPF(standards_conformance);
 DUPF(besmode);
 DUPF(retransmit_merging);
+DUPF(xeventq_impl);
+DUPF(sock_waitset_impl);
+DUPF(recv_steering);
 DUPF(sched_class);
 DUPF(random_seed);
 DUPF(entity_naming_mode);
@@ -987,6 +992,18 @@ static const char *en_retransmit_merging_vs[] = { "never", "adaptive", "always",
 static const enum ddsi_retransmit_merging en_retransmit_merging_ms[] = { DDSI_REXMIT_MERGE_NEVER, DDSI_REXMIT_MERGE_ADAPTIVE, DDSI_REXMIT_MERGE_ALWAYS, 0 };
 GENERIC_ENUM_CTYPE (retransmit_merging, enum ddsi_retransmit_merging)
 
+static const char *en_xeventq_impl_vs[] = { "heap", "wheel", NULL };
+static const enum ddsi_xeventq_impl en_xeventq_impl_ms[] = { DDSI_XEVQ_HEAP, DDSI_XEVQ_WHEEL, 0 };
+GENERIC_ENUM_CTYPE (xeventq_impl, enum ddsi_xeventq_impl)
+
+static const char *en_sock_waitset_impl_vs[] = { "default", "io_uring", NULL };
+static const enum ddsi_sock_waitset_impl en_sock_waitset_impl_ms[] = { DDSI_SOCKWS_DEFAULT, DDSI_SOCKWS_IO_URING, 0 };
+GENERIC_ENUM_CTYPE (sock_waitset_impl, enum ddsi_sock_waitset_impl)
+
+static const char *en_recv_steering_vs[] = { "kernel", "guidprefix", NULL };
+static const enum ddsi_recv_steering en_recv_steering_ms[] = { DDSI_RECV_STEERING_KERNEL, DDSI_RECV_STEERING_GUIDPREFIX, 0 };
+GENERIC_ENUM_CTYPE (recv_steering, enum ddsi_recv_steering)
+
 static const char *en_sched_class_vs[] = { "realtime", "timeshare", "default", NULL };
 static const ddsrt_sched_t en_sched_class_ms[] = { DDSRT_SCHED_REALTIME, DDSRT_SCHED_TIMESHARE, DDSRT_SCHED_DEFAULT, 0 };
 GENERIC_ENUM_CTYPE (sched_class, ddsrt_sched_t)
@@ -1441,6 +1458,18 @@ static enum update_result uf_natint_255(struct ddsi_cfgst *cfgst, void *parent,
   return uf_int_min_max(cfgst, parent, cfgelem, first, value, 0, 255);
 }
 
+static enum update_result uf_batch_size(struct ddsi_cfgst *cfgst, void *parent, struct cfgelem const * const cfgelem, int first, const char *value)
+{
+  // upper bound matches DDSI_TRAN_MAX_READ_BATCH and DDSI_TRAN_MAX_WRITE_BATCH
+  return uf_int_min_max(cfgst, parent, cfgelem, first, value, 1, 64);
+}
+
+static enum update_result uf_data_recv_threads(struct ddsi_cfgst *cfgst, void *parent, struct cfgelem const * const cfgelem, int first, const char *value)
+{
+  // upper bound matches MAX_DATA_RECV_THREADS
+  return uf_int_min_max(cfgst, parent, cfgelem, first, value, 1, 16);
+}
+
 static enum update_result uf_uint (struct ddsi_cfgst *cfgst, void *parent, struct cfgelem const * const cfgelem, UNUSED_ARG (int first), const char *value)
 {
   uint32_t * const elem = cfg_address (cfgst, parent, cfgelem);
@@ -0,0 +1,146 @@
+// Copyright(c) 2025 ZettaScale Technology and others
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License v. 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Eclipse Distribution License
+// v. 1.0 which is available at
+// http://www.eclipse.org/org/documents/edl-v10.php.
+//
+// SPDX-License-Identifier: EPL-2.0 OR BSD-3-Clause
+
+#include <assert.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include "dds/ddsrt/heap.h"
+#include "dds/ddsrt/string.h"
+#include "dds/ddsrt/avl.h"
+#include "dds/ddsi/ddsi_domaingv.h"
+#include "dds/ddsi/ddsi_serdata.h"
+#include "dds/ddsi/ddsi_endpoint.h"
+#include "dds/ddsi/ddsi_proxy_endpoint.h"
+#include "dds/ddsi/ddsi_log.h"
+#include "ddsi__content_filter.h"
+#include "ddsi__endpoint_match.h"
+#include "ddsi__entity_index.h"
+#include "ddsi__misc.h"
+#include "ddsi__receive.h"
+#include "ddsi__sysdeps.h"
+#include "ddsi__xevent.h"
+#include "ddsi__xmsg.h"
+
+extern inline void *ddsi_content_filter_compile (const struct ddsi_content_filter_interface *cfif, const struct ddsi_sertype *type, const struct ddsi_content_filter_property *cfp);
+extern inline bool ddsi_content_filter_accepts (const struct ddsi_content_filter_interface *cfif, const void *filter, const struct ddsi_serdata *serdata);
+extern inline void ddsi_content_filter_free (const struct ddsi_content_filter_interface *cfif, void *filter);
+
+void ddsi_content_filter_property_copy (ddsi_content_filter_property_t *dst, const ddsi_content_filter_property_t *src)
+{
+  dst->content_filtered_topic_name = ddsrt_strdup (src->content_filtered_topic_name);
+  dst->related_topic_name = ddsrt_strdup (src->related_topic_name);
+  dst->filter_class_name = ddsrt_strdup (src->filter_class_name);
+  dst->filter_expression = ddsrt_strdup (src->filter_expression);
+  dst->expression_parameters.n = src->expression_parameters.n;
+  dst->expression_parameters.strs = NULL;
+  if (src->expression_parameters.n > 0)
+  {
+    dst->expression_parameters.strs = ddsrt_malloc (src->expression_parameters.n * sizeof (*dst->expression_parameters.strs));
+    for (uint32_t i = 0; i < src->expression_parameters.n; i++)
+      dst->expression_parameters.strs[i] = ddsrt_strdup (src->expression_parameters.strs[i]);
+  }
+}
+
+ddsi_content_filter_property_t *ddsi_content_filter_property_dup (const ddsi_content_filter_property_t *cfp)
+{
+  ddsi_content_filter_property_t *x = ddsrt_malloc (sizeof (*x));
+  ddsi_content_filter_property_copy (x, cfp);
+  return x;
+}
+
+void ddsi_content_filter_property_free (ddsi_content_filter_property_t *cfp)
+{
+  if (cfp == NULL)
+    return;
+  for (uint32_t i = 0; i < cfp->expression_parameters.n; i++)
+    ddsrt_free (cfp->expression_parameters.strs[i]);
+  ddsrt_free (cfp->expression_parameters.strs);
+  ddsrt_free (cfp->filter_expression);
+  ddsrt_free (cfp->filter_class_name);
+  ddsrt_free (cfp->related_topic_name);
+  ddsrt_free (cfp->content_filtered_topic_name);
+  ddsrt_free (cfp);
+}
+
+static bool is_filterable (const struct ddsi_serdata *serdata)
+{
+  // invalid samples (dispose, unregister) always pass: they are needed for the
+  // instance life cycle in the readers
+  return serdata->kind == SDK_DATA && serdata->statusinfo == 0;
+}
+
+int ddsi_content_filter_prd_filter (struct ddsi_writer *wr, struct ddsi_proxy_reader *prd, struct ddsi_serdata *serdata)
+{
+  const struct ddsi_content_filter_interface * const cfif = wr->e.gv->content_filter_interface;
+  ASSERT_MUTEX_HELD (&wr->e.lock);
+  if (!is_filterable (serdata))
+    return 1;
+  ddsi_guid_t guid = { .prefix = prd->e.guid.prefix, .entityid = { .u = 0 } };
+  ddsrt_avl_iter_t it;
+  for (const struct ddsi_wr_prd_match *m = ddsrt_avl_iter_succ (&ddsi_wr_readers_treedef, &wr->readers, &it, &guid);
+       m && ddsi_guid_prefix_eq (&m->prd_guid.prefix, &prd->e.guid.prefix);
+       m = ddsrt_avl_iter_next (&it))
+  {
+    if (m->content_filter == NULL || ddsi_content_filter_accepts (cfif, m->content_filter, serdata))
+      return 1;
+  }
+  return 0;
+}
+
+bool ddsi_writer_content_filter_rejects (const struct ddsi_writer *wr, const struct ddsi_serdata *serdata)
+{
+  const struct ddsi_content_filter_interface * const cfif = wr->e.gv->content_filter_interface;
+  ASSERT_MUTEX_HELD (&wr->e.lock);
+  if (wr->num_readers == 0 || wr->num_readers_content_filtered < wr->num_readers || !is_filterable (serdata))
+    return false;
+  ddsrt_avl_iter_t it;
+  for (const struct ddsi_wr_prd_match *m = ddsrt_avl_iter_first (&ddsi_wr_readers_treedef, &wr->readers, &it); m; m = ddsrt_avl_iter_next (&it))
+  {
+    assert (m->content_filter != NULL);
+    if (ddsi_content_filter_accepts (cfif, m->content_filter, serdata))
+      return false;
+  }
+  return true;
+}
+
+void ddsi_writer_send_filtered_gaps (struct ddsi_writer *wr, ddsi_seqno_t seq)
+{
+  struct ddsi_domaingv * const gv = wr->e.gv;
+  const uint32_t zero = 0;
+  ddsi_guid_prefix_t last_prefix;
+  bool have_last = false;
+  ASSERT_MUTEX_HELD (&wr->e.lock);
+  assert (wr->filtered_gap_start > 0 && wr->filtered_gap_start < seq);
+  ETRACE (wr, "send_filtered_gaps "PGUIDFMT" %"PRIu64"..%"PRIu64"\n", PGUID (wr->e.guid), wr->filtered_gap_start, seq);
+
+  ddsrt_avl_iter_t it;
+  for (const struct ddsi_wr_prd_match *m = ddsrt_avl_iter_first (&ddsi_wr_readers_treedef, &wr->readers, &it); m; m = ddsrt_avl_iter_next (&it))
+  {
+    struct ddsi_proxy_reader *prd;
+    if (!m->is_reliable || m->via_psmx)
+      continue;
+    if (have_last && ddsi_guid_prefix_eq (&last_prefix, &m->prd_guid.prefix))
+      continue;
+    if ((prd = ddsi_entidx_lookup_proxy_reader_guid (gv->entity_index, &m->prd_guid)) == NULL)
+      continue;
+    last_prefix = m->prd_guid.prefix;
+    have_last = true;
+
+    struct ddsi_xmsg *msg = ddsi_xmsg_new (gv->xmsgpool, &wr->e.guid, wr->c.pp, 0, DDSI_XMSG_KIND_CONTROL);
+    ddsi_xmsg_setdst_prd (msg, prd);
+    ddsi_add_gap (msg, wr, prd, wr->filtered_gap_start, seq, 0, &zero);
+    if (ddsi_xmsg_size (msg) == 0)
+      ddsi_xmsg_free (msg);
+    else
+      ddsi_qxev_msg (wr->evq, msg);
+  }
+  wr->filtered_gap_start = 0;
+}
@@ -378,6 +378,12 @@ static void print_writer (struct st *st, void *varg)
   cpfku32 (st, "throttle_count", w->throttle_count);
   cpfku64 (st, "time_throttled", w->time_throttled);
   cpfku64 (st, "time_retransmit", w->time_retransmit);
+  if (w->pacing.enabled)
+  {
+    cpfku64 (st, "pacing_rate", w->pacing.rate);
+    cpfku32 (st, "pacing_decrease_count", w->pacing.decrease_count);
+    cpfku64 (st, "time_paced", w->pacing.time_paced);
+  }
 
   cpfkseq (st, "as", print_addrset, w->as);
   cpfkseq (st, "local_readers", print_writer_rdseq, w);
@@ -537,11 +543,12 @@ static void print_proxy_writer (struct st *st, void *varg)
   cpfkseqno (st, "last_seq", w->last_seq);
   cpfku32 (st, "last_fragnum", w->last_fragnum);
   cpfkseq (st, "local_readers", print_proxy_writer_rdseq, w);
-  uint64_t disc_frags, disc_samples;
-  ddsi_defrag_stats (w->defrag, &disc_frags);
+  uint64_t disc_frags, disc_samples, rec_frags;
+  ddsi_defrag_stats (w->defrag, &disc_frags, &rec_frags);
   ddsi_reorder_stats (w->reorder, &disc_samples);
   cpfku64 (st, "discarded_fragment_bytes", disc_frags);
   cpfku64 (st, "discarded_sample_bytes", disc_samples);
+  cpfku64 (st, "recovered_fragment_bytes", rec_frags);
   ddsrt_mutex_unlock (&w->e.lock);
 }
 
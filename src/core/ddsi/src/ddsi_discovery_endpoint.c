@@ -35,6 +35,8 @@
 #include "ddsi__vendor.h"
 #include "ddsi__xqos.h"
 #include "ddsi__addrset.h"
+#include "ddsi__xevent.h"
+#include "ddsi__content_filter.h"
 
 struct add_locator_to_ps_arg {
   struct ddsi_domaingv *gv;
@@ -177,6 +179,17 @@ static int sedp_write_endpoint_impl
         ps.present |= PP_CYCLONE_REQUESTS_KEYHASH;
         ps.cyclone_requests_keyhash = 1u;
       }
+      if (gv->config.fec)
+      {
+        ps.present |= PP_CYCLONE_ACCEPTS_FEC;
+        ps.cyclone_accepts_fec = 1u;
+      }
+      if (rd->content_filter)
+      {
+        // not aliased: plist_fini always frees the expression parameter sequence
+        ps.present |= PP_CONTENT_FILTER_PROPERTY;
+        ddsi_content_filter_property_copy (&ps.content_filter_property, rd->content_filter);
+      }
     }
 
 #ifdef DDSRT_HAVE_SSM
@@ -526,7 +539,7 @@ void ddsi_handle_sedp_alive_endpoint (const struct ddsi_receiver_state *rst, dds
         struct ddsi_proxy_writer *proxy_writer;
         /* not supposed to get here for built-in ones, so can determine the channel based on the transport priority */
         assert (!ddsi_is_builtin_entityid (datap->endpoint_guid.entityid, vendorid));
-        ddsi_new_proxy_writer (&proxy_writer, gv, &ppguid, &datap->endpoint_guid, as, datap, gv->user_dqueue, gv->xevents, timestamp, seq);
+        ddsi_new_proxy_writer (&proxy_writer, gv, &ppguid, &datap->endpoint_guid, as, datap, gv->user_dqueue, ddsi_xeventq_for_guid (gv, &datap->endpoint_guid), timestamp, seq);
       }
     }
     else
@@ -45,6 +45,8 @@
 #include "ddsi__vendor.h"
 #include "ddsi__xqos.h"
 #include "ddsi__hbcontrol.h"
+#include "ddsi__pacing.h"
+#include "ddsi__content_filter.h"
 #include "ddsi__lease.h"
 #include "dds/dds.h"
 #include "dds__types.h"
@@ -171,22 +173,8 @@ static uint32_t get_min_receive_buffer_size (struct ddsi_writer *wr)
   return min_receive_buffer_size;
 }
 
-void ddsi_rebuild_writer_addrset (struct ddsi_writer *wr)
+static void writer_set_burst_size_limits (struct ddsi_writer *wr)
 {
-  /* FIXME: way too inefficient in this form:
-     - it gets computed for every change
-     - in many cases the set of addresses from the readers
-       is identical, so we could cache the results */
-
-  /* only one operation at a time */
-  ASSERT_MUTEX_HELD (&wr->e.lock);
-
-  /* swap in new address set; this simple procedure is ok as long as
-     wr->as is never accessed without the wr->e.lock held */
-  struct ddsi_addrset * const oldas = wr->as;
-  wr->as = ddsi_compute_writer_addrset (wr);
-  ddsi_unref_addrset (oldas);
-
   /* Computing burst size limit here is a bit of a hack; but anyway ...
      try to limit bursts of retransmits to 67% of the smallest receive
      buffer, and those of initial transmissions to that + overshoot%.
@@ -197,7 +185,7 @@ void ddsi_rebuild_writer_addrset (struct ddsi_writer *wr)
      - the way things are now: the retransmits will be sent unicast,
        so if there are multiple receivers, that'll blow up things by
        a non-trivial amount */
-  const uint32_t min_receive_buffer_size = get_min_receive_buffer_size (wr);
+  const uint32_t min_receive_buffer_size = wr->min_receive_buffer_size;
   wr->rexmit_burst_size_limit = min_receive_buffer_size - min_receive_buffer_size / 3;
   if (wr->rexmit_burst_size_limit < 1024)
     wr->rexmit_burst_size_limit = 1024;
@@ -213,12 +201,56 @@ void ddsi_rebuild_writer_addrset (struct ddsi_writer *wr)
     wr->init_burst_size_limit = wr->rexmit_burst_size_limit;
   else
     wr->init_burst_size_limit = (uint32_t) limit64;
+}
+
+void ddsi_rebuild_writer_addrset (struct ddsi_writer *wr)
+{
+  /* FIXME: in many cases the set of addresses from the readers is
+     identical, so we could cache the results */
+
+  /* only one operation at a time */
+  ASSERT_MUTEX_HELD (&wr->e.lock);
+
+  /* swap in new address set; this simple procedure is ok as long as
+     wr->as is never accessed without the wr->e.lock held */
+  struct ddsi_addrset * const oldas = wr->as;
+  wr->as = ddsi_compute_writer_addrset (wr);
+  ddsi_unref_addrset (oldas);
+
+  if (wr->as_cache)
+    ddsi_wraddrset_cache_free (wr->as_cache);
+  wr->as_cache = ddsi_wraddrset_cache_new (wr);
+
+  wr->min_receive_buffer_size = get_min_receive_buffer_size (wr);
+  writer_set_burst_size_limits (wr);
 
   ELOGDISC (wr, "ddsi_rebuild_writer_addrset("PGUIDFMT"):", PGUID (wr->e.guid));
   ddsi_log_addrset(wr->e.gv, DDS_LC_DISCOVERY, "", wr->as);
   ELOGDISC (wr, " (burst size %"PRIu32" rexmit %"PRIu32")\n", wr->init_burst_size_limit, wr->rexmit_burst_size_limit);
 }
 
+void ddsi_update_writer_addrset (struct ddsi_writer *wr, struct ddsi_wr_prd_match *m, const struct ddsi_proxy_reader *prd, bool added)
+{
+  ASSERT_MUTEX_HELD (&wr->e.lock);
+  if (!(added ? ddsi_wraddrset_add_reader (wr, m, prd) : ddsi_wraddrset_remove_reader (wr, m)))
+  {
+    ddsi_rebuild_writer_addrset (wr);
+    return;
+  }
+
+  /* A reader leaving can only raise the minimum receive buffer size, sticking
+     to the old, conservative limits until the next full rebuild is fine */
+  if (added && prd->receive_buffer_size < wr->min_receive_buffer_size)
+  {
+    wr->min_receive_buffer_size = prd->receive_buffer_size;
+    writer_set_burst_size_limits (wr);
+  }
+
+  ELOGDISC (wr, "ddsi_update_writer_addrset("PGUIDFMT" %s "PGUIDFMT"):", PGUID (wr->e.guid), added ? "add" : "remove", PGUID (prd->e.guid));
+  ddsi_log_addrset(wr->e.gv, DDS_LC_DISCOVERY, "", wr->as);
+  ELOGDISC (wr, " (burst size %"PRIu32" rexmit %"PRIu32")\n", wr->init_burst_size_limit, wr->rexmit_burst_size_limit);
+}
+
 #ifdef DDSRT_HAVE_SSM
 static bool nwpart_includes_ssm_enabled_interfaces (const struct ddsi_domaingv *gv, const struct ddsi_config_networkpartition_listelem *np)
   ddsrt_nonnull ((1));
@@ -799,6 +831,10 @@ static void ddsi_new_writer_guid_common_init (struct ddsi_writer *wr, const char
   wr->num_readers = 0;
   wr->num_reliable_readers = 0;
   wr->num_readers_requesting_keyhash = 0;
+  wr->num_readers_accepting_fec = 0;
+  wr->num_readers_content_filtered = 0;
+  wr->filtered_gap_start = 0;
+  wr->filtered_count = 0;
   wr->num_acks_received = 0;
   wr->num_nacks_received = 0;
   wr->throttle_count = 0;
@@ -816,6 +852,7 @@ static void ddsi_new_writer_guid_common_init (struct ddsi_writer *wr, const char
   wr->test_suppress_flush_on_sync_heartbeat = 0;
   wr->test_drop_outgoing_data = 0;
   wr->alive_vclock = 0;
+  wr->min_receive_buffer_size = UINT32_MAX;
   wr->init_burst_size_limit = UINT32_MAX - UINT16_MAX;
   wr->rexmit_burst_size_limit = UINT32_MAX - UINT16_MAX;
 
@@ -855,11 +892,14 @@ static void ddsi_new_writer_guid_common_init (struct ddsi_writer *wr, const char
             (wr->e.guid.entityid.u == DDSI_ENTITYID_P2P_BUILTIN_PARTICIPANT_STATELESS_MESSAGE_WRITER));
   }
   wr->handle_as_transient_local = (wr->xqos->durability.kind == DDS_DURABILITY_TRANSIENT_LOCAL);
+  ddsi_pacing_init (&wr->pacing, gv, gv->config.congestion_control && wr->reliable && !ddsi_is_builtin_entityid (wr->e.guid.entityid, DDSI_VENDORID_ECLIPSE));
+  wr->fec = gv->config.fec && !ddsi_is_builtin_entityid (wr->e.guid.entityid, DDSI_VENDORID_ECLIPSE);
   wr->num_readers_requesting_keyhash +=
     gv->config.generate_keyhash &&
     ((wr->e.guid.entityid.u & DDSI_ENTITYID_KIND_MASK) == DDSI_ENTITYID_KIND_WRITER_WITH_KEY);
   wr->type = ddsi_sertype_ref (type);
   wr->as = ddsi_new_addrset ();
+  wr->as_cache = NULL;
 
 #ifdef DDS_HAS_NETWORK_PARTITIONS
   /* This is an open issue how to encrypt mesages send for various
@@ -911,7 +951,7 @@ static void ddsi_new_writer_guid_common_init (struct ddsi_writer *wr, const char
   }
 #endif
 
-  wr->evq = gv->xevents;
+  wr->evq = ddsi_xeventq_for_guid (gv, &wr->e.guid);
 
   /* heartbeat event will be deleted when the handler can't find a
      writer for it in the hash table. NEVER => won't ever be
@@ -1100,7 +1140,7 @@ static void gc_delete_writer (struct ddsi_gcreq *gcreq)
 
   /* We now allow GC while blocked on a full WHC, but we still don't allow deleting a writer while blocked on it. The writer's state must be DELETING by the time we get here, and that means the transmit path is no longer blocked. It doesn't imply that the write thread is no longer in throttle_writer(), just that if it is, it will soon return from there. Therefore, block until it isn't throttling anymore. We can safely lock the writer, as we're on the separate GC thread. */
   assert (wr->state == WRST_DELETING);
-  assert (!wr->throttling);
+  assert (!wr->throttling && !wr->pacing.waiters);
 
   if (wr->heartbeat_xevent)
   {
@@ -1149,10 +1189,13 @@ static void gc_delete_writer (struct ddsi_gcreq *gcreq)
     ddsi_unref_addrset (wr->ssm_as);
 #endif
   ddsi_unref_addrset (wr->as); /* must remain until readers gone (rebuilding of addrset) */
+  if (wr->as_cache)
+    ddsi_wraddrset_cache_free (wr->as_cache);
   ddsi_xqos_fini (wr->xqos);
   ddsrt_free (wr->xqos);
   ddsi_local_reader_ary_fini (&wr->rdary);
   ddsrt_cond_destroy (&wr->throttle_cond);
+  ddsi_pacing_fini (&wr->pacing);
 
   ddsi_sertype_unref ((struct ddsi_sertype *) wr->type);
   endpoint_common_fini (&wr->e, &wr->c);
@@ -1166,7 +1209,7 @@ static void gc_delete_writer_throttlewait (struct ddsi_gcreq *gcreq)
   /* We now allow GC while blocked on a full WHC, but we still don't allow deleting a writer while blocked on it. The writer's state must be DELETING by the time we get here, and that means the transmit path is no longer blocked. It doesn't imply that the write thread is no longer in throttle_writer(), just that if it is, it will soon return from there. Therefore, block until it isn't throttling anymore. We can safely lock the writer, as we're on the separate GC thread. */
   assert (wr->state == WRST_DELETING);
   ddsrt_mutex_lock (&wr->e.lock);
-  while (wr->throttling)
+  while (wr->throttling || wr->pacing.waiters)
     ddsrt_cond_wait (&wr->throttle_cond, &wr->e.lock);
   ddsrt_mutex_unlock (&wr->e.lock);
   ddsi_gcreq_requeue (gcreq, gc_delete_writer);
@@ -1174,7 +1217,7 @@ static void gc_delete_writer_throttlewait (struct ddsi_gcreq *gcreq)
 
 static int gcreq_writer (struct ddsi_writer *wr)
 {
-  struct ddsi_gcreq *gcreq = ddsi_gcreq_new (wr->e.gv->gcreq_queue, wr->throttling ? gc_delete_writer_throttlewait : gc_delete_writer);
+  struct ddsi_gcreq *gcreq = ddsi_gcreq_new (wr->e.gv->gcreq_queue, (wr->throttling || wr->pacing.waiters) ? gc_delete_writer_throttlewait : gc_delete_writer);
   gcreq->arg = wr;
   ddsi_gcreq_enqueue (gcreq);
   return 0;
@@ -1473,7 +1516,7 @@ static void reader_init_network_partition (struct ddsi_reader *rd)
 }
 #endif /* DDS_HAS_NETWORK_PARTITIONS */
 
-dds_return_t ddsi_new_reader (struct ddsi_reader **rd_out, const struct ddsi_guid *guid, const struct ddsi_guid *group_guid, struct ddsi_participant *pp, const char *topic_name, const struct ddsi_sertype *type, const struct dds_qos *xqos, struct ddsi_rhc *rhc, ddsi_status_cb_t status_cb, void * status_entity, struct ddsi_psmx_locators_set *psmx_locators)
+dds_return_t ddsi_new_reader (struct ddsi_reader **rd_out, const struct ddsi_guid *guid, const struct ddsi_guid *group_guid, struct ddsi_participant *pp, const char *topic_name, const struct ddsi_sertype *type, const struct dds_qos *xqos, struct ddsi_rhc *rhc, ddsi_status_cb_t status_cb, void * status_entity, struct ddsi_psmx_locators_set *psmx_locators, const struct ddsi_content_filter_property *content_filter)
 {
   /* see ddsi_new_writer for commenets */
 
@@ -1521,6 +1564,7 @@ dds_return_t ddsi_new_reader (struct ddsi_reader **rd_out, const struct ddsi_gui
   rd->request_keyhash = rd->type->request_keyhash;
   rd->init_acknack_count = 1;
   rd->num_writers = 0;
+  rd->content_filter = content_filter ? ddsi_content_filter_property_dup (content_filter) : NULL;
 #ifdef DDSRT_HAVE_SSM
   rd->favours_ssm = 0;
 #endif
@@ -1610,6 +1654,7 @@ static void gc_delete_reader (struct ddsi_gcreq *gcreq)
     (rd->status_cb) (rd->status_cb_entity, NULL);
   }
   ddsi_sertype_unref ((struct ddsi_sertype *) rd->type);
+  ddsi_content_filter_property_free (rd->content_filter);
 
   ddsi_xqos_fini (rd->xqos);
   ddsrt_free (rd->xqos);
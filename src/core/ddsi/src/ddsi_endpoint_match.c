@@ -33,6 +33,7 @@
 #include "ddsi__vendor.h"
 #include "ddsi__lat_estim.h"
 #include "ddsi__acknack.h"
+#include "ddsi__content_filter.h"
 #ifdef DDS_HAS_TYPE_DISCOVERY
 #include "ddsi__typelookup.h"
 #endif
@@ -614,6 +615,7 @@ void ddsi_free_wr_prd_match (const struct ddsi_domaingv *gv, const ddsi_guid_t *
     (void) wr_guid;
 #endif
     ddsi_lat_estim_fini (&m->hb_to_ack_latency);
+    ddsi_content_filter_free (gv->content_filter_interface, m->content_filter);
     ddsrt_free (m);
   }
 }
@@ -759,11 +761,17 @@ void ddsi_writer_add_connection (struct ddsi_writer *wr, struct ddsi_proxy_reade
   m->all_have_replied_to_hb = 0;
   m->non_responsive_count = 0;
   m->rexmit_requests = 0;
+  ddsi_set_unspec_xlocator (&m->cover_loc);
 #ifdef DDS_HAS_SECURITY
   m->crypto_handle = crypto_handle;
 #else
   DDSRT_UNUSED_ARG(crypto_handle);
 #endif
+  /* data going via PSMX doesn't pass through the writer's filtering */
+  if (prd->content_filter && !m->via_psmx)
+    m->content_filter = ddsi_content_filter_compile (wr->e.gv->content_filter_interface, wr->type, prd->content_filter);
+  else
+    m->content_filter = NULL;
   /* m->demoted: see below */
   ddsrt_mutex_lock (&prd->e.lock);
   if (prd->deleting)
@@ -802,6 +810,7 @@ void ddsi_writer_add_connection (struct ddsi_writer *wr, struct ddsi_proxy_reade
               PGUID (wr->e.guid), PGUID (prd->e.guid));
     ddsrt_mutex_unlock (&wr->e.lock);
     ddsi_lat_estim_fini (&m->hb_to_ack_latency);
+    ddsi_content_filter_free (wr->e.gv->content_filter_interface, m->content_filter);
     ddsrt_free (m);
   }
   else
@@ -812,7 +821,9 @@ void ddsi_writer_add_connection (struct ddsi_writer *wr, struct ddsi_proxy_reade
     wr->num_readers++;
     wr->num_reliable_readers += m->is_reliable;
     wr->num_readers_requesting_keyhash += prd->requests_keyhash ? 1 : 0;
-    ddsi_rebuild_writer_addrset (wr);
+    wr->num_readers_accepting_fec += prd->accepts_fec ? 1 : 0;
+    wr->num_readers_content_filtered += (m->content_filter != NULL) ? 1 : 0;
+    ddsi_update_writer_addrset (wr, m, prd, true);
     ddsrt_mutex_unlock (&wr->e.lock);
 
     if (wr->status_cb)
@@ -1221,7 +1232,9 @@ void ddsi_writer_drop_connection (const struct ddsi_guid *wr_guid, const struct
       wr->num_readers--;
       wr->num_reliable_readers -= m->is_reliable;
       wr->num_readers_requesting_keyhash -= prd->requests_keyhash ? 1 : 0;
-      ddsi_rebuild_writer_addrset (wr);
+      wr->num_readers_accepting_fec -= prd->accepts_fec ? 1 : 0;
+      wr->num_readers_content_filtered -= (m->content_filter != NULL) ? 1 : 0;
+      ddsi_update_writer_addrset (wr, m, prd, false);
       ddsi_remove_acked_messages (wr, &whcst, &deferred_free_list);
     }
 
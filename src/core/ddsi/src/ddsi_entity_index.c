@@ -46,16 +46,21 @@ static int all_entities_compare (const void *va, const void *vb);
 static const ddsrt_avl_treedef_t all_entities_treedef =
   DDSRT_AVL_TREEDEF_INITIALIZER (offsetof (struct ddsi_entity_common, all_entities_avlnode), 0, all_entities_compare, 0);
 
-static uint32_t hash_entity_guid (const struct ddsi_entity_common *c)
+uint32_t ddsi_entidx_guid_hash (const ddsi_guid_t *guid)
 {
   return
-    (uint32_t) (((((uint32_t) c->guid.prefix.u[0] + unihashconsts[0]) *
-                  ((uint32_t) c->guid.prefix.u[1] + unihashconsts[1])) +
-                 (((uint32_t) c->guid.prefix.u[2] + unihashconsts[2]) *
-                  ((uint32_t) c->guid.entityid.u  + unihashconsts[3])))
+    (uint32_t) (((((uint32_t) guid->prefix.u[0] + unihashconsts[0]) *
+                  ((uint32_t) guid->prefix.u[1] + unihashconsts[1])) +
+                 (((uint32_t) guid->prefix.u[2] + unihashconsts[2]) *
+                  ((uint32_t) guid->entityid.u  + unihashconsts[3])))
                 >> 32);
 }
 
+static uint32_t hash_entity_guid (const struct ddsi_entity_common *c)
+{
+  return ddsi_entidx_guid_hash (&c->guid);
+}
+
 static uint32_t hash_entity_guid_wrapper (const void *c)
 {
   return hash_entity_guid (c);
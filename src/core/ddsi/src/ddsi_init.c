@@ -38,6 +38,7 @@
 #include "ddsi__discovery.h"
 #include "ddsi__radmin.h"
 #include "ddsi__thread.h"
+#include "ddsi__tkmap.h"
 #include "ddsi__entity_index.h"
 #include "ddsi__lease.h"
 #include "ddsi__entity.h"
@@ -82,6 +83,74 @@ enum make_uc_sockets_ret {
   MUSRET_ERROR          /* generic error, no use continuing */
 };
 
+static bool use_multiple_receive_threads (const struct ddsi_config *cfg)
+{
+  switch (cfg->multiple_recv_threads)
+  {
+    case DDSI_BOOLDEF_FALSE:
+    case DDSI_BOOLDEF_DEFAULT:
+      // Too many people run into trouble with firewalls blocking the packets
+      // Cyclone sends to itself for interrupting the blocking reads.  So
+      // default to a single thread and multiplexing.
+      //
+      // (One could also consider multiple threads, but still doing select+read
+      // but having fewer threads is arguably a good thing in itself.)
+      return false;
+    case DDSI_BOOLDEF_TRUE:
+      return true;
+  }
+  assert (0);
+  return false;
+}
+
+static uint32_t data_recv_threads (const struct ddsi_domaingv *gv)
+{
+  // Multiple threads for receiving data require multiple sockets bound to the same
+  // port, and only UDP can do that; the conditions must match the one for the
+  // dedicated data receive thread in setup_and_start_recv_threads
+  if (gv->config.data_recv_threads <= 1)
+    return 1;
+  if (!(gv->m_factory->m_connless && gv->config.many_sockets_mode == DDSI_MSM_SINGLE_UNICAST && use_multiple_receive_threads (&gv->config)))
+  {
+    GVLOG (DDS_LC_CONFIG, "rtps_init: Internal/DataReceiveThreads ignored: requires multiple receive threads and ManySocketsMode single\n");
+    return 1;
+  }
+  if (!ddsi_factory_supports (gv->m_factory, DDSI_LOCATOR_KIND_UDPv4) && !ddsi_factory_supports (gv->m_factory, DDSI_LOCATOR_KIND_UDPv6))
+  {
+    GVLOG (DDS_LC_CONFIG, "rtps_init: Internal/DataReceiveThreads ignored: not supported by transport %s\n", gv->m_factory->m_typename);
+    return 1;
+  }
+#ifndef SO_REUSEPORT
+  GVWARNING ("rtps_init: Internal/DataReceiveThreads ignored: SO_REUSEPORT not supported\n");
+  return 1;
+#else
+  return (uint32_t) gv->config.data_recv_threads;
+#endif
+}
+
+static void make_data_conn_uc_shards (struct ddsi_domaingv *gv, uint32_t nthreads)
+{
+  // Failing to create the additional sockets only costs performance, so it is not an error
+  const uint32_t port = ddsi_conn_port (gv->data_conn_uc);
+  const struct ddsi_tran_qos qos = { .m_purpose = DDSI_TRAN_QOS_RECV_UC, .m_diffserv = 0, .m_interface = NULL, .m_reuseport = true };
+  assert (gv->n_data_conn_uc_shards == 0 && nthreads <= MAX_DATA_RECV_THREADS);
+  while (gv->n_data_conn_uc_shards + 1 < nthreads)
+  {
+    if (ddsi_factory_create_conn (&gv->data_conn_uc_shards[gv->n_data_conn_uc_shards], gv->m_factory, port, &qos) != DDS_RETCODE_OK)
+    {
+      GVWARNING ("rtps_init: failed to create socket %"PRIu32" for data port %"PRIu32", using %"PRIu32" data receive threads\n",
+                 gv->n_data_conn_uc_shards + 1, port, gv->n_data_conn_uc_shards + 1);
+      break;
+    }
+    gv->n_data_conn_uc_shards++;
+  }
+  if (gv->n_data_conn_uc_shards > 0 && gv->config.data_recv_steering == DDSI_RECV_STEERING_GUIDPREFIX)
+  {
+    if (ddsi_udp_conn_steer_by_guid_prefix (gv->data_conn_uc, gv->n_data_conn_uc_shards + 1) != DDS_RETCODE_OK)
+      GVWARNING ("rtps_init: steering by GUID prefix not supported, using default distribution over data receive threads\n");
+  }
+}
+
 static enum make_uc_sockets_ret make_uc_sockets (struct ddsi_domaingv *gv, uint32_t * pdisc, uint32_t * pdata, int ppid)
 {
   dds_return_t rc;
@@ -114,11 +183,20 @@ static enum make_uc_sockets_ret make_uc_sockets (struct ddsi_domaingv *gv, uint3
   if (rc != DDS_RETCODE_OK)
     goto fail_disc;
 
-  if (*pdata == 0 || *pdata == *pdisc)
+  // Spreading the data over multiple threads needs a data port that is distinct from
+  // the discovery port, when both are random that means it needs its own socket
+  uint32_t nthreads = data_recv_threads (gv);
+  if (*pdata != 0 && *pdata == *pdisc && nthreads > 1)
+  {
+    GVLOG (DDS_LC_CONFIG, "rtps_init: Internal/DataReceiveThreads ignored: data and discovery ports are the same\n");
+    nthreads = 1;
+  }
+  if ((*pdata == 0) ? (nthreads == 1) : (*pdata == *pdisc))
     gv->data_conn_uc = gv->disc_conn_uc;
   else
   {
-    rc = ddsi_factory_create_conn (&gv->data_conn_uc, gv->m_factory, *pdata, &qos);
+    const struct ddsi_tran_qos qos_data = { .m_purpose = DDSI_TRAN_QOS_RECV_UC, .m_diffserv = 0, .m_interface = NULL, .m_reuseport = (nthreads > 1) };
+    rc = ddsi_factory_create_conn (&gv->data_conn_uc, gv->m_factory, *pdata, &qos_data);
     if (rc != DDS_RETCODE_OK)
       goto fail_data;
   }
@@ -126,6 +204,8 @@ static enum make_uc_sockets_ret make_uc_sockets (struct ddsi_domaingv *gv, uint3
   ddsi_conn_locator (gv->data_conn_uc, &gv->loc_default_uc);
   *pdisc = gv->loc_meta_uc.port;
   *pdata = gv->loc_default_uc.port;
+  if (nthreads > 1)
+    make_data_conn_uc_shards (gv, nthreads);
   return MUSRET_SUCCESS;
 
 fail_data:
@@ -513,6 +593,20 @@ int ddsi_config_prep (struct ddsi_domaingv *gv, struct ddsi_cfgst *cfgst)
     DDS_ILOG (DDS_LC_ERROR, gv->config.domainId, "Invalid watermark settings\n");
     goto err_config_late_error;
   }
+  if (gv->config.congestion_control &&
+      (gv->config.cc_min_rate == 0 ||
+       gv->config.cc_max_rate < gv->config.cc_min_rate ||
+       gv->config.cc_initial_rate < gv->config.cc_min_rate ||
+       gv->config.cc_initial_rate > gv->config.cc_max_rate))
+  {
+    DDS_ILOG (DDS_LC_ERROR, gv->config.domainId, "Invalid congestion control settings\n");
+    goto err_config_late_error;
+  }
+  if (gv->config.fec && gv->config.fec_group_size > UINT16_MAX)
+  {
+    DDS_ILOG (DDS_LC_ERROR, gv->config.domainId, "Invalid forward error correction group size\n");
+    goto err_config_late_error;
+  }
 
   /* Dependencies between default values is not handled
    automatically by the gv->config processing (yet) */
@@ -844,26 +938,6 @@ static void make_special_types (struct ddsi_domaingv *gv)
   free_special_types (gv);
 }
 
-static bool use_multiple_receive_threads (const struct ddsi_config *cfg)
-{
-  switch (cfg->multiple_recv_threads)
-  {
-    case DDSI_BOOLDEF_FALSE:
-    case DDSI_BOOLDEF_DEFAULT:
-      // Too many people run into trouble with firewalls blocking the packets
-      // Cyclone sends to itself for interrupting the blocking reads.  So
-      // default to a single thread and multiplexing.
-      //
-      // (One could also consider multiple threads, but still doing select+read
-      // but having fewer threads is arguably a good thing in itself.)
-      return false;
-    case DDSI_BOOLDEF_TRUE:
-      return true;
-  }
-  assert (0);
-  return false;
-}
-
 static int setup_and_start_recv_threads (struct ddsi_domaingv *gv)
 {
   const bool multi_recv_thr = use_multiple_receive_threads (&gv->config);
@@ -882,6 +956,7 @@ static int setup_and_start_recv_threads (struct ddsi_domaingv *gv)
   gv->n_recv_threads = 1;
   gv->recv_threads[0].name = "recv";
   gv->recv_threads[0].arg.mode = DDSI_RTM_MANY;
+  gv->recv_threads[0].arg.u.many.conn = NULL;
   if (gv->m_factory->m_connless && gv->config.many_sockets_mode != DDSI_MSM_NO_UNICAST && multi_recv_thr)
   {
     bool allow_asm_mc = false;
@@ -898,7 +973,7 @@ static int setup_and_start_recv_threads (struct ddsi_domaingv *gv)
       ddsi_conn_disable_multiplexing (gv->data_conn_mc);
       gv->n_recv_threads++;
     }
-    if (gv->config.many_sockets_mode == DDSI_MSM_SINGLE_UNICAST)
+    if (gv->config.many_sockets_mode == DDSI_MSM_SINGLE_UNICAST && gv->n_data_conn_uc_shards == 0)
     {
       /* No per-participant sockets => handle data unicasts on a separate thread as well */
       gv->recv_threads[gv->n_recv_threads].name = "recvUC";
@@ -908,6 +983,21 @@ static int setup_and_start_recv_threads (struct ddsi_domaingv *gv)
       ddsi_conn_disable_multiplexing (gv->data_conn_uc);
       gv->n_recv_threads++;
     }
+    else if (gv->config.many_sockets_mode == DDSI_MSM_SINGLE_UNICAST)
+    {
+      /* Multiple sockets bound to the data port: a packet sent to the port for waking
+         up a thread may well end up with another one, so these use a waitset with
+         only their own socket in it */
+      for (uint32_t i = 0; i <= gv->n_data_conn_uc_shards; i++)
+      {
+        struct recv_thread * const rt = &gv->recv_threads[gv->n_recv_threads];
+        (void) snprintf (rt->namebuf, sizeof (rt->namebuf), "recvUC.%"PRIu32, i);
+        rt->name = rt->namebuf;
+        rt->arg.mode = DDSI_RTM_MANY;
+        rt->arg.u.many.conn = (i == 0) ? gv->data_conn_uc : gv->data_conn_uc_shards[i - 1];
+        gv->n_recv_threads++;
+      }
+    }
   }
   assert (gv->n_recv_threads <= MAX_RECV_THREADS);
 
@@ -924,7 +1014,17 @@ static int setup_and_start_recv_threads (struct ddsi_domaingv *gv)
     }
     if (gv->recv_threads[i].arg.mode == DDSI_RTM_MANY)
     {
-      if ((gv->recv_threads[i].arg.u.many.ws = ddsi_sock_waitset_new ()) == NULL)
+      gv->recv_threads[i].arg.u.many.ws = NULL;
+      if (gv->config.sock_waitset_impl == DDSI_SOCKWS_IO_URING)
+      {
+        /* UDP max packet size is 64kB, same as do_packet; the datagrams are copied out
+           of the buffers right away, so only a few are needed to absorb bursts */
+        const size_t maxdgram = gv->config.rmsg_chunk_size < 65536 ? gv->config.rmsg_chunk_size : 65536;
+        const uint32_t nbufs = 64;
+        if ((gv->recv_threads[i].arg.u.many.ws = ddsi_sock_waitset_new_io_uring (nbufs, maxdgram)) == NULL)
+          GVWARNING ("rtps_init: io_uring not available for thread %s, using default socket waitset\n", gv->recv_threads[i].name);
+      }
+      if (gv->recv_threads[i].arg.u.many.ws == NULL && (gv->recv_threads[i].arg.u.many.ws = ddsi_sock_waitset_new ()) == NULL)
       {
         GVERROR ("rtps_init: can't allocate sock waitset for thread %s\n", gv->recv_threads[i].name);
         goto fail;
@@ -1011,6 +1111,9 @@ static void free_conns (struct ddsi_domaingv *gv)
         cs[j] = NULL;
     ddsi_conn_free (cs[i]);
   }
+  for (uint32_t i = 0; i < gv->n_data_conn_uc_shards; i++)
+    ddsi_conn_free (gv->data_conn_uc_shards[i]);
+  gv->n_data_conn_uc_shards = 0;
 }
 
 static int create_vnet_interface_for_psmx (struct ddsi_domaingv *gv, const char *psmx_instance_name, const ddsi_locator_t locator, bool mc_capable)
@@ -1121,6 +1224,7 @@ int ddsi_init (struct ddsi_domaingv *gv, struct ddsi_psmx_instance_locators *psm
 
   gv->disc_conn_uc = NULL;
   gv->data_conn_uc = NULL;
+  gv->n_data_conn_uc_shards = 0;
   gv->disc_conn_mc = NULL;
   gv->data_conn_mc = NULL;
   for (size_t i = 0; i < MAX_XMIT_CONNS; i++)
@@ -1561,7 +1665,8 @@ int ddsi_init (struct ddsi_domaingv *gv, struct ddsi_psmx_instance_locators *psm
       const struct ddsi_tran_qos qos = {
         .m_purpose = (gv->interfaces[i].allow_multicast ? DDSI_TRAN_QOS_XMIT_MC : DDSI_TRAN_QOS_XMIT_UC),
         .m_diffserv = 0,
-        .m_interface = &gv->interfaces[i]
+        .m_interface = &gv->interfaces[i],
+        .m_zerocopy = (gv->config.zerocopy_send_threshold > 0)
       };
       // FIXME: looking up the factory here is a hack to support PSMX in addition to (e.g.) UDP
       struct ddsi_tran_factory * fact = ddsi_factory_find_supported_kind (gv, gv->interfaces[i].loc.kind);
@@ -1589,6 +1694,14 @@ int ddsi_init (struct ddsi_domaingv *gv, struct ddsi_psmx_instance_locators *psm
 
   /* Create event queues */
   gv->xevents = ddsi_xeventq_new (gv, gv->config.max_queued_rexmit_bytes, gv->config.max_queued_rexmit_msgs);
+  gv->n_xevent_shards = (uint32_t) gv->config.xeventq_shards;
+  gv->xevent_shards = NULL;
+  if (gv->n_xevent_shards > 0)
+  {
+    gv->xevent_shards = ddsrt_malloc (gv->n_xevent_shards * sizeof (*gv->xevent_shards));
+    for (uint32_t i = 0; i < gv->n_xevent_shards; i++)
+      gv->xevent_shards[i] = ddsi_xeventq_new (gv, gv->config.max_queued_rexmit_bytes, gv->config.max_queued_rexmit_msgs);
+  }
 
 #ifdef DDS_HAS_SECURITY
   ddsi_omg_security_init (gv);
@@ -1606,6 +1719,12 @@ int ddsi_init (struct ddsi_domaingv *gv, struct ddsi_psmx_instance_locators *psm
   gv->sendq_running = false;
   ddsrt_mutex_init (&gv->sendq_running_lock);
 
+  ddsrt_atomic_st32 (&gv->zerocopy_pending, 0);
+  ddsrt_atomic_st32 (&gv->zerocopy_sent, 0);
+  ddsrt_atomic_st32 (&gv->zerocopy_copied, 0);
+  ddsrt_atomic_st64 (&gv->zerocopy_bytes_saved, 0);
+  ddsrt_atomic_st64 (&gv->zerocopy_bytes_copied, 0);
+
   gv->builtins_dqueue = ddsi_dqueue_new ("builtins", gv, gv->config.delivery_queue_maxsamples, ddsi_builtins_dqueue_handler, NULL);
   gv->user_dqueue = ddsi_dqueue_new ("user", gv, gv->config.delivery_queue_maxsamples, ddsi_user_dqueue_handler, NULL);
 
@@ -1700,6 +1819,27 @@ err_udp_tcp_init:
   return -1;
 }
 
+static void stop_xevent_shards (struct ddsi_domaingv *gv, uint32_t n)
+{
+  for (uint32_t i = 0; i < n; i++)
+    ddsi_xeventq_stop (gv->xevent_shards[i]);
+}
+
+static int start_xevent_shards (struct ddsi_domaingv *gv)
+{
+  for (uint32_t i = 0; i < gv->n_xevent_shards; i++)
+  {
+    char name[16];
+    (void) snprintf (name, sizeof (name), "%"PRIu32, i);
+    if (ddsi_xeventq_start (gv->xevent_shards[i], name) < 0)
+    {
+      stop_xevent_shards (gv, i);
+      return -1;
+    }
+  }
+  return 0;
+}
+
 int ddsi_start (struct ddsi_domaingv *gv)
 {
   ddsi_gcreq_queue_start (gv->gcreq_queue);
@@ -1709,9 +1849,15 @@ int ddsi_start (struct ddsi_domaingv *gv)
 
   if (ddsi_xeventq_start (gv->xevents, NULL) < 0)
     return -1;
+  if (start_xevent_shards (gv) < 0)
+  {
+    ddsi_xeventq_stop (gv->xevents);
+    return -1;
+  }
 
   if (gv->config.transport_selector != DDSI_TRANS_NONE && setup_and_start_recv_threads (gv) < 0)
   {
+    stop_xevent_shards (gv, gv->n_xevent_shards);
     ddsi_xeventq_stop (gv->xevents);
     return -1;
   }
@@ -1785,6 +1931,7 @@ void ddsi_stop (struct ddsi_domaingv *gv)
     ddsi_listener_free(gv->listener);
   }
 
+  stop_xevent_shards (gv, gv->n_xevent_shards);
   ddsi_xeventq_stop (gv->xevents);
 
   /* Send a bubble through the delivery queue for built-ins, so that any
@@ -1905,6 +2052,10 @@ void ddsi_fini (struct ddsi_domaingv *gv)
   ddsi_defrag_free (gv->spdp_defrag);
   ddsrt_mutex_destroy (&gv->spdp_lock);
 
+  /* Releasing instances from the per-thread caches of threads that terminate
+     from here on could require the GC, so they have to be left to the map */
+  ddsi_tkmap_close_caches (gv->m_tkmap);
+
   /* Shut down the GC system -- no new requests will be added */
   ddsi_gcreq_queue_free (gv->gcreq_queue);
 
@@ -1918,6 +2069,9 @@ void ddsi_fini (struct ddsi_domaingv *gv)
   ddsi_omg_security_deinit (gv->security_context);
 #endif
 
+  for (uint32_t i = 0; i < gv->n_xevent_shards; i++)
+    ddsi_xeventq_free (gv->xevent_shards[i]);
+  ddsrt_free (gv->xevent_shards);
   ddsi_xeventq_free (gv->xevents);
 
   // if sendq thread is started
@@ -1933,6 +2087,14 @@ void ddsi_fini (struct ddsi_domaingv *gv)
   for (int i = 0; i < gv->n_interfaces; i++)
     gv->intf_xlocators[i].conn = NULL;
   free_conns (gv);
+  if (gv->config.zerocopy_send_threshold > 0)
+  {
+    // all zero-copy writes have completed now that the connections are gone
+    struct ddsi_xpack_zerocopy_stats zcst;
+    ddsi_xpack_zerocopy_stats (gv, &zcst);
+    GVLOG (DDS_LC_INFO, "zero-copy writes: %"PRIu32" packets %"PRIu64" bytes not copied, %"PRIu32" packets %"PRIu64" bytes copied anyway\n",
+           zcst.sent, zcst.bytes_saved, zcst.copied, zcst.bytes_copied);
+  }
   ddsi_free_mcgroup_membership(gv->mship);
   ddsi_tran_factories_fini (gv);
 
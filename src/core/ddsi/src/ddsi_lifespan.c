@@ -54,6 +54,11 @@ ddsrt_mtime_t ddsi_lifespan_next_expired_locked (const struct ddsi_lifespan_adm
   return (node != NULL) ? node->t_expire : DDSRT_MTIME_NEVER;
 }
 
+bool ddsi_lifespan_empty_locked (const struct ddsi_lifespan_adm *lifespan_adm)
+{
+  return ddsrt_fibheap_min (&lifespan_fhdef, &lifespan_adm->ls_exp_heap) == NULL;
+}
+
 void ddsi_lifespan_init (const struct ddsi_domaingv *gv, struct ddsi_lifespan_adm *lifespan_adm, size_t fh_offset, size_t fh_node_offset, ddsi_sample_expired_cb_t sample_expired_cb)
 {
   ddsrt_fibheap_init (&lifespan_fhdef, &lifespan_adm->ls_exp_heap);
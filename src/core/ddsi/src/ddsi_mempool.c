@@ -0,0 +1,390 @@
+// Copyright(c) 2025 ZettaScale Technology and others
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License v. 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Eclipse Distribution License
+// v. 1.0 which is available at
+// http://www.eclipse.org/org/documents/edl-v10.php.
+//
+// SPDX-License-Identifier: EPL-2.0 OR BSD-3-Clause
+
+#include <assert.h>
+#include <string.h>
+
+#include "dds/ddsrt/heap.h"
+#include "dds/ddsrt/sync.h"
+#include "dds/ddsrt/threads.h"
+#include "dds/ddsi/ddsi_iid.h"
+#include "dds/ddsi/ddsi_mempool.h"
+#include "ddsi__mempool.h"
+
+#define MAGAZINE_SIZE 32
+#define MAX_CLASSES 24
+
+/* Number of pools for which a thread remembers its per-thread state, beyond
+   that it needs to search the pool's list of threads.  A thread typically
+   uses the serdata pool and the message pool of a single domain. */
+#define TSD_SLOTS 4
+
+struct magazine {
+  struct magazine *next;
+  uint32_t n;
+  void *objs[MAGAZINE_SIZE];
+};
+
+struct depot {
+  ddsrt_mutex_t lock;
+  struct magazine *full;
+  struct magazine *empty;
+  uint32_t nfull;
+  uint32_t maxfull;
+};
+
+struct mempool_thread {
+  struct mempool_thread *next;
+  ddsrt_thread_t owner;
+  struct ddsi_mempool_stats stats;
+  struct magazine *mags[MAX_CLASSES];
+};
+
+struct ddsi_mempool {
+  struct ddsi_mempool *next; /* protected by pools_lock */
+  uint64_t id;
+  uint32_t min_shift;
+  uint32_t nclasses;
+  void (*free) (void *obj);
+  struct depot depots[MAX_CLASSES];
+  ddsrt_mutex_t threads_lock;
+  struct mempool_thread *threads;
+  struct ddsi_mempool_stats retired; /* of threads that terminated, protected by threads_lock */
+};
+
+struct mempool_tsd {
+  uint64_t pool_id;
+  struct mempool_thread *thr;
+};
+
+static ddsrt_thread_local struct mempool_tsd tsd_mempool[TSD_SLOTS];
+static ddsrt_thread_local uint32_t tsd_mempool_next;
+
+/* All existing pools, so that a terminating thread can find its per-thread state
+   in each of them.  Lock order: pools_lock, threads_lock, depot lock. */
+static ddsrt_once_t pools_once = DDSRT_ONCE_INIT;
+static ddsrt_mutex_t pools_lock;
+static struct ddsi_mempool *pools;
+
+static void pools_init (void)
+{
+  ddsrt_mutex_init (&pools_lock);
+}
+
+static uint32_t log2_ceil (uint32_t x)
+{
+  uint32_t n = 0;
+  while (n < 31 && (UINT32_C (1) << n) < x)
+    n++;
+  return n;
+}
+
+struct ddsi_mempool *ddsi_mempool_new (uint32_t min_size, uint32_t max_size, uint32_t max_objs, size_t max_bytes, void (*free) (void *obj))
+{
+  struct ddsi_mempool *pool = ddsrt_malloc (sizeof (*pool));
+  assert (min_size > 0 && min_size <= max_size);
+  // 0 marks an unused slot in the thread-local pointers to the per-thread state
+  do {
+    pool->id = ddsi_iid_gen ();
+  } while (pool->id == 0);
+  pool->min_shift = log2_ceil (min_size);
+  pool->nclasses = log2_ceil (max_size) - pool->min_shift + 1;
+  if (pool->nclasses > MAX_CLASSES)
+    pool->nclasses = MAX_CLASSES;
+  pool->free = free;
+  for (uint32_t c = 0; c < pool->nclasses; c++)
+  {
+    struct depot * const dp = &pool->depots[c];
+    const size_t class_size = (size_t) 1 << (pool->min_shift + c);
+    size_t maxobjs = max_bytes / class_size;
+    if (maxobjs > max_objs)
+      maxobjs = max_objs;
+    ddsrt_mutex_init (&dp->lock);
+    dp->full = dp->empty = NULL;
+    dp->nfull = 0;
+    dp->maxfull = (uint32_t) (maxobjs / MAGAZINE_SIZE);
+    if (dp->maxfull < 2)
+      dp->maxfull = 2;
+  }
+  ddsrt_mutex_init (&pool->threads_lock);
+  pool->threads = NULL;
+  memset (&pool->retired, 0, sizeof (pool->retired));
+
+  ddsrt_once (&pools_once, pools_init);
+  ddsrt_mutex_lock (&pools_lock);
+  pool->next = pools;
+  pools = pool;
+  ddsrt_mutex_unlock (&pools_lock);
+  return pool;
+}
+
+static void free_magazine (struct magazine *m, void (*free) (void *obj))
+{
+  for (uint32_t i = 0; i < m->n; i++)
+    free (m->objs[i]);
+  ddsrt_free (m);
+}
+
+static void free_magazine_list (struct magazine *m, void (*free) (void *obj))
+{
+  while (m)
+  {
+    struct magazine *next = m->next;
+    free_magazine (m, free);
+    m = next;
+  }
+}
+
+void ddsi_mempool_free (struct ddsi_mempool *pool)
+{
+  struct ddsi_mempool **ppool;
+  ddsrt_mutex_lock (&pools_lock);
+  for (ppool = &pools; *ppool != pool; ppool = &(*ppool)->next)
+    assert (*ppool != NULL);
+  *ppool = pool->next;
+  ddsrt_mutex_unlock (&pools_lock);
+
+  void (* const free) (void *obj) = pool->free;
+  struct mempool_thread *thr;
+  while ((thr = pool->threads) != NULL)
+  {
+    pool->threads = thr->next;
+    for (uint32_t c = 0; c < pool->nclasses; c++)
+      if (thr->mags[c])
+        free_magazine (thr->mags[c], free);
+    ddsrt_free (thr);
+  }
+  ddsrt_mutex_destroy (&pool->threads_lock);
+  for (uint32_t c = 0; c < pool->nclasses; c++)
+  {
+    struct depot * const dp = &pool->depots[c];
+    free_magazine_list (dp->full, free);
+    free_magazine_list (dp->empty, free);
+    ddsrt_mutex_destroy (&dp->lock);
+  }
+  ddsrt_free (pool);
+}
+
+static struct mempool_thread *mempool_thread_slow (struct ddsi_mempool *pool)
+{
+  const ddsrt_thread_t self = ddsrt_thread_self ();
+  struct mempool_thread *thr;
+  ddsrt_mutex_lock (&pool->threads_lock);
+  for (thr = pool->threads; thr; thr = thr->next)
+    if (ddsrt_thread_equal (thr->owner, self))
+      break;
+  if (thr == NULL)
+  {
+    /* A thread that terminates without calling ddsi_mempool_thread_fini leaves
+       its magazines behind, they get picked up by a new thread with the same id
+       or else freed with the pool */
+    thr = ddsrt_malloc (sizeof (*thr));
+    thr->owner = self;
+    memset (&thr->stats, 0, sizeof (thr->stats));
+    memset (thr->mags, 0, sizeof (thr->mags));
+    thr->next = pool->threads;
+    pool->threads = thr;
+  }
+  ddsrt_mutex_unlock (&pool->threads_lock);
+
+  struct mempool_tsd * const slot = &tsd_mempool[tsd_mempool_next];
+  tsd_mempool_next = (tsd_mempool_next + 1) % TSD_SLOTS;
+  slot->pool_id = pool->id;
+  slot->thr = thr;
+  return thr;
+}
+
+static struct mempool_thread *mempool_thread (struct ddsi_mempool *pool)
+{
+  for (uint32_t i = 0; i < TSD_SLOTS; i++)
+    if (tsd_mempool[i].pool_id == pool->id)
+      return tsd_mempool[i].thr;
+  return mempool_thread_slow (pool);
+}
+
+static struct magazine *new_magazine (void)
+{
+  struct magazine *m = ddsrt_malloc (sizeof (*m));
+  m->next = NULL;
+  m->n = 0;
+  return m;
+}
+
+static struct magazine *thread_magazine (struct mempool_thread *thr, uint32_t c)
+{
+  if (thr->mags[c] == NULL)
+    thr->mags[c] = new_magazine ();
+  return thr->mags[c];
+}
+
+// smallest class of at least size, "nclasses" if there is no such class
+static uint32_t size_class (const struct ddsi_mempool *pool, uint32_t size)
+{
+  const uint32_t shift = log2_ceil (size);
+  const uint32_t c = (shift <= pool->min_shift) ? 0 : shift - pool->min_shift;
+  return (c >= pool->nclasses || size > (UINT32_C (1) << 31)) ? pool->nclasses : c;
+}
+
+uint32_t ddsi_mempool_class_size (const struct ddsi_mempool *pool, uint32_t size)
+{
+  const uint32_t c = size_class (pool, size);
+  return (c == pool->nclasses) ? size : UINT32_C (1) << (pool->min_shift + c);
+}
+
+void *ddsi_mempool_get (struct ddsi_mempool *pool, uint32_t *size)
+{
+  struct mempool_thread * const thr = mempool_thread (pool);
+  const uint32_t c = size_class (pool, *size);
+  thr->stats.gets++;
+  if (c == pool->nclasses)
+    return NULL;
+  *size = UINT32_C (1) << (pool->min_shift + c);
+
+  struct magazine *m = thread_magazine (thr, c);
+  if (m->n == 0)
+  {
+    struct depot * const dp = &pool->depots[c];
+    ddsrt_mutex_lock (&dp->lock);
+    if (dp->full)
+    {
+      struct magazine * const full = dp->full;
+      dp->full = full->next;
+      dp->nfull--;
+      m->next = dp->empty;
+      dp->empty = m;
+      thr->mags[c] = m = full;
+      thr->stats.exchanges++;
+    }
+    ddsrt_mutex_unlock (&dp->lock);
+    if (m->n == 0)
+      return NULL;
+  }
+  thr->stats.hits++;
+  return m->objs[--m->n];
+}
+
+bool ddsi_mempool_put (struct ddsi_mempool *pool, void *obj, uint32_t size)
+{
+  struct mempool_thread * const thr = mempool_thread (pool);
+  const uint32_t shift = log2_ceil (size);
+  // largest class not exceeding size, "nclasses" if there is no such class
+  uint32_t c = (shift < pool->min_shift) ? pool->nclasses : shift - pool->min_shift;
+  if (c < pool->nclasses && size < (UINT32_C (1) << shift))
+    c = (c == 0) ? pool->nclasses : c - 1;
+  if (c >= pool->nclasses)
+  {
+    thr->stats.rejects++;
+    return false;
+  }
+
+  struct magazine *m = thread_magazine (thr, c);
+  if (m->n == MAGAZINE_SIZE)
+  {
+    struct depot * const dp = &pool->depots[c];
+    struct magazine *empty = NULL;
+    bool exchanged = false;
+    ddsrt_mutex_lock (&dp->lock);
+    if (dp->nfull < dp->maxfull)
+    {
+      m->next = dp->full;
+      dp->full = m;
+      dp->nfull++;
+      if ((empty = dp->empty) != NULL)
+        dp->empty = empty->next;
+      exchanged = true;
+    }
+    ddsrt_mutex_unlock (&dp->lock);
+    if (!exchanged)
+    {
+      /* depot is full, the magazine is still ours */
+      thr->stats.rejects++;
+      return false;
+    }
+    thr->stats.exchanges++;
+    thr->mags[c] = m = (empty != NULL) ? empty : new_magazine ();
+    assert (m->n == 0);
+  }
+  thr->stats.puts++;
+  m->objs[m->n++] = obj;
+  return true;
+}
+
+static void add_stats (struct ddsi_mempool_stats *stats, const struct ddsi_mempool_stats *x)
+{
+  stats->gets += x->gets;
+  stats->hits += x->hits;
+  stats->puts += x->puts;
+  stats->rejects += x->rejects;
+  stats->exchanges += x->exchanges;
+}
+
+void ddsi_mempool_get_stats (struct ddsi_mempool *pool, struct ddsi_mempool_stats *stats)
+{
+  ddsrt_mutex_lock (&pool->threads_lock);
+  *stats = pool->retired;
+  for (const struct mempool_thread *thr = pool->threads; thr; thr = thr->next)
+    add_stats (stats, &thr->stats);
+  ddsrt_mutex_unlock (&pool->threads_lock);
+}
+
+static void retire_magazine (struct ddsi_mempool *pool, uint32_t c, struct magazine *m)
+{
+  /* A partially filled magazine can go on the list of full ones just the same,
+     the limit on the number of magazines in the depot then still bounds the
+     memory it holds on to */
+  if (m->n > 0)
+  {
+    struct depot * const dp = &pool->depots[c];
+    bool accepted = false;
+    ddsrt_mutex_lock (&dp->lock);
+    if (dp->nfull < dp->maxfull)
+    {
+      m->next = dp->full;
+      dp->full = m;
+      dp->nfull++;
+      accepted = true;
+    }
+    ddsrt_mutex_unlock (&dp->lock);
+    if (accepted)
+      return;
+  }
+  free_magazine (m, pool->free);
+}
+
+void ddsi_mempool_thread_fini (void)
+{
+  const ddsrt_thread_t self = ddsrt_thread_self ();
+  memset (tsd_mempool, 0, sizeof (tsd_mempool));
+  tsd_mempool_next = 0;
+
+  ddsrt_once (&pools_once, pools_init);
+  ddsrt_mutex_lock (&pools_lock);
+  for (struct ddsi_mempool *pool = pools; pool; pool = pool->next)
+  {
+    struct mempool_thread *thr, **pthr;
+    ddsrt_mutex_lock (&pool->threads_lock);
+    for (pthr = &pool->threads; (thr = *pthr) != NULL && !ddsrt_thread_equal (thr->owner, self); pthr = &thr->next)
+      ;
+    if (thr != NULL)
+    {
+      *pthr = thr->next;
+      add_stats (&pool->retired, &thr->stats);
+    }
+    ddsrt_mutex_unlock (&pool->threads_lock);
+    if (thr != NULL)
+    {
+      for (uint32_t c = 0; c < pool->nclasses; c++)
+        if (thr->mags[c])
+          retire_magazine (pool, c, thr->mags[c]);
+      ddsrt_free (thr);
+    }
+  }
+  ddsrt_mutex_unlock (&pools_lock);
+}
@@ -0,0 +1,134 @@
+// Copyright(c) 2025 ZettaScale Technology and others
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License v. 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Eclipse Distribution License
+// v. 1.0 which is available at
+// http://www.eclipse.org/org/documents/edl-v10.php.
+//
+// SPDX-License-Identifier: EPL-2.0 OR BSD-3-Clause
+
+#include <assert.h>
+
+#include "dds/ddsrt/time.h"
+#include "dds/ddsi/ddsi_domaingv.h"
+#include "ddsi__lat_estim.h"
+#include "ddsi__pacing.h"
+
+/* Round-trip estimates are clamped: below a millisecond the additive increase
+   would be much faster than the pacing granularity, and an ACKNACK arriving
+   more than a second after the heartbeat says more about the reader than
+   about the network */
+#define PACING_MIN_RTT DDS_MSECS (1)
+#define PACING_MAX_RTT DDS_SECS (1)
+#define PACING_DEFAULT_RTT DDS_MSECS (10)
+
+/* The bucket holds at most BURST worth of data at the current rate (but at
+   least one message), and retransmits can put it at most MAX_DEBT into debt */
+#define PACING_BURST DDS_MSECS (10)
+#define PACING_MAX_DEBT DDS_SECS (1)
+
+void ddsi_pacing_init (struct ddsi_pacing *p, const struct ddsi_domaingv *gv, bool enabled)
+{
+  p->enabled = enabled;
+  p->rate = enabled ? gv->config.cc_initial_rate : 0;
+  p->tokens = 0;
+  p->t_refill.v = 0;
+  p->t_rate_upd.v = 0;
+  p->t_decrease.v = 0;
+  ddsi_lat_estim_init (&p->rtt);
+  p->decrease_count = 0;
+  p->time_paced = 0;
+  p->waiters = 0;
+}
+
+void ddsi_pacing_fini (struct ddsi_pacing *p)
+{
+  ddsi_lat_estim_fini (&p->rtt);
+}
+
+static int64_t bucket_size (const struct ddsi_pacing *p, const struct ddsi_domaingv *gv)
+{
+  const int64_t sz = (int64_t) (p->rate * (uint64_t) PACING_BURST / DDS_NSECS_IN_SEC);
+  return (sz > (int64_t) gv->config.max_msg_size) ? sz : (int64_t) gv->config.max_msg_size;
+}
+
+static void refill (struct ddsi_pacing *p, const struct ddsi_domaingv *gv, ddsrt_mtime_t tnow)
+{
+  const int64_t maxtokens = bucket_size (p, gv);
+  if (p->t_refill.v == 0)
+  {
+    p->tokens = maxtokens;
+    p->t_refill = tnow;
+  }
+  else if (tnow.v > p->t_refill.v)
+  {
+    /* capping the interval avoids overflow; the bucket is full long before */
+    const int64_t dt = (tnow.v - p->t_refill.v < DDS_SECS (1)) ? tnow.v - p->t_refill.v : DDS_SECS (1);
+    const int64_t add = (int64_t) (p->rate * (uint64_t) dt / DDS_NSECS_IN_SEC);
+    if (add > 0)
+    {
+      p->tokens = (p->tokens + add < maxtokens) ? p->tokens + add : maxtokens;
+      p->t_refill = tnow;
+    }
+  }
+}
+
+int64_t ddsi_pacing_delay (struct ddsi_pacing *p, const struct ddsi_domaingv *gv, ddsrt_mtime_t tnow)
+{
+  assert (p->enabled && p->rate > 0);
+  refill (p, gv, tnow);
+  if (p->tokens >= 0)
+    return 0;
+  return 1 + (int64_t) ((uint64_t) -p->tokens * DDS_NSECS_IN_SEC / p->rate);
+}
+
+void ddsi_pacing_consume (struct ddsi_pacing *p, uint32_t size)
+{
+  const int64_t maxdebt = (int64_t) (p->rate * (uint64_t) PACING_MAX_DEBT / DDS_NSECS_IN_SEC);
+  p->tokens -= (int64_t) size;
+  if (p->tokens < -maxdebt)
+    p->tokens = -maxdebt;
+}
+
+static int64_t current_rtt (const struct ddsi_pacing *p)
+{
+  const double rtt_us = ddsi_lat_estim_current (&p->rtt);
+  const int64_t rtt = (rtt_us > 0) ? (int64_t) (rtt_us * 1e3) : PACING_DEFAULT_RTT;
+  if (rtt < PACING_MIN_RTT)
+    return PACING_MIN_RTT;
+  else if (rtt > PACING_MAX_RTT)
+    return PACING_MAX_RTT;
+  else
+    return rtt;
+}
+
+void ddsi_pacing_note_acknack (struct ddsi_pacing *p, const struct ddsi_domaingv *gv, ddsrt_mtime_t tnow, ddsrt_mtime_t t_ackhb, bool progress, bool loss)
+{
+  assert (p->enabled);
+  if (t_ackhb.v != 0 && tnow.v > t_ackhb.v && tnow.v - t_ackhb.v < PACING_MAX_RTT)
+    ddsi_lat_estim_update (&p->rtt, tnow.v - t_ackhb.v);
+
+  const int64_t rtt = current_rtt (p);
+  if (loss)
+  {
+    /* All NACKs caused by a single burst of losses arrive within about one
+       round-trip, so those after the first shouldn't reduce the rate again */
+    if (tnow.v - p->t_decrease.v >= rtt)
+    {
+      p->rate -= p->rate / 4;
+      if (p->rate < gv->config.cc_min_rate)
+        p->rate = gv->config.cc_min_rate;
+      p->decrease_count++;
+      p->t_decrease = tnow;
+      p->t_rate_upd = tnow;
+    }
+  }
+  else if (progress && tnow.v - p->t_rate_upd.v >= rtt)
+  {
+    p->rate += gv->config.cc_min_rate;
+    if (p->rate > gv->config.cc_max_rate)
+      p->rate = gv->config.cc_max_rate;
+    p->t_rate_upd = tnow;
+  }
+}
@@ -27,6 +27,7 @@
 #include "ddsi__endpoint.h"
 #include "ddsi__gc.h"
 #include "ddsi__plist.h"
+#include "ddsi__content_filter.h"
 #include "ddsi__proxy_endpoint.h"
 #include "ddsi__proxy_participant.h"
 #include "ddsi__typelib.h"
@@ -229,7 +230,8 @@ void ddsi_send_entityid_to_prd (struct ddsi_proxy_reader *prd, const ddsi_guid_t
     struct ddsi_xmsg *msg = ddsi_xmsg_new (gv->xmsgpool, guid, NULL, sizeof (ddsi_rtps_entityid_t), DDSI_XMSG_KIND_CONTROL);
     ddsi_xmsg_setdst_prd (msg, prd);
     ddsi_xmsg_add_entityid (msg);
-    ddsi_qxev_msg (gv->xevents, msg);
+    // same queue as the messages of the local writer that follow it
+    ddsi_qxev_msg (ddsi_xeventq_for_guid (gv, guid), msg);
   }
 }
 
@@ -243,7 +245,8 @@ void ddsi_send_entityid_to_pwr (struct ddsi_proxy_writer *pwr, const ddsi_guid_t
     struct ddsi_xmsg *msg = ddsi_xmsg_new (gv->xmsgpool, guid, NULL, sizeof (ddsi_rtps_entityid_t), DDSI_XMSG_KIND_CONTROL);
     ddsi_xmsg_setdst_pwr (msg, pwr);
     ddsi_xmsg_add_entityid (msg);
-    ddsi_qxev_msg (gv->xevents, msg);
+    // same queue as the acknacks that follow it
+    ddsi_qxev_msg (pwr->evq, msg);
   }
 }
 
@@ -644,6 +647,7 @@ int ddsi_new_proxy_reader (struct ddsi_proxy_reader **proxy_reader, struct ddsi_
   prd->is_fict_trans_reader = 0;
   prd->receive_buffer_size = proxypp->receive_buffer_size;
   prd->requests_keyhash = (plist->present & PP_CYCLONE_REQUESTS_KEYHASH) && plist->cyclone_requests_keyhash;
+  prd->accepts_fec = (plist->present & PP_CYCLONE_ACCEPTS_FEC) && plist->cyclone_accepts_fec;
   if (plist->present & PP_CYCLONE_REDUNDANT_NETWORKING)
     prd->redundant_networking = (plist->cyclone_redundant_networking != 0);
   else
@@ -651,13 +655,18 @@ int ddsi_new_proxy_reader (struct ddsi_proxy_reader **proxy_reader, struct ddsi_
 
   ddsrt_avl_init (&ddsi_prd_writers_treedef, &prd->writers);
 
+  if (plist->present & PP_CONTENT_FILTER_PROPERTY)
+    prd->content_filter = ddsi_content_filter_property_dup (&plist->content_filter_property);
+  else
+    prd->content_filter = NULL;
+
 #ifdef DDS_HAS_SECURITY
   if (prd->e.guid.entityid.u == DDSI_ENTITYID_P2P_BUILTIN_PARTICIPANT_VOLATILE_SECURE_READER)
     prd->filter = ddsi_volatile_secure_data_filter;
   else
-    prd->filter = NULL;
+    prd->filter = prd->content_filter ? ddsi_content_filter_prd_filter : NULL;
 #else
-  prd->filter = NULL;
+  prd->filter = prd->content_filter ? ddsi_content_filter_prd_filter : NULL;
 #endif
 
   /* locking the entity prevents matching while the built-in topic hasn't been published yet */
@@ -802,6 +811,7 @@ static void gc_delete_proxy_reader (struct ddsi_gcreq *gcreq)
 #ifdef DDS_HAS_SECURITY
   ddsi_omg_security_deregister_remote_reader (prd);
 #endif
+  ddsi_content_filter_property_free (prd->content_filter);
   proxy_endpoint_common_fini (&prd->e, &prd->c);
   ddsrt_free (prd);
 }
@@ -413,6 +413,12 @@ struct ddsi_rbuf {
      approach.  Changes would be confined rmsg_new and rmsg_free. */
   unsigned char *freeptr;
 
+  /* End of the space reserved for a batch of rmsgs (see rmsg_new_batch),
+     or NULL if no batch is outstanding.  Allocations never start below
+     it, so that growing or decoding one message in the batch doesn't
+     overwrite the ones following it. */
+  unsigned char *reserved_end;
+
   /* to ensure reasonable alignment of raw[] */
   union {
     int64_t l;
@@ -440,6 +446,7 @@ static struct ddsi_rbuf *ddsi_rbuf_alloc_new (struct ddsi_rbufpool *rbp)
   rb->size = rbp->rbuf_size;
   rb->max_rmsg_size = rbp->max_rmsg_size;
   rb->freeptr = rb->raw;
+  rb->reserved_end = NULL;
   rb->trace = rbp->trace;
   RBPTRACE ("rbuf_alloc_new(%p) = %p\n", (void *) rbp, (void *) rb);
   return rb;
@@ -488,33 +495,42 @@ static void ddsi_rbuf_release (struct ddsi_rbuf *rbuf)
 #define ASSERT_RMSG_UNCOMMITTED(rmsg) ((void) 0)
 #endif
 
+static unsigned char *ddsi_rbuf_allocptr (const struct ddsi_rbuf *rb)
+{
+  assert (rb->freeptr >= rb->raw);
+  assert (rb->freeptr <= rb->raw + rb->size);
+  assert (rb->reserved_end == NULL || (rb->reserved_end >= rb->raw && rb->reserved_end <= rb->raw + rb->size));
+  return (rb->reserved_end && rb->reserved_end > rb->freeptr) ? rb->reserved_end : rb->freeptr;
+}
+
 static void *ddsi_rbuf_alloc (struct ddsi_rbufpool *rbp)
 {
   /* Note: only one thread calls ddsi_rmsg_new on a pool */
   uint32_t asize = max_rmsg_size_w_hdr (rbp->max_rmsg_size);
   struct ddsi_rbuf *rb;
+  unsigned char *ptr;
   RBPTRACE ("rmsg_rbuf_alloc(%p, %"PRIu32")\n", (void *) rbp, asize);
   ASSERT_RBUFPOOL_OWNER (rbp);
   rb = rbp->current;
   assert (rb != NULL);
-  assert (rb->freeptr >= rb->raw);
-  assert (rb->freeptr <= rb->raw + rb->size);
+  ptr = ddsi_rbuf_allocptr (rb);
 
-  if ((uint32_t) (rb->raw + rb->size - rb->freeptr) < asize)
+  if ((uint32_t) (rb->raw + rb->size - ptr) < asize)
   {
     /* not enough space left for new rmsg */
     if ((rb = ddsi_rbuf_new (rbp)) == NULL)
       return NULL;
 
     /* a new one should have plenty of space */
-    assert ((uint32_t) (rb->raw + rb->size - rb->freeptr) >= asize);
+    ptr = ddsi_rbuf_allocptr (rb);
+    assert ((uint32_t) (rb->raw + rb->size - ptr) >= asize);
   }
 
-  RBPTRACE ("rmsg_rbuf_alloc(%p, %"PRIu32") = %p\n", (void *) rbp, asize, (void *) rb->freeptr);
+  RBPTRACE ("rmsg_rbuf_alloc(%p, %"PRIu32") = %p\n", (void *) rbp, asize, (void *) ptr);
 #if USE_VALGRIND
-  VALGRIND_MEMPOOL_ALLOC (rbp, rb->freeptr, asize);
+  VALGRIND_MEMPOOL_ALLOC (rbp, ptr, asize);
 #endif
-  return rb->freeptr;
+  return ptr;
 }
 
 static void init_rmsg_chunk (struct ddsi_rmsg_chunk *chunk, struct ddsi_rbuf *rbuf)
@@ -525,6 +541,16 @@ static void init_rmsg_chunk (struct ddsi_rmsg_chunk *chunk, struct ddsi_rbuf *rb
   ddsrt_atomic_inc32 (&rbuf->n_live_rmsg_chunks);
 }
 
+static void init_rmsg (struct ddsi_rmsg *rmsg, struct ddsi_rbufpool *rbp)
+{
+  /* Reference to this rmsg, undone by rmsg_commit(). */
+  ddsrt_atomic_st32 (&rmsg->refcount, RMSG_REFCOUNT_UNCOMMITTED_BIAS);
+  /* Initial chunk */
+  init_rmsg_chunk (&rmsg->chunk, rbp->current);
+  rmsg->trace = rbp->trace;
+  rmsg->lastchunk = &rmsg->chunk;
+}
+
 struct ddsi_rmsg *ddsi_rmsg_new (struct ddsi_rbufpool *rbp)
 {
   /* Note: only one thread calls ddsi_rmsg_new on a pool */
@@ -535,18 +561,73 @@ struct ddsi_rmsg *ddsi_rmsg_new (struct ddsi_rbufpool *rbp)
   if (rmsg == NULL)
     return NULL;
 
-  /* Reference to this rmsg, undone by rmsg_commit(). */
-  ddsrt_atomic_st32 (&rmsg->refcount, RMSG_REFCOUNT_UNCOMMITTED_BIAS);
-  /* Initial chunk */
-  init_rmsg_chunk (&rmsg->chunk, rbp->current);
-  rmsg->trace = rbp->trace;
-  rmsg->lastchunk = &rmsg->chunk;
+  init_rmsg (rmsg, rbp);
   /* Incrementing freeptr happens in commit(), so that discarding the
      message is really simple. */
   RBPTRACE ("rmsg_new(%p) = %p\n", (void *) rbp, (void *) rmsg);
   return rmsg;
 }
 
+uint32_t ddsi_rmsg_new_batch (struct ddsi_rbufpool *rbp, uint32_t n, struct ddsi_rmsg **rmsgs)
+{
+  /* Allocates up to n rmsgs from consecutive, maximum-sized slots in the
+     current rbuf, so that they can all be filled before any of them is
+     processed.  Only as many as fit in the current rbuf are allocated,
+     unless not even one fits, in which case a new rbuf is used.
+
+     The rmsgs must be committed in order, and the batch must be
+     terminated with rbufpool_end_batch() once all are committed.
+     Committing an rmsg that is still referenced moves freeptr to the
+     end of it; committing one that is no longer referenced frees it
+     without touching freeptr.  Consequently, at the end of the batch
+     freeptr is at the end of the last rmsg that is still in use (or
+     unchanged if none is) and the space following it is available
+     again, just like with rmsg_new().  Freed slots in between are
+     simply not reused, just like other rmsgs freed out of order. */
+  const uint32_t asize = max_rmsg_size_w_hdr (rbp->max_rmsg_size);
+  struct ddsi_rbuf *rb;
+  unsigned char *ptr;
+  uint32_t nfit;
+  RBPTRACE ("rmsg_new_batch(%p, %"PRIu32")\n", (void *) rbp, n);
+  ASSERT_RBUFPOOL_OWNER (rbp);
+  assert (n > 0);
+  rb = rbp->current;
+  assert (rb != NULL && rb->reserved_end == NULL);
+  ptr = ddsi_rbuf_allocptr (rb);
+  if ((nfit = (uint32_t) (rb->raw + rb->size - ptr) / asize) == 0)
+  {
+    if ((rb = ddsi_rbuf_new (rbp)) == NULL)
+      return 0;
+    ptr = ddsi_rbuf_allocptr (rb);
+    nfit = (uint32_t) (rb->raw + rb->size - ptr) / asize;
+    assert (nfit > 0);
+  }
+  if (n > nfit)
+    n = nfit;
+  for (uint32_t i = 0; i < n; i++)
+  {
+    rmsgs[i] = (struct ddsi_rmsg *) (ptr + i * asize);
+#if USE_VALGRIND
+    VALGRIND_MEMPOOL_ALLOC (rbp, rmsgs[i], asize);
+#endif
+    init_rmsg (rmsgs[i], rbp);
+  }
+  rb->reserved_end = ptr + n * asize;
+  RBPTRACE ("rmsg_new_batch(%p) = %"PRIu32" @ %p\n", (void *) rbp, n, (void *) ptr);
+  return n;
+}
+
+void ddsi_rbufpool_end_batch (struct ddsi_rbufpool *rbp)
+{
+  /* If the current rbuf got replaced during the batch, the remaining
+     rmsgs of the batch were still in the old one, and so it retains
+     its reservation.  That doesn't matter: it will never be used for
+     allocating again. */
+  RBPTRACE ("rbufpool_end_batch(%p)\n", (void *) rbp);
+  ASSERT_RBUFPOOL_OWNER (rbp);
+  rbp->current->reserved_end = NULL;
+}
+
 void ddsi_rmsg_setsize (struct ddsi_rmsg *rmsg, uint32_t size)
 {
   uint32_t size8P = align_rmsg (size);
@@ -596,8 +677,13 @@ void ddsi_rmsg_free (struct ddsi_rmsg *rmsg)
 static void commit_rmsg_chunk (struct ddsi_rmsg_chunk *chunk)
 {
   struct ddsi_rbuf *rbuf = chunk->rbuf;
+  unsigned char * const end = (unsigned char *) (chunk + 1) + chunk->u.size;
   RBUFTRACE ("commit_rmsg_chunk(%p)\n", (void *) chunk);
-  rbuf->freeptr = (unsigned char *) (chunk + 1) + chunk->u.size;
+  /* Never move it back: when rmsgs are allocated in batches (see
+     rmsg_new_batch), a later one in the batch may be committed after an
+     earlier one got extended with a chunk beyond the reserved space */
+  if (end > rbuf->freeptr)
+    rbuf->freeptr = end;
 }
 
 void ddsi_rmsg_commit (struct ddsi_rmsg *rmsg)
@@ -620,7 +706,7 @@ void ddsi_rmsg_commit (struct ddsi_rmsg *rmsg)
   assert (ddsrt_atomic_ld32 (&rmsg->refcount) >= RMSG_REFCOUNT_UNCOMMITTED_BIAS);
   assert (ddsrt_atomic_ld32 (&rmsg->chunk.rbuf->n_live_rmsg_chunks) > 0);
   assert (ddsrt_atomic_ld32 (&chunk->rbuf->n_live_rmsg_chunks) > 0);
-  assert (chunk->rbuf->rbufpool->current == chunk->rbuf);
+  assert (chunk->rbuf->rbufpool->current == chunk->rbuf || chunk->rbuf->reserved_end != NULL);
   if (ddsrt_atomic_sub32_nv (&rmsg->refcount, RMSG_REFCOUNT_UNCOMMITTED_BIAS) == 0)
     ddsi_rmsg_free (rmsg);
   else
@@ -858,6 +944,7 @@ struct ddsi_defrag {
   uint32_t max_samples;
   enum ddsi_defrag_drop_mode drop_mode;
   uint64_t discarded_bytes;
+  uint64_t recovered_bytes;
   const struct ddsrt_log_cfg *logcfg;
   bool trace;
 };
@@ -894,14 +981,16 @@ struct ddsi_defrag *ddsi_defrag_new (const struct ddsrt_log_cfg *logcfg, enum dd
   d->n_samples = 0;
   d->max_sample = NULL;
   d->discarded_bytes = 0;
+  d->recovered_bytes = 0;
   d->logcfg = logcfg;
   d->trace = (logcfg->c.mask & DDS_LC_RADMIN) != 0;
   return d;
 }
 
-void ddsi_defrag_stats (struct ddsi_defrag *defrag, uint64_t *discarded_bytes)
+void ddsi_defrag_stats (struct ddsi_defrag *defrag, uint64_t *discarded_bytes, uint64_t *recovered_bytes)
 {
   *discarded_bytes = defrag->discarded_bytes;
+  *recovered_bytes = defrag->recovered_bytes;
 }
 
 void ddsi_fragchain_adjust_refcount (struct ddsi_rdata *frag, int adjust)
@@ -1446,6 +1535,84 @@ void ddsi_defrag_notegap (struct ddsi_defrag *defrag, ddsi_seqno_t min, ddsi_seq
   defrag->max_sample = ddsrt_avl_find_max (&defrag_sampletree_treedef, &defrag->sampletree);
 }
 
+static void defrag_xor_range (const struct ddsi_defrag_iv *iv, uint32_t min, uint32_t maxp1, unsigned char *dst)
+{
+  /* [min,maxp1) is contained in iv, and the fragments in the chain cover
+     it without gaps but possibly with overlaps (see defrag_add_fragment):
+     each fragment starts at or before the end of all preceding ones */
+  uint32_t pos = min;
+  assert (iv->min <= min && maxp1 <= iv->maxp1);
+  for (const struct ddsi_rdata *d = iv->first; d != NULL && pos < maxp1; d = d->nextfrag)
+  {
+    if (d->maxp1 <= pos)
+      continue;
+    assert (d->min <= pos);
+    const uint32_t endp1 = (d->maxp1 < maxp1) ? d->maxp1 : maxp1;
+    const unsigned char *src = DDSI_RMSG_PAYLOADOFF (d->rmsg, DDSI_RDATA_PAYLOAD_OFF (d)) + (pos - d->min);
+    unsigned char *out = dst + (pos - min);
+    for (uint32_t i = 0; i < endp1 - pos; i++)
+      out[i] ^= src[i];
+    pos = endp1;
+  }
+  assert (pos >= maxp1);
+}
+
+bool ddsi_defrag_fec_recover (struct ddsi_defrag *defrag, ddsi_seqno_t seq, uint32_t size, uint32_t min, uint32_t unitsize, uint32_t nunits, unsigned char *parity, uint32_t paritysize, uint32_t *rmin, uint32_t *rmaxp1)
+{
+  struct ddsi_rsample *s;
+  if (defrag->max_sample && defrag->max_sample->u.defrag.seq == seq)
+    s = defrag->max_sample;
+  else if ((s = ddsrt_avl_lookup (&defrag_sampletree_treedef, &defrag->sampletree, &seq)) == NULL)
+  {
+    /* either complete already, or nothing received at all */
+    TRACE (defrag, "defrag_fec_recover(%p, seq %"PRIu64") sample not present\n", (void *) defrag, seq);
+    return false;
+  }
+  struct ddsi_rsample_defrag * const dfsample = &s->u.defrag;
+  if (dfsample->sampleinfo->size != size || min >= size || unitsize == 0)
+    return false;
+
+  const uint32_t grpmaxp1 = ((uint64_t) nunits * unitsize < size - min) ? min + nunits * unitsize : size;
+  uint32_t missing = UINT32_MAX;
+  for (uint32_t u = 0; u < nunits && (uint64_t) u * unitsize < grpmaxp1 - min; u++)
+  {
+    const uint32_t a = min + u * unitsize;
+    const uint32_t b = (grpmaxp1 - a < unitsize) ? grpmaxp1 : a + unitsize;
+    const struct ddsi_defrag_iv *iv = ddsrt_avl_lookup_pred_eq (&rsample_defrag_fragtree_treedef, &dfsample->fragtree, &a);
+    if (iv == NULL || iv->maxp1 < b)
+    {
+      if (missing != UINT32_MAX)
+      {
+        TRACE (defrag, "defrag_fec_recover(%p, seq %"PRIu64") [%"PRIu32"..%"PRIu32") multiple blocks missing\n", (void *) defrag, seq, min, grpmaxp1);
+        return false;
+      }
+      missing = u;
+    }
+  }
+  if (missing == UINT32_MAX)
+    return false;
+
+  *rmin = min + missing * unitsize;
+  *rmaxp1 = (grpmaxp1 - *rmin < unitsize) ? grpmaxp1 : *rmin + unitsize;
+  const uint32_t len = *rmaxp1 - *rmin;
+  if (len > paritysize)
+    return false;
+  for (uint32_t u = 0; u < nunits && (uint64_t) u * unitsize < grpmaxp1 - min; u++)
+  {
+    const uint32_t a = min + u * unitsize;
+    if (u == missing)
+      continue;
+    /* blocks in the group are never longer than the missing one, except when
+       the missing one is the last of the sample */
+    const uint32_t b = (grpmaxp1 - a < len) ? grpmaxp1 : a + len;
+    const struct ddsi_defrag_iv *iv = ddsrt_avl_lookup_pred_eq (&rsample_defrag_fragtree_treedef, &dfsample->fragtree, &a);
+    defrag_xor_range (iv, a, b, parity);
+  }
+  TRACE (defrag, "defrag_fec_recover(%p, seq %"PRIu64") recovered [%"PRIu32"..%"PRIu32")\n", (void *) defrag, seq, *rmin, *rmaxp1);
+  defrag->recovered_bytes += len;
+  return true;
+}
+
 enum ddsi_defrag_nackmap_result ddsi_defrag_nackmap (struct ddsi_defrag *defrag, ddsi_seqno_t seq, uint32_t maxfragnum, struct ddsi_fragment_number_set_header *map, uint32_t *mapbits, uint32_t maxsz)
 {
   struct ddsi_rsample *s;
@@ -389,6 +389,10 @@ static dds_return_t ddsi_raweth_create_conn (struct ddsi_tran_conn **conn_out, s
   uc->m_base.m_base.m_handle_fn = ddsi_raweth_conn_handle;
   uc->m_base.m_locator_fn = ddsi_raweth_conn_locator;
   uc->m_base.m_read_fn = ddsi_raweth_conn_read;
+  uc->m_base.m_read_batch_fn = 0;
+  uc->m_base.m_read_done_fn = 0;
+  uc->m_base.m_write_multi_fn = 0;
+  uc->m_base.m_write_zerocopy_fn = 0;
   uc->m_base.m_write_fn = ddsi_raweth_conn_write;
   uc->m_base.m_disable_multiplexing_fn = 0;
 
@@ -666,6 +670,10 @@ static dds_return_t ddsi_raweth_create_conn (struct ddsi_tran_conn **conn_out, s
   uc->m_base.m_base.m_handle_fn = ddsi_raweth_conn_handle;
   uc->m_base.m_locator_fn = ddsi_raweth_conn_locator;
   uc->m_base.m_read_fn = ddsi_raweth_conn_read;
+  uc->m_base.m_read_batch_fn = 0;
+  uc->m_base.m_read_done_fn = 0;
+  uc->m_base.m_write_multi_fn = 0;
+  uc->m_base.m_write_zerocopy_fn = 0;
   uc->m_base.m_write_fn = ddsi_raweth_conn_write;
   uc->m_base.m_disable_multiplexing_fn = 0;
   uc->buffer = ddsrt_malloc(buflen);
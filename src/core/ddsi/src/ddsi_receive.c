@@ -31,6 +31,7 @@
 #include "ddsi__misc.h"
 #include "ddsi__bswap.h"
 #include "ddsi__lat_estim.h"
+#include "ddsi__pacing.h"
 #include "ddsi__bitset.h"
 #include "ddsi__xevent.h"
 #include "ddsi__addrset.h"
@@ -560,6 +561,24 @@ static enum validation_result validate_DataFrag (const struct ddsi_receiver_stat
   return vr;
 }
 
+static enum validation_result validate_DataFragParity (const struct ddsi_receiver_state *rst, ddsi_rtps_datafrag_parity_t *msg, size_t size, int byteswap, struct ddsi_rsample_info *sampleinfo, const ddsi_keyhash_t **keyhashp, unsigned char **payloadp, uint32_t *payloadsz)
+{
+  /* A DataFrag describing the first block of the group, extended with the
+     number of blocks; only the payload differs */
+  enum validation_result vr;
+  if (size < sizeof (*msg))
+    return VR_MALFORMED;
+  if ((vr = validate_DataFrag (rst, &msg->frag, size, byteswap, sampleinfo, keyhashp, payloadp, payloadsz)) != VR_ACCEPT)
+    return vr;
+  if (offsetof (ddsi_rtps_data_datafrag_common_t, octetsToInlineQos) + sizeof (msg->frag.x.octetsToInlineQos) + msg->frag.x.octetsToInlineQos < sizeof (*msg))
+    return VR_MALFORMED;
+  if (byteswap)
+    msg->unitsInGroup = ddsrt_bswap2u (msg->unitsInGroup);
+  if (msg->unitsInGroup == 0)
+    return VR_MALFORMED;
+  return VR_ACCEPT;
+}
+
 int ddsi_add_gap (struct ddsi_xmsg *msg, struct ddsi_writer *wr, struct ddsi_proxy_reader *prd, ddsi_seqno_t start, ddsi_seqno_t base, uint32_t numbits, const uint32_t *bits)
 {
   struct ddsi_xmsg_marker sm_marker;
@@ -884,6 +903,16 @@ static int handle_AckNack (struct ddsi_receiver_state *rst, ddsrt_etime_t tnow,
     }
   }
 
+  /* Rate-based congestion control: acknowledging new data allows the rate
+     to grow, a request for a retransmit makes it shrink */
+  if (wr->pacing.enabled)
+  {
+    const uint64_t old_rate = wr->pacing.rate;
+    ddsi_pacing_note_acknack (&wr->pacing, rst->gv, ddsrt_time_monotonic (), wr->hbcontrol.t_of_last_ackhb, seqbase - 1 > rn->seq, !is_pure_ack && !is_preemptive_ack);
+    if (wr->pacing.rate != old_rate)
+      RSTTRACE (" rate %"PRIu64, wr->pacing.rate);
+  }
+
   /* First, the ACK part: if the AckNack advances the highest sequence
      number ack'd by the remote reader, update state & try dropping
      some messages */
@@ -1046,6 +1075,8 @@ static int handle_AckNack (struct ddsi_receiver_state *rst, ddsrt_etime_t tnow,
               if (sent > wr->e.gv->config.fragment_size)
                 sent = wr->e.gv->config.fragment_size;
               wr->rexmit_bytes += sent;
+              if (wr->pacing.enabled)
+                ddsi_pacing_consume (&wr->pacing, sent);
               limit = (sent > limit) ? 0 : limit - sent;
             }
           }
@@ -1077,6 +1108,8 @@ static int handle_AckNack (struct ddsi_receiver_state *rst, ddsrt_etime_t tnow,
               if (sent > wr->e.gv->config.fragment_size)
                 sent = wr->e.gv->config.fragment_size;
               wr->rexmit_bytes += sent;
+              if (wr->pacing.enabled)
+                ddsi_pacing_consume (&wr->pacing, sent);
               limit = (sent > limit) ? 0 : limit - sent;
             }
           }
@@ -1663,6 +1696,15 @@ static int handle_NackFrag (struct ddsi_receiver_state *rst, ddsrt_etime_t tnow,
   }
   RSTTRACE (" "PGUIDFMT" -> "PGUIDFMT"", PGUID (src), PGUID (dst));
 
+  /* A NackFrag always means fragments got lost */
+  if (wr->pacing.enabled)
+  {
+    const uint64_t old_rate = wr->pacing.rate;
+    ddsi_pacing_note_acknack (&wr->pacing, rst->gv, ddsrt_time_monotonic (), (ddsrt_mtime_t) { 0 }, false, true);
+    if (wr->pacing.rate != old_rate)
+      RSTTRACE (" rate %"PRIu64, wr->pacing.rate);
+  }
+
   /* Resend the requested fragments if we still have the sample, send
      a Gap if we don't have them anymore. */
   if (ddsi_whc_borrow_sample (wr->whc, seq, &sample))
@@ -1686,6 +1728,8 @@ static int handle_NackFrag (struct ddsi_receiver_state *rst, ddsrt_etime_t tnow,
           sent = true;
           nfrags_lim--;
           wr->rexmit_bytes += wr->e.gv->config.fragment_size;
+          if (wr->pacing.enabled)
+            ddsi_pacing_consume (&wr->pacing, wr->e.gv->config.fragment_size);
         }
       }
     }
@@ -2136,6 +2180,7 @@ unsigned char ddsi_normalize_data_datafrag_flags (const ddsi_rtps_submessage_hea
     case DDSI_RTPS_SMID_DATA:
       return smhdr->flags;
     case DDSI_RTPS_SMID_DATA_FRAG:
+    case DDSI_RTPS_SMID_CYCLONE_DATAFRAG_PARITY:
       {
         unsigned char common = smhdr->flags & DDSI_DATA_FLAG_INLINE_QOS;
         DDSRT_STATIC_ASSERT_CODE (DDSI_DATA_FLAG_INLINE_QOS == DDSI_DATAFRAG_FLAG_INLINE_QOS);
@@ -2786,6 +2831,75 @@ static int handle_DataFrag (struct ddsi_receiver_state *rst, ddsrt_etime_t tnow,
   return 1;
 }
 
+static int handle_DataFragParity (struct ddsi_receiver_state *rst, ddsrt_etime_t tnow, struct ddsi_rmsg *rmsg, const ddsi_rtps_datafrag_parity_t *msg, struct ddsi_rsample_info *sampleinfo, const ddsi_keyhash_t *keyhash, unsigned char *datap, uint32_t datasz, struct ddsi_dqueue **deferred_wakeup, ddsi_rtps_submessage_kind_t prev_smid)
+{
+  struct ddsi_proxy_writer * const pwr = sampleinfo->pwr;
+  const uint32_t unitsize = (uint32_t) msg->frag.fragmentSize * msg->frag.fragmentsInSubmessage;
+  const uint32_t min = (msg->frag.fragmentStartingNum - 1) * msg->frag.fragmentSize;
+  uint32_t begin, endp1;
+  bool recovered;
+
+  RSTTRACE ("DATAFRAG_PARITY("PGUIDFMT" -> "PGUIDFMT" #%"PRIu64"/[%"PRIu32"..%"PRIu32"]x%"PRIu16,
+            PGUIDPREFIX (rst->src_guid_prefix), msg->frag.x.writerId.u,
+            PGUIDPREFIX (rst->dst_guid_prefix), msg->frag.x.readerId.u,
+            ddsi_from_seqno (msg->frag.x.writerSN),
+            msg->frag.fragmentStartingNum, (ddsi_fragment_number_t) (msg->frag.fragmentStartingNum + msg->frag.fragmentsInSubmessage - 1),
+            msg->unitsInGroup);
+  if (!rst->forme)
+  {
+    RSTTRACE (" not-for-me)");
+    return 1;
+  }
+  if (pwr == NULL)
+  {
+    RSTTRACE (" unknown-writer)");
+    return 1;
+  }
+  if (!ddsi_security_validate_msg_decoding (&pwr->e, &pwr->c, pwr->c.proxypp, rst, prev_smid))
+  {
+    RSTTRACE (" clear submsg from protected src "PGUIDFMT")", PGUID (pwr->e.guid));
+    return 1;
+  }
+#ifdef DDS_HAS_SECURITY
+  if (pwr->c.security_info.security_attributes & DDSI_ENDPOINT_SECURITY_ATTRIBUTES_FLAG_IS_PAYLOAD_PROTECTED)
+  {
+    /* parity over an encrypted payload is of no use, the writer doesn't send it */
+    RSTTRACE (" payload-protected)");
+    return 1;
+  }
+#endif
+  if ((msg->frag.x.writerId.u & DDSI_ENTITYID_SOURCE_MASK) == DDSI_ENTITYID_SOURCE_BUILTIN || sampleinfo->size > rst->gv->config.max_sample_size)
+  {
+    RSTTRACE (" ignored)");
+    return 1;
+  }
+
+  /* Reconstructing the missing block happens in place, the rdata then refers
+     to the parity payload as if it were a DataFrag for that block */
+  ddsrt_mutex_lock (&pwr->e.lock);
+  recovered = ddsi_defrag_fec_recover (pwr->defrag, sampleinfo->seq, sampleinfo->size, min, unitsize, msg->unitsInGroup, datap, datasz, &begin, &endp1);
+  ddsrt_mutex_unlock (&pwr->e.lock);
+  if (!recovered)
+  {
+    RSTTRACE (" nothing-to-recover)");
+    return 1;
+  }
+  RSTTRACE ("/[%"PRIu32"..%"PRIu32") of %"PRIu32, begin, endp1, msg->frag.sampleSize);
+  if (begin == 0 && !set_sampleinfo_bswap (sampleinfo, (struct dds_cdr_header *) datap))
+  {
+    RSTTRACE (" invalid-encoding)");
+    return 1;
+  }
+
+  const unsigned submsg_offset = (unsigned) ((unsigned char *) msg - DDSI_RMSG_PAYLOAD (rmsg));
+  const unsigned payload_offset = (unsigned) (datap - DDSI_RMSG_PAYLOAD (rmsg));
+  const unsigned keyhash_offset = keyhash ? (unsigned) (keyhash->value - DDSI_RMSG_PAYLOAD (rmsg)) : 0;
+  struct ddsi_rdata *rdata = ddsi_rdata_new (rmsg, begin, endp1, submsg_offset, payload_offset, keyhash_offset);
+  handle_regular (rst, tnow, rmsg, &msg->frag.x, sampleinfo, (endp1 - 1) / msg->frag.fragmentSize, rdata, deferred_wakeup, true);
+  RSTTRACE (")");
+  return 1;
+}
+
 struct submsg_name {
   char x[32];
 };
@@ -2809,6 +2923,7 @@ static const char *submsg_name (ddsi_rtps_submessage_kind_t id, struct submsg_na
     case DDSI_RTPS_SMID_DATA: return "DATA";
     case DDSI_RTPS_SMID_ADLINK_MSG_LEN: return "ADLINK_MSG_LEN";
     case DDSI_RTPS_SMID_ADLINK_ENTITY_ID: return "ADLINK_ENTITY_ID";
+    case DDSI_RTPS_SMID_CYCLONE_DATAFRAG_PARITY: return "CYCLONE_DATAFRAG_PARITY";
     case DDSI_RTPS_SMID_SEC_PREFIX: return "SEC_PREFIX";
     case DDSI_RTPS_SMID_SEC_BODY: return "SEC_BODY";
     case DDSI_RTPS_SMID_SEC_POSTFIX: return "SEC_POSTFIX";
@@ -3175,6 +3290,24 @@ static int handle_submsg_sequence
         ts_for_latmeas = 0;
         break;
       }
+      case DDSI_RTPS_SMID_CYCLONE_DATAFRAG_PARITY: {
+        struct ddsi_rsample_info sampleinfo;
+        uint32_t datasz = 0;
+        unsigned char *datap;
+        const ddsi_keyhash_t *keyhash;
+        if (!ddsi_vendor_is_eclipse (rst->vendor)) {
+          // vendor-specific submessage id, some other vendor may have assigned it another meaning
+          struct submsg_name buffer;
+          GVTRACE ("%s", submsg_name (sm->smhdr.submessageId, &buffer));
+        } else if ((vr = validate_DataFragParity (rst, &sm->datafrag_parity, submsg_size, byteswap, &sampleinfo, &keyhash, &datap, &datasz)) == VR_ACCEPT) {
+          sampleinfo.timestamp = timestamp;
+          sampleinfo.reception_timestamp = tnowWC;
+          handle_DataFragParity (rst, tnowE, rmsg, &sm->datafrag_parity, &sampleinfo, keyhash, datap, datasz, &deferred_wakeup, prev_smid);
+          rst_live = 1;
+        }
+        ts_for_latmeas = 0;
+        break;
+      }
       case DDSI_RTPS_SMID_DATA: {
         struct ddsi_rsample_info sampleinfo;
         unsigned char *datap;
@@ -3258,8 +3391,10 @@ static int handle_submsg_sequence
   }
 }
 
-static void handle_rtps_message (struct ddsi_thread_state * const thrst, struct ddsi_domaingv *gv, struct ddsi_tran_conn * conn, const ddsi_guid_prefix_t *guidprefix, struct ddsi_rbufpool *rbpool, struct ddsi_rmsg *rmsg, size_t sz, unsigned char *msg, const struct ddsi_network_packet_info *pktinfo)
+static struct ddsi_rmsg *handle_rtps_message (struct ddsi_thread_state * const thrst, struct ddsi_domaingv *gv, struct ddsi_tran_conn * conn, const ddsi_guid_prefix_t *guidprefix, struct ddsi_rbufpool *rbpool, struct ddsi_rmsg *rmsg, size_t sz, unsigned char *msg, const struct ddsi_network_packet_info *pktinfo)
 {
+  /* Returns the rmsg the caller must commit: decoding a protected message
+     commits the one passed in and continues with a new one */
   ddsi_rtps_header_t *hdr = (ddsi_rtps_header_t *) msg;
   assert (gv->config.protocol_version.major == DDSI_RTPS_MAJOR);
   assert (ddsi_thread_is_asleep ());
@@ -3296,11 +3431,12 @@ static void handle_rtps_message (struct ddsi_thread_state * const thrst, struct
       handle_submsg_sequence (thrst, gv, conn, pktinfo, ddsrt_time_wallclock (), ddsrt_time_elapsed (), &hdr->guid_prefix, guidprefix, msg, (size_t) sz, msg + DDSI_RTPS_MESSAGE_HEADER_SIZE, rmsg, res == DDSI_RTPS_MSG_STATE_ENCODED);
     }
   }
+  return rmsg;
 }
 
 void ddsi_handle_rtps_message (struct ddsi_thread_state * const thrst, struct ddsi_domaingv *gv, struct ddsi_tran_conn * conn, const ddsi_guid_prefix_t *guidprefix, struct ddsi_rbufpool *rbpool, struct ddsi_rmsg *rmsg, size_t sz, unsigned char *msg, const struct ddsi_network_packet_info *pktinfo)
 {
-  handle_rtps_message (thrst, gv, conn, guidprefix, rbpool, rmsg, sz, msg, pktinfo);
+  (void) handle_rtps_message (thrst, gv, conn, guidprefix, rbpool, rmsg, sz, msg, pktinfo);
 }
 
 static bool do_packet (struct ddsi_thread_state * const thrst, struct ddsi_domaingv *gv, struct ddsi_tran_conn * conn, const ddsi_guid_prefix_t *guidprefix, struct ddsi_rbufpool *rbpool)
@@ -3391,12 +3527,80 @@ static bool do_packet (struct ddsi_thread_state * const thrst, struct ddsi_domai
   if (sz > 0 && !gv->deaf)
   {
     ddsi_rmsg_setsize (rmsg, (uint32_t) sz);
-    handle_rtps_message(thrst, gv, conn, guidprefix, rbpool, rmsg, (size_t) sz, buff, &pktinfo);
+    rmsg = handle_rtps_message (thrst, gv, conn, guidprefix, rbpool, rmsg, (size_t) sz, buff, &pktinfo);
   }
   ddsi_rmsg_commit (rmsg);
   return (sz > 0);
 }
 
+static bool do_packet_batch (struct ddsi_thread_state * const thrst, struct ddsi_domaingv *gv, struct ddsi_tran_conn * conn, const ddsi_guid_prefix_t *guidprefix, struct ddsi_rbufpool *rbpool)
+{
+  /* Same as do_packet for a connectionless transport, but reading as many
+     packets as are available (up to ReceiveBatchSize) in one go.  The rmsgs
+     for the entire batch get allocated up front; processing and committing
+     them happens in the order in which the packets were received. */
+  const size_t maxsz = gv->config.rmsg_chunk_size < 65536 ? gv->config.rmsg_chunk_size : 65536;
+  struct ddsi_rmsg *rmsgs[DDSI_TRAN_MAX_READ_BATCH];
+  struct ddsi_tran_read_batch_elem elems[DDSI_TRAN_MAX_READ_BATCH];
+  uint32_t n;
+  ssize_t nrecv;
+
+  assert (!conn->m_stream && conn->m_read_batch_fn != NULL);
+  assert (gv->config.recv_batch_size > 1 && gv->config.recv_batch_size <= DDSI_TRAN_MAX_READ_BATCH);
+  if ((n = ddsi_rmsg_new_batch (rbpool, (uint32_t) gv->config.recv_batch_size, rmsgs)) == 0)
+    return false;
+  for (uint32_t i = 0; i < n; i++)
+  {
+    elems[i].buf = (unsigned char *) DDSI_RMSG_PAYLOAD (rmsgs[i]);
+    elems[i].len = maxsz;
+  }
+
+  nrecv = ddsi_conn_read_batch (conn, elems, n);
+  for (uint32_t i = 0; i < n; i++)
+  {
+    struct ddsi_rmsg *rmsg = rmsgs[i];
+    if ((ssize_t) i < nrecv && elems[i].sz > 0 && !gv->deaf)
+    {
+      ddsi_rmsg_setsize (rmsg, (uint32_t) elems[i].sz);
+      rmsg = handle_rtps_message (thrst, gv, conn, guidprefix, rbpool, rmsg, elems[i].sz, elems[i].buf, &elems[i].pktinfo);
+    }
+    ddsi_rmsg_commit (rmsg);
+  }
+  ddsi_rbufpool_end_batch (rbpool);
+  return (nrecv > 0);
+}
+
+static void do_dgram (struct ddsi_thread_state * const thrst, struct ddsi_domaingv *gv, struct ddsi_tran_conn * conn, const ddsi_guid_prefix_t *guidprefix, struct ddsi_rbufpool *rbpool, const struct ddsi_sock_waitset_dgram *dgram)
+{
+  /* Same as do_packet for a datagram that the socket waitset has already received into
+     a buffer of its own.  Copying it into an rmsg sized to the datagram allows the
+     waitset to return its buffer to the kernel immediately, whereas the rmsg may have
+     to be retained for an arbitrary amount of time. */
+  struct ddsi_network_packet_info pktinfo;
+  struct ddsi_rmsg *rmsg;
+  unsigned char *buff;
+  if ((rmsg = ddsi_rmsg_new (rbpool)) == NULL)
+    return;
+  buff = (unsigned char *) DDSI_RMSG_PAYLOAD (rmsg);
+  assert (dgram->sz <= dgram->len && dgram->len <= gv->config.rmsg_chunk_size);
+  memcpy (buff, dgram->buf, dgram->sz);
+  ddsi_conn_read_done (conn, dgram->msghdr, buff, dgram->len, dgram->sz, &pktinfo);
+  if (dgram->sz > 0 && !gv->deaf)
+  {
+    ddsi_rmsg_setsize (rmsg, (uint32_t) dgram->sz);
+    rmsg = handle_rtps_message (thrst, gv, conn, guidprefix, rbpool, rmsg, dgram->sz, buff, &pktinfo);
+  }
+  ddsi_rmsg_commit (rmsg);
+}
+
+static bool do_packets (struct ddsi_thread_state * const thrst, struct ddsi_domaingv *gv, struct ddsi_tran_conn * conn, const ddsi_guid_prefix_t *guidprefix, struct ddsi_rbufpool *rbpool)
+{
+  if (gv->config.recv_batch_size > 1 && conn->m_read_batch_fn != NULL)
+    return do_packet_batch (thrst, gv, conn, guidprefix, rbpool);
+  else
+    return do_packet (thrst, gv, conn, guidprefix, rbpool);
+}
+
 struct local_participant_desc
 {
   struct ddsi_tran_conn * m_conn;
@@ -3549,8 +3753,11 @@ static int recv_thread_waitset_add_conn (struct ddsi_sock_waitset * ws, struct d
   {
     struct ddsi_domaingv *gv = conn->m_base.gv;
     for (uint32_t i = 0; i < gv->n_recv_threads; i++)
-      if (gv->recv_threads[i].arg.mode == DDSI_RTM_SINGLE && gv->recv_threads[i].arg.u.single.conn == conn)
+    {
+      const struct ddsi_recv_thread_arg * const arg = &gv->recv_threads[i].arg;
+      if ((arg->mode == DDSI_RTM_SINGLE && arg->u.single.conn == conn) || (arg->mode == DDSI_RTM_MANY && arg->u.many.conn == conn))
         return 0;
+    }
     return ddsi_sock_waitset_add (ws, conn);
   }
 }
@@ -3598,7 +3805,7 @@ uint32_t ddsi_recv_thread (void *vrecv_thread_arg)
     while (ddsrt_atomic_ld32 (&gv->rtps_keepgoing))
     {
       LOG_THREAD_CPUTIME (&gv->logconfig, next_thread_cputime);
-      (void) do_packet (thrst, gv, conn, NULL, rbpool);
+      (void) do_packets (thrst, gv, conn, NULL, rbpool);
     }
   }
   else
@@ -3607,7 +3814,14 @@ uint32_t ddsi_recv_thread (void *vrecv_thread_arg)
     unsigned num_fixed = 0, num_fixed_uc = 0;
     struct ddsi_sock_waitset_ctx * ctx;
     local_participant_set_init (&lps, &gv->participant_set_generation);
-    if (gv->m_factory->m_connless)
+    if (recv_thread_arg->u.many.conn)
+    {
+      // one of the sockets bound to the data port, the participant set isn't relevant
+      if (ddsi_sock_waitset_add (waitset, recv_thread_arg->u.many.conn) < 0)
+        DDS_FATAL("recv_thread: failed to add data_conn_uc to waitset\n");
+      num_fixed = 1;
+    }
+    else if (gv->m_factory->m_connless)
     {
       int rc;
       if ((rc = recv_thread_waitset_add_conn (waitset, gv->disc_conn_uc)) < 0)
@@ -3668,6 +3882,7 @@ uint32_t ddsi_recv_thread (void *vrecv_thread_arg)
       {
         int idx;
         struct ddsi_tran_conn * conn;
+        struct ddsi_sock_waitset_dgram dgram;
         while ((idx = ddsi_sock_waitset_next_event (ctx, &conn)) >= 0)
         {
           const ddsi_guid_prefix_t *guid_prefix;
@@ -3676,7 +3891,9 @@ uint32_t ddsi_recv_thread (void *vrecv_thread_arg)
           else
             guid_prefix = &lps.ps[(unsigned)idx - num_fixed].guid_prefix;
           /* Process message and clean out connection if failed or closed */
-          if (!do_packet (thrst, gv, conn, guid_prefix, rbpool) && !conn->m_connless)
+          if (ddsi_sock_waitset_event_dgram (ctx, &dgram))
+            do_dgram (thrst, gv, conn, guid_prefix, rbpool, &dgram);
+          else if (!do_packets (thrst, gv, conn, guid_prefix, rbpool) && !conn->m_connless)
             ddsi_conn_free (conn);
         }
       }
@@ -290,6 +290,24 @@ int ddsi_sock_waitset_next_event (struct ddsi_sock_waitset_ctx * ctx, struct dds
 #include <errno.h>
 #include <fcntl.h>
 #include <sys/epoll.h>
+#if DDSRT_HAVE_IO_URING
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+#include "dds/ddsrt/endian.h"
+#endif
+
+#if DDSRT_HAVE_IO_URING
+struct uring;
+
+struct uring_event {
+  int32_t bid; /* buffer to return to the kernel before taking the next event, or -1 */
+  bool have_dgram;
+  struct msghdr msghdr;
+  struct ddsi_sock_waitset_dgram dgram;
+};
+#endif
 
 struct ddsi_sock_waitset_ctx
 {
@@ -297,12 +315,21 @@ struct ddsi_sock_waitset_ctx
   uint32_t nevs;
   uint32_t evs_sz;
   uint32_t index; /* cursor for enumerating */
+#if DDSRT_HAVE_IO_URING
+  struct ddsi_sock_waitset *ws; /* io_uring: events are taken from its completion queue */
+  struct uring_event ev; /* io_uring: most recently returned event */
+#endif
 };
 
 struct entry {
   uint32_t index;
   int fd;
   struct ddsi_tran_conn * conn;
+#if DDSRT_HAVE_IO_URING
+  uint32_t gen; /* io_uring: distinguishes completions for this entry from those for previous uses of the slot */
+  bool recvmsg; /* io_uring: receive using multishot recvmsg, or else poll for readability */
+  bool armed; /* io_uring: a request is pending in the kernel */
+#endif
 };
 
 struct ddsi_sock_waitset
@@ -313,8 +340,407 @@ struct ddsi_sock_waitset
   struct entry *entries;
   struct ddsi_sock_waitset_ctx ctx; /* set of descriptors being handled */
   ddsrt_mutex_t lock; /* for add/delete */
+#if DDSRT_HAVE_IO_URING
+  struct uring *uring; /* if non-null, io_uring is used instead of epoll */
+#endif
 };
 
+#if DDSRT_HAVE_IO_URING
+
+/* The io_uring variant keeps a request pending in the kernel for each entry: a multishot
+   recvmsg for connections that can take a datagram received outside the transport, a
+   poll for the others.  The requests are armed by the thread handling the events only,
+   so that the work of receiving the datagrams is done by that thread, too.  Datagrams are
+   received into a ring of provided buffers, of which the thread handling the events has
+   at most one at any time.
+
+   The user data of a request is the index of the entry combined with its generation,
+   which gets incremented whenever the entry is removed, so that completions for a
+   connection that has been removed in the meantime can be recognized and ignored. */
+
+#define URING_SQ_ENTRIES 64
+#define URING_CQ_ENTRIES 1024
+#define URING_BGID 0
+#define URING_CONTROL_SIZE 64 /* plenty for IP_PKTINFO/IPV6_PKTINFO */
+#define URING_UD_IGNORE UINT64_MAX
+
+struct uring {
+  int fd;
+  unsigned sq_entries, sq_mask, cq_mask;
+  unsigned *sq_head, *sq_tail, *sq_array;
+  unsigned *cq_head, *cq_tail;
+  struct io_uring_sqe *sqes;
+  struct io_uring_cqe *cqes;
+  void *sq_ring, *cq_ring;
+  size_t sq_ring_sz, cq_ring_sz, sqes_sz;
+  unsigned sq_pending; /* number of queued requests not yet submitted */
+  bool need_arm; /* there may be entries that need to be (re)armed */
+  struct io_uring_buf_ring *br;
+  size_t br_sz;
+  uint32_t nbufs;
+  uint16_t br_tail;
+  unsigned char *bufs;
+  size_t bufsize; /* distance between buffers */
+  size_t dgram_offset; /* offset of the datagram in a buffer */
+  size_t maxdgram;
+  struct msghdr msghdr; /* template for multishot recvmsg */
+};
+
+static int sys_io_uring_setup (unsigned entries, struct io_uring_params *p)
+{
+  return (int) syscall (__NR_io_uring_setup, entries, p);
+}
+
+static int sys_io_uring_enter (int fd, unsigned to_submit, unsigned min_complete, unsigned flags)
+{
+  return (int) syscall (__NR_io_uring_enter, fd, to_submit, min_complete, flags, NULL, 0);
+}
+
+static int sys_io_uring_register (int fd, unsigned opcode, void *arg, unsigned nr_args)
+{
+  return (int) syscall (__NR_io_uring_register, fd, opcode, arg, nr_args);
+}
+
+static uint64_t uring_user_data (uint32_t idx, uint32_t gen)
+{
+  return ((uint64_t) gen << 32) | idx;
+}
+
+static void uring_recycle_buffer (struct uring *ur, uint16_t bid)
+{
+  struct io_uring_buf * const b = &ur->br->bufs[ur->br_tail & (ur->nbufs - 1)];
+  b->addr = (uintptr_t) (ur->bufs + (size_t) bid * ur->bufsize);
+  b->len = (uint32_t) (ur->dgram_offset + ur->maxdgram);
+  b->bid = bid;
+  ur->br_tail++;
+  __atomic_store_n (&ur->br->tail, ur->br_tail, __ATOMIC_RELEASE);
+}
+
+static void uring_flush_locked (struct uring *ur)
+{
+  /* Requests that could not be submitted remain in the submission queue and get
+     submitted on the next attempt */
+  while (ur->sq_pending > 0)
+  {
+    const int n = sys_io_uring_enter (ur->fd, ur->sq_pending, 0, 0);
+    if (n > 0)
+      ur->sq_pending -= (unsigned) n;
+    else if (n == 0 || errno != EINTR)
+    {
+      DDS_WARNING ("ddsi_sock_waitset: io_uring_enter failed, errno = %d\n", errno);
+      break;
+    }
+  }
+}
+
+static struct io_uring_sqe *uring_get_sqe_locked (struct uring *ur)
+{
+  const unsigned tail = *ur->sq_tail;
+  if (tail - __atomic_load_n (ur->sq_head, __ATOMIC_ACQUIRE) >= ur->sq_entries)
+  {
+    uring_flush_locked (ur);
+    if (tail - __atomic_load_n (ur->sq_head, __ATOMIC_ACQUIRE) >= ur->sq_entries)
+      return NULL;
+  }
+  const unsigned idx = tail & ur->sq_mask;
+  struct io_uring_sqe * const sqe = &ur->sqes[idx];
+  memset (sqe, 0, sizeof (*sqe));
+  ur->sq_array[idx] = idx;
+  return sqe;
+}
+
+static void uring_push_locked (struct uring *ur)
+{
+  __atomic_store_n (ur->sq_tail, *ur->sq_tail + 1, __ATOMIC_RELEASE);
+  ur->sq_pending++;
+}
+
+static bool uring_arm_locked (struct uring *ur, uint32_t idx, struct entry *e)
+{
+  struct io_uring_sqe *sqe;
+  if ((sqe = uring_get_sqe_locked (ur)) == NULL)
+    return false;
+  sqe->fd = e->fd;
+  sqe->user_data = uring_user_data (idx, e->gen);
+  if (e->recvmsg)
+  {
+    sqe->opcode = IORING_OP_RECVMSG;
+    sqe->addr = (uintptr_t) &ur->msghdr;
+    sqe->len = 1;
+    sqe->ioprio = IORING_RECV_MULTISHOT;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = URING_BGID;
+  }
+  else
+  {
+    /* The trigger pipe gets drained completely and so a multishot poll works, but the
+       other connections read a single message per event and need a level-triggered
+       poll, i.e., one that gets rearmed after handling the event */
+    uint32_t events = POLLIN;
+#if DDSRT_ENDIAN == DDSRT_BIG_ENDIAN
+    events = (events << 16) | (events >> 16);
+#endif
+    sqe->opcode = IORING_OP_POLL_ADD;
+    sqe->poll32_events = events;
+    sqe->len = (idx == 0) ? IORING_POLL_ADD_MULTI : 0;
+  }
+  uring_push_locked (ur);
+  e->armed = true;
+  return true;
+}
+
+static void uring_disarm_locked (struct uring *ur, uint32_t idx, struct entry *e)
+{
+  if (e->armed)
+  {
+    struct io_uring_sqe *sqe;
+    if ((sqe = uring_get_sqe_locked (ur)) != NULL)
+    {
+      sqe->opcode = IORING_OP_ASYNC_CANCEL;
+      sqe->addr = uring_user_data (idx, e->gen);
+      sqe->user_data = URING_UD_IGNORE;
+      uring_push_locked (ur);
+    }
+    e->armed = false;
+  }
+  e->gen++;
+}
+
+static void uring_prep_entry_locked (struct ddsi_sock_waitset *ws, struct entry *e, struct ddsi_tran_conn *conn)
+{
+  e->recvmsg = (conn != NULL && conn->m_connless && conn->m_read_done_fn != NULL);
+  e->armed = false;
+  ws->uring->need_arm = true;
+}
+
+static void uring_arm_pending_locked (struct ddsi_sock_waitset *ws)
+{
+  struct uring * const ur = ws->uring;
+  if (!ur->need_arm)
+    return;
+  ur->need_arm = false;
+  const uint32_t sz = ddsrt_atomic_ld32 (&ws->sz);
+  for (uint32_t i = 0; i < sz; i++)
+  {
+    struct entry * const e = &ws->entries[i];
+    if (e->fd != -1 && !e->armed && !uring_arm_locked (ur, i, e))
+      ur->need_arm = true;
+  }
+  uring_flush_locked (ur);
+}
+
+static void uring_free (struct uring *ur)
+{
+  struct io_uring_buf_reg reg;
+  memset (&reg, 0, sizeof (reg));
+  reg.bgid = URING_BGID;
+  (void) sys_io_uring_register (ur->fd, IORING_UNREGISTER_PBUF_RING, &reg, 1);
+  munmap (ur->sqes, ur->sqes_sz);
+  if (ur->cq_ring != ur->sq_ring)
+    munmap (ur->cq_ring, ur->cq_ring_sz);
+  munmap (ur->sq_ring, ur->sq_ring_sz);
+  close (ur->fd);
+  munmap (ur->br, ur->br_sz);
+  ddsrt_free (ur->bufs);
+  ddsrt_free (ur);
+}
+
+static struct uring *uring_new (uint32_t nbufs, size_t maxdgram)
+{
+  struct io_uring_params p;
+  struct uring *ur;
+  if ((ur = ddsrt_malloc (sizeof (*ur))) == NULL)
+    goto fail_uring;
+  memset (ur, 0, sizeof (*ur));
+  memset (&p, 0, sizeof (p));
+  p.flags = IORING_SETUP_CQSIZE;
+  p.cq_entries = URING_CQ_ENTRIES;
+  if ((ur->fd = sys_io_uring_setup (URING_SQ_ENTRIES, &p)) < 0)
+    goto fail_setup;
+  /* multishot requests may produce any number of completions, so the kernel must hold
+     on to them when the completion queue is full rather than drop them */
+  if (!(p.features & IORING_FEAT_NODROP))
+    goto fail_features;
+
+  ur->sq_ring_sz = p.sq_off.array + p.sq_entries * sizeof (unsigned);
+  ur->cq_ring_sz = p.cq_off.cqes + p.cq_entries * sizeof (struct io_uring_cqe);
+  if ((p.features & IORING_FEAT_SINGLE_MMAP) && ur->cq_ring_sz > ur->sq_ring_sz)
+    ur->sq_ring_sz = ur->cq_ring_sz;
+  if ((ur->sq_ring = mmap (NULL, ur->sq_ring_sz, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ur->fd, IORING_OFF_SQ_RING)) == MAP_FAILED)
+    goto fail_sq_ring;
+  if (p.features & IORING_FEAT_SINGLE_MMAP)
+    ur->cq_ring = ur->sq_ring;
+  else if ((ur->cq_ring = mmap (NULL, ur->cq_ring_sz, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ur->fd, IORING_OFF_CQ_RING)) == MAP_FAILED)
+    goto fail_cq_ring;
+  ur->sqes_sz = p.sq_entries * sizeof (struct io_uring_sqe);
+  if ((ur->sqes = mmap (NULL, ur->sqes_sz, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ur->fd, IORING_OFF_SQES)) == MAP_FAILED)
+    goto fail_sqes;
+  unsigned char * const sq = ur->sq_ring;
+  unsigned char * const cq = ur->cq_ring;
+  ur->sq_entries = p.sq_entries;
+  ur->sq_mask = *(unsigned *) (sq + p.sq_off.ring_mask);
+  ur->sq_head = (unsigned *) (sq + p.sq_off.head);
+  ur->sq_tail = (unsigned *) (sq + p.sq_off.tail);
+  ur->sq_array = (unsigned *) (sq + p.sq_off.array);
+  ur->cq_mask = *(unsigned *) (cq + p.cq_off.ring_mask);
+  ur->cq_head = (unsigned *) (cq + p.cq_off.head);
+  ur->cq_tail = (unsigned *) (cq + p.cq_off.tail);
+  ur->cqes = (struct io_uring_cqe *) (cq + p.cq_off.cqes);
+
+  /* A buffer holds the header describing the message, the source address, the control
+     messages and the datagram, in that order; the control messages must be aligned */
+  ur->msghdr.msg_namelen = (socklen_t) sizeof (struct sockaddr_storage);
+  ur->msghdr.msg_controllen = URING_CONTROL_SIZE;
+  ur->dgram_offset = sizeof (struct io_uring_recvmsg_out) + ur->msghdr.msg_namelen + ur->msghdr.msg_controllen;
+  ur->maxdgram = maxdgram;
+  ur->bufsize = (ur->dgram_offset + maxdgram + 63) & ~(size_t) 63;
+  ur->nbufs = nbufs;
+  if ((ur->bufs = ddsrt_malloc (nbufs * ur->bufsize)) == NULL)
+    goto fail_bufs;
+  ur->br_sz = nbufs * sizeof (struct io_uring_buf);
+  if ((ur->br = mmap (NULL, ur->br_sz, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0)) == MAP_FAILED)
+    goto fail_br;
+  struct io_uring_buf_reg reg;
+  memset (&reg, 0, sizeof (reg));
+  reg.ring_addr = (uintptr_t) ur->br;
+  reg.ring_entries = nbufs;
+  reg.bgid = URING_BGID;
+  if (sys_io_uring_register (ur->fd, IORING_REGISTER_PBUF_RING, &reg, 1) < 0)
+    goto fail_register;
+  for (uint32_t i = 0; i < nbufs; i++)
+    uring_recycle_buffer (ur, (uint16_t) i);
+  return ur;
+
+fail_register:
+  munmap (ur->br, ur->br_sz);
+fail_br:
+  ddsrt_free (ur->bufs);
+fail_bufs:
+  munmap (ur->sqes, ur->sqes_sz);
+fail_sqes:
+  if (ur->cq_ring != ur->sq_ring)
+    munmap (ur->cq_ring, ur->cq_ring_sz);
+fail_cq_ring:
+  munmap (ur->sq_ring, ur->sq_ring_sz);
+fail_sq_ring:
+fail_features:
+  close (ur->fd);
+fail_setup:
+  ddsrt_free (ur);
+fail_uring:
+  return NULL;
+}
+
+static void uring_event_done (struct uring *ur, struct uring_event *ev)
+{
+  if (ev->bid >= 0)
+  {
+    uring_recycle_buffer (ur, (uint16_t) ev->bid);
+    ev->bid = -1;
+  }
+  ev->have_dgram = false;
+}
+
+static void uring_event_dgram (struct uring *ur, struct uring_event *ev)
+{
+  unsigned char * const buf = ur->bufs + (size_t) ev->bid * ur->bufsize;
+  struct io_uring_recvmsg_out out;
+  memcpy (&out, buf, sizeof (out));
+  memset (&ev->msghdr, 0, sizeof (ev->msghdr));
+  ev->msghdr.msg_name = buf + sizeof (out);
+  ev->msghdr.msg_namelen = (out.namelen < (uint32_t) ur->msghdr.msg_namelen) ? (socklen_t) out.namelen : ur->msghdr.msg_namelen;
+  ev->msghdr.msg_control = buf + sizeof (out) + ur->msghdr.msg_namelen;
+  ev->msghdr.msg_controllen = (out.controllen < ur->msghdr.msg_controllen) ? out.controllen : ur->msghdr.msg_controllen;
+  ev->msghdr.msg_flags = (int) out.flags;
+  ev->dgram.msghdr = &ev->msghdr;
+  ev->dgram.buf = buf + ur->dgram_offset;
+  ev->dgram.len = ur->maxdgram;
+  ev->dgram.sz = (out.payloadlen < ur->maxdgram) ? out.payloadlen : ur->maxdgram;
+  ev->have_dgram = true;
+}
+
+static struct ddsi_sock_waitset_ctx * uring_wait (struct ddsi_sock_waitset * ws)
+{
+  struct uring * const ur = ws->uring;
+  ddsrt_mutex_lock (&ws->lock);
+  uring_arm_pending_locked (ws);
+  ddsrt_mutex_unlock (&ws->lock);
+  if (*ur->cq_head == __atomic_load_n (ur->cq_tail, __ATOMIC_ACQUIRE))
+  {
+    if (sys_io_uring_enter (ur->fd, 0, 1, IORING_ENTER_GETEVENTS) < 0 && errno != EINTR)
+    {
+      DDS_WARNING("ddsi_sock_waitset_wait: io_uring_enter failed, errno = %d\n", errno);
+      return NULL;
+    }
+  }
+  return &ws->ctx;
+}
+
+static int uring_next_event (struct ddsi_sock_waitset_ctx * ctx, struct ddsi_tran_conn ** conn)
+{
+  struct ddsi_sock_waitset * const ws = ctx->ws;
+  struct uring * const ur = ws->uring;
+  unsigned head = *ur->cq_head;
+  uring_event_done (ur, &ctx->ev);
+  while (head != __atomic_load_n (ur->cq_tail, __ATOMIC_ACQUIRE))
+  {
+    const struct io_uring_cqe cqe = ur->cqes[head & ur->cq_mask];
+    __atomic_store_n (ur->cq_head, ++head, __ATOMIC_RELEASE);
+    if (cqe.flags & IORING_CQE_F_BUFFER)
+      ctx->ev.bid = (int32_t) (cqe.flags >> IORING_CQE_BUFFER_SHIFT);
+    if (cqe.user_data == URING_UD_IGNORE)
+      continue;
+
+    const uint32_t idx = (uint32_t) cqe.user_data;
+    const uint32_t gen = (uint32_t) (cqe.user_data >> 32);
+    ddsrt_mutex_lock (&ws->lock);
+    struct entry * const e = (idx < ddsrt_atomic_ld32 (&ws->sz)) ? &ws->entries[idx] : NULL;
+    if (e == NULL || e->fd == -1 || e->gen != gen)
+    {
+      ddsrt_mutex_unlock (&ws->lock);
+      uring_event_done (ur, &ctx->ev);
+      continue;
+    }
+    if (!(cqe.flags & IORING_CQE_F_MORE))
+    {
+      e->armed = false;
+      ur->need_arm = true;
+    }
+    if (cqe.res == -EINVAL && e->recvmsg)
+    {
+      /* multishot recvmsg requires Linux 6.0, poll for readability instead on older kernels */
+      e->recvmsg = false;
+    }
+    const uint32_t index = e->index;
+    const bool recvmsg = e->recvmsg;
+    *conn = e->conn;
+    ddsrt_mutex_unlock (&ws->lock);
+
+    if (idx == 0)
+    {
+      /* trigger pipe, drain & try again */
+      char dummy[64];
+      while (read (ws->pipe[0], dummy, sizeof (dummy)) > 0)
+        ;
+    }
+    else if (cqe.res < 0 || (recvmsg && ctx->ev.bid < 0))
+    {
+      /* running out of buffers (ENOBUFS) or an error on the socket terminates a multishot
+         recvmsg, these have been dealt with once the entry is rearmed */
+      uring_event_done (ur, &ctx->ev);
+    }
+    else
+    {
+      if (recvmsg)
+        uring_event_dgram (ur, &ctx->ev);
+      return (int) (index - 1);
+    }
+  }
+  return -1;
+}
+
+#endif /* DDSRT_HAVE_IO_URING */
+
 static int add_entry_locked (struct ddsi_sock_waitset * ws, struct ddsi_tran_conn * conn, int fd)
 {
   uint32_t idx, fidx, sz, n;
@@ -336,20 +762,33 @@ static int add_entry_locked (struct ddsi_sock_waitset * ws, struct ddsi_tran_con
     const uint32_t newsz = ddsrt_atomic_add32_nv (&ws->sz, WAITSET_DELTA);
     ws->entries = ddsrt_realloc (ws->entries, newsz * sizeof (*ws->entries));
     for (idx = sz; idx < newsz; idx++)
+    {
       ws->entries[idx].fd = -1;
+#if DDSRT_HAVE_IO_URING
+      ws->entries[idx].gen = 0;
+      ws->entries[idx].armed = false;
+#endif
+    }
     fidx = sz;
   }
-  ev.events = EPOLLIN;
-  ev.data.ptr = &ws->entries[fidx];
-  if (epoll_ctl (ws->epfd, EPOLL_CTL_ADD, fd, &ev) == -1)
-    return -1;
+#if DDSRT_HAVE_IO_URING
+  if (ws->uring)
+    uring_prep_entry_locked (ws, &ws->entries[fidx], conn);
+  else
+#endif
+  {
+    ev.events = EPOLLIN;
+    ev.data.ptr = &ws->entries[fidx];
+    if (epoll_ctl (ws->epfd, EPOLL_CTL_ADD, fd, &ev) == -1)
+      return -1;
+  }
   ws->entries[fidx].conn = conn;
   ws->entries[fidx].fd = fd;
   ws->entries[fidx].index = n;
   return 1;
 }
 
-struct ddsi_sock_waitset * ddsi_sock_waitset_new (void)
+static struct ddsi_sock_waitset * waitset_new (struct uring *uring)
 {
   const uint32_t sz = WAITSET_DELTA;
   struct ddsi_sock_waitset * ws;
@@ -360,25 +799,44 @@ struct ddsi_sock_waitset * ddsi_sock_waitset_new (void)
   if ((ws->entries = ddsrt_malloc (sz * sizeof (*ws->entries))) == NULL)
     goto fail_entries;
   for (i = 0; i < sz; i++)
+  {
     ws->entries[i].fd = -1;
+#if DDSRT_HAVE_IO_URING
+    ws->entries[i].gen = 0;
+    ws->entries[i].armed = false;
+#endif
+  }
   ws->ctx.nevs = 0;
   ws->ctx.index = 0;
   ws->ctx.evs_sz = sz;
+#if DDSRT_HAVE_IO_URING
+  ws->uring = uring;
+  ws->ctx.ws = uring ? ws : NULL;
+  ws->ctx.ev.bid = -1;
+  ws->ctx.ev.have_dgram = false;
+#else
+  assert (uring == NULL);
+#endif
   if ((ws->ctx.evs = ddsrt_malloc (ws->ctx.evs_sz * sizeof (*ws->ctx.evs))) == NULL)
     goto fail_ctx_evs;
-  if ((ws->epfd = epoll_create (1)) == -1)
+  if (uring != NULL)
+    ws->epfd = -1;
+  else if ((ws->epfd = epoll_create (1)) == -1)
     goto fail_epoll_create;
   if (pipe (ws->pipe) == -1)
     goto fail_pipe;
   if (add_entry_locked (ws, NULL, ws->pipe[0]) < 0)
     goto fail_add_trigger;
   assert (ws->entries[0].fd == ws->pipe[0]);
-  if (fcntl (ws->epfd, F_SETFD, fcntl (ws->epfd, F_GETFD) | FD_CLOEXEC) == -1)
+  if (ws->epfd != -1 && fcntl (ws->epfd, F_SETFD, fcntl (ws->epfd, F_GETFD) | FD_CLOEXEC) == -1)
     goto fail_fcntl;
   if (fcntl (ws->pipe[0], F_SETFD, fcntl (ws->pipe[0], F_GETFD) | FD_CLOEXEC) == -1)
     goto fail_fcntl;
   if (fcntl (ws->pipe[1], F_SETFD, fcntl (ws->pipe[1], F_GETFD) | FD_CLOEXEC) == -1)
     goto fail_fcntl;
+  /* the io_uring variant drains the pipe on each wakeup */
+  if (uring != NULL && fcntl (ws->pipe[0], F_SETFL, fcntl (ws->pipe[0], F_GETFL) | O_NONBLOCK) == -1)
+    goto fail_fcntl;
   ddsrt_mutex_init (&ws->lock);
   return ws;
 
@@ -387,7 +845,8 @@ fail_add_trigger:
   close (ws->pipe[0]);
   close (ws->pipe[1]);
 fail_pipe:
-  close (ws->epfd);
+  if (ws->epfd != -1)
+    close (ws->epfd);
 fail_epoll_create:
   ddsrt_free (ws->ctx.evs);
 fail_ctx_evs:
@@ -398,12 +857,40 @@ fail_waitset:
   return NULL;
 }
 
+struct ddsi_sock_waitset * ddsi_sock_waitset_new (void)
+{
+  return waitset_new (NULL);
+}
+
+struct ddsi_sock_waitset * ddsi_sock_waitset_new_io_uring (uint32_t nbufs, size_t maxdgram)
+{
+#if DDSRT_HAVE_IO_URING
+  struct uring *uring;
+  struct ddsi_sock_waitset *ws;
+  assert (nbufs > 0 && nbufs <= 32768 && (nbufs & (nbufs - 1)) == 0);
+  if ((uring = uring_new (nbufs, maxdgram)) == NULL)
+    return NULL;
+  if ((ws = waitset_new (uring)) == NULL)
+    uring_free (uring);
+  return ws;
+#else
+  (void) nbufs;
+  (void) maxdgram;
+  return NULL;
+#endif
+}
+
 void ddsi_sock_waitset_free (struct ddsi_sock_waitset * ws)
 {
   ddsrt_mutex_destroy (&ws->lock);
+#if DDSRT_HAVE_IO_URING
+  if (ws->uring)
+    uring_free (ws->uring);
+#endif
   close (ws->pipe[0]);
   close (ws->pipe[1]);
-  close (ws->epfd);
+  if (ws->epfd != -1)
+    close (ws->epfd);
   ddsrt_free (ws->entries);
   ddsrt_free (ws->ctx.evs);
   ddsrt_free (ws);
@@ -439,6 +926,22 @@ void ddsi_sock_waitset_purge (struct ddsi_sock_waitset * ws, unsigned index)
   struct epoll_event ev;
   ddsrt_mutex_lock (&ws->lock);
   sz = ddsrt_atomic_ld32 (&ws->sz);
+#if DDSRT_HAVE_IO_URING
+  if (ws->uring)
+  {
+    /* pending requests keep the sockets open, so cancel them */
+    for (i = index + 1; i < sz; i++)
+    {
+      if (ws->entries[i].fd != -1)
+        uring_disarm_locked (ws->uring, i, &ws->entries[i]);
+      ws->entries[i].conn = NULL;
+      ws->entries[i].fd = -1;
+    }
+    uring_flush_locked (ws->uring);
+    ddsrt_mutex_unlock (&ws->lock);
+    return;
+  }
+#endif
   close (ws->epfd);
   if ((ws->epfd = epoll_create (1)) == -1)
     abort (); /* FIXME */
@@ -468,6 +971,15 @@ void ddsi_sock_waitset_remove (struct ddsi_sock_waitset * ws, struct ddsi_tran_c
   for (i = 1; i < sz; i++)
     if (ws->entries[i].fd == fd)
       break;
+#if DDSRT_HAVE_IO_URING
+  if (i < sz && ws->uring)
+  {
+    uring_disarm_locked (ws->uring, i, &ws->entries[i]);
+    uring_flush_locked (ws->uring);
+    ws->entries[i].fd = -1;
+  }
+  else
+#endif
   if (i < sz)
   {
     // pre linux 2.6.9, a non-null event pointer was required, contents don't matter
@@ -486,6 +998,10 @@ struct ddsi_sock_waitset_ctx * ddsi_sock_waitset_wait (struct ddsi_sock_waitset
      be stored, and the set will be grown on the next call */
   uint32_t ws_sz = ddsrt_atomic_ld32 (&ws->sz);
   int nevs;
+#if DDSRT_HAVE_IO_URING
+  if (ws->uring)
+    return uring_wait (ws);
+#endif
   if (ws->ctx.evs_sz < ws_sz)
   {
     ws->ctx.evs_sz = ws_sz;
@@ -509,6 +1025,10 @@ struct ddsi_sock_waitset_ctx * ddsi_sock_waitset_wait (struct ddsi_sock_waitset
 
 int ddsi_sock_waitset_next_event (struct ddsi_sock_waitset_ctx * ctx, struct ddsi_tran_conn **conn)
 {
+#if DDSRT_HAVE_IO_URING
+  if (ctx->ws)
+    return uring_next_event (ctx, conn);
+#endif
   while (ctx->index < ctx->nevs)
   {
     uint32_t idx = ctx->index++;
@@ -530,6 +1050,21 @@ int ddsi_sock_waitset_next_event (struct ddsi_sock_waitset_ctx * ctx, struct dds
   return -1;
 }
 
+bool ddsi_sock_waitset_event_dgram (const struct ddsi_sock_waitset_ctx * ctx, struct ddsi_sock_waitset_dgram * dgram)
+{
+#if DDSRT_HAVE_IO_URING
+  if (ctx->ws && ctx->ev.have_dgram)
+  {
+    *dgram = ctx->ev.dgram;
+    return true;
+  }
+#else
+  (void) ctx;
+  (void) dgram;
+#endif
+  return false;
+}
+
 #elif MODE_SEL == MODE_WFMEVS
 
 struct ddsi_sock_waitset_ctx
@@ -1191,3 +1726,19 @@ DDSRT_WARNING_GNUC_ON(sign-conversion)
 #else
 #error "no mode selected"
 #endif
+
+#if MODE_SEL != MODE_EPOLL
+struct ddsi_sock_waitset * ddsi_sock_waitset_new_io_uring (uint32_t nbufs, size_t maxdgram)
+{
+  (void) nbufs;
+  (void) maxdgram;
+  return NULL;
+}
+
+bool ddsi_sock_waitset_event_dgram (const struct ddsi_sock_waitset_ctx * ctx, struct ddsi_sock_waitset_dgram * dgram)
+{
+  (void) ctx;
+  (void) dgram;
+  return false;
+}
+#endif
@@ -19,17 +19,21 @@
 #include "ddsi__radmin.h"
 #include "ddsi__proxy_endpoint.h"
 
-void ddsi_get_writer_stats (struct ddsi_writer *wr, uint64_t *rexmit_bytes, uint32_t *throttle_count, uint64_t *time_throttled, uint64_t *time_retransmit)
+void ddsi_get_writer_stats (struct ddsi_writer *wr, uint64_t *rexmit_bytes, uint32_t *throttle_count, uint64_t *time_throttled, uint64_t *time_retransmit, uint64_t *pacing_rate, uint32_t *pacing_decrease_count, uint64_t *time_paced, uint64_t *filtered_count)
 {
   ddsrt_mutex_lock (&wr->e.lock);
   *rexmit_bytes = wr->rexmit_bytes;
   *throttle_count = wr->throttle_count;
   *time_throttled = wr->time_throttled;
   *time_retransmit = wr->time_retransmit;
+  *pacing_rate = wr->pacing.rate;
+  *pacing_decrease_count = wr->pacing.decrease_count;
+  *time_paced = wr->pacing.time_paced;
+  *filtered_count = wr->filtered_count;
   ddsrt_mutex_unlock (&wr->e.lock);
 }
 
-void ddsi_get_reader_stats (struct ddsi_reader *rd, uint64_t *discarded_bytes)
+void ddsi_get_reader_stats (struct ddsi_reader *rd, uint64_t *discarded_bytes, uint64_t *recovered_bytes)
 {
   struct ddsi_rd_pwr_match *m;
   ddsi_guid_t pwrguid;
@@ -37,6 +41,7 @@ void ddsi_get_reader_stats (struct ddsi_reader *rd, uint64_t *discarded_bytes)
   assert (ddsi_thread_is_awake ());
 
   *discarded_bytes = 0;
+  *recovered_bytes = 0;
 
   // collect for all matched proxy writers
   ddsrt_mutex_lock (&rd->e.lock);
@@ -47,17 +52,18 @@ void ddsi_get_reader_stats (struct ddsi_reader *rd, uint64_t *discarded_bytes)
     ddsrt_mutex_unlock (&rd->e.lock);
     if ((pwr = ddsi_entidx_lookup_proxy_writer_guid (rd->e.gv->entity_index, &pwrguid)) != NULL)
     {
-      uint64_t disc_frags, disc_samples;
+      uint64_t disc_frags, disc_samples, rec_frags;
       ddsrt_mutex_lock (&pwr->e.lock);
       struct ddsi_pwr_rd_match *x = ddsrt_avl_lookup (&ddsi_pwr_readers_treedef, &pwr->readers, &rd->e.guid);
       if (x != NULL)
       {
-        ddsi_defrag_stats (pwr->defrag, &disc_frags);
+        ddsi_defrag_stats (pwr->defrag, &disc_frags, &rec_frags);
         if (x->in_sync != PRMSS_OUT_OF_SYNC && !x->filtered)
           ddsi_reorder_stats (pwr->reorder, &disc_samples);
         else
           ddsi_reorder_stats (x->u.not_in_sync.reorder, &disc_samples);
         *discarded_bytes += disc_frags + disc_samples;
+        *recovered_bytes += rec_frags;
       }
       ddsrt_mutex_unlock (&pwr->e.lock);
     }
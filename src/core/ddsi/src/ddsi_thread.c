@@ -24,6 +24,8 @@
 #include "dds/ddsi/ddsi_domaingv.h"
 #include "ddsi__thread.h"
 #include "ddsi__sysdeps.h"
+#include "ddsi__tkmap.h"
+#include "ddsi__mempool.h"
 
 struct ddsi_thread_states thread_states;
 ddsrt_thread_local struct ddsi_thread_state *tsd_thread_state;
@@ -129,6 +131,8 @@ bool ddsi_thread_states_fini (void)
      already, we can release all resources. */
   struct ddsi_thread_state *thrst = ddsi_lookup_thread_state ();
   assert (ddsi_vtime_asleep_p (ddsrt_atomic_ld32 (&thrst->vtime)));
+  ddsi_tkmap_thread_caches_fini (thrst);
+  ddsi_mempool_thread_fini ();
   reap_thread_state (thrst, true);
   tsd_thread_state = NULL;
 
@@ -207,6 +211,8 @@ static void cleanup_thread_state (void *data)
   {
     assert (thrst->state == DDSI_THREAD_STATE_LAZILY_CREATED);
     assert (ddsi_vtime_asleep_p (ddsrt_atomic_ld32 (&thrst->vtime)));
+    ddsi_tkmap_thread_caches_fini (thrst);
+    ddsi_mempool_thread_fini ();
     reap_thread_state (thrst, false);
   }
   ddsrt_fini ();
@@ -258,6 +264,8 @@ static uint32_t create_thread_wrapper (void *ptr)
   thrst->state = DDSI_THREAD_STATE_ALIVE;
   ddsrt_mutex_unlock (&thread_states.lock);
   const uint32_t ret = thrst->f (thrst->f_arg);
+  ddsi_tkmap_thread_caches_fini (thrst);
+  ddsi_mempool_thread_fini ();
   ddsrt_mutex_lock (&thread_states.lock);
   thrst->state = DDSI_THREAD_STATE_STOPPED;
   ddsrt_mutex_unlock (&thread_states.lock);
@@ -10,31 +10,108 @@
 
 #include <assert.h>
 #include <string.h>
+#include <inttypes.h>
 
 #include "dds/ddsrt/heap.h"
 #include "dds/ddsrt/log.h"
 #include "dds/ddsrt/sync.h"
 #include "dds/ddsrt/hopscotch.h"
+#include "dds/ddsrt/string.h"
+#include "dds/ddsrt/threads.h"
+#include "dds/ddsrt/time.h"
 #include "dds/ddsi/ddsi_unused.h"
 #include "dds/ddsi/ddsi_domaingv.h"
 #include "dds/ddsi/ddsi_iid.h"
 #include "dds/ddsi/ddsi_tkmap.h"
 #include "dds/ddsi/ddsi_serdata.h"
+#include "dds/ddsi/ddsi_log.h"
 #include "ddsi__thread.h"
 #include "ddsi__gc.h"
+#include "ddsi__tkmap.h"
 #include "dds/cdr/dds_cdrstream.h"
 
 #define REFC_DELETE 0x80000000
 #define REFC_MASK   0x0fffffff
 
-struct ddsi_tkmap
+#define MAX_TKMAP_SHARDS 256
+#define MAX_TKMAP_CACHE_SIZE 65536
+
+/* Lookups in the per-thread caches are timed once every CACHE_TIMING_INTERVAL
+   lookups (a power of two), and the statistics are traced once every
+   CACHE_REPORT_INTERVAL lookups */
+#define CACHE_TIMING_INTERVAL 64
+#define CACHE_REPORT_INTERVAL (1u << 20)
+
+/* The instances are spread over a number of independent hash tables based on
+   the hash of the key, so that threads working on different instances don't
+   all contend for the same cache lines. The lock and condition variable are
+   only used for waiting for an instance that is being deleted to disappear
+   from its table. */
+struct ddsi_tkmap_shard
 {
   struct ddsrt_chh *m_hh;
-  struct ddsi_domaingv *gv;
   ddsrt_mutex_t m_lock;
   ddsrt_cond_t m_cond;
 };
 
+struct ddsi_tkmap_cache_stats
+{
+  uint64_t lookups;
+  uint64_t hits;
+  uint64_t timed_hits;
+  uint64_t timed_misses;
+  int64_t hit_time;
+  int64_t miss_time;
+};
+
+/* A small direct-mapped cache of instances, indexed by the hash of the key and
+   private to one thread. Each cached instance holds a reference, so that a hit
+   doesn't need anything beyond a key comparison and incrementing the reference
+   count. The flip side is that the instances in the cache are retained in the
+   map (and so keep their instance handle) until they get evicted or the thread
+   terminates.
+
+   A cache is on the list of the map and on that of the owning thread, and is
+   freed when both are done with it. Whichever comes first detaches it from the
+   map by clearing "map"; the references are then either released by the
+   terminating thread or freed with the map. */
+struct ddsi_tkmap_cache
+{
+  struct ddsi_tkmap_cache *next; /* protected by map->caches_lock */
+  struct ddsi_tkmap_cache *thread_next; /* only accessed by the owner */
+  uint64_t map_id;
+  ddsrt_mutex_t lock; /* protects map */
+  struct ddsi_tkmap *map;
+  ddsrt_atomic_uint32_t refc;
+  char owner_name[24];
+  struct ddsi_tkmap_cache_stats stats;
+  struct ddsi_tkmap_instance *entries[];
+};
+
+struct ddsi_tkmap
+{
+  struct ddsi_domaingv *gv;
+  uint32_t nshards;
+  struct ddsi_tkmap_shard *shards;
+  uint64_t id;
+  uint32_t cache_size; /* 0 or a power of 2 */
+  ddsrt_mutex_t caches_lock;
+  bool caches_closed;
+  struct ddsi_tkmap_cache *caches;
+};
+
+/* The calling thread's caches, and the one for the map it used most recently.
+   The map is identified by its unique id rather than by its address so that a
+   cache for a map that has since been freed will never be used. */
+struct tkmap_cache_tsd
+{
+  uint64_t map_id;
+  struct ddsi_tkmap_cache *cache;
+  struct ddsi_tkmap_cache *caches;
+};
+
+static ddsrt_thread_local struct tkmap_cache_tsd tsd_tkmap_cache;
+
 static void gc_buckets_impl (struct ddsi_gcreq *gcreq)
 {
   ddsrt_free (gcreq->arg);
@@ -84,13 +161,46 @@ static bool dds_tk_equals_void (const void *a, const void *b)
   return dds_tk_equals (a, b);
 }
 
+static struct ddsi_tkmap_shard *tkmap_shard (const struct ddsi_tkmap *map, const struct ddsi_serdata *sd)
+{
+  /* The hash tables index using the low-order bits of the hash, multiplying by a large
+     odd constant and then using the high-order bits avoids correlation */
+  const uint32_t h = sd->hash * UINT32_C (0x9e3779b1);
+  return &map->shards[(uint32_t) (((uint64_t) h * map->nshards) >> 32)];
+}
+
 struct ddsi_tkmap *ddsi_tkmap_new (struct ddsi_domaingv *gv)
 {
   struct ddsi_tkmap *tkmap = dds_alloc (sizeof (*tkmap));
-  tkmap->m_hh = ddsrt_chh_new (1, dds_tk_hash_void, dds_tk_equals_void, gc_buckets, tkmap);
   tkmap->gv = gv;
-  ddsrt_mutex_init (&tkmap->m_lock);
-  ddsrt_cond_init (&tkmap->m_cond);
+  tkmap->nshards = (uint32_t) gv->config.tkmap_shards;
+  if (tkmap->nshards == 0)
+    tkmap->nshards = 1;
+  else if (tkmap->nshards > MAX_TKMAP_SHARDS)
+    tkmap->nshards = MAX_TKMAP_SHARDS;
+  tkmap->shards = ddsrt_malloc (tkmap->nshards * sizeof (*tkmap->shards));
+  for (uint32_t i = 0; i < tkmap->nshards; i++)
+  {
+    struct ddsi_tkmap_shard * const shard = &tkmap->shards[i];
+    shard->m_hh = ddsrt_chh_new (1, dds_tk_hash_void, dds_tk_equals_void, gc_buckets, tkmap);
+    ddsrt_mutex_init (&shard->m_lock);
+    ddsrt_cond_init (&shard->m_cond);
+  }
+  // 0 is the initial value of the thread-local cache pointer's map id, so it
+  // must never be used for a map
+  do {
+    tkmap->id = ddsi_iid_gen ();
+  } while (tkmap->id == 0);
+  tkmap->cache_size = 0;
+  if (gv->config.tkmap_cache_size > 0)
+  {
+    tkmap->cache_size = 1;
+    while (tkmap->cache_size < (uint32_t) gv->config.tkmap_cache_size && tkmap->cache_size < MAX_TKMAP_CACHE_SIZE)
+      tkmap->cache_size *= 2;
+  }
+  ddsrt_mutex_init (&tkmap->caches_lock);
+  tkmap->caches_closed = false;
+  tkmap->caches = NULL;
   return tkmap;
 }
 
@@ -101,12 +211,61 @@ static void free_tkmap_instance (void *vtk, UNUSED_ARG(void *f_arg))
   ddsrt_free (tk);
 }
 
+static void tkmap_cache_trace_stats (const struct ddsi_tkmap *map, const char *thrname, const struct ddsi_tkmap_cache_stats *st)
+{
+  const struct ddsi_domaingv * const gv = map->gv;
+  GVTRACE ("tkmap cache %s: lookups %"PRIu64" hits %"PRIu64" (%.1f%%) avg lookup hit %.0fns miss %.0fns\n",
+           thrname, st->lookups, st->hits, (st->lookups == 0) ? 0.0 : 100.0 * (double) st->hits / (double) st->lookups,
+           (st->timed_hits == 0) ? 0.0 : (double) st->hit_time / (double) st->timed_hits,
+           (st->timed_misses == 0) ? 0.0 : (double) st->miss_time / (double) st->timed_misses);
+}
+
+static void tkmap_cache_unref (struct ddsi_tkmap_cache *c)
+{
+  if (ddsrt_atomic_dec32_nv (&c->refc) == 0)
+  {
+    ddsrt_mutex_destroy (&c->lock);
+    ddsrt_free (c);
+  }
+}
+
+void ddsi_tkmap_close_caches (struct ddsi_tkmap *map)
+{
+  /* Instances referenced by the caches are also in the hash tables and get freed
+     with them, no need to drop the references first.  Taking the caches off the
+     list one at a time avoids holding caches_lock while locking a cache, as a
+     terminating thread locks them in the opposite order. */
+  struct ddsi_tkmap_cache *c;
+  ddsrt_mutex_lock (&map->caches_lock);
+  map->caches_closed = true;
+  while ((c = map->caches) != NULL)
+  {
+    map->caches = c->next;
+    ddsrt_mutex_unlock (&map->caches_lock);
+    ddsrt_mutex_lock (&c->lock);
+    assert (c->map == map || c->map == NULL);
+    c->map = NULL;
+    ddsrt_mutex_unlock (&c->lock);
+    tkmap_cache_trace_stats (map, c->owner_name, &c->stats);
+    tkmap_cache_unref (c);
+    ddsrt_mutex_lock (&map->caches_lock);
+  }
+  ddsrt_mutex_unlock (&map->caches_lock);
+}
+
 void ddsi_tkmap_free (struct ddsi_tkmap * map)
 {
-  ddsrt_chh_enum_unsafe (map->m_hh, free_tkmap_instance, NULL);
-  ddsrt_chh_free (map->m_hh);
-  ddsrt_cond_destroy (&map->m_cond);
-  ddsrt_mutex_destroy (&map->m_lock);
+  ddsi_tkmap_close_caches (map);
+  ddsrt_mutex_destroy (&map->caches_lock);
+  for (uint32_t i = 0; i < map->nshards; i++)
+  {
+    struct ddsi_tkmap_shard * const shard = &map->shards[i];
+    ddsrt_chh_enum_unsafe (shard->m_hh, free_tkmap_instance, NULL);
+    ddsrt_chh_free (shard->m_hh);
+    ddsrt_cond_destroy (&shard->m_cond);
+    ddsrt_mutex_destroy (&shard->m_lock);
+  }
+  ddsrt_free (map->shards);
   dds_free (map);
 }
 
@@ -116,7 +275,7 @@ uint64_t ddsi_tkmap_lookup (struct ddsi_tkmap * map, const struct ddsi_serdata *
   struct ddsi_tkmap_instance * tk;
   assert (ddsi_thread_is_awake ());
   dummy.m_sample = (struct ddsi_serdata *) sd;
-  tk = ddsrt_chh_lookup (map->m_hh, &dummy);
+  tk = ddsrt_chh_lookup (tkmap_shard (map, sd)->m_hh, &dummy);
   return (tk) ? tk->m_iid : DDS_HANDLE_NIL;
 }
 
@@ -127,9 +286,13 @@ struct ddsi_tkmap_instance *ddsi_tkmap_find_by_id (struct ddsi_tkmap *map, uint6
   struct ddsi_tkmap_instance *tk;
   uint32_t refc;
   assert (ddsi_thread_is_awake ());
-  for (tk = ddsrt_chh_iter_first (map->m_hh, &it); tk; tk = ddsrt_chh_iter_next (&it))
-    if (tk->m_iid == iid)
-      break;
+  tk = NULL;
+  for (uint32_t i = 0; tk == NULL && i < map->nshards; i++)
+  {
+    for (tk = ddsrt_chh_iter_first (map->shards[i].m_hh, &it); tk; tk = ddsrt_chh_iter_next (&it))
+      if (tk->m_iid == iid)
+        break;
+  }
   if (tk == NULL)
     /* Common case of it not existing at all */
     return NULL;
@@ -155,13 +318,14 @@ struct ddsi_tkmap_instance *ddsi_tkmap_find_by_id (struct ddsi_tkmap *map, uint6
 
 struct ddsi_tkmap_instance *ddsi_tkmap_find (struct ddsi_tkmap *map, struct ddsi_serdata *sd, const bool create)
 {
+  struct ddsi_tkmap_shard * const shard = tkmap_shard (map, sd);
   struct ddsi_tkmap_instance dummy;
   struct ddsi_tkmap_instance *tk;
 
   assert (ddsi_thread_is_awake ());
   dummy.m_sample = sd;
 retry:
-  if ((tk = ddsrt_chh_lookup(map->m_hh, &dummy)) != NULL)
+  if ((tk = ddsrt_chh_lookup(shard->m_hh, &dummy)) != NULL)
   {
     uint32_t new;
     new = ddsrt_atomic_inc32_nv(&tk->m_refc);
@@ -173,10 +337,10 @@ retry:
       /* simplest action would be to just spin, but that can potentially take a long time;
        we can block until someone signals some entry is removed from the map if we take
        some lock & wait for some condition */
-      ddsrt_mutex_lock(&map->m_lock);
-      while ((tk = ddsrt_chh_lookup(map->m_hh, &dummy)) != NULL && (ddsrt_atomic_ld32(&tk->m_refc) & REFC_DELETE))
-        ddsrt_cond_wait(&map->m_cond, &map->m_lock);
-      ddsrt_mutex_unlock(&map->m_lock);
+      ddsrt_mutex_lock(&shard->m_lock);
+      while ((tk = ddsrt_chh_lookup(shard->m_hh, &dummy)) != NULL && (ddsrt_atomic_ld32(&tk->m_refc) & REFC_DELETE))
+        ddsrt_cond_wait(&shard->m_cond, &shard->m_lock);
+      ddsrt_mutex_unlock(&shard->m_lock);
       goto retry;
     }
   }
@@ -188,7 +352,7 @@ retry:
     tk->m_sample = ddsi_serdata_to_untyped (sd);
     ddsrt_atomic_st32 (&tk->m_refc, 1);
     tk->m_iid = ddsi_iid_gen ();
-    if (!ddsrt_chh_add (map->m_hh, tk))
+    if (!ddsrt_chh_add (shard->m_hh, tk))
     {
       /* Lost a race from another thread, retry */
       ddsi_serdata_unref (tk->m_sample);
@@ -199,9 +363,159 @@ retry:
   return tk;
 }
 
+static bool tkmap_cache_detached (struct ddsi_tkmap_cache *c)
+{
+  ddsrt_mutex_lock (&c->lock);
+  const bool detached = (c->map == NULL);
+  ddsrt_mutex_unlock (&c->lock);
+  return detached;
+}
+
+static struct ddsi_tkmap_cache *tkmap_thread_cache (struct ddsi_tkmap *map)
+{
+  struct tkmap_cache_tsd * const tsd = &tsd_tkmap_cache;
+  if (tsd->map_id == map->id)
+    return tsd->cache;
+
+  /* Slow path: this thread either never used this map or used a different one
+     since, so it may or may not already have a cache.  Caches of maps that no
+     longer exist are dropped on the way. */
+  struct ddsi_tkmap_cache *c, **pc = &tsd->caches;
+  while ((c = *pc) != NULL && c->map_id != map->id)
+  {
+    if (!tkmap_cache_detached (c))
+      pc = &c->thread_next;
+    else
+    {
+      *pc = c->thread_next;
+      tkmap_cache_unref (c);
+    }
+  }
+  if (c == NULL)
+  {
+    ddsrt_mutex_lock (&map->caches_lock);
+    if (map->caches_closed)
+    {
+      ddsrt_mutex_unlock (&map->caches_lock);
+      return NULL;
+    }
+    c = ddsrt_malloc (sizeof (*c) + map->cache_size * sizeof (c->entries[0]));
+    c->map_id = map->id;
+    ddsrt_mutex_init (&c->lock);
+    c->map = map;
+    ddsrt_atomic_st32 (&c->refc, 2);
+    (void) ddsrt_strlcpy (c->owner_name, ddsi_lookup_thread_state ()->name, sizeof (c->owner_name));
+    memset (&c->stats, 0, sizeof (c->stats));
+    memset (c->entries, 0, map->cache_size * sizeof (c->entries[0]));
+    c->next = map->caches;
+    map->caches = c;
+    ddsrt_mutex_unlock (&map->caches_lock);
+    c->thread_next = tsd->caches;
+    tsd->caches = c;
+  }
+  tsd->map_id = map->id;
+  tsd->cache = c;
+  return c;
+}
+
+void ddsi_tkmap_thread_caches_fini (struct ddsi_thread_state *thrst)
+{
+  struct tkmap_cache_tsd * const tsd = &tsd_tkmap_cache;
+  struct ddsi_tkmap_cache *c;
+  tsd->map_id = 0;
+  tsd->cache = NULL;
+  while ((c = tsd->caches) != NULL)
+  {
+    tsd->caches = c->thread_next;
+    ddsrt_mutex_lock (&c->lock);
+    struct ddsi_tkmap * const map = c->map;
+    if (map != NULL)
+    {
+      /* The map can't be closed (let alone freed) while we hold the lock on an
+         attached cache, but it may already have taken the cache off its list and
+         be waiting for the lock to detach it.  If not, the map's reference is ours
+         to drop. */
+      struct ddsi_tkmap_cache **pc;
+      ddsrt_mutex_lock (&map->caches_lock);
+      for (pc = &map->caches; *pc != NULL && *pc != c; pc = &(*pc)->next)
+        ;
+      const bool unlinked = (*pc != NULL);
+      if (unlinked)
+        *pc = c->next;
+      ddsrt_mutex_unlock (&map->caches_lock);
+      if (unlinked)
+      {
+        tkmap_cache_trace_stats (map, c->owner_name, &c->stats);
+        ddsrt_atomic_dec32 (&c->refc);
+      }
+      ddsi_thread_state_awake (thrst, map->gv);
+      for (uint32_t i = 0; i < map->cache_size; i++)
+        if (c->entries[i])
+          ddsi_tkmap_instance_unref (map, c->entries[i]);
+      ddsi_thread_state_asleep (thrst);
+      c->map = NULL;
+    }
+    ddsrt_mutex_unlock (&c->lock);
+    tkmap_cache_unref (c);
+  }
+}
+
+static struct ddsi_tkmap_instance *tkmap_cache_lookup_instance_ref (struct ddsi_tkmap *map, struct ddsi_tkmap_cache *c, struct ddsi_serdata *sd)
+{
+  struct ddsi_tkmap_instance ** const entry = &c->entries[sd->hash & (map->cache_size - 1)];
+  struct ddsi_tkmap_instance *tk = *entry;
+  struct ddsi_tkmap_instance dummy;
+  dummy.m_sample = sd;
+  if (tk != NULL && tk->m_sample->hash == sd->hash && dds_tk_equals (tk, &dummy))
+  {
+    /* The cache holds a reference, so it can't be in the process of being deleted */
+    assert (!(ddsrt_atomic_ld32 (&tk->m_refc) & REFC_DELETE));
+    ddsrt_atomic_inc32 (&tk->m_refc);
+    c->stats.hits++;
+    return tk;
+  }
+  else if ((tk = ddsi_tkmap_find (map, sd, true)) != NULL)
+  {
+    struct ddsi_tkmap_instance * const evicted = *entry;
+    ddsrt_atomic_inc32 (&tk->m_refc);
+    *entry = tk;
+    if (evicted)
+      ddsi_tkmap_instance_unref (map, evicted);
+  }
+  return tk;
+}
+
 struct ddsi_tkmap_instance *ddsi_tkmap_lookup_instance_ref (struct ddsi_tkmap *map, struct ddsi_serdata *sd)
 {
-  return ddsi_tkmap_find (map, sd, true);
+  struct ddsi_tkmap_cache *c;
+  if (map->cache_size == 0)
+    return ddsi_tkmap_find (map, sd, true);
+
+  assert (ddsi_thread_is_awake ());
+  if ((c = tkmap_thread_cache (map)) == NULL)
+    return ddsi_tkmap_find (map, sd, true);
+  if (++c->stats.lookups % CACHE_TIMING_INTERVAL != 0)
+    return tkmap_cache_lookup_instance_ref (map, c, sd);
+  else
+  {
+    const uint64_t hits = c->stats.hits;
+    const ddsrt_mtime_t t0 = ddsrt_time_monotonic ();
+    struct ddsi_tkmap_instance * const tk = tkmap_cache_lookup_instance_ref (map, c, sd);
+    const int64_t dt = ddsrt_time_monotonic ().v - t0.v;
+    if (c->stats.hits != hits)
+    {
+      c->stats.timed_hits++;
+      c->stats.hit_time += dt;
+    }
+    else
+    {
+      c->stats.timed_misses++;
+      c->stats.miss_time += dt;
+    }
+    if (c->stats.lookups % CACHE_REPORT_INTERVAL == 0)
+      tkmap_cache_trace_stats (map, c->owner_name, &c->stats);
+    return tk;
+  }
 }
 
 void ddsi_tkmap_instance_ref (struct ddsi_tkmap_instance *tk)
@@ -226,14 +540,15 @@ void ddsi_tkmap_instance_unref (struct ddsi_tkmap *map, struct ddsi_tkmap_instan
   if (new == REFC_DELETE)
   {
     /* Remove from hash table */
-    bool removed = ddsrt_chh_remove(map->m_hh, tk);
+    struct ddsi_tkmap_shard * const shard = tkmap_shard (map, tk->m_sample);
+    bool removed = ddsrt_chh_remove(shard->m_hh, tk);
     assert (removed);
     (void)removed;
 
     /* Signal any threads blocked in their retry loops in lookup */
-    ddsrt_mutex_lock(&map->m_lock);
-    ddsrt_cond_broadcast(&map->m_cond);
-    ddsrt_mutex_unlock(&map->m_lock);
+    ddsrt_mutex_lock(&shard->m_lock);
+    ddsrt_cond_broadcast(&shard->m_cond);
+    ddsrt_mutex_unlock(&shard->m_lock);
 
     /* Schedule freeing of memory until after all those who may have found a pointer have
      progressed to where they no longer hold that pointer */
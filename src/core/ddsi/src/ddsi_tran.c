@@ -36,7 +36,11 @@ extern inline int ddsi_listener_locator (struct ddsi_tran_listener * listener, d
 extern inline int ddsi_listener_listen (struct ddsi_tran_listener * listener);
 extern inline struct ddsi_tran_conn * ddsi_listener_accept (struct ddsi_tran_listener * listener);
 extern inline ssize_t ddsi_conn_read (struct ddsi_tran_conn * conn, unsigned char * buf, size_t len, bool allow_spurious, struct ddsi_network_packet_info *pktinfo);
+extern inline ssize_t ddsi_conn_read_batch (struct ddsi_tran_conn * conn, struct ddsi_tran_read_batch_elem *elems, size_t n);
+extern inline void ddsi_conn_read_done (struct ddsi_tran_conn * conn, ddsrt_msghdr_t *msghdr, unsigned char *buf, size_t len, size_t nrecv, struct ddsi_network_packet_info *pktinfo);
 extern inline ssize_t ddsi_conn_write (struct ddsi_tran_conn * conn, const ddsi_locator_t *dst, const ddsi_tran_write_msgfrags_t *msgfrags, uint32_t flags);
+extern inline size_t ddsi_conn_write_multi (struct ddsi_tran_conn * conn, size_t ndst, const ddsi_locator_t *dsts, const ddsi_tran_write_msgfrags_t *msgfrags, uint32_t flags);
+extern inline ssize_t ddsi_conn_write_zerocopy (struct ddsi_tran_conn * conn, const ddsi_locator_t *dst, const ddsi_tran_write_msgfrags_t *msgfrags, uint32_t flags, struct ddsi_tran_zerocopy_ref *ref);
 extern inline uint32_t ddsi_tran_get_locator_port (const struct ddsi_tran_factory *factory, const ddsi_locator_t *loc);
 extern inline void ddsi_tran_set_locator_port (const struct ddsi_tran_factory *factory, ddsi_locator_t *loc, uint32_t port);
 extern inline uint32_t ddsi_tran_get_locator_aux (const struct ddsi_tran_factory *factory, const ddsi_locator_t *loc);
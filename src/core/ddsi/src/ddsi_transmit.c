@@ -31,6 +31,7 @@
 #include "ddsi__xevent.h"
 #include "ddsi__transmit.h"
 #include "ddsi__hbcontrol.h"
+#include "ddsi__pacing.h"
 #include "ddsi__receive.h"
 #include "ddsi__lease.h"
 #include "ddsi__security_omg.h"
@@ -39,6 +40,7 @@
 #include "ddsi__endpoint_match.h"
 #include "ddsi__protocol.h"
 #include "ddsi__vendor.h"
+#include "ddsi__content_filter.h"
 #include "dds__whc.h"
 
 static const struct ddsi_wr_prd_match *root_rdmatch (const struct ddsi_writer *wr)
@@ -288,6 +290,85 @@ dds_return_t ddsi_create_fragment_message (struct ddsi_writer *wr, ddsi_seqno_t
   return ret;
 }
 
+static dds_return_t create_fragment_parity_message (struct ddsi_writer *wr, ddsi_seqno_t seq, struct ddsi_serdata *serdata, uint32_t fragnum, uint16_t nfrags_per_unit, uint16_t nunits, struct ddsi_xmsg **pmsg)
+{
+  /* The parity covers NUNITS consecutive blocks of NFRAGS_PER_UNIT
+     fragments, i.e., exactly what went into NUNITS DataFrag submessages
+     for a new sample.  Packet loss means losing entire submessages, and
+     so that's what one parity block can restore. */
+  const size_t expected_inline_qos_size = /* statusinfo */ 8 + /* keyhash */ 20 + /* sentinel */ 4;
+  struct ddsi_domaingv const * const gv = wr->e.gv;
+  const uint32_t size = ddsi_serdata_size (serdata);
+  const uint32_t unitsize = (uint32_t) nfrags_per_unit * gv->config.fragment_size;
+  const uint32_t fragstart = fragnum * gv->config.fragment_size;
+  struct ddsi_xmsg_marker sm_marker, pl_marker;
+  ddsi_rtps_datafrag_parity_t *par;
+  unsigned char *parity;
+
+  ASSERT_MUTEX_HELD (&wr->e.lock);
+  assert (serdata->kind != SDK_EMPTY);
+  assert (fragstart < size && nunits > 0);
+  const uint32_t paritysize = (size - fragstart < unitsize) ? size - fragstart : unitsize;
+
+  if ((*pmsg = ddsi_xmsg_new (gv->xmsgpool, &wr->e.guid, wr->c.pp, sizeof (ddsi_rtps_info_ts_t) + sizeof (ddsi_rtps_datafrag_parity_t) + expected_inline_qos_size + paritysize + 3, DDSI_XMSG_KIND_DATA)) == NULL)
+    return DDS_RETCODE_OUT_OF_RESOURCES;
+  ddsi_xmsg_setdst_addrset (*pmsg, wr->as);
+  ddsi_xmsg_setmaxdelay (*pmsg, wr->xqos->latency_budget.duration);
+
+  /* If the parity may stand in for the first fragment, it needs everything
+     the first fragment carries: timestamp, flags and inline QoS */
+  if (fragnum == 0)
+    ddsi_xmsg_add_timestamp (*pmsg, serdata->timestamp);
+
+  par = ddsi_xmsg_append (*pmsg, &sm_marker, sizeof (ddsi_rtps_datafrag_parity_t));
+  ddsi_xmsg_submsg_init (*pmsg, sm_marker, DDSI_RTPS_SMID_CYCLONE_DATAFRAG_PARITY);
+  par->frag.x.smhdr.flags = (unsigned char) (par->frag.x.smhdr.flags | (serdata->kind == SDK_KEY ? DDSI_DATAFRAG_FLAG_KEYFLAG : 0));
+  par->frag.x.extraFlags = 0;
+  par->frag.x.octetsToInlineQos = (unsigned short) ((char*) (par+1) - ((char*) &par->frag.x.octetsToInlineQos + 2));
+  par->frag.x.readerId = ddsi_to_entityid (DDSI_ENTITYID_UNKNOWN);
+  par->frag.x.writerId = ddsi_hton_entityid (wr->e.guid.entityid);
+  par->frag.x.writerSN = ddsi_to_seqno (seq);
+  par->frag.fragmentStartingNum = fragnum + 1;
+  /* A short parity block means a group of one short block at the end of the
+     sample, which the receiver only accepts if the fragment count matches */
+  par->frag.fragmentsInSubmessage = (uint16_t) ((paritysize + gv->config.fragment_size - 1) / gv->config.fragment_size);
+  par->frag.fragmentSize = gv->config.fragment_size;
+  par->frag.sampleSize = size;
+  par->unitsInGroup = nunits;
+  par->unused = 0;
+
+  if (fragnum == 0)
+  {
+    /* Adding parameters means potential reallocing, so par likely becomes invalid */
+    if (wr->num_readers_requesting_keyhash > 0)
+      ddsi_xmsg_addpar_keyhash (*pmsg, serdata, wr->force_md5_keyhash);
+    if (serdata->statusinfo)
+      ddsi_xmsg_addpar_statusinfo (*pmsg, serdata->statusinfo);
+    if (ddsi_xmsg_addpar_sentinel_ifparam (*pmsg) > 0)
+    {
+      par = ddsi_xmsg_submsg_from_marker (*pmsg, sm_marker);
+      par->frag.x.smhdr.flags |= DDSI_DATAFRAG_FLAG_INLINE_QOS;
+    }
+  }
+
+  const uint32_t paritysize4 = (paritysize + 3) & ~(uint32_t) 3;
+  parity = ddsi_xmsg_append (*pmsg, &pl_marker, paritysize4);
+  memset (parity, 0, paritysize4);
+  for (uint32_t u = 0, off = fragstart; u < nunits && off < size; u++, off += unitsize)
+  {
+    const uint32_t len = (size - off < paritysize) ? size - off : paritysize;
+    ddsrt_iovec_t iov;
+    struct ddsi_serdata *ref = ddsi_serdata_to_ser_ref (serdata, off, len, &iov);
+    const unsigned char *src = iov.iov_base;
+    assert (iov.iov_len >= len);
+    for (uint32_t i = 0; i < len; i++)
+      parity[i] ^= src[i];
+    ddsi_serdata_to_ser_unref (ref, &iov);
+  }
+  ddsi_xmsg_submsg_setnext (*pmsg, sm_marker);
+  return 0;
+}
+
 static void create_HeartbeatFrag (struct ddsi_writer *wr, ddsi_seqno_t seq, unsigned fragnum, struct ddsi_proxy_reader *prd, struct ddsi_xmsg **pmsg)
 {
   struct ddsi_domaingv const * const gv = wr->e.gv;
@@ -377,6 +458,14 @@ static int must_skip_frag (const char *frags_to_skip, unsigned frag)
 }
 #endif
 
+static bool use_fec (const struct ddsi_writer *wr)
+{
+  /* Parity is computed over the plain payload and so can't be used when the
+     payload or the submessages get encoded */
+  return wr->fec && wr->num_readers_accepting_fec > 0 &&
+    !ddsi_omg_writer_is_submessage_protected (wr) && !ddsi_omg_writer_is_payload_protected (wr);
+}
+
 static void transmit_sample_lgmsg_unlocks_wr (struct ddsi_xpack *xp, struct ddsi_writer *wr, ddsi_seqno_t seq, struct ddsi_serdata *serdata, struct ddsi_proxy_reader *prd, int isnew, uint32_t nfrags, uint32_t nfrags_lim)
 {
 #if 0
@@ -389,10 +478,24 @@ static void transmit_sample_lgmsg_unlocks_wr (struct ddsi_xpack *xp, struct ddsi
     nf_in_submsg = 1;
   else if (nf_in_submsg > UINT16_MAX)
     nf_in_submsg = UINT16_MAX;
+  /* Parity only for the initial transmission to all readers (retransmits are
+     directed at a reader that already told us what it is missing) and only
+     if it takes multiple DataFrags (else the parity would be a copy).  The
+     groups are balanced so that the last one isn't much smaller than the
+     others. */
+  const uint32_t nf_per_unit = nf_in_submsg;
+  const uint32_t nunits = (nfrags_lim + nf_per_unit - 1) / nf_per_unit;
+  uint32_t fec_group_size = 0, fec_group_start = 0, fec_nunits = 0;
+  if (isnew && prd == NULL && nunits > 1 && use_fec (wr))
+  {
+    const uint32_t ngroups = (nunits + wr->e.gv->config.fec_group_size - 1) / wr->e.gv->config.fec_group_size;
+    fec_group_size = (nunits + ngroups - 1) / ngroups;
+  }
   for (uint32_t i = 0; i < nfrags_lim; i += nf_in_submsg)
   {
     struct ddsi_xmsg *fmsg = NULL;
     struct ddsi_xmsg *hmsg = NULL;
+    struct ddsi_xmsg *pmsg = NULL;
     int ret;
 #if 0
     if (must_skip_frag (frags_to_skip, i))
@@ -412,10 +515,18 @@ static void transmit_sample_lgmsg_unlocks_wr (struct ddsi_xpack *xp, struct ddsi
       // more fragment messages to come
       create_HeartbeatFrag (wr, seq, i + nf_in_submsg - 1, prd, &hmsg);
     }
+    if (fec_group_size > 0 && ++fec_nunits == 1)
+      fec_group_start = i;
+    if (fec_nunits > 0 && (fec_nunits == fec_group_size || i + nf_in_submsg >= nfrags_lim))
+    {
+      (void) create_fragment_parity_message (wr, seq, serdata, fec_group_start, (uint16_t) nf_per_unit, (uint16_t) fec_nunits, &pmsg);
+      fec_nunits = 0;
+    }
     ddsrt_mutex_unlock (&wr->e.lock);
 
     if(fmsg) ddsi_xpack_addmsg (xp, fmsg, 0);
     if(hmsg) ddsi_xpack_addmsg (xp, hmsg, 0);
+    if(pmsg) ddsi_xpack_addmsg (xp, pmsg, 0);
 
     ddsrt_mutex_lock (&wr->e.lock);
   }
@@ -726,6 +837,76 @@ static dds_return_t throttle_writer (struct ddsi_thread_state * const thrst, str
   return result;
 }
 
+static bool writer_is_paced (const struct ddsi_writer *wr)
+{
+  /* Without reliable readers there are no ACKNACKs to adjust the rate, and
+     nothing that suffers from sending too fast. */
+  return wr->pacing.enabled && wr->num_reliable_readers > 0;
+}
+
+static dds_return_t pace_writer (struct ddsi_thread_state * const thrst, struct ddsi_xpack *xp, struct ddsi_writer *wr, uint32_t size, int gc_allowed)
+{
+  /* Waits until the writer's token bucket allows sending new data, sleeping
+     on the writer's condition variable without updating the thread's vtime,
+     like throttle_writer.  Unlike throttle_writer, any number of threads may
+     be waiting here at the same time, and it doesn't set "throttling" as that
+     would change the heartbeat rate.  The number of waiters is tracked
+     separately so that deleting the writer can wait for them to leave.  The
+     bucket is allowed to go into debt by one sample, so a large sample is
+     delayed only by its predecessors.  If GC is not allowed we must not
+     block, and the sample just takes its tokens. */
+  struct ddsi_domaingv const * const gv = wr->e.gv;
+  dds_return_t result = DDS_RETCODE_OK;
+  ddsrt_mtime_t tnow = ddsrt_time_monotonic ();
+  int64_t delay;
+
+  ASSERT_MUTEX_HELD (&wr->e.lock);
+  assert (writer_is_paced (wr));
+  if (gc_allowed && (delay = ddsi_pacing_delay (&wr->pacing, gv, tnow)) > 0)
+  {
+    const ddsrt_mtime_t pace_start = tnow;
+    const ddsrt_mtime_t abstimeout = ddsrt_mtime_add_duration (pace_start, wr->xqos->reliability.max_blocking_time);
+    wr->pacing.waiters++;
+
+    /* Anything still in the packet was sent at the permitted rate and delaying
+       it further only delays the heartbeat it may contain */
+    if (xp)
+    {
+      ddsrt_mutex_unlock (&wr->e.lock);
+      ddsi_xpack_send (xp, true);
+      ddsrt_mutex_lock (&wr->e.lock);
+    }
+
+    /* Readers may disappear while waiting */
+    while (ddsrt_atomic_ld32 (&gv->rtps_keepgoing) && wr->state == WRST_OPERATIONAL && writer_is_paced (wr))
+    {
+      tnow = ddsrt_time_monotonic ();
+      if ((delay = ddsi_pacing_delay (&wr->pacing, gv, tnow)) == 0)
+        break;
+      if (tnow.v + delay > abstimeout.v)
+      {
+        result = DDS_RETCODE_TIMEOUT;
+        break;
+      }
+      ddsi_thread_state_asleep (thrst);
+      (void) ddsrt_cond_waitfor (&wr->throttle_cond, &wr->e.lock, delay);
+      ddsi_thread_state_awake_domain_ok (thrst);
+    }
+
+    assert (wr->pacing.waiters > 0);
+    wr->pacing.waiters--;
+    wr->pacing.time_paced += (uint64_t) (ddsrt_time_monotonic ().v - pace_start.v);
+    if (wr->state != WRST_OPERATIONAL)
+    {
+      /* gc_delete_writer may be waiting */
+      ddsrt_cond_broadcast (&wr->throttle_cond);
+    }
+  }
+  if (result == DDS_RETCODE_OK)
+    ddsi_pacing_consume (&wr->pacing, size);
+  return result;
+}
+
 static int maybe_grow_whc (struct ddsi_writer *wr)
 {
   struct ddsi_domaingv const * const gv = wr->e.gv;
@@ -875,6 +1056,14 @@ static int write_sample (struct ddsi_thread_state * const thrst, struct ddsi_xpa
     }
   }
 
+  /* If sending new data is paced, wait for our turn. */
+  if (writer_is_paced (wr) && pace_writer (thrst, xp, wr, ddsi_serdata_size (serdata), gc_allowed) == DDS_RETCODE_TIMEOUT)
+  {
+    ddsrt_mutex_unlock (&wr->e.lock);
+    r = DDS_RETCODE_TIMEOUT;
+    goto drop;
+  }
+
   if (wr->state != WRST_OPERATIONAL)
   {
     r = DDS_RETCODE_PRECONDITION_NOT_MET;
@@ -895,6 +1084,7 @@ static int write_sample (struct ddsi_thread_state * const thrst, struct ddsi_xpa
   else if (wr->test_drop_outgoing_data)
   {
     GVTRACE ("test_drop_outgoing_data");
+    wr->filtered_gap_start = 0;
     ddsi_writer_update_seq_xmit (wr, seq);
     ddsrt_mutex_unlock (&wr->e.lock);
   }
@@ -909,8 +1099,27 @@ static int write_sample (struct ddsi_thread_state * const thrst, struct ddsi_xpa
     ddsi_writer_update_seq_xmit (wr, seq);
     ddsrt_mutex_unlock (&wr->e.lock);
   }
+  else if (ddsi_writer_content_filter_rejects (wr, serdata))
+  {
+    /* All matched readers have a content filter and none of them is interested
+       in this sample.  Treat it as transmitted, so that it gets a GAP on a
+       retransmit request, and remember it so that a GAP for it can be sent
+       along with the next sample that does get sent, saving the readers a
+       round-trip before they can deliver that one. */
+    ETRACE (wr, "write_sample "PGUIDFMT" #%"PRIu64" filtered\n", PGUID (wr->e.guid), seq);
+    if (wr->filtered_gap_start == 0)
+      wr->filtered_gap_start = seq;
+    wr->filtered_count++;
+    ddsi_writer_update_seq_xmit (wr, seq);
+    if (wr->heartbeat_xevent)
+      ddsi_writer_hbcontrol_note_asyncwrite (wr, tnow);
+    ddsrt_mutex_unlock (&wr->e.lock);
+  }
   else
   {
+    if (wr->filtered_gap_start != 0)
+      ddsi_writer_send_filtered_gaps (wr, seq);
+
     /* Note the subtlety of enqueueing with the lock held but
        transmitting without holding the lock. Still working on
        cleaning that up. */
@@ -949,6 +1158,87 @@ int ddsi_write_sample_gc (struct ddsi_thread_state * const thrst, struct ddsi_xp
   return write_sample (thrst, xp, wr, serdata, tk, 1);
 }
 
+static bool write_sample_may_batch (const struct ddsi_writer *wr, const struct ddsi_serdata *serdata)
+{
+  /* Only samples that fit in a single DATA submessage are batched, anything else
+     is rare enough to not bother */
+  struct ddsi_domaingv const * const gv = wr->e.gv;
+  const uint32_t sz = ddsi_serdata_size (serdata);
+  return sz <= gv->config.fragment_size && sz <= gv->config.max_sample_size && !ddsi_omg_writer_is_submessage_protected (wr);
+}
+
+void ddsi_write_samples_gc (struct ddsi_thread_state * const thrst, struct ddsi_xpack *xp, struct ddsi_writer *wr, uint32_t n, struct ddsi_serdata * const *serdata, struct ddsi_tkmap_instance * const *tk, int *results)
+{
+  struct ddsi_lease *lease;
+  uint32_t i = 0;
+
+  if (xp == NULL)
+  {
+    for (i = 0; i < n; i++)
+      results[i] = write_sample (thrst, xp, wr, serdata[i], tk[i], 1);
+    return;
+  }
+
+  if (wr->xqos->liveliness.kind == DDS_LIVELINESS_MANUAL_BY_PARTICIPANT && ((lease = ddsrt_atomic_ldvoidp (&wr->c.pp->minl_man)) != NULL))
+    ddsi_lease_renew (lease, ddsrt_time_elapsed());
+  else if (wr->xqos->liveliness.kind == DDS_LIVELINESS_MANUAL_BY_TOPIC && wr->lease != NULL)
+    ddsi_lease_renew (wr->lease, ddsrt_time_elapsed());
+
+  while (i < n)
+  {
+    /* Runs of samples are handled with the lock held throughout, with a heartbeat only
+       following the last one.  Anything that may require throttling, pacing,
+       fragmenting, protection, dropping or writer-side content filtering is left to
+       write_sample, which also makes it the one handling the sample that ends the run.
+       The latter includes a pending GAP for filtered samples: that one must be sent
+       before any later sample, or it would cover samples sent in the run. */
+    struct ddsi_whc_state whcst;
+    ddsi_seqno_t seq = 0;
+    ddsrt_mutex_lock (&wr->e.lock);
+    if (!wr->alive)
+      ddsi_writer_set_alive_may_unlock (wr, true);
+    const ddsrt_mtime_t tnow = ddsrt_time_monotonic ();
+    const bool transmit = !wr->test_drop_outgoing_data && !ddsi_addrset_empty (wr->as);
+    ddsi_whc_get_state (wr->whc, &whcst);
+    while (i < n && whcst.unacked_bytes <= wr->whc_high && wr->state == WRST_OPERATIONAL && write_sample_may_batch (wr, serdata[i]) &&
+           wr->num_readers_content_filtered == 0 && wr->filtered_gap_start == 0 &&
+           (!writer_is_paced (wr) || ddsi_pacing_delay (&wr->pacing, wr->e.gv, tnow) == 0))
+    {
+      if (writer_is_paced (wr))
+        ddsi_pacing_consume (&wr->pacing, ddsi_serdata_size (serdata[i]));
+      serdata[i]->twrite = tnow;
+      seq = ++wr->seq;
+      if ((results[i] = insert_sample_in_whc (wr, seq, serdata[i], tk[i])) >= 0)
+      {
+        struct ddsi_xmsg *fmsg;
+        if (!transmit)
+          ddsi_writer_update_seq_xmit (wr, seq);
+        else if (ddsi_create_fragment_message_simple (wr, seq, serdata[i], &fmsg) >= 0)
+          ddsi_xpack_addmsg (xp, fmsg, 0);
+      }
+      ddsi_serdata_unref (serdata[i]);
+      i++;
+      ddsi_whc_get_state (wr->whc, &whcst);
+    }
+
+    struct ddsi_xmsg *hmsg = NULL;
+    enum ddsi_hbcontrol_ack_required hbansreq = DDSI_HBC_ACK_REQ_NO;
+    if (seq != 0 && transmit && wr->heartbeat_xevent)
+      hmsg = ddsi_writer_hbcontrol_piggyback (wr, &whcst, tnow, ddsi_xpack_packetid (xp), &hbansreq);
+    ddsrt_mutex_unlock (&wr->e.lock);
+    if (hmsg)
+      ddsi_xpack_addmsg (xp, hmsg, 0);
+    if (hbansreq >= DDSI_HBC_ACK_REQ_YES_AND_FLUSH)
+      ddsi_xpack_send (xp, true);
+
+    if (i < n)
+    {
+      results[i] = write_sample (thrst, xp, wr, serdata[i], tk[i], 1);
+      i++;
+    }
+  }
+}
+
 int ddsi_write_sample_nogc (struct ddsi_thread_state * const thrst, struct ddsi_xpack *xp, struct ddsi_writer *wr, struct ddsi_serdata *serdata, struct ddsi_tkmap_instance *tk)
 {
   return write_sample (thrst, xp, wr, serdata, tk, 0);
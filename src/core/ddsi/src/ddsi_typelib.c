@@ -221,6 +221,11 @@ const char * ddsi_typemap_get_type_name (const ddsi_typemap_t *typemap, const dd
   return ddsi_typeobj_get_type_name_impl (type_obj);
 }
 
+const struct DDS_XTypes_TypeObject * ddsi_typemap_get_typeobj (const ddsi_typemap_t *typemap, const ddsi_typeid_t *type_id)
+{
+  return ddsi_typemap_typeobj (typemap, &type_id->x);
+}
+
 ddsi_typemap_t *ddsi_typemap_deser (const unsigned char *data, uint32_t sz)
 {
   unsigned char *data_norm;
@@ -35,6 +35,11 @@
 #include "ddsi__mcgroup.h"
 #include "ddsi__pcap.h"
 
+#if defined __linux
+#include <linux/filter.h>
+#include <linux/errqueue.h>
+#endif
+
 // Make sure that the size of the index that can be stored in a cover_info_t fits in the UDP multicast address range
 #define UDP_MC_ADDRESS_PREFIX_BITS 4
 DDSRT_STATIC_ASSERT (DDSI_LOCATOR_UDPv4MCGEN_INDEX_MASK_BITS <= 32 - UDP_MC_ADDRESS_PREFIX_BITS);
@@ -59,6 +64,12 @@ DDSRT_STATIC_ASSERT (DDSI_LOCATOR_UDPv4MCGEN_INDEX_MASK_BITS <= 32 - UDP_MC_ADDR
 #  endif
 #endif
 
+#if defined __linux && defined SO_ZEROCOPY && defined MSG_ZEROCOPY && defined SO_EE_ORIGIN_ZEROCOPY
+#define UDP_ZEROCOPY 1
+#else
+#define UDP_ZEROCOPY 0
+#endif
+
 union addr {
   struct sockaddr_storage x;
   struct sockaddr a;
@@ -75,8 +86,37 @@ typedef struct ddsi_udp_conn {
   WSAEVENT m_sockEvent;
 #endif
   int m_diffserv;
+#if UDP_ZEROCOPY
+  struct ddsi_udp_zerocopy *m_zerocopy; // null pointer if zero-copy writes are not enabled
+#endif
 } *ddsi_udp_conn_t;
 
+#if UDP_ZEROCOPY
+// Limit on the number of zero-copy writes awaiting completion, beyond that the data
+// gets copied.  The kernel imposes a limit of its own (via net.core.optmem_max) and
+// that one will typically be hit first.
+#define UDP_ZEROCOPY_MAX_PENDING 4096u
+
+// The kernel falls back to copying if the interface can't send directly from the
+// application's memory (e.g., loopback, or if IP fragmentation is needed), and that
+// is more expensive than an ordinary write.  Once that happens, ordinary writes are
+// used for a while before trying again.
+#define UDP_ZEROCOPY_BACKOFF 1024u
+
+// The kernel numbers zero-copy writes on a socket consecutively and reports ranges of
+// completed ones via the error queue.  The writes awaiting completion are kept in
+// order, the one with number first_id is at index "first".  Completions may be
+// reported out of order, entries of completed writes are cleared until all preceding
+// ones have completed, too.
+struct ddsi_udp_zerocopy {
+  ddsrt_mutex_t lock;
+  uint32_t first_id;
+  uint32_t first, count, size; // size is a power of 2
+  uint32_t backoff; // number of writes still to be done by copying
+  struct ddsi_tran_zerocopy_ref **pending;
+};
+#endif
+
 typedef struct ddsi_udp_tran_factory {
   struct ddsi_tran_factory fact;
   int32_t m_kind;
@@ -151,59 +191,44 @@ static void translate_pktinfo (struct ddsi_network_packet_info *pktinfo, ddsrt_m
   pktinfo->if_index = 0;
 }
 
-static ssize_t ddsi_udp_conn_read (struct ddsi_tran_conn * conn_cmn, unsigned char * buf, size_t len, bool allow_spurious, struct ddsi_network_packet_info *pktinfo)
-{
-  ddsi_udp_conn_t conn = (ddsi_udp_conn_t) conn_cmn;
-  struct ddsi_domaingv * const gv = conn->m_base.m_base.gv;
-  union addr src;
 #if PACKET_DESTINATION_INFO
-  union in_pktinfo_4_6 {
+union in_pktinfo_4_6 {
 #if defined IP_PKTINFO
-    struct in_pktinfo ip4;
+  struct in_pktinfo ip4;
 #endif
 #if DDSRT_HAVE_IPV6 && defined IPV6_PKTINFO
-    struct in6_pktinfo ip6;
+  struct in6_pktinfo ip6;
 #endif
-  };
-  char incmsg[CMSG_SPACE (sizeof (union in_pktinfo_4_6))];
+};
+#define UDP_INCMSG_SIZE CMSG_SPACE (sizeof (union in_pktinfo_4_6))
 #endif // PACKET_DESTINATION_INFO
-  ddsrt_iovec_t msg_iov = {
-    .iov_base = (void *) buf,
-    .iov_len = (ddsrt_iov_len_t) len /* Windows uses unsigned, POSIX (except Linux) int */
-  };
-  ddsrt_msghdr_t msghdr = {
-    .msg_name = &src.x,
-    .msg_namelen = (socklen_t) sizeof (src),
-    .msg_iov = &msg_iov,
-    .msg_iovlen = 1
+
+static void ddsi_udp_conn_init_msghdr (ddsrt_msghdr_t *msghdr, union addr *src, ddsrt_iovec_t *msg_iov, unsigned char *buf, size_t len, void *incmsg)
+{
+  msg_iov->iov_base = (void *) buf;
+  msg_iov->iov_len = (ddsrt_iov_len_t) len; /* Windows uses unsigned, POSIX (except Linux) int */
+  memset (msghdr, 0, sizeof (*msghdr));
+  msghdr->msg_name = &src->x;
+  msghdr->msg_namelen = (socklen_t) sizeof (*src);
+  msghdr->msg_iov = msg_iov;
+  msghdr->msg_iovlen = 1;
 #if PACKET_DESTINATION_INFO
-    ,
-      .msg_controllen = sizeof (incmsg),
-      .msg_control = incmsg
+  msghdr->msg_controllen = UDP_INCMSG_SIZE;
+  msghdr->msg_control = incmsg;
+#else
+  (void) incmsg;
 #endif // PACKET_DESTINATION_INFO
-    // accrights/control implicitly initialised to 0
-    // msg_flags is an out parameter anyway
-  };
-  (void) allow_spurious;
-
-  dds_return_t rc;
-  ssize_t nrecv;
-  do {
-    rc = ddsrt_recvmsg (&conn->m_sockext, &msghdr, 0, &nrecv);
-  } while (rc == DDS_RETCODE_INTERRUPTED);
-
-  if (rc != DDS_RETCODE_OK)
-  {
-    if (rc != DDS_RETCODE_BAD_PARAMETER && rc != DDS_RETCODE_NO_CONNECTION)
-      GVERROR ("UDP recvmsg sock %d: ret %d retcode %"PRId32"\n", (int) conn->m_sockext.sock, (int) nrecv, rc);
-    return -1;
-  }
+  // accrights/control implicitly initialised to 0
+  // msg_flags is an out parameter anyway
+}
 
-  assert (rc == DDS_RETCODE_OK && nrecv >= 0);
+static void ddsi_udp_conn_read_done (ddsi_udp_conn_t conn, const union addr *src, ddsrt_msghdr_t *msghdr, unsigned char *buf, size_t len, size_t nrecv, struct ddsi_network_packet_info *pktinfo)
+{
+  struct ddsi_domaingv * const gv = conn->m_base.m_base.gv;
   if (pktinfo)
   {
-    addr_to_loc (conn->m_base.m_factory, &pktinfo->src, &src);
-    translate_pktinfo (pktinfo, &msghdr, conn->m_base.m_base.m_port, src.a.sa_family == AF_INET6);
+    addr_to_loc (conn->m_base.m_factory, &pktinfo->src, src);
+    translate_pktinfo (pktinfo, msghdr, conn->m_base.m_base.m_port, src->a.sa_family == AF_INET6);
   }
 
   if (gv->pcap_fp)
@@ -212,36 +237,224 @@ static ssize_t ddsi_udp_conn_read (struct ddsi_tran_conn * conn_cmn, unsigned ch
     socklen_t dest_len = sizeof (dest);
     if (ddsrt_getsockname (conn->m_sockext.sock, &dest.a, &dest_len) != DDS_RETCODE_OK)
       memset (&dest, 0, sizeof (dest));
-    ddsi_write_pcap_received (gv, ddsrt_time_wallclock (), &src.x, &dest.x, buf, (size_t) nrecv);
+    ddsi_write_pcap_received (gv, ddsrt_time_wallclock (), &src->x, &dest.x, buf, nrecv);
   }
 
   /* Check for udp packet truncation */
 #if ! DDSRT_MSGHDR_FLAGS
   const bool trunc_flag = false;
 #elif defined MSG_CTRUNC
-  const bool trunc_flag = (msghdr.msg_flags & (MSG_TRUNC | MSG_CTRUNC)) != 0;
+  const bool trunc_flag = (msghdr->msg_flags & (MSG_TRUNC | MSG_CTRUNC)) != 0;
 #else
-  const bool trunc_flag = (msghdr.msg_flags & MSG_TRUNC) != 0;
+  const bool trunc_flag = (msghdr->msg_flags & MSG_TRUNC) != 0;
 #endif
-  if ((size_t) nrecv > len || trunc_flag)
+  if (nrecv > len || trunc_flag)
   {
     char addrbuf[DDSI_LOCSTRLEN];
     ddsi_locator_t tmp;
-    addr_to_loc (conn->m_base.m_factory, &tmp, &src);
+    addr_to_loc (conn->m_base.m_factory, &tmp, src);
     ddsi_locator_to_string (addrbuf, sizeof (addrbuf), &tmp);
     GVWARNING ("%s => %d truncated to %d\n", addrbuf, (int) nrecv, (int) len);
   }
+}
+
+#if UDP_ZEROCOPY
+static void ddsi_udp_zerocopy_complete (struct ddsi_udp_zerocopy *zc, uint32_t lo, uint32_t hi, bool copied)
+{
+  // range is inclusive and both ends are of writes that are pending
+  const uint32_t a = lo - zc->first_id, b = hi - zc->first_id;
+  if (copied)
+    zc->backoff = UDP_ZEROCOPY_BACKOFF;
+  for (uint32_t idx = a; idx <= b && idx < zc->count; idx++)
+  {
+    struct ddsi_tran_zerocopy_ref ** const p = &zc->pending[(zc->first + idx) & (zc->size - 1)];
+    if (*p != NULL)
+    {
+      (*p)->done (*p, copied);
+      *p = NULL;
+    }
+  }
+  while (zc->count > 0 && zc->pending[zc->first] == NULL)
+  {
+    zc->first = (zc->first + 1) & (zc->size - 1);
+    zc->first_id++;
+    zc->count--;
+  }
+}
+
+static void ddsi_udp_zerocopy_reap_locked (ddsi_udp_conn_t conn)
+{
+  struct ddsi_udp_zerocopy * const zc = conn->m_zerocopy;
+  // the error is followed by the address of the "offender", but that is irrelevant here
+  union {
+    struct cmsghdr align;
+    unsigned char buf[CMSG_SPACE (sizeof (struct sock_extended_err) + sizeof (struct sockaddr_storage))];
+  } control;
+  ddsrt_msghdr_t msg;
+  ssize_t n;
+  while (true)
+  {
+    memset (&msg, 0, sizeof (msg));
+    msg.msg_control = &control;
+    msg.msg_controllen = sizeof (control);
+    if (ddsrt_recvmsg (&conn->m_sockext, &msg, MSG_ERRQUEUE | MSG_DONTWAIT, &n) != DDS_RETCODE_OK)
+      break;
+    for (struct cmsghdr *cm = CMSG_FIRSTHDR (&msg); cm != NULL; cm = CMSG_NXTHDR (&msg, cm))
+    {
+      if (!((cm->cmsg_level == IPPROTO_IP && cm->cmsg_type == IP_RECVERR) ||
+            (cm->cmsg_level == IPPROTO_IPV6 && cm->cmsg_type == IPV6_RECVERR)))
+        continue;
+      struct sock_extended_err ee;
+      memcpy (&ee, CMSG_DATA (cm), sizeof (ee));
+      if (ee.ee_origin == SO_EE_ORIGIN_ZEROCOPY && ee.ee_errno == 0)
+        ddsi_udp_zerocopy_complete (zc, ee.ee_info, ee.ee_data, (ee.ee_code & SO_EE_CODE_ZEROCOPY_COPIED) != 0);
+    }
+  }
+}
+
+static void ddsi_udp_zerocopy_reap (ddsi_udp_conn_t conn)
+{
+  ddsrt_mutex_lock (&conn->m_zerocopy->lock);
+  ddsi_udp_zerocopy_reap_locked (conn);
+  ddsrt_mutex_unlock (&conn->m_zerocopy->lock);
+}
+
+static bool ddsi_udp_zerocopy_reserve (struct ddsi_udp_zerocopy *zc)
+{
+  if (zc->count < zc->size)
+    return true;
+  else if (zc->size == UDP_ZEROCOPY_MAX_PENDING)
+    return false;
+  else
+  {
+    // grow, moving the entries to the start so the ring doesn't wrap around
+    struct ddsi_tran_zerocopy_ref **pending = ddsrt_malloc (2 * zc->size * sizeof (*pending));
+    for (uint32_t i = 0; i < zc->count; i++)
+      pending[i] = zc->pending[(zc->first + i) & (zc->size - 1)];
+    ddsrt_free (zc->pending);
+    zc->pending = pending;
+    zc->first = 0;
+    zc->size *= 2;
+    return true;
+  }
+}
+#endif
+
+// Completion notifications for zero-copy writes arrive on the socket's error queue and
+// wake up the receive thread without there necessarily being any data, therefore such
+// a socket must not block in reads.  Returns the flags to pass to recvmsg.
+static int ddsi_udp_conn_prep_read (ddsi_udp_conn_t conn)
+{
+#if UDP_ZEROCOPY
+  if (conn->m_zerocopy)
+  {
+    ddsi_udp_zerocopy_reap (conn);
+    return MSG_DONTWAIT;
+  }
+#else
+  (void) conn;
+#endif
+  return 0;
+}
+
+static ssize_t ddsi_udp_conn_read (struct ddsi_tran_conn * conn_cmn, unsigned char * buf, size_t len, bool allow_spurious, struct ddsi_network_packet_info *pktinfo)
+{
+  ddsi_udp_conn_t conn = (ddsi_udp_conn_t) conn_cmn;
+  struct ddsi_domaingv * const gv = conn->m_base.m_base.gv;
+  union addr src;
+#if PACKET_DESTINATION_INFO
+  char incmsg[UDP_INCMSG_SIZE];
+#else
+  char * const incmsg = NULL;
+#endif
+  ddsrt_iovec_t msg_iov;
+  ddsrt_msghdr_t msghdr;
+  ddsi_udp_conn_init_msghdr (&msghdr, &src, &msg_iov, buf, len, incmsg);
+  (void) allow_spurious;
+
+  const int recvflags = ddsi_udp_conn_prep_read (conn);
+  dds_return_t rc;
+  ssize_t nrecv;
+  do {
+    rc = ddsrt_recvmsg (&conn->m_sockext, &msghdr, recvflags, &nrecv);
+  } while (rc == DDS_RETCODE_INTERRUPTED);
+
+  if (rc == DDS_RETCODE_TRY_AGAIN && recvflags != 0)
+    return 0;
+  else if (rc != DDS_RETCODE_OK)
+  {
+    if (rc != DDS_RETCODE_BAD_PARAMETER && rc != DDS_RETCODE_NO_CONNECTION)
+      GVERROR ("UDP recvmsg sock %d: ret %d retcode %"PRId32"\n", (int) conn->m_sockext.sock, (int) nrecv, rc);
+    return -1;
+  }
+
+  assert (rc == DDS_RETCODE_OK && nrecv >= 0);
+  ddsi_udp_conn_read_done (conn, &src, &msghdr, buf, len, (size_t) nrecv, pktinfo);
   return nrecv;
 }
 
-static ssize_t ddsi_udp_conn_write (struct ddsi_tran_conn * conn_cmn, const ddsi_locator_t *dst, const ddsi_tran_write_msgfrags_t *msgfrags, uint32_t flags)
+static ssize_t ddsi_udp_conn_read_batch (struct ddsi_tran_conn * conn_cmn, struct ddsi_tran_read_batch_elem *elems, size_t n)
 {
   ddsi_udp_conn_t conn = (ddsi_udp_conn_t) conn_cmn;
+  struct ddsi_domaingv * const gv = conn->m_base.m_base.gv;
+  union addr src[DDSI_TRAN_MAX_READ_BATCH];
+#if PACKET_DESTINATION_INFO
+  char incmsg[DDSI_TRAN_MAX_READ_BATCH][UDP_INCMSG_SIZE];
+#endif
+  ddsrt_iovec_t msg_iov[DDSI_TRAN_MAX_READ_BATCH];
+  ddsrt_mmsghdr_t msgs[DDSI_TRAN_MAX_READ_BATCH];
+  assert (n > 0 && n <= DDSI_TRAN_MAX_READ_BATCH);
+  for (size_t i = 0; i < n; i++)
+  {
+#if PACKET_DESTINATION_INFO
+    ddsi_udp_conn_init_msghdr (&msgs[i].msg_hdr, &src[i], &msg_iov[i], elems[i].buf, elems[i].len, incmsg[i]);
+#else
+    ddsi_udp_conn_init_msghdr (&msgs[i].msg_hdr, &src[i], &msg_iov[i], elems[i].buf, elems[i].len, NULL);
+#endif
+    msgs[i].msg_len = 0;
+  }
+
+  const int recvflags = ddsi_udp_conn_prep_read (conn);
+  dds_return_t rc;
+  size_t nmsgs;
+  do {
+    rc = ddsrt_recvmmsg (&conn->m_sockext, msgs, n, recvflags, &nmsgs);
+  } while (rc == DDS_RETCODE_INTERRUPTED);
+
+  if (rc == DDS_RETCODE_TRY_AGAIN && recvflags != 0)
+    return 0;
+  else if (rc != DDS_RETCODE_OK)
+  {
+    if (rc != DDS_RETCODE_BAD_PARAMETER && rc != DDS_RETCODE_NO_CONNECTION)
+      GVERROR ("UDP recvmmsg sock %d: retcode %"PRId32"\n", (int) conn->m_sockext.sock, rc);
+    return -1;
+  }
+
+  assert (nmsgs > 0 && nmsgs <= n);
+  for (size_t i = 0; i < nmsgs; i++)
+  {
+    elems[i].sz = msgs[i].msg_len;
+    ddsi_udp_conn_read_done (conn, &src[i], &msgs[i].msg_hdr, elems[i].buf, elems[i].len, elems[i].sz, &elems[i].pktinfo);
+  }
+  return (ssize_t) nmsgs;
+}
+
+static void ddsi_udp_conn_read_done_ext (struct ddsi_tran_conn * conn_cmn, ddsrt_msghdr_t *msghdr, unsigned char *buf, size_t len, size_t nrecv, struct ddsi_network_packet_info *pktinfo)
+{
+  ddsi_udp_conn_t conn = (ddsi_udp_conn_t) conn_cmn;
+  union addr src;
+  // the source address is in memory owned by someone else and need not be aligned
+  memset (&src, 0, sizeof (src));
+  memcpy (&src, msghdr->msg_name, ((size_t) msghdr->msg_namelen < sizeof (src)) ? (size_t) msghdr->msg_namelen : sizeof (src));
+  ddsi_udp_conn_read_done (conn, &src, msghdr, buf, len, nrecv, pktinfo);
+}
+
+static dds_return_t ddsi_udp_conn_sendmsg (ddsi_udp_conn_t conn, const ddsi_locator_t *dst, const ddsi_tran_write_msgfrags_t *msgfrags, uint32_t flags, int sendflags, ssize_t *nsent_out)
+{
   struct ddsi_domaingv * const gv = conn->m_base.m_base.gv;
   dds_return_t rc;
   ssize_t nsent = -1;
   unsigned retry = 2;
-  int sendflags = 0;
 #if defined _WIN32 && !defined WINCE
   ddsrt_mtime_t timeout = DDSRT_MTIME_NEVER;
   ddsrt_mtime_t tnow = { 0 };
@@ -306,12 +519,136 @@ static ssize_t ddsi_udp_conn_write (struct ddsi_tran_conn * conn_cmn, const ddsi
       memset(&sa, 0, sizeof(sa));
     ddsi_write_pcap_sent (gv, ddsrt_time_wallclock (), &sa.x, &msg, (size_t) nsent);
   }
-  else if (rc != DDS_RETCODE_OK && rc != DDS_RETCODE_NOT_ALLOWED && rc != DDS_RETCODE_NO_CONNECTION)
+  *nsent_out = nsent;
+  return rc;
+}
+
+static void ddsi_udp_conn_write_error (ddsi_udp_conn_t conn, const ddsi_locator_t *dst, dds_return_t rc)
+{
+  struct ddsi_domaingv * const gv = conn->m_base.m_base.gv;
+  if (rc != DDS_RETCODE_NOT_ALLOWED && rc != DDS_RETCODE_NO_CONNECTION)
   {
     char locbuf[DDSI_LOCSTRLEN];
     GVERROR ("ddsi_udp_conn_write to %s failed with retcode %"PRId32"\n", ddsi_locator_to_string (locbuf, sizeof (locbuf), dst), rc);
   }
-  return (rc == DDS_RETCODE_OK) ? nsent : -1;
+}
+
+static ssize_t ddsi_udp_conn_write (struct ddsi_tran_conn * conn_cmn, const ddsi_locator_t *dst, const ddsi_tran_write_msgfrags_t *msgfrags, uint32_t flags)
+{
+  ddsi_udp_conn_t conn = (ddsi_udp_conn_t) conn_cmn;
+  dds_return_t rc;
+  ssize_t nsent;
+  if ((rc = ddsi_udp_conn_sendmsg (conn, dst, msgfrags, flags, 0, &nsent)) != DDS_RETCODE_OK)
+  {
+    ddsi_udp_conn_write_error (conn, dst, rc);
+    return -1;
+  }
+  return nsent;
+}
+
+#if UDP_ZEROCOPY
+static ssize_t ddsi_udp_conn_write_zerocopy (struct ddsi_tran_conn * conn_cmn, const ddsi_locator_t *dst, const ddsi_tran_write_msgfrags_t *msgfrags, uint32_t flags, struct ddsi_tran_zerocopy_ref *ref)
+{
+  ddsi_udp_conn_t conn = (ddsi_udp_conn_t) conn_cmn;
+  struct ddsi_udp_zerocopy * const zc = conn->m_zerocopy;
+  dds_return_t rc;
+  ssize_t nsent;
+
+  // The lock is needed to keep the administration in the same order as the kernel
+  // numbers the writes.  Normally the receive thread takes care of the completions,
+  // but if the writes get too far ahead of it, check for them here.
+  ddsrt_mutex_lock (&zc->lock);
+  if (zc->count == zc->size)
+    ddsi_udp_zerocopy_reap_locked (conn);
+  if (zc->backoff > 0)
+    zc->backoff--;
+  else if (ddsi_udp_zerocopy_reserve (zc))
+  {
+    rc = ddsi_udp_conn_sendmsg (conn, dst, msgfrags, flags, MSG_ZEROCOPY, &nsent);
+    if (rc == DDS_RETCODE_OK)
+    {
+      zc->pending[(zc->first + zc->count) & (zc->size - 1)] = ref;
+      zc->count++;
+      ddsrt_mutex_unlock (&zc->lock);
+      return nsent;
+    }
+    else if (rc != DDS_RETCODE_OUT_OF_RESOURCES)
+    {
+      ddsrt_mutex_unlock (&zc->lock);
+      ddsi_udp_conn_write_error (conn, dst, rc);
+      return -1;
+    }
+  }
+  ddsrt_mutex_unlock (&zc->lock);
+
+  // Copying anyway or too many writes pending: an ordinary write, after which the data
+  // is no longer needed
+  if ((rc = ddsi_udp_conn_sendmsg (conn, dst, msgfrags, flags, 0, &nsent)) != DDS_RETCODE_OK)
+  {
+    ddsi_udp_conn_write_error (conn, dst, rc);
+    return -1;
+  }
+  ref->done (ref, true);
+  return nsent;
+}
+#endif
+
+static size_t ddsi_udp_conn_write_multi (struct ddsi_tran_conn * conn_cmn, size_t ndst, const ddsi_locator_t *dsts, const ddsi_tran_write_msgfrags_t *msgfrags, uint32_t flags)
+{
+  ddsi_udp_conn_t conn = (ddsi_udp_conn_t) conn_cmn;
+  struct ddsi_domaingv * const gv = conn->m_base.m_base.gv;
+  union addr dstaddr[DDSI_TRAN_MAX_WRITE_BATCH];
+  ddsrt_mmsghdr_t msgs[DDSI_TRAN_MAX_WRITE_BATCH];
+  size_t i = 0, nok = 0;
+  int sendflags = 0;
+  assert (ndst > 0 && ndst <= DDSI_TRAN_MAX_WRITE_BATCH);
+  assert (msgfrags->niov <= INT_MAX);
+  for (size_t k = 0; k < ndst; k++)
+  {
+    ddsi_ipaddr_from_loc (&dstaddr[k].x, &dsts[k]);
+    msgs[k].msg_hdr = (ddsrt_msghdr_t) {
+      .msg_name = &dstaddr[k].x,
+      .msg_namelen = (socklen_t) ddsrt_sockaddr_get_size (&dstaddr[k].a),
+      .msg_iov = (ddsrt_iovec_t *) msgfrags->iov,
+      .msg_iovlen = (ddsrt_msg_iovlen_t) msgfrags->niov
+#if DDSRT_MSGHDR_FLAGS
+      , .msg_flags = (int) flags
+#endif
+    };
+    msgs[k].msg_len = 0;
+  }
+  (void) flags; // in case ! DDSRT_MSGHDR_FLAGS
+
+#if MSG_NOSIGNAL && !LWIP_SOCKET
+  sendflags |= MSG_NOSIGNAL;
+#endif
+  while (i < ndst)
+  {
+    size_t nsent;
+    if (ddsrt_sendmmsg (conn->m_sockext.sock, &msgs[i], ndst - i, sendflags, &nsent) != DDS_RETCODE_OK)
+    {
+      // The failure is for the first remaining destination: let the single-destination path deal
+      // with retrying and error reporting for that one, then continue with the others
+      if (ddsi_udp_conn_write (conn_cmn, &dsts[i], msgfrags, flags) > 0)
+        nok++;
+      i++;
+    }
+    else
+    {
+      if (gv->pcap_fp)
+      {
+        union addr sa;
+        socklen_t alen = sizeof (sa);
+        if (ddsrt_getsockname (conn->m_sockext.sock, &sa.a, &alen) != DDS_RETCODE_OK)
+          memset(&sa, 0, sizeof(sa));
+        for (size_t k = i; k < i + nsent; k++)
+          ddsi_write_pcap_sent (gv, ddsrt_time_wallclock (), &sa.x, &msgs[k].msg_hdr, msgs[k].msg_len);
+      }
+      nok += nsent;
+      i += nsent;
+    }
+  }
+  return nok;
 }
 
 static void ddsi_udp_disable_multiplexing (struct ddsi_tran_conn * conn_cmn)
@@ -368,6 +705,38 @@ static uint16_t get_socket_port (struct ddsi_domaingv const * const gv, ddsrt_so
   return ddsrt_sockaddr_get_port (&addr.a);
 }
 
+static dds_return_t set_reuse_port (struct ddsi_domaingv const * const gv, ddsrt_socket_t socket)
+{
+  // Only SO_REUSEPORT: unlike SO_REUSEADDR, it distributes the unicast datagrams over
+  // all sockets bound to the port, rather than delivering them all to one of them
+#ifdef SO_REUSEPORT
+  dds_return_t rc;
+  const int one = 1;
+  if ((rc = ddsrt_setsockopt (socket, SOL_SOCKET, SO_REUSEPORT, &one, sizeof (one))) != DDS_RETCODE_OK)
+    GVERROR ("ddsi_udp_create_conn: set SO_REUSEPORT = 1 failed: %s\n", dds_strretcode (rc));
+  return rc;
+#else
+  (void) socket;
+  GVERROR ("ddsi_udp_create_conn: SO_REUSEPORT not supported\n");
+  return DDS_RETCODE_UNSUPPORTED;
+#endif
+}
+
+static dds_return_t set_zerocopy (struct ddsi_domaingv const * const gv, ddsrt_socket_t socket)
+{
+#if UDP_ZEROCOPY
+  dds_return_t rc;
+  const int one = 1;
+  if ((rc = ddsrt_setsockopt (socket, SOL_SOCKET, SO_ZEROCOPY, &one, sizeof (one))) != DDS_RETCODE_OK)
+    GVLOG (DDS_LC_CONFIG, "ddsi_udp_create_conn: zero-copy transmit not supported by network stack: %s\n", dds_strretcode (rc));
+  return rc;
+#else
+  (void) socket;
+  GVLOG (DDS_LC_CONFIG, "ddsi_udp_create_conn: zero-copy transmit not supported on this platform\n");
+  return DDS_RETCODE_UNSUPPORTED;
+#endif
+}
+
 static dds_return_t set_dont_route (struct ddsi_domaingv const * const gv, ddsrt_socket_t socket, bool ipv6)
 {
   dds_return_t rc;
@@ -579,7 +948,7 @@ static dds_return_t ddsi_udp_create_conn (struct ddsi_tran_conn **conn_out, stru
 
   dds_return_t rc;
   ddsrt_socket_t sock;
-  bool reuse_addr = false, bind_to_any = false, ipv6 = false, set_mc_xmit_options = false;
+  bool reuse_addr = false, reuse_port = false, bind_to_any = false, ipv6 = false, set_mc_xmit_options = false, zerocopy = false;
   const char *purpose_str = NULL;
 
   switch (qos->m_purpose)
@@ -588,16 +957,19 @@ static dds_return_t ddsi_udp_create_conn (struct ddsi_tran_conn **conn_out, stru
       reuse_addr = false;
       bind_to_any = false;
       set_mc_xmit_options = false;
+      zerocopy = qos->m_zerocopy;
       purpose_str = "transmit(uc)";
       break;
     case DDSI_TRAN_QOS_XMIT_MC:
       reuse_addr = false;
       bind_to_any = false;
       set_mc_xmit_options = true;
+      zerocopy = qos->m_zerocopy;
       purpose_str = "transmit(uc/mc)";
       break;
     case DDSI_TRAN_QOS_RECV_UC:
       reuse_addr = false;
+      reuse_port = qos->m_reuseport;
       bind_to_any = true;
       set_mc_xmit_options = false;
       purpose_str = "unicast";
@@ -655,6 +1027,9 @@ static dds_return_t ddsi_udp_create_conn (struct ddsi_tran_conn **conn_out, stru
     }
   }
 
+  if (reuse_port && set_reuse_port (gv, sock) != DDS_RETCODE_OK)
+    goto fail_w_socket;
+
   if ((rc = set_rcvbuf (gv, sock, &gv->config.socket_rcvbuf_size)) < 0)
     goto fail_w_socket;
   if (rc > 0) {
@@ -703,6 +1078,10 @@ static dds_return_t ddsi_udp_create_conn (struct ddsi_tran_conn **conn_out, stru
       goto fail_w_socket;
   }
 
+  // Failure to enable zero-copy writes is not an issue, it just means the data gets copied
+  if (zerocopy && set_zerocopy (gv, sock) != DDS_RETCODE_OK)
+    zerocopy = false;
+
   ddsi_udp_conn_t conn = ddsrt_malloc (sizeof (*conn));
   memset (conn, 0, sizeof (*conn));
 
@@ -720,9 +1099,29 @@ static dds_return_t ddsi_udp_create_conn (struct ddsi_tran_conn **conn_out, stru
   conn->m_base.m_base.m_handle_fn = ddsi_udp_conn_handle;
 
   conn->m_base.m_read_fn = ddsi_udp_conn_read;
+  conn->m_base.m_read_batch_fn = ddsi_udp_conn_read_batch;
+  conn->m_base.m_read_done_fn = ddsi_udp_conn_read_done_ext;
   conn->m_base.m_write_fn = ddsi_udp_conn_write;
+  conn->m_base.m_write_multi_fn = ddsi_udp_conn_write_multi;
   conn->m_base.m_disable_multiplexing_fn = ddsi_udp_disable_multiplexing;
   conn->m_base.m_locator_fn = ddsi_udp_conn_locator;
+#if UDP_ZEROCOPY
+  if (zerocopy)
+  {
+    struct ddsi_udp_zerocopy * const zc = ddsrt_malloc (sizeof (*zc));
+    ddsrt_mutex_init (&zc->lock);
+    zc->first_id = 0;
+    zc->first = zc->count = 0;
+    zc->backoff = 0;
+    zc->size = 64;
+    zc->pending = ddsrt_malloc (zc->size * sizeof (*zc->pending));
+    conn->m_zerocopy = zc;
+    conn->m_base.m_write_zerocopy_fn = ddsi_udp_conn_write_zerocopy;
+    // receiving directly into the waitset's buffers (io_uring) doesn't read the
+    // error queue, this makes it call the read function that does
+    conn->m_base.m_read_done_fn = 0;
+  }
+#endif
 
   GVTRACE ("ddsi_udp_create_conn %s socket %"PRIdSOCK" port %"PRIu32"\n", purpose_str, conn->m_sockext.sock, conn->m_base.m_base.m_port);
   *conn_out = &conn->m_base;
@@ -738,6 +1137,40 @@ fail_addrinuse:
   return DDS_RETCODE_PRECONDITION_NOT_MET;
 }
 
+dds_return_t ddsi_udp_conn_steer_by_guid_prefix (struct ddsi_tran_conn *conn_cmn, uint32_t nconns)
+{
+#if defined __linux && defined SO_ATTACH_REUSEPORT_CBPF
+  ddsi_udp_conn_t conn = (ddsi_udp_conn_t) conn_cmn;
+  struct ddsi_domaingv const * const gv = conn->m_base.m_base.gv;
+  // A classic BPF program sees the UDP payload and returns the index of the socket in
+  // the reuseport group (in the order they were bound).  The RTPS header is "RTPS",
+  // version, vendor id and then the 12-byte GUID prefix: fold that into 32 bits and
+  // hash.  Loading beyond the end of the packet returns 0, which is fine, too.
+  struct sock_filter code[] = {
+    BPF_STMT (BPF_LD | BPF_W | BPF_ABS, 8),
+    BPF_STMT (BPF_MISC | BPF_TAX, 0),
+    BPF_STMT (BPF_LD | BPF_W | BPF_ABS, 12),
+    BPF_STMT (BPF_ALU | BPF_XOR | BPF_X, 0),
+    BPF_STMT (BPF_MISC | BPF_TAX, 0),
+    BPF_STMT (BPF_LD | BPF_W | BPF_ABS, 16),
+    BPF_STMT (BPF_ALU | BPF_XOR | BPF_X, 0),
+    BPF_STMT (BPF_ALU | BPF_MUL | BPF_K, 0x9e3779b1),
+    BPF_STMT (BPF_ALU | BPF_RSH | BPF_K, 16),
+    BPF_STMT (BPF_ALU | BPF_MOD | BPF_K, nconns),
+    BPF_STMT (BPF_RET | BPF_A, 0)
+  };
+  struct sock_fprog prog = { .len = (unsigned short) (sizeof (code) / sizeof (code[0])), .filter = code };
+  dds_return_t rc;
+  assert (nconns > 0);
+  if ((rc = ddsrt_setsockopt (conn->m_sockext.sock, SOL_SOCKET, SO_ATTACH_REUSEPORT_CBPF, &prog, sizeof (prog))) != DDS_RETCODE_OK)
+    GVERROR ("ddsi_udp_conn_steer_by_guid_prefix: set SO_ATTACH_REUSEPORT_CBPF failed: %s\n", dds_strretcode (rc));
+  return rc;
+#else
+  (void) conn_cmn; (void) nconns;
+  return DDS_RETCODE_UNSUPPORTED;
+#endif
+}
+
 static int joinleave_asm_mcgroup (ddsrt_socket_t socket, int join, const ddsi_locator_t *mcloc, const struct ddsi_network_interface *interf)
 {
   dds_return_t rc;
@@ -845,10 +1278,28 @@ static void ddsi_udp_release_conn (struct ddsi_tran_conn * conn_cmn)
   GVTRACE ("ddsi_udp_release_conn %s socket %"PRIdSOCK" port %"PRIu32"\n",
            conn_cmn->m_base.m_multicast ? "multicast" : "unicast",
            conn->m_sockext.sock, conn->m_base.m_base.m_port);
+#if UDP_ZEROCOPY
+  if (conn->m_zerocopy)
+    ddsi_udp_zerocopy_reap (conn);
+#endif
   ddsrt_socket_ext_fini (&conn->m_sockext);
   ddsrt_close (conn->m_sockext.sock);
 #if defined _WIN32 && !defined WINCE
   WSACloseEvent (conn->m_sockEvent);
+#endif
+#if UDP_ZEROCOPY
+  if (conn->m_zerocopy)
+  {
+    // The socket is gone, so no completions will be reported any more.  The kernel
+    // holds its own references to the pages of any packets still in flight, freeing
+    // the memory can at worst affect the contents of those packets.
+    struct ddsi_udp_zerocopy * const zc = conn->m_zerocopy;
+    ddsi_udp_zerocopy_complete (zc, zc->first_id, zc->first_id + zc->count - 1, false);
+    assert (zc->count == 0);
+    ddsrt_free (zc->pending);
+    ddsrt_mutex_destroy (&zc->lock);
+    ddsrt_free (zc);
+  }
 #endif
   ddsrt_free (conn_cmn);
 }
@@ -88,6 +88,10 @@ static dds_return_t ddsi_vnet_create_conn (struct ddsi_tran_conn **conn_out, str
   x->m_base.m_base.m_handle_fn = ddsi_vnet_conn_handle;
   x->m_base.m_locator_fn = ddsi_vnet_conn_locator;
   x->m_base.m_read_fn = 0;
+  x->m_base.m_read_batch_fn = 0;
+  x->m_base.m_read_done_fn = 0;
+  x->m_base.m_write_multi_fn = 0;
+  x->m_base.m_write_zerocopy_fn = 0;
   x->m_base.m_write_fn = ddsi_vnet_conn_write;
   x->m_base.m_disable_multiplexing_fn = 0;
 
@@ -341,11 +341,24 @@ static cost_t sat_cost_add (cost_t x, int32_t a)
     return (x < INT32_MIN - a) ? INT32_MIN : x + a;
 }
 
+static cost_t calc_locator_base_cost (const ddsi_xlocator_t *loc, cover_info_t ci)
+{
+  // ci: cover info of any reader reached via this (non-PSMX) locator, only the
+  // multicast indicator matters
+  const int32_t cost_uc  = loc->conn->m_interf->prefer_multicast ? 1000000 : 2;
+  const int32_t cost_mc  = loc->conn->m_interf->prefer_multicast ? 1 : 3;
+  const int32_t cost_ssm = loc->conn->m_interf->prefer_multicast ? 0 : 2;
+  const cost_t cost = - loc->conn->m_interf->priority;
+  if ((ci & CI_MULTICAST_MASK) == 0)
+    return cost + cost_uc;
+  else if (((ci & CI_MULTICAST_MASK) >> CI_MULTICAST_SHIFT) == CI_MULTICAST_SSM)
+    return cost + cost_ssm;
+  else
+    return cost + cost_mc;
+}
+
 static readercount_cost_t calc_locator_cost (const struct locset *locs, const struct cover *c, int lidx, dds_locator_mask_t ignore)
 {
-  const int32_t cost_uc  = locs->locs[lidx].conn->m_interf->prefer_multicast ? 1000000 : 2;
-  const int32_t cost_mc  = locs->locs[lidx].conn->m_interf->prefer_multicast ? 1 : 3;
-  const int32_t cost_ssm = locs->locs[lidx].conn->m_interf->prefer_multicast ? 0 : 2;
   readercount_cost_t x = { .nrds = 0, .cost = - locs->locs[lidx].conn->m_interf->priority };
 
   // Find first reader that this locator addresses so we actually know something
@@ -369,12 +382,8 @@ static readercount_cost_t calc_locator_cost (const struct locset *locs, const st
     else
       goto no_readers;
   }
-  else if ((ci & CI_MULTICAST_MASK) == 0)
-    x.cost += cost_uc;
-  else if (((ci & CI_MULTICAST_MASK) >> CI_MULTICAST_SHIFT) == CI_MULTICAST_SSM)
-    x.cost += cost_ssm;
   else
-    x.cost += cost_mc;
+    x.cost = calc_locator_base_cost (&locs->locs[lidx], ci);
 
   for (; rdidx < c->nreaders; rdidx++)
   {
@@ -805,3 +814,197 @@ struct ddsi_addrset *ddsi_compute_writer_addrset (const struct ddsi_writer *wr)
   locset_free (locs);
   return newas;
 }
+
+/* Incremental maintenance of the address set
+
+   Recomputing the cover from scratch costs O(readers x locators) for each
+   reader that matches or unmatches, which makes a discovery storm quadratic
+   in the number of readers.  For the common case of a reader that is reached
+   via ordinary unicast/multicast locators, adding or removing a single reader
+   can be handled locally:
+
+   - a new reader is either reached already via a locator in the address set,
+     or its cheapest locator gets added;
+   - for a removed reader, the locator it was assigned to gets removed if no
+     other reader is assigned to it.
+
+   Each reader is assigned to exactly one locator in the address set, so the
+   result is always a cover, but not necessarily the one the full computation
+   would choose: it never switches from unicast to multicast as more readers
+   join.  Therefore the full computation is redone once the number of
+   incremental changes to the address set becomes proportional to the number
+   of readers, keeping the amortized cost per change independent of the number
+   of readers.  Redundant networking, SSM, MCGEN and PSMX are rare enough to
+   simply always use the full computation. */
+
+#define WRAS_MIN_INCREMENTAL_CHANGES 16
+
+struct wras_locref {
+  ddsrt_avl_node_t avlnode;
+  ddsi_xlocator_t loc;
+  uint32_t refc; /* number of readers assigned to this locator */
+};
+
+struct ddsi_wraddrset_cache {
+  const struct ddsi_domaingv *gv;
+  ddsrt_avl_tree_t locrefs; /* mirrors the writer's address set */
+  uint32_t nchanges; /* changes to the address set since the full computation */
+};
+
+static int compare_locref (const void *va, const void *vb)
+{
+  return ddsi_compare_xlocators (va, vb);
+}
+
+static const ddsrt_avl_treedef_t wras_locref_treedef =
+  DDSRT_AVL_TREEDEF_INITIALIZER (offsetof (struct wras_locref, avlnode), offsetof (struct wras_locref, loc), compare_locref, 0);
+
+static void wras_add_locref_helper (const ddsi_xlocator_t *loc, void *varg)
+{
+  struct ddsi_wraddrset_cache * const cache = varg;
+  struct wras_locref *lr = ddsrt_malloc (sizeof (*lr));
+  lr->loc = *loc;
+  lr->refc = 0;
+  ddsrt_avl_insert (&wras_locref_treedef, &cache->locrefs, lr);
+}
+
+struct wras_reader_locs_arg {
+  const struct ddsi_wraddrset_cache *cache;
+  bool incremental_ok;
+  struct wras_locref *assigned; /* locator in address set via which the reader is reached */
+  ddsi_xlocator_t cheapest;
+  cost_t cheapest_cost;
+};
+
+static void wras_reader_locs_helper (const ddsi_xlocator_t *loc, void *varg)
+{
+  struct wras_reader_locs_arg * const arg = varg;
+  if (loc->c.kind == DDSI_LOCATOR_KIND_PSMX || loc->c.kind == DDSI_LOCATOR_KIND_UDPv4MCGEN)
+  {
+    arg->incremental_ok = false;
+    return;
+  }
+  if (arg->assigned == NULL)
+    arg->assigned = ddsrt_avl_lookup (&wras_locref_treedef, &arg->cache->locrefs, loc);
+  const cost_t cost = calc_locator_base_cost (loc, (cover_info_t) (multicast_indicator (arg->cache->gv, loc) << CI_MULTICAST_SHIFT));
+  if (cost < arg->cheapest_cost)
+  {
+    arg->cheapest = *loc;
+    arg->cheapest_cost = cost;
+  }
+}
+
+static bool wras_scan_reader_locs (const struct ddsi_wraddrset_cache *cache, const struct ddsi_writer *wr, const struct ddsi_proxy_reader *prd, struct wras_reader_locs_arg *arg)
+{
+  arg->cache = cache;
+  arg->incremental_ok = !prd->redundant_networking;
+#ifdef DDSRT_HAVE_SSM
+  if (prd->favours_ssm && wr->supports_ssm)
+    arg->incremental_ok = false;
+#else
+  (void) wr;
+#endif
+  arg->assigned = NULL;
+  ddsi_set_unspec_xlocator (&arg->cheapest);
+  arg->cheapest_cost = INT32_MAX;
+  if (arg->incremental_ok)
+    ddsi_addrset_forall (prd->c.as, wras_reader_locs_helper, arg);
+  return arg->incremental_ok;
+}
+
+static void wras_locref_free_helper (void *vlr)
+{
+  ddsrt_free (vlr);
+}
+
+void ddsi_wraddrset_cache_free (struct ddsi_wraddrset_cache *cache)
+{
+  ddsrt_avl_free (&wras_locref_treedef, &cache->locrefs, wras_locref_free_helper);
+  ddsrt_free (cache);
+}
+
+static bool wras_incremental_allowed (const struct ddsi_writer *wr)
+{
+  const uint32_t max_changes = (wr->num_readers / 4 > WRAS_MIN_INCREMENTAL_CHANGES) ? wr->num_readers / 4 : WRAS_MIN_INCREMENTAL_CHANGES;
+  return wr->as_cache != NULL && wr->as_cache->nchanges < max_changes;
+}
+
+struct ddsi_wraddrset_cache *ddsi_wraddrset_cache_new (struct ddsi_writer *wr)
+{
+  struct ddsi_entity_index * const gh = wr->e.gv->entity_index;
+  struct ddsi_wraddrset_cache *cache = ddsrt_malloc (sizeof (*cache));
+  cache->gv = wr->e.gv;
+  ddsrt_avl_init (&wras_locref_treedef, &cache->locrefs);
+  cache->nchanges = 0;
+  ddsi_addrset_forall (wr->as, wras_add_locref_helper, cache);
+
+  ddsrt_avl_iter_t it;
+  for (struct ddsi_wr_prd_match *m = ddsrt_avl_iter_first (&ddsi_wr_readers_treedef, &wr->readers, &it); m; m = ddsrt_avl_iter_next (&it))
+  {
+    struct ddsi_proxy_reader *prd;
+    struct wras_reader_locs_arg arg;
+    ddsi_set_unspec_xlocator (&m->cover_loc);
+    if ((prd = ddsi_entidx_lookup_proxy_reader_guid (gh, &m->prd_guid)) == NULL)
+      continue;
+    if (!wras_scan_reader_locs (cache, wr, prd, &arg) || arg.assigned == NULL)
+    {
+      ddsi_wraddrset_cache_free (cache);
+      cache = NULL;
+      break;
+    }
+    m->cover_loc = arg.assigned->loc;
+    arg.assigned->refc++;
+  }
+  return cache;
+}
+
+bool ddsi_wraddrset_add_reader (struct ddsi_writer *wr, struct ddsi_wr_prd_match *m, const struct ddsi_proxy_reader *prd)
+{
+  struct wras_reader_locs_arg arg;
+  if (!wras_incremental_allowed (wr))
+    return false;
+  if (!wras_scan_reader_locs (wr->as_cache, wr, prd, &arg))
+    return false;
+  if (arg.assigned != NULL)
+  {
+    arg.assigned->refc++;
+    m->cover_loc = arg.assigned->loc;
+    return true;
+  }
+  if (arg.cheapest_cost == INT32_MAX)
+    return false;
+
+  struct wras_locref *lr = ddsrt_malloc (sizeof (*lr));
+  lr->loc = arg.cheapest;
+  lr->refc = 1;
+  ddsrt_avl_insert (&wras_locref_treedef, &wr->as_cache->locrefs, lr);
+  wr->as_cache->nchanges++;
+  m->cover_loc = lr->loc;
+  /* The address set may be referenced by messages that are still queued, but
+     it has its own lock and those messages might as well go to the new
+     reader, so there is no need to construct a new one */
+  ddsi_add_xlocator_to_addrset (wr->e.gv, wr->as, &lr->loc);
+  char buf[DDSI_LOCSTRLEN];
+  ELOGDISC (wr, "setcover: add %s for "PGUIDFMT"\n", ddsi_xlocator_to_string (buf, sizeof (buf), &lr->loc), PGUID (prd->e.guid));
+  return true;
+}
+
+bool ddsi_wraddrset_remove_reader (struct ddsi_writer *wr, const struct ddsi_wr_prd_match *m)
+{
+  struct wras_locref *lr;
+  if (!wras_incremental_allowed (wr) || ddsi_is_unspec_xlocator (&m->cover_loc))
+    return false;
+  if ((lr = ddsrt_avl_lookup (&wras_locref_treedef, &wr->as_cache->locrefs, &m->cover_loc)) == NULL)
+    return false;
+  assert (lr->refc > 0);
+  if (--lr->refc == 0)
+  {
+    char buf[DDSI_LOCSTRLEN];
+    ELOGDISC (wr, "setcover: remove %s for "PGUIDFMT"\n", ddsi_xlocator_to_string (buf, sizeof (buf), &lr->loc), PGUID (m->prd_guid));
+    ddsi_remove_from_addrset (wr->e.gv, wr->as, &lr->loc);
+    ddsrt_avl_delete (&wras_locref_treedef, &wr->as_cache->locrefs, lr);
+    ddsrt_free (lr);
+    wr->as_cache->nchanges++;
+  }
+  return true;
+}
@@ -16,10 +16,12 @@
 #include "dds/ddsrt/heap.h"
 #include "dds/ddsrt/sync.h"
 #include "dds/ddsrt/fibheap.h"
+#include "dds/ddsrt/timerwheel.h"
 #include "dds/ddsi/ddsi_unused.h"
 #include "dds/ddsi/ddsi_domaingv.h"
 #include "ddsi__log.h"
 #include "ddsi__xevent.h"
+#include "ddsi__entity_index.h"
 #include "ddsi__thread.h"
 #include "ddsi__transmit.h"
 #include "ddsi__xmsg.h"
@@ -40,7 +42,10 @@ enum cb_sync_on_delete_state {
 
 struct ddsi_xevent
 {
-  ddsrt_fibheap_node_t heapnode;
+  union {
+    ddsrt_fibheap_node_t heap;
+    ddsrt_timerwheel_node_t wheel;
+  } qnode;
   struct ddsi_xeventq *evq;
   ddsrt_mtime_t tsched;
 
@@ -91,7 +96,9 @@ struct ddsi_xevent_nt
 };
 
 struct ddsi_xeventq {
+  enum ddsi_xeventq_impl impl;
   ddsrt_fibheap_t xevents;
+  ddsrt_timerwheel_t xevents_wheel;
   ddsrt_avl_tree_t msg_xevents;
   struct ddsi_xevent_nt *non_timed_xmit_list_oldest;
   struct ddsi_xevent_nt *non_timed_xmit_list_newest; /* undefined if ..._oldest == NULL */
@@ -119,7 +126,8 @@ static void handle_nontimed_xevent (struct ddsi_xeventq *evq, struct ddsi_xevent
 
 static const ddsrt_avl_treedef_t msg_xevents_treedef = DDSRT_AVL_TREEDEF_INITIALIZER_INDKEY (offsetof (struct ddsi_xevent_nt, u.msg_rexmit.msg_avlnode), offsetof (struct ddsi_xevent_nt, u.msg_rexmit.msg), msg_xevents_cmp, 0);
 
-static const ddsrt_fibheap_def_t evq_xevents_fhdef = DDSRT_FIBHEAPDEF_INITIALIZER(offsetof (struct ddsi_xevent, heapnode), compare_xevent_tsched);
+static const ddsrt_fibheap_def_t evq_xevents_fhdef = DDSRT_FIBHEAPDEF_INITIALIZER(offsetof (struct ddsi_xevent, qnode.heap), compare_xevent_tsched);
+static const ddsrt_timerwheel_def_t evq_xevents_twdef = DDSRT_TIMERWHEELDEF_INITIALIZER(offsetof (struct ddsi_xevent, qnode.wheel));
 
 static int compare_xevent_tsched (const void *va, const void *vb)
 {
@@ -128,6 +136,61 @@ static int compare_xevent_tsched (const void *va, const void *vb)
   return (a->tsched.v == b->tsched.v) ? 0 : (a->tsched.v < b->tsched.v) ? -1 : 1;
 }
 
+/* The timed events are either in a heap or in a timer wheel, the operations below
+   hide the difference.  TSCHED_DELETE precedes any time, so in the heap the events
+   to be deleted are at the front and in the wheel they are in the list of expired
+   events.  Either way they are returned first by xevq_extract_due. */
+
+static void xevq_insert (struct ddsi_xeventq *evq, struct ddsi_xevent *ev)
+{
+  if (evq->impl == DDSI_XEVQ_WHEEL)
+    ddsrt_timerwheel_insert (&evq_xevents_twdef, &evq->xevents_wheel, ev, ev->tsched.v);
+  else
+    ddsrt_fibheap_insert (&evq_xevents_fhdef, &evq->xevents, ev);
+}
+
+static void xevq_remove (struct ddsi_xeventq *evq, struct ddsi_xevent *ev)
+{
+  if (evq->impl == DDSI_XEVQ_WHEEL)
+    ddsrt_timerwheel_delete (&evq_xevents_twdef, &evq->xevents_wheel, ev);
+  else
+    ddsrt_fibheap_delete (&evq_xevents_fhdef, &evq->xevents, ev);
+}
+
+static void xevq_decrease_key (struct ddsi_xeventq *evq, struct ddsi_xevent *ev)
+{
+  if (evq->impl == DDSI_XEVQ_WHEEL)
+  {
+    ddsrt_timerwheel_delete (&evq_xevents_twdef, &evq->xevents_wheel, ev);
+    ddsrt_timerwheel_insert (&evq_xevents_twdef, &evq->xevents_wheel, ev, ev->tsched.v);
+  }
+  else
+  {
+    ddsrt_fibheap_decrease_key (&evq_xevents_fhdef, &evq->xevents, ev);
+  }
+}
+
+static struct ddsi_xevent *xevq_extract_due (struct ddsi_xeventq *evq, ddsrt_mtime_t tnow)
+{
+  if (evq->impl == DDSI_XEVQ_WHEEL)
+    return ddsrt_timerwheel_extract_due (&evq_xevents_twdef, &evq->xevents_wheel, tnow.v);
+  else
+  {
+    struct ddsi_xevent *min = ddsrt_fibheap_min (&evq_xevents_fhdef, &evq->xevents);
+    if (min == NULL || min->tsched.v > tnow.v)
+      return NULL;
+    return ddsrt_fibheap_extract_min (&evq_xevents_fhdef, &evq->xevents);
+  }
+}
+
+static struct ddsi_xevent *xevq_extract_any (struct ddsi_xeventq *evq)
+{
+  if (evq->impl == DDSI_XEVQ_WHEEL)
+    return ddsrt_timerwheel_extract_any (&evq_xevents_twdef, &evq->xevents_wheel);
+  else
+    return ddsrt_fibheap_extract_min (&evq_xevents_fhdef, &evq->xevents);
+}
+
 static void update_rexmit_counts (struct ddsi_xeventq *evq, size_t msg_rexmit_queued_rexmit_bytes)
 {
   assert (msg_rexmit_queued_rexmit_bytes <= evq->queued_rexmit_bytes);
@@ -275,12 +338,12 @@ static void ddsi_delete_xevent_nosync (struct ddsi_xeventq *evq, struct ddsi_xev
   if (ev->tsched.v != DDS_NEVER)
   {
     ev->tsched.v = TSCHED_DELETE;
-    ddsrt_fibheap_decrease_key (&evq_xevents_fhdef, &evq->xevents, ev);
+    xevq_decrease_key (evq, ev);
   }
   else
   {
     ev->tsched.v = TSCHED_DELETE;
-    ddsrt_fibheap_insert (&evq_xevents_fhdef, &evq->xevents, ev);
+    xevq_insert (evq, ev);
   }
   /* TSCHED_DELETE is absolute minimum time, so chances are we need to
      wake up the thread.  The superfluous signal is harmless. */
@@ -295,7 +358,7 @@ static void ddsi_delete_xevent_sync (struct ddsi_xeventq *evq, struct ddsi_xeven
     if (ev->tsched.v != DDS_NEVER)
     {
       assert (ev->tsched.v != TSCHED_DELETE);
-      ddsrt_fibheap_delete (&evq_xevents_fhdef, &evq->xevents, ev);
+      xevq_remove (evq, ev);
       ev->tsched.v = DDS_NEVER;
     }
     if (ev->sync_state == CSODS_EXECUTING)
@@ -343,12 +406,12 @@ int ddsi_resched_xevent_if_earlier (struct ddsi_xevent *ev, ddsrt_mtime_t tsched
     if (ev->tsched.v != DDS_NEVER)
     {
       ev->tsched = tsched;
-      ddsrt_fibheap_decrease_key (&evq_xevents_fhdef, &evq->xevents, ev);
+      xevq_decrease_key (evq, ev);
     }
     else
     {
       ev->tsched = tsched;
-      ddsrt_fibheap_insert (&evq_xevents_fhdef, &evq->xevents, ev);
+      xevq_insert (evq, ev);
     }
     is_resched = 1;
     if (tsched.v < tbefore.v)
@@ -393,6 +456,12 @@ static ddsrt_mtime_t earliest_in_xeventq (struct ddsi_xeventq *evq)
 {
   struct ddsi_xevent *min;
   ASSERT_MUTEX_HELD (&evq->lock);
+  if (evq->impl == DDSI_XEVQ_WHEEL)
+  {
+    // a lower bound for the wheel, but waking up early is harmless: the thread simply
+    // goes back to sleep
+    return (ddsrt_mtime_t) { ddsrt_timerwheel_next (&evq_xevents_twdef, &evq->xevents_wheel) };
+  }
   return ((min = ddsrt_fibheap_min (&evq_xevents_fhdef, &evq->xevents)) != NULL) ? min->tsched : DDSRT_MTIME_NEVER;
 }
 
@@ -405,7 +474,7 @@ static void qxev_insert (struct ddsi_xevent *ev)
   if (ev->tsched.v != DDS_NEVER)
   {
     ddsrt_mtime_t tbefore = earliest_in_xeventq (evq);
-    ddsrt_fibheap_insert (&evq_xevents_fhdef, &evq->xevents, ev);
+    xevq_insert (evq, ev);
     if (ev->tsched.v < tbefore.v)
       ddsrt_cond_broadcast (&evq->cond);
   }
@@ -430,7 +499,9 @@ struct ddsi_xeventq * ddsi_xeventq_new (struct ddsi_domaingv *gv, size_t max_que
   /* limit to 2GB to prevent overflow (4GB - 64kB should be ok, too) */
   if (max_queued_rexmit_bytes > 2147483648u)
     max_queued_rexmit_bytes = 2147483648u;
+  evq->impl = gv->config.xeventq_impl;
   ddsrt_fibheap_init (&evq_xevents_fhdef, &evq->xevents);
+  ddsrt_timerwheel_init (&evq_xevents_twdef, &evq->xevents_wheel, ddsrt_time_monotonic ().v);
   ddsrt_avl_init (&msg_xevents_treedef, &evq->msg_xevents);
   evq->non_timed_xmit_list_oldest = NULL;
   evq->non_timed_xmit_list_newest = NULL;
@@ -451,6 +522,16 @@ struct ddsi_xeventq * ddsi_xeventq_new (struct ddsi_domaingv *gv, size_t max_que
   return evq;
 }
 
+struct ddsi_xeventq *ddsi_xeventq_for_guid (const struct ddsi_domaingv *gv, const ddsi_guid_t *guid)
+{
+  // Built-in endpoints stay on the default queue, discovery traffic is interleaved
+  // with the other housekeeping there anyway.
+  if (gv->n_xevent_shards == 0 || (guid->entityid.u & DDSI_ENTITYID_SOURCE_MASK) != DDSI_ENTITYID_SOURCE_USER)
+    return gv->xevents;
+  const uint32_t h = ddsi_entidx_guid_hash (guid);
+  return gv->xevent_shards[(uint32_t) (((uint64_t) h * gv->n_xevent_shards) >> 32)];
+}
+
 dds_return_t ddsi_xeventq_start (struct ddsi_xeventq *evq, const char *name)
 {
   dds_return_t rc;
@@ -489,7 +570,7 @@ void ddsi_xeventq_free (struct ddsi_xeventq *evq)
 {
   struct ddsi_xevent *ev;
   assert (evq->thrst == NULL);
-  while ((ev = ddsrt_fibheap_extract_min (&evq_xevents_fhdef, &evq->xevents)) != NULL)
+  while ((ev = xevq_extract_any (evq)) != NULL)
     free_xevent (ev);
 
   {
@@ -591,9 +672,9 @@ static void handle_xevents (struct ddsi_thread_state * const thrst, struct ddsi_
   bool cont;
   do {
     cont = false;
-    while (earliest_in_xeventq (xevq).v <= tnow.v)
+    struct ddsi_xevent *xev;
+    while ((xev = xevq_extract_due (xevq, tnow)) != NULL)
     {
-      struct ddsi_xevent *xev = ddsrt_fibheap_extract_min (&evq_xevents_fhdef, &xevq->xevents);
       if (xev->tsched.v == TSCHED_DELETE)
         free_xevent (xev);
       else
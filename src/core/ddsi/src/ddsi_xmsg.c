@@ -22,12 +22,13 @@
 #include "dds/ddsrt/heap.h"
 #include "dds/ddsrt/random.h"
 #include "dds/ddsrt/avl.h"
+#include "dds/ddsrt/static_assert.h"
 #include "dds/ddsi/ddsi_xqos.h"
 #include "dds/ddsi/ddsi_log.h"
 #include "dds/ddsi/ddsi_unused.h"
 #include "dds/ddsi/ddsi_domaingv.h"
 #include "dds/ddsi/ddsi_serdata.h"
-#include "dds/ddsi/ddsi_freelist.h"
+#include "dds/ddsi/ddsi_mempool.h"
 #include "ddsi__protocol.h"
 #include "ddsi__addrset.h"
 #include "ddsi__misc.h"
@@ -38,13 +39,14 @@
 #include "ddsi__endpoint.h"
 #include "ddsi__plist.h"
 #include "ddsi__tran.h"
+#include "ddsi__thread.h"
 #include "ddsi__vendor.h"
 
 #define DDSI_XMSG_MAX_ALIGN 8
 #define DDSI_XMSG_CHUNK_SIZE 128
 
 struct ddsi_xmsgpool {
-  struct ddsi_freelist freelist;
+  struct ddsi_mempool *mempool;
   ddsi_protocol_version_t protocol_version;
 };
 
@@ -139,7 +141,6 @@ struct ddsi_xmsg_chain {
 
 struct ddsi_xpack
 {
-  struct ddsi_xpack *sendq_next;
   bool async_mode;
   ddsi_rtps_header_t hdr;
   ddsi_rtps_msg_len_t msg_len;
@@ -171,6 +172,8 @@ struct ddsi_xpack
 
   bool includes_rexmit;
   struct ddsi_xmsg_chain included_msgs;
+  uint32_t refd_payload_max;
+  struct ddsi_xpack_zerocopy *zerocopy;
 
 #ifdef DDS_HAS_NETWORK_PARTITIONS
   uint32_t encoderId;
@@ -196,23 +199,23 @@ static size_t align4u (size_t x)
 
 static void ddsi_xmsg_realfree (struct ddsi_xmsg *m);
 
+static void ddsi_xmsg_realfree_wrap (void *elem)
+{
+  ddsi_xmsg_realfree (elem);
+}
+
 struct ddsi_xmsgpool *ddsi_xmsgpool_new (ddsi_protocol_version_t protocol_version)
 {
   struct ddsi_xmsgpool *pool;
   pool = ddsrt_malloc (sizeof (*pool));
   pool->protocol_version = protocol_version;
-  ddsi_freelist_init (&pool->freelist, MAX_FREELIST_SIZE, offsetof (struct ddsi_xmsg, link.older));
+  pool->mempool = ddsi_mempool_new (DDSI_XMSG_CHUNK_SIZE, DDSI_XMSG_CHUNK_SIZE, MAX_FREELIST_SIZE, SIZE_MAX, ddsi_xmsg_realfree_wrap);
   return pool;
 }
 
-static void ddsi_xmsg_realfree_wrap (void *elem)
-{
-  ddsi_xmsg_realfree (elem);
-}
-
 void ddsi_xmsgpool_free (struct ddsi_xmsgpool *pool)
 {
-  ddsi_freelist_fini (&pool->freelist, ddsi_xmsg_realfree_wrap);
+  ddsi_mempool_free (pool->mempool);
   ddsrt_free (pool);
 }
 
@@ -282,7 +285,8 @@ static struct ddsi_xmsg *ddsi_xmsg_allocnew (struct ddsi_xmsgpool *pool, size_t
 struct ddsi_xmsg *ddsi_xmsg_new (struct ddsi_xmsgpool *pool, const ddsi_guid_t *src_guid, struct ddsi_participant *pp, size_t expected_size, enum ddsi_xmsg_kind kind)
 {
   struct ddsi_xmsg *m;
-  if ((m = ddsi_freelist_pop (&pool->freelist)) != NULL)
+  uint32_t chunk_size = DDSI_XMSG_CHUNK_SIZE;
+  if ((m = ddsi_mempool_get (pool->mempool, &chunk_size)) != NULL)
     ddsi_xmsg_reinit (m, kind);
   else if ((m = ddsi_xmsg_allocnew (pool, expected_size, kind)) == NULL)
     return NULL;
@@ -332,7 +336,7 @@ void ddsi_xmsg_free (struct ddsi_xmsg *m)
       break;
   }
   /* Only cache the smallest xmsgs; data messages store the payload by reference and are small */
-  if (m->maxsz > DDSI_XMSG_CHUNK_SIZE || !ddsi_freelist_push (&pool->freelist, m))
+  if (m->maxsz > DDSI_XMSG_CHUNK_SIZE || !ddsi_mempool_put (pool->mempool, m, DDSI_XMSG_CHUNK_SIZE))
   {
     ddsi_xmsg_realfree (m);
   }
@@ -364,6 +368,7 @@ static int submsg_is_compatible (const struct ddsi_xmsg *msg, ddsi_rtps_submessa
           /* normal control stuff is ok */
           return 1;
         case DDSI_RTPS_SMID_DATA: case DDSI_RTPS_SMID_DATA_FRAG:
+        case DDSI_RTPS_SMID_CYCLONE_DATAFRAG_PARITY:
           /* but data is strictly verboten */
           return 0;
         case DDSI_RTPS_SMID_SEC_BODY:
@@ -389,6 +394,7 @@ static int submsg_is_compatible (const struct ddsi_xmsg *msg, ddsi_rtps_submessa
           /* we never generate these directly */
           return 0;
         case DDSI_RTPS_SMID_INFO_TS: case DDSI_RTPS_SMID_DATA: case DDSI_RTPS_SMID_DATA_FRAG:
+        case DDSI_RTPS_SMID_CYCLONE_DATAFRAG_PARITY:
           /* Timestamp only preceding data; data may be present just
              once for rexmits.  The readerId offset can be used to
              ensure rexmits have only one data submessages -- the test
@@ -1009,16 +1015,111 @@ int ddsi_xmsg_addpar_sentinel_ifparam (struct ddsi_xmsg * m)
    pointer we compute the address of the xmsg from the address of the
    chain element, &c. */
 
-static void ddsi_xmsg_chain_release (struct ddsi_domaingv *gv, struct ddsi_xmsg_chain *chain)
+static void ddsi_xmsg_chain_free (struct ddsi_xmsg_chain *chain)
 {
-  ddsi_guid_t wrguid;
-  memset (&wrguid, 0, sizeof (wrguid));
-
   while (chain->latest)
   {
     struct ddsi_xmsg_chain_elem *ce = chain->latest;
     struct ddsi_xmsg *m = (struct ddsi_xmsg *) ((char *) ce - offsetof (struct ddsi_xmsg, link));
     chain->latest = ce->older;
+    ddsi_xmsg_free (m);
+  }
+}
+
+/* Zero-copy writes ---------------------------------------------------
+
+   A packet referencing enough serialised sample data is sent using the zero-copy
+   write of the transport, if it has one.  The kernel then reads the data some time
+   after the write returns.  That applies not only to the sample data but to the
+   entire packet: the submessages in the xmsgs and the RTPS header in the xpack.
+   Freeing the xmsgs (and so releasing their references to the serdata) is therefore
+   deferred until the writes to all destinations have completed, and the header gets
+   copied so the xpack can be reused. */
+
+struct ddsi_xpack_zerocopy {
+  struct ddsi_tran_zerocopy_ref ref;
+  ddsrt_atomic_uint32_t refc;
+  struct ddsi_domaingv *gv;
+  uint32_t size;
+  struct ddsi_xmsg_chain msgs;
+  ddsi_rtps_header_t hdr;
+};
+
+static void ddsi_xpack_zerocopy_unref (struct ddsi_xpack_zerocopy *zc)
+{
+  if (ddsrt_atomic_dec32_ov (&zc->refc) == 1)
+  {
+    ddsi_xmsg_chain_free (&zc->msgs);
+    ddsrt_free (zc);
+  }
+}
+
+static void ddsi_xpack_zerocopy_done (struct ddsi_tran_zerocopy_ref *ref, bool copied)
+{
+  struct ddsi_xpack_zerocopy * const zc = (struct ddsi_xpack_zerocopy *) ref;
+  struct ddsi_domaingv * const gv = zc->gv;
+  if (copied)
+  {
+    ddsrt_atomic_inc32 (&gv->zerocopy_copied);
+    ddsrt_atomic_add64 (&gv->zerocopy_bytes_copied, zc->size);
+  }
+  else
+  {
+    ddsrt_atomic_inc32 (&gv->zerocopy_sent);
+    ddsrt_atomic_add64 (&gv->zerocopy_bytes_saved, zc->size);
+  }
+  ddsrt_atomic_dec32 (&gv->zerocopy_pending);
+  ddsi_xpack_zerocopy_unref (zc);
+}
+
+static struct ddsi_xpack_zerocopy *ddsi_xpack_zerocopy_new (struct ddsi_xpack *xp)
+{
+  struct ddsi_xpack_zerocopy * const zc = ddsrt_malloc (sizeof (*zc));
+  zc->ref.done = ddsi_xpack_zerocopy_done;
+  ddsrt_atomic_st32 (&zc->refc, 1);
+  zc->gv = xp->gv;
+  zc->size = xp->msg_len.length;
+  zc->msgs.latest = NULL;
+  // zero-copy is only used for connectionless transports, so the only part of the
+  // packet in the xpack is the header in the first iovec
+  assert (xp->msgfrags->iov[0].iov_len == sizeof (zc->hdr));
+  memcpy (&zc->hdr, xp->msgfrags->iov[0].iov_base, sizeof (zc->hdr));
+  xp->msgfrags->iov[0].iov_base = (void *) &zc->hdr;
+  return zc;
+}
+
+static bool ddsi_xpack_may_use_zerocopy (const struct ddsi_xpack *xp)
+{
+  const uint32_t threshold = xp->gv->config.zerocopy_send_threshold;
+  if (threshold == 0 || xp->refd_payload_max < threshold)
+    return false;
+#ifdef DDS_HAS_SECURITY
+  // Encoding copies the packet
+  if (xp->sec_info.use_rtps_encoding)
+    return false;
+#endif
+  return true;
+}
+
+void ddsi_xpack_zerocopy_stats (const struct ddsi_domaingv *gv, struct ddsi_xpack_zerocopy_stats *st)
+{
+  st->pending = ddsrt_atomic_ld32 (&gv->zerocopy_pending);
+  st->sent = ddsrt_atomic_ld32 (&gv->zerocopy_sent);
+  st->copied = ddsrt_atomic_ld32 (&gv->zerocopy_copied);
+  st->bytes_saved = ddsrt_atomic_ld64 (&gv->zerocopy_bytes_saved);
+  st->bytes_copied = ddsrt_atomic_ld64 (&gv->zerocopy_bytes_copied);
+}
+
+/* Releases the xmsgs once the xpack containing them has been sent; if it was sent
+   using zero-copy writes, freeing them is left to the last completion. */
+static void ddsi_xmsg_chain_release (struct ddsi_domaingv *gv, struct ddsi_xmsg_chain *chain, struct ddsi_xpack_zerocopy *zc)
+{
+  ddsi_guid_t wrguid;
+  memset (&wrguid, 0, sizeof (wrguid));
+
+  for (struct ddsi_xmsg_chain_elem *ce = chain->latest; ce; ce = ce->older)
+  {
+    struct ddsi_xmsg *m = (struct ddsi_xmsg *) ((char *) ce - offsetof (struct ddsi_xmsg, link));
 
     /* If this xmsg was written by a writer different from wrguid,
        update wr->xmit_seq.  There isn't necessarily a writer, and
@@ -1044,8 +1145,15 @@ static void ddsi_xmsg_chain_release (struct ddsi_domaingv *gv, struct ddsi_xmsg_
           ddsi_writer_update_seq_xmit (wr, m->kindspecific.data.wrseq);
       }
     }
+  }
 
-    ddsi_xmsg_free (m);
+  if (zc == NULL)
+    ddsi_xmsg_chain_free (chain);
+  else
+  {
+    zc->msgs = *chain;
+    chain->latest = NULL;
+    ddsi_xpack_zerocopy_unref (zc);
   }
 }
 
@@ -1070,6 +1178,8 @@ static void ddsi_xpack_reinit (struct ddsi_xpack *xp)
   xp->msg_len.length = 0;
   xp->includes_rexmit = false;
   xp->included_msgs.latest = NULL;
+  xp->refd_payload_max = 0;
+  xp->zerocopy = NULL;
   xp->maxdelay = DDS_INFINITY;
 #ifdef DDS_HAS_SECURITY
   xp->sec_info.use_rtps_encoding = 0;
@@ -1138,6 +1248,20 @@ static ssize_t ddsi_xpack_send_rtps(struct ddsi_xpack * xp, const ddsi_xlocator_
   }
   else
 #endif /* DDS_HAS_SECURITY */
+  if (loc->conn->m_write_zerocopy_fn != NULL && ddsi_xpack_may_use_zerocopy (xp))
+  {
+    if (xp->zerocopy == NULL)
+      xp->zerocopy = ddsi_xpack_zerocopy_new (xp);
+    struct ddsi_xpack_zerocopy * const zc = xp->zerocopy;
+    ddsrt_atomic_inc32 (&zc->refc);
+    ddsrt_atomic_inc32 (&xp->gv->zerocopy_pending);
+    if ((ret = ddsi_conn_write_zerocopy (loc->conn, &loc->c, xp->msgfrags, xp->call_flags, &zc->ref)) < 0)
+    {
+      ddsrt_atomic_dec32 (&xp->gv->zerocopy_pending);
+      ddsi_xpack_zerocopy_unref (zc);
+    }
+  }
+  else
   {
     ret = ddsi_conn_write (loc->conn, &loc->c, xp->msgfrags, xp->call_flags);
   }
@@ -1203,6 +1327,103 @@ static void ddsi_xpack_send1v (const ddsi_xlocator_t *loc, void * varg)
   (void) ddsi_xpack_send1 (loc, varg);
 }
 
+struct ddsi_xpack_send_multi_arg {
+  struct ddsi_xpack *xp;
+  size_t max;
+  size_t n;
+  struct ddsi_tran_conn *conn;
+  ddsi_locator_t dsts[DDSI_TRAN_MAX_WRITE_BATCH];
+};
+
+static void ddsi_xpack_send_multi_flush (struct ddsi_xpack_send_multi_arg *arg)
+{
+  if (arg->n == 1)
+  {
+    (void) ddsi_conn_write (arg->conn, &arg->dsts[0], arg->xp->msgfrags, arg->xp->call_flags);
+    arg->xp->call_flags = 0;
+    arg->n = 0;
+  }
+  else if (arg->n > 1)
+  {
+    (void) ddsi_conn_write_multi (arg->conn, arg->n, arg->dsts, arg->xp->msgfrags, arg->xp->call_flags);
+    arg->xp->call_flags = 0;
+    arg->n = 0;
+  }
+}
+
+static void ddsi_xpack_send_multi_add (const ddsi_xlocator_t *loc, void * varg)
+{
+  struct ddsi_xpack_send_multi_arg * const arg = varg;
+  struct ddsi_xpack * const xp = arg->xp;
+  struct ddsi_domaingv const * const gv = xp->gv;
+
+  // Muting and transports that can't send to multiple destinations at once are handled
+  // by the regular path, there is nothing to be gained for them
+  if (gv->mute || loc->conn->m_write_multi_fn == NULL)
+  {
+    (void) ddsi_xpack_send1 (loc, xp);
+    return;
+  }
+
+  if (gv->logconfig.c.mask & DDS_LC_TRACE)
+  {
+    char buf[DDSI_LOCSTRLEN];
+    GVTRACE (" %s", ddsi_xlocator_to_string (buf, sizeof(buf), loc));
+  }
+  if (gv->config.xmit_lossiness > 0)
+  {
+    if ((ddsrt_random () % 1000) < (uint32_t) gv->config.xmit_lossiness)
+    {
+      GVTRACE ("(dropped)");
+      return;
+    }
+  }
+
+  assert (loc->c.kind != DDSI_LOCATOR_KIND_PSMX);
+  // A batch can only contain destinations reached via the same connection; with a single
+  // network interface that is all of them, otherwise a change of connection flushes it
+  if (arg->n == arg->max || (arg->n > 0 && loc->conn != arg->conn))
+    ddsi_xpack_send_multi_flush (arg);
+  arg->conn = loc->conn;
+  arg->dsts[arg->n++] = loc->c;
+}
+
+static bool ddsi_xpack_use_send_multi (const struct ddsi_xpack *xp)
+{
+  if (xp->gv->config.send_batch_size <= 1)
+    return false;
+#ifdef DDS_HAS_SECURITY
+  // Encoding is done per destination
+  if (xp->sec_info.use_rtps_encoding)
+    return false;
+#endif
+  // Zero-copy writes are done one destination at a time
+  if (ddsi_xpack_may_use_zerocopy (xp))
+    return false;
+  return true;
+}
+
+static size_t ddsi_xpack_send_addrset (struct ddsi_xpack *xp, struct ddsi_addrset *as, bool uc_only)
+{
+  size_t (* const forall) (struct ddsi_addrset *as, ddsi_addrset_forall_fun_t f, void *arg) =
+    uc_only ? ddsi_addrset_forall_uc_count : ddsi_addrset_forall_count;
+  if (!ddsi_xpack_use_send_multi (xp))
+    return forall (as, ddsi_xpack_send1v, xp);
+  else
+  {
+    struct ddsi_xpack_send_multi_arg arg;
+    size_t calls;
+    assert (xp->gv->config.send_batch_size <= DDSI_TRAN_MAX_WRITE_BATCH);
+    arg.xp = xp;
+    arg.max = (size_t) xp->gv->config.send_batch_size;
+    arg.n = 0;
+    arg.conn = NULL;
+    calls = forall (as, ddsi_xpack_send_multi_add, &arg);
+    ddsi_xpack_send_multi_flush (&arg);
+    return calls;
+  }
+}
+
 static void ddsi_xpack_send_real (struct ddsi_xpack *xp)
 {
   struct ddsi_domaingv const * const gv = xp->gv;
@@ -1243,14 +1464,14 @@ static void ddsi_xpack_send_real (struct ddsi_xpack *xp)
          it is updated, but that might not be something we want to guarantee */
       if (xp->dstaddr.all.as)
       {
-        calls = ddsi_addrset_forall_count (xp->dstaddr.all.as, ddsi_xpack_send1v, xp);
+        calls = ddsi_xpack_send_addrset (xp, xp->dstaddr.all.as, false);
         ddsi_unref_addrset (xp->dstaddr.all.as);
       }
       break;
     case NN_XMSG_DST_ALL_UC:
       if (xp->dstaddr.all_uc.as)
       {
-        calls = ddsi_addrset_forall_uc_count (xp->dstaddr.all_uc.as, ddsi_xpack_send1v, xp);
+        calls = ddsi_xpack_send_addrset (xp, xp->dstaddr.all_uc.as, true);
         ddsi_unref_addrset (xp->dstaddr.all_uc.as);
       }
       break;
@@ -1260,51 +1481,180 @@ static void ddsi_xpack_send_real (struct ddsi_xpack *xp)
   {
     GVLOG (DDS_LC_TRAFFIC, "traffic-xmit (%lu) %"PRIu32"\n", (unsigned long) calls, xp->msg_len.length);
   }
-  ddsi_xmsg_chain_release (xp->gv, &xp->included_msgs);
+  ddsi_xmsg_chain_release (xp->gv, &xp->included_msgs, xp->zerocopy);
   ddsi_xpack_reinit (xp);
 }
 
-#define SENDQ_MAX 200
+/* The queue for the send thread is a bounded multi-producer, single-consumer ring
+   of xpacks, following D. Vyukov's bounded queue: a writer claims a slot by
+   advancing "tail" and publishes the packet by updating the slot's sequence
+   number, the send thread consumes the slots in order.  The mutex and condition
+   variables are only used when the send thread runs out of work or a writer finds
+   the ring full, so the send thread drains everything that has been queued before
+   going to sleep and writers only need to wake it up if it actually is asleep. */
+struct ddsi_xpack_sendq_slot {
+  ddsrt_atomic_uint32_t seq;
+  struct ddsi_xpack *xp;
+};
+
+struct ddsi_xpack_sendq {
+  ddsrt_atomic_uint32_t tail; // next slot to be claimed by a writer
+  char pad[DDSI_CACHE_LINE_SIZE - sizeof (ddsrt_atomic_uint32_t)];
+  ddsrt_atomic_uint32_t head; // next slot to be consumed by the send thread
+  ddsrt_atomic_uint32_t thread_waiting; // send thread is blocked (or about to block) on cond
+  ddsrt_atomic_uint32_t writers_waiting; // number of writers blocked (or about to block) on space_cond
+  ddsrt_atomic_uint32_t max_depth;
+  ddsrt_atomic_uint32_t enqueue_waits;
+  ddsrt_atomic_uint32_t sent;
+  ddsrt_atomic_uint32_t flushes;
+  ddsrt_atomic_uint32_t max_flush;
+  bool stop;
+  ddsrt_mutex_t lock;
+  ddsrt_cond_t cond;
+  ddsrt_cond_t space_cond;
+  struct ddsi_xpack_sendq_slot slots[DDSI_XPACK_SENDQ_SIZE];
+};
+
+DDSRT_STATIC_ASSERT ((DDSI_XPACK_SENDQ_SIZE & (DDSI_XPACK_SENDQ_SIZE - 1)) == 0);
+
+static void ddsi_xpack_sendq_update_max (ddsrt_atomic_uint32_t *max, uint32_t v)
+{
+  uint32_t m;
+  while (v > (m = ddsrt_atomic_ld32 (max)) && !ddsrt_atomic_cas32 (max, m, v))
+    ;
+}
+
+static bool ddsi_xpack_sendq_try_enqueue (struct ddsi_xpack_sendq *q, struct ddsi_xpack *xp)
+{
+  uint32_t pos = ddsrt_atomic_ld32 (&q->tail);
+  for (;;)
+  {
+    struct ddsi_xpack_sendq_slot * const s = &q->slots[pos % DDSI_XPACK_SENDQ_SIZE];
+    const uint32_t seq = ddsrt_atomic_ld32 (&s->seq);
+    const int32_t dif = (int32_t) (seq - pos);
+    if (dif < 0)
+      return false;
+    else if (dif > 0)
+      pos = ddsrt_atomic_ld32 (&q->tail);
+    else if (!ddsrt_atomic_cas32 (&q->tail, pos, pos + 1))
+      pos = ddsrt_atomic_ld32 (&q->tail);
+    else
+    {
+      s->xp = xp;
+      ddsrt_atomic_fence_rel ();
+      ddsrt_atomic_st32 (&s->seq, pos + 1);
+      // the send thread may already have consumed it
+      const int32_t depth = (int32_t) (pos + 1 - ddsrt_atomic_ld32 (&q->head));
+      if (depth > 0)
+        ddsi_xpack_sendq_update_max (&q->max_depth, (uint32_t) depth);
+      return true;
+    }
+  }
+}
+
+static bool ddsi_xpack_sendq_nonempty (const struct ddsi_xpack_sendq *q)
+{
+  const uint32_t pos = ddsrt_atomic_ld32 (&q->head);
+  return ddsrt_atomic_ld32 (&q->slots[pos % DDSI_XPACK_SENDQ_SIZE].seq) == pos + 1;
+}
+
+static struct ddsi_xpack *ddsi_xpack_sendq_try_dequeue (struct ddsi_xpack_sendq *q)
+{
+  // only called by the send thread, so "head" can't change underneath us
+  const uint32_t pos = ddsrt_atomic_ld32 (&q->head);
+  struct ddsi_xpack_sendq_slot * const s = &q->slots[pos % DDSI_XPACK_SENDQ_SIZE];
+  if (ddsrt_atomic_ld32 (&s->seq) != pos + 1)
+    return NULL;
+  ddsrt_atomic_fence_acq ();
+  struct ddsi_xpack * const xp = s->xp;
+  ddsrt_atomic_fence_rel ();
+  ddsrt_atomic_st32 (&s->seq, pos + DDSI_XPACK_SENDQ_SIZE);
+  ddsrt_atomic_st32 (&q->head, pos + 1);
+  return xp;
+}
 
 static uint32_t ddsi_xpack_sendq_thread (void *vgv)
 {
   struct ddsi_domaingv *gv = vgv;
+  struct ddsi_xpack_sendq * const q = gv->sendq;
   struct ddsi_thread_state * const thrst = ddsi_lookup_thread_state ();
+  uint32_t nflush = 0;
   ddsi_thread_state_awake_fixed_domain (thrst);
-  ddsrt_mutex_lock (&gv->sendq_lock);
-  while (!(gv->sendq_stop && gv->sendq_head == NULL))
+  while (true)
   {
     struct ddsi_xpack *xp;
-    if ((xp = gv->sendq_head) == NULL)
+    if ((xp = ddsi_xpack_sendq_try_dequeue (q)) != NULL)
     {
-      ddsi_thread_state_asleep (thrst);
-      (void) ddsrt_cond_wait (&gv->sendq_cond, &gv->sendq_lock);
-      ddsi_thread_state_awake_fixed_domain (thrst);
+      // writers waiting for space check the ring again after registering as
+      // waiting, so either they see this slot or we see them; they are only woken
+      // up once half the ring is free to avoid switching back-and-forth for every
+      // packet
+      ddsrt_atomic_fence ();
+      if (ddsrt_atomic_ld32 (&q->writers_waiting) > 0 &&
+          ddsrt_atomic_ld32 (&q->tail) - ddsrt_atomic_ld32 (&q->head) <= DDSI_XPACK_SENDQ_SIZE / 2)
+      {
+        ddsrt_mutex_lock (&q->lock);
+        ddsrt_cond_broadcast (&q->space_cond);
+        ddsrt_mutex_unlock (&q->lock);
+      }
+      ddsi_xpack_send_real (xp);
+      ddsi_xpack_free (xp);
+      ddsrt_atomic_st32 (&q->sent, ddsrt_atomic_ld32 (&q->sent) + 1);
+      nflush++;
+      continue;
+    }
+
+    if (nflush > 0)
+    {
+      ddsrt_atomic_st32 (&q->flushes, ddsrt_atomic_ld32 (&q->flushes) + 1);
+      ddsi_xpack_sendq_update_max (&q->max_flush, nflush);
+      nflush = 0;
+    }
+    ddsrt_mutex_lock (&q->lock);
+    ddsrt_atomic_st32 (&q->thread_waiting, 1);
+    ddsrt_atomic_fence ();
+    if (ddsi_xpack_sendq_nonempty (q))
+      ddsrt_atomic_st32 (&q->thread_waiting, 0);
+    else if (q->stop)
+    {
+      ddsrt_mutex_unlock (&q->lock);
+      break;
     }
     else
     {
-      gv->sendq_head = xp->sendq_next;
-      if (--gv->sendq_length == 0)
-        ddsrt_cond_broadcast (&gv->sendq_cond);
-      ddsrt_mutex_unlock (&gv->sendq_lock);
-      ddsi_xpack_send_real (xp);
-      ddsi_xpack_free (xp);
-      ddsrt_mutex_lock (&gv->sendq_lock);
+      ddsi_thread_state_asleep (thrst);
+      (void) ddsrt_cond_wait (&q->cond, &q->lock);
+      ddsi_thread_state_awake_fixed_domain (thrst);
+      ddsrt_atomic_st32 (&q->thread_waiting, 0);
     }
+    ddsrt_mutex_unlock (&q->lock);
   }
-  ddsrt_mutex_unlock (&gv->sendq_lock);
   ddsi_thread_state_asleep (thrst);
   return 0;
 }
 
 void ddsi_xpack_sendq_init (struct ddsi_domaingv *gv)
 {
-  gv->sendq_stop = 0;
-  gv->sendq_head = NULL;
-  gv->sendq_tail = NULL;
-  gv->sendq_length = 0;
-  ddsrt_mutex_init (&gv->sendq_lock);
-  ddsrt_cond_init (&gv->sendq_cond);
+  struct ddsi_xpack_sendq *q = ddsrt_malloc (sizeof (*q));
+  ddsrt_atomic_st32 (&q->tail, 0);
+  ddsrt_atomic_st32 (&q->head, 0);
+  ddsrt_atomic_st32 (&q->thread_waiting, 0);
+  ddsrt_atomic_st32 (&q->writers_waiting, 0);
+  ddsrt_atomic_st32 (&q->max_depth, 0);
+  ddsrt_atomic_st32 (&q->enqueue_waits, 0);
+  ddsrt_atomic_st32 (&q->sent, 0);
+  ddsrt_atomic_st32 (&q->flushes, 0);
+  ddsrt_atomic_st32 (&q->max_flush, 0);
+  q->stop = false;
+  ddsrt_mutex_init (&q->lock);
+  ddsrt_cond_init (&q->cond);
+  ddsrt_cond_init (&q->space_cond);
+  for (uint32_t i = 0; i < DDSI_XPACK_SENDQ_SIZE; i++)
+  {
+    ddsrt_atomic_st32 (&q->slots[i].seq, i);
+    q->slots[i].xp = NULL;
+  }
+  gv->sendq = q;
 }
 
 void ddsi_xpack_sendq_start (struct ddsi_domaingv *gv)
@@ -1316,22 +1666,65 @@ void ddsi_xpack_sendq_start (struct ddsi_domaingv *gv)
 
 void ddsi_xpack_sendq_stop (struct ddsi_domaingv *gv)
 {
-  ddsrt_mutex_lock (&gv->sendq_lock);
-  gv->sendq_stop = 1;
-  ddsrt_cond_broadcast (&gv->sendq_cond);
-  ddsrt_mutex_unlock (&gv->sendq_lock);
+  struct ddsi_xpack_sendq * const q = gv->sendq;
+  ddsrt_mutex_lock (&q->lock);
+  q->stop = true;
+  ddsrt_cond_broadcast (&q->cond);
+  ddsrt_mutex_unlock (&q->lock);
 }
 
 void ddsi_xpack_sendq_fini (struct ddsi_domaingv *gv)
 {
+  struct ddsi_xpack_sendq * const q = gv->sendq;
   ddsi_join_thread (gv->sendq_ts);
-  assert (gv->sendq_head == NULL);
-  ddsrt_cond_destroy (&gv->sendq_cond);
-  ddsrt_mutex_destroy (&gv->sendq_lock);
+  assert (!ddsi_xpack_sendq_nonempty (q));
+  ddsrt_cond_destroy (&q->space_cond);
+  ddsrt_cond_destroy (&q->cond);
+  ddsrt_mutex_destroy (&q->lock);
+  ddsrt_free (q);
+  gv->sendq = NULL;
+}
+
+void ddsi_xpack_sendq_stats (const struct ddsi_domaingv *gv, struct ddsi_xpack_sendq_stats *st)
+{
+  const struct ddsi_xpack_sendq * const q = gv->sendq;
+  st->enqueued = ddsrt_atomic_ld32 (&q->tail);
+  st->depth = st->enqueued - ddsrt_atomic_ld32 (&q->head);
+  st->max_depth = ddsrt_atomic_ld32 (&q->max_depth);
+  st->enqueue_waits = ddsrt_atomic_ld32 (&q->enqueue_waits);
+  st->sent = ddsrt_atomic_ld32 (&q->sent);
+  st->flushes = ddsrt_atomic_ld32 (&q->flushes);
+  st->max_flush = ddsrt_atomic_ld32 (&q->max_flush);
+}
+
+static void ddsi_xpack_sendq_enqueue (struct ddsi_xpack_sendq *q, struct ddsi_xpack *xp)
+{
+  if (!ddsi_xpack_sendq_try_enqueue (q, xp))
+  {
+    ddsrt_atomic_inc32 (&q->enqueue_waits);
+    ddsrt_mutex_lock (&q->lock);
+    ddsrt_atomic_inc32 (&q->writers_waiting);
+    ddsrt_atomic_fence ();
+    while (!ddsi_xpack_sendq_try_enqueue (q, xp))
+      (void) ddsrt_cond_wait (&q->space_cond, &q->lock);
+    ddsrt_atomic_dec32 (&q->writers_waiting);
+    ddsrt_mutex_unlock (&q->lock);
+  }
+
+  // the send thread checks the ring again after registering as waiting, so either
+  // it sees this packet or we see it waiting; only one writer needs to wake it up
+  ddsrt_atomic_fence ();
+  if (ddsrt_atomic_ld32 (&q->thread_waiting) && ddsrt_atomic_cas32 (&q->thread_waiting, 1, 0))
+  {
+    ddsrt_mutex_lock (&q->lock);
+    ddsrt_cond_broadcast (&q->cond);
+    ddsrt_mutex_unlock (&q->lock);
+  }
 }
 
 void ddsi_xpack_send (struct ddsi_xpack *xp, bool immediately)
 {
+  (void) immediately;
   if (!xp->async_mode)
     ddsi_xpack_send_real (xp);
   else
@@ -1346,19 +1739,7 @@ void ddsi_xpack_send (struct ddsi_xpack *xp, bool immediately)
       memcpy (xp1->msgfrags->iov, xp->msgfrags->iov, xp->msgfrags->niov * sizeof (*xp->msgfrags->iov));
     }
     ddsi_xpack_reinit (xp);
-    xp1->sendq_next = NULL;
-    ddsrt_mutex_lock (&gv->sendq_lock);
-    while (gv->sendq_length >= SENDQ_MAX)
-      ddsrt_cond_wait (&gv->sendq_cond, &gv->sendq_lock);
-    if (immediately || gv->sendq_length == 0)
-      ddsrt_cond_broadcast (&gv->sendq_cond);
-    if (gv->sendq_head)
-      gv->sendq_tail->sendq_next = xp1;
-    else
-      gv->sendq_head = xp1;
-    gv->sendq_tail = xp1;
-    gv->sendq_length++;
-    ddsrt_mutex_unlock (&gv->sendq_lock);
+    ddsi_xpack_sendq_enqueue (gv->sendq, xp1);
   }
 }
 
@@ -1649,6 +2030,8 @@ int ddsi_xpack_addmsg (struct ddsi_xpack *xp, struct ddsi_xmsg *m, const uint32_
     xp->call_flags = flags;
     if (ddsi_xmsg_is_rexmit (m))
       xp->includes_rexmit = true;
+    if (m->refd_payload && m->refd_payload_iov.iov_len > xp->refd_payload_max)
+      xp->refd_payload_max = (uint32_t) m->refd_payload_iov.iov_len;
     ddsi_xmsg_chain_add (&xp->included_msgs, m);
     GVTRACE (" => now niov %d sz %"PRIuSIZE"\n", (int) niov, sz);
   }
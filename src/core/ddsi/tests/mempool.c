@@ -0,0 +1,177 @@
+// Copyright(c) 2025 ZettaScale Technology and others
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License v. 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Eclipse Distribution License
+// v. 1.0 which is available at
+// http://www.eclipse.org/org/documents/edl-v10.php.
+//
+// SPDX-License-Identifier: EPL-2.0 OR BSD-3-Clause
+
+#include "CUnit/Theory.h"
+#include "dds/ddsrt/heap.h"
+#include "dds/ddsrt/threads.h"
+#include "dds/ddsi/ddsi_iid.h"
+#include "dds/ddsi/ddsi_mempool.h"
+#include "ddsi__mempool.h"
+
+static uint32_t nfreed;
+
+static void count_free (void *obj)
+{
+  nfreed++;
+  ddsrt_free (obj);
+}
+
+static void setup (void)
+{
+  ddsi_iid_init ();
+  nfreed = 0;
+}
+
+static void teardown (void)
+{
+  ddsi_iid_fini ();
+}
+
+CU_Test (ddsi_mempool, size_classes, .init = setup, .fini = teardown)
+{
+  struct ddsi_mempool *pool = ddsi_mempool_new (64, 1024, 1024, SIZE_MAX, count_free);
+  uint32_t size;
+
+  // rounding a size to its size class doesn't touch the pool
+  CU_ASSERT (ddsi_mempool_class_size (pool, 100) == 128);
+  CU_ASSERT (ddsi_mempool_class_size (pool, 10) == 64);
+  CU_ASSERT (ddsi_mempool_class_size (pool, 1024) == 1024);
+  CU_ASSERT (ddsi_mempool_class_size (pool, 2000) == 2000);
+
+  // nothing in the pool yet, but the size gets rounded up to the size class
+  size = 100;
+  CU_ASSERT (ddsi_mempool_get (pool, &size) == NULL);
+  CU_ASSERT (size == 128);
+  size = 10;
+  CU_ASSERT (ddsi_mempool_get (pool, &size) == NULL);
+  CU_ASSERT (size == 64);
+  size = 2000;
+  CU_ASSERT (ddsi_mempool_get (pool, &size) == NULL);
+  CU_ASSERT (size == 2000);
+
+  // objects go in the largest class not exceeding their size
+  void *a = ddsrt_malloc (200), *b = ddsrt_malloc (32), *c = ddsrt_malloc (2048);
+  CU_ASSERT (ddsi_mempool_put (pool, a, 200));
+  CU_ASSERT (!ddsi_mempool_put (pool, b, 32));
+  CU_ASSERT (!ddsi_mempool_put (pool, c, 2048));
+  size = 129;
+  CU_ASSERT (ddsi_mempool_get (pool, &size) == NULL);
+  size = 65;
+  CU_ASSERT (ddsi_mempool_get (pool, &size) == a);
+  CU_ASSERT (size == 128);
+  CU_ASSERT (ddsi_mempool_put (pool, a, size));
+
+  struct ddsi_mempool_stats st;
+  ddsi_mempool_get_stats (pool, &st);
+  CU_ASSERT (st.gets == 5 && st.hits == 1);
+  CU_ASSERT (st.puts == 2 && st.rejects == 2);
+
+  ddsi_mempool_free (pool);
+  CU_ASSERT (nfreed == 1);
+  ddsrt_free (b);
+  ddsrt_free (c);
+}
+
+#define NOBJS 1000
+
+struct producer_arg {
+  struct ddsi_mempool *pool;
+  uint32_t nobjs;
+  bool thread_fini;
+  uint32_t naccepted;
+};
+
+static uint32_t producer (void *varg)
+{
+  struct producer_arg * const arg = varg;
+  arg->naccepted = 0;
+  for (uint32_t i = 0; i < arg->nobjs; i++)
+  {
+    void *obj = ddsrt_malloc (128);
+    if (ddsi_mempool_put (arg->pool, obj, 128))
+      arg->naccepted++;
+    else
+      ddsrt_free (obj);
+  }
+  if (arg->thread_fini)
+    ddsi_mempool_thread_fini ();
+  return 0;
+}
+
+static void run_producer (struct producer_arg *arg)
+{
+  ddsrt_thread_t tid;
+  ddsrt_threadattr_t attr;
+  ddsrt_threadattr_init (&attr);
+  dds_return_t rc = ddsrt_thread_create (&tid, "producer", &attr, producer, arg);
+  CU_ASSERT_FATAL (rc == 0);
+  rc = ddsrt_thread_join (tid, NULL);
+  CU_ASSERT_FATAL (rc == 0);
+}
+
+static uint32_t drain (struct ddsi_mempool *pool)
+{
+  uint32_t ngot = 0;
+  void *obj;
+  uint32_t size = 128;
+  while ((obj = ddsi_mempool_get (pool, &size)) != NULL)
+  {
+    ddsrt_free (obj);
+    ngot++;
+  }
+  return ngot;
+}
+
+CU_Test (ddsi_mempool, cross_thread, .init = setup, .fini = teardown)
+{
+  // Objects freed in one thread must be available to another one via the depot, but
+  // only up to the configured limit.  The limit for the depot here is 8 magazines of
+  // 32 objects, the producer thread retains one magazine itself.
+  struct producer_arg arg = { .pool = ddsi_mempool_new (128, 128, 256, SIZE_MAX, count_free), .nobjs = NOBJS };
+  run_producer (&arg);
+  CU_ASSERT (arg.naccepted == 256 + 32);
+  CU_ASSERT (drain (arg.pool) == 256);
+
+  struct ddsi_mempool_stats st;
+  ddsi_mempool_get_stats (arg.pool, &st);
+  CU_ASSERT (st.puts == 256 + 32);
+  CU_ASSERT (st.rejects == NOBJS - (256 + 32));
+  CU_ASSERT (st.hits == 256);
+  CU_ASSERT (st.exchanges == 8 + 8);
+
+  ddsi_mempool_free (arg.pool);
+  CU_ASSERT (nfreed == 32);
+}
+
+CU_Test (ddsi_mempool, thread_fini, .init = setup, .fini = teardown)
+{
+  // A terminating thread moves its magazines to the depot as far as the limit of 8
+  // magazines allows, frees the objects that don't fit and leaves nothing behind
+  struct producer_arg arg = { .pool = ddsi_mempool_new (128, 128, 256, SIZE_MAX, count_free), .nobjs = 40, .thread_fini = true };
+  run_producer (&arg);
+  CU_ASSERT (arg.naccepted == 40);
+  CU_ASSERT (nfreed == 0);
+  CU_ASSERT (drain (arg.pool) == 40);
+
+  arg.nobjs = NOBJS;
+  run_producer (&arg);
+  CU_ASSERT (arg.naccepted == 256 + 32);
+  CU_ASSERT (nfreed == 32);
+  CU_ASSERT (drain (arg.pool) == 256);
+
+  // the statistics of the terminated threads are retained
+  struct ddsi_mempool_stats st;
+  ddsi_mempool_get_stats (arg.pool, &st);
+  CU_ASSERT (st.puts == 40 + 256 + 32);
+  CU_ASSERT (st.hits == 40 + 256);
+
+  ddsi_mempool_free (arg.pool);
+  CU_ASSERT (nfreed == 32);
+}
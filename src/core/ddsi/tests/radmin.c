@@ -160,3 +160,39 @@ CU_Test (ddsi_radmin, drop_gap_at_end, .init = setup, .fini = teardown)
   ddsi_reorder_free (reorder);
   ddsi_defrag_free (defrag);
 }
+
+CU_Test (ddsi_radmin, batch_alloc, .init = setup, .fini = teardown)
+{
+  struct ddsi_defrag *defrag = ddsi_defrag_new (&gv.logconfig, DDSI_DEFRAG_DROP_LATEST, 1);
+  struct ddsi_reorder *reorder = ddsi_reorder_new (&gv.logconfig, DDSI_REORDER_MODE_NORMAL, 3, false);
+
+  // default receive buffer size is large enough for several maximum-sized messages
+  struct ddsi_rmsg *rmsgs[4];
+  uint32_t n = ddsi_rmsg_new_batch (rbpool, 4, rmsgs);
+  CU_ASSERT_FATAL (n == 4);
+  for (uint32_t i = 0; i < n; i++)
+  {
+    ddsi_rmsg_setsize (rmsgs[i], 0);
+    // all payloads must be usable at the same time
+    if (i > 0)
+      CU_ASSERT_FATAL ((unsigned char *) rmsgs[i] >= (unsigned char *) DDSI_RMSG_PAYLOAD (rmsgs[i-1]) + gv.config.rmsg_chunk_size);
+  }
+
+  // keep the second one alive by storing an out-of-order sample in the reorder admin
+  struct ddsi_receiver_state *rst = ddsi_rmsg_alloc (rmsgs[1], sizeof (*rst));
+  memset (rst, 0, sizeof (*rst));
+  insert_sample (defrag, reorder, rmsgs[1], rst, 2);
+  check_reorder (reorder, 0, 1, 3, (const ddsi_seqno_t[]){2,0});
+  for (uint32_t i = 0; i < n; i++)
+    ddsi_rmsg_commit (rmsgs[i]);
+  ddsi_rbufpool_end_batch (rbpool);
+
+  // memory following the one still in use is available again, the one in use isn't
+  struct ddsi_rmsg *rmsg = ddsi_rmsg_new (rbpool);
+  CU_ASSERT_FATAL ((unsigned char *) rmsg > (unsigned char *) rmsgs[1] && (unsigned char *) rmsg < (unsigned char *) rmsgs[2]);
+  ddsi_rmsg_setsize (rmsg, 0);
+  ddsi_rmsg_commit (rmsg);
+
+  ddsi_reorder_free (reorder);
+  ddsi_defrag_free (defrag);
+}
@@ -275,7 +275,7 @@ static void receive_packet_init (ddsi_guid_t *rdguid, ddsi_guid_t *wrguid, bool
     assert (ret == DDS_RETCODE_OK);
     (void) ret;
   }
-  ddsi_new_reader (&rd, rdguid, NULL, pp, "Q", st, &ddsi_default_qos_reader, &rhc.c, NULL, NULL, NULL);
+  ddsi_new_reader (&rd, rdguid, NULL, pp, "Q", st, &ddsi_default_qos_reader, &rhc.c, NULL, NULL, NULL, NULL);
   assert (ddsi_entidx_lookup_reader_guid (gv.entity_index, rdguid));
   // reader keeps sertype alive, so we can safely drop a reference here
   // (akin to deleting the topic after creating the reader in the API)
@@ -0,0 +1,158 @@
+// Copyright(c) 2025 ZettaScale Technology and others
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License v. 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Eclipse Distribution License
+// v. 1.0 which is available at
+// http://www.eclipse.org/org/documents/edl-v10.php.
+//
+// SPDX-License-Identifier: EPL-2.0 OR BSD-3-Clause
+
+#include <stdarg.h>
+#include <stdio.h>
+
+#include "CUnit/Theory.h"
+
+#include "dds/ddsrt/attributes.h"
+#include "dds/ddsrt/heap.h"
+#include "dds/ddsrt/threads.h"
+#include "dds/ddsrt/time.h"
+#include "dds/ddsi/ddsi_iid.h"
+#include "dds/ddsi/ddsi_domaingv.h"
+#include "dds/ddsi/ddsi_init.h"
+#include "dds/ddsi/ddsi_xmsg.h"
+#include "ddsi__xmsg.h"
+#include "ddsi__thread.h"
+
+static struct ddsi_domaingv gv;
+static struct ddsi_thread_state *thrst;
+
+static void null_log_sink (void *varg, const dds_log_data_t *msg)
+{
+  (void)varg; (void)msg;
+}
+
+/* Print message preceded by time stamp */
+static void tprintf (const char *msg, ...)
+  ddsrt_attribute_format_printf (1, 2);
+
+static void tprintf (const char *msg, ...)
+{
+  va_list args;
+  dds_time_t t = dds_time ();
+  printf ("%d.%06d ", (int32_t) (t / DDS_NSECS_IN_SEC), (int32_t) (t % DDS_NSECS_IN_SEC) / 1000);
+  va_start (args, msg);
+  vprintf (msg, args);
+  va_end (args);
+}
+
+static void setup (void)
+{
+  ddsi_iid_init ();
+  ddsi_thread_states_init ();
+
+  // see radmin.c: the main thread needs to look like it was created by Cyclone
+  thrst = ddsi_lookup_thread_state ();
+  // coverity[missing_lock:FALSE]
+  assert (thrst->state == DDSI_THREAD_STATE_LAZILY_CREATED);
+  thrst->state = DDSI_THREAD_STATE_ALIVE;
+  ddsrt_atomic_stvoidp (&thrst->gv, &gv);
+
+  memset (&gv, 0, sizeof (gv));
+  ddsi_config_init_default (&gv.config);
+  gv.config.transport_selector = DDSI_TRANS_NONE;
+
+  ddsi_config_prep (&gv, NULL);
+  dds_set_log_sink (null_log_sink, NULL);
+  dds_set_trace_sink (null_log_sink, NULL);
+
+  ddsi_init (&gv, NULL);
+  ddsi_xpack_sendq_init (&gv);
+  ddsi_xpack_sendq_start (&gv);
+}
+
+static void teardown (void)
+{
+  ddsi_fini (&gv);
+  // coverity[missing_lock:FALSE]
+  thrst->state = DDSI_THREAD_STATE_LAZILY_CREATED;
+  ddsi_thread_states_fini ();
+  ddsi_iid_fini ();
+}
+
+struct writer_arg {
+  uint32_t n;
+};
+
+static uint32_t writer_thread (void *varg)
+{
+  struct writer_arg const * const arg = varg;
+  // An async xpack without any messages in it is queued like any other, the send
+  // thread simply has nothing to transmit for it.  That makes it possible to
+  // exercise the queue without depending on the network.
+  struct ddsi_xpack *xp = ddsi_xpack_new (&gv, true);
+  for (uint32_t i = 0; i < arg->n; i++)
+    ddsi_xpack_send (xp, (i % 16) == 15);
+  ddsi_xpack_free (xp);
+  return 0;
+}
+
+static dds_duration_t run_writers (uint32_t nthreads, uint32_t n_per_thread, struct ddsi_xpack_sendq_stats *st0)
+{
+  ddsrt_thread_t *tids = ddsrt_malloc (nthreads * sizeof (*tids));
+  struct writer_arg arg = { .n = n_per_thread };
+  ddsrt_threadattr_t tattr;
+  ddsrt_threadattr_init (&tattr);
+  // the statistics are cumulative and a theory shares the set-up between its data points
+  ddsi_xpack_sendq_stats (&gv, st0);
+  const dds_time_t t0 = dds_time ();
+  for (uint32_t i = 0; i < nthreads; i++)
+  {
+    dds_return_t rc = ddsrt_thread_create (&tids[i], "sendq_writer", &tattr, writer_thread, &arg);
+    CU_ASSERT_FATAL (rc == DDS_RETCODE_OK);
+  }
+  for (uint32_t i = 0; i < nthreads; i++)
+    (void) ddsrt_thread_join (tids[i], NULL);
+  struct ddsi_xpack_sendq_stats st;
+  do {
+    ddsi_xpack_sendq_stats (&gv, &st);
+    if (st.sent - st0->sent != nthreads * n_per_thread)
+      dds_sleepfor (DDS_MSECS (1));
+  } while (st.sent - st0->sent != nthreads * n_per_thread);
+  const dds_time_t t1 = dds_time ();
+  ddsrt_free (tids);
+  return t1 - t0;
+}
+
+CU_Test (ddsi_sendq, all_sent, .init = setup, .fini = teardown)
+{
+  const uint32_t nthreads = 4, n_per_thread = 10000;
+  struct ddsi_xpack_sendq_stats st0, st;
+  (void) run_writers (nthreads, n_per_thread, &st0);
+  ddsi_xpack_sendq_stats (&gv, &st);
+  CU_ASSERT_FATAL (st.enqueued == nthreads * n_per_thread);
+  CU_ASSERT_FATAL (st.sent == nthreads * n_per_thread);
+  CU_ASSERT_FATAL (st.depth == 0);
+  CU_ASSERT_FATAL (st.max_depth > 0 && st.max_depth <= DDSI_XPACK_SENDQ_SIZE);
+  CU_ASSERT_FATAL (st.flushes > 0 && st.flushes <= st.sent);
+  CU_ASSERT_FATAL (st.max_flush > 0 && st.max_flush <= st.sent);
+}
+
+CU_TheoryDataPoints (ddsi_sendq, throughput) = {
+  CU_DataPoints (uint32_t, 1, 4, 16)
+};
+
+CU_Theory ((uint32_t nthreads), ddsi_sendq, throughput, .init = setup, .fini = teardown, .timeout = 60)
+{
+  const uint32_t n_total = 64000;
+  struct ddsi_xpack_sendq_stats st0, st;
+  const dds_duration_t dt = run_writers (nthreads, n_total / nthreads, &st0);
+  ddsi_xpack_sendq_stats (&gv, &st);
+  const uint32_t nsent = st.sent - st0.sent, nflushes = st.flushes - st0.flushes;
+  CU_ASSERT_FATAL (nsent == n_total);
+  CU_ASSERT_FATAL (st.enqueued - st0.enqueued == n_total);
+  CU_ASSERT_FATAL (nflushes > 0 && nflushes <= nsent);
+  tprintf ("sendq %2"PRIu32" writers: %.2f Mpkt/s, max depth %"PRIu32", enqueue waits %"PRIu32", flushes %"PRIu32" (avg %.1f)\n",
+           nthreads, (double) n_total / (double) dt * 1e3, st.max_depth, st.enqueue_waits - st0.enqueue_waits,
+           nflushes, (double) nsent / (double) nflushes);
+}
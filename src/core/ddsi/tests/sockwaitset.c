@@ -0,0 +1,173 @@
+// Copyright(c) 2025 ZettaScale Technology and others
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License v. 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Eclipse Distribution License
+// v. 1.0 which is available at
+// http://www.eclipse.org/org/documents/edl-v10.php.
+//
+// SPDX-License-Identifier: EPL-2.0 OR BSD-3-Clause
+
+#include <stdio.h>
+
+#include "CUnit/Test.h"
+
+#include "dds/ddsrt/heap.h"
+#include "dds/ddsrt/sockets.h"
+#include "dds/ddsrt/string.h"
+#include "ddsi__tran.h"
+#include "ddsi__sockwaitset.h"
+
+#define NCONNS 2
+#define NDGRAMS 20
+#define MAXDGRAM 1024
+
+// The waitset only needs the socket and to know whether the connection can handle
+// datagrams received on its behalf, so a minimal fake connection suffices.
+struct fake_conn {
+  struct ddsi_tran_conn c;
+  ddsrt_socket_t sock;
+  struct sockaddr_in addr;
+};
+
+static ddsrt_socket_t fake_conn_handle (struct ddsi_tran_base *base)
+{
+  return ((struct fake_conn *) base)->sock;
+}
+
+static void fake_conn_read_done (struct ddsi_tran_conn *conn, ddsrt_msghdr_t *msghdr, unsigned char *buf, size_t len, size_t nrecv, struct ddsi_network_packet_info *pktinfo)
+{
+  (void) conn; (void) msghdr; (void) buf; (void) len; (void) nrecv; (void) pktinfo;
+}
+
+static struct sockaddr_in bound_socket (ddsrt_socket_t *sock)
+{
+  struct sockaddr_in addr = { .sin_family = AF_INET, .sin_addr.s_addr = htonl (INADDR_LOOPBACK) };
+  socklen_t addrlen = sizeof (addr);
+  dds_return_t rc;
+  rc = ddsrt_socket (sock, AF_INET, SOCK_DGRAM, 0);
+  CU_ASSERT_FATAL (rc == DDS_RETCODE_OK);
+  rc = ddsrt_bind (*sock, (struct sockaddr *) &addr, sizeof (addr));
+  CU_ASSERT_FATAL (rc == DDS_RETCODE_OK);
+  rc = ddsrt_getsockname (*sock, (struct sockaddr *) &addr, &addrlen);
+  CU_ASSERT_FATAL (rc == DDS_RETCODE_OK);
+  return addr;
+}
+
+static void send_dgram (ddsrt_socket_t sock, const struct sockaddr_in *dst, const void *buf, size_t len)
+{
+  ddsrt_iovec_t iov = { .iov_base = (void *) buf, .iov_len = (ddsrt_iov_len_t) len };
+  ddsrt_msghdr_t msg;
+  memset (&msg, 0, sizeof (msg));
+  msg.msg_name = (void *) dst;
+  msg.msg_namelen = sizeof (*dst);
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  ssize_t sent;
+  dds_return_t rc = ddsrt_sendmsg (sock, &msg, 0, &sent);
+  CU_ASSERT_FATAL (rc == DDS_RETCODE_OK && (size_t) sent == len);
+}
+
+// Receives until a datagram has arrived on conns[stop_at] (or on any of them if
+// stop_at < 0 and there are no more events), checking the contents along the way
+static void receive_dgrams (struct ddsi_sock_waitset *ws, struct fake_conn *conns, const struct sockaddr_in *src, uint32_t *seq, int stop_at)
+{
+  bool stop = false;
+  for (int iter = 0; !stop && iter < 1000; iter++)
+  {
+    struct ddsi_sock_waitset_ctx *ctx = ddsi_sock_waitset_wait (ws);
+    CU_ASSERT_FATAL (ctx != NULL);
+    struct ddsi_tran_conn *conn;
+    int idx;
+    while ((idx = ddsi_sock_waitset_next_event (ctx, &conn)) >= 0)
+    {
+      CU_ASSERT_FATAL (idx < NCONNS && conn == &conns[idx].c);
+      struct ddsi_sock_waitset_dgram dgram;
+      CU_ASSERT_FATAL (ddsi_sock_waitset_event_dgram (ctx, &dgram));
+      CU_ASSERT_FATAL (dgram.len == MAXDGRAM);
+      struct sockaddr_in from;
+      CU_ASSERT_FATAL (dgram.msghdr->msg_namelen == sizeof (from));
+      memcpy (&from, dgram.msghdr->msg_name, sizeof (from));
+      CU_ASSERT_FATAL (from.sin_port == src->sin_port);
+      // datagrams on a socket arrive in order: "<idx> <seq>", or large ones that get truncated
+      if (seq[idx] == NDGRAMS)
+      {
+        CU_ASSERT_FATAL (dgram.sz == MAXDGRAM);
+        CU_ASSERT_FATAL (dgram.msghdr->msg_flags & MSG_TRUNC);
+      }
+      else
+      {
+        char expected[32];
+        (void) snprintf (expected, sizeof (expected), "%d %"PRIu32, idx, seq[idx]);
+        CU_ASSERT_FATAL (dgram.sz == strlen (expected) && memcmp (dgram.buf, expected, dgram.sz) == 0);
+      }
+      seq[idx]++;
+      if (idx == stop_at)
+        stop = true;
+    }
+    if (stop_at < 0)
+      stop = true;
+  }
+  CU_ASSERT_FATAL (stop);
+}
+
+CU_Test (ddsi_sockwaitset, io_uring)
+{
+  struct ddsi_sock_waitset *ws;
+  if ((ws = ddsi_sock_waitset_new_io_uring (4, MAXDGRAM)) == NULL)
+  {
+    printf ("io_uring not supported, skipping\n");
+    return;
+  }
+
+  struct fake_conn conns[NCONNS];
+  ddsrt_socket_t sender;
+  const struct sockaddr_in src = bound_socket (&sender);
+  for (int i = 0; i < NCONNS; i++)
+  {
+    memset (&conns[i], 0, sizeof (conns[i]));
+    conns[i].addr = bound_socket (&conns[i].sock);
+    conns[i].c.m_base.m_handle_fn = fake_conn_handle;
+    conns[i].c.m_read_done_fn = fake_conn_read_done;
+    conns[i].c.m_connless = true;
+    CU_ASSERT_FATAL (ddsi_sock_waitset_add (ws, &conns[i].c) == 1);
+  }
+
+  // many more datagrams than there are buffers, followed by one that doesn't fit
+  unsigned char *big = ddsrt_malloc (MAXDGRAM + 1);
+  memset (big, 0, MAXDGRAM + 1);
+  for (uint32_t j = 0; j < NDGRAMS; j++)
+  {
+    for (int i = 0; i < NCONNS; i++)
+    {
+      char buf[32];
+      (void) snprintf (buf, sizeof (buf), "%d %"PRIu32, i, j);
+      send_dgram (sender, &conns[i].addr, buf, strlen (buf));
+    }
+  }
+  for (int i = 0; i < NCONNS; i++)
+    send_dgram (sender, &conns[i].addr, big, MAXDGRAM + 1);
+  uint32_t seq[NCONNS] = { 0 };
+  while (seq[0] < NDGRAMS + 1 || seq[1] < NDGRAMS + 1)
+    receive_dgrams (ws, conns, &src, seq, (seq[0] < NDGRAMS + 1) ? 0 : 1);
+  CU_ASSERT_FATAL (seq[0] == NDGRAMS + 1 && seq[1] == NDGRAMS + 1);
+
+  // nothing is received any more for a removed connection
+  ddsi_sock_waitset_remove (ws, &conns[1].c);
+  send_dgram (sender, &conns[1].addr, "x", 1);
+  seq[0] = 0;
+  send_dgram (sender, &conns[0].addr, "0 0", 3);
+  receive_dgrams (ws, conns, &src, seq, 0);
+  CU_ASSERT_FATAL (seq[0] == 1 && seq[1] == NDGRAMS + 1);
+
+  // triggering wakes it up without any events
+  ddsi_sock_waitset_trigger (ws);
+  receive_dgrams (ws, conns, &src, seq, -1);
+  CU_ASSERT_FATAL (seq[0] == 1 && seq[1] == NDGRAMS + 1);
+
+  ddsi_sock_waitset_free (ws);
+  ddsrt_free (big);
+  for (int i = 0; i < NCONNS; i++)
+    ddsrt_close (conns[i].sock);
+  ddsrt_close (sender);
+}
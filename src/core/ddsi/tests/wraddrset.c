@@ -8,11 +8,15 @@
 //
 // SPDX-License-Identifier: EPL-2.0 OR BSD-3-Clause
 
+#include <stdio.h>
+#include <string.h>
+
 #include "CUnit/Theory.h"
 #include "dds/ddsrt/cdtors.h"
 #include "dds/ddsrt/heap.h"
 #include "dds/ddsrt/endian.h"
 #include "dds/ddsrt/environ.h"
+#include "dds/ddsrt/time.h"
 #include "dds/ddsi/ddsi_iid.h"
 #include "dds/ddsi/ddsi_proxy_participant.h"
 #include "dds/ddsi/ddsi_entity_index.h"
@@ -275,3 +279,199 @@ CU_Test (ddsi_wraddrset, some_cases)
   }
   CU_PASS ("I want to keep this code, but I don't know yet what the test expectation should be ...");
 }
+
+#define JOIN_LEAVE_NRDS 2000
+
+struct join_leave_cover {
+  bool mc;
+  bool uc[JOIN_LEAVE_NRDS];
+};
+
+static void join_leave_reader_loc (ddsi_locator_t *loc, int k)
+{
+  *loc = (ddsi_locator_t){
+    .kind = DDSI_LOCATOR_KIND_UDPv4,
+    .address = {0,0,0,0, 0,0,0,0, 0,0,0,0, 10,0,(unsigned char) (k / 256),(unsigned char) (k % 256)},
+    .port = 7410
+  };
+}
+
+static void join_leave_cover_helper (const ddsi_xlocator_t *loc, void *varg)
+{
+  struct join_leave_cover * const cover = varg;
+  if (ddsi_is_mcaddr (&gv, &loc->c))
+    cover->mc = true;
+  else
+  {
+    const int k = 256 * loc->c.address[14] + loc->c.address[15];
+    CU_ASSERT_FATAL (loc->c.address[12] == 10 && k < JOIN_LEAVE_NRDS);
+    cover->uc[k] = true;
+  }
+}
+
+static void join_leave_check_cover (struct ddsi_writer *wr, const bool *present, const bool *has_mc)
+{
+  // every matched reader must be reachable via either its unicast address or via the multicast
+  // address if it has one
+  struct join_leave_cover *cover = ddsrt_malloc (sizeof (*cover));
+  memset (cover, 0, sizeof (*cover));
+  ddsrt_mutex_lock (&wr->e.lock);
+  ddsi_addrset_forall (wr->as, join_leave_cover_helper, cover);
+  ddsrt_mutex_unlock (&wr->e.lock);
+  for (int k = 0; k < JOIN_LEAVE_NRDS; k++)
+  {
+    if (present[k])
+      CU_ASSERT_FATAL (cover->uc[k] || (has_mc[k] && cover->mc));
+  }
+  ddsrt_free (cover);
+}
+
+static void join_leave_wait_for_nreaders (struct ddsi_writer *wr, uint32_t n)
+{
+  // proxy reader deletion is completed by the garbage collector, which requires that
+  // this thread is not awake
+  ddsi_thread_state_asleep (ddsi_lookup_thread_state ());
+  uint32_t m;
+  do {
+    ddsrt_mutex_lock (&wr->e.lock);
+    m = wr->num_readers;
+    ddsrt_mutex_unlock (&wr->e.lock);
+    if (m != n)
+      dds_sleepfor (DDS_MSECS (1));
+  } while (m != n);
+  ddsi_thread_state_awake (ddsi_lookup_thread_state (), &gv);
+}
+
+CU_Test (ddsi_wraddrset, join_leave, .timeout = 120)
+{
+  const ddsi_locator_t mcloc = {
+    .kind = DDSI_LOCATOR_KIND_UDPv4, .address = {0,0,0,0, 0,0,0,0, 0,0,0,0, 239,255,0,1}, .port = 7400
+  };
+  const ddsi_plist_t plist_pp = {
+    .present = 0,
+    .qos = {
+      .present = DDSI_QP_LIVELINESS,
+      .liveliness = { .kind = DDS_LIVELINESS_AUTOMATIC, .lease_duration = DDS_INFINITY }
+    }
+  };
+  static bool present[JOIN_LEAVE_NRDS], has_mc[JOIN_LEAVE_NRDS];
+  ddsi_guid_t wrppguid, rdppguid;
+
+  setup_and_start ();
+  ddsi_thread_state_awake (ddsi_lookup_thread_state (), &gv);
+  ddsi_generate_participant_guid (&wrppguid, &gv);
+  ddsi_new_participant (&wrppguid, &gv, 0, &plist_pp);
+
+  const struct ddsi_sertype st = {
+    .ops = &(struct ddsi_sertype_ops){ .free = sertype_free },
+    .serdata_ops = &(struct ddsi_serdata_ops){ NULL },
+    .serdata_basehash = 0,
+    .has_key = 0,
+    .request_keyhash = 0,
+    .is_memcpy_safe = 1,
+    .allowed_data_representation = DDS_DATA_REPRESENTATION_RESTRICT_DEFAULT,
+    .type_name = "Q",
+    .gv = DDSRT_ATOMIC_VOIDP_INIT (&gv),
+    .flags_refc = DDSRT_ATOMIC_UINT32_INIT (0),
+    .base_sertype = NULL,
+    .sizeof_type = 8,
+    .data_type_props = DDS_DATA_TYPE_IS_MEMCPY_SAFE
+  };
+  struct ddsi_whc whc = {
+    .ops = &(struct ddsi_whc_ops){
+      .get_state = whc_get_state,
+      .remove_acked_messages = whc_remove_acked_messages,
+      .free_deferred_free_list = whc_free_deferred_free_list,
+      .free = whc_free
+    }
+  };
+  struct ddsi_participant *pp = ddsi_entidx_lookup_participant_guid (gv.entity_index, &wrppguid);
+  struct ddsi_writer *wr;
+  ddsi_guid_t wrguid;
+  dds_return_t ret = ddsi_generate_writer_guid (&wrguid, pp, &st);
+  CU_ASSERT_FATAL (ret == DDS_RETCODE_OK);
+  ddsi_new_writer (&wr, &wrguid, NULL, pp, "Q", &st, &ddsi_default_qos_writer, &whc, NULL, NULL, NULL);
+
+  // all readers live in a single proxy participant, that keeps the setup cheap and doesn't
+  // affect the address set computation, which only looks at the readers' locators
+  rdppguid = (ddsi_guid_t){ .prefix = { .u = { 0, 1, 1 } }, .entityid = { .u = DDSI_ENTITYID_PARTICIPANT } };
+  struct ddsi_addrset *proxypp_as = ddsi_new_addrset ();
+  ddsi_add_locator_to_addrset (&gv, proxypp_as, &mcloc);
+  struct ddsi_proxy_participant *proxy_participant;
+  ddsi_new_proxy_participant (&proxy_participant, &gv, &rdppguid, 0, proxypp_as, ddsi_ref_addrset (proxypp_as), &plist_pp, DDS_INFINITY, DDSI_VENDORID_ECLIPSE, ddsrt_time_wallclock (), 1);
+  CU_ASSERT_FATAL (proxy_participant != NULL);
+
+  ddsi_plist_t plist_rd = { .present = 0, .qos = ddsi_default_qos_reader };
+  plist_rd.qos.present |= DDSI_QP_TOPIC_NAME | DDSI_QP_TYPE_NAME;
+  plist_rd.qos.reliability.kind = DDS_RELIABILITY_RELIABLE;
+  plist_rd.qos.topic_name = "Q";
+  plist_rd.qos.type_name = "Q";
+
+  // 3 phases: all readers join one by one, then 1/4 of them repeatedly leave and join again,
+  // then all leave; one in three readers only has a unicast address
+  const int nchurn = JOIN_LEAVE_NRDS / 4;
+  dds_time_t tjoin = 0, tchurn = 0, tleave = 0;
+  for (int phase = 0; phase < 3; phase++)
+  {
+    const dds_time_t t0 = dds_time ();
+    const int nops = (phase == 1) ? 2 * nchurn : JOIN_LEAVE_NRDS;
+    for (int op = 0; op < nops; op++)
+    {
+      const int k = (phase == 1) ? (op % nchurn) * 4 : op;
+      const ddsi_guid_t rdguid = {
+        .prefix = rdppguid.prefix,
+        .entityid = { .u = DDSI_ENTITYID_ALLOCSTEP * (unsigned) (k + 1) | DDSI_ENTITYID_SOURCE_USER | DDSI_ENTITYID_KIND_READER_NO_KEY }
+      };
+      if (present[k])
+      {
+        ddsrt_mutex_lock (&wr->e.lock);
+        const uint32_t nrds = wr->num_readers;
+        ddsrt_mutex_unlock (&wr->e.lock);
+        ret = ddsi_delete_proxy_reader (&gv, &rdguid, ddsrt_time_wallclock (), false);
+        CU_ASSERT_FATAL (ret == 0);
+        present[k] = false;
+        if (phase == 1)
+          join_leave_wait_for_nreaders (wr, nrds - 1);
+      }
+      else
+      {
+        ddsi_locator_t loc;
+        join_leave_reader_loc (&loc, k);
+        has_mc[k] = (k % 3) != 0;
+        struct ddsi_addrset *rd_as = ddsi_new_addrset ();
+        ddsi_add_locator_to_addrset (&gv, rd_as, &loc);
+        if (has_mc[k])
+          ddsi_add_locator_to_addrset (&gv, rd_as, &mcloc);
+        struct ddsi_proxy_reader *proxy_reader;
+#if DDSRT_HAVE_SSM
+        ddsi_new_proxy_reader (&proxy_reader, &gv, &rdppguid, &rdguid, rd_as, &plist_rd, ddsrt_time_wallclock (), 1, false);
+#else
+        ddsi_new_proxy_reader (&proxy_reader, &gv, &rdppguid, &rdguid, rd_as, &plist_rd, ddsrt_time_wallclock (), 1);
+#endif
+        CU_ASSERT_FATAL (proxy_reader != NULL);
+        ddsi_unref_addrset (rd_as);
+        present[k] = true;
+      }
+    }
+    if (phase == 2)
+      join_leave_wait_for_nreaders (wr, 0);
+    const dds_time_t t1 = dds_time ();
+    switch (phase)
+    {
+      case 0: tjoin = t1 - t0; break;
+      case 1: tchurn = t1 - t0; break;
+      case 2: tleave = t1 - t0; break;
+    }
+    join_leave_check_cover (wr, present, has_mc);
+  }
+
+  ddsrt_mutex_lock (&wr->e.lock);
+  CU_ASSERT (wr->num_readers == 0);
+  CU_ASSERT (ddsi_addrset_empty (wr->as));
+  ddsrt_mutex_unlock (&wr->e.lock);
+  printf ("%d readers: join %.3fs churn %.3fs leave %.3fs\n", JOIN_LEAVE_NRDS,
+          (double) tjoin / 1e9, (double) tchurn / 1e9, (double) tleave / 1e9);
+
+  ddsi_thread_state_asleep (ddsi_lookup_thread_state ());
+  stop_and_teardown ();
+}
@@ -0,0 +1,193 @@
+// Copyright(c) 2025 ZettaScale Technology and others
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License v. 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Eclipse Distribution License
+// v. 1.0 which is available at
+// http://www.eclipse.org/org/documents/edl-v10.php.
+//
+// SPDX-License-Identifier: EPL-2.0 OR BSD-3-Clause
+
+#include <stdio.h>
+
+#include "CUnit/Theory.h"
+
+#include "dds/ddsrt/heap.h"
+#include "dds/ddsrt/random.h"
+#include "dds/ddsrt/time.h"
+#include "dds/ddsi/ddsi_iid.h"
+#include "dds/ddsi/ddsi_domaingv.h"
+#include "dds/ddsi/ddsi_init.h"
+#include "dds/ddsi/ddsi_xevent.h"
+#include "ddsi__xevent.h"
+#include "ddsi__thread.h"
+
+static struct ddsi_domaingv gv;
+static struct ddsi_thread_state *thrst;
+static struct ddsi_xeventq *evq;
+
+static void null_log_sink (void *varg, const dds_log_data_t *msg)
+{
+  (void)varg; (void)msg;
+}
+
+static void setup (enum ddsi_xeventq_impl impl, int nshards)
+{
+  ddsi_iid_init ();
+  ddsi_thread_states_init ();
+
+  // see radmin.c: the main thread needs to look like it was created by Cyclone
+  thrst = ddsi_lookup_thread_state ();
+  // coverity[missing_lock:FALSE]
+  assert (thrst->state == DDSI_THREAD_STATE_LAZILY_CREATED);
+  thrst->state = DDSI_THREAD_STATE_ALIVE;
+  ddsrt_atomic_stvoidp (&thrst->gv, &gv);
+
+  memset (&gv, 0, sizeof (gv));
+  ddsi_config_init_default (&gv.config);
+  gv.config.transport_selector = DDSI_TRANS_NONE;
+  gv.config.xeventq_impl = impl;
+  gv.config.xeventq_shards = nshards;
+
+  ddsi_config_prep (&gv, NULL);
+  dds_set_log_sink (null_log_sink, NULL);
+  dds_set_trace_sink (null_log_sink, NULL);
+
+  ddsi_init (&gv, NULL);
+  // a queue without a thread, events get handled by ddsi_xeventq_step
+  evq = ddsi_xeventq_new (&gv, 0, 0);
+}
+
+static void teardown (void)
+{
+  ddsi_xeventq_free (evq);
+  ddsi_fini (&gv);
+  // coverity[missing_lock:FALSE]
+  thrst->state = DDSI_THREAD_STATE_LAZILY_CREATED;
+  ddsi_thread_states_fini ();
+  ddsi_iid_fini ();
+}
+
+struct event_arg {
+  ddsrt_mtime_t tsched;
+  uint32_t *count;
+};
+
+static void event_cb (struct ddsi_domaingv *gv_arg, struct ddsi_xevent *ev, struct ddsi_xpack *xp, void *varg, ddsrt_mtime_t tnow)
+{
+  (void) gv_arg; (void) ev; (void) xp;
+  struct event_arg * const arg = varg;
+  CU_ASSERT_FATAL (tnow.v >= arg->tsched.v);
+  (*arg->count)++;
+}
+
+static ddsrt_mtime_t random_time (ddsrt_prng_t *prng, ddsrt_mtime_t t, dds_duration_t range)
+{
+  return ddsrt_mtime_add_duration (t, (dds_duration_t) (ddsrt_prng_random (prng) % (uint32_t) (range / DDS_USECS (1))) * DDS_USECS (1));
+}
+
+CU_TheoryDataPoints (ddsi_xevent, on_time) = {
+  CU_DataPoints (enum ddsi_xeventq_impl, DDSI_XEVQ_HEAP, DDSI_XEVQ_WHEEL)
+};
+
+CU_Theory ((enum ddsi_xeventq_impl impl), ddsi_xevent, on_time)
+{
+  setup (impl, 0);
+  ddsrt_prng_t prng;
+  ddsrt_prng_init_simple (&prng, 1);
+  const uint32_t n = 1000;
+  uint32_t count = 0;
+  struct ddsi_xevent **evs = ddsrt_malloc (n * sizeof (*evs));
+  const ddsrt_mtime_t t0 = ddsrt_time_monotonic ();
+  for (uint32_t i = 0; i < n; i++)
+  {
+    struct event_arg arg = { .tsched = random_time (&prng, t0, DDS_MSECS (50)), .count = &count };
+    evs[i] = ddsi_qxev_callback (evq, arg.tsched, event_cb, &arg, sizeof (arg), false);
+  }
+  // the callback checks that none fires too early
+  while (count < n && ddsrt_time_monotonic ().v < t0.v + DDS_SECS (5))
+  {
+    ddsi_xeventq_step (evq);
+    dds_sleepfor (DDS_USECS (100));
+  }
+  CU_ASSERT_FATAL (count == n);
+  for (uint32_t i = 0; i < n; i++)
+  {
+    CU_ASSERT_FATAL (!ddsi_xevent_is_scheduled (evs[i]));
+    ddsi_delete_xevent (evs[i]);
+  }
+  ddsrt_free (evs);
+  teardown ();
+}
+
+CU_TheoryDataPoints (ddsi_xevent, reschedule) = {
+  CU_DataPoints (enum ddsi_xeventq_impl, DDSI_XEVQ_HEAP, DDSI_XEVQ_WHEEL)
+};
+
+CU_Theory ((enum ddsi_xeventq_impl impl), ddsi_xevent, reschedule, .timeout = 60)
+{
+  setup (impl, 0);
+  ddsrt_prng_t prng;
+  ddsrt_prng_init_simple (&prng, 1);
+  const uint32_t n = 1000000;
+  uint32_t count = 0;
+  struct ddsi_xevent **evs = ddsrt_malloc (n * sizeof (*evs));
+  // not interested in whether they fire on time here
+  const struct event_arg arg = { .tsched = { 0 }, .count = &count };
+
+  // schedule everything well into the future, spread over 100s
+  const ddsrt_mtime_t tbase = ddsrt_mtime_add_duration (ddsrt_time_monotonic (), DDS_SECS (1000));
+  const ddsrt_mtime_t tearlier = { tbase.v - DDS_SECS (200) };
+  const ddsrt_mtime_t t0 = ddsrt_time_monotonic ();
+  for (uint32_t i = 0; i < n; i++)
+    evs[i] = ddsi_qxev_callback (evq, random_time (&prng, tbase, DDS_SECS (100)), event_cb, &arg, sizeof (arg), false);
+  // reschedule everything a bit earlier, like heartbeats and acknacks do all the time
+  const ddsrt_mtime_t t1 = ddsrt_time_monotonic ();
+  for (uint32_t i = 0; i < n; i++)
+  {
+    const int r = ddsi_resched_xevent_if_earlier (evs[i], random_time (&prng, tearlier, DDS_SECS (100)));
+    CU_ASSERT_FATAL (r);
+  }
+  // make everything due, then handle it
+  const ddsrt_mtime_t t2 = ddsrt_time_monotonic ();
+  for (uint32_t i = 0; i < n; i++)
+    (void) ddsi_resched_xevent_if_earlier (evs[i], t2);
+  ddsi_xeventq_step (evq);
+  const ddsrt_mtime_t t3 = ddsrt_time_monotonic ();
+  CU_ASSERT_FATAL (count == n);
+  for (uint32_t i = 0; i < n; i++)
+    ddsi_delete_xevent (evs[i]);
+  ddsi_xeventq_step (evq);
+  ddsrt_free (evs);
+
+  printf ("xevent %s: schedule %.1f ns/event, reschedule %.1f ns/event, fire %.1f ns/event\n",
+          (impl == DDSI_XEVQ_WHEEL) ? "wheel" : "heap",
+          (double) (t1.v - t0.v) / n, (double) (t2.v - t1.v) / n, (double) (t3.v - t2.v) / n);
+  teardown ();
+}
+
+CU_Test (ddsi_xevent, shards)
+{
+  setup (DDSI_XEVQ_HEAP, 4);
+  CU_ASSERT_FATAL (gv.n_xevent_shards == 4);
+  uint32_t counts[4] = { 0 };
+  ddsi_guid_t guid = { .prefix = { .u = { 0x01100000, 0x12345678, 0x9abcdef0 } } };
+  for (uint32_t i = 1; i <= 1000; i++)
+  {
+    guid.entityid.u = (i << 8) | DDSI_ENTITYID_KIND_WRITER_WITH_KEY;
+    struct ddsi_xeventq * const q = ddsi_xeventq_for_guid (&gv, &guid);
+    CU_ASSERT_FATAL (q == ddsi_xeventq_for_guid (&gv, &guid));
+    uint32_t j;
+    for (j = 0; j < gv.n_xevent_shards && gv.xevent_shards[j] != q; j++)
+      ;
+    CU_ASSERT_FATAL (j < gv.n_xevent_shards);
+    counts[j]++;
+  }
+  // spread isn't perfect, but no shard should be (nearly) empty
+  for (uint32_t j = 0; j < 4; j++)
+    CU_ASSERT_FATAL (counts[j] > 150);
+  // built-in endpoints are always handled by the default queue
+  guid.entityid.u = DDSI_ENTITYID_SEDP_BUILTIN_PUBLICATIONS_WRITER;
+  CU_ASSERT_FATAL (ddsi_xeventq_for_guid (&gv, &guid) == gv.xevents);
+  teardown ();
+}
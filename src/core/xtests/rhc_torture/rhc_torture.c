@@ -17,6 +17,8 @@
 #include "dds/ddsrt/heap.h"
 #include "dds/ddsrt/process.h"
 #include "dds/ddsrt/sync.h"
+#include "dds/ddsrt/threads.h"
+#include "dds/ddsrt/atomics.h"
 #include "dds/ddsrt/random.h"
 #include "dds/ddsrt/cdtors.h"
 #include "dds/ddsi/ddsi_tkmap.h"
@@ -902,6 +904,193 @@ static void test_conditions (dds_entity_t pp, dds_entity_t tp, const int count,
     fwr (wr[i]);
 }
 
+#define CONC_N_KEYVALS 96 /* multiple of CONC_NWRITERS and CONC_NREADERS */
+#define CONC_NWRITERS 2
+#define CONC_NREADERS 3
+#define CONC_MAX_SAMPLES 16
+
+struct conc_arg {
+  struct ddsi_domaingv *gv;
+  struct dds_rhc *rhc;
+  struct ddsi_proxy_writer *wr[CONC_NWRITERS];
+  uint64_t iids[CONC_N_KEYVALS];
+  uint32_t count;
+  ddsrt_atomic_uint32_t ntaken;
+  ddsrt_atomic_uint32_t stop;
+};
+
+struct conc_thread_arg {
+  struct conc_arg *arg;
+  uint32_t idx;
+  ddsrt_prng_t prng;
+};
+
+static struct ddsi_serdata *mksample_conc (int32_t keyval, int32_t x, int32_t y, unsigned statusinfo)
+{
+  /* mksample isn't thread-safe, and the writer and sequence number need to be in the sample */
+  RhcTypes_T d = { keyval, "A", x, y, "B" };
+  struct ddsi_serdata *sd = ddsi_serdata_from_sample (mdtype, SDK_DATA, &d);
+  sd->statusinfo = statusinfo;
+  sd->timestamp.v = dds_time ();
+  return sd;
+}
+
+static uint32_t conc_writer_thread (void *varg)
+{
+  struct conc_thread_arg * const targ = varg;
+  struct conc_arg * const arg = targ->arg;
+  int32_t seqs[CONC_N_KEYVALS] = { 0 };
+  ddsi_thread_state_awake (ddsi_lookup_thread_state (), arg->gv);
+  ddsi_thread_state_asleep (ddsi_lookup_thread_state ());
+  for (uint32_t i = 0; i < arg->count; i++)
+  {
+    /* mostly write "own" instances, which should mostly only require the instance
+       lock, but sometimes also the others, which changes the registrations and
+       requires exclusive access; likewise for the occasional dispose */
+    const uint32_t r = ddsrt_prng_random (&targ->prng);
+    int32_t k = (int32_t) ((r >> 8) % CONC_N_KEYVALS);
+    if ((r % 8) != 0)
+      k += (int32_t) targ->idx - k % CONC_NWRITERS;
+    const unsigned statusinfo = ((r % 64) == 1) ? DDSI_STATUSINFO_DISPOSE : 0;
+    (void) store (arg->gv->m_tkmap, arg->rhc, arg->wr[targ->idx], mksample_conc (k, ++seqs[k], (int32_t) targ->idx, statusinfo), false, false);
+  }
+  return 0;
+}
+
+static uint32_t conc_reader_thread (void *varg)
+{
+  struct conc_thread_arg * const targ = varg;
+  struct conc_arg * const arg = targ->arg;
+  int32_t lastseq[CONC_N_KEYVALS][CONC_NWRITERS] = {{ 0 }};
+  dds_sample_info_t iseq[CONC_MAX_SAMPLES];
+  RhcTypes_T mseq[CONC_MAX_SAMPLES];
+  void *ptrs[CONC_MAX_SAMPLES];
+  memset (mseq, 0, sizeof (mseq));
+  for (int i = 0; i < CONC_MAX_SAMPLES; i++)
+    ptrs[i] = &mseq[i];
+  ddsi_thread_state_awake (ddsi_lookup_thread_state (), arg->gv);
+  ddsi_thread_state_asleep (ddsi_lookup_thread_state ());
+  while (!ddsrt_atomic_ld32 (&arg->stop))
+  {
+    /* each reader thread has its own subset of the instances, so it can check that
+       it sees the samples of each writer exactly once and in order */
+    const uint32_t r = ddsrt_prng_random (&targ->prng);
+    int32_t k = (int32_t) ((r >> 8) % CONC_N_KEYVALS);
+    k += (int32_t) targ->idx - k % CONC_NREADERS;
+    const bool take = (r % 4) != 0;
+    struct dds_read_collect_sample_arg collarg;
+    dds_read_collect_sample_arg_init (&collarg, ptrs, iseq, NULL, NULL);
+    ddsi_thread_state_awake_domain_ok (ddsi_lookup_thread_state ());
+    const int32_t n = (take ? dds_rhc_take : dds_rhc_read) (arg->rhc, CONC_MAX_SAMPLES, DDS_ANY_SAMPLE_STATE | DDS_ANY_VIEW_STATE | DDS_ANY_INSTANCE_STATE, arg->iids[k], NULL, dds_read_collect_sample, &collarg);
+    ddsi_thread_state_asleep (ddsi_lookup_thread_state ());
+    if (n < 0)
+    {
+      printf ("concurrent: %s of instance %"PRId32" failed: %"PRId32"\n", take ? "take" : "read", k, n);
+      abort ();
+    }
+    uint32_t ntaken = 0;
+    for (int32_t i = 0; i < n; i++)
+    {
+      if (!iseq[i].valid_data)
+        continue;
+      const int32_t w = mseq[i].y, x = mseq[i].x;
+      if (mseq[i].k != k || iseq[i].instance_handle != arg->iids[k] || w < 0 || w >= CONC_NWRITERS)
+      {
+        printf ("concurrent: unexpected sample k %"PRId32" w %"PRId32" in instance %"PRId32"\n", mseq[i].k, w, k);
+        abort ();
+      }
+      if (take ? (x != lastseq[k][w] + 1) : (x <= lastseq[k][w]))
+      {
+        printf ("concurrent: %s instance %"PRId32" writer %"PRId32" seq %"PRId32" after %"PRId32"\n", take ? "take" : "read", k, w, x, lastseq[k][w]);
+        abort ();
+      }
+      if (take)
+      {
+        lastseq[k][w] = x;
+        ntaken++;
+      }
+    }
+    if (ntaken > 0)
+      ddsrt_atomic_add32 (&arg->ntaken, ntaken);
+  }
+  for (int i = 0; i < CONC_MAX_SAMPLES; i++)
+    RhcTypes_T_free (&mseq[i], DDS_FREE_CONTENTS);
+  return 0;
+}
+
+static void test_concurrent (dds_entity_t pp, const int count, bool print)
+{
+  /* Writers and readers operating on the same cache in parallel, with some operations
+     that can be done with only the instance locked, some that require the entire cache
+     (including the occasional read of all instances from this thread) */
+  struct ddsi_domaingv *gv = get_gv (pp);
+  struct conc_arg arg;
+  memset (&arg, 0, sizeof (arg));
+  arg.gv = gv;
+  arg.count = (uint32_t) count;
+  const int concurrent_rhc = gv->config.concurrent_rhc;
+  gv->config.concurrent_rhc = 1;
+  arg.rhc = mkrhc (gv, NULL, DDS_HISTORY_KEEP_ALL, 1, DDS_DESTINATIONORDER_BY_RECEPTION_TIMESTAMP);
+  gv->config.concurrent_rhc = concurrent_rhc;
+  for (int i = 0; i < CONC_NWRITERS; i++)
+    arg.wr[i] = mkwr (0);
+
+  /* create all instances up front: the readers read/take them by instance handle */
+  uint32_t states_seen[2 * 2 * 3][2] = {{ 0 }};
+  for (int32_t k = 0; k < CONC_N_KEYVALS; k++)
+    arg.iids[k] = store (gv->m_tkmap, arg.rhc, arg.wr[k % CONC_NWRITERS], mksample_conc (k, 0, k % CONC_NWRITERS, 0), print, false);
+  tkall (arg.rhc, NULL, print, states_seen);
+
+  ddsrt_threadattr_t tattr;
+  ddsrt_threadattr_init (&tattr);
+  struct conc_thread_arg wrarg[CONC_NWRITERS], rdarg[CONC_NREADERS];
+  ddsrt_thread_t wrtid[CONC_NWRITERS], rdtid[CONC_NREADERS];
+  for (uint32_t i = 0; i < CONC_NREADERS; i++)
+  {
+    rdarg[i] = (struct conc_thread_arg) { .arg = &arg, .idx = i };
+    ddsrt_prng_init_simple (&rdarg[i].prng, ddsrt_prng_random (&prng));
+    if (ddsrt_thread_create (&rdtid[i], "conc_rd", &tattr, conc_reader_thread, &rdarg[i]) != 0)
+      abort ();
+  }
+  for (uint32_t i = 0; i < CONC_NWRITERS; i++)
+  {
+    wrarg[i] = (struct conc_thread_arg) { .arg = &arg, .idx = i };
+    ddsrt_prng_init_simple (&wrarg[i].prng, ddsrt_prng_random (&prng));
+    if (ddsrt_thread_create (&wrtid[i], "conc_wr", &tattr, conc_writer_thread, &wrarg[i]) != 0)
+      abort ();
+  }
+
+  /* peeking at all instances needs exclusive access, and with xchecks enabled
+     it checks the consistency of the entire cache */
+  const uint32_t nexpected = CONC_NWRITERS * arg.count;
+  const dds_time_t tend = dds_time () + DDS_SECS (60);
+  while (ddsrt_atomic_ld32 (&arg.ntaken) < nexpected && dds_time () < tend)
+  {
+    rdtkcond (arg.rhc, NULL, NULL, false, 0, "PEEK ALL", dds_rhc_peek, states_seen);
+    dds_sleepfor (DDS_MSECS (1));
+  }
+  ddsrt_atomic_st32 (&arg.stop, 1);
+  for (int i = 0; i < CONC_NWRITERS; i++)
+    (void) ddsrt_thread_join (wrtid[i], NULL);
+  for (int i = 0; i < CONC_NREADERS; i++)
+    (void) ddsrt_thread_join (rdtid[i], NULL);
+  printf ("concurrent: taken %"PRIu32" expected %"PRIu32"\n", ddsrt_atomic_ld32 (&arg.ntaken), nexpected);
+  if (ddsrt_atomic_ld32 (&arg.ntaken) != nexpected)
+    abort ();
+
+  /* all that may remain are invalid samples for disposed instances */
+  uint32_t states_remaining[2 * 2 * 3][2] = {{ 0 }};
+  rdtkcond (arg.rhc, NULL, NULL, print, 0, "TAKE ALL", dds_rhc_take, states_remaining);
+  for (int i = 0; i < (int) (sizeof (states_remaining) / sizeof (states_remaining[0])); i++)
+  {
+    if (states_remaining[i][1] != 0)
+      abort ();
+  }
+  frhc (arg.rhc);
+  for (int i = 0; i < CONC_NWRITERS; i++)
+    fwr (arg.wr[i]);
+}
+
 struct stacktracethread_arg {
   dds_time_t when;
   dds_time_t period;
@@ -1160,6 +1349,12 @@ int main (int argc, char **argv)
         test_conditions (pp, tp, count, zztab[zz].create, zztab[zz].filter0, zztab[zz].filter1, print);
       }
   }
+
+  if (5 >= first)
+  {
+    printf ("%"PRId64" ************* 5 *************\n", dds_time ());
+    test_concurrent (pp, count, print);
+  }
   printf ("%"PRId64" cleaning up\n", dds_time ());
 
   ddsrt_cond_destroy (&wait_gc_cycle_cond);
@@ -182,6 +182,7 @@ int main (int argc, char **argv)
   dds_set_topic_filter_extended (1, ptr);
   dds_get_topic_filter_and_arg (1, ptr, ptr);
   dds_get_topic_filter_extended (1, ptr);
+  dds_set_topic_filter_expression (1, ptr, 0, ptr);
   dds_create_subscriber (1, ptr, ptr);
   dds_create_publisher (1, ptr, ptr);
   dds_suspend (1);
@@ -209,6 +210,7 @@ int main (int argc, char **argv)
   dds_writecdr (1, ptr);
   dds_forwardcdr (1, ptr);
   dds_write_ts (1, ptr, 0);
+  dds_write_batch (1, ptr, 0, ptr, ptr);
   dds_create_readcondition (1, 0);
   dds_create_querycondition (1, 0, 0);
   dds_create_guardcondition (1);
@@ -799,6 +801,7 @@ int main (int argc, char **argv)
 
   // ddsi/ddsi_transmit.h
   ddsi_write_sample_gc (ptr, ptr2, ptr3, ptr4, ptr5);
+  ddsi_write_samples_gc (ptr, ptr2, ptr3, 0, ptr4, ptr5, ptr);
 
   // ddsi/ddsi_entity_index.h
   (void) ddsi_entidx_lookup_writer_guid (ptr, ptr2);
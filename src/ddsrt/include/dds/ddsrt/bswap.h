@@ -102,6 +102,32 @@ DDS_INLINE_EXPORT inline int64_t ddsrt_bswap8 (int64_t x)
   return (int64_t) ddsrt_bswap8u ((uint64_t) x);
 }
 
+/**
+ * @brief Byteswap an array of 2, 4 or 8-byte integers in place
+ *
+ * Uses vector instructions when available (SSE2/AVX2 on x86, NEON on ARM), the
+ * choice between SSE2 and AVX2 is made at run-time. The buffer need not be
+ * aligned to the element size.
+ *
+ * @param[in,out] buf the array to byteswap
+ * @param[in] elem_size size of an element, 1 (a no-op), 2, 4 or 8
+ * @param[in] num number of elements
+ */
+DDS_EXPORT void ddsrt_bswap_array (void *buf, size_t elem_size, size_t num);
+
+/**
+ * @brief Copy an array of 2, 4 or 8-byte integers, byteswapping them
+ *
+ * Equivalent to a memcpy followed by @ref ddsrt_bswap_array, but in a single pass.
+ * The source and destination must not overlap.
+ *
+ * @param[out] dst destination array
+ * @param[in] src source array
+ * @param[in] elem_size size of an element, 1 (a plain copy), 2, 4 or 8
+ * @param[in] num number of elements
+ */
+DDS_EXPORT void ddsrt_bswap_array_copy (void *dst, const void *src, size_t elem_size, size_t num);
+
 /**
  * @brief Macros for byteswapping
  * 
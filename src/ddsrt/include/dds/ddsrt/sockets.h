@@ -292,6 +292,70 @@ ddsrt_recvmsg(
   int flags,
   ssize_t *rcvd);
 
+/**
+ * @brief Message header for sending or receiving multiple messages in one call
+ *
+ * The layout matches that of Linux' "struct mmsghdr", so that @ref ddsrt_recvmmsg
+ * and @ref ddsrt_sendmmsg can pass an array of these directly to the kernel.
+ */
+typedef struct ddsrt_mmsghdr {
+  ddsrt_msghdr_t msg_hdr; /**< message header, as for @ref ddsrt_recvmsg and @ref ddsrt_sendmsg */
+  unsigned int msg_len;   /**< number of bytes received or sent for this message */
+} ddsrt_mmsghdr_t;
+
+/**
+ * @brief Receive multiple messages
+ *
+ * - Waits for at least one message to arrive (unless the socket is nonblocking or MSG_DONTWAIT
+ *   is specified), then receives as many further messages as are immediately available, up to
+ *   'vlen' messages.
+ * - On platforms that lack recvmmsg, this is equivalent to receiving a single message with
+ *   @ref ddsrt_recvmsg.
+ * - The 'flags' are as for @ref ddsrt_recvmsg.
+ *
+ * @param[in] sockext the socket
+ * @param[in,out] msgs the message headers, on return the first 'rcvd' of them are filled in
+ * @param[in] vlen the number of message headers in 'msgs', must be > 0
+ * @param[in] flags flags for special options
+ * @param[out] rcvd number of messages received (> 0 if return == OK, undefined if return != OK)
+ * @return a DDS_RETCODE (OK, ERROR, TRY_AGAIN, BAD_PARAMETER, NO_CONNECTION, INTERRUPTED, OUT_OF_RESOURCES, ILLEGAL_OPERATION)
+ *
+ * See @ref ddsrt_recvmsg
+ */
+dds_return_t
+ddsrt_recvmmsg(
+  const ddsrt_socket_ext_t *sockext,
+  ddsrt_mmsghdr_t *msgs,
+  size_t vlen,
+  int flags,
+  size_t *rcvd);
+
+/**
+ * @brief Send multiple messages
+ *
+ * - Sends the messages in order, stopping at the first one that fails. If the first message
+ *   could not be sent, the error for that message is returned, else the return is OK and 'sent'
+ *   gives the number of messages that were sent.
+ * - On platforms that lack sendmmsg, this is done with successive calls to @ref ddsrt_sendmsg.
+ * - The 'flags' are as for @ref ddsrt_sendmsg.
+ *
+ * @param[in] sock the socket
+ * @param[in,out] msgs the messages to send, on return msg_len is set for the first 'sent' of them
+ * @param[in] vlen the number of messages in 'msgs', must be > 0
+ * @param[in] flags flags for special options
+ * @param[out] sent number of messages sent (> 0 if return == OK, undefined if return != OK)
+ * @return a DDS_RETCODE (OK, ERROR, and more)
+ *
+ * See @ref ddsrt_sendmsg
+ */
+dds_return_t
+ddsrt_sendmmsg(
+  ddsrt_socket_t sock,
+  ddsrt_mmsghdr_t *msgs,
+  size_t vlen,
+  int flags,
+  size_t *sent);
+
 /**
  * @brief Get options from the socket.
  *
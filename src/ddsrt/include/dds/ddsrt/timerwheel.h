@@ -0,0 +1,152 @@
+// Copyright(c) 2025 ZettaScale Technology and others
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License v. 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Eclipse Distribution License
+// v. 1.0 which is available at
+// http://www.eclipse.org/org/documents/edl-v10.php.
+//
+// SPDX-License-Identifier: EPL-2.0 OR BSD-3-Clause
+
+#ifndef DDSRT_TIMERWHEEL_H
+#define DDSRT_TIMERWHEEL_H
+
+/** @file timerwheel.h
+  A hierarchical timing wheel is an alternative to a priority queue for keeping track of
+  timers, where insert and delete are O(1) and there is no ordering cost for timers that
+  are deleted or rescheduled before they expire.
+
+  Time is divided into ticks, and the wheel consists of a number of levels of slots, each
+  slot on level L covering 2^(L*DDSRT_TIMERWHEEL_SLOT_BITS) ticks.  A timer is stored in
+  the slot of the lowest level that doesn't require it to be moved before the current
+  time reaches the start of the slot, and as time advances, the contents of slots on
+  higher levels are redistributed over the lower levels.  Timers that expire in the
+  current tick are kept in a separate list, so that they are never returned before
+  their expiry time, and timers that have expired are kept in yet another list, so
+  that taking them out is O(1).
+
+  Compared to @ref ddsrt_fibheap, the earliest expiry time is not known exactly for
+  timers beyond the current tick: for those, only a lower bound is available.
+*/
+
+#include <stdint.h>
+
+#include "dds/export.h"
+
+#if defined (__cplusplus)
+extern "C" {
+#endif
+
+/** @brief log2 of the number of slots per level */
+#define DDSRT_TIMERWHEEL_SLOT_BITS 6
+/** @brief number of slots per level */
+#define DDSRT_TIMERWHEEL_SLOTS (1u << DDSRT_TIMERWHEEL_SLOT_BITS)
+/** @brief number of levels, beyond the range covered by these timers are kept in an overflow list */
+#define DDSRT_TIMERWHEEL_LEVELS 6
+/** @brief log2 of the tick duration in units of time (i.e., 65.536us if time is in nanoseconds) */
+#define DDSRT_TIMERWHEEL_TICK_BITS 16
+
+typedef struct ddsrt_timerwheel_node {
+  struct ddsrt_timerwheel_node *prev; ///< Previous node in the slot, NULL if first
+  struct ddsrt_timerwheel_node *next; ///< Next node in the slot, NULL if last
+  int64_t t; ///< Expiry time
+  uint32_t where; ///< Index of the slot the node is in
+} ddsrt_timerwheel_node_t;
+
+/**
+ * @brief The timer wheel definition for the @ref ddsrt_timerwheel
+ *
+ * See @ref DDSRT_TIMERWHEELDEF_INITIALIZER
+ */
+typedef struct ddsrt_timerwheel_def {
+  uintptr_t offset; ///< The offset of the @ref ddsrt_timerwheel_node with respect to the user node
+} ddsrt_timerwheel_def_t;
+
+/** @brief The timer wheel */
+typedef struct ddsrt_timerwheel {
+  int64_t tnow; ///< Time of the last call to @ref ddsrt_timerwheel_extract_due
+  int64_t cur; ///< Current tick
+  uint64_t occupied[DDSRT_TIMERWHEEL_LEVELS]; ///< Bitmask of non-empty slots per level
+  ddsrt_timerwheel_node_t *slots[DDSRT_TIMERWHEEL_LEVELS * DDSRT_TIMERWHEEL_SLOTS + 3]; ///< Slots of all levels, followed by the current tick, the expired and the overflow lists
+} ddsrt_timerwheel_t;
+
+/**
+ * @brief Macro to initialize @ref ddsrt_timerwheel_def
+ */
+#define DDSRT_TIMERWHEELDEF_INITIALIZER(offset) { (offset) }
+
+/**
+ * @brief Initialize the @ref ddsrt_timerwheel
+ *
+ * @param[in] twdef the timer wheel definition
+ * @param[out] tw the timer wheel
+ * @param[in] tnow the current time
+ */
+DDS_EXPORT void ddsrt_timerwheel_init (const ddsrt_timerwheel_def_t *twdef, ddsrt_timerwheel_t *tw, int64_t tnow);
+
+/**
+ * @brief Insert a node into a timer wheel
+ *
+ * @param[in] twdef the timer wheel definition
+ * @param[in,out] tw the timer wheel
+ * @param[in] vnode user node to insert, must not be in the wheel
+ * @param[in] t expiry time of the node
+ *
+ * See @ref ddsrt_timerwheel_delete, @ref ddsrt_timerwheel_extract_due
+ */
+DDS_EXPORT void ddsrt_timerwheel_insert (const ddsrt_timerwheel_def_t *twdef, ddsrt_timerwheel_t *tw, void *vnode, int64_t t);
+
+/**
+ * @brief Remove a node from a timer wheel
+ *
+ * Like @ref ddsrt_fibheap_delete, it only removes the node from the wheel.
+ *
+ * @param[in] twdef the timer wheel definition
+ * @param[in,out] tw the timer wheel
+ * @param[in] vnode user node to remove, must be in the wheel
+ */
+DDS_EXPORT void ddsrt_timerwheel_delete (const ddsrt_timerwheel_def_t *twdef, ddsrt_timerwheel_t *tw, void *vnode);
+
+/**
+ * @brief Lower bound for the earliest expiry time in a timer wheel
+ *
+ * If there are no expired nodes, the result is either the exact earliest expiry time, or
+ * it is a lower bound that is later than the time passed to the most recent call to
+ * @ref ddsrt_timerwheel_extract_due (or @ref ddsrt_timerwheel_init).  So waiting until
+ * the returned time and then calling @ref ddsrt_timerwheel_extract_due never fails to
+ * make progress.
+ *
+ * @param[in] twdef the timer wheel definition
+ * @param[in] tw the timer wheel
+ * @return lower bound for the earliest expiry time, INT64_MIN if there are expired
+ * nodes, INT64_MAX if empty
+ */
+DDS_EXPORT int64_t ddsrt_timerwheel_next (const ddsrt_timerwheel_def_t *twdef, const ddsrt_timerwheel_t *tw);
+
+/**
+ * @brief Take an expired node from a timer wheel
+ *
+ * Advances the current time of the wheel to tnow, then removes and returns a node with
+ * an expiry time <= tnow.  Nodes are not necessarily returned in order of expiry time.
+ *
+ * @param[in] twdef the timer wheel definition
+ * @param[in,out] tw the timer wheel
+ * @param[in] tnow the current time, the wheel's notion of time never goes backwards
+ * @return pointer to an expired user node, NULL if there is none
+ */
+DDS_EXPORT void *ddsrt_timerwheel_extract_due (const ddsrt_timerwheel_def_t *twdef, ddsrt_timerwheel_t *tw, int64_t tnow);
+
+/**
+ * @brief Take an arbitrary node from a timer wheel
+ *
+ * @param[in] twdef the timer wheel definition
+ * @param[in,out] tw the timer wheel
+ * @return pointer to a user node, NULL if the wheel is empty
+ */
+DDS_EXPORT void *ddsrt_timerwheel_extract_any (const ddsrt_timerwheel_def_t *twdef, ddsrt_timerwheel_t *tw);
+
+#if defined (__cplusplus)
+}
+#endif
+
+#endif /* DDSRT_TIMERWHEEL_H */
@@ -8,12 +8,198 @@
 //
 // SPDX-License-Identifier: EPL-2.0 OR BSD-3-Clause
 
+#include <assert.h>
+#include <string.h>
+
 #include "dds/export.h"
 #include "dds/ddsrt/bswap.h"
 
+#if defined (__SSE2__) || defined (_M_X64) || (defined (_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define DDSRT_BSWAP_SSE2 1
+#if ((defined (__GNUC__) && (__GNUC__ >= 5)) || defined (__clang__)) && !defined (_MSC_VER)
+#include <immintrin.h>
+#define DDSRT_BSWAP_AVX2 1
+#endif
+#elif defined (__ARM_NEON) || defined (__ARM_NEON__)
+#include <arm_neon.h>
+#define DDSRT_BSWAP_NEON 1
+#endif
+
 DDS_EXPORT extern inline uint16_t ddsrt_bswap2u (uint16_t x);
 DDS_EXPORT extern inline uint32_t ddsrt_bswap4u (uint32_t x);
 DDS_EXPORT extern inline uint64_t ddsrt_bswap8u (uint64_t x);
 DDS_EXPORT extern inline int16_t ddsrt_bswap2 (int16_t x);
 DDS_EXPORT extern inline int32_t ddsrt_bswap4 (int32_t x);
 DDS_EXPORT extern inline int64_t ddsrt_bswap8 (int64_t x);
+
+/* The kernels all take a source and a destination that are either identical (in-place
+   swapping) or don't overlap. They process as many complete 16 or 32 byte blocks as
+   possible and return the number of bytes done, the scalar code does the remainder.
+   Loads and stores are unaligned: XCDR2 aligns 8-byte integers to 4 bytes only, and
+   the data may be at any offset in a received message anyway. */
+
+static void bswap_scalar (unsigned char *dst, const unsigned char *src, size_t elem_size, size_t num)
+{
+  /* memcpy makes it safe for unaligned data, compilers turn it into plain loads/stores */
+  switch (elem_size)
+  {
+    case 2:
+      for (size_t i = 0; i < num; i++) {
+        uint16_t x;
+        memcpy (&x, src + 2 * i, 2);
+        x = ddsrt_bswap2u (x);
+        memcpy (dst + 2 * i, &x, 2);
+      }
+      break;
+    case 4:
+      for (size_t i = 0; i < num; i++) {
+        uint32_t x;
+        memcpy (&x, src + 4 * i, 4);
+        x = ddsrt_bswap4u (x);
+        memcpy (dst + 4 * i, &x, 4);
+      }
+      break;
+    case 8:
+      for (size_t i = 0; i < num; i++) {
+        uint64_t x;
+        memcpy (&x, src + 8 * i, 8);
+        x = ddsrt_bswap8u (x);
+        memcpy (dst + 8 * i, &x, 8);
+      }
+      break;
+  }
+}
+
+#if DDSRT_BSWAP_SSE2
+/* SSE2 has no byte shuffle: reorder the 16-bit words within an element using word
+   shuffles, then swap the bytes within each word with shifts */
+static size_t bswap_sse2 (unsigned char *dst, const unsigned char *src, size_t elem_size, size_t nbytes)
+{
+  size_t i;
+  for (i = 0; i + 16 <= nbytes; i += 16)
+  {
+    __m128i x = _mm_loadu_si128 ((const __m128i *) (src + i));
+    switch (elem_size)
+    {
+      case 4:
+        x = _mm_shufflehi_epi16 (_mm_shufflelo_epi16 (x, _MM_SHUFFLE (2, 3, 0, 1)), _MM_SHUFFLE (2, 3, 0, 1));
+        break;
+      case 8:
+        x = _mm_shufflehi_epi16 (_mm_shufflelo_epi16 (x, _MM_SHUFFLE (0, 1, 2, 3)), _MM_SHUFFLE (0, 1, 2, 3));
+        break;
+    }
+    x = _mm_or_si128 (_mm_slli_epi16 (x, 8), _mm_srli_epi16 (x, 8));
+    _mm_storeu_si128 ((__m128i *) (dst + i), x);
+  }
+  return i;
+}
+#endif
+
+#if DDSRT_BSWAP_AVX2
+#if defined (__AVX2__)
+#define DDSRT_BSWAP_ATTR_AVX2
+#else
+#define DDSRT_BSWAP_ATTR_AVX2 __attribute__ ((target ("avx2")))
+#endif
+
+DDSRT_BSWAP_ATTR_AVX2
+static size_t bswap_avx2 (unsigned char *dst, const unsigned char *src, size_t elem_size, size_t nbytes)
+{
+  /* vpshufb shuffles within 128-bit lanes, which is fine because elements never cross them */
+  __m256i mask;
+  switch (elem_size)
+  {
+    case 2:
+      mask = _mm256_setr_epi8 (1,0,3,2,5,4,7,6,9,8,11,10,13,12,15,14, 1,0,3,2,5,4,7,6,9,8,11,10,13,12,15,14);
+      break;
+    case 4:
+      mask = _mm256_setr_epi8 (3,2,1,0,7,6,5,4,11,10,9,8,15,14,13,12, 3,2,1,0,7,6,5,4,11,10,9,8,15,14,13,12);
+      break;
+    default:
+      mask = _mm256_setr_epi8 (7,6,5,4,3,2,1,0,15,14,13,12,11,10,9,8, 7,6,5,4,3,2,1,0,15,14,13,12,11,10,9,8);
+      break;
+  }
+  size_t i;
+  for (i = 0; i + 64 <= nbytes; i += 64)
+  {
+    const __m256i x0 = _mm256_loadu_si256 ((const __m256i *) (src + i));
+    const __m256i x1 = _mm256_loadu_si256 ((const __m256i *) (src + i + 32));
+    _mm256_storeu_si256 ((__m256i *) (dst + i), _mm256_shuffle_epi8 (x0, mask));
+    _mm256_storeu_si256 ((__m256i *) (dst + i + 32), _mm256_shuffle_epi8 (x1, mask));
+  }
+  for (; i + 32 <= nbytes; i += 32)
+  {
+    const __m256i x = _mm256_loadu_si256 ((const __m256i *) (src + i));
+    _mm256_storeu_si256 ((__m256i *) (dst + i), _mm256_shuffle_epi8 (x, mask));
+  }
+  return i;
+}
+
+static int have_avx2 (void)
+{
+#if defined (__AVX2__)
+  return 1;
+#else
+  /* __builtin_cpu_supports only reads a variable initialized by a constructor in
+     libgcc/compiler-rt, so there is no point in caching the result */
+  return __builtin_cpu_supports ("avx2");
+#endif
+}
+#endif
+
+#if DDSRT_BSWAP_NEON
+static size_t bswap_neon (unsigned char *dst, const unsigned char *src, size_t elem_size, size_t nbytes)
+{
+  size_t i;
+  for (i = 0; i + 16 <= nbytes; i += 16)
+  {
+    const uint8x16_t x = vld1q_u8 (src + i);
+    switch (elem_size)
+    {
+      case 2: vst1q_u8 (dst + i, vrev16q_u8 (x)); break;
+      case 4: vst1q_u8 (dst + i, vrev32q_u8 (x)); break;
+      default: vst1q_u8 (dst + i, vrev64q_u8 (x)); break;
+    }
+  }
+  return i;
+}
+#endif
+
+/* Below this size the set-up cost of the vector code isn't worth it */
+#define BSWAP_VECTOR_MIN_BYTES 32
+
+static void bswap_impl (unsigned char *dst, const unsigned char *src, size_t elem_size, size_t num)
+{
+  assert (elem_size == 2 || elem_size == 4 || elem_size == 8);
+  const size_t nbytes = elem_size * num;
+  size_t done = 0;
+  if (nbytes >= BSWAP_VECTOR_MIN_BYTES)
+  {
+#if DDSRT_BSWAP_AVX2
+    if (have_avx2 ())
+      done = bswap_avx2 (dst, src, elem_size, nbytes);
+#endif
+#if DDSRT_BSWAP_SSE2
+    done += bswap_sse2 (dst + done, src + done, elem_size, nbytes - done);
+#elif DDSRT_BSWAP_NEON
+    done = bswap_neon (dst, src, elem_size, nbytes);
+#endif
+  }
+  assert (done % elem_size == 0);
+  bswap_scalar (dst + done, src + done, elem_size, num - done / elem_size);
+}
+
+void ddsrt_bswap_array (void *buf, size_t elem_size, size_t num)
+{
+  if (elem_size > 1)
+    bswap_impl (buf, buf, elem_size, num);
+}
+
+void ddsrt_bswap_array_copy (void * restrict dst, const void * restrict src, size_t elem_size, size_t num)
+{
+  if (elem_size > 1)
+    bswap_impl (dst, src, elem_size, num);
+  else if (num > 0)
+    memcpy (dst, src, num);
+}
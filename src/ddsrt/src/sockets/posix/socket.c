@@ -8,13 +8,17 @@
 //
 // SPDX-License-Identifier: EPL-2.0 OR BSD-3-Clause
 
+#define _GNU_SOURCE /* Required for recvmmsg and sendmmsg. */
+
 #include <assert.h>
+#include <limits.h>
 #include <string.h>
 #include <unistd.h>
 
 #include "sockets_priv.h"
 #include "dds/ddsrt/log.h"
 #include "dds/ddsrt/misc.h"
+#include "dds/ddsrt/static_assert.h"
 
 #if !LWIP_SOCKET
 #if defined(__VXWORKS__)
@@ -485,6 +489,43 @@ ddsrt_recvmsg(
   return recv_error_to_retcode(errno);
 }
 
+#if DDSRT_HAVE_RECVMMSG || DDSRT_HAVE_SENDMMSG
+DDSRT_STATIC_ASSERT (sizeof (ddsrt_mmsghdr_t) == sizeof (struct mmsghdr) &&
+                     offsetof (ddsrt_mmsghdr_t, msg_hdr) == offsetof (struct mmsghdr, msg_hdr) &&
+                     offsetof (ddsrt_mmsghdr_t, msg_len) == offsetof (struct mmsghdr, msg_len));
+#endif
+
+dds_return_t
+ddsrt_recvmmsg(
+  const ddsrt_socket_ext_t *sockext,
+  ddsrt_mmsghdr_t *msgs,
+  size_t vlen,
+  int flags,
+  size_t *rcvd)
+{
+  assert(msgs != NULL && vlen > 0);
+#if DDSRT_HAVE_RECVMMSG
+  int n;
+  if (vlen > UINT_MAX)
+    vlen = UINT_MAX;
+  if ((n = recvmmsg(sockext->sock, (struct mmsghdr *) msgs, (unsigned) vlen, flags | MSG_WAITFORONE, NULL)) != -1) {
+    assert(n > 0);
+    *rcvd = (size_t) n;
+    return DDS_RETCODE_OK;
+  }
+  return recv_error_to_retcode(errno);
+#else
+  dds_return_t rc;
+  ssize_t n;
+  (void) vlen;
+  if ((rc = ddsrt_recvmsg(sockext, &msgs[0].msg_hdr, flags, &n)) == DDS_RETCODE_OK) {
+    msgs[0].msg_len = (unsigned int) n;
+    *rcvd = 1;
+  }
+  return rc;
+#endif
+}
+
 static inline dds_return_t
 send_error_to_retcode(int errnum)
 {
@@ -566,6 +607,38 @@ ddsrt_sendmsg(
   return send_error_to_retcode(errno);
 }
 
+dds_return_t
+ddsrt_sendmmsg(
+  ddsrt_socket_t sock,
+  ddsrt_mmsghdr_t *msgs,
+  size_t vlen,
+  int flags,
+  size_t *sent)
+{
+  assert(msgs != NULL && vlen > 0);
+#if DDSRT_HAVE_SENDMMSG
+  int n;
+  if (vlen > UINT_MAX)
+    vlen = UINT_MAX;
+  if ((n = sendmmsg(sock, (struct mmsghdr *) msgs, (unsigned) vlen, flags)) != -1) {
+    assert(n > 0);
+    *sent = (size_t) n;
+    return DDS_RETCODE_OK;
+  }
+  return send_error_to_retcode(errno);
+#else
+  dds_return_t rc = DDS_RETCODE_OK;
+  ssize_t n;
+  size_t i = 0;
+  while (i < vlen && (rc = ddsrt_sendmsg(sock, &msgs[i].msg_hdr, flags, &n)) == DDS_RETCODE_OK)
+    msgs[i++].msg_len = (unsigned int) n;
+  if (i == 0)
+    return rc;
+  *sent = i;
+  return DDS_RETCODE_OK;
+#endif
+}
+
 dds_return_t
 ddsrt_select(
   int32_t nfds,
@@ -625,6 +625,25 @@ ddsrt_recvmsg(
     return ddsrt_recvmsg_recvfrom (sockext, msg, flags, rcvd);
 }
 
+dds_return_t
+ddsrt_recvmmsg(
+  const ddsrt_socket_ext_t *sockext,
+  ddsrt_mmsghdr_t *msgs,
+  size_t vlen,
+  int flags,
+  size_t *rcvd)
+{
+  dds_return_t rc;
+  ssize_t n;
+  assert(msgs != NULL && vlen > 0);
+  (void) vlen;
+  if ((rc = ddsrt_recvmsg(sockext, &msgs[0].msg_hdr, flags, &n)) == DDS_RETCODE_OK) {
+    msgs[0].msg_len = (unsigned int) n;
+    *rcvd = 1;
+  }
+  return rc;
+}
+
 static dds_return_t
 send_error_to_retcode(int errnum)
 {
@@ -726,6 +745,26 @@ ddsrt_sendmsg(
   return send_error_to_retcode(WSAGetLastError());
 }
 
+dds_return_t
+ddsrt_sendmmsg(
+  ddsrt_socket_t sock,
+  ddsrt_mmsghdr_t *msgs,
+  size_t vlen,
+  int flags,
+  size_t *sent)
+{
+  dds_return_t rc = DDS_RETCODE_OK;
+  ssize_t n;
+  size_t i = 0;
+  assert(msgs != NULL && vlen > 0);
+  while (i < vlen && (rc = ddsrt_sendmsg(sock, &msgs[i].msg_hdr, flags, &n)) == DDS_RETCODE_OK)
+    msgs[i++].msg_len = (unsigned int) n;
+  if (i == 0)
+    return rc;
+  *sent = i;
+  return DDS_RETCODE_OK;
+}
+
 dds_return_t
 ddsrt_select(
   int32_t nfds,
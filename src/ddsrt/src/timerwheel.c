@@ -0,0 +1,237 @@
+// Copyright(c) 2025 ZettaScale Technology and others
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License v. 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Eclipse Distribution License
+// v. 1.0 which is available at
+// http://www.eclipse.org/org/documents/edl-v10.php.
+//
+// SPDX-License-Identifier: EPL-2.0 OR BSD-3-Clause
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <assert.h>
+
+#include "dds/ddsrt/misc.h"
+#include "dds/ddsrt/bits.h"
+#include "dds/ddsrt/timerwheel.h"
+
+#define BITS DDSRT_TIMERWHEEL_SLOT_BITS
+#define SLOTS DDSRT_TIMERWHEEL_SLOTS
+#define LEVELS DDSRT_TIMERWHEEL_LEVELS
+
+// Indices of the lists following the slots: timers that expire in the current
+// tick but later than tnow, timers that have expired, and timers beyond the range
+// of the highest level
+#define NEAR (LEVELS * SLOTS)
+#define DUE (NEAR + 1)
+#define OVERFLOW (NEAR + 2)
+
+static ddsrt_timerwheel_node_t *tonode (const ddsrt_timerwheel_def_t *twdef, void *vnode)
+{
+  return (ddsrt_timerwheel_node_t *) ((char *) vnode + twdef->offset);
+}
+
+static void *fromnode (const ddsrt_timerwheel_def_t *twdef, ddsrt_timerwheel_node_t *node)
+{
+  return (char *) node - twdef->offset;
+}
+
+static uint32_t ffs64 (uint64_t x)
+{
+  const uint32_t lo = ddsrt_ffs32u ((uint32_t) x);
+  if (lo)
+    return lo;
+  const uint32_t hi = ddsrt_ffs32u ((uint32_t) (x >> 32));
+  return hi ? hi + 32 : 0;
+}
+
+static int64_t tick_to_time (int64_t tick)
+{
+  if (tick > (INT64_MAX >> DDSRT_TIMERWHEEL_TICK_BITS))
+    return INT64_MAX;
+  return tick << DDSRT_TIMERWHEEL_TICK_BITS;
+}
+
+static void link_node (ddsrt_timerwheel_t *tw, uint32_t idx, ddsrt_timerwheel_node_t *node)
+{
+  node->where = idx;
+  node->prev = NULL;
+  node->next = tw->slots[idx];
+  if (node->next)
+    node->next->prev = node;
+  tw->slots[idx] = node;
+  if (idx < NEAR)
+    tw->occupied[idx / SLOTS] |= UINT64_C (1) << (idx % SLOTS);
+}
+
+static void unlink_node (ddsrt_timerwheel_t *tw, ddsrt_timerwheel_node_t *node)
+{
+  const uint32_t idx = node->where;
+  if (node->prev)
+    node->prev->next = node->next;
+  else
+    tw->slots[idx] = node->next;
+  if (node->next)
+    node->next->prev = node->prev;
+  if (idx < NEAR && tw->slots[idx] == NULL)
+    tw->occupied[idx / SLOTS] &= ~(UINT64_C (1) << (idx % SLOTS));
+}
+
+static uint32_t slot_index (const ddsrt_timerwheel_t *tw, int64_t t)
+{
+  if (t <= tw->tnow)
+    return DUE;
+  const int64_t tick = t >> DDSRT_TIMERWHEEL_TICK_BITS;
+  if (tick <= tw->cur)
+    return NEAR;
+  // lowest level on which the slot doesn't need to be redistributed before tick:
+  // all digits above it are the same as those of the current tick
+  for (uint32_t l = 0; l < LEVELS; l++)
+  {
+    const uint32_t shift = BITS * (l + 1);
+    if ((tick >> shift) == (tw->cur >> shift))
+      return l * SLOTS + (uint32_t) ((tick >> (BITS * l)) & (SLOTS - 1));
+  }
+  return OVERFLOW;
+}
+
+static void relink_list (ddsrt_timerwheel_t *tw, uint32_t idx)
+{
+  ddsrt_timerwheel_node_t *node = tw->slots[idx];
+  tw->slots[idx] = NULL;
+  if (idx < NEAR)
+    tw->occupied[idx / SLOTS] &= ~(UINT64_C (1) << (idx % SLOTS));
+  while (node)
+  {
+    ddsrt_timerwheel_node_t * const next = node->next;
+    link_node (tw, slot_index (tw, node->t), node);
+    node = next;
+  }
+}
+
+static bool next_boundary (const ddsrt_timerwheel_t *tw, int64_t *tick, uint32_t *idx)
+{
+  // Slots at or before the current digit on each level are always empty and the
+  // lowest level with an occupied slot ahead of the current one has the earliest
+  // slot (all slots on higher levels start at the end of this one's range, or later)
+  for (uint32_t l = 0; l < LEVELS; l++)
+  {
+    const uint32_t d = (uint32_t) ((tw->cur >> (BITS * l)) & (SLOTS - 1));
+    const uint64_t mask = (d == SLOTS - 1) ? 0 : ~((UINT64_C (2) << d) - 1);
+    const uint64_t ahead = tw->occupied[l] & mask;
+    if (ahead)
+    {
+      const uint32_t s = ffs64 (ahead) - 1;
+      const uint32_t shift = BITS * (l + 1);
+      *tick = ((tw->cur >> shift) << shift) | ((int64_t) s << (BITS * l));
+      *idx = l * SLOTS + s;
+      return true;
+    }
+  }
+  if (tw->slots[OVERFLOW])
+  {
+    const uint32_t shift = BITS * LEVELS;
+    *tick = ((tw->cur >> shift) + 1) << shift;
+    *idx = OVERFLOW;
+    return true;
+  }
+  return false;
+}
+
+static void advance (ddsrt_timerwheel_t *tw, int64_t tick)
+{
+  int64_t btick;
+  uint32_t idx;
+  while (next_boundary (tw, &btick, &idx) && btick <= tick)
+  {
+    tw->cur = btick;
+    relink_list (tw, idx);
+  }
+  if (tick > tw->cur)
+    tw->cur = tick;
+}
+
+void ddsrt_timerwheel_init (const ddsrt_timerwheel_def_t *twdef, ddsrt_timerwheel_t *tw, int64_t tnow)
+{
+  DDSRT_UNUSED_ARG (twdef);
+  tw->tnow = tnow;
+  tw->cur = tnow >> DDSRT_TIMERWHEEL_TICK_BITS;
+  for (uint32_t l = 0; l < LEVELS; l++)
+    tw->occupied[l] = 0;
+  for (uint32_t i = 0; i < sizeof (tw->slots) / sizeof (tw->slots[0]); i++)
+    tw->slots[i] = NULL;
+}
+
+void ddsrt_timerwheel_insert (const ddsrt_timerwheel_def_t *twdef, ddsrt_timerwheel_t *tw, void *vnode, int64_t t)
+{
+  ddsrt_timerwheel_node_t * const node = tonode (twdef, vnode);
+  node->t = t;
+  link_node (tw, slot_index (tw, t), node);
+}
+
+void ddsrt_timerwheel_delete (const ddsrt_timerwheel_def_t *twdef, ddsrt_timerwheel_t *tw, void *vnode)
+{
+  unlink_node (tw, tonode (twdef, vnode));
+}
+
+int64_t ddsrt_timerwheel_next (const ddsrt_timerwheel_def_t *twdef, const ddsrt_timerwheel_t *tw)
+{
+  DDSRT_UNUSED_ARG (twdef);
+  if (tw->slots[DUE])
+    return INT64_MIN;
+  if (tw->slots[NEAR])
+  {
+    // the timers in the current tick precede all others, and there are never many
+    int64_t tmin = INT64_MAX;
+    for (const ddsrt_timerwheel_node_t *node = tw->slots[NEAR]; node; node = node->next)
+      if (node->t < tmin)
+        tmin = node->t;
+    return tmin;
+  }
+  int64_t btick;
+  uint32_t idx;
+  if (next_boundary (tw, &btick, &idx))
+    return tick_to_time (btick);
+  return INT64_MAX;
+}
+
+void *ddsrt_timerwheel_extract_due (const ddsrt_timerwheel_def_t *twdef, ddsrt_timerwheel_t *tw, int64_t tnow)
+{
+  if (tnow > tw->tnow)
+  {
+    tw->tnow = tnow;
+    advance (tw, tnow >> DDSRT_TIMERWHEEL_TICK_BITS);
+    ddsrt_timerwheel_node_t *node = tw->slots[NEAR];
+    while (node)
+    {
+      ddsrt_timerwheel_node_t * const next = node->next;
+      if (node->t <= tnow)
+      {
+        unlink_node (tw, node);
+        link_node (tw, DUE, node);
+      }
+      node = next;
+    }
+  }
+  ddsrt_timerwheel_node_t * const node = tw->slots[DUE];
+  if (node == NULL)
+    return NULL;
+  unlink_node (tw, node);
+  return fromnode (twdef, node);
+}
+
+void *ddsrt_timerwheel_extract_any (const ddsrt_timerwheel_def_t *twdef, ddsrt_timerwheel_t *tw)
+{
+  static const uint32_t lists[] = { DUE, NEAR, OVERFLOW };
+  ddsrt_timerwheel_node_t *node = NULL;
+  for (uint32_t i = 0; node == NULL && i < sizeof (lists) / sizeof (lists[0]); i++)
+    node = tw->slots[lists[i]];
+  for (uint32_t l = 0; node == NULL && l < LEVELS; l++)
+    if (tw->occupied[l])
+      node = tw->slots[l * SLOTS + ffs64 (tw->occupied[l]) - 1];
+  if (node == NULL)
+    return NULL;
+  unlink_node (tw, node);
+  return fromnode (twdef, node);
+}
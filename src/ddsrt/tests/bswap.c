@@ -0,0 +1,174 @@
+// Copyright(c) 2025 ZettaScale Technology and others
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License v. 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Eclipse Distribution License
+// v. 1.0 which is available at
+// http://www.eclipse.org/org/documents/edl-v10.php.
+//
+// SPDX-License-Identifier: EPL-2.0 OR BSD-3-Clause
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+#include "CUnit/Test.h"
+
+#include "dds/ddsrt/attributes.h"
+#include "dds/ddsrt/cdtors.h"
+#include "dds/ddsrt/bswap.h"
+#include "dds/ddsrt/heap.h"
+#include "dds/ddsrt/random.h"
+#include "dds/ddsrt/time.h"
+
+CU_Init(ddsrt_bswap)
+{
+  ddsrt_init();
+  return 0;
+}
+
+CU_Clean(ddsrt_bswap)
+{
+  ddsrt_fini();
+  return 0;
+}
+
+static void bswap_ref (unsigned char *dst, const unsigned char *src, size_t elem_size, size_t num)
+{
+  for (size_t i = 0; i < num; i++)
+    for (size_t j = 0; j < elem_size; j++)
+      dst[i * elem_size + j] = src[i * elem_size + elem_size - 1 - j];
+}
+
+CU_Test(ddsrt_bswap, array)
+{
+  // covers the vector code paths and the scalar remainder for all misalignments
+  enum { maxnum = 300, maxoff = 8 };
+  unsigned char *src = ddsrt_malloc (8 * maxnum + maxoff);
+  unsigned char *ref = ddsrt_malloc (8 * maxnum + maxoff);
+  unsigned char *buf = ddsrt_malloc (8 * maxnum + maxoff);
+  unsigned char *dst = ddsrt_malloc (8 * maxnum + maxoff + 1);
+  for (size_t i = 0; i < 8 * maxnum + maxoff; i++)
+    src[i] = (unsigned char) ddsrt_random ();
+  for (size_t elem_size = 1; elem_size <= 8; elem_size *= 2)
+  {
+    for (size_t off = 0; off < maxoff; off++)
+    {
+      for (size_t num = 0; num < maxnum; num += (num < 40) ? 1 : 37)
+      {
+        const size_t sz = elem_size * num;
+        bswap_ref (ref, src + off, elem_size, num);
+
+        memcpy (buf + off, src + off, sz);
+        ddsrt_bswap_array (buf + off, elem_size, num);
+        CU_ASSERT_FATAL (memcmp (buf + off, ref, sz) == 0);
+
+        // the copy must not write beyond the end of the destination
+        memset (dst, 0xee, sz + off + 1);
+        ddsrt_bswap_array_copy (dst + off, src + off, elem_size, num);
+        CU_ASSERT_FATAL (memcmp (dst + off, ref, sz) == 0);
+        CU_ASSERT_FATAL (dst[off + sz] == 0xee);
+      }
+    }
+  }
+  ddsrt_free (dst);
+  ddsrt_free (buf);
+  ddsrt_free (ref);
+  ddsrt_free (src);
+}
+
+static void bswap_elementwise (void *vbuf, size_t elem_size, size_t num)
+{
+  // the element-by-element swapping that the CDR serializer used to do
+  switch (elem_size)
+  {
+    case 2: {
+      uint16_t *buf = vbuf;
+      for (size_t i = 0; i < num; i++)
+        buf[i] = ddsrt_bswap2u (buf[i]);
+      break;
+    }
+    case 4: {
+      uint32_t *buf = vbuf;
+      for (size_t i = 0; i < num; i++)
+        buf[i] = ddsrt_bswap4u (buf[i]);
+      break;
+    }
+    case 8: {
+      uint32_t *buf = vbuf;
+      for (size_t i = 0; i < num; i++) {
+        uint32_t a = ddsrt_bswap4u (buf[2*i]);
+        uint32_t b = ddsrt_bswap4u (buf[2*i+1]);
+        buf[2*i] = b;
+        buf[2*i+1] = a;
+      }
+      break;
+    }
+  }
+}
+
+static double bswap_throughput (void (*f) (void *buf, size_t elem_size, size_t num), void *buf, size_t elem_size, size_t bytes)
+{
+  // repeat until at least 16MB has been swapped and at least 10ms have passed, reading
+  // the clock once per MB to keep it out of the measurement for small arrays
+  const size_t reps = (bytes < ((size_t) 1 << 20)) ? ((size_t) 1 << 20) / bytes : 1;
+  const ddsrt_mtime_t t0 = ddsrt_time_monotonic ();
+  size_t total = 0;
+  int64_t dt;
+  do {
+    for (size_t i = 0; i < reps; i++)
+      f (buf, elem_size, bytes / elem_size);
+    total += reps * bytes;
+    dt = ddsrt_time_monotonic ().v - t0.v;
+  } while (total < ((size_t) 16 << 20) || dt < DDS_MSECS (10));
+  return (double) total / (double) dt;
+}
+
+/* Print message preceded by time stamp */
+static void tprintf (const char *msg, ...)
+  ddsrt_attribute_format_printf (1, 2);
+
+static void tprintf (const char *msg, ...)
+{
+  va_list args;
+  dds_time_t t = dds_time ();
+  printf ("%d.%06d ", (int32_t) (t / DDS_NSECS_IN_SEC), (int32_t) (t % DDS_NSECS_IN_SEC) / 1000);
+  va_start (args, msg);
+  vprintf (msg, args);
+  va_end (args);
+}
+
+CU_Test(ddsrt_bswap, array_large, .timeout = 60)
+{
+  // large buffers, as in the CDR serializer, must give the same result as
+  // swapping element by element, and preferably do so faster
+  const size_t maxbytes = (size_t) 16 << 20;
+  unsigned char *src = ddsrt_malloc (maxbytes);
+  unsigned char *ref = ddsrt_malloc (maxbytes);
+  unsigned char *buf = ddsrt_malloc (maxbytes);
+  for (size_t i = 0; i < maxbytes; i++)
+    src[i] = (unsigned char) ddsrt_random ();
+  tprintf ("byte swap throughput (GB/s), element-by-element vs ddsrt_bswap_array\n");
+  tprintf ("%10s %11s %11s %11s\n", "size", "2-byte", "4-byte", "8-byte");
+  for (size_t bytes = 1024; bytes <= maxbytes; bytes *= 4)
+  {
+    double gbps_elem[3], gbps_array[3];
+    for (int k = 0; k < 3; k++)
+    {
+      const size_t elem_size = (size_t) 2 << k;
+      memcpy (ref, src, bytes);
+      bswap_elementwise (ref, elem_size, bytes / elem_size);
+      memcpy (buf, src, bytes);
+      ddsrt_bswap_array (buf, elem_size, bytes / elem_size);
+      CU_ASSERT_FATAL (memcmp (buf, ref, bytes) == 0);
+
+      gbps_elem[k] = bswap_throughput (bswap_elementwise, ref, elem_size, bytes);
+      gbps_array[k] = bswap_throughput (ddsrt_bswap_array, buf, elem_size, bytes);
+    }
+    tprintf ("%10zu %5.1f %5.1f %5.1f %5.1f %5.1f %5.1f\n", bytes,
+             gbps_elem[0], gbps_array[0], gbps_elem[1], gbps_array[1], gbps_elem[2], gbps_array[2]);
+  }
+  ddsrt_free (buf);
+  ddsrt_free (ref);
+  ddsrt_free (src);
+}
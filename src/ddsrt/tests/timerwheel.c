@@ -0,0 +1,120 @@
+// Copyright(c) 2025 ZettaScale Technology and others
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License v. 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Eclipse Distribution License
+// v. 1.0 which is available at
+// http://www.eclipse.org/org/documents/edl-v10.php.
+//
+// SPDX-License-Identifier: EPL-2.0 OR BSD-3-Clause
+
+#include <stdint.h>
+#include <stddef.h>
+#include "CUnit/Theory.h"
+
+#include "dds/ddsrt/random.h"
+#include "dds/ddsrt/timerwheel.h"
+
+#define NTIMERS 1000
+
+struct timer {
+  ddsrt_timerwheel_node_t twnode;
+  bool in_wheel;
+  int64_t t;
+};
+
+static const ddsrt_timerwheel_def_t twdef = DDSRT_TIMERWHEELDEF_INITIALIZER (offsetof (struct timer, twnode));
+
+static int64_t random_delta (ddsrt_prng_t *prng, int64_t max)
+{
+  // max is at most 2^62, anything from a fraction of a tick to way beyond the range of
+  // the wheel, with a small probability of it being in the past
+  const int64_t d = (int64_t) ((ddsrt_prng_random (prng) | ((uint64_t) ddsrt_prng_random (prng) << 32)) % (uint64_t) max);
+  return (ddsrt_prng_random (prng) % 16) == 0 ? -d : d;
+}
+
+static void check_next (const ddsrt_timerwheel_t *tw, const struct timer *timers, int64_t tnow)
+{
+  int64_t tmin = INT64_MAX;
+  for (uint32_t i = 0; i < NTIMERS; i++)
+    if (timers[i].in_wheel && timers[i].t < tmin)
+      tmin = timers[i].t;
+  const int64_t tnext = ddsrt_timerwheel_next (&twdef, tw);
+  CU_ASSERT_FATAL (tnext <= tmin);
+  if (tmin <= tnow)
+    CU_ASSERT_FATAL (tnext == INT64_MIN);
+  else
+    CU_ASSERT_FATAL (tnext > tnow);
+}
+
+CU_TheoryDataPoints (ddsrt_timerwheel, random) = {
+  CU_DataPoints (int64_t, 1000, 10000000, INT64_C (1000000000000), INT64_C (1) << 62)
+};
+
+CU_Theory ((int64_t range), ddsrt_timerwheel, random)
+{
+  static struct timer timers[NTIMERS];
+  // limit the rate at which time advances to stay clear of overflow
+  const int64_t max_step = INT64_C (1) << 40;
+  ddsrt_timerwheel_t tw;
+  ddsrt_prng_t prng;
+  ddsrt_prng_init_simple (&prng, (uint32_t) range);
+  int64_t tnow = INT64_C (1) << 40;
+  ddsrt_timerwheel_init (&twdef, &tw, tnow);
+  for (uint32_t i = 0; i < NTIMERS; i++)
+    timers[i].in_wheel = false;
+
+  for (uint32_t iter = 0; iter < 100000; iter++)
+  {
+    struct timer * const x = &timers[ddsrt_prng_random (&prng) % NTIMERS];
+    switch (ddsrt_prng_random (&prng) % 4)
+    {
+      case 0: case 1: // (re)schedule
+        if (x->in_wheel)
+          ddsrt_timerwheel_delete (&twdef, &tw, x);
+        x->t = tnow + random_delta (&prng, range);
+        x->in_wheel = true;
+        ddsrt_timerwheel_insert (&twdef, &tw, x, x->t);
+        break;
+      case 2: // cancel
+        if (x->in_wheel)
+        {
+          ddsrt_timerwheel_delete (&twdef, &tw, x);
+          x->in_wheel = false;
+        }
+        break;
+      case 3: { // advance time and take out everything that expired
+        const int64_t tnext = ddsrt_timerwheel_next (&twdef, &tw);
+        // jump to the next timer often enough, or else most of them only ever get
+        // rescheduled or cancelled
+        const int64_t step = random_delta (&prng, range < max_step ? range : max_step);
+        if (tnext > tnow && tnext - tnow <= max_step && (ddsrt_prng_random (&prng) % 2) == 0)
+          tnow = tnext;
+        else
+          tnow += (step < 0 ? -step : step) / 8;
+        struct timer *y;
+        while ((y = ddsrt_timerwheel_extract_due (&twdef, &tw, tnow)) != NULL)
+        {
+          CU_ASSERT_FATAL (y->in_wheel);
+          CU_ASSERT_FATAL (y->t <= tnow);
+          y->in_wheel = false;
+        }
+        break;
+      }
+    }
+    check_next (&tw, timers, tnow);
+  }
+
+  uint32_t n = 0;
+  for (uint32_t i = 0; i < NTIMERS; i++)
+    n += timers[i].in_wheel;
+  struct timer *y;
+  while ((y = ddsrt_timerwheel_extract_any (&twdef, &tw)) != NULL)
+  {
+    CU_ASSERT_FATAL (y->in_wheel);
+    y->in_wheel = false;
+    n--;
+  }
+  CU_ASSERT_FATAL (n == 0);
+  CU_ASSERT_FATAL (ddsrt_timerwheel_next (&twdef, &tw) == INT64_MAX);
+}
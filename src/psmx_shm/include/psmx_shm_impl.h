@@ -0,0 +1,49 @@
+// Copyright(c) 2025 ZettaScale Technology and others
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License v. 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Eclipse Distribution License
+// v. 1.0 which is available at
+// http://www.eclipse.org/org/documents/edl-v10.php.
+//
+// SPDX-License-Identifier: EPL-2.0 OR BSD-3-Clause
+
+#ifndef PSMX_SHM_IMPL_H
+#define PSMX_SHM_IMPL_H
+
+#include "dds/dds.h"
+#include "dds/ddsc/dds_psmx.h"
+#include "psmx_shm_export.h"
+
+#if defined (__cplusplus)
+extern "C" {
+#endif
+
+/**
+ * @brief Constructor for the shared-memory PSMX plugin
+ *
+ * Communication between processes on the same host using POSIX shared memory and
+ * futexes, without requiring a separate daemon.  Supported configuration options, in
+ * addition to the generic ones:
+ *
+ * - KEYED_TOPICS=true|false: whether to accept topics with a key (default true)
+ * - POOL_SIZE=N[k|M|G]: address space reserved for the memory pool of each PSMX
+ *   instance from which the loans are taken (default 512M), memory is only committed
+ *   once it is actually used
+ * - QUEUE_CAPACITY=N: number of samples that can be queued for each reader (default
+ *   1024, rounded up to a power of 2)
+ * - MAX_READERS=N: maximum number of readers for a topic/partition on the host
+ *   (default 64)
+ *
+ * @param[out] psmx         New PSMX instance
+ * @param[in] instance_id   Numeric PSMX instance id
+ * @param[in] config        PSMX configuration string
+ * @returns a DDS return code
+ */
+DDS_PSMX_SHM_EXPORT dds_return_t shm_create_psmx (struct dds_psmx **psmx, dds_psmx_instance_id_t instance_id, const char *config);
+
+#if defined (__cplusplus)
+}
+#endif
+
+#endif /* PSMX_SHM_IMPL_H */
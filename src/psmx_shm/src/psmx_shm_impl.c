@@ -0,0 +1,1552 @@
+// Copyright(c) 2025 ZettaScale Technology and others
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License v. 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Eclipse Distribution License
+// v. 1.0 which is available at
+// http://www.eclipse.org/org/documents/edl-v10.php.
+//
+// SPDX-License-Identifier: EPL-2.0 OR BSD-3-Clause
+
+// Shared memory PSMX plugin that doesn't need a daemon.
+//
+// There are three kinds of shared memory segments, all POSIX shared memory objects:
+//
+// - a "node" segment per PSMX instance name, containing a random node identifier that
+//   is shared by all processes on the machine;
+// - a "pool" segment per PSMX instance per process from which the loans are allocated
+//   (only by the owning process) and to which they are returned by whichever process
+//   drops the last reference;
+// - a "channel" segment per service/type/partition/topic containing a fixed number of
+//   reader slots, each slot containing a bounded multi-producer single-consumer queue
+//   of references to chunks in the pools.
+//
+// A writer pushes a reference to its chunk to the queue of each active reader slot of
+// the channel and wakes up the reader thread if needed using a futex in the slot.
+// Reliable readers cause the writer to block for at most the max blocking time if the
+// queue is full, best-effort readers simply lose the sample.
+//
+// Processes are identified by a random "user id" rather than by their pid: pids are
+// meaningless across pid namespaces (containers sharing /dev/shm), where kill(pid,0)
+// would declare live processes dead.  Each process holds an exclusive flock on a "user"
+// object named after its id for as long as it uses the plugin, a process is alive if that
+// object exists and is locked.  The lock is released by the kernel when the process
+// terminates, however that happens.
+//
+// The node and channel segments contain a table of user ids of the processes using
+// them, protected by a flock on the segment.  The last one to leave unlinks the segment,
+// entries of processes that no longer exist are removed when a process attaches.  Pools
+// are unlinked once the owner is gone and the last chunk has been freed.  Pools of dead
+// processes are removed when a new instance is created.
+//
+// All objects are created with mode SHM_MODE, so only processes of the same user or
+// group can use them.
+
+#include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <linux/futex.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <time.h>
+
+#include "dds/dds.h"
+#include "dds/ddsrt/atomics.h"
+#include "dds/ddsrt/heap.h"
+#include "dds/ddsrt/md5.h"
+#include "dds/ddsrt/misc.h"
+#include "dds/ddsrt/random.h"
+#include "dds/ddsrt/static_assert.h"
+#include "dds/ddsrt/string.h"
+#include "dds/ddsrt/strtol.h"
+#include "dds/ddsrt/sync.h"
+#include "dds/ddsrt/threads.h"
+#include "dds/ddsrt/time.h"
+#include "dds/ddsc/dds_loaned_sample.h"
+#include "dds/ddsc/dds_psmx.h"
+#include "psmx_shm_impl.h"
+
+#if ! DDSRT_HAVE_ATOMIC64
+#error "shared memory PSMX plugin requires 64-bit atomics"
+#endif
+
+#define ERROR_PREFIX "=== [SHM] "
+
+#define SHM_NAME_PREFIX "/cdds_psmx_shm_"
+#define SHM_NAME_MAX 64
+#define SHM_DEV_SHM "/dev/shm"
+#define SHM_CACHE_LINE 64u
+
+#define SHM_SEGMENT_MAGIC 0x43444d53u /* "CDMS" */
+#define SHM_POOL_MAGIC 0x43444d50u /* "CDMP" */
+#define SHM_VERSION 2u
+#define SHM_MAX_USERS 256
+#define SHM_MODE 0660
+#define SHM_USER_ID_MASK 0x3fffffffu /* user ids must fit in a slot state */
+
+#define SHM_DEFAULT_POOL_SIZE (512u * 1024u * 1024u)
+#define SHM_MIN_POOL_SIZE (1u * 1024u * 1024u)
+#define SHM_DEFAULT_QUEUE_CAPACITY 1024u
+#define SHM_MAX_QUEUE_CAPACITY (1u << 20)
+#define SHM_DEFAULT_MAX_READERS 64u
+#define SHM_MAX_MAX_READERS 4096u
+
+// Size classes: 256 << (2*i), the largest is 16MiB, each chunk starts with a header
+#define SHM_NCLASSES 9
+#define SHM_CLASS_SIZE(i) (256u << (2 * (i)))
+#define SHM_CHUNK_HDR_SIZE 64u
+#define SHM_POOL_HDR_SIZE 4096u
+
+// A slot's state word combines the pid of the reader with the actual state, so that
+// a slot of a reader that died can be reclaimed without the risk of reclaiming the
+// slot of a new reader that happened to claim it in the meantime
+#define SHM_SLOT_FREE     0u
+#define SHM_SLOT_CLAIMING 1u
+#define SHM_SLOT_ACTIVE   2u
+#define SHM_SLOT_CLOSING  3u
+#define SHM_SLOT_STATE(s) ((s) & 3u)
+#define SHM_SLOT_USER(s) ((s) >> 2)
+#define SHM_SLOT_MAKE(user, st) (((user) << 2) | (st))
+
+#define SHM_SLOT_FLAG_RELIABLE 1u
+
+// Header shared by the node and channel segments
+struct shm_segment_hdr {
+  uint32_t magic;
+  uint32_t version;
+  uint64_t size;
+  uint32_t nusers;
+  uint32_t users[SHM_MAX_USERS];
+};
+
+struct shm_node_hdr {
+  struct shm_segment_hdr h;
+  dds_psmx_node_identifier_t node_id;
+};
+
+struct shm_channel_hdr {
+  struct shm_segment_hdr h;
+  uint32_t max_readers;
+  uint32_t capacity;
+  uint32_t slot_size;
+  uint32_t slots_offset;
+};
+
+struct shm_cell {
+  ddsrt_atomic_uint32_t seq;
+  uint32_t pad;
+  uint64_t pool_id;
+  uint64_t offset;
+};
+
+struct shm_slot {
+  ddsrt_atomic_uint32_t state;
+  ddsrt_atomic_uint32_t flags;
+  ddsrt_atomic_uint32_t nwriters;
+  ddsrt_atomic_uint32_t data_futex;
+  ddsrt_atomic_uint32_t reader_sleeping;
+  ddsrt_atomic_uint32_t space_futex;
+  ddsrt_atomic_uint32_t writers_waiting;
+  char pad0[SHM_CACHE_LINE - 7 * sizeof (uint32_t)];
+  ddsrt_atomic_uint32_t head; // consumer position
+  char pad1[SHM_CACHE_LINE - sizeof (uint32_t)];
+  ddsrt_atomic_uint32_t tail; // producer position
+  char pad2[SHM_CACHE_LINE - sizeof (uint32_t)];
+  struct shm_cell cells[];
+};
+
+struct shm_pool_class {
+  uint64_t offset;
+  uint32_t chunk_size;
+  uint32_t nchunks;
+  ddsrt_atomic_uint64_t free_list; // (tag << 32) | (index + 1), 0 if empty
+  ddsrt_atomic_uint32_t ncarved;
+  uint32_t pad;
+};
+
+struct shm_pool_hdr {
+  uint32_t magic;
+  uint32_t version;
+  uint64_t id;
+  uint64_t size;
+  ddsrt_atomic_uint32_t nallocated;
+  ddsrt_atomic_uint32_t orphaned;
+  ddsrt_atomic_uint32_t free_futex;
+  ddsrt_atomic_uint32_t free_waiters;
+  struct shm_pool_class cls[SHM_NCLASSES];
+};
+
+struct shm_chunk {
+  ddsrt_atomic_uint32_t refc;
+  ddsrt_atomic_uint32_t next;
+  uint32_t cls;
+  uint32_t index;
+  dds_psmx_metadata_t metadata;
+};
+
+DDSRT_STATIC_ASSERT (sizeof (struct shm_chunk) <= SHM_CHUNK_HDR_SIZE);
+DDSRT_STATIC_ASSERT (sizeof (struct shm_pool_hdr) <= SHM_POOL_HDR_SIZE);
+DDSRT_STATIC_ASSERT (offsetof (struct shm_slot, cells) == 3 * SHM_CACHE_LINE);
+
+struct shm_segment {
+  int fd;
+  void *addr;
+  size_t size;
+  char name[SHM_NAME_MAX];
+};
+
+struct shm_pool_map {
+  struct shm_pool_map *next;
+  uint64_t id;
+  ddsrt_atomic_uint32_t refc; // one for being in the list, one for each loan
+  bool own;
+  struct shm_segment seg;
+};
+
+struct shm_psmx {
+  struct dds_psmx c;
+  char *service_name;
+  bool support_keyed_topics;
+  uint64_t pool_size;
+  uint32_t queue_capacity;
+  uint32_t max_readers;
+  ddsrt_mutex_t lock;
+  bool have_node;
+  struct shm_segment node;
+  struct shm_pool_map *own_pool;
+  struct shm_pool_map *pool_maps;
+};
+
+struct shm_psmx_topic {
+  struct dds_psmx_topic c;
+  char *topic_name;
+  char *type_name;
+};
+
+struct shm_psmx_endpoint {
+  struct dds_psmx_endpoint c;
+  struct shm_psmx *psmx;
+  dds_psmx_endpoint_type_t endpoint_type;
+  struct shm_segment channel;
+  dds_duration_t max_blocking_time;
+  // reader-only
+  struct shm_slot *slot;
+  uint32_t slot_state; // value of state word while active
+  dds_entity_t reader;
+  ddsrt_mutex_t lock; // serialises taking samples from the queue
+  ddsrt_atomic_uint32_t terminate;
+  bool thread_running;
+  ddsrt_thread_t tid;
+};
+
+struct shm_loan {
+  dds_loaned_sample_t c;
+  struct shm_pool_map *map;
+  struct shm_chunk *chunk;
+};
+
+typedef void (*shm_segment_init_fn_t) (void *addr, size_t size, const void *arg);
+
+static bool shm_type_qos_supported (struct dds_psmx *psmx, dds_psmx_endpoint_type_t forwhat, dds_data_type_properties_t data_type_props, const struct dds_qos *qos);
+static struct dds_psmx_topic *shm_create_topic (struct dds_psmx *psmx, const char *topic_name, const char *type_name, dds_data_type_properties_t data_type_props, const struct ddsi_type *type_definition, uint32_t sizeof_type);
+static dds_return_t shm_delete_topic (struct dds_psmx_topic *psmx_topic);
+static void shm_delete_psmx (struct dds_psmx *psmx);
+static dds_psmx_node_identifier_t shm_get_node_id (const struct dds_psmx *psmx);
+static dds_psmx_features_t shm_supported_features (const struct dds_psmx *psmx);
+
+static const dds_psmx_ops_t psmx_instance_ops = {
+  .type_qos_supported = shm_type_qos_supported,
+  .create_topic = NULL,
+  .delete_topic = shm_delete_topic,
+  .deinit = NULL,
+  .get_node_id = shm_get_node_id,
+  .supported_features = shm_supported_features,
+  .create_topic_with_type = shm_create_topic,
+  .delete_psmx = shm_delete_psmx
+};
+
+static struct dds_psmx_endpoint *shm_create_endpoint (struct dds_psmx_topic *psmx_topic, const struct dds_qos *qos, dds_psmx_endpoint_type_t endpoint_type);
+static dds_return_t shm_delete_endpoint (struct dds_psmx_endpoint *psmx_endpoint);
+
+static const dds_psmx_topic_ops_t psmx_topic_ops = {
+  .create_endpoint = shm_create_endpoint,
+  .delete_endpoint = shm_delete_endpoint
+};
+
+static dds_loaned_sample_t *shm_ep_request_loan (struct dds_psmx_endpoint *psmx_endpoint, uint32_t size_requested);
+static dds_return_t shm_ep_write_with_key (struct dds_psmx_endpoint *psmx_endpoint, dds_loaned_sample_t *data, size_t keysz, const void *key);
+static dds_loaned_sample_t *shm_ep_take (struct dds_psmx_endpoint *psmx_endpoint);
+static dds_return_t shm_ep_on_data_available (struct dds_psmx_endpoint *psmx_endpoint, dds_entity_t reader);
+
+static const dds_psmx_endpoint_ops_t psmx_ep_ops = {
+  .request_loan = shm_ep_request_loan,
+  .write = NULL,
+  .take = shm_ep_take,
+  .on_data_available = shm_ep_on_data_available,
+  .write_with_key = shm_ep_write_with_key
+};
+
+static void shm_loaned_sample_free (struct dds_loaned_sample *loaned_sample);
+
+static const dds_loaned_sample_ops_t ls_ops = {
+  .free = shm_loaned_sample_free
+};
+
+/* Futexes and processes */
+
+static void shm_futex_wait (ddsrt_atomic_uint32_t *a, uint32_t expected, dds_duration_t timeout)
+{
+  // not FUTEX_PRIVATE_FLAG: the futex is shared between processes
+  struct timespec ts = { .tv_sec = (time_t) (timeout / DDS_NSECS_IN_SEC), .tv_nsec = (long) (timeout % DDS_NSECS_IN_SEC) };
+  (void) syscall (SYS_futex, &a->v, FUTEX_WAIT, expected, &ts, NULL, 0);
+}
+
+static void shm_futex_wake (ddsrt_atomic_uint32_t *a)
+{
+  (void) syscall (SYS_futex, &a->v, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+}
+
+/* Users (processes) */
+
+static ddsrt_once_t shm_self_once = DDSRT_ONCE_INIT;
+static ddsrt_mutex_t shm_self_lock;
+static uint32_t shm_self_refc;
+static uint32_t shm_self_id;
+static pid_t shm_self_pid;
+static int shm_self_fd = -1;
+
+static void shm_make_name (char *name, size_t size, const char *kind, const char *fmt, ...)
+  ddsrt_attribute_format_printf (4, 5);
+
+static void shm_user_name (char *name, size_t size, uint32_t id)
+{
+  shm_make_name (name, size, "user", "%08"PRIx32, id);
+}
+
+static void shm_self_init_lock (void)
+{
+  ddsrt_mutex_init (&shm_self_lock);
+}
+
+static dds_return_t shm_self_create (void)
+{
+  char name[SHM_NAME_MAX];
+  // 30 random bits, a collision with an existing user only costs another attempt
+  for (int attempt = 0; attempt < 100; attempt++)
+  {
+    const uint32_t id = ddsrt_random () & SHM_USER_ID_MASK;
+    if (id == 0)
+      continue;
+    shm_user_name (name, sizeof (name), id);
+    int fd;
+    if ((fd = shm_open (name, O_RDONLY | O_CREAT | O_EXCL, SHM_MODE)) < 0)
+    {
+      if (errno == EEXIST)
+        continue;
+      return DDS_RETCODE_ERROR;
+    }
+    if (flock (fd, LOCK_EX | LOCK_NB) < 0)
+    {
+      (void) shm_unlink (name);
+      (void) close (fd);
+      return DDS_RETCODE_ERROR;
+    }
+    shm_self_id = id;
+    shm_self_pid = getpid ();
+    shm_self_fd = fd;
+    return DDS_RETCODE_OK;
+  }
+  return DDS_RETCODE_ERROR;
+}
+
+static dds_return_t shm_self_ref (void)
+{
+  dds_return_t ret = DDS_RETCODE_OK;
+  ddsrt_once (&shm_self_once, shm_self_init_lock);
+  ddsrt_mutex_lock (&shm_self_lock);
+  if (shm_self_refc > 0 && shm_self_pid != getpid ())
+  {
+    // forked: the lock (and so the user id) belongs to the parent
+    (void) close (shm_self_fd);
+    shm_self_refc = 0;
+  }
+  if (shm_self_refc == 0)
+    ret = shm_self_create ();
+  if (ret == DDS_RETCODE_OK)
+    shm_self_refc++;
+  ddsrt_mutex_unlock (&shm_self_lock);
+  return ret;
+}
+
+static void shm_self_unref (void)
+{
+  ddsrt_mutex_lock (&shm_self_lock);
+  if (shm_self_pid == getpid () && --shm_self_refc == 0)
+  {
+    char name[SHM_NAME_MAX];
+    shm_user_name (name, sizeof (name), shm_self_id);
+    (void) shm_unlink (name);
+    (void) close (shm_self_fd);
+    shm_self_fd = -1;
+    shm_self_id = 0;
+  }
+  ddsrt_mutex_unlock (&shm_self_lock);
+}
+
+static bool shm_user_alive (uint32_t id)
+{
+  // Errors other than the object not existing are treated as the user being alive:
+  // wrongly declaring a process dead is worse than keeping a dead one around
+  if (id == shm_self_id)
+    return true;
+  char name[SHM_NAME_MAX];
+  shm_user_name (name, sizeof (name), id);
+  int fd;
+  if ((fd = shm_open (name, O_RDONLY, 0)) < 0)
+    return errno != ENOENT;
+  bool alive = true;
+  if (flock (fd, LOCK_EX | LOCK_NB) == 0)
+  {
+    // nobody holds the lock, so the owner is gone without cleaning up after itself
+    (void) shm_unlink (name);
+    (void) flock (fd, LOCK_UN);
+    alive = false;
+  }
+  (void) close (fd);
+  return alive;
+}
+
+/* Segments shared by all processes: node and channel */
+
+static void shm_segment_purge_users (struct shm_segment_hdr *hdr)
+{
+  // Forget about processes that no longer exist, caller must hold the lock
+  for (uint32_t i = 0; i < hdr->nusers; )
+  {
+    if (shm_user_alive (hdr->users[i]))
+      i++;
+    else
+      hdr->users[i] = hdr->users[--hdr->nusers];
+  }
+}
+
+static dds_return_t shm_segment_attach (struct shm_segment *seg, const char *name, size_t size, shm_segment_init_fn_t init, const void *arg)
+{
+  struct stat st;
+  int fd;
+  // The last process to detach unlinks the segment while holding the lock, so if the
+  // object turns out to have been unlinked by the time we get the lock, try again
+  for (;;)
+  {
+    if ((fd = shm_open (name, O_RDWR | O_CREAT, SHM_MODE)) < 0)
+      return DDS_RETCODE_ERROR;
+    if (flock (fd, LOCK_EX) < 0 || fstat (fd, &st) < 0)
+    {
+      (void) close (fd);
+      return DDS_RETCODE_ERROR;
+    }
+    if (st.st_nlink > 0)
+      break;
+    (void) close (fd);
+  }
+
+  if (st.st_size > 0)
+    size = (size_t) st.st_size;
+  else if (ftruncate (fd, (off_t) size) < 0)
+    goto err;
+  void *addr;
+  if ((addr = mmap (NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0)) == MAP_FAILED)
+    goto err;
+
+  struct shm_segment_hdr *hdr = addr;
+  if (hdr->magic == 0)
+  {
+    init (addr, size, arg);
+    hdr->version = SHM_VERSION;
+    hdr->size = size;
+    hdr->magic = SHM_SEGMENT_MAGIC;
+  }
+  else if (hdr->magic != SHM_SEGMENT_MAGIC || hdr->version != SHM_VERSION || hdr->size != size)
+  {
+    (void) munmap (addr, size);
+    goto err;
+  }
+
+  shm_segment_purge_users (hdr);
+  if (hdr->nusers == SHM_MAX_USERS)
+  {
+    (void) munmap (addr, size);
+    goto err;
+  }
+  hdr->users[hdr->nusers++] = shm_self_id;
+  (void) flock (fd, LOCK_UN);
+
+  seg->fd = fd;
+  seg->addr = addr;
+  seg->size = size;
+  (void) ddsrt_strlcpy (seg->name, name, sizeof (seg->name));
+  return DDS_RETCODE_OK;
+
+err:
+  (void) flock (fd, LOCK_UN);
+  (void) close (fd);
+  return DDS_RETCODE_ERROR;
+}
+
+static void shm_segment_detach (struct shm_segment *seg)
+{
+  struct shm_segment_hdr *hdr = seg->addr;
+  (void) flock (seg->fd, LOCK_EX);
+  for (uint32_t i = 0; i < hdr->nusers; i++)
+  {
+    if (hdr->users[i] == shm_self_id)
+    {
+      hdr->users[i] = hdr->users[--hdr->nusers];
+      break;
+    }
+  }
+  shm_segment_purge_users (hdr);
+  if (hdr->nusers == 0)
+    (void) shm_unlink (seg->name);
+  (void) flock (seg->fd, LOCK_UN);
+  (void) munmap (seg->addr, seg->size);
+  (void) close (seg->fd);
+}
+
+static void shm_make_name (char *name, size_t size, const char *kind, const char *fmt, ...)
+{
+  va_list ap;
+  int n = snprintf (name, size, "%s%s_", SHM_NAME_PREFIX, kind);
+  assert (n > 0 && (size_t) n < size);
+  va_start (ap, fmt);
+  (void) vsnprintf (name + n, size - (size_t) n, fmt, ap);
+  va_end (ap);
+}
+
+static void shm_md5_hex (char hex[33], const char **parts, size_t nparts)
+{
+  ddsrt_md5_state_t md5st;
+  ddsrt_md5_byte_t digest[16];
+  ddsrt_md5_init (&md5st);
+  for (size_t i = 0; i < nparts; i++)
+    ddsrt_md5_append (&md5st, (const ddsrt_md5_byte_t *) parts[i], (unsigned) strlen (parts[i]) + 1);
+  ddsrt_md5_finish (&md5st, digest);
+  for (size_t i = 0; i < sizeof (digest); i++)
+    (void) snprintf (hex + 2 * i, 3, "%02x", digest[i]);
+}
+
+/* Pools */
+
+static void shm_pool_name (char *name, size_t size, uint64_t id)
+{
+  shm_make_name (name, size, "pool", "%016"PRIx64, id);
+}
+
+static dds_return_t shm_pool_create (struct shm_segment *seg, uint64_t id, uint64_t pool_size)
+{
+  char name[SHM_NAME_MAX];
+  shm_pool_name (name, sizeof (name), id);
+  int fd;
+  if ((fd = shm_open (name, O_RDWR | O_CREAT | O_EXCL, SHM_MODE)) < 0)
+    return DDS_RETCODE_ERROR;
+  // Only the memory for the header and the chunks that are actually carved out of the
+  // pool gets allocated, see shm_pool_alloc
+  void *addr;
+  if (ftruncate (fd, (off_t) pool_size) < 0 ||
+      posix_fallocate (fd, 0, SHM_POOL_HDR_SIZE) != 0 ||
+      (addr = mmap (NULL, (size_t) pool_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0)) == MAP_FAILED)
+  {
+    (void) shm_unlink (name);
+    (void) close (fd);
+    return DDS_RETCODE_OUT_OF_RESOURCES;
+  }
+
+  struct shm_pool_hdr *pool = addr;
+  pool->id = id;
+  pool->size = pool_size;
+  const uint64_t region_size = ((pool_size - SHM_POOL_HDR_SIZE) / SHM_NCLASSES) & ~(uint64_t) (SHM_POOL_HDR_SIZE - 1);
+  uint64_t offset = SHM_POOL_HDR_SIZE;
+  for (uint32_t i = 0; i < SHM_NCLASSES; i++)
+  {
+    struct shm_pool_class *cls = &pool->cls[i];
+    cls->chunk_size = SHM_CLASS_SIZE (i);
+    cls->offset = offset;
+    cls->nchunks = (uint32_t) (region_size / cls->chunk_size);
+    offset += region_size;
+  }
+  ddsrt_atomic_fence_rel ();
+  pool->version = SHM_VERSION;
+  pool->magic = SHM_POOL_MAGIC;
+
+  seg->fd = fd;
+  seg->addr = addr;
+  seg->size = (size_t) pool_size;
+  (void) ddsrt_strlcpy (seg->name, name, sizeof (seg->name));
+  return DDS_RETCODE_OK;
+}
+
+static dds_return_t shm_pool_open (struct shm_segment *seg, uint64_t id)
+{
+  char name[SHM_NAME_MAX];
+  shm_pool_name (name, sizeof (name), id);
+  int fd;
+  if ((fd = shm_open (name, O_RDWR, 0)) < 0)
+    return DDS_RETCODE_ERROR;
+  struct stat st;
+  void *addr;
+  if (fstat (fd, &st) < 0 || (size_t) st.st_size < SHM_POOL_HDR_SIZE ||
+      (addr = mmap (NULL, (size_t) st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0)) == MAP_FAILED)
+  {
+    (void) close (fd);
+    return DDS_RETCODE_ERROR;
+  }
+  const struct shm_pool_hdr *pool = addr;
+  if (pool->magic != SHM_POOL_MAGIC || pool->version != SHM_VERSION || pool->id != id || pool->size != (uint64_t) st.st_size)
+  {
+    (void) munmap (addr, (size_t) st.st_size);
+    (void) close (fd);
+    return DDS_RETCODE_ERROR;
+  }
+  seg->fd = fd;
+  seg->addr = addr;
+  seg->size = (size_t) st.st_size;
+  (void) ddsrt_strlcpy (seg->name, name, sizeof (seg->name));
+  return DDS_RETCODE_OK;
+}
+
+static void shm_pool_close (struct shm_segment *seg)
+{
+  (void) munmap (seg->addr, seg->size);
+  (void) close (seg->fd);
+}
+
+static void shm_pool_remove_stale (void)
+{
+  // Pool names contain the user id of the owner, which makes it possible to get rid of
+  // the ones left behind by processes that crashed.  Readers that still have them mapped
+  // don't care.
+  DIR *dir;
+  if ((dir = opendir (SHM_DEV_SHM)) == NULL)
+    return;
+  const char *prefix = SHM_NAME_PREFIX "pool_";
+  const size_t prefixlen = strlen (prefix) - 1; // no leading '/' in directory
+  struct dirent *ent;
+  while ((ent = readdir (dir)) != NULL)
+  {
+    if (strncmp (ent->d_name, prefix + 1, prefixlen) != 0 || strlen (ent->d_name) != prefixlen + 16)
+      continue;
+    char idhex[9];
+    memcpy (idhex, ent->d_name + prefixlen, 8);
+    idhex[8] = 0;
+    unsigned long long id;
+    char *endp;
+    if (ddsrt_strtoull (idhex, &endp, 16, &id) != DDS_RETCODE_OK || *endp != 0)
+      continue;
+    if (!shm_user_alive ((uint32_t) id))
+    {
+      char name[SHM_NAME_MAX] = "/";
+      (void) ddsrt_strlcpy (name + 1, ent->d_name, sizeof (name) - 1);
+      (void) shm_unlink (name);
+    }
+  }
+  (void) closedir (dir);
+}
+
+static uint32_t shm_pool_class_pop (struct shm_pool_class *cls, const struct shm_pool_hdr *pool)
+{
+  uint64_t head, next;
+  do {
+    head = ddsrt_atomic_ld64 (&cls->free_list);
+    const uint32_t idx1 = (uint32_t) head;
+    if (idx1 == 0)
+      return UINT32_MAX;
+    const struct shm_chunk *chunk = (const struct shm_chunk *) ((const char *) pool + cls->offset + (uint64_t) (idx1 - 1) * cls->chunk_size);
+    next = ((head >> 32) + 1) << 32 | ddsrt_atomic_ld32 (&chunk->next);
+  } while (!ddsrt_atomic_cas64 (&cls->free_list, head, next));
+  return (uint32_t) head - 1;
+}
+
+static void shm_pool_class_push (struct shm_pool_class *cls, struct shm_chunk *chunk)
+{
+  uint64_t head, next;
+  do {
+    head = ddsrt_atomic_ld64 (&cls->free_list);
+    ddsrt_atomic_st32 (&chunk->next, (uint32_t) head);
+    next = ((head >> 32) + 1) << 32 | (chunk->index + 1);
+  } while (!ddsrt_atomic_cas64 (&cls->free_list, head, next));
+}
+
+static struct shm_chunk *shm_pool_alloc (struct shm_pool_map *map, uint32_t size)
+{
+  struct shm_pool_hdr *pool = map->seg.addr;
+  for (uint32_t i = 0; i < SHM_NCLASSES; i++)
+  {
+    struct shm_pool_class *cls = &pool->cls[i];
+    if (size > cls->chunk_size - SHM_CHUNK_HDR_SIZE)
+      continue;
+    uint32_t idx = shm_pool_class_pop (cls, pool);
+    if (idx == UINT32_MAX)
+    {
+      // Nothing on the free list, carve a new one out of the region, making sure the
+      // memory is really there because touching unbacked memory results in a SIGBUS.
+      // The chunk is only claimed once it is backed, so that a failure doesn't lose it;
+      // allocating the memory twice when racing with another thread is harmless.
+      uint32_t n;
+      bool backed = false;
+      while ((n = ddsrt_atomic_ld32 (&cls->ncarved)) < cls->nchunks)
+      {
+        if (!(backed = (posix_fallocate (map->seg.fd, (off_t) (cls->offset + (uint64_t) n * cls->chunk_size), cls->chunk_size) == 0)))
+          break;
+        if (ddsrt_atomic_cas32 (&cls->ncarved, n, n + 1))
+          break;
+      }
+      if (n >= cls->nchunks || !backed)
+        continue;
+      idx = n;
+    }
+    struct shm_chunk *chunk = (struct shm_chunk *) ((char *) pool + cls->offset + (uint64_t) idx * cls->chunk_size);
+    ddsrt_atomic_st32 (&chunk->refc, 1);
+    chunk->cls = i;
+    chunk->index = idx;
+    ddsrt_atomic_inc32 (&pool->nallocated);
+    return chunk;
+  }
+  return NULL;
+}
+
+static struct shm_chunk *shm_pool_alloc_wait (struct shm_pool_map *map, uint32_t size, dds_duration_t max_blocking_time)
+{
+  // Pool exhausted: the readers hold on to all chunks that can satisfy the request,
+  // so wait for them to free some, just like a writer waits for space in a queue
+  struct shm_pool_hdr *pool = map->seg.addr;
+  struct shm_chunk *chunk = NULL;
+  if (size > SHM_CLASS_SIZE (SHM_NCLASSES - 1) - SHM_CHUNK_HDR_SIZE || max_blocking_time <= 0)
+    return NULL;
+  const dds_time_t tnow = ddsrt_time_monotonic ().v;
+  const dds_time_t tend = (max_blocking_time >= DDS_NEVER - tnow) ? DDS_NEVER : tnow + max_blocking_time;
+  ddsrt_atomic_inc32 (&pool->free_waiters);
+  for (;;)
+  {
+    const uint32_t fv = ddsrt_atomic_ld32 (&pool->free_futex);
+    if ((chunk = shm_pool_alloc (map, size)) != NULL)
+      break;
+    const dds_time_t now = ddsrt_time_monotonic ().v;
+    if (now >= tend)
+      break;
+    shm_futex_wait (&pool->free_futex, fv, (tend - now < DDS_MSECS (10)) ? tend - now : DDS_MSECS (10));
+  }
+  ddsrt_atomic_dec32 (&pool->free_waiters);
+  return chunk;
+}
+
+static void shm_chunk_unref (struct shm_pool_map *map, struct shm_chunk *chunk)
+{
+  if (ddsrt_atomic_dec32_nv (&chunk->refc) > 0)
+    return;
+  struct shm_pool_hdr *pool = map->seg.addr;
+  assert (chunk->cls < SHM_NCLASSES);
+  shm_pool_class_push (&pool->cls[chunk->cls], chunk);
+  ddsrt_atomic_inc32 (&pool->free_futex);
+  if (ddsrt_atomic_ld32 (&pool->free_waiters))
+    shm_futex_wake (&pool->free_futex);
+  if (ddsrt_atomic_dec32_nv (&pool->nallocated) == 0 && ddsrt_atomic_ld32 (&pool->orphaned))
+    (void) shm_unlink (map->seg.name);
+}
+
+static struct shm_chunk *shm_pool_map_chunk (const struct shm_pool_map *map, uint64_t offset)
+{
+  const struct shm_pool_hdr *pool = map->seg.addr;
+  if (offset < SHM_POOL_HDR_SIZE || offset >= map->seg.size)
+    return NULL;
+  struct shm_chunk *chunk = (struct shm_chunk *) ((char *) map->seg.addr + offset);
+  if (chunk->cls >= SHM_NCLASSES || offset + pool->cls[chunk->cls].chunk_size > map->seg.size)
+    return NULL;
+  return chunk;
+}
+
+static void shm_pool_map_free (struct shm_pool_map *map)
+{
+  if (map->own)
+  {
+    struct shm_pool_hdr *pool = map->seg.addr;
+    ddsrt_atomic_inc32 (&pool->orphaned);
+    if (ddsrt_atomic_ld32 (&pool->nallocated) == 0)
+      (void) shm_unlink (map->seg.name);
+  }
+  shm_pool_close (&map->seg);
+  ddsrt_free (map);
+}
+
+static struct shm_pool_map *shm_pool_map_ref (struct shm_psmx *spsmx, uint64_t id)
+{
+  struct shm_pool_map *map;
+  ddsrt_mutex_lock (&spsmx->lock);
+  for (map = spsmx->pool_maps; map; map = map->next)
+  {
+    if (map->id == id)
+    {
+      ddsrt_atomic_inc32 (&map->refc);
+      ddsrt_mutex_unlock (&spsmx->lock);
+      return map;
+    }
+  }
+
+  // Not mapped yet: good moment to also get rid of mappings of pools that no longer have
+  // an owner and from which we have no outstanding loans
+  struct shm_pool_map **prev = &spsmx->pool_maps;
+  while ((map = *prev) != NULL)
+  {
+    const struct shm_pool_hdr *pool = map->seg.addr;
+    if (!map->own && ddsrt_atomic_ld32 (&map->refc) == 1 && ddsrt_atomic_ld32 (&pool->orphaned))
+    {
+      *prev = map->next;
+      shm_pool_map_free (map);
+    }
+    else
+    {
+      prev = &map->next;
+    }
+  }
+
+  map = ddsrt_malloc (sizeof (*map));
+  if (shm_pool_open (&map->seg, id) != DDS_RETCODE_OK)
+  {
+    ddsrt_free (map);
+    map = NULL;
+  }
+  else
+  {
+    map->id = id;
+    map->own = false;
+    ddsrt_atomic_st32 (&map->refc, 2);
+    map->next = spsmx->pool_maps;
+    spsmx->pool_maps = map;
+  }
+  ddsrt_mutex_unlock (&spsmx->lock);
+  return map;
+}
+
+static struct shm_pool_map *shm_own_pool_ref (struct shm_psmx *spsmx)
+{
+  struct shm_pool_map *map;
+  ddsrt_mutex_lock (&spsmx->lock);
+  if ((map = spsmx->own_pool) == NULL)
+  {
+    const uint64_t id = ((uint64_t) shm_self_id << 32) | ddsrt_random ();
+    map = ddsrt_malloc (sizeof (*map));
+    if (shm_pool_create (&map->seg, id, spsmx->pool_size) != DDS_RETCODE_OK)
+    {
+      ddsrt_free (map);
+      ddsrt_mutex_unlock (&spsmx->lock);
+      return NULL;
+    }
+    map->id = id;
+    map->own = true;
+    ddsrt_atomic_st32 (&map->refc, 1);
+    map->next = spsmx->pool_maps;
+    spsmx->pool_maps = map;
+    spsmx->own_pool = map;
+  }
+  ddsrt_atomic_inc32 (&map->refc);
+  ddsrt_mutex_unlock (&spsmx->lock);
+  return map;
+}
+
+static void shm_pool_map_unref (struct shm_pool_map *map)
+{
+  // the list holds a reference, so it never drops to 0 here
+  ddsrt_atomic_dec32 (&map->refc);
+}
+
+static void shm_unref_chunk_by_ref (struct shm_psmx *spsmx, uint64_t pool_id, uint64_t offset)
+{
+  struct shm_pool_map *map;
+  struct shm_chunk *chunk;
+  if ((map = shm_pool_map_ref (spsmx, pool_id)) == NULL)
+    return;
+  if ((chunk = shm_pool_map_chunk (map, offset)) != NULL)
+    shm_chunk_unref (map, chunk);
+  shm_pool_map_unref (map);
+}
+
+/* Channels and reader slots */
+
+struct shm_channel_init_arg {
+  uint32_t max_readers;
+  uint32_t capacity;
+};
+
+static size_t shm_align (size_t x, size_t a)
+{
+  return (x + a - 1) & ~(a - 1);
+}
+
+static void shm_channel_sizes (uint32_t max_readers, uint32_t capacity, uint32_t *slots_offset, uint32_t *slot_size, size_t *size)
+{
+  *slots_offset = (uint32_t) shm_align (sizeof (struct shm_channel_hdr), SHM_CACHE_LINE);
+  *slot_size = (uint32_t) shm_align (sizeof (struct shm_slot) + capacity * sizeof (struct shm_cell), SHM_CACHE_LINE);
+  *size = *slots_offset + (size_t) max_readers * *slot_size;
+}
+
+static void shm_channel_init (void *addr, size_t size, const void *varg)
+{
+  const struct shm_channel_init_arg *arg = varg;
+  struct shm_channel_hdr *ch = addr;
+  size_t size1;
+  (void) size;
+  ch->max_readers = arg->max_readers;
+  ch->capacity = arg->capacity;
+  shm_channel_sizes (ch->max_readers, ch->capacity, &ch->slots_offset, &ch->slot_size, &size1);
+  assert (size1 == size);
+}
+
+static struct shm_slot *shm_channel_slot (const struct shm_segment *channel, uint32_t i)
+{
+  const struct shm_channel_hdr *ch = channel->addr;
+  return (struct shm_slot *) ((char *) channel->addr + ch->slots_offset + (size_t) i * ch->slot_size);
+}
+
+static dds_return_t shm_channel_attach (struct shm_psmx *spsmx, struct shm_segment *channel, const char *type_name, const char *partition, const char *topic_name)
+{
+  const char *parts[] = { spsmx->service_name, type_name, partition, topic_name };
+  char hex[33], name[SHM_NAME_MAX];
+  shm_md5_hex (hex, parts, sizeof (parts) / sizeof (parts[0]));
+  shm_make_name (name, sizeof (name), "ch", "%s", hex);
+  // Once the channel exists, its size is fixed, and it is that of the first process to
+  // create it
+  const struct shm_channel_init_arg arg = { .max_readers = spsmx->max_readers, .capacity = spsmx->queue_capacity };
+  uint32_t slots_offset, slot_size;
+  size_t size;
+  shm_channel_sizes (arg.max_readers, arg.capacity, &slots_offset, &slot_size, &size);
+  return shm_segment_attach (channel, name, size, shm_channel_init, &arg);
+}
+
+// Bounded MPSC queue, each cell has a sequence number that tells whether it is free
+// (seq == pos), filled (seq == pos + 1) or still in use from the previous round
+static bool shm_ring_push (struct shm_slot *slot, uint32_t capacity, uint64_t pool_id, uint64_t offset)
+{
+  const uint32_t mask = capacity - 1;
+  uint32_t pos = ddsrt_atomic_ld32 (&slot->tail);
+  for (;;)
+  {
+    struct shm_cell *cell = &slot->cells[pos & mask];
+    const uint32_t seq = ddsrt_atomic_ld32 (&cell->seq);
+    ddsrt_atomic_fence_acq ();
+    const int32_t dif = (int32_t) (seq - pos);
+    if (dif == 0 && ddsrt_atomic_cas32 (&slot->tail, pos, pos + 1))
+    {
+      cell->pool_id = pool_id;
+      cell->offset = offset;
+      ddsrt_atomic_fence_rel ();
+      ddsrt_atomic_st32 (&cell->seq, pos + 1);
+      return true;
+    }
+    else if (dif < 0)
+    {
+      return false;
+    }
+    pos = ddsrt_atomic_ld32 (&slot->tail);
+  }
+}
+
+static bool shm_ring_pop (struct shm_slot *slot, uint32_t capacity, uint64_t *pool_id, uint64_t *offset)
+{
+  const uint32_t pos = ddsrt_atomic_ld32 (&slot->head);
+  struct shm_cell *cell = &slot->cells[pos & (capacity - 1)];
+  if (ddsrt_atomic_ld32 (&cell->seq) != pos + 1)
+    return false;
+  ddsrt_atomic_fence_acq ();
+  *pool_id = cell->pool_id;
+  *offset = cell->offset;
+  ddsrt_atomic_fence_rel ();
+  ddsrt_atomic_st32 (&cell->seq, pos + capacity);
+  ddsrt_atomic_st32 (&slot->head, pos + 1);
+  return true;
+}
+
+static bool shm_ring_empty (struct shm_slot *slot, uint32_t capacity)
+{
+  const uint32_t pos = ddsrt_atomic_ld32 (&slot->head);
+  return ddsrt_atomic_ld32 (&slot->cells[pos & (capacity - 1)].seq) != pos + 1;
+}
+
+static void shm_slot_close (struct shm_psmx *spsmx, const struct shm_segment *channel, struct shm_slot *slot)
+{
+  // Caller changed the state to CLOSING, so no writer will start pushing data into the
+  // queue; blocked writers need to be woken up and the ones in progress need to finish
+  const struct shm_channel_hdr *ch = channel->addr;
+  ddsrt_atomic_inc32 (&slot->space_futex);
+  shm_futex_wake (&slot->space_futex);
+  const dds_time_t tend = ddsrt_time_monotonic ().v + DDS_SECS (10);
+  while (ddsrt_atomic_ld32 (&slot->nwriters) > 0 && ddsrt_time_monotonic ().v < tend)
+    dds_sleepfor (DDS_MSECS (1));
+  uint64_t pool_id, offset;
+  while (shm_ring_pop (slot, ch->capacity, &pool_id, &offset))
+    shm_unref_chunk_by_ref (spsmx, pool_id, offset);
+  ddsrt_atomic_fence_rel ();
+  ddsrt_atomic_st32 (&slot->state, SHM_SLOT_FREE);
+}
+
+static bool shm_slot_reclaim_if_dead (struct shm_psmx *spsmx, const struct shm_segment *channel, struct shm_slot *slot)
+{
+  const uint32_t s = ddsrt_atomic_ld32 (&slot->state);
+  if (SHM_SLOT_STATE (s) != SHM_SLOT_ACTIVE || shm_user_alive (SHM_SLOT_USER (s)))
+    return false;
+  if (!ddsrt_atomic_cas32 (&slot->state, s, SHM_SLOT_MAKE (SHM_SLOT_USER (s), SHM_SLOT_CLOSING)))
+    return false;
+  shm_slot_close (spsmx, channel, slot);
+  return true;
+}
+
+static struct shm_slot *shm_slot_claim (struct shm_psmx *spsmx, const struct shm_segment *channel, bool reliable, uint32_t *state)
+{
+  const struct shm_channel_hdr *ch = channel->addr;
+  const uint32_t self = shm_self_id;
+  for (int attempt = 0; attempt < 2; attempt++)
+  {
+    for (uint32_t i = 0; i < ch->max_readers; i++)
+    {
+      struct shm_slot *slot = shm_channel_slot (channel, i);
+      if (!ddsrt_atomic_cas32 (&slot->state, SHM_SLOT_FREE, SHM_SLOT_MAKE (self, SHM_SLOT_CLAIMING)))
+        continue;
+      // nwriters, writers_waiting are balanced and the futex words need not be reset
+      ddsrt_atomic_st32 (&slot->flags, reliable ? SHM_SLOT_FLAG_RELIABLE : 0);
+      ddsrt_atomic_st32 (&slot->reader_sleeping, 0);
+      ddsrt_atomic_st32 (&slot->head, 0);
+      ddsrt_atomic_st32 (&slot->tail, 0);
+      for (uint32_t j = 0; j < ch->capacity; j++)
+        ddsrt_atomic_st32 (&slot->cells[j].seq, j);
+      ddsrt_atomic_fence_rel ();
+      *state = SHM_SLOT_MAKE (self, SHM_SLOT_ACTIVE);
+      ddsrt_atomic_st32 (&slot->state, *state);
+      return slot;
+    }
+    // all slots in use, perhaps some readers died
+    for (uint32_t i = 0; i < ch->max_readers; i++)
+      (void) shm_slot_reclaim_if_dead (spsmx, channel, shm_channel_slot (channel, i));
+  }
+  return NULL;
+}
+
+static dds_return_t shm_slot_deliver (struct shm_psmx_endpoint *sep, struct shm_slot *slot, struct shm_chunk *chunk, uint64_t pool_id, uint64_t offset)
+{
+  const struct shm_channel_hdr *ch = sep->channel.addr;
+  dds_return_t ret = DDS_RETCODE_OK;
+  bool pushed = false, reader_dead = false;
+
+  // Reader won't complete closing the slot until nwriters is 0, and this increment is a
+  // full barrier, so if the state is still active, it is safe to push
+  ddsrt_atomic_inc32 (&slot->nwriters);
+  if (SHM_SLOT_STATE (ddsrt_atomic_ld32 (&slot->state)) != SHM_SLOT_ACTIVE)
+  {
+    ddsrt_atomic_dec32 (&slot->nwriters);
+    return DDS_RETCODE_OK;
+  }
+
+  ddsrt_atomic_inc32 (&chunk->refc);
+  if (shm_ring_push (slot, ch->capacity, pool_id, offset))
+    pushed = true;
+  else if (ddsrt_atomic_ld32 (&slot->flags) & SHM_SLOT_FLAG_RELIABLE)
+  {
+    const dds_time_t tnow = ddsrt_time_monotonic ().v;
+    const dds_time_t tend = (sep->max_blocking_time >= DDS_NEVER - tnow) ? DDS_NEVER : tnow + sep->max_blocking_time;
+    ddsrt_atomic_inc32 (&slot->writers_waiting);
+    for (;;)
+    {
+      const uint32_t sv = ddsrt_atomic_ld32 (&slot->space_futex);
+      if (shm_ring_push (slot, ch->capacity, pool_id, offset))
+      {
+        pushed = true;
+        break;
+      }
+      const uint32_t s = ddsrt_atomic_ld32 (&slot->state);
+      if (SHM_SLOT_STATE (s) != SHM_SLOT_ACTIVE)
+        break;
+      if (!shm_user_alive (SHM_SLOT_USER (s)))
+      {
+        reader_dead = true;
+        break;
+      }
+      const dds_time_t now = ddsrt_time_monotonic ().v;
+      if (now >= tend)
+      {
+        ret = DDS_RETCODE_TIMEOUT;
+        break;
+      }
+      shm_futex_wait (&slot->space_futex, sv, (tend - now < DDS_MSECS (10)) ? tend - now : DDS_MSECS (10));
+    }
+    ddsrt_atomic_dec32 (&slot->writers_waiting);
+  }
+
+  if (pushed)
+  {
+    ddsrt_atomic_inc32 (&slot->data_futex);
+    if (ddsrt_atomic_ld32 (&slot->reader_sleeping))
+      shm_futex_wake (&slot->data_futex);
+  }
+  else
+  {
+    // the writer still holds a reference, this never frees the chunk
+    ddsrt_atomic_dec32 (&chunk->refc);
+  }
+  ddsrt_atomic_dec32 (&slot->nwriters);
+  if (reader_dead)
+    (void) shm_slot_reclaim_if_dead (sep->psmx, &sep->channel, slot);
+  return ret;
+}
+
+/* PSMX instance */
+
+static bool is_wildcard_partition (const char *str)
+{
+  return strchr (str, '*') || strchr (str, '?');
+}
+
+static bool shm_type_qos_supported (struct dds_psmx *psmx, dds_psmx_endpoint_type_t forwhat, dds_data_type_properties_t data_type_props, const struct dds_qos *qos)
+{
+  const struct shm_psmx *spsmx = (const struct shm_psmx *) psmx;
+  if ((data_type_props & DDS_DATA_TYPE_CONTAINS_KEY) && !spsmx->support_keyed_topics)
+    return false;
+  // Everything else is really dependent on the endpoint QoS, not the topic QoS
+  if (forwhat == DDS_PSMX_ENDPOINT_TYPE_UNSET)
+    return true;
+
+  // Writers retain nothing in shared memory, so only volatile
+  dds_durability_kind_t d_kind = DDS_DURABILITY_VOLATILE;
+  if (dds_qget_durability (qos, &d_kind) && d_kind != DDS_DURABILITY_VOLATILE)
+    return false;
+
+  uint32_t n_partitions;
+  char **partitions;
+  if (dds_qget_partition (qos, &n_partitions, &partitions))
+  {
+    bool supported = n_partitions == 0 || (n_partitions == 1 && !is_wildcard_partition (partitions[0]));
+    for (uint32_t n = 0; n < n_partitions; n++)
+      dds_free (partitions[n]);
+    if (n_partitions > 0)
+      dds_free (partitions);
+    if (!supported)
+      return false;
+  }
+
+  dds_ignorelocal_kind_t ignore_local;
+  if (dds_qget_ignorelocal (qos, &ignore_local) && ignore_local != DDS_IGNORELOCAL_NONE)
+    return false;
+  dds_liveliness_kind_t liveliness_kind;
+  if (dds_qget_liveliness (qos, &liveliness_kind, NULL) && liveliness_kind != DDS_LIVELINESS_AUTOMATIC)
+    return false;
+  dds_duration_t deadline_duration;
+  if (dds_qget_deadline (qos, &deadline_duration) && deadline_duration != DDS_INFINITY)
+    return false;
+  return true;
+}
+
+static struct dds_psmx_topic *shm_create_topic (struct dds_psmx *psmx, const char *topic_name, const char *type_name, dds_data_type_properties_t data_type_props, const struct ddsi_type *type_definition, uint32_t sizeof_type)
+{
+  (void) psmx; (void) data_type_props; (void) type_definition; (void) sizeof_type;
+  struct shm_psmx_topic *stp = ddsrt_malloc (sizeof (*stp));
+  memset (stp, 0, sizeof (*stp));
+  stp->c.ops = psmx_topic_ops;
+  stp->topic_name = ddsrt_strdup (topic_name);
+  stp->type_name = ddsrt_strdup (type_name);
+  return &stp->c;
+}
+
+static dds_return_t shm_delete_topic (struct dds_psmx_topic *psmx_topic)
+{
+  struct shm_psmx_topic *stp = (struct shm_psmx_topic *) psmx_topic;
+  ddsrt_free (stp->topic_name);
+  ddsrt_free (stp->type_name);
+  ddsrt_free (stp);
+  return DDS_RETCODE_OK;
+}
+
+static void shm_delete_psmx (struct dds_psmx *psmx)
+{
+  struct shm_psmx *spsmx = (struct shm_psmx *) psmx;
+  // all endpoints and loans are gone by now
+  while (spsmx->pool_maps)
+  {
+    struct shm_pool_map *map = spsmx->pool_maps;
+    spsmx->pool_maps = map->next;
+    shm_pool_map_free (map);
+  }
+  if (spsmx->have_node)
+    shm_segment_detach (&spsmx->node);
+  ddsrt_mutex_destroy (&spsmx->lock);
+  ddsrt_free (spsmx->service_name);
+  ddsrt_free (spsmx);
+  shm_self_unref ();
+}
+
+static void shm_node_init (void *addr, size_t size, const void *arg)
+{
+  struct shm_node_hdr *node = addr;
+  (void) size; (void) arg;
+  for (size_t i = 0; i < sizeof (node->node_id.x); i += 4)
+  {
+    const uint32_t r = ddsrt_random ();
+    memcpy (node->node_id.x + i, &r, sizeof (r));
+  }
+}
+
+static dds_psmx_node_identifier_t shm_get_node_id (const struct dds_psmx *psmx)
+{
+  // All processes using the same instance name share a randomly generated node id,
+  // which remains in existence as long as any of them still uses it
+  struct shm_psmx *spsmx = (struct shm_psmx *) psmx;
+  dds_psmx_node_identifier_t node_id;
+  memset (&node_id, 0, sizeof (node_id));
+  ddsrt_mutex_lock (&spsmx->lock);
+  if (!spsmx->have_node)
+  {
+    const char *parts[] = { spsmx->service_name };
+    char hex[33], name[SHM_NAME_MAX];
+    shm_md5_hex (hex, parts, 1);
+    shm_make_name (name, sizeof (name), "node", "%s", hex);
+    if (shm_segment_attach (&spsmx->node, name, sizeof (struct shm_node_hdr), shm_node_init, NULL) == DDS_RETCODE_OK)
+      spsmx->have_node = true;
+  }
+  if (spsmx->have_node)
+    node_id = ((const struct shm_node_hdr *) spsmx->node.addr)->node_id;
+  ddsrt_mutex_unlock (&spsmx->lock);
+  return node_id;
+}
+
+static dds_psmx_features_t shm_supported_features (const struct dds_psmx *psmx)
+{
+  (void) psmx;
+  return DDS_PSMX_FEATURE_SHARED_MEMORY | DDS_PSMX_FEATURE_ZERO_COPY;
+}
+
+/* Endpoints */
+
+static struct dds_psmx_endpoint *shm_create_endpoint (struct dds_psmx_topic *psmx_topic, const struct dds_qos *qos, dds_psmx_endpoint_type_t endpoint_type)
+{
+  struct shm_psmx_topic *stp = (struct shm_psmx_topic *) psmx_topic;
+  struct shm_psmx *spsmx = (struct shm_psmx *) psmx_topic->psmx_instance;
+  if (endpoint_type != DDS_PSMX_ENDPOINT_TYPE_READER && endpoint_type != DDS_PSMX_ENDPOINT_TYPE_WRITER)
+    return NULL;
+
+  char *partition = NULL;
+  uint32_t n_partitions;
+  char **partitions;
+  if (dds_qget_partition (qos, &n_partitions, &partitions))
+  {
+    assert (n_partitions <= 1);
+    if (n_partitions == 1)
+      partition = partitions[0];
+    if (n_partitions > 0)
+      dds_free (partitions);
+  }
+
+  struct shm_psmx_endpoint *sep = ddsrt_malloc (sizeof (*sep));
+  memset (sep, 0, sizeof (*sep));
+  sep->c.ops = psmx_ep_ops;
+  sep->psmx = spsmx;
+  sep->endpoint_type = endpoint_type;
+  dds_return_t ret = shm_channel_attach (spsmx, &sep->channel, stp->type_name, partition ? partition : "", stp->topic_name);
+  dds_free (partition);
+  if (ret != DDS_RETCODE_OK)
+  {
+    ddsrt_free (sep);
+    return NULL;
+  }
+
+  dds_reliability_kind_t reliability_kind = DDS_RELIABILITY_BEST_EFFORT;
+  sep->max_blocking_time = 0;
+  (void) dds_qget_reliability (qos, &reliability_kind, &sep->max_blocking_time);
+  if (endpoint_type == DDS_PSMX_ENDPOINT_TYPE_READER)
+  {
+    if ((sep->slot = shm_slot_claim (spsmx, &sep->channel, reliability_kind == DDS_RELIABILITY_RELIABLE, &sep->slot_state)) == NULL)
+    {
+      shm_segment_detach (&sep->channel);
+      ddsrt_free (sep);
+      return NULL;
+    }
+    ddsrt_mutex_init (&sep->lock);
+    ddsrt_atomic_st32 (&sep->terminate, 0);
+  }
+  return &sep->c;
+}
+
+static dds_return_t shm_delete_endpoint (struct dds_psmx_endpoint *psmx_endpoint)
+{
+  struct shm_psmx_endpoint *sep = (struct shm_psmx_endpoint *) psmx_endpoint;
+  if (sep->endpoint_type == DDS_PSMX_ENDPOINT_TYPE_READER)
+  {
+    if (sep->thread_running)
+    {
+      ddsrt_atomic_st32 (&sep->terminate, 1);
+      ddsrt_atomic_inc32 (&sep->slot->data_futex);
+      shm_futex_wake (&sep->slot->data_futex);
+      (void) ddsrt_thread_join (sep->tid, NULL);
+    }
+    if (ddsrt_atomic_cas32 (&sep->slot->state, sep->slot_state, SHM_SLOT_MAKE (SHM_SLOT_USER (sep->slot_state), SHM_SLOT_CLOSING)))
+      shm_slot_close (sep->psmx, &sep->channel, sep->slot);
+    ddsrt_mutex_destroy (&sep->lock);
+  }
+  shm_segment_detach (&sep->channel);
+  ddsrt_free (sep);
+  return DDS_RETCODE_OK;
+}
+
+static dds_loaned_sample_t *shm_ep_request_loan (struct dds_psmx_endpoint *psmx_endpoint, uint32_t size_requested)
+{
+  struct shm_psmx_endpoint *sep = (struct shm_psmx_endpoint *) psmx_endpoint;
+  if (sep->endpoint_type != DDS_PSMX_ENDPOINT_TYPE_WRITER)
+    return NULL;
+  struct shm_pool_map *map;
+  struct shm_chunk *chunk;
+  if ((map = shm_own_pool_ref (sep->psmx)) == NULL)
+    return NULL;
+  if ((chunk = shm_pool_alloc (map, size_requested)) == NULL)
+    chunk = shm_pool_alloc_wait (map, size_requested, sep->max_blocking_time);
+  if (chunk == NULL)
+  {
+    shm_pool_map_unref (map);
+    return NULL;
+  }
+  struct shm_loan *loan = ddsrt_malloc (sizeof (*loan));
+  loan->c.ops = ls_ops;
+  loan->c.metadata = &chunk->metadata;
+  loan->c.sample_ptr = (char *) chunk + SHM_CHUNK_HDR_SIZE;
+  loan->map = map;
+  loan->chunk = chunk;
+  memset (&chunk->metadata, 0, sizeof (chunk->metadata));
+  return &loan->c;
+}
+
+static dds_return_t shm_ep_write_with_key (struct dds_psmx_endpoint *psmx_endpoint, dds_loaned_sample_t *data, size_t keysz, const void *key)
+{
+  (void) keysz; (void) key;
+  struct shm_psmx_endpoint *sep = (struct shm_psmx_endpoint *) psmx_endpoint;
+  struct shm_loan *loan = (struct shm_loan *) data;
+  if (loan->chunk == NULL || loan->c.ops.free != shm_loaned_sample_free || !loan->map->own)
+    return DDS_RETCODE_BAD_PARAMETER;
+
+  const struct shm_channel_hdr *ch = sep->channel.addr;
+  const uint64_t offset = (uint64_t) ((char *) loan->chunk - (char *) loan->map->seg.addr);
+  dds_return_t ret = DDS_RETCODE_OK;
+  for (uint32_t i = 0; i < ch->max_readers; i++)
+  {
+    struct shm_slot *slot = shm_channel_slot (&sep->channel, i);
+    if (SHM_SLOT_STATE (ddsrt_atomic_ld32 (&slot->state)) != SHM_SLOT_ACTIVE)
+      continue;
+    dds_return_t ret1 = shm_slot_deliver (sep, slot, loan->chunk, loan->map->id, offset);
+    if (ret1 != DDS_RETCODE_OK && ret == DDS_RETCODE_OK)
+      ret = ret1;
+  }
+
+  // The sample now belongs to the readers, drop the writer's reference
+  shm_chunk_unref (loan->map, loan->chunk);
+  loan->chunk = NULL;
+  loan->c.metadata = NULL;
+  loan->c.sample_ptr = NULL;
+  return ret;
+}
+
+static dds_loaned_sample_t *shm_ep_take_locked (struct shm_psmx_endpoint *sep)
+{
+  const struct shm_channel_hdr *ch = sep->channel.addr;
+  struct shm_slot * const slot = sep->slot;
+  uint64_t pool_id, offset;
+  while (shm_ring_pop (slot, ch->capacity, &pool_id, &offset))
+  {
+    ddsrt_atomic_fence ();
+    if (ddsrt_atomic_ld32 (&slot->writers_waiting))
+    {
+      ddsrt_atomic_inc32 (&slot->space_futex);
+      shm_futex_wake (&slot->space_futex);
+    }
+
+    struct shm_pool_map *map;
+    struct shm_chunk *chunk;
+    if ((map = shm_pool_map_ref (sep->psmx, pool_id)) == NULL)
+      continue;
+    if ((chunk = shm_pool_map_chunk (map, offset)) == NULL)
+    {
+      shm_pool_map_unref (map);
+      continue;
+    }
+    struct shm_loan *loan = ddsrt_malloc (sizeof (*loan));
+    loan->c.ops = ls_ops;
+    loan->c.loan_origin.origin_kind = DDS_LOAN_ORIGIN_KIND_PSMX;
+    loan->c.loan_origin.psmx_endpoint = &sep->c;
+    loan->c.metadata = &chunk->metadata;
+    loan->c.sample_ptr = (char *) chunk + SHM_CHUNK_HDR_SIZE;
+    ddsrt_atomic_st32 (&loan->c.refc, 1);
+    loan->map = map;
+    loan->chunk = chunk;
+    return &loan->c;
+  }
+  return NULL;
+}
+
+static dds_loaned_sample_t *shm_ep_take (struct dds_psmx_endpoint *psmx_endpoint)
+{
+  struct shm_psmx_endpoint *sep = (struct shm_psmx_endpoint *) psmx_endpoint;
+  if (sep->endpoint_type != DDS_PSMX_ENDPOINT_TYPE_READER)
+    return NULL;
+  ddsrt_mutex_lock (&sep->lock);
+  dds_loaned_sample_t *ls = shm_ep_take_locked (sep);
+  ddsrt_mutex_unlock (&sep->lock);
+  return ls;
+}
+
+static uint32_t shm_reader_thread (void *varg)
+{
+  struct shm_psmx_endpoint *sep = varg;
+  const struct shm_channel_hdr *ch = sep->channel.addr;
+  struct shm_slot * const slot = sep->slot;
+  while (!ddsrt_atomic_ld32 (&sep->terminate))
+  {
+    const uint32_t fv = ddsrt_atomic_ld32 (&slot->data_futex);
+    dds_loaned_sample_t *ls;
+    while ((ls = shm_ep_take (&sep->c)) != NULL)
+    {
+      (void) dds_reader_store_loaned_sample (sep->reader, ls);
+      dds_loaned_sample_unref (ls);
+    }
+    // Writers check reader_sleeping after publishing data and incrementing the futex
+    // word, so either they wake us or we notice the data
+    ddsrt_atomic_st32 (&slot->reader_sleeping, 1);
+    ddsrt_atomic_fence ();
+    if (shm_ring_empty (slot, ch->capacity) && !ddsrt_atomic_ld32 (&sep->terminate))
+      shm_futex_wait (&slot->data_futex, fv, DDS_MSECS (100));
+    ddsrt_atomic_st32 (&slot->reader_sleeping, 0);
+  }
+  return 0;
+}
+
+static dds_return_t shm_ep_on_data_available (struct dds_psmx_endpoint *psmx_endpoint, dds_entity_t reader)
+{
+  struct shm_psmx_endpoint *sep = (struct shm_psmx_endpoint *) psmx_endpoint;
+  if (sep->endpoint_type != DDS_PSMX_ENDPOINT_TYPE_READER)
+    return DDS_RETCODE_BAD_PARAMETER;
+  if (sep->thread_running)
+    return DDS_RETCODE_PRECONDITION_NOT_MET;
+  sep->reader = reader;
+  ddsrt_threadattr_t tattr;
+  ddsrt_threadattr_init (&tattr);
+  if (ddsrt_thread_create (&sep->tid, "shm_psmx_rd", &tattr, shm_reader_thread, sep) != DDS_RETCODE_OK)
+    return DDS_RETCODE_ERROR;
+  sep->thread_running = true;
+  return DDS_RETCODE_OK;
+}
+
+static void shm_loaned_sample_free (struct dds_loaned_sample *loaned_sample)
+{
+  struct shm_loan *loan = (struct shm_loan *) loaned_sample;
+  if (loan->chunk)
+    shm_chunk_unref (loan->map, loan->chunk);
+  shm_pool_map_unref (loan->map);
+  ddsrt_free (loan);
+}
+
+/* Construction */
+
+static dds_return_t get_bool_option (const char *config, const char *name, bool *value)
+{
+  char *str = dds_psmx_get_config_option_value (config, name);
+  dds_return_t ret = DDS_RETCODE_OK;
+  if (str == NULL)
+    return DDS_RETCODE_OK;
+  if (strcmp (str, "true") == 0)
+    *value = true;
+  else if (strcmp (str, "false") == 0)
+    *value = false;
+  else
+  {
+    fprintf (stderr, ERROR_PREFIX "invalid value for %s\n", name);
+    ret = DDS_RETCODE_BAD_PARAMETER;
+  }
+  ddsrt_free (str);
+  return ret;
+}
+
+static dds_return_t get_uint64_option (const char *config, const char *name, uint64_t min, uint64_t max, bool allow_suffix, uint64_t *value)
+{
+  char *str = dds_psmx_get_config_option_value (config, name);
+  dds_return_t ret = DDS_RETCODE_OK;
+  if (str == NULL)
+    return DDS_RETCODE_OK;
+  unsigned long long v;
+  char *endp;
+  if (ddsrt_strtoull (str, &endp, 0, &v) != DDS_RETCODE_OK || endp == str)
+    ret = DDS_RETCODE_BAD_PARAMETER;
+  else
+  {
+    unsigned shift = 0;
+    if (allow_suffix && *endp)
+    {
+      switch (*endp++)
+      {
+        case 'k': case 'K': shift = 10; break;
+        case 'm': case 'M': shift = 20; break;
+        case 'g': case 'G': shift = 30; break;
+        default: ret = DDS_RETCODE_BAD_PARAMETER; break;
+      }
+    }
+    if (*endp != 0 || v > (max >> shift) || (v << shift) < min)
+      ret = DDS_RETCODE_BAD_PARAMETER;
+    else
+      *value = (uint64_t) v << shift;
+  }
+  if (ret != DDS_RETCODE_OK)
+    fprintf (stderr, ERROR_PREFIX "invalid value for %s\n", name);
+  ddsrt_free (str);
+  return ret;
+}
+
+dds_return_t shm_create_psmx (struct dds_psmx **psmx, dds_psmx_instance_id_t instance_id, const char *config)
+{
+  (void) instance_id;
+  assert (psmx);
+
+  bool keyed_topics = true;
+  uint64_t pool_size = SHM_DEFAULT_POOL_SIZE;
+  uint64_t queue_capacity = SHM_DEFAULT_QUEUE_CAPACITY;
+  uint64_t max_readers = SHM_DEFAULT_MAX_READERS;
+  if (get_bool_option (config, "KEYED_TOPICS", &keyed_topics) != DDS_RETCODE_OK ||
+      get_uint64_option (config, "POOL_SIZE", SHM_MIN_POOL_SIZE, (uint64_t) SIZE_MAX / 2, true, &pool_size) != DDS_RETCODE_OK ||
+      get_uint64_option (config, "QUEUE_CAPACITY", 1, SHM_MAX_QUEUE_CAPACITY, false, &queue_capacity) != DDS_RETCODE_OK ||
+      get_uint64_option (config, "MAX_READERS", 1, SHM_MAX_MAX_READERS, false, &max_readers) != DDS_RETCODE_OK)
+    return DDS_RETCODE_BAD_PARAMETER;
+
+  // Channels are scoped by the service name if given, else by the instance name
+  char *service_name = dds_psmx_get_config_option_value (config, "SERVICE_NAME");
+  if (service_name == NULL && (service_name = dds_psmx_get_config_option_value (config, "INSTANCE_NAME")) == NULL)
+    return DDS_RETCODE_BAD_PARAMETER;
+  if (shm_self_ref () != DDS_RETCODE_OK)
+  {
+    ddsrt_free (service_name);
+    return DDS_RETCODE_ERROR;
+  }
+
+  shm_pool_remove_stale ();
+
+  struct shm_psmx *spsmx = ddsrt_malloc (sizeof (*spsmx));
+  memset (spsmx, 0, sizeof (*spsmx));
+  spsmx->c.ops = psmx_instance_ops;
+  spsmx->service_name = service_name;
+  spsmx->support_keyed_topics = keyed_topics;
+  spsmx->pool_size = pool_size;
+  spsmx->queue_capacity = 1;
+  while (spsmx->queue_capacity < queue_capacity)
+    spsmx->queue_capacity *= 2;
+  spsmx->max_readers = (uint32_t) max_readers;
+  ddsrt_mutex_init (&spsmx->lock);
+  *psmx = &spsmx->c;
+  return DDS_RETCODE_OK;
+}
@@ -10,10 +10,12 @@
 
 #include <assert.h>
 #include <stddef.h>
+#include <string.h>
 
 #include "dds/ddsrt/heap.h"
 #include "dds/ddsrt/types.h"
 #include "dds/ddsrt/static_assert.h"
+#include "dds/ddsrt/sync.h"
 #include "dds/security/openssl_support.h"
 #include "crypto_defs.h"
 #include "crypto_utils.h"
@@ -54,25 +56,105 @@ static bool trusted_check_buffer_sizes (const size_t num, const trusted_crypto_d
 }
 #endif
 
-bool crypto_cipher_encrypt_data (const crypto_session_key_t *session_key, uint32_t key_size, const struct init_vector *iv, const size_t num_inp, const trusted_crypto_data_t *inpdata, trusted_crypto_data_t *outpdata, crypto_hmac_t *tag, DDS_Security_SecurityException *ex)
+static const EVP_CIPHER *get_cipher (uint32_t key_size)
+{
+  assert (key_size == 128 || key_size == 256);
+  return (key_size != 256) ? EVP_aes_128_gcm () : EVP_aes_256_gcm ();
+}
+
+static bool set_key (EVP_CIPHER_CTX *ctx, bool encrypt, const crypto_session_key_t *key, uint32_t key_size, DDS_Security_SecurityException *ex)
+{
+  if (encrypt)
+  {
+    if (!EVP_EncryptInit_ex (ctx, get_cipher (key_size), NULL, key->data, NULL))
+      SSLERROR (fail, "EVP_EncryptInit_ex to set aes_128_gcm/aes_256_gcm and key");
+  }
+  else
+  {
+    if (!EVP_DecryptInit_ex (ctx, get_cipher (key_size), NULL, key->data, NULL))
+      SSLERROR (fail, "EVP_DecryptInit_ex to set aes_128_gcm/aes_256_gcm and key");
+  }
+  return true;
+fail:
+  return false;
+}
+
+static EVP_CIPHER_CTX *new_keyed_context (bool encrypt, const crypto_session_key_t *key, uint32_t key_size, DDS_Security_SecurityException *ex)
+{
+  EVP_CIPHER_CTX *ctx;
+  if ((ctx = EVP_CIPHER_CTX_new ()) == NULL)
+    SSLERROR (fail_context_new, "EVP_CIPHER_CTX_new");
+  if (!set_key (ctx, encrypt, key, key_size, ex))
+  {
+    EVP_CIPHER_CTX_free (ctx);
+    return NULL;
+  }
+  return ctx;
+fail_context_new:
+  return NULL;
+}
+
+void crypto_cipher_context_init (crypto_cipher_context *cc)
+{
+  ddsrt_mutex_init (&cc->lock);
+  cc->ctx = NULL;
+  cc->key_size = 0;
+  memset (cc->key.data, 0, sizeof (cc->key.data));
+}
+
+void crypto_cipher_context_fini (crypto_cipher_context *cc)
+{
+  if (cc->ctx)
+    EVP_CIPHER_CTX_free (cc->ctx);
+  memset (cc->key.data, 0, sizeof (cc->key.data));
+  ddsrt_mutex_destroy (&cc->lock);
+}
+
+void crypto_derived_key_context_init (crypto_derived_key_context *dc)
+{
+  crypto_cipher_context_init (&dc->cipher);
+  dc->session_id = 0;
+  dc->transformation_kind = CRYPTO_TRANSFORMATION_KIND_INVALID;
+  memset (dc->master_salt, 0, sizeof (dc->master_salt));
+  memset (dc->master_key, 0, sizeof (dc->master_key));
+}
+
+void crypto_derived_key_context_fini (crypto_derived_key_context *dc)
+{
+  memset (dc->master_salt, 0, sizeof (dc->master_salt));
+  memset (dc->master_key, 0, sizeof (dc->master_key));
+  crypto_cipher_context_fini (&dc->cipher);
+}
+
+static bool cipher_context_set_key_locked (crypto_cipher_context *cc, bool encrypt, const crypto_session_key_t *key, uint32_t key_size, DDS_Security_SecurityException *ex)
+{
+  if (cc->key_size == key_size && memcmp (cc->key.data, key->data, key_size / 8) == 0)
+    return true;
+  if (cc->ctx == NULL && (cc->ctx = EVP_CIPHER_CTX_new ()) == NULL)
+    SSLERROR (fail, "EVP_CIPHER_CTX_new");
+  if (!set_key (cc->ctx, encrypt, key, key_size, ex))
+    goto fail;
+  cc->key_size = key_size;
+  memcpy (cc->key.data, key->data, key_size / 8);
+  return true;
+fail:
+  cc->key_size = 0;
+  return false;
+}
+
+/* The cipher, key and key schedule are retained in the context when only the
+   IV is set, for GCM that also resets the counter, the AAD and the tag */
+static bool encrypt_with_context (EVP_CIPHER_CTX *ctx, const struct init_vector *iv, const size_t num_inp, const trusted_crypto_data_t *inpdata, trusted_crypto_data_t *outpdata, crypto_hmac_t *tag, DDS_Security_SecurityException *ex)
 {
-  assert (session_key);
   assert (iv);
   assert (num_inp > 0);
   assert (inpdata);
-  assert (key_size == 128 || key_size == 256);
   assert (trusted_check_buffer_sizes (num_inp, inpdata, outpdata));
 
-  EVP_CIPHER const * const evp = (key_size != 256) ? EVP_aes_128_gcm () : EVP_aes_256_gcm ();
-  EVP_CIPHER_CTX *ctx;
   unsigned char *ptr = outpdata ? outpdata->x.base : NULL;
 
-  if ((ctx = EVP_CIPHER_CTX_new ()) == NULL)
-    SSLERROR (fail_context_new, "EVP_CIPHER_CTX_new");
-  if (!EVP_EncryptInit_ex (ctx, evp, NULL, NULL, NULL))
-    SSLERROR (fail_encrypt, "EVP_EncryptInit_ex to set aes_128_gcm/aes_256_gcm");
-  if (!EVP_EncryptInit_ex (ctx, NULL, NULL, session_key->data, iv->u))
-    SSLERROR (fail_encrypt, "EVP_EncryptInit_ex to set key and IV");
+  if (!EVP_EncryptInit_ex (ctx, NULL, NULL, NULL, iv->u))
+    SSLERROR (fail_encrypt, "EVP_EncryptInit_ex to set IV");
 
   for (size_t i = 0; i < num_inp; i++)
   {
@@ -104,46 +186,23 @@ bool crypto_cipher_encrypt_data (const crypto_session_key_t *session_key, uint32
   /* get the tag */
   if (!EVP_CIPHER_CTX_ctrl (ctx, EVP_CTRL_GCM_GET_TAG, CRYPTO_HMAC_SIZE, tag->data))
     SSLERROR (fail_encrypt, "EVP_CIPHER_CTX_ctrl to get the tag");
-
-  EVP_CIPHER_CTX_free (ctx);
   return true;
 
 fail_encrypt:
-  EVP_CIPHER_CTX_free (ctx);
-fail_context_new:
   return false;
 }
 
-bool crypto_cipher_calc_hmac (const crypto_session_key_t *session_key, uint32_t key_size, const struct init_vector *iv, const tainted_crypto_data_t *inpdata, crypto_hmac_t *tag, DDS_Security_SecurityException *ex)
+static bool decrypt_with_context (EVP_CIPHER_CTX *ctx, const struct init_vector *iv, const size_t num_inp, const const_tainted_crypto_data_t *inpdata, tainted_crypto_data_t *outpdata, crypto_hmac_t *tag, DDS_Security_SecurityException *ex)
 {
-  const trusted_crypto_data_t inpdata_wrapper = { *inpdata };
-  if (inpdata_wrapper.x.length > INT_MAX)
-  {
-    DDS_Security_Exception_set (ex, DDS_CRYPTO_PLUGIN_CONTEXT, DDS_SECURITY_ERR_CIPHER_ERROR, 0, "oversize data fragment");
-    return false;
-  }
-  return crypto_cipher_encrypt_data (session_key, key_size, iv, 1, &inpdata_wrapper, NULL, tag, ex);
-}
-
-bool crypto_cipher_decrypt_data (const remote_session_info *session, const struct init_vector *iv, const size_t num_inp, const const_tainted_crypto_data_t *inpdata, tainted_crypto_data_t *outpdata, crypto_hmac_t *tag, DDS_Security_SecurityException *ex)
-{
-  assert (session);
   assert (iv);
   assert (num_inp > 0);
   assert (inpdata);
-  assert (session->key_size == 128 || session->key_size == 256);
   assert (check_buffer_sizes (num_inp, inpdata, outpdata));
 
-  EVP_CIPHER const * const evp = (session->key_size != 256) ? EVP_aes_128_gcm () : EVP_aes_256_gcm ();
   unsigned char *ptr = outpdata ? outpdata->base : NULL;
-  EVP_CIPHER_CTX *ctx;
 
-  if ((ctx = EVP_CIPHER_CTX_new ()) == NULL)
-    SSLERROR (fail_context_new, "EVP_CIPHER_CTX_new");
-  if (!EVP_DecryptInit_ex (ctx, evp, NULL, NULL, NULL))
-    SSLERROR (fail_decrypt, "EVP_DecryptInit_ex to set aes_128_gcm/aes_256_gcm");
-  if (!EVP_DecryptInit_ex (ctx, NULL, NULL, session->key.data, iv->u))
-    SSLERROR (fail_decrypt, "EVP_DecryptInit_ex to set key and IV");
+  if (!EVP_DecryptInit_ex (ctx, NULL, NULL, NULL, iv->u))
+    SSLERROR (fail_decrypt, "EVP_DecryptInit_ex to set IV");
 
   /* Set expected tag value. */
   if (!EVP_CIPHER_CTX_ctrl (ctx, EVP_CTRL_GCM_SET_TAG, CRYPTO_HMAC_SIZE, tag->data))
@@ -180,12 +239,155 @@ bool crypto_cipher_decrypt_data (const remote_session_info *session, const struc
     if (!EVP_DecryptFinal_ex (ctx, temp, &len))
       SSLERROR (fail_decrypt, "EVP_EncryptFinal_ex to finalize signature check");
   }
-
-  EVP_CIPHER_CTX_free(ctx);
   return true;
 
 fail_decrypt:
-  EVP_CIPHER_CTX_free(ctx);
-fail_context_new:
   return false;
 }
+
+bool crypto_cipher_encrypt_data (const crypto_session_key_t *session_key, uint32_t key_size, const struct init_vector *iv, const size_t num_inp, const trusted_crypto_data_t *inpdata, trusted_crypto_data_t *outpdata, crypto_hmac_t *tag, DDS_Security_SecurityException *ex)
+{
+  assert (session_key);
+  EVP_CIPHER_CTX *ctx;
+  if ((ctx = new_keyed_context (true, session_key, key_size, ex)) == NULL)
+    return false;
+  const bool result = encrypt_with_context (ctx, iv, num_inp, inpdata, outpdata, tag, ex);
+  EVP_CIPHER_CTX_free (ctx);
+  return result;
+}
+
+bool crypto_cipher_encrypt_session_batch (session_key_material *session, size_t num_jobs, const crypto_cipher_job_t *jobs, DDS_Security_SecurityException *ex)
+{
+  crypto_cipher_context * const cc = &session->cipher;
+  EVP_CIPHER_CTX *ctx;
+  bool cached, result = true;
+
+  if ((cached = ddsrt_mutex_trylock (&cc->lock)))
+  {
+    if (!cipher_context_set_key_locked (cc, true, &session->key, session->key_size, ex))
+    {
+      ddsrt_mutex_unlock (&cc->lock);
+      return false;
+    }
+    ctx = cc->ctx;
+  }
+  else if ((ctx = new_keyed_context (true, &session->key, session->key_size, ex)) == NULL)
+  {
+    return false;
+  }
+
+  for (size_t i = 0; i < num_jobs && result; i++)
+    result = encrypt_with_context (ctx, jobs[i].iv, jobs[i].num_inp, jobs[i].inpdata, jobs[i].outpdata, jobs[i].tag, ex);
+
+  if (!cached)
+    EVP_CIPHER_CTX_free (ctx);
+  else
+  {
+    /* don't trust the state of a context after an error */
+    if (!result)
+      cc->key_size = 0;
+    ddsrt_mutex_unlock (&cc->lock);
+  }
+  return result;
+}
+
+bool crypto_cipher_encrypt_session (session_key_material *session, const struct init_vector *iv, const size_t num_inp, const trusted_crypto_data_t *inpdata, trusted_crypto_data_t *outpdata, crypto_hmac_t *tag, DDS_Security_SecurityException *ex)
+{
+  const crypto_cipher_job_t job = {
+    .iv = iv, .num_inp = num_inp, .inpdata = inpdata, .outpdata = outpdata, .tag = tag
+  };
+  return crypto_cipher_encrypt_session_batch (session, 1, &job, ex);
+}
+
+bool crypto_cipher_decrypt_data (const remote_session_info *session, const struct init_vector *iv, const size_t num_inp, const const_tainted_crypto_data_t *inpdata, tainted_crypto_data_t *outpdata, crypto_hmac_t *tag, DDS_Security_SecurityException *ex)
+{
+  assert (session);
+  EVP_CIPHER_CTX *ctx;
+  if ((ctx = new_keyed_context (false, &session->key, session->key_size, ex)) == NULL)
+    return false;
+  const bool result = decrypt_with_context (ctx, iv, num_inp, inpdata, outpdata, tag, ex);
+  EVP_CIPHER_CTX_free (ctx);
+  return result;
+}
+
+typedef bool (*derive_key_fn_t) (crypto_session_key_t *session_key, uint32_t session_id, const unsigned char *master_salt, const unsigned char *master_key, DDS_Security_CryptoTransformKind_Enum transformation_kind, DDS_Security_SecurityException *ex);
+
+static bool derived_key_context_matches (const crypto_derived_key_context *dc, const master_key_material *keymat, const unsigned char *master_key, uint32_t session_id)
+{
+  const uint32_t key_bytes = CRYPTO_KEY_SIZE_BYTES (keymat->transformation_kind);
+  return (dc->cipher.key_size != 0 &&
+          dc->session_id == session_id &&
+          dc->transformation_kind == keymat->transformation_kind &&
+          memcmp (dc->master_salt, keymat->master_salt, key_bytes) == 0 &&
+          memcmp (dc->master_key, master_key, key_bytes) == 0);
+}
+
+static bool derived_key_context_set_key_locked (crypto_derived_key_context *dc, bool encrypt, const master_key_material *keymat, const unsigned char *master_key, uint32_t session_id, derive_key_fn_t derive, DDS_Security_SecurityException *ex)
+{
+  if (derived_key_context_matches (dc, keymat, master_key, session_id))
+    return true;
+
+  const uint32_t key_bytes = CRYPTO_KEY_SIZE_BYTES (keymat->transformation_kind);
+  crypto_session_key_t key;
+  dc->cipher.key_size = 0;
+  if (!derive (&key, session_id, keymat->master_salt, master_key, keymat->transformation_kind, ex))
+    return false;
+  if (!cipher_context_set_key_locked (&dc->cipher, encrypt, &key, crypto_get_key_size (keymat->transformation_kind), ex))
+    return false;
+  dc->session_id = session_id;
+  dc->transformation_kind = keymat->transformation_kind;
+  memcpy (dc->master_salt, keymat->master_salt, key_bytes);
+  memcpy (dc->master_key, master_key, key_bytes);
+  return true;
+}
+
+bool crypto_cipher_decrypt_remote (master_key_material *keymat, uint32_t session_id, const struct init_vector *iv, const size_t num_inp, const const_tainted_crypto_data_t *inpdata, tainted_crypto_data_t *outpdata, crypto_hmac_t *tag, DDS_Security_SecurityException *ex)
+{
+  crypto_derived_key_context * const dc = &keymat->remote_session;
+
+  /* key material without keys can't be cached but checking it is left to the key derivation */
+  if (!CRYPTO_TRANSFORM_HAS_KEYS (keymat->transformation_kind) || !ddsrt_mutex_trylock (&dc->cipher.lock))
+  {
+    remote_session_info session;
+    session.key_size = crypto_get_key_size (keymat->transformation_kind);
+    session.id = session_id;
+    if (!crypto_calculate_session_key (&session.key, session_id, keymat->master_salt, keymat->master_sender_key, keymat->transformation_kind, ex))
+      return false;
+    return crypto_cipher_decrypt_data (&session, iv, num_inp, inpdata, outpdata, tag, ex);
+  }
+
+  bool result = false;
+  if (derived_key_context_set_key_locked (dc, false, keymat, keymat->master_sender_key, session_id, crypto_calculate_session_key, ex))
+  {
+    /* a tag mismatch is an expected failure, it does not affect the key schedule */
+    result = decrypt_with_context (dc->cipher.ctx, iv, num_inp, inpdata, outpdata, tag, ex);
+  }
+  ddsrt_mutex_unlock (&dc->cipher.lock);
+  return result;
+}
+
+bool crypto_cipher_calc_receiver_specific_mac (master_key_material *keymat, uint32_t session_id, const struct init_vector *iv, const crypto_hmac_t *common_mac, crypto_hmac_t *hmac, DDS_Security_SecurityException *ex)
+{
+  crypto_derived_key_context * const dc = &keymat->receiver_specific;
+  const trusted_crypto_data_t data = { {
+    .base = (unsigned char *) common_mac->data,
+    .length = CRYPTO_HMAC_SIZE
+  } };
+
+  if (!CRYPTO_TRANSFORM_HAS_KEYS (keymat->transformation_kind) || !ddsrt_mutex_trylock (&dc->cipher.lock))
+  {
+    crypto_session_key_t key;
+    if (!crypto_calculate_receiver_specific_key (&key, session_id, keymat->master_salt, keymat->master_receiver_specific_key, keymat->transformation_kind, ex))
+      return false;
+    return crypto_cipher_encrypt_data (&key, crypto_get_key_size (keymat->transformation_kind), iv, 1, &data, NULL, hmac, ex);
+  }
+
+  bool result = false;
+  if (derived_key_context_set_key_locked (dc, true, keymat, keymat->master_receiver_specific_key, session_id, crypto_calculate_receiver_specific_key, ex))
+  {
+    if (!(result = encrypt_with_context (dc->cipher.ctx, iv, 1, &data, NULL, hmac, ex)))
+      dc->cipher.key_size = 0;
+  }
+  ddsrt_mutex_unlock (&dc->cipher.lock);
+  return result;
+}
@@ -12,8 +12,33 @@
 #define CRYPTO_CIPHER_H
 
 #include "dds/ddsrt/types.h"
+#include "dds/security/export.h"
 #include "crypto_objects.h"
 
+/**
+ * @brief A single message for @ref crypto_cipher_encrypt_session_batch
+ */
+typedef struct crypto_cipher_job
+{
+  const struct init_vector *iv;           /**< The init vector used by the encoding */
+  size_t num_inp;                         /**< The number of input data segments */
+  const trusted_crypto_data_t *inpdata;   /**< The input data segments */
+  trusted_crypto_data_t *outpdata;        /**< The output data segment (optional) */
+  crypto_hmac_t *tag;                     /**< Contains on return the mac value */
+} crypto_cipher_job_t;
+
+void crypto_cipher_context_init (crypto_cipher_context *cc)
+  ddsrt_nonnull_all;
+
+void crypto_cipher_context_fini (crypto_cipher_context *cc)
+  ddsrt_nonnull_all;
+
+void crypto_derived_key_context_init (crypto_derived_key_context *dc)
+  ddsrt_nonnull_all;
+
+void crypto_derived_key_context_fini (crypto_derived_key_context *dc)
+  ddsrt_nonnull_all;
+
 /**
  * @brief Encodes the provide data using the provided key
  *
@@ -44,8 +69,38 @@
 bool crypto_cipher_encrypt_data(const crypto_session_key_t *session_key, uint32_t key_size, const struct init_vector *iv, const size_t num_inp, const trusted_crypto_data_t *inpdata, trusted_crypto_data_t *outpdata, crypto_hmac_t *tag, DDS_Security_SecurityException *ex)
   ddsrt_nonnull((1, 3, 5, 7, 8)) ddsrt_attribute_warn_unused_result;
 
-bool crypto_cipher_calc_hmac (const crypto_session_key_t *session_key, uint32_t key_size, const struct init_vector *iv, const tainted_crypto_data_t *inpdata, crypto_hmac_t *tag, DDS_Security_SecurityException *ex)
-  ddsrt_nonnull((1, 3, 4, 5, 6)) ddsrt_attribute_warn_unused_result;
+/**
+ * @brief Encodes the provided data using the current key of a local session
+ *
+ * Equivalent to @ref crypto_cipher_encrypt_data with the session's key, but using
+ * the cipher context cached in the session, so that the key schedule is only
+ * computed once for each session key.
+ *
+ * @param[in,out] session       The session providing the key and the cached context
+ * @param[in]     iv            The init vector used by the encoding
+ * @param[in]     num_inp       The number of input data segments
+ * @param[in]     inpdata       The input data segments
+ * @param[in,out] outpdata      The output data segment (optional)
+ * @param[in,out] tag           Contains on return the mac value calculated over the provided data
+ * @param[in,out] ex            Security exception
+ */
+bool crypto_cipher_encrypt_session (session_key_material *session, const struct init_vector *iv, const size_t num_inp, const trusted_crypto_data_t *inpdata, trusted_crypto_data_t *outpdata, crypto_hmac_t *tag, DDS_Security_SecurityException *ex)
+  ddsrt_nonnull((1, 2, 4, 6, 7)) ddsrt_attribute_warn_unused_result;
+
+/**
+ * @brief Encodes a number of messages using the current key of a local session
+ *
+ * All messages are encoded with the same key, holding the session's cipher
+ * context for the duration, each with their own init vector.  Processing stops
+ * at the first failure.
+ *
+ * @param[in,out] session       The session providing the key and the cached context
+ * @param[in]     num_jobs      The number of messages
+ * @param[in,out] jobs          The messages
+ * @param[in,out] ex            Security exception
+ */
+SECURITY_EXPORT bool crypto_cipher_encrypt_session_batch (session_key_material *session, size_t num_jobs, const crypto_cipher_job_t *jobs, DDS_Security_SecurityException *ex)
+  ddsrt_nonnull((1, 3, 4)) ddsrt_attribute_warn_unused_result;
 
 /**
  * @brief Decodes the provided data using the session key and key_size
@@ -73,4 +128,43 @@ bool crypto_cipher_calc_hmac (const crypto_session_key_t *session_key, uint32_t
 bool crypto_cipher_decrypt_data(const remote_session_info *session, const struct init_vector *iv, const size_t num_inp, const const_tainted_crypto_data_t *inpdata, tainted_crypto_data_t *outpdata, crypto_hmac_t *tag, DDS_Security_SecurityException *ex)
   ddsrt_nonnull((1, 2, 4, 6, 7)) ddsrt_attribute_warn_unused_result;
 
+/**
+ * @brief Decodes the provided data received in a session of a remote entity
+ *
+ * Equivalent to deriving the session key from the master key material and the
+ * session id and then calling @ref crypto_cipher_decrypt_data, but the session
+ * key and the cipher context are cached in the key material for as long as the
+ * remote entity keeps using the same session.
+ *
+ * @param[in,out] keymat        The master key material of the remote entity
+ * @param[in]     session_id    The received session id
+ * @param[in]     iv            The init vector used by the decoding
+ * @param[in]     num_inp       The number of input data segments
+ * @param[in]     inpdata       The input data segments
+ * @param[in,out] outpdata      The output data segment (optional)
+ * @param[in,out] tag           The mac value which has to be verified
+ * @param[in,out] ex            Security exception
+ */
+bool crypto_cipher_decrypt_remote (master_key_material *keymat, uint32_t session_id, const struct init_vector *iv, const size_t num_inp, const const_tainted_crypto_data_t *inpdata, tainted_crypto_data_t *outpdata, crypto_hmac_t *tag, DDS_Security_SecurityException *ex)
+  ddsrt_nonnull((1, 3, 5, 7, 8)) ddsrt_attribute_warn_unused_result;
+
+/**
+ * @brief Computes a receiver-specific MAC over a common MAC
+ *
+ * The key is the receiver-specific session key derived from the master
+ * receiver-specific key in the key material and the session id.  It is cached
+ * in the key material together with the cipher context for as long as the
+ * same session is used, so that, e.g., a writer signing each message for many
+ * readers only sets the IV for each of them.
+ *
+ * @param[in,out] keymat        The key material providing the receiver-specific key
+ * @param[in]     session_id    The session id of the message
+ * @param[in]     iv            The init vector of the message
+ * @param[in]     common_mac    The common mac of the message
+ * @param[in,out] hmac          Contains on return the receiver-specific mac
+ * @param[in,out] ex            Security exception
+ */
+bool crypto_cipher_calc_receiver_specific_mac (master_key_material *keymat, uint32_t session_id, const struct init_vector *iv, const crypto_hmac_t *common_mac, crypto_hmac_t *hmac, DDS_Security_SecurityException *ex)
+  ddsrt_nonnull((1, 3, 4, 5, 6)) ddsrt_attribute_warn_unused_result;
+
 #endif /* CRYPTO_CIPHER_H */
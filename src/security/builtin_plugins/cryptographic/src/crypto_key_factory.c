@@ -1893,6 +1893,51 @@ err_no_crypto:
   return result;
 }
 
+bool
+crypto_factory_get_remote_reader_sign_key_materials(
+    const dds_security_crypto_key_factory *factory,
+    size_t n,
+    const DDS_Security_DatareaderCryptoHandle *reader_ids,
+    crypto_sign_key_material *sign_keys,
+    DDS_Security_SecurityException *ex)
+{
+  dds_security_crypto_key_factory_impl *impl = (dds_security_crypto_key_factory_impl *)factory;
+  CryptoObject **objects;
+  bool result = true;
+
+  assert(reader_ids);
+  assert(sign_keys);
+
+  objects = ddsrt_malloc(n * sizeof(*objects));
+  crypto_object_table_find_multiple(impl->crypto_objects, n, reader_ids, objects);
+  for (size_t i = 0; i < n && result; i++)
+  {
+    if (!objects[i] || !CRYPTO_OBJECT_VALID(objects[i], CRYPTO_OBJECT_KIND_REMOTE_READER_CRYPTO))
+    {
+      DDS_Security_Exception_set(ex, DDS_CRYPTO_PLUGIN_CONTEXT,
+                                 DDS_SECURITY_ERR_INVALID_CRYPTO_HANDLE_CODE, 0,
+                                 DDS_SECURITY_ERR_INVALID_CRYPTO_HANDLE_MESSAGE);
+      for (size_t k = 0; k < i; k++)
+      {
+        CRYPTO_OBJECT_RELEASE(sign_keys[k].session_key);
+        CRYPTO_OBJECT_RELEASE(sign_keys[k].key_material);
+      }
+      result = false;
+    }
+    else
+    {
+      const remote_datareader_crypto *reader_crypto = (const remote_datareader_crypto *)objects[i];
+      sign_keys[i].key_material = (master_key_material *)CRYPTO_OBJECT_KEEP(reader_crypto->writer2reader_key_material_message);
+      sign_keys[i].session_key = (session_key_material *)CRYPTO_OBJECT_KEEP(reader_crypto->writer_session);
+      sign_keys[i].protection_kind = reader_crypto->metadata_protectionKind;
+    }
+  }
+  for (size_t i = 0; i < n; i++)
+    CRYPTO_OBJECT_RELEASE(objects[i]);
+  ddsrt_free(objects);
+  return result;
+}
+
 bool
 crypto_factory_get_endpoint_relation(
     const dds_security_crypto_key_factory *factory,
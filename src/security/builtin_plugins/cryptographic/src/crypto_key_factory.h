@@ -139,6 +139,23 @@ bool crypto_factory_get_remote_reader_sign_key_material(
     DDS_Security_ProtectionKind *protection_kind,
     DDS_Security_SecurityException *ex);
 
+typedef struct crypto_sign_key_material
+{
+  master_key_material *key_material;
+  session_key_material *session_key;
+  DDS_Security_ProtectionKind protection_kind;
+} crypto_sign_key_material;
+
+/* Equivalent to crypto_factory_get_remote_reader_sign_key_material for each of
+   the readers, but holding the object table lock only once.  On success, the
+   caller must release the key material and the session of each of them. */
+bool crypto_factory_get_remote_reader_sign_key_materials(
+    const dds_security_crypto_key_factory *factory,
+    size_t n,
+    const DDS_Security_DatareaderCryptoHandle *reader_ids,
+    crypto_sign_key_material *sign_keys,
+    DDS_Security_SecurityException *ex);
+
 bool crypto_factory_get_endpoint_relation(
     const dds_security_crypto_key_factory *factory,
     DDS_Security_ParticipantCryptoHandle local_participant_handle,
@@ -14,6 +14,7 @@
 #include "dds/ddsrt/heap.h"
 #include "dds/ddsrt/hopscotch.h"
 #include "dds/ddsrt/types.h"
+#include "crypto_cipher.h"
 #include "crypto_objects.h"
 #include "crypto_utils.h"
 
@@ -228,6 +229,15 @@ CryptoObject * crypto_object_table_find(struct CryptoObjectTable *table, int64_t
   return object;
 }
 
+void crypto_object_table_find_multiple(struct CryptoObjectTable *table, size_t n, const int64_t *handles, CryptoObject **objects)
+{
+  assert (table);
+  ddsrt_mutex_lock (&table->lock);
+  for (size_t i = 0; i < n; i++)
+    objects[i] = crypto_object_keep (table->findfnc(table, &handles[i]));
+  ddsrt_mutex_unlock (&table->lock);
+}
+
 void crypto_object_table_walk(struct CryptoObjectTable *table, CryptoObjectTableCallback callback, void *arg)
 {
   struct ddsrt_hh_iter it;
@@ -254,6 +264,8 @@ static void master_key_material__free(CryptoObject *obj)
       ddsrt_free (keymat->master_sender_key);
       ddsrt_free (keymat->master_receiver_specific_key);
     }
+    crypto_derived_key_context_fini (&keymat->remote_session);
+    crypto_derived_key_context_fini (&keymat->receiver_specific);
     crypto_object_deinit ((CryptoObject *)keymat);
     memset (keymat, 0, sizeof (*keymat));
     ddsrt_free (keymat);
@@ -264,6 +276,8 @@ master_key_material * crypto_master_key_material_new(DDS_Security_CryptoTransfor
 {
   master_key_material *keymat = ddsrt_calloc (1, sizeof(*keymat));
   crypto_object_init((CryptoObject *)keymat, CRYPTO_OBJECT_KIND_KEY_MATERIAL, master_key_material__free);
+  crypto_derived_key_context_init (&keymat->remote_session);
+  crypto_derived_key_context_init (&keymat->receiver_specific);
   keymat->transformation_kind = transform_kind;
   if (CRYPTO_TRANSFORM_HAS_KEYS(transform_kind))
   {
@@ -315,6 +329,7 @@ static void session_key_material__free(CryptoObject *obj)
   {
     CHECK_CRYPTO_OBJECT_KIND(obj, CRYPTO_OBJECT_KIND_SESSION_KEY_MATERIAL);
     CRYPTO_OBJECT_RELEASE(session->master_key_material);
+    crypto_cipher_context_fini (&session->cipher);
     crypto_object_deinit((CryptoObject *)session);
     memset (session, 0, sizeof (*session));
     ddsrt_free(session);
@@ -333,6 +348,7 @@ session_key_material * crypto_session_key_material_new(master_key_material *mast
   session->max_blocks_per_session = INT64_MAX; /* FIXME: should be a config parameter */
   session->block_counter = session->max_blocks_per_session;
   session->master_key_material = CRYPTO_OBJECT_KEEP(master_key);
+  crypto_cipher_context_init (&session->cipher);
 
   return session;
 }
@@ -11,6 +11,7 @@
 #ifndef CRYPTO_OBJECTS_H
 #define CRYPTO_OBJECTS_H
 
+#include <openssl/evp.h>
 #include <openssl/rand.h>
 #include "dds/ddsrt/atomics.h"
 #include "dds/ddsrt/sync.h"
@@ -74,6 +75,33 @@ struct local_datareader_crypto;
 struct remote_datawriter_crypto;
 struct remote_datareader_crypto;
 
+/* OpenSSL cipher context that remains keyed with the session key it was last
+   used with: setting up the AES key schedule costs more than encrypting a
+   typical submessage, so for the next message with the same key only the IV
+   needs to be reset.  The data path only ever try-locks it, a thread finding
+   it in use falls back to a temporary context. */
+typedef struct crypto_cipher_context
+{
+  ddsrt_mutex_t lock;
+  EVP_CIPHER_CTX *ctx;
+  uint32_t key_size; /* 0 if ctx is not keyed */
+  crypto_session_key_t key;
+} crypto_cipher_context;
+
+/* Cipher context keyed with a session key derived from master key material:
+   the most recently received session of a remote entity for decrypting, or
+   the most recently used session for receiver-specific MACs.  The source
+   fields identify the master key the session key was derived from, so that
+   a key update implicitly invalidates it */
+typedef struct crypto_derived_key_context
+{
+  crypto_cipher_context cipher;
+  uint32_t session_id;
+  DDS_Security_CryptoTransformKind_Enum transformation_kind;
+  unsigned char master_salt[CRYPTO_KEY_SIZE_MAX];
+  unsigned char master_key[CRYPTO_KEY_SIZE_MAX];
+} crypto_derived_key_context;
+
 typedef struct master_key_material
 {
   CryptoObject _parent;
@@ -83,6 +111,8 @@ typedef struct master_key_material
   unsigned char *master_sender_key;
   uint32_t receiver_specific_key_id;
   unsigned char *master_receiver_specific_key;
+  crypto_derived_key_context remote_session;
+  crypto_derived_key_context receiver_specific;
 } master_key_material;
 
 typedef struct session_key_material
@@ -96,6 +126,7 @@ typedef struct session_key_material
   uint64_t max_blocks_per_session;
   uint64_t init_vector_suffix;
   master_key_material *master_key_material;
+  crypto_cipher_context cipher;
 } session_key_material;
 
 typedef struct remote_session_info
@@ -379,6 +410,15 @@ crypto_object_table_find(
     struct CryptoObjectTable *table,
     int64_t handle);
 
+/* Looks up a number of handles taking the table lock only once, objects[i] is
+   set to the (kept) object for handles[i] or NULL if it doesn't exist */
+void
+crypto_object_table_find_multiple(
+    struct CryptoObjectTable *table,
+    size_t n,
+    const int64_t *handles,
+    CryptoObject **objects);
+
 typedef int (*CryptoObjectTableCallback)(CryptoObject *obj, void *arg);
 
 struct CryptoObjectTable
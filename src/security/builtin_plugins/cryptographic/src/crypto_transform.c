@@ -289,13 +289,6 @@ static tainted_input_buffer_t tainted_input_buffer_from_OctetSeq (const DDS_Secu
   };
 }
 
-static bool initialize_remote_session_info (remote_session_info *info, const struct const_tainted_secure_prefix *prefix, const unsigned char *master_salt, const unsigned char *master_key, DDS_Security_CryptoTransformKind_Enum transformation_kind, DDS_Security_SecurityException *ex)
-{
-  info->key_size = crypto_get_key_size (transformation_kind);
-  info->id = prefix->session_id;
-  return crypto_calculate_session_key (&info->key, info->id, master_salt, master_key, transformation_kind, ex);
-}
-
 static bool read_submsg_header (tainted_input_buffer_t *input, uint8_t smid, ddsi_rtps_submessage_header_t *hdr, bool *bswap, tainted_input_buffer_t *submsg_view)
 {
   assert (input->ptr <= input->endp);
@@ -680,14 +673,14 @@ encode_serialized_payload(
     encrypted_data.x.base = content->data;
     encrypted_data.x.length = plain_buffer->_length;
 
-    if (!crypto_cipher_encrypt_data(&session->key, session->key_size, &prefix->iv, 1, &plain_data, &encrypted_data, &hmac, ex))
+    if (!crypto_cipher_encrypt_session(session, &prefix->iv, 1, &plain_data, &encrypted_data, &hmac, ex))
       goto fail_encrypt;
     content->length = ddsrt_toBE4u((uint32_t)encrypted_data.x.length);
   }
   else if (is_authentication_required(transform_kind))
   {
     /* the transformation_kind indicates only indicates authentication the determine HMAC */
-    if (!crypto_cipher_encrypt_data(&session->key, session->key_size, &prefix->iv, 1, &plain_data, NULL, &hmac, ex))
+    if (!crypto_cipher_encrypt_session(session, &prefix->iv, 1, &plain_data, NULL, &hmac, ex))
       goto fail_encrypt;
     unsigned char *ptr = trusted_crypto_buffer_append(&buffer,  plain_buffer->_length);
     memcpy(ptr, plain_buffer->_buffer, plain_buffer->_length);
@@ -745,34 +738,41 @@ static bool add_specific_mac_find_offsets (trusted_crypto_buffer_t *buffer, bool
   return true;
 }
 
+struct specific_mac_key {
+  master_key_material *keymat;
+  uint32_t session_id;
+};
+
+/* Appends the receiver-specific MACs for a number of receivers at once: the
+   offsets of the crypto header and footer are located only once, the buffer
+   is extended only once and each MAC is computed in place using the cipher
+   context cached in the receiver's key material */
 static bool
-add_specific_mac(
+add_specific_macs(
     trusted_crypto_buffer_t *buffer,
-    master_key_material *keymat,
-    session_key_material *session,
+    size_t n,
+    const struct specific_mac_key *keys,
     bool is_rtps,
     DDS_Security_SecurityException *ex)
 {
   size_t header_offset, footer_offset;
+  if (n == 0)
+    return true;
   if (!add_specific_mac_find_offsets (buffer, is_rtps, &header_offset, &footer_offset))
     return false;
 
-  crypto_hmac_t hmac;
   {
-    struct trusted_crypto_header const * const h = (struct trusted_crypto_header const *) (buffer->contents + header_offset);
     struct trusted_crypto_footer const * const f = (struct trusted_crypto_footer const *) (buffer->contents + footer_offset);
-    crypto_session_key_t key;
-    const trusted_crypto_data_t data = { {
-      .base = (unsigned char *) f->postfix.common_mac.data,
-      .length = CRYPTO_HMAC_SIZE
-    } };
-    if (!crypto_calculate_receiver_specific_key (&key, session->id, keymat->master_salt, keymat->master_receiver_specific_key, keymat->transformation_kind, ex) ||
-        !crypto_cipher_encrypt_data (&key, session->key_size, &h->prefix.iv, 1, &data, NULL, &hmac, ex))
+    if (n > (UINT16_MAX - f->header.octetsToNextHeader) / sizeof (struct receiver_specific_mac))
+    {
+      DDS_Security_Exception_set (ex, DDS_CRYPTO_PLUGIN_CONTEXT, DDS_SECURITY_ERR_CIPHER_ERROR, 0, "too many receiver specific macs");
       return false;
+    }
   }
 
   // appending may force reallocation
-  trusted_crypto_buffer_append (buffer, sizeof (struct receiver_specific_mac));
+  trusted_crypto_buffer_append (buffer, n * sizeof (struct receiver_specific_mac));
+  struct trusted_crypto_header const * const header = (struct trusted_crypto_header const *) (buffer->contents + header_offset);
   struct trusted_crypto_footer * const footer = (struct trusted_crypto_footer *) (buffer->contents + footer_offset);
   const uint32_t length = ddsrt_fromBE4u (footer->postfix.receiver_specific_macs._length);
 
@@ -782,19 +782,34 @@ add_specific_mac(
   if (length > (footer->header.octetsToNextHeader - receiver_specific_macs_offset) / sizeof (struct receiver_specific_mac))
     return false; // no worries that we already reallocated: this can't happen and it'll be freed if it does happen anyway
 
-  // there must now be room to append another MAC
-  assert (buffer->length - footer_offset >= sizeof (ddsi_rtps_submessage_header_t) + footer->header.octetsToNextHeader + sizeof (struct receiver_specific_mac));
-  DDSRT_STATIC_ASSERT (sizeof (struct receiver_specific_mac) <= UINT16_MAX);
+  // there must now be room to append the MACs
+  assert (buffer->length - footer_offset >= sizeof (ddsi_rtps_submessage_header_t) + footer->header.octetsToNextHeader + n * sizeof (struct receiver_specific_mac));
+  for (size_t i = 0; i < n; i++)
+  {
+    struct receiver_specific_mac * const rcvmac = &footer->postfix.receiver_specific_macs._buffer[length + i];
+    if (!crypto_cipher_calc_receiver_specific_mac (keys[i].keymat, keys[i].session_id, &header->prefix.iv, &footer->postfix.common_mac, &rcvmac->receiver_mac, ex))
+      return false;
+    const uint32_t key_id = ddsrt_toBE4u (keys[i].keymat->receiver_specific_key_id);
+    memcpy (rcvmac->receiver_mac_key_id, &key_id, sizeof(key_id));
+  }
   // octetsToNextHeader += (uint16_t) sizeof ... triggers a conversion warning for int to uint16_t from gcc
-  footer->header.octetsToNextHeader = (uint16_t) (footer->header.octetsToNextHeader + sizeof (struct receiver_specific_mac));
-  footer->postfix.receiver_specific_macs._length = ddsrt_toBE4u (length + 1);
-  struct receiver_specific_mac * const rcvmac = &footer->postfix.receiver_specific_macs._buffer[length];
-  rcvmac->receiver_mac = hmac;
-  const uint32_t key_id = ddsrt_toBE4u (keymat->receiver_specific_key_id);
-  memcpy (rcvmac->receiver_mac_key_id, &key_id, sizeof(key_id));
+  footer->header.octetsToNextHeader = (uint16_t) (footer->header.octetsToNextHeader + n * sizeof (struct receiver_specific_mac));
+  footer->postfix.receiver_specific_macs._length = ddsrt_toBE4u (length + (uint32_t) n);
   return true;
 }
 
+static bool
+add_specific_mac(
+    trusted_crypto_buffer_t *buffer,
+    master_key_material *keymat,
+    session_key_material *session,
+    bool is_rtps,
+    DDS_Security_SecurityException *ex)
+{
+  const struct specific_mac_key key = { .keymat = keymat, .session_id = session->id };
+  return add_specific_macs (buffer, 1, &key, is_rtps, ex);
+}
+
 static bool
 add_reader_specific_mac(
     dds_security_crypto_key_factory *factory,
@@ -819,6 +834,42 @@ add_reader_specific_mac(
   return result;
 }
 
+static bool
+add_reader_specific_macs(
+    dds_security_crypto_key_factory *factory,
+    trusted_crypto_buffer_t *buffer,
+    const DDS_Security_DatareaderCryptoHandleSeq *reader_crypto_list,
+    DDS_Security_SecurityException *ex)
+{
+  const size_t n = reader_crypto_list->_length;
+  crypto_sign_key_material *sign_keys = ddsrt_malloc(n * sizeof(*sign_keys));
+  struct specific_mac_key *keys = ddsrt_malloc(n * sizeof(*keys));
+  size_t nkeys = 0;
+  bool result = false;
+
+  if (crypto_factory_get_remote_reader_sign_key_materials(factory, n, reader_crypto_list->_buffer, sign_keys, ex))
+  {
+    for (size_t i = 0; i < n; i++)
+    {
+      if (has_origin_authentication(sign_keys[i].protection_kind))
+      {
+        keys[nkeys].keymat = sign_keys[i].key_material;
+        keys[nkeys].session_id = sign_keys[i].session_key->id;
+        nkeys++;
+      }
+    }
+    result = add_specific_macs(buffer, nkeys, keys, false, ex);
+    for (size_t i = 0; i < n; i++)
+    {
+      CRYPTO_OBJECT_RELEASE(sign_keys[i].session_key);
+      CRYPTO_OBJECT_RELEASE(sign_keys[i].key_material);
+    }
+  }
+  ddsrt_free(keys);
+  ddsrt_free(sign_keys);
+  return result;
+}
+
 static bool
 add_writer_specific_mac(
     dds_security_crypto_key_factory *factory,
@@ -951,7 +1002,7 @@ encode_submmessage_encrypt(
     trusted_crypto_data_t encrypted_data = {{ .base = body->content.data, .length = plain_submsg->_length }};
 
     /* encrypt submessage */
-    if (!crypto_cipher_encrypt_data(&session->key, session->key_size, &header->prefix.iv, 1, &plain_data, &encrypted_data, &hmac, ex))
+    if (!crypto_cipher_encrypt_session(session, &header->prefix.iv, 1, &plain_data, &encrypted_data, &hmac, ex))
       goto enc_submsg_fail;
 
     /* adjust the length of the body submessage when needed */
@@ -967,7 +1018,7 @@ encode_submmessage_encrypt(
   {
     unsigned char *ptr = trusted_crypto_buffer_append(&buffer, plain_submsg->_length);
     /* the transformation_kind indicates only indicates authentication the determine HMAC */
-    if (!crypto_cipher_encrypt_data(&session->key, session->key_size, &header->prefix.iv, 1, &plain_data, NULL, &hmac, ex))
+    if (!crypto_cipher_encrypt_session(session, &header->prefix.iv, 1, &plain_data, NULL, &hmac, ex))
       goto enc_submsg_fail;
 
     /* copy submessage */
@@ -991,11 +1042,11 @@ encode_submmessage_encrypt(
       *index = (int32_t) crypto_list->_length;
     else
     {
-      DDS_Security_CryptoHandle remote_crypto = crypto_list->_buffer[0];
-
-      if (!add_reader_specific_mac(factory, &buffer, remote_crypto, ex))
+      /* Add the MACs for all readers at once, this leaves nothing to do for
+         subsequent calls with a non-zero index */
+      if (!add_reader_specific_macs(factory, &buffer, crypto_list, ex))
         goto enc_submsg_fail;
-      (*index)++;
+      *index = (int32_t) crypto_list->_length;
     }
   }
   else
@@ -1126,9 +1177,7 @@ check_reader_specific_mac(
     DDS_Security_SecurityException *ex)
 {
   master_key_material *keymat = NULL;
-  tainted_crypto_data_t data = { .base = postfix->common_mac.data, .length = CRYPTO_HMAC_SIZE };
   uint32_t index;
-  crypto_session_key_t key;
   const crypto_hmac_t *href = NULL;
   crypto_hmac_t hmac;
 
@@ -1155,14 +1204,7 @@ check_reader_specific_mac(
     goto check_failed;
   }
 
-  if (!crypto_calculate_receiver_specific_key(&key, prefix->session_id, keymat->master_salt, keymat->master_receiver_specific_key, keymat->transformation_kind, ex))
-  {
-    DDS_Security_Exception_set(ex, DDS_CRYPTO_PLUGIN_CONTEXT, DDS_SECURITY_ERR_INVALID_CRYPTO_RECEIVER_SIGN_CODE, 0,
-        "%s: failed to calculate receiver specific session key", context);
-    goto check_failed;
-  }
-
-  if (!crypto_cipher_calc_hmac(&key, crypto_get_key_size(keymat->transformation_kind), &prefix->iv, &data, &hmac, ex))
+  if (!crypto_cipher_calc_receiver_specific_mac(keymat, prefix->session_id, &prefix->iv, &postfix->common_mac, &hmac, ex))
   {
     DDS_Security_Exception_set(ex, DDS_CRYPTO_PLUGIN_CONTEXT, DDS_SECURITY_ERR_INVALID_CRYPTO_RECEIVER_SIGN_CODE, 0,
         "%s: failed to calculate receiver specific hmac", context);
@@ -1295,7 +1337,7 @@ static DDS_Security_boolean encode_rtps_message_encrypt (
     encrypted_data.x.length = secure_body_plain_size;
 
     /* encrypt message */
-    if (!crypto_cipher_encrypt_data(&session->key, session->key_size, &header->prefix.iv, num_segs, plain_data, &encrypted_data, &hmac, ex))
+    if (!crypto_cipher_encrypt_session(session, &header->prefix.iv, num_segs, plain_data, &encrypted_data, &hmac, ex))
       goto enc_rtps_fail_data;
 
     body->content.length = ddsrt_toBE4u((uint32_t)encrypted_data.x.length);
@@ -1310,7 +1352,7 @@ static DDS_Security_boolean encode_rtps_message_encrypt (
   {
     unsigned char *ptr = trusted_crypto_buffer_append(&buffer, secure_body_plain_size);
     /* the transformation_kind indicates only indicates authentication the determine HMAC */
-    if (!crypto_cipher_encrypt_data(&session->key, session->key_size, &header->prefix.iv, num_segs, plain_data, NULL, &hmac, ex))
+    if (!crypto_cipher_encrypt_session(session, &header->prefix.iv, num_segs, plain_data, NULL, &hmac, ex))
       goto enc_rtps_fail_data;
 
     /* copy submessage */
@@ -1408,7 +1450,6 @@ ddsi_security_decode_rtps_message (dds_security_crypto_transform *instance,
 {
   dds_security_crypto_transform_impl *impl = (dds_security_crypto_transform_impl *)instance;
   dds_security_crypto_key_factory *factory = cryptography_get_crypto_key_factory(impl->crypto);
-  remote_session_info remote_session;
   struct const_tainted_encrypted_state estate;
   unsigned char *buffer = NULL;
   size_t buflen;
@@ -1451,14 +1492,6 @@ ddsi_security_decode_rtps_message (dds_security_crypto_transform *instance,
       goto fail_reader_mac;
   }
 
-  /* calculate the session key */
-  if (!initialize_remote_session_info(&remote_session, &estate.prefix, remote_key_material->master_salt, remote_key_material->master_sender_key, remote_key_material->transformation_kind, ex))
-  {
-    DDS_Security_Exception_set(ex, DDS_CRYPTO_PLUGIN_CONTEXT, DDS_SECURITY_ERR_INVALID_CRYPTO_ARGUMENT_CODE, 0,
-        "%s: " DDS_SECURITY_ERR_INVALID_CRYPTO_ARGUMENT_MESSAGE, context);
-    goto fail_reader_mac;
-  }
-
   buflen = estate.body.data.length + DDSI_RTPS_MESSAGE_HEADER_SIZE;
   buffer = ddsrt_malloc(buflen);
   memcpy(buffer, encoded_data.base, DDSI_RTPS_MESSAGE_HEADER_SIZE);
@@ -1484,7 +1517,7 @@ ddsi_security_decode_rtps_message (dds_security_crypto_transform *instance,
       goto fail_decrypt;
     }
 
-    if (!crypto_cipher_decrypt_data(&remote_session, &estate.prefix.iv, 1, &estate.body.data, &decoded_body, &estate.postfix.common_mac, ex))
+    if (!crypto_cipher_decrypt_remote(remote_key_material, estate.prefix.session_id, &estate.prefix.iv, 1, &estate.body.data, &decoded_body, &estate.postfix.common_mac, ex))
       goto fail_decrypt;
   }
   else if (is_authentication_required(estate.prefix.transform_kind))
@@ -1496,7 +1529,7 @@ ddsi_security_decode_rtps_message (dds_security_crypto_transform *instance,
       goto fail_decrypt;
     }
     /* When the CryptoHeader indicates that authentication is performed then calculate the HMAC */
-    if (!crypto_cipher_decrypt_data(&remote_session, &estate.prefix.iv, 1, &estate.body.data, NULL, &estate.postfix.common_mac, ex))
+    if (!crypto_cipher_decrypt_remote(remote_key_material, estate.prefix.session_id, &estate.prefix.iv, 1, &estate.body.data, NULL, &estate.postfix.common_mac, ex))
       goto fail_decrypt;
     memcpy(decoded_body.base, estate.body.data.base, estate.body.data.length);
   }
@@ -1583,7 +1616,6 @@ decode_submessage(
   master_key_material *keymat;
   tainted_crypto_data_t plain_data;
   DDS_Security_ProtectionKind protection_kind;
-  remote_session_info remote_session;
   struct const_tainted_encrypted_state est;
 
   assert(encoded_submsg && encoded_submsg->endp > encoded_submsg->ptr && encoded_submsg->ptr);
@@ -1619,10 +1651,6 @@ decode_submessage(
   if (has_origin_authentication(protection_kind) && !check_reader_specific_mac(factory, &est.prefix, &est.postfix, kind, remote_crypto, context, ex))
     goto fail_mac;
 
-  /* calculate the session key */
-  if (!initialize_remote_session_info(&remote_session, &est.prefix, keymat->master_salt, keymat->master_sender_key, keymat->transformation_kind, ex))
-    goto fail_mac;
-
   plain_data.base = ddsrt_malloc(est.body.data.length);
   plain_data.length = est.body.data.length;
 
@@ -1644,7 +1672,7 @@ decode_submessage(
       goto fail_decrypt;
     }
 
-    if (!crypto_cipher_decrypt_data(&remote_session, &est.prefix.iv, 1, &est.body.data, &plain_data, &est.postfix.common_mac, ex))
+    if (!crypto_cipher_decrypt_remote(keymat, est.prefix.session_id, &est.prefix.iv, 1, &est.body.data, &plain_data, &est.postfix.common_mac, ex))
       goto fail_decrypt;
   }
   else if (is_authentication_required(est.prefix.transform_kind))
@@ -1657,7 +1685,7 @@ decode_submessage(
     }
     assert(est.prefix.transform_id != 0);
     /* When the CryptoHeader indicates that authentication is performed then calculate the HMAC */
-    if (!crypto_cipher_decrypt_data(&remote_session, &est.prefix.iv, 1, &est.body.data, NULL, &est.postfix.common_mac, ex))
+    if (!crypto_cipher_decrypt_remote(keymat, est.prefix.session_id, &est.prefix.iv, 1, &est.body.data, NULL, &est.postfix.common_mac, ex))
       goto fail_decrypt;
 
     memcpy(plain_data.base, est.body.data.base, est.body.data.length);
@@ -1726,7 +1754,6 @@ decode_serialized_payload(
   tainted_crypto_data_t plain_data;
   DDS_Security_BasicProtectionKind basic_protection_kind;
   master_key_material *writer_master_key;
-  remote_session_info remote_session;
   struct const_tainted_encrypted_state estate;
 
   DDSRT_UNUSED_ARG(inline_qos);
@@ -1763,10 +1790,6 @@ decode_serialized_payload(
   plain_data.base = ddsrt_malloc(estate.body.data.length);
   plain_data.length = estate.body.data.length;
 
-  /* calculate the session key */
-  if (!initialize_remote_session_info(&remote_session, &estate.prefix, writer_master_key->master_salt, writer_master_key->master_sender_key, writer_master_key->transformation_kind, ex))
-    goto fail_decrypt;
-
   /*
    * Depending on encryption, the payload part between Header and Footer is
    * either CryptoContent or the original plain payload.
@@ -1782,7 +1805,7 @@ decode_serialized_payload(
       goto fail_decrypt;
     }
 
-    if (!crypto_cipher_decrypt_data(&remote_session, &estate.prefix.iv, 1, &estate.body.data, &plain_data, &estate.postfix.common_mac, ex))
+    if (!crypto_cipher_decrypt_remote(writer_master_key, estate.prefix.session_id, &estate.prefix.iv, 1, &estate.body.data, &plain_data, &estate.postfix.common_mac, ex))
       goto fail_decrypt;
   }
   else if (is_authentication_required(estate.prefix.transform_kind))
@@ -1795,7 +1818,7 @@ decode_serialized_payload(
       goto fail_decrypt;
     }
     /* When the CryptoHeader indicates that authentication is performed then calculate the HMAC */
-    if (!crypto_cipher_decrypt_data(&remote_session, &estate.prefix.iv, 1, &estate.body.data, NULL, &estate.postfix.common_mac, ex))
+    if (!crypto_cipher_decrypt_remote(writer_master_key, estate.prefix.session_id, &estate.prefix.iv, 1, &estate.body.data, NULL, &estate.postfix.common_mac, ex))
       goto fail_decrypt;
     memcpy(plain_data.base, estate.body.data.base,  estate.body.data.length);
   }
@@ -9,6 +9,7 @@
 // SPDX-License-Identifier: EPL-2.0 OR BSD-3-Clause
 
 #include <assert.h>
+#include <inttypes.h>
 
 #include "dds/ddsrt/bswap.h"
 #include "dds/ddsrt/endian.h"
@@ -16,6 +17,7 @@
 #include "dds/ddsrt/string.h"
 #include "dds/ddsrt/types.h"
 #include "dds/ddsrt/environ.h"
+#include "dds/ddsrt/time.h"
 #include "dds/security/dds_security_api.h"
 #include "dds/security/core/dds_security_serialize.h"
 #include "dds/security/core/dds_security_utils.h"
@@ -1076,6 +1078,88 @@ CU_Test(ddssec_builtin_encode_datawriter_submessage, no_encode_sign_128, .init =
   encode_datawriter_submessage_sign(CRYPTO_TRANSFORMATION_KIND_AES128_GMAC);
 }
 
+CU_Test(ddssec_builtin_encode_datawriter_submessage, sign_scaling, .init = suite_encode_datawriter_submessage_init, .fini = suite_encode_datawriter_submessage_fini, .timeout = 60)
+{
+  /* The receiver specific macs for all readers are added in a single call, check
+     that they are correct for any number of readers and report how the cost of
+     encoding a submessage scales with the number of readers */
+  const uint32_t MAX_READERS = 512;
+  const uint32_t MESSAGES = 100;
+  DDS_Security_DatawriterCryptoHandle writer_crypto;
+  DDS_Security_DatareaderCryptoHandleSeq reader_list;
+  DDS_Security_SecurityException exception = {NULL, 0, 0};
+  DDS_Security_OctetSeq plain_buffer;
+  DDS_Security_PropertySeq datawriter_properties;
+  DDS_Security_EndpointSecurityAttributes datawriter_security_attributes;
+  session_key_material *session_keys;
+
+  CU_ASSERT_FATAL(crypto != NULL);
+  assert(crypto != NULL);
+
+  prepare_endpoint_security_attributes_and_properties(&datawriter_security_attributes, &datawriter_properties, CRYPTO_TRANSFORMATION_KIND_AES256_GCM, true);
+  initialize_data_submessage(&plain_buffer, DDSRT_BOSEL_NATIVE);
+  writer_crypto = register_local_datawriter(&datawriter_security_attributes, &datawriter_properties);
+  CU_ASSERT_FATAL(writer_crypto != 0);
+  session_keys = get_datawriter_session(writer_crypto);
+
+  reader_list._maximum = MAX_READERS;
+  reader_list._length = 0;
+  reader_list._buffer = DDS_Security_DatareaderCryptoHandleSeq_allocbuf(MAX_READERS);
+  for (uint32_t nreaders = 1; nreaders <= MAX_READERS; nreaders *= 2)
+  {
+    while (reader_list._length < nreaders)
+    {
+      reader_list._buffer[reader_list._length] = register_remote_datareader(writer_crypto);
+      CU_ASSERT_FATAL(reader_list._buffer[reader_list._length] != 0);
+      reader_list._length++;
+    }
+
+    const dds_time_t t0 = dds_time();
+    for (uint32_t m = 0; m < MESSAGES; m++)
+    {
+      DDS_Security_OctetSeq encoded_buffer;
+      DDS_Security_OctetSeq *buffer = &plain_buffer;
+      int32_t index = 0;
+      while (index != (int32_t)nreaders)
+      {
+        DDS_Security_boolean result = crypto->crypto_transform->encode_datawriter_submessage(
+            crypto->crypto_transform, &encoded_buffer, buffer, writer_crypto, &reader_list, &index, &exception);
+        if (!result)
+          printf("encode_datawriter_submessage: %s\n", exception.message ? exception.message : "Error message missing");
+        CU_ASSERT_FATAL(result);
+        reset_exception(&exception);
+        buffer = NULL;
+      }
+
+      if (m == 0)
+      {
+        struct crypto_header *header = NULL;
+        struct crypto_footer *footer = NULL;
+        DDS_Security_OctetSeq data;
+        CU_ASSERT_FATAL(check_encoded_data(&encoded_buffer, true, &header, &footer, &data));
+        const uint32_t session_id = ddsrt_bswap4u(*(uint32_t *)header->session_id);
+        CU_ASSERT(check_reader_signing(&reader_list, footer, session_id, header->session_id, session_keys->key_size));
+        ddsrt_free(footer);
+        ddsrt_free(header);
+      }
+      DDS_Security_OctetSeq_deinit(&encoded_buffer);
+    }
+    const dds_duration_t dt = dds_time() - t0;
+    printf("sign_scaling: %3"PRIu32" readers: %8.2f us/msg %6.3f us/reader\n", nreaders,
+           (double)dt / 1e3 / MESSAGES, (double)dt / 1e3 / MESSAGES / nreaders);
+  }
+
+  for (uint32_t i = 0; i < reader_list._length; i++)
+    unregister_datareader(reader_list._buffer[i]);
+  unregister_datawriter(writer_crypto);
+
+  DDS_Security_OctetSeq_deinit(&plain_buffer);
+  DDS_Security_DatareaderCryptoHandleSeq_deinit(&reader_list);
+  ddsrt_free(datawriter_properties._buffer[0].name);
+  ddsrt_free(datawriter_properties._buffer[0].value);
+  ddsrt_free(datawriter_properties._buffer);
+}
+
 CU_Test(ddssec_builtin_encode_datawriter_submessage, invalid_args, .init = suite_encode_datawriter_submessage_init, .fini = suite_encode_datawriter_submessage_fini)
 {
   DDS_Security_boolean result;
@@ -24,6 +24,7 @@
 #include "CUnit/Test.h"
 #include "common/src/loader.h"
 #include "common/src/crypto_helper.h"
+#include "crypto_cipher.h"
 #include "crypto_objects.h"
 #include "crypto_utils.h"
 
@@ -722,3 +723,134 @@ CU_Test(ddssec_builtin_encode_serialized_payload, invalid_args, .init = suite_en
   DDS_Security_OctetSeq_deinit(&plain_buffer);
 }
 
+
+static void encode_check_decode(DDS_Security_DatawriterCryptoHandle writer_crypto, DDS_Security_OctetSeq *plain_buffer, uint32_t *session_id)
+{
+  DDS_Security_SecurityException exception = {NULL, 0, 0};
+  DDS_Security_OctetSeq encoded_buffer = {0, 0, NULL};
+  DDS_Security_OctetSeq extra_inline_qos = {0, 0, NULL};
+  DDS_Security_OctetSeq encoded_payload = {0, 0, NULL};
+  DDS_Security_OctetSeq decoded_buffer;
+  session_key_material *session_keys = get_datawriter_session(writer_crypto);
+  struct crypto_header *header = NULL;
+  struct crypto_footer *footer = NULL;
+  bool result;
+
+  result = crypto->crypto_transform->encode_serialized_payload(
+      crypto->crypto_transform, &encoded_buffer, &extra_inline_qos, plain_buffer, writer_crypto, &exception);
+  CU_ASSERT_FATAL(result);
+  reset_exception(&exception);
+
+  result = split_encoded_data(encoded_buffer._buffer, encoded_buffer._length, &header, &encoded_payload, &footer, true);
+  CU_ASSERT_FATAL(result);
+  *session_id = ddsrt_fromBE4u(*(uint32_t *)header->session_id);
+
+  decoded_buffer._buffer = ddsrt_malloc(plain_buffer->_length);
+  decoded_buffer._length = decoded_buffer._maximum = plain_buffer->_length;
+  result = crypto_decrypt_data(*session_id, &header->session_id[0], header->transform_identifier.transformation_kind, session_keys->master_key_material, &encoded_payload, &decoded_buffer, footer->common_mac);
+  CU_ASSERT_FATAL(result);
+  CU_ASSERT(check_payload_decoded(&decoded_buffer, plain_buffer));
+  DDS_Security_OctetSeq_deinit(&decoded_buffer);
+  DDS_Security_OctetSeq_deinit(&encoded_buffer);
+}
+
+/* The cipher context is cached in the session, make sure every payload is still
+   encrypted correctly with its own IV, including across session key changes */
+CU_Test(ddssec_builtin_encode_serialized_payload, repeated, .init = suite_encode_serialized_payload_init, .fini = suite_encode_serialized_payload_fini)
+{
+  DDS_Security_DatawriterCryptoHandle writer_crypto;
+  DDS_Security_OctetSeq plain_buffer;
+  session_key_material *session_keys;
+  uint32_t session_id, prev_session_id = 0;
+  size_t length;
+
+  writer_crypto = register_local_datawriter(true);
+  CU_ASSERT_FATAL(writer_crypto != 0);
+  session_keys = get_datawriter_session(writer_crypto);
+
+  length = strlen(SAMPLE_TEST_DATA) + 1;
+  plain_buffer._length = plain_buffer._maximum = (uint32_t) length;
+  plain_buffer._buffer = DDS_Security_OctetSeq_allocbuf((uint32_t) length);
+  memcpy((char *)plain_buffer._buffer, SAMPLE_TEST_DATA, length);
+
+  for (int i = 0; i < 100; i++)
+  {
+    /* force a new session key every 25 payloads */
+    if (i % 25 == 24)
+      session_keys->block_counter = session_keys->max_blocks_per_session;
+    plain_buffer._buffer[0] = (unsigned char) i;
+    encode_check_decode(writer_crypto, &plain_buffer, &session_id);
+    if (i % 25 == 24 || i == 0)
+      CU_ASSERT(session_id != prev_session_id);
+    else
+      CU_ASSERT(session_id == prev_session_id);
+    prev_session_id = session_id;
+  }
+
+  DDS_Security_OctetSeq_deinit(&plain_buffer);
+  unregister_local_datawriter(writer_crypto);
+}
+
+CU_Test(ddssec_builtin_encode_serialized_payload, batch, .init = suite_encode_serialized_payload_init, .fini = suite_encode_serialized_payload_fini)
+{
+  DDS_Security_DatawriterCryptoHandle writer_crypto;
+  DDS_Security_SecurityException exception = {NULL, 0, 0};
+  DDS_Security_OctetSeq plain_buffer;
+  session_key_material *session_keys;
+  uint32_t session_id;
+  size_t length;
+  bool result;
+
+  writer_crypto = register_local_datawriter(true);
+  CU_ASSERT_FATAL(writer_crypto != 0);
+  session_keys = get_datawriter_session(writer_crypto);
+
+  length = strlen(SAMPLE_TEST_DATA) + 1;
+  plain_buffer._length = plain_buffer._maximum = (uint32_t) length;
+  plain_buffer._buffer = DDS_Security_OctetSeq_allocbuf((uint32_t) length);
+  memcpy((char *)plain_buffer._buffer, SAMPLE_TEST_DATA, length);
+
+  /* encoding a payload initialises the session key */
+  encode_check_decode(writer_crypto, &plain_buffer, &session_id);
+  CU_ASSERT_FATAL(session_id == session_keys->id);
+
+#define NJOBS 3
+  struct init_vector ivs[NJOBS];
+  trusted_crypto_data_t inp[NJOBS], outp[NJOBS];
+  crypto_hmac_t tags[NJOBS];
+  crypto_cipher_job_t jobs[NJOBS];
+  for (uint32_t i = 0; i < NJOBS; i++)
+  {
+    const uint32_t sid = ddsrt_toBE4u(session_id);
+    const uint64_t ivsuffix = ++session_keys->init_vector_suffix;
+    memcpy(ivs[i].u, &sid, sizeof(sid));
+    memcpy(ivs[i].u + sizeof(sid), &ivsuffix, sizeof(ivsuffix));
+    inp[i].x.base = plain_buffer._buffer + i;
+    inp[i].x.length = length - i;
+    outp[i].x.base = ddsrt_malloc(length);
+    outp[i].x.length = length - i;
+    jobs[i] = (crypto_cipher_job_t) { .iv = &ivs[i], .num_inp = 1, .inpdata = &inp[i], .outpdata = &outp[i], .tag = &tags[i] };
+  }
+  result = crypto_cipher_encrypt_session_batch(session_keys, NJOBS, jobs, &exception);
+  CU_ASSERT_FATAL(result);
+  reset_exception(&exception);
+
+  DDS_Security_CryptoTransformKind transformation_kind;
+  const uint32_t kind_be = ddsrt_toBE4u(session_keys->master_key_material->transformation_kind);
+  memcpy(transformation_kind, &kind_be, sizeof(kind_be));
+  for (uint32_t i = 0; i < NJOBS; i++)
+  {
+    DDS_Security_OctetSeq encrypted = { (uint32_t) outp[i].x.length, (uint32_t) outp[i].x.length, outp[i].x.base };
+    DDS_Security_OctetSeq decoded = { (uint32_t) length, (uint32_t) length, ddsrt_malloc(length) };
+    DDS_Security_OctetSeq expected = { (uint32_t) (length - i), (uint32_t) (length - i), plain_buffer._buffer + i };
+    result = crypto_decrypt_data(session_id, ivs[i].u, transformation_kind, session_keys->master_key_material, &encrypted, &decoded, tags[i].data);
+    CU_ASSERT(result);
+    CU_ASSERT(check_payload_decoded(&decoded, &expected));
+    ddsrt_free(decoded._buffer);
+    ddsrt_free(outp[i].x.base);
+  }
+#undef NJOBS
+
+  DDS_Security_OctetSeq_deinit(&plain_buffer);
+  unregister_local_datawriter(writer_crypto);
+}
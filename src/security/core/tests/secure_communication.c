@@ -386,6 +386,83 @@ static void test_payload_secret(DDS_Security_ProtectionKind rtps_pk, DDS_Securit
   ddsrt_free (sample.text);
 }
 
+static double test_throughput_run (DDS_Security_ProtectionKind rtps_pk, DDS_Security_ProtectionKind metadata_pk, DDS_Security_BasicProtectionKind payload_pk, int32_t n_samples)
+{
+  dds_entity_t *writers, *readers, *writer_topics, *reader_topics;
+  SecurityCoreTests_Type1 rd_samples[100];
+  void *samples[100];
+  dds_sample_info_t info[100];
+  dds_return_t ret;
+  char name[100];
+  struct domain_sec_config domain_config = { PK_N, PK_N, rtps_pk, metadata_pk, payload_pk, NULL };
+
+  for (size_t i = 0; i < sizeof (samples) / sizeof (samples[0]); i++)
+    samples[i] = &rd_samples[i];
+  test_init (&domain_config, 1, 1, 1, 1, set_encryption_parameters_basic);
+  create_topic_name ("ddssec_secure_communication_", g_topic_nr++, name, sizeof name);
+  dds_qos_t *qos = get_qos ();
+  dds_qset_durability (qos, DDS_DURABILITY_VOLATILE);
+  create_eps (&writers, &writer_topics, 1, 1, 1, name, &SecurityCoreTests_Type1_desc, g_pub_participants, qos, &dds_create_writer, DDS_PUBLICATION_MATCHED_STATUS);
+  create_eps (&readers, &reader_topics, 1, 1, 1, name, &SecurityCoreTests_Type1_desc, g_sub_participants, qos, &dds_create_reader, DDS_DATA_AVAILABLE_STATUS);
+  dds_delete_qos (qos);
+  sync_writer_to_readers (g_pub_participants[0], writers[0], 1, dds_time () + DDS_SECS (5));
+
+  const dds_time_t tstart = dds_time ();
+  int32_t n_received = 0;
+  for (int32_t i = 0; i < n_samples; i++)
+  {
+    SecurityCoreTests_Type1 sample = { i, 1 };
+    ret = dds_write (writers[0], &sample);
+    CU_ASSERT_EQUAL_FATAL (ret, DDS_RETCODE_OK);
+    while ((ret = dds_take (readers[0], samples, info, 100, 100)) > 0)
+      n_received += ret;
+  }
+  while (n_received < n_samples)
+  {
+    if ((ret = dds_take (readers[0], samples, info, 100, 100)) > 0)
+      n_received += ret;
+    else
+      CU_ASSERT_FATAL (reader_wait_for_data (g_sub_participants[0], readers[0], DDS_SECS (5)));
+  }
+  const dds_time_t tend = dds_time ();
+  CU_ASSERT_EQUAL (n_received, n_samples);
+
+  test_fini (1, 1);
+  free_eps (readers, reader_topics);
+  free_eps (writers, writer_topics);
+  return (double) n_samples / ((double) (tend - tstart) / 1e9);
+}
+
+/* Benchmark comparing the number of messages per second between a writer and a reader
+   without protection and with RTPS message, submessage and payload protection */
+CU_Test(ddssec_secure_communication, throughput, .timeout = 120)
+{
+  static const struct {
+    DDS_Security_ProtectionKind rtps_pk, metadata_pk;
+    DDS_Security_BasicProtectionKind payload_pk;
+  } configs[] = {
+    { PK_N, PK_N, BPK_N },
+    { PK_N, PK_N, BPK_S },
+    { PK_N, PK_N, BPK_E },
+    { PK_N, PK_S, BPK_N },
+    { PK_N, PK_E, BPK_N },
+    { PK_S, PK_N, BPK_N },
+    { PK_E, PK_N, BPK_N },
+    { PK_E, PK_E, BPK_E }
+  };
+  const int32_t n_samples = 20000;
+  double baseline = 0.0;
+  for (size_t i = 0; i < sizeof (configs) / sizeof (configs[0]); i++)
+  {
+    const double rate = test_throughput_run (configs[i].rtps_pk, configs[i].metadata_pk, configs[i].payload_pk, n_samples);
+    if (i == 0)
+      baseline = rate;
+    printf ("throughput rtps %s metadata %s payload %s: %.0f msgs/s (%.0f%%)\n",
+            pk_to_str (configs[i].rtps_pk), pk_to_str (configs[i].metadata_pk), bpk_to_str (configs[i].payload_pk),
+            rate, 100.0 * rate / baseline);
+  }
+}
+
 /* Test communication between 2 nodes for all combinations of RTPS, metadata (submsg)
    and payload protection kinds using a single reader and writer */
 CU_Test(ddssec_secure_communication, protection_kinds, .timeout = 120)
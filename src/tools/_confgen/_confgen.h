@@ -47,6 +47,9 @@ void gendef_pf_boolean_default (FILE *fp, void *parent, struct cfgelem const * c
 void gendef_pf_besmode (FILE *fp, void *parent, struct cfgelem const * const cfgelem);
 void gendef_pf_protocol_version (FILE *out, void *parent, struct cfgelem const * const cfgelem);
 void gendef_pf_retransmit_merging (FILE *fp, void *parent, struct cfgelem const * const cfgelem);
+void gendef_pf_xeventq_impl (FILE *fp, void *parent, struct cfgelem const * const cfgelem);
+void gendef_pf_sock_waitset_impl (FILE *fp, void *parent, struct cfgelem const * const cfgelem);
+void gendef_pf_recv_steering (FILE *fp, void *parent, struct cfgelem const * const cfgelem);
 void gendef_pf_sched_class (FILE *fp, void *parent, struct cfgelem const * const cfgelem);
 void gendef_pf_entity_naming_mode (FILE *fp, void *parent, struct cfgelem const * const cfgelem);
 void gendef_pf_random_seed (FILE *fp, void *parent, struct cfgelem const * const cfgelem);
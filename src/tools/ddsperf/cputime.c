@@ -25,6 +25,7 @@
 #include "dds/ddsrt/misc.h"
 
 #include "cputime.h"
+#include "output.h"
 #include "ddsperf_types.h"
 
 static void print_one (char *line, size_t sz, size_t *pos, const char *name, double du, double ds)
@@ -33,12 +34,38 @@ static void print_one (char *line, size_t sz, size_t *pos, const char *name, dou
     *pos += (size_t) snprintf (line + *pos, sz - *pos, " %s:%.0f%%+%.0f%%", name, 100.0 * du, 100.0 * ds);
 }
 
+static void output_cputime (const struct CPUStats *s, bool print_host)
+{
+  char peer[128], name[64];
+  if (print_host)
+    snprintf (peer, sizeof (peer), "%s:%"PRIu32, s->hostname, s->pid);
+  output_begin ("cpu", print_host ? peer : NULL);
+  if (s->maxrss > 1024)
+    output_value ("rss", s->maxrss);
+  output_value ("vcsw", s->vcsw);
+  output_value ("ivcsw", s->ivcsw);
+  for (uint32_t i = 0; i < s->cpu._length; i++)
+  {
+    const struct CPUStatThread * const thr = &s->cpu._buffer[i];
+    snprintf (name, sizeof (name), "%s.user", thr->name);
+    output_value (name, thr->u_pct);
+    snprintf (name, sizeof (name), "%s.sys", thr->name);
+    output_value (name, thr->s_pct);
+  }
+  output_end ();
+}
+
 bool print_cputime (const struct CPUStats *s, const char *prefix, bool print_host, bool is_fresh)
 {
   if (!s->some_above)
     return false;
   else
   {
+    if (is_fresh)
+      output_cputime (s, print_host);
+    if (!output_text ())
+      return true;
+
     char line[512];
     size_t pos = 0;
     pos += (size_t) snprintf (line + pos, sizeof (line) - pos, "%s", prefix);
@@ -37,9 +37,12 @@
 #include "dds/ddsrt/fibheap.h"
 #include "dds/ddsrt/atomics.h"
 #include "dds/ddsrt/heap.h"
+#include "dds/ddsrt/rusage.h"
 
 #include "cputime.h"
 #include "netload.h"
+#include "hdrhist.h"
+#include "output.h"
 
 #if !defined(_WIN32) && !defined(LWIP_SOCKET)
 #include <errno.h>
@@ -48,7 +51,9 @@
 #define UDATA_MAGIC "DDSPerf:"
 #define UDATA_MAGIC_SIZE (sizeof (UDATA_MAGIC) - 1)
 
-#define PINGPONG_RAWSIZE 20000
+/* User data of the participants created in "disc" mode: DDSPerfDisc:PID */
+#define UDATA_DISC_MAGIC "DDSPerfDisc:"
+#define UDATA_DISC_MAGIC_SIZE (sizeof (UDATA_DISC_MAGIC) - 1)
 
 enum topicsel {
   KS,    /* KeyedSeq type: seq#, key, sequence-of-octet */
@@ -191,6 +196,19 @@ static bool sublatency = false;
 /* Use writer loans (only for memcpy-able types) */
 static bool use_writer_loan = false;
 
+/* Write each burst using a single call to dds_write_batch */
+static bool use_write_batch = false;
+
+/* Discovery scale test ("disc" mode): number of participants to create (0 if
+   not selected), topics per participant, readers and writers per topic, and
+   the time to wait after the system has settled before leaving/joining again
+   (0: join once and stay) */
+static uint32_t disctest_nparticipants = 0;
+static uint32_t disctest_ntopics = 1;
+static uint32_t disctest_nreaders = 1;
+static uint32_t disctest_nwriters = 1;
+static double disctest_cycle = 0;
+
 /* Event queue for processing discovery events (data available on
    DCPSParticipant, subscription & publication matched)
    asynchronously to avoid deadlocking on creating a reader from
@@ -213,12 +231,17 @@ struct hist {
 static ddsrt_mutex_t pubstat_lock;
 static struct hist *pubstat_hist;
 
+/* Latency statistics: the interval histogram is replaced every time the
+   statistics are printed and then added to the one for the entire run */
 struct latencystat {
   int64_t min, max;
   int64_t sum;
   uint32_t cnt;
+  int64_t totmin, totmax;
+  int64_t totsum;
   uint64_t totcnt;
-  int64_t *raw;
+  struct hdrhist *hist;
+  struct hdrhist *tothist;
 };
 
 /* Subscriber statistics for tracking number of samples received
@@ -359,6 +382,53 @@ static int cmp_ppant_tdeadline (const void *va, const void *vb)
 static ddsrt_fibheap_def_t ppants_to_match_fhd = DDSRT_FIBHEAPDEF_INITIALIZER (offsetof (struct ppant, fhnode), cmp_ppant_tdeadline);
 static ddsrt_fibheap_t ppants_to_match;
 
+/* Discovery scale test: the participants created in a mass join get deleted again
+   in a mass leave if cycling.  The system has settled after a join once all
+   participants with the UDATA_DISC_MAGIC user data have been discovered (via the
+   DCPSParticipant reader) and all local readers and writers have matched all
+   remote ones, and after a leave once all those participants have disappeared. */
+enum disctest_phase {
+  DISCTEST_IDLE,     /* not started or finished */
+  DISCTEST_JOINING,
+  DISCTEST_JOINED,
+  DISCTEST_LEAVING,
+  DISCTEST_LEFT
+};
+
+struct disctest_ppant {
+  ddsrt_avl_node_t avlnode;
+  dds_instance_handle_t handle;
+};
+
+struct disctest_phasestat {
+  uint32_t n;
+  double sum, max;
+};
+
+struct disctest_admin {
+  ddsrt_mutex_t lock;
+  enum disctest_phase phase;
+  uint32_t nprocs;               /* number of ddsperf processes, fixed at first join */
+  dds_entity_t *dps;             /* locally created participants */
+  ddsrt_avl_tree_t ppants;       /* discovered disc participants, including local ones */
+  uint32_t nppants;
+  int64_t rd_matched;            /* sum of current_count of local readers */
+  int64_t wr_matched;            /* sum of current_count of local writers */
+  dds_time_t tstart;             /* start of current join/leave */
+  dds_time_t tppants;            /* all participants discovered (or gone) */
+  dds_time_t tsettled;           /* all participants & endpoints discovered (or gone) */
+  /* only accessed by main thread */
+  bool reported;
+  dds_time_t tnext;
+  dds_time_t cputime_start;
+  bool netload_valid;
+  struct netload_counters netload_start;
+  struct disctest_phasestat join, leave;
+};
+
+static ddsrt_avl_treedef_t disctest_ppants_td = DDSRT_AVL_TREEDEF_INITIALIZER (offsetof (struct disctest_ppant, avlnode), offsetof (struct disctest_ppant, handle), cmp_instance_handle, NULL);
+static struct disctest_admin disctest;
+
 /* Printing error messages: error2 is for DDS errors, error3 is for usage errors */
 static void verrorx (int exitcode, const char *fmt, va_list ap) ddsrt_attribute_noreturn;
 static void error2 (const char *fmt, ...) ddsrt_attribute_format_printf(1, 2) ddsrt_attribute_noreturn;
@@ -543,7 +613,7 @@ static void xsnprintf(char *buf, size_t bufsz, size_t *p, const char *fmt, ...)
   }
 }
 
-static void hist_print (const char *prefix, struct hist *h, dds_time_t dt, int reset)
+static void hist_print (const char *prefix, const char *record, struct hist *h, dds_time_t dt, int reset)
 {
   const size_t l_size = sizeof(char) * h->nbins + 200 + strlen (prefix);
   const size_t hist_size = sizeof(char) * h->nbins + 1;
@@ -584,6 +654,15 @@ static void hist_print (const char *prefix, struct hist *h, dds_time_t dt, int r
   }
 
   avg = (double) cnt / dt_s;
+  output_begin (record, NULL);
+  output_value ("rate", avg);
+  if (h->min != UINT64_MAX)
+  {
+    output_value ("min", (double) h->min);
+    output_value ("max", (double) h->max);
+  }
+  output_end ();
+
   if (avg < 999.5)
     xsnprintf (l, l_size, &p, "%5.3g", avg);
   else if (avg < 1e6)
@@ -623,8 +702,11 @@ static void hist_print (const char *prefix, struct hist *h, dds_time_t dt, int r
     xsnprintf (l, l_size, &p, " %3"PRIu64"s", (h->max + 500000000) / 1000000000);
 
   (void) p;
-  puts (l);
-  fflush (stdout);
+  if (output_text ())
+  {
+    puts (l);
+    fflush (stdout);
+  }
   free (l);
   free (hist);
   if (reset)
@@ -695,6 +777,73 @@ static void *init_sample (union data *data, uint32_t seq)
   return baggage;
 }
 
+static void publoop_batch (union data *data, size_t seqoff, size_t keyvaloff)
+{
+  dds_return_t result;
+  union data *samples = malloc (burstsize * sizeof (*samples));
+  const void **ptrs = malloc (burstsize * sizeof (*ptrs));
+  dds_time_t *tstamps = malloc (burstsize * sizeof (*tstamps));
+  assert (samples && ptrs && tstamps);
+  for (uint32_t k = 0; k < burstsize; k++)
+    ptrs[k] = &samples[k];
+
+  dds_time_t ntot = 0;
+  const dds_time_t tfirst = dds_time ();
+  dds_time_t t_write = tfirst;
+  while (!ddsrt_atomic_ld32 (&termflag))
+  {
+    /* the samples in a burst differ only in sequence number and key value, the
+       sequence of topic KS shares the buffer of the template sample */
+    bool anyreqresp = false;
+    for (uint32_t k = 0; k < burstsize; k++)
+    {
+      const bool reqresp = (ping_frac == 0) ? 0 : (ping_frac == UINT32_MAX) ? 1 : (ddsrt_random () <= ping_frac);
+      anyreqresp = anyreqresp || reqresp;
+      tstamps[k] = (t_write & ~1) | reqresp;
+      memcpy (&samples[k], data, sizeof (*data));
+      (*((uint32_t *) ((char *) data + seqoff)))++;
+      if (keyvaloff != SIZE_MAX) {
+        uint32_t * const keyvalptr = (uint32_t *) ((char *) data + keyvaloff);
+        *keyvalptr = (*keyvalptr + 1) % nkeyvals;
+      }
+    }
+    if ((result = dds_write_batch (wr_data, ptrs, burstsize, tstamps, NULL)) != DDS_RETCODE_OK)
+    {
+      printf ("write batch error: %d\n", result);
+      fflush (stdout);
+      if (result != DDS_RETCODE_TIMEOUT)
+        exit (2);
+      /* some of the samples have not been written, which will show up as lost
+         samples in the subscribers, same as in the unreliable case */
+    }
+    if (anyreqresp)
+    {
+      dds_write_flush (wr_data);
+    }
+
+    /* the time it takes to write a sample is the average over the burst */
+    const dds_time_t t_post_write = dds_time ();
+    ddsrt_mutex_lock (&pubstat_lock);
+    hist_record (pubstat_hist, (uint64_t) (t_post_write - t_write) / burstsize, burstsize);
+    ntot += burstsize;
+    ddsrt_mutex_unlock (&pubstat_lock);
+
+    t_write = t_post_write;
+    if (pub_rate < HUGE_VAL)
+    {
+      while (((double) (ntot / burstsize) / ((double) (t_write - tfirst) / 1e9 + 5e-3)) > pub_rate && !ddsrt_atomic_ld32 (&termflag))
+      {
+        dds_write_flush (wr_data);
+        dds_sleepfor (DDS_MSECS (1));
+        t_write = dds_time ();
+      }
+    }
+  }
+  free (tstamps);
+  free (ptrs);
+  free (samples);
+}
+
 static uint32_t pubthread (void *varg)
 {
   int result;
@@ -733,6 +882,15 @@ static uint32_t pubthread (void *varg)
     }
   }
 
+  if (use_write_batch)
+  {
+    publoop_batch (&data, seqoff, keyvaloff);
+    if (baggage)
+      free (baggage);
+    free (ihs);
+    return 0;
+  }
+
   uint32_t time_interval = 1; // call dds_time() once for this many samples
   uint32_t time_counter = time_interval; // how many more samples on current time stamp
   uint32_t batch_counter = 0; // number of samples in current batch
@@ -855,67 +1013,116 @@ static void latencystat_init (struct latencystat *x)
   x->min = INT64_MAX;
   x->max = INT64_MIN;
   x->sum = x->cnt = 0;
-  x->raw = malloc (PINGPONG_RAWSIZE * sizeof (*x->raw));
-  assert(x->raw);
+  x->totmin = INT64_MAX;
+  x->totmax = INT64_MIN;
+  x->totsum = 0;
+  x->totcnt = 0;
+  x->hist = hdrhist_new ();
+  x->tothist = hdrhist_new ();
 }
 
 static void latencystat_fini (struct latencystat *x)
 {
-  free (x->raw);
+  hdrhist_free (x->hist);
+  hdrhist_free (x->tothist);
 }
 
-static void latencystat_reset (struct latencystat *x, int64_t *newraw)
+static void latencystat_reset (struct latencystat *x, struct hdrhist *newhist)
 {
-  x->raw = newraw;
+  x->hist = newhist;
   x->min = INT64_MAX;
   x->max = INT64_MIN;
   x->sum = x->cnt = 0;
 }
 
-static int cmp_int64 (const void *va, const void *vb)
+static void format_ppinfo (char *buf, size_t size, dds_instance_handle_t pubhandle, dds_instance_handle_t pphandle)
 {
-  const int64_t *a = va;
-  const int64_t *b = vb;
-  return (*a == *b) ? 0 : (*a < *b) ? -1 : 1;
+  struct ppant *pp;
+  ddsrt_mutex_lock (&disc_lock);
+  if ((pp = ddsrt_avl_lookup (&ppants_td, &ppants, &pphandle)) == NULL)
+    snprintf (buf, size, "%"PRIx64, pubhandle);
+  else
+    snprintf (buf, size, "%s:%"PRIu32, pp->hostname, pp->pid);
+  ddsrt_mutex_unlock (&disc_lock);
 }
 
-static int64_t *latencystat_print (struct latencystat *y, const char *prefix, const char *subprefix, dds_instance_handle_t pubhandle, dds_instance_handle_t pphandle, uint32_t size)
+static const double latency_percentiles[] = { 50, 90, 99, 99.9, 99.99, 99.999, 99.9999 };
+static const char *latency_percentile_names[] = { "p50", "p90", "p99", "p99.9", "p99.99", "p99.999", "p99.9999" };
+
+static void output_latency (const char *record, const char *ppinfo, uint32_t size, double mean, int64_t min, int64_t max, uint64_t cnt, const struct hdrhist *h)
+{
+  output_begin (record, ppinfo);
+  output_value ("size", size);
+  output_value ("mean", mean / 1e3);
+  output_value ("min", (double) min / 1e3);
+  for (size_t i = 0; i < sizeof (latency_percentiles) / sizeof (latency_percentiles[0]); i++)
+    output_value (latency_percentile_names[i], (double) hdrhist_percentile (h, latency_percentiles[i]) / 1e3);
+  output_value ("max", (double) max / 1e3);
+  output_value ("cnt", (double) cnt);
+  output_value ("histcnt", (double) hdrhist_count (h));
+  output_end ();
+}
+
+static struct hdrhist *latencystat_print (struct latencystat *y, const char *prefix, const char *subprefix, const char *record, dds_instance_handle_t pubhandle, dds_instance_handle_t pphandle, uint32_t size)
 {
   if (y->cnt > 0)
   {
-    const uint32_t rawcnt = (y->cnt > PINGPONG_RAWSIZE) ? PINGPONG_RAWSIZE : y->cnt;
     char ppinfo[128];
-    struct ppant *pp;
-    ddsrt_mutex_lock (&disc_lock);
-    if ((pp = ddsrt_avl_lookup (&ppants_td, &ppants, &pphandle)) == NULL)
-      snprintf (ppinfo, sizeof (ppinfo), "%"PRIx64, pubhandle);
-    else
-      snprintf (ppinfo, sizeof (ppinfo), "%s:%"PRIu32, pp->hostname, pp->pid);
-    ddsrt_mutex_unlock (&disc_lock);
+    format_ppinfo (ppinfo, sizeof (ppinfo), pubhandle, pphandle);
+    const double mean = (double) y->sum / (double) y->cnt;
+    output_latency (record, ppinfo, size, mean, y->min, y->max, y->cnt, y->hist);
+    if (output_text ())
+    {
+      printf ("%s%s %s size %"PRIu32" mean %.3fus min %.3fus 50%% %.3fus 90%% %.3fus 99%% %.3fus max %.3fus cnt %"PRIu32"\n",
+              prefix, subprefix, ppinfo, size,
+              mean / 1e3,
+              (double) y->min / 1e3,
+              (double) hdrhist_percentile (y->hist, 50) / 1e3,
+              (double) hdrhist_percentile (y->hist, 90) / 1e3,
+              (double) hdrhist_percentile (y->hist, 99) / 1e3,
+              (double) y->max / 1e3,
+              y->cnt);
+    }
+    hdrhist_merge (y->tothist, y->hist);
+    hdrhist_reset (y->hist);
+  }
+  return y->hist;
+}
 
-    qsort (y->raw, rawcnt, sizeof (*y->raw), cmp_int64);
-    printf ("%s%s %s size %"PRIu32" mean %.3fus min %.3fus 50%% %.3fus 90%% %.3fus 99%% %.3fus max %.3fus cnt %"PRIu32"\n",
-            prefix, subprefix, ppinfo, size,
-            (double) y->sum / (double) y->cnt / 1e3,
-            (double) y->min / 1e3,
-            (double) y->raw[rawcnt - (rawcnt + 1) / 2] / 1e3,
-            (double) y->raw[rawcnt - (rawcnt + 9) / 10] / 1e3,
-            (double) y->raw[rawcnt - (rawcnt + 99) / 100] / 1e3,
-            (double) y->max / 1e3,
-            y->cnt);
+static void latencystat_print_summary (const struct latencystat *x, const char *prefix, const char *subprefix, const char *record, dds_instance_handle_t pubhandle, dds_instance_handle_t pphandle, uint32_t size)
+{
+  if (x->totcnt == 0)
+    return;
+  char ppinfo[128];
+  format_ppinfo (ppinfo, sizeof (ppinfo), pubhandle, pphandle);
+  const struct hdrhist *h = x->tothist;
+  const double mean = (double) x->totsum / (double) x->totcnt;
+  output_latency (record, ppinfo, size, mean, x->totmin, x->totmax, x->totcnt, h);
+  if (output_text ())
+  {
+    char line[512];
+    size_t pos = 0;
+    xsnprintf (line, sizeof (line), &pos, "%s%s total %s size %"PRIu32" mean %.3fus min %.3fus", prefix, subprefix, ppinfo, size, mean / 1e3, (double) x->totmin / 1e3);
+    for (size_t i = 0; i < sizeof (latency_percentiles) / sizeof (latency_percentiles[0]); i++)
+      xsnprintf (line, sizeof (line), &pos, " %g%% %.3fus", latency_percentiles[i], (double) hdrhist_percentile (h, latency_percentiles[i]) / 1e3);
+    xsnprintf (line, sizeof (line), &pos, " max %.3fus cnt %"PRIu64, (double) x->totmax / 1e3, x->totcnt);
+    if (hdrhist_count (h) != x->totcnt)
+      xsnprintf (line, sizeof (line), &pos, " corrected %"PRIu64, hdrhist_count (h));
+    puts (line);
   }
-  return y->raw;
 }
 
-static void latencystat_update (struct latencystat *x, int64_t tdelta)
+static void latencystat_update (struct latencystat *x, int64_t tdelta, int64_t expected_interval)
 {
   if (tdelta < x->min) x->min = tdelta;
   if (tdelta > x->max) x->max = tdelta;
   x->sum += tdelta;
-  if (x->cnt < PINGPONG_RAWSIZE)
-    x->raw[x->cnt] = tdelta;
   x->cnt++;
+  if (tdelta < x->totmin) x->totmin = tdelta;
+  if (tdelta > x->totmax) x->totmax = tdelta;
+  x->totsum += tdelta;
   x->totcnt++;
+  hdrhist_record_corrected (x->hist, tdelta, expected_interval);
 }
 
 static void init_eseq_admin (struct eseq_admin *ea, unsigned nkeys)
@@ -989,7 +1196,7 @@ static int check_eseq (struct eseq_admin *ea, uint32_t seq, uint32_t keyval, uin
       ea->stats[i].nlost += seq - e;
       ea->stats[i].last_size = size;
       if (sublatency)
-        latencystat_update (&ea->stats[i].info, tdelta);
+        latencystat_update (&ea->stats[i].info, tdelta, 0);
       ddsrt_mutex_unlock (&ea->lock);
       return seq == e;
     }
@@ -1017,7 +1224,7 @@ static int check_eseq (struct eseq_admin *ea, uint32_t seq, uint32_t keyval, uin
   if (sublatency)
   {
     latencystat_init (&ea->stats[ea->nph].info);
-    latencystat_update (&ea->stats[ea->nph].info, tdelta);
+    latencystat_update (&ea->stats[ea->nph].info, tdelta, 0);
   }
   ea->nph++;
   ddsrt_mutex_unlock (&ea->lock);
@@ -1039,10 +1246,14 @@ static bool update_roundtrip (dds_instance_handle_t pubhandle, int64_t tdelta, b
   {
     allseen = false;
   }
+  /* Pings sent at a fixed rate that got delayed by a stall hide the delay the pings
+     that should have been sent during the stall would have had (coordinated omission),
+     tdelta is half the round-trip time, so those would have been ping_intv/2 apart */
+  const int64_t expected_interval = (isping && ping_intv > 0 && ping_intv != DDS_INFINITY) ? ping_intv / 2 : 0;
   for (uint32_t i = 0; i < npongstat; i++)
     if (pongstat[i].pubhandle == pubhandle)
     {
-      latencystat_update (&pongstat[i].info, tdelta);
+      latencystat_update (&pongstat[i].info, tdelta, expected_interval);
       ddsrt_mutex_unlock (&pongstat_lock);
       return allseen;
     }
@@ -1054,7 +1265,7 @@ static bool update_roundtrip (dds_instance_handle_t pubhandle, int64_t tdelta, b
   x->pubhandle = pubhandle;
   x->pphandle = get_pphandle_for_pubhandle (pubhandle);
   latencystat_init (&x->info);
-  latencystat_update (&x->info, tdelta);
+  latencystat_update (&x->info, tdelta, expected_interval);
   npongstat++;
   ddsrt_mutex_unlock (&pongstat_lock);
   return allseen;
@@ -1424,6 +1635,93 @@ static void free_ppant (void *vpp)
   free (pp);
 }
 
+static void disctest_check_settled_locked (dds_time_t tnow)
+{
+  const uint32_t nppants = disctest.nprocs * disctest_nparticipants;
+  /* every local reader matches every writer on the same topic anywhere, and vice versa */
+  const int64_t nmatch = (int64_t) nppants * disctest_nparticipants * disctest_ntopics * disctest_nreaders * disctest_nwriters;
+  switch (disctest.phase)
+  {
+    case DISCTEST_IDLE:
+    case DISCTEST_JOINED:
+    case DISCTEST_LEFT:
+      break;
+    case DISCTEST_JOINING:
+      if (disctest.tppants == DDS_NEVER && disctest.nppants >= nppants)
+        disctest.tppants = tnow;
+      if (disctest.tppants != DDS_NEVER && disctest.rd_matched >= nmatch && disctest.wr_matched >= nmatch)
+      {
+        disctest.tsettled = tnow;
+        disctest.phase = DISCTEST_JOINED;
+      }
+      break;
+    case DISCTEST_LEAVING:
+      if (disctest.nppants == 0)
+      {
+        disctest.tppants = disctest.tsettled = tnow;
+        disctest.phase = DISCTEST_LEFT;
+      }
+      break;
+  }
+}
+
+static void disctest_participant_new (dds_instance_handle_t handle)
+{
+  ddsrt_avl_ipath_t ipath;
+  ddsrt_mutex_lock (&disctest.lock);
+  if (ddsrt_avl_lookup_ipath (&disctest_ppants_td, &disctest.ppants, &handle, &ipath) == NULL)
+  {
+    struct disctest_ppant *pp = malloc (sizeof (*pp));
+    assert (pp);
+    pp->handle = handle;
+    ddsrt_avl_insert_ipath (&disctest_ppants_td, &disctest.ppants, pp, &ipath);
+    disctest.nppants++;
+    disctest_check_settled_locked (dds_time ());
+  }
+  ddsrt_mutex_unlock (&disctest.lock);
+}
+
+static void disctest_participant_gone (dds_instance_handle_t handle)
+{
+  ddsrt_avl_dpath_t dpath;
+  struct disctest_ppant *pp;
+  ddsrt_mutex_lock (&disctest.lock);
+  if ((pp = ddsrt_avl_lookup_dpath (&disctest_ppants_td, &disctest.ppants, &handle, &dpath)) != NULL)
+  {
+    ddsrt_avl_delete_dpath (&disctest_ppants_td, &disctest.ppants, pp, &dpath);
+    free (pp);
+    disctest.nppants--;
+    disctest_check_settled_locked (dds_time ());
+  }
+  ddsrt_mutex_unlock (&disctest.lock);
+}
+
+static void disctest_subscription_matched_listener (dds_entity_t rd, const dds_subscription_matched_status_t status, void *arg)
+{
+  (void) rd;
+  (void) arg;
+  ddsrt_mutex_lock (&disctest.lock);
+  if (disctest.phase == DISCTEST_JOINING || disctest.phase == DISCTEST_JOINED)
+  {
+    disctest.rd_matched += status.current_count_change;
+    disctest_check_settled_locked (dds_time ());
+  }
+  ddsrt_mutex_unlock (&disctest.lock);
+}
+
+static void disctest_publication_matched_listener (dds_entity_t wr, const dds_publication_matched_status_t status, void *arg)
+{
+  (void) wr;
+  (void) arg;
+  ddsrt_mutex_lock (&disctest.lock);
+  if (disctest.phase == DISCTEST_JOINING || disctest.phase == DISCTEST_JOINED)
+  {
+    disctest.wr_matched += status.current_count_change;
+    disctest_check_settled_locked (dds_time ());
+  }
+  ddsrt_mutex_unlock (&disctest.lock);
+}
+
 static void async_participant_data_listener (dds_entity_t rd, void *arg)
 {
   dds_sample_info_t info;
@@ -1439,8 +1737,11 @@ static void async_participant_data_listener (dds_entity_t rd, void *arg)
     {
       ddsrt_avl_dpath_t dpath;
       dds_entity_t pong_wr_to_del = 0;
+      bool disctest_gone = false;
       ddsrt_mutex_lock (&disc_lock);
-      if ((pp = ddsrt_avl_lookup_dpath (&ppants_td, &ppants, &info.instance_handle, &dpath)) != NULL)
+      if ((pp = ddsrt_avl_lookup_dpath (&ppants_td, &ppants, &info.instance_handle, &dpath)) == NULL)
+        disctest_gone = (disctest_nparticipants > 0);
+      else
       {
         printf ("[%"PRIdPID"] participant %s:%"PRIu32": gone\n", ddsrt_getpid (), pp->hostname, pp->pid);
         fflush (stdout);
@@ -1458,6 +1759,8 @@ static void async_participant_data_listener (dds_entity_t rd, void *arg)
       }
       ddsrt_mutex_unlock (&disc_lock);
       dds_delete (pong_wr_to_del);
+      if (disctest_gone)
+        disctest_participant_gone (info.instance_handle);
     }
     else
     {
@@ -1472,7 +1775,9 @@ static void async_participant_data_listener (dds_entity_t rd, void *arg)
         const char *udata = vudata;
         int has_reader, pos;
         long pid;
-        if (sscanf (udata, UDATA_MAGIC "%d:%ld%n", &has_reader, &pid, &pos) == 2 && udata[pos] == ':' && strlen (udata + pos) == usz - (unsigned) pos)
+        if (disctest_nparticipants > 0 && usz >= UDATA_DISC_MAGIC_SIZE && memcmp (udata, UDATA_DISC_MAGIC, UDATA_DISC_MAGIC_SIZE) == 0)
+          disctest_participant_new (info.instance_handle);
+        else if (sscanf (udata, UDATA_MAGIC "%d:%ld%n", &has_reader, &pid, &pos) == 2 && udata[pos] == ':' && strlen (udata + pos) == usz - (unsigned) pos)
         {
           size_t sz = usz - (unsigned) pos;
           char *hostname = malloc (sz);
@@ -1669,17 +1974,17 @@ static bool print_stats (dds_time_t tref, dds_time_t tnow, dds_time_t tprev, str
   const double ts = (double) (tnow - tref) / 1e9;
   bool output = false;
   snprintf (prefix, sizeof (prefix), "[%"PRIdPID"] %.3f ", ddsrt_getpid (), ts);
+  output_set_time (ts);
 
   if (pub_rate > 0)
   {
     ddsrt_mutex_lock (&pubstat_lock);
-    hist_print (prefix, pubstat_hist, tnow - tprev, 1);
+    hist_print (prefix, "pub", pubstat_hist, tnow - tprev, 1);
     ddsrt_mutex_unlock (&pubstat_lock);
     output = true;
   }
 
-  int64_t *newraw = malloc (PINGPONG_RAWSIZE * sizeof (*newraw));
-  assert(newraw);
+  struct hdrhist *newhist = hdrhist_new ();
   if (submode != SM_NONE)
   {
     struct eseq_admin * const ea = &eseq_admin;
@@ -1712,10 +2017,20 @@ static bool print_stats (dds_time_t tref, dds_time_t tnow, dds_time_t tprev, str
     if (nrecv > 0 || substat_every_second)
     {
       const double dt = (double) (tnow - tprev);
-      printf ("%s size %"PRIu32" total %"PRIu64" lost %"PRIu64" delta %"PRIu64" lost %"PRIu64" rate %.2f kS/s %.2f Mb/s (%.2f kS/s %.2f Mb/s)\n",
-              prefix, last_size, tot_nrecv, tot_nlost, nrecv, nlost,
-              (double) nrecv * 1e6 / dt, (double) nrecv_bytes * 8 * 1e3 / dt,
-              (double) nrecv10s * 1e6 / (10 * dt), (double) nrecv10s_bytes * 8 * 1e3 / (10 * dt));
+      output_begin ("sub", NULL);
+      output_value ("size", last_size);
+      output_value ("total", (double) tot_nrecv);
+      output_value ("lost", (double) tot_nlost);
+      output_value ("delta", (double) nrecv);
+      output_value ("deltalost", (double) nlost);
+      output_value ("rate", (double) nrecv * 1e9 / dt);
+      output_value ("bitrate", (double) nrecv_bytes * 8 * 1e9 / dt);
+      output_end ();
+      if (output_text ())
+        printf ("%s size %"PRIu32" total %"PRIu64" lost %"PRIu64" delta %"PRIu64" lost %"PRIu64" rate %.2f kS/s %.2f Mb/s (%.2f kS/s %.2f Mb/s)\n",
+                prefix, last_size, tot_nrecv, tot_nlost, nrecv, nlost,
+                (double) nrecv * 1e6 / dt, (double) nrecv_bytes * 8 * 1e3 / dt,
+                (double) nrecv10s * 1e6 / (10 * dt), (double) nrecv10s_bytes * 8 * 1e3 / (10 * dt));
       output = true;
     }
 
@@ -1726,13 +2041,13 @@ static bool print_stats (dds_time_t tref, dds_time_t tnow, dds_time_t tprev, str
       {
         struct eseq_stat * const x = &ea->stats[i];
         struct latencystat y = x->info;
-        latencystat_reset (&x->info, newraw);
+        latencystat_reset (&x->info, newhist);
         /* pongwr entries get added at the end, npongwr only grows: so can safely
          unlock the stats in between nodes for calculating percentiles */
         ddsrt_mutex_unlock (&ea->lock);
         if (y.cnt > 0)
           output = true;
-        newraw = latencystat_print (&y, prefix, " sublat", ea->ph[i], ea->pph[i], x->last_size);
+        newhist = latencystat_print (&y, prefix, " sublat", "sublat", ea->ph[i], ea->pph[i], x->last_size);
         ddsrt_mutex_lock (&ea->lock);
       }
       ddsrt_mutex_unlock (&ea->lock);
@@ -1744,17 +2059,17 @@ static bool print_stats (dds_time_t tref, dds_time_t tnow, dds_time_t tprev, str
   {
     struct subthread_arg_pongstat * const x = &pongstat[i];
     struct subthread_arg_pongstat y = *x;
-    latencystat_reset (&x->info, newraw);
+    latencystat_reset (&x->info, newhist);
     /* pongstat entries get added at the end, npongstat only grows: so can safely
        unlock the stats in between nodes for calculating percentiles */
     ddsrt_mutex_unlock (&pongstat_lock);
     if (y.info.cnt > 0)
       output = true;
-    newraw = latencystat_print (&y.info, prefix, "", y.pubhandle, y.pphandle, topic_payload_size (topicsel, baggagesize));
+    newhist = latencystat_print (&y.info, prefix, "", "roundtrip", y.pubhandle, y.pphandle, topic_payload_size (topicsel, baggagesize));
     ddsrt_mutex_lock (&pongstat_lock);
   }
   ddsrt_mutex_unlock (&pongstat_lock);
-  free (newraw);
+  hdrhist_free (newhist);
 
   if (record_cputime (cputime_state, prefix, tnow))
     output = true;
@@ -1796,13 +2111,295 @@ static bool print_stats (dds_time_t tref, dds_time_t tnow, dds_time_t tprev, str
   {
     (void) dds_refresh_statistics (stats->substat);
     (void) dds_refresh_statistics (stats->pubstat);
-    printf ("%s discarded %"PRIu64" rexmit %"PRIu64" Trexmit %"PRIu64" Tthrottle %"PRIu64" Nthrottle %"PRIu32"\n", prefix, stats->discarded_bytes->u.u64, stats->rexmit_bytes->u.u64, stats->time_rexmit->u.u64, stats->time_throttle->u.u64, stats->throttle_count->u.u32);
+    output_begin ("ddsi", NULL);
+    output_value ("discarded", (double) stats->discarded_bytes->u.u64);
+    output_value ("rexmit", (double) stats->rexmit_bytes->u.u64);
+    output_value ("Trexmit", (double) stats->time_rexmit->u.u64);
+    output_value ("Tthrottle", (double) stats->time_throttle->u.u64);
+    output_value ("Nthrottle", (double) stats->throttle_count->u.u32);
+    output_end ();
+    if (output_text ())
+      printf ("%s discarded %"PRIu64" rexmit %"PRIu64" Trexmit %"PRIu64" Tthrottle %"PRIu64" Nthrottle %"PRIu32"\n", prefix, stats->discarded_bytes->u.u64, stats->rexmit_bytes->u.u64, stats->time_rexmit->u.u64, stats->time_throttle->u.u64, stats->throttle_count->u.u32);
   }
 
   fflush (stdout);
+  output_flush ();
   return output;
 }
 
+static void print_latency_summary (dds_time_t tref)
+{
+  /* only called once all threads and listeners that update the statistics are gone */
+  char prefix[128];
+  const double ts = (tref == DDS_INFINITY) ? 0.0 : (double) (dds_time () - tref) / 1e9;
+  snprintf (prefix, sizeof (prefix), "[%"PRIdPID"] %.3f ", ddsrt_getpid (), ts);
+  output_set_time (ts);
+  if (sublatency)
+  {
+    for (uint32_t i = 0; i < eseq_admin.nph; i++)
+    {
+      struct eseq_stat * const x = &eseq_admin.stats[i];
+      hdrhist_merge (x->info.tothist, x->info.hist);
+      latencystat_print_summary (&x->info, prefix, " sublat", "sublat_total", eseq_admin.ph[i], eseq_admin.pph[i], x->last_size);
+    }
+  }
+  for (uint32_t i = 0; i < npongstat; i++)
+  {
+    struct subthread_arg_pongstat * const x = &pongstat[i];
+    hdrhist_merge (x->info.tothist, x->info.hist);
+    latencystat_print_summary (&x->info, prefix, "", "roundtrip_total", x->pubhandle, x->pphandle, topic_payload_size (topicsel, baggagesize));
+  }
+  fflush (stdout);
+  output_flush ();
+}
+
+/* Discovery scale test: re-checking every 10ms while joining/leaving, so the CPU
+   time and network traffic get sampled shortly after the system settled */
+#define DISCTEST_POLL_INTV DDS_MSECS (10)
+
+static void disctest_init (void)
+{
+  ddsrt_mutex_init (&disctest.lock);
+  ddsrt_avl_init (&disctest_ppants_td, &disctest.ppants);
+  disctest.phase = DISCTEST_IDLE;
+  disctest.nprocs = 0;
+  disctest.dps = calloc (disctest_nparticipants > 0 ? disctest_nparticipants : 1, sizeof (*disctest.dps));
+  assert (disctest.dps);
+  disctest.nppants = 0;
+  disctest.join = (struct disctest_phasestat) { 0, 0.0, 0.0 };
+  disctest.leave = (struct disctest_phasestat) { 0, 0.0, 0.0 };
+}
+
+static dds_time_t disctest_cputime (void)
+{
+#if DDSRT_HAVE_RUSAGE
+  ddsrt_rusage_t usage;
+  if (ddsrt_getrusage (DDSRT_RUSAGE_SELF, &usage) == DDS_RETCODE_OK)
+    return usage.utime + usage.stime;
+#endif
+  return 0;
+}
+
+static void disctest_start_phase (enum disctest_phase phase, dds_time_t tnow, struct record_netload_state *netload_state)
+{
+  disctest.reported = false;
+  disctest.cputime_start = disctest_cputime ();
+  disctest.netload_valid = record_netload_counters (netload_state, &disctest.netload_start);
+  ddsrt_mutex_lock (&disctest.lock);
+  disctest.phase = phase;
+  disctest.tstart = tnow;
+  disctest.tppants = disctest.tsettled = DDS_NEVER;
+  disctest.rd_matched = disctest.wr_matched = 0;
+  ddsrt_mutex_unlock (&disctest.lock);
+}
+
+static void disctest_join (dds_time_t tnow, struct record_netload_state *netload_state)
+{
+  dds_listener_t *listener;
+  dds_qos_t *qos;
+  char udata[64];
+  disctest_start_phase (DISCTEST_JOINING, tnow, netload_state);
+  qos = dds_create_qos ();
+  (void) snprintf (udata, sizeof (udata), UDATA_DISC_MAGIC"%"PRIdPID, ddsrt_getpid ());
+  dds_qset_userdata (qos, udata, strlen (udata));
+  /* readers and writers inherit the participant's listener */
+  listener = dds_create_listener (NULL);
+  dds_lset_subscription_matched (listener, disctest_subscription_matched_listener);
+  dds_lset_publication_matched (listener, disctest_publication_matched_listener);
+  for (uint32_t i = 0; i < disctest_nparticipants; i++)
+  {
+    dds_entity_t pp;
+    if ((pp = dds_create_participant (did, qos, listener)) < 0)
+      error2 ("dds_create_participant(disc %"PRIu32") failed: %d\n", i, (int) pp);
+    disctest.dps[i] = pp;
+    for (uint32_t j = 0; j < disctest_ntopics; j++)
+    {
+      char tpname[32];
+      dds_entity_t tp, ep;
+      (void) snprintf (tpname, sizeof (tpname), "DDSPerfDisc%"PRIu32, j);
+      if ((tp = dds_create_topic (pp, &OneULong_desc, tpname, NULL, NULL)) < 0)
+        error2 ("dds_create_topic(%s) failed: %d\n", tpname, (int) tp);
+      for (uint32_t k = 0; k < disctest_nreaders; k++)
+        if ((ep = dds_create_reader (pp, tp, NULL, NULL)) < 0)
+          error2 ("dds_create_reader(%s) failed: %d\n", tpname, (int) ep);
+      for (uint32_t k = 0; k < disctest_nwriters; k++)
+        if ((ep = dds_create_writer (pp, tp, NULL, NULL)) < 0)
+          error2 ("dds_create_writer(%s) failed: %d\n", tpname, (int) ep);
+    }
+  }
+  dds_delete_listener (listener);
+  dds_delete_qos (qos);
+}
+
+static void disctest_delete_participants (void)
+{
+  for (uint32_t i = 0; i < disctest_nparticipants; i++)
+  {
+    if (disctest.dps[i] > 0)
+      dds_delete (disctest.dps[i]);
+    disctest.dps[i] = 0;
+  }
+}
+
+static void disctest_leave (dds_time_t tnow, struct record_netload_state *netload_state)
+{
+  /* matched listeners are ignored while leaving: settling is determined by the
+     disappearance of all participants from DCPSParticipant */
+  disctest_start_phase (DISCTEST_LEAVING, tnow, netload_state);
+  disctest_delete_participants ();
+  ddsrt_mutex_lock (&disctest.lock);
+  disctest_check_settled_locked (dds_time ());
+  ddsrt_mutex_unlock (&disctest.lock);
+}
+
+static void disctest_phasestat_update (struct disctest_phasestat *x, double t)
+{
+  x->n++;
+  x->sum += t;
+  if (t > x->max)
+    x->max = t;
+}
+
+static void disctest_report (dds_time_t tref, dds_time_t tnow, bool joined, struct record_netload_state *netload_state)
+{
+  const char *what = joined ? "join" : "leave";
+  const double ts = (double) (tnow - tref) / 1e9;
+  const double tsettle = (double) (disctest.tsettled - disctest.tstart) / 1e9;
+  const double tppants = (double) (disctest.tppants - disctest.tstart) / 1e9;
+  const uint32_t nppants = disctest.nprocs * disctest_nparticipants;
+  const uint64_t nendpoints = (uint64_t) nppants * disctest_ntopics * (disctest_nreaders + disctest_nwriters);
+  const double cputime = (double) (disctest_cputime () - disctest.cputime_start) / 1e9;
+  const double cpu_per_ep = (nendpoints > 0) ? cputime / (double) nendpoints : 0.0;
+  struct netload_counters nl;
+  const bool nl_valid = disctest.netload_valid && record_netload_counters (netload_state, &nl);
+  disctest_phasestat_update (joined ? &disctest.join : &disctest.leave, tsettle);
+
+  output_set_time (ts);
+  if (output_text ())
+  {
+    printf ("[%"PRIdPID"] %.3f disc %s: %"PRIu32" participants %"PRIu64" endpoints settled in %.3fs",
+            ddsrt_getpid (), ts, what, nppants, nendpoints, tsettle);
+    if (joined)
+      printf (" (participants %.3fs)", tppants);
+    printf (" cpu %.3fs (%.1fus/endpoint)", cputime, 1e6 * cpu_per_ep);
+    if (nl_valid)
+      printf (" xmit %"PRIu64"B %"PRIu64"pkt recv %"PRIu64"B %"PRIu64"pkt",
+              nl.obytes - disctest.netload_start.obytes, nl.opkt - disctest.netload_start.opkt,
+              nl.ibytes - disctest.netload_start.ibytes, nl.ipkt - disctest.netload_start.ipkt);
+    printf ("\n");
+  }
+  output_begin (joined ? "disc_join" : "disc_leave", NULL);
+  output_value ("settle", tsettle);
+  output_value ("participants_settle", tppants);
+  output_value ("participants", nppants);
+  output_value ("endpoints", (double) nendpoints);
+  output_value ("cpu", cputime);
+  output_value ("cpu_per_endpoint", cpu_per_ep);
+  if (nl_valid)
+  {
+    output_value ("xmit_bytes", (double) (nl.obytes - disctest.netload_start.obytes));
+    output_value ("xmit_packets", (double) (nl.opkt - disctest.netload_start.opkt));
+    output_value ("recv_bytes", (double) (nl.ibytes - disctest.netload_start.ibytes));
+    output_value ("recv_packets", (double) (nl.ipkt - disctest.netload_start.ipkt));
+  }
+  output_end ();
+  fflush (stdout);
+  output_flush ();
+}
+
+/* Drives the discovery scale test from the main loop, returns when it next needs attention */
+static dds_time_t disctest_step (dds_time_t tref, dds_time_t tnow, struct record_netload_state *netload_state)
+{
+  enum disctest_phase phase;
+  dds_time_t tsettled;
+  ddsrt_mutex_lock (&disctest.lock);
+  phase = disctest.phase;
+  tsettled = disctest.tsettled;
+  ddsrt_mutex_unlock (&disctest.lock);
+  switch (phase)
+  {
+    case DISCTEST_IDLE: {
+      /* every ddsperf process discovered by now is expected to create as many participants
+         as we do: -Qminmatch:N with -Qinitwait:DUR ensures they have all been found */
+      ddsrt_avl_iter_t it;
+      disctest.nprocs = 0;
+      ddsrt_mutex_lock (&disc_lock);
+      for (struct ppant *pp = ddsrt_avl_iter_first (&ppants_td, &ppants, &it); pp; pp = ddsrt_avl_iter_next (&it))
+        disctest.nprocs++;
+      ddsrt_mutex_unlock (&disc_lock);
+      disctest_join (tnow, netload_state);
+      break;
+    }
+    case DISCTEST_JOINING:
+    case DISCTEST_LEAVING:
+      break;
+    case DISCTEST_JOINED:
+    case DISCTEST_LEFT:
+      if (!disctest.reported)
+      {
+        disctest_report (tref, tnow, phase == DISCTEST_JOINED, netload_state);
+        disctest.reported = true;
+        disctest.tnext = (disctest_cycle > 0) ? tsettled + (dds_duration_t) (disctest_cycle * 1e9) : DDS_NEVER;
+      }
+      if (tnow < disctest.tnext)
+        return disctest.tnext;
+      else if (phase == DISCTEST_JOINED)
+        disctest_leave (tnow, netload_state);
+      else
+        disctest_join (tnow, netload_state);
+      break;
+  }
+  return tnow + DISCTEST_POLL_INTV;
+}
+
+/* Deletes the participants and prints a summary, returns false if the initial join never
+   settled */
+static bool disctest_stop (dds_time_t tref)
+{
+  const double ts = (tref == DDS_INFINITY) ? 0.0 : (double) (dds_time () - tref) / 1e9;
+  const uint32_t nppants = disctest.nprocs * disctest_nparticipants;
+  const int64_t nmatch = (int64_t) nppants * disctest_nparticipants * disctest_ntopics * disctest_nreaders * disctest_nwriters;
+  ddsrt_mutex_lock (&disctest.lock);
+  const enum disctest_phase phase = disctest.phase;
+  const uint32_t nseen = disctest.nppants;
+  const int64_t rd_matched = disctest.rd_matched, wr_matched = disctest.wr_matched;
+  disctest.phase = DISCTEST_IDLE;
+  ddsrt_mutex_unlock (&disctest.lock);
+  disctest_delete_participants ();
+
+  output_set_time (ts);
+  if (phase == DISCTEST_JOINING)
+    printf ("[%"PRIdPID"] %.3f disc join: not settled: %"PRIu32"/%"PRIu32" participants, %"PRId64"/%"PRId64" reader and %"PRId64"/%"PRId64" writer matches\n",
+            ddsrt_getpid (), ts, nseen, nppants, rd_matched, nmatch, wr_matched, nmatch);
+  else if (phase == DISCTEST_LEAVING)
+    printf ("[%"PRIdPID"] %.3f disc leave: not settled: %"PRIu32" participants remaining\n", ddsrt_getpid (), ts, nseen);
+  const struct disctest_phasestat * const xs[] = { &disctest.join, &disctest.leave };
+  const char *names[] = { "join", "leave" };
+  for (size_t i = 0; i < sizeof (xs) / sizeof (xs[0]); i++)
+  {
+    if (xs[i]->n == 0)
+      continue;
+    if (output_text ())
+      printf ("[%"PRIdPID"] %.3f disc %s summary: %"PRIu32" times settled in mean %.3fs max %.3fs\n",
+              ddsrt_getpid (), ts, names[i], xs[i]->n, xs[i]->sum / xs[i]->n, xs[i]->max);
+    output_begin (i == 0 ? "disc_join_total" : "disc_leave_total", NULL);
+    output_value ("count", xs[i]->n);
+    output_value ("mean", xs[i]->sum / xs[i]->n);
+    output_value ("max", xs[i]->max);
+    output_end ();
+  }
+  fflush (stdout);
+  output_flush ();
+  return disctest_nparticipants == 0 || disctest.join.n > 0;
+}
+
+static void disctest_fini (void)
+{
+  ddsrt_avl_free (&disctest_ppants_td, &disctest.ppants, free);
+  free (disctest.dps);
+  ddsrt_mutex_destroy (&disctest.lock);
+}
+
 static void subthread_arg_init (struct subthread_arg *arg, dds_entity_t rd, uint32_t max_samples)
 {
   arg->rd = rd;
@@ -1922,6 +2519,10 @@ OPTIONS:\n\
   -1                  print \"sub\" stats every second, even when there is\n\
                       data\n\
   -X                  output extended statistics\n\
+  -O FMT[:FILE]       also write the statistics in a machine-readable format\n\
+                      to FILE: FMT is json (an object per line) or csv (a\n\
+                      line per value); if FILE is \"-\" or omitted, they are\n\
+                      written to stdout instead of the text statistics\n\
   -i ID               use domain ID instead of the default domain\n\
 \n\
 MODE... is zero or more of:\n\
@@ -1929,6 +2530,8 @@ MODE... is zero or more of:\n\
     Send a ping upon receiving all expected pongs, or send a ping at\n\
     rate R (optionally suffixed with Hz/kHz).  The triggering mode is either\n\
     a listener (default, unless -L has been specified) or a waitset.\n\
+    Latency percentiles at rate R are corrected for coordinated omission;\n\
+    the full percentile spectrum for the whole run is printed at the end.\n\
   pong [waitset|listener]\n\
     A \"dummy\" mode that serves two purposes: configuring the triggering.\n\
     mode (but it is shared with ping's mode), and suppressing the 1Hz ping\n\
@@ -1936,7 +2539,7 @@ MODE... is zero or more of:\n\
   sub [waitset|listener|polling]\n\
     Subscribe to data, with calls to take occurring either in a listener\n\
     (default), when a waitset is triggered, or by polling at 1kHz.\n\
-  pub [R[Hz]] [size S] [burst N] [[ping] X%%] [loan]\n\
+  pub [R[Hz]] [size S] [burst N] [[ping] X%%] [loan] [batch]\n\
     Publish bursts of data at rate R, optionally suffixed with Hz/kHz.  If\n\
     no rate is given or R is \"inf\", data is published as fast as\n\
     possible.  Each burst is a single sample by default, but can be set\n\
@@ -1945,7 +2548,19 @@ MODE... is zero or more of:\n\
     If desired, a fraction of the samples can be treated as if it were a\n\
     ping, for this, specify a percentage either as \"ping X%%\" (the\n\
     \"ping\" keyword is optional, the %% sign is not).  \"loan\" uses\n\
-    loans on the writer.\n\
+    loans on the writer.  \"batch\" writes each burst using a single call\n\
+    to dds_write_batch instead of a call to dds_write for each sample.\n\
+  disc [participants P] [topics T] [readers R] [writers W] [cycle DUR]\n\
+    Discovery scale test: create P participants (default 1), each with T\n\
+    topics and R readers and W writers per topic (default 1), and report\n\
+    how long it takes until all participants of all ddsperf processes have\n\
+    been discovered and all readers and writers matched, along with the\n\
+    CPU time per endpoint and, with -d, the network traffic.  All ddsperf\n\
+    processes must use the same parameters; those not discovered before\n\
+    starting are not taken into account, so use -Qminmatch and\n\
+    -Qinitwait to start all of them at the same time.  With \"cycle DUR\"\n\
+    all participants are deleted DUR seconds after settling and recreated\n\
+    DUR seconds after all have disappeared, over and over again.\n\
 \n\
   Payload size (including fixed part of topic) may be set as part of a\n\
   \"ping\" or \"pub\" specification for topic KS (there is only size,\n\
@@ -1968,6 +2583,8 @@ EXAMPLES:\n\
   ddsperf -L -TOU -D10 pub sub\n\
     basic throughput test within the process with tiny, keyless samples,\n\
     running for 10s\n\
+  ddsperf -Qminmatch:2 -Qinitwait:10 -d eth0 disc participants 10 topics 20 cycle 5\n\
+    discovery scale test, run three of these at the same time\n\
 ", argv0, argv0, argv0);
   fflush (stdout);
   exit (3);
@@ -1983,6 +2600,7 @@ static const struct string_int_map_elem modestrings[] = {
   { "pong", 2 },
   { "sub", 3 },
   { "pub", 4 },
+  { "disc", 5 },
   { NULL, 0 }
 };
 
@@ -2181,6 +2799,10 @@ static void set_mode_pub (int *xoptind, int xargc, char * const xargv[])
     {
       use_writer_loan = true;
     }
+    else if (strcmp (xargv[*xoptind], "batch") == 0)
+    {
+      use_write_batch = true;
+    }
     else
     {
       error3 ("%s: unrecognised publish specification\n", xargv[*xoptind]);
@@ -2189,6 +2811,38 @@ static void set_mode_pub (int *xoptind, int xargc, char * const xargv[])
   }
 }
 
+static void set_mode_disc (int *xoptind, int xargc, char * const xargv[])
+{
+  disctest_nparticipants = 1;
+  disctest_ntopics = disctest_nreaders = disctest_nwriters = 1;
+  disctest_cycle = 0;
+  while (*xoptind < xargc && exact_string_int_map_lookup (modestrings, "mode string", xargv[*xoptind], false) == -1)
+  {
+    int pos = 0;
+    if (set_simple_uint32 (xoptind, xargc, xargv, "participants", NULL, &disctest_nparticipants) ||
+        set_simple_uint32 (xoptind, xargc, xargv, "topics", NULL, &disctest_ntopics) ||
+        set_simple_uint32 (xoptind, xargc, xargv, "readers", NULL, &disctest_nreaders) ||
+        set_simple_uint32 (xoptind, xargc, xargv, "writers", NULL, &disctest_nwriters))
+    {
+      /* no further work needed */
+    }
+    else if (strcmp (xargv[*xoptind], "cycle") == 0)
+    {
+      if (++(*xoptind) == xargc)
+        error3 ("argument missing in cycle specification\n");
+      if (sscanf (xargv[*xoptind], "%lf%n", &disctest_cycle, &pos) != 1 || xargv[*xoptind][pos] != 0 || disctest_cycle < 0)
+        error3 ("%s: invalid cycle specification\n", xargv[*xoptind]);
+    }
+    else
+    {
+      error3 ("%s: unrecognised discovery test specification\n", xargv[*xoptind]);
+    }
+    (*xoptind)++;
+  }
+  if (disctest_nparticipants == 0)
+    error3 ("disc: number of participants must be at least 1\n");
+}
+
 static void set_mode (int xoptind, int xargc, char * const xargv[])
 {
   int code;
@@ -2206,6 +2860,7 @@ static void set_mode (int xoptind, int xargc, char * const xargv[])
       case 2: set_mode_pong (&xoptind, xargc, xargv); break;
       case 3: set_mode_sub (&xoptind, xargc, xargv); break;
       case 4: set_mode_pub (&xoptind, xargc, xargv); break;
+      case 5: set_mode_disc (&xoptind, xargc, xargv); break;
     }
   }
   if (xoptind != xargc)
@@ -2263,7 +2918,7 @@ int main (int argc, char *argv[])
 
   argv0 = argv[0];
 
-  while ((opt = getopt (argc, argv, "1cd:D:i:n:k:ulLK:T:Q:R:Xh")) != EOF)
+  while ((opt = getopt (argc, argv, "1cd:D:i:n:k:ulLK:O:T:Q:R:Xh")) != EOF)
   {
     int pos;
     switch (opt)
@@ -2330,6 +2985,10 @@ int main (int argc, char *argv[])
         break;
       }
       case 'X': extended_stats = true; break;
+      case 'O':
+        if (!output_init (optarg))
+          error3 ("-O %s: expected json|csv[:FILE] with FILE writable\n", optarg);
+        break;
       case 'R': {
         tref = 0;
         if (sscanf (optarg, "%"SCNd64"%n", &tref, &pos) != 1 || optarg[pos] != 0)
@@ -2360,6 +3019,8 @@ int main (int argc, char *argv[])
     error3 ("size %"PRIu32" invalid: only topic KS has a sequence\n", baggagesize);
   if (topicsel == KS && use_writer_loan)
     error3 ("topic KS is not supported with writer loans because it contains a sequence\n");
+  if (use_writer_loan && use_write_batch)
+    error3 ("writer loans and batch writes are mutually exclusive\n");
   if (baggagesize != 0 && baggagesize < 12)
     error3 ("size %"PRIu32" invalid: too small to allow for overhead\n", baggagesize);
   else if (baggagesize > 0)
@@ -2389,6 +3050,7 @@ int main (int argc, char *argv[])
   ddsrt_mutex_init (&pongstat_lock);
   ddsrt_mutex_init (&pongwr_lock);
   ddsrt_mutex_init (&pubstat_lock);
+  disctest_init ();
 
   pubstat_hist = hist_new (30, 1000, 0);
 
@@ -2732,6 +3394,13 @@ int main (int argc, char *argv[])
       ddsrt_mutex_unlock (&disc_lock);
     }
 
+    if (disctest_nparticipants > 0)
+    {
+      const dds_time_t tdisctest = disctest_step (tref, tnow, netload_state);
+      if (tdisctest < twakeup)
+        twakeup = tdisctest;
+    }
+
     /* next wakeup should be when the next event occurs */
     if (tnext < twakeup)
       twakeup = tnext;
@@ -2836,6 +3505,9 @@ err_minmatch_wait:
      to let it make progress once room is available again.  */
   dds_delete (rd_data);
 
+  print_latency_summary (tref);
+  const bool disctest_ok = disctest_stop (tref);
+
   uint64_t nlost = 0;
   bool received_ok = true;
   for (uint32_t i = 0; i < eseq_admin.nph; i++)
@@ -2855,6 +3527,7 @@ err_minmatch_wait:
   // have a publication_matched listener.
   async_listener_stop (async_listener);
   async_listener_free (async_listener);
+  disctest_fini ();
 
   ddsrt_mutex_destroy (&disc_lock);
   ddsrt_mutex_destroy (&pongwr_lock);
@@ -2892,6 +3565,11 @@ err_minmatch_wait:
     printf ("[%"PRIdPID"] error: too few matching participants (%"PRIu32")\n", ddsrt_getpid (), matchcount);
     ok = false;
   }
+  if (!disctest_ok)
+  {
+    printf ("[%"PRIdPID"] error: discovery did not settle\n", ddsrt_getpid ());
+    ok = false;
+  }
   if (nlost > 0 && (reliable && histdepth == 0))
   {
     printf ("[%"PRIdPID"] error: %"PRIu64" samples lost\n", ddsrt_getpid (), nlost);
@@ -2918,6 +3596,8 @@ err_minmatch_wait:
     ok = false;
   }
 
+  output_fini ();
+
   if (livemem_check)
   {
     printf ("[%"PRIdPID"] note: livemem init %.1fMB peak %.1fMB final %.1fMB\n", ddsrt_getpid (), livemem_init / 1048576.0, (double) ddsrt_atomic_ld32 (&ddsperf_malloc_peak) / 1048576.0, livemem_final / 1048576.0);
@@ -0,0 +1,148 @@
+// Copyright(c) 2025 ZettaScale Technology and others
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License v. 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Eclipse Distribution License
+// v. 1.0 which is available at
+// http://www.eclipse.org/org/documents/edl-v10.php.
+//
+// SPDX-License-Identifier: EPL-2.0 OR BSD-3-Clause
+
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#include "hdrhist.h"
+
+/* Bucket 0 covers [0,2048) in steps of 1, bucket b > 0 covers [1024 << b, 2048 << b)
+   in steps of 1 << b: that's a relative error of less than 1/1024 everywhere.  The
+   lower half of bucket b > 0 coincides with bucket b-1, so only the upper half is
+   stored.  26 buckets makes the maximum 2048 << 25 ns, about 68.7s. */
+#define SUBBUCKET_HALF_MAG 10
+#define SUBBUCKET_HALF (1u << SUBBUCKET_HALF_MAG)
+#define SUBBUCKET_MASK ((uint64_t) 2 * SUBBUCKET_HALF - 1)
+#define NBUCKETS 26
+#define NCOUNTS ((NBUCKETS + 1) * SUBBUCKET_HALF)
+#define MAXVALUE (((uint64_t) 2 * SUBBUCKET_HALF << (NBUCKETS - 1)) - 1)
+
+struct hdrhist {
+  uint64_t total;
+  uint64_t min, max;
+  uint64_t counts[NCOUNTS];
+};
+
+static uint32_t floor_log2 (uint64_t x)
+{
+  assert (x != 0);
+#if defined __GNUC__ || defined __clang__
+  return 63 - (uint32_t) __builtin_clzll (x);
+#else
+  uint32_t n = 0;
+  while (x >>= 1)
+    n++;
+  return n;
+#endif
+}
+
+static uint32_t counts_index (uint64_t x)
+{
+  const uint32_t bucket = floor_log2 (x | SUBBUCKET_MASK) - SUBBUCKET_HALF_MAG;
+  const uint32_t subbucket = (uint32_t) (x >> bucket);
+  return ((bucket + 1) << SUBBUCKET_HALF_MAG) + subbucket - SUBBUCKET_HALF;
+}
+
+static uint64_t highest_equivalent_value (uint32_t idx)
+{
+  int32_t bucket = (int32_t) (idx >> SUBBUCKET_HALF_MAG) - 1;
+  uint64_t subbucket = (idx & (SUBBUCKET_HALF - 1)) + SUBBUCKET_HALF;
+  if (bucket < 0)
+  {
+    subbucket -= SUBBUCKET_HALF;
+    bucket = 0;
+  }
+  return ((subbucket + 1) << bucket) - 1;
+}
+
+struct hdrhist *hdrhist_new (void)
+{
+  struct hdrhist *h = malloc (sizeof (*h));
+  assert (h);
+  hdrhist_reset (h);
+  return h;
+}
+
+void hdrhist_free (struct hdrhist *h)
+{
+  free (h);
+}
+
+void hdrhist_reset (struct hdrhist *h)
+{
+  h->total = 0;
+  h->min = UINT64_MAX;
+  h->max = 0;
+  memset (h->counts, 0, sizeof (h->counts));
+}
+
+static void record1 (struct hdrhist *h, uint64_t x)
+{
+  if (x > MAXVALUE)
+    x = MAXVALUE;
+  if (x < h->min)
+    h->min = x;
+  if (x > h->max)
+    h->max = x;
+  h->counts[counts_index (x)]++;
+  h->total++;
+}
+
+void hdrhist_record (struct hdrhist *h, int64_t x)
+{
+  record1 (h, (x < 0) ? 0 : (uint64_t) x);
+}
+
+void hdrhist_record_corrected (struct hdrhist *h, int64_t x, int64_t expected_interval)
+{
+  hdrhist_record (h, x);
+  if (expected_interval <= 0)
+    return;
+  for (int64_t y = x - expected_interval; y >= expected_interval; y -= expected_interval)
+    record1 (h, (uint64_t) y);
+}
+
+void hdrhist_merge (struct hdrhist *dst, const struct hdrhist *src)
+{
+  if (src->total == 0)
+    return;
+  for (uint32_t i = 0; i < NCOUNTS; i++)
+    dst->counts[i] += src->counts[i];
+  dst->total += src->total;
+  if (src->min < dst->min)
+    dst->min = src->min;
+  if (src->max > dst->max)
+    dst->max = src->max;
+}
+
+uint64_t hdrhist_count (const struct hdrhist *h)
+{
+  return h->total;
+}
+
+int64_t hdrhist_percentile (const struct hdrhist *h, double pct)
+{
+  if (h->total == 0)
+    return 0;
+  uint64_t target = (uint64_t) (pct / 100.0 * (double) h->total + 0.5);
+  if (target < 1)
+    target = 1;
+  else if (target > h->total)
+    target = h->total;
+  uint64_t acc = 0;
+  uint32_t i;
+  for (i = 0; i < NCOUNTS - 1; i++)
+    if ((acc += h->counts[i]) >= target)
+      break;
+  // report the upper end of the bin, but never beyond what was actually observed
+  const uint64_t x = highest_equivalent_value (i);
+  return (int64_t) ((x < h->min) ? h->min : (x > h->max) ? h->max : x);
+}
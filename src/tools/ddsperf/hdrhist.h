@@ -0,0 +1,38 @@
+// Copyright(c) 2025 ZettaScale Technology and others
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License v. 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Eclipse Distribution License
+// v. 1.0 which is available at
+// http://www.eclipse.org/org/documents/edl-v10.php.
+//
+// SPDX-License-Identifier: EPL-2.0 OR BSD-3-Clause
+
+#ifndef HDRHIST_H
+#define HDRHIST_H
+
+#include <stdint.h>
+
+/* High dynamic range histogram of latencies in nanoseconds: log-linear bins
+   covering 0 .. ~68s with 3 significant digits, so that percentiles far out
+   into the tail are accurate without having to keep all samples.  Values out
+   of range are clamped. */
+struct hdrhist;
+
+struct hdrhist *hdrhist_new (void);
+void hdrhist_free (struct hdrhist *h);
+void hdrhist_reset (struct hdrhist *h);
+void hdrhist_record (struct hdrhist *h, int64_t x);
+
+/* Records x, and if x exceeds the expected interval between samples, also
+   the values that the samples that should have been taken in the meantime
+   would have had: correction for coordinated omission */
+void hdrhist_record_corrected (struct hdrhist *h, int64_t x, int64_t expected_interval);
+
+void hdrhist_merge (struct hdrhist *dst, const struct hdrhist *src);
+uint64_t hdrhist_count (const struct hdrhist *h);
+
+/* Value at percentile pct (0 .. 100), 0 if the histogram is empty */
+int64_t hdrhist_percentile (const struct hdrhist *h, double pct);
+
+#endif
@@ -21,6 +21,7 @@
 #include "dds/ddsrt/misc.h"
 
 #include "netload.h"
+#include "output.h"
 
 #if DDSRT_HAVE_NETSTAT
 
@@ -50,17 +51,21 @@ void record_netload (struct record_netload_state *st, const char *prefix, dds_ti
         const double dt = (double) (tnow - st->tprev) / 1e9;
         const double dx = 8 * (double) (x.obytes - st->obytes) / dt;
         const double dr = 8 * (double) (x.ibytes - st->ibytes) / dt;
+        output_begin ("netload", st->name);
+        output_value ("xmit", dx);
+        output_value ("recv", dr);
+        output_end ();
         if (st->bw > 0)
         {
           const double dxpct = 100.0 * dx / st->bw;
           const double drpct = 100.0 * dr / st->bw;
-          if (dxpct >= 0.5 || drpct >= 0.5)
+          if (output_text () && (dxpct >= 0.5 || drpct >= 0.5))
           {
             printf ("%s %s: xmit %.0f%% recv %.0f%% [%"PRIu64" %"PRIu64"]\n",
                     prefix, st->name, dxpct, drpct, x.obytes, x.ibytes);
           }
         }
-        else if (dx >= 1e5 || dr >= 1e5) // 100kb/s is arbitrary
+        else if (output_text () && (dx >= 1e5 || dr >= 1e5)) // 100kb/s is arbitrary
         {
           printf ("%s %s: xmit %.2f Mb/s recv %.2f Mb/s [%"PRIu64" %"PRIu64"]\n",
                   prefix, st->name, dx / 1e6, dr / 1e6, x.obytes, x.ibytes);
@@ -105,6 +110,18 @@ void record_netload_free (struct record_netload_state *st)
   }
 }
 
+bool record_netload_counters (struct record_netload_state *st, struct netload_counters *x)
+{
+  struct ddsrt_netstat y;
+  if (st == NULL || st->errored || ddsrt_netstat_get (st->ctrl, &y) != DDS_RETCODE_OK)
+    return false;
+  x->ipkt = y.ipkt;
+  x->opkt = y.opkt;
+  x->ibytes = y.ibytes;
+  x->obytes = y.obytes;
+  return true;
+}
+
 #else
 
 void record_netload (struct record_netload_state *st, const char *prefix, dds_time_t tnow)
@@ -126,4 +143,11 @@ void record_netload_free (struct record_netload_state *st)
   (void) st;
 }
 
+bool record_netload_counters (struct record_netload_state *st, struct netload_counters *x)
+{
+  (void) st;
+  (void) x;
+  return false;
+}
+
 #endif
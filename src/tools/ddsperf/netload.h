@@ -15,8 +15,18 @@
 
 struct record_netload_state;
 
+struct netload_counters {
+  uint64_t ipkt;
+  uint64_t opkt;
+  uint64_t ibytes;
+  uint64_t obytes;
+};
+
 void record_netload (struct record_netload_state *st, const char *prefix, dds_time_t tnow);
 struct record_netload_state *record_netload_new (const char *dev, double bw);
 void record_netload_free (struct record_netload_state *st);
 
+/* Current values of the interface counters, false if unavailable */
+bool record_netload_counters (struct record_netload_state *st, struct netload_counters *x);
+
 #endif
@@ -0,0 +1,163 @@
+// Copyright(c) 2025 ZettaScale Technology and others
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License v. 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Eclipse Distribution License
+// v. 1.0 which is available at
+// http://www.eclipse.org/org/documents/edl-v10.php.
+//
+// SPDX-License-Identifier: EPL-2.0 OR BSD-3-Clause
+
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+#include <math.h>
+
+#include "dds/ddsrt/process.h"
+#include "dds/ddsrt/misc.h"
+
+#include "output.h"
+
+enum output_format {
+  OF_TEXT,
+  OF_JSON,
+  OF_CSV
+};
+
+static enum output_format format = OF_TEXT;
+static FILE *fp;
+static double cur_time;
+static const char *cur_record;
+static const char *cur_peer;
+
+bool output_init (const char *spec)
+{
+  const char *file = strchr (spec, ':');
+  const size_t len = file ? (size_t) (file - spec) : strlen (spec);
+  if (len == 4 && strncmp (spec, "json", len) == 0)
+    format = OF_JSON;
+  else if (len == 3 && strncmp (spec, "csv", len) == 0)
+    format = OF_CSV;
+  else
+    return false;
+  if (file == NULL || strcmp (file + 1, "-") == 0)
+    fp = stdout;
+  else
+  {
+DDSRT_WARNING_MSVC_OFF(4996);
+    if ((fp = fopen (file + 1, "w")) == NULL)
+      return false;
+DDSRT_WARNING_MSVC_ON(4996);
+  }
+  if (format == OF_CSV)
+    fprintf (fp, "time,pid,record,peer,name,value\n");
+  return true;
+}
+
+void output_fini (void)
+{
+  if (fp && fp != stdout)
+    fclose (fp);
+  fp = NULL;
+  format = OF_TEXT;
+}
+
+bool output_text (void)
+{
+  return format == OF_TEXT || fp != stdout;
+}
+
+void output_set_time (double ts)
+{
+  cur_time = ts;
+}
+
+static void print_json_string (const char *s)
+{
+  fputc ('"', fp);
+  for (; *s; s++)
+  {
+    if (*s == '"' || *s == '\\')
+      fprintf (fp, "\\%c", *s);
+    else if ((unsigned char) *s < 0x20)
+      fprintf (fp, "\\u%04x", (unsigned) *s);
+    else
+      fputc (*s, fp);
+  }
+  fputc ('"', fp);
+}
+
+static void print_csv_string (const char *s)
+{
+  if (strpbrk (s, ",\"\n") == NULL)
+    fputs (s, fp);
+  else
+  {
+    fputc ('"', fp);
+    for (; *s; s++)
+    {
+      if (*s == '"')
+        fputc ('"', fp);
+      fputc (*s, fp);
+    }
+    fputc ('"', fp);
+  }
+}
+
+void output_begin (const char *record, const char *peer)
+{
+  cur_record = record;
+  cur_peer = peer ? peer : "";
+  if (format == OF_JSON)
+  {
+    fprintf (fp, "{\"time\":%.6f,\"pid\":%"PRIdPID",\"record\":", cur_time, ddsrt_getpid ());
+    print_json_string (cur_record);
+    if (*cur_peer)
+    {
+      fprintf (fp, ",\"peer\":");
+      print_json_string (cur_peer);
+    }
+  }
+}
+
+void output_value (const char *name, double value)
+{
+  switch (format)
+  {
+    case OF_TEXT:
+      break;
+    case OF_JSON:
+      fputc (',', fp);
+      print_json_string (name);
+      // JSON has no representation for infinities and NaNs
+      if (isfinite (value))
+        fprintf (fp, ":%.15g", value);
+      else
+        fprintf (fp, ":null");
+      break;
+    case OF_CSV:
+      fprintf (fp, "%.6f,%"PRIdPID",", cur_time, ddsrt_getpid ());
+      print_csv_string (cur_record);
+      fputc (',', fp);
+      print_csv_string (cur_peer);
+      fputc (',', fp);
+      print_csv_string (name);
+      if (isfinite (value))
+        fprintf (fp, ",%.15g\n", value);
+      else
+        fprintf (fp, ",\n");
+      break;
+  }
+}
+
+void output_end (void)
+{
+  if (format == OF_JSON)
+    fprintf (fp, "}\n");
+}
+
+void output_flush (void)
+{
+  if (fp)
+    fflush (fp);
+}
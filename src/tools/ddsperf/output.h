@@ -0,0 +1,38 @@
+// Copyright(c) 2025 ZettaScale Technology and others
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License v. 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Eclipse Distribution License
+// v. 1.0 which is available at
+// http://www.eclipse.org/org/documents/edl-v10.php.
+//
+// SPDX-License-Identifier: EPL-2.0 OR BSD-3-Clause
+
+#ifndef OUTPUT_H
+#define OUTPUT_H
+
+#include <stdbool.h>
+
+/* Machine-readable output of the statistics.  A record has a type (e.g., "sub"),
+   optionally a peer it relates to and a number of named values.  In JSON each
+   record is an object on a line of its own, in CSV each value is a line with
+   time, pid, record type, peer, name and value.  Only to be used from the thread
+   that prints the statistics. */
+
+/* spec is "json" or "csv", optionally followed by ":FILE"; FILE = "-" (the default)
+   means stdout, in which case the text output of the statistics is suppressed */
+bool output_init (const char *spec);
+void output_fini (void);
+
+/* Whether the statistics should (also) be printed as text */
+bool output_text (void);
+
+/* Set the time stamp (in seconds) for the records that follow */
+void output_set_time (double ts);
+
+void output_begin (const char *record, const char *peer);
+void output_value (const char *name, double value);
+void output_end (void);
+void output_flush (void);
+
+#endif
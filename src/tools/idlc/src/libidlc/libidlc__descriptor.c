@@ -26,6 +26,7 @@
 
 #include "libidlc__generator.h"
 #include "libidlc__descriptor.h"
+#include "libidlc__serializers.h"
 #include "hashid.h"
 #ifdef DDS_HAS_TYPELIB
 #include "idl/descriptor_type_meta.h"
@@ -2336,7 +2337,7 @@ err_type:
 }
 
 #define MAX_FLAGS 30
-static int print_flags(FILE *fp, struct descriptor *descriptor, bool type_info)
+static int print_flags(FILE *fp, struct descriptor *descriptor, bool type_info, bool gen_serializers)
 {
   const char *fmt;
   const char *vec[MAX_FLAGS] = { NULL };
@@ -2379,6 +2380,9 @@ static int print_flags(FILE *fp, struct descriptor *descriptor, bool type_info)
   (void) type_info;
 #endif
 
+  if (gen_serializers)
+    vec[len++] = "DDS_TOPIC_GEN_SERIALIZERS";
+
   if (!len)
     vec[len++] = "0u";
 
@@ -2390,7 +2394,7 @@ static int print_flags(FILE *fp, struct descriptor *descriptor, bool type_info)
   return fputs(",\n", fp) < 0 ? -1 : 0;
 }
 
-static int print_descriptor(FILE *fp, struct descriptor *descriptor, bool type_info)
+static int print_descriptor(FILE *fp, struct descriptor *descriptor, bool type_info, bool gen_serializers)
 {
   char *name, *type;
   const char *fmt;
@@ -2405,7 +2409,7 @@ static int print_descriptor(FILE *fp, struct descriptor *descriptor, bool type_i
         "  .m_flagset = ";
   if (idl_fprintf(fp, fmt, type) < 0)
     return -1;
-  if (print_flags(fp, descriptor, type_info) < 0)
+  if (print_flags(fp, descriptor, type_info, gen_serializers) < 0)
     return -1;
   fmt = "  .m_nkeys = %1$"PRIu32"u,\n" /* number of keys */
         "  .m_typename = \"%2$s\",\n"; /* fully qualified name in IDL */
@@ -2453,13 +2457,18 @@ static int print_descriptor(FILE *fp, struct descriptor *descriptor, bool type_i
     }
   }
 
+  if (gen_serializers) {
+    if (idl_fprintf(fp, ",\n  .m_gen_ops = &%1$s_gen_ops", type) < 0)
+      return -1;
+  }
+
   if (idl_fprintf(fp, "\n};\n\n") < 0)
     return -1;
 
   return 0;
 }
 
-static int print_cdrstream_descriptor(FILE *fp, struct descriptor *descriptor, uint32_t offset)
+static int print_cdrstream_descriptor(FILE *fp, struct descriptor *descriptor, uint32_t offset, bool gen_serializers)
 {
   char *name, *type;
   const char *fmt;
@@ -2474,7 +2483,7 @@ static int print_cdrstream_descriptor(FILE *fp, struct descriptor *descriptor, u
         "  .flagset = ";
   if (idl_fprintf(fp, fmt, type) < 0)
     return -1;
-  if (print_flags(fp, descriptor, false) < 0)
+  if (print_flags(fp, descriptor, false, false) < 0)
     return -1;
   fmt = "  .keys = {\n"
         "    .nkeys = %1$"PRIu32"u,\n";
@@ -2508,10 +2517,13 @@ static int print_cdrstream_descriptor(FILE *fp, struct descriptor *descriptor, u
   // a problem for our purpose and avoids making the output dependent on
   // platform-specific details (such as alignment)
   fmt = "  .opt_size_xcdr1 = 0,\n"
-        "  .opt_size_xcdr2 = 0\n"
-        "};\n\n";
+        "  .opt_size_xcdr2 = 0";
   if (idl_fprintf(fp, "%s", fmt) < 0)
     return -1;
+  if (gen_serializers && idl_fprintf(fp, ",\n  .gen_ops = &%1$s_gen_ops", type) < 0)
+    return -1;
+  if (idl_fprintf(fp, "\n};\n\n") < 0)
+    return -1;
   return 0;
 }
 
@@ -2686,6 +2698,7 @@ generate_descriptor(
   idl_retcode_t ret;
   struct descriptor descriptor;
   uint32_t inst_count;
+  bool gen_serializers = false;
 
   if ((ret = generate_descriptor_impl(pstate, node, &descriptor)) < 0)
     goto err_gen;
@@ -2693,16 +2706,18 @@ generate_descriptor(
     { ret = IDL_RETCODE_NO_MEMORY; goto err_print; }
   if (print_keys(generator->source.handle, &descriptor, inst_count) < 0)
     { ret = IDL_RETCODE_NO_MEMORY; goto err_print; }
+  if (generator->config.generate_serializers && (ret = generate_serializers(pstate, generator, &descriptor, &gen_serializers)) < 0)
+    goto err_print;
 #ifdef DDS_HAS_TYPELIB
   if (generator->config.c.generate_type_info && print_type_meta_ser(generator->source.handle, pstate, node) < 0)
     { ret = IDL_RETCODE_NO_MEMORY; goto err_print; }
-  if (print_descriptor(generator->source.handle, &descriptor, generator->config.c.generate_type_info) < 0)
+  if (print_descriptor(generator->source.handle, &descriptor, generator->config.c.generate_type_info, gen_serializers) < 0)
     { ret = IDL_RETCODE_NO_MEMORY; goto err_print; }
 #else
-  if (print_descriptor(generator->source.handle, &descriptor, false) < 0)
+  if (print_descriptor(generator->source.handle, &descriptor, false, gen_serializers) < 0)
     { ret = IDL_RETCODE_NO_MEMORY; goto err_print; }
 #endif
-  if (generator->config.generate_cdrstream_desc && print_cdrstream_descriptor(generator->source.handle, &descriptor, inst_count) < 0)
+  if (generator->config.generate_cdrstream_desc && print_cdrstream_descriptor(generator->source.handle, &descriptor, inst_count, gen_serializers) < 0)
     { ret = IDL_RETCODE_NO_MEMORY; goto err_print; }
 
 err_print:
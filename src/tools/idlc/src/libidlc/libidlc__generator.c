@@ -31,6 +31,7 @@
 const char *export_macro = NULL;
 const char *header_guard_prefix = "DDSC_";
 int generate_cdrstream_desc = 0;
+int gen_serializers = 0;
 
 static idl_retcode_t print_header(FILE *fh, const char *in, const char *out)
 {
@@ -134,7 +135,7 @@ generate_nosetup(const idl_pstate_t *pstate, struct generator *generator)
     return ret;
   if (fputs("#include \"dds/ddsc/dds_public_impl.h\"\n", generator->header.handle) < 0)
     return IDL_RETCODE_NO_MEMORY;
-  if (generator->config.generate_cdrstream_desc && fputs("#include \"dds/cdr/dds_cdrstream.h\"\n", generator->header.handle) < 0)
+  if ((generator->config.generate_cdrstream_desc || generator->config.generate_serializers) && fputs("#include \"dds/cdr/dds_cdrstream.h\"\n", generator->header.handle) < 0)
     return IDL_RETCODE_NO_MEMORY;
   if (fputs("\n", generator->header.handle) < 0)
     return IDL_RETCODE_NO_MEMORY;
@@ -147,7 +148,11 @@ generate_nosetup(const idl_pstate_t *pstate, struct generator *generator)
   for (const char *ptr = sep; *ptr; ptr++)
     if (idl_isseparator((unsigned char)*ptr))
       sep = ptr+1;
-  if (idl_fprintf(generator->source.handle, "#include \"%s\"\n\n", sep) < 0)
+  if (idl_fprintf(generator->source.handle, "#include \"%s\"\n", sep) < 0)
+    return IDL_RETCODE_NO_MEMORY;
+  if (generator->config.generate_serializers && fputs("#include \"dds/cdr/dds_cdrstream_gen.h\"\n", generator->source.handle) < 0)
+    return IDL_RETCODE_NO_MEMORY;
+  if (fputs("\n", generator->source.handle) < 0)
     return IDL_RETCODE_NO_MEMORY;
   if ((ret = generate_types(pstate, generator)))
     return ret;
@@ -196,6 +201,11 @@ static const idlc_option_t *opts[] = {
   &(idlc_option_t){
     IDLC_FLAG, { .flag = &generate_cdrstream_desc }, 'f', "cdrstream-desc", "",
     "Generate CDR descriptor in addition to regular topic descriptor." },
+  &(idlc_option_t){
+    IDLC_FLAG, { .flag = &gen_serializers }, 'f', "gen-serializers", "",
+    "Generate type-specialised serialization functions for topic types "
+    "that are final structs of primitives, enums, strings, sequences and "
+    "arrays, that are used instead of interpreting the marshalling ops." },
   &(idlc_option_t){
     IDLC_STRING, { .string = &header_guard_prefix },
     'f', "header-guard-prefix", "<header guard prefix>",
@@ -240,7 +250,10 @@ generate(const idl_pstate_t *pstate, const idlc_generator_config_t *config)
   if(!(generator.config.guard_macro = create_guard(header_guard_prefix, generator.header.path, pstate->digest)))
     goto err_options;
   generator.config.generate_cdrstream_desc = (generate_cdrstream_desc != 0);
+  generator.config.generate_serializers = (gen_serializers != 0);
   ret = generate_nosetup(pstate, &generator);
+  if (generator.serializers.nodes)
+    idl_free(generator.serializers.nodes);
   if(generator.config.guard_macro)
     idl_free(generator.config.guard_macro);
 
@@ -34,7 +34,12 @@ struct generator {
     char *export_macro;
     char *guard_macro;
     bool generate_cdrstream_desc;
+    bool generate_serializers;
   } config;
+  struct {
+    const void **nodes;
+    size_t count;
+  } serializers; /**< structs for which serializers have been generated */
 };
 
 #endif /* GENERATOR_H */
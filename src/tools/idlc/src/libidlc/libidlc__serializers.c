@@ -0,0 +1,945 @@
+// Copyright(c) 2025 ZettaScale Technology and others
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License v. 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Eclipse Distribution License
+// v. 1.0 which is available at
+// http://www.eclipse.org/org/documents/edl-v10.php.
+//
+// SPDX-License-Identifier: EPL-2.0 OR BSD-3-Clause
+
+#include <assert.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include "idl/heap.h"
+#include "idl/print.h"
+#include "idl/stream.h"
+#include "idl/string.h"
+#include "idl/processor.h"
+
+#include "libidlc__descriptor.h"
+#include "libidlc__generator.h"
+#include "libidlc__serializers.h"
+
+/* The generated functions mirror what the interpreter in dds_cdrstream.c does
+   for the marshalling ops idlc generates for the type, using the helpers in
+   dds/cdr/dds_cdrstream_gen.h. Only types for which the CDR representation is
+   simple enough are supported: final structs without inheritance, optional or
+   external members, containing primitives, enums, strings, nested structs,
+   sequences and arrays of these. Anything else, including all unions, wide
+   strings and bitmasks, falls back to the interpreter. */
+
+enum sertype_kind {
+  SK_BOOL,
+  SK_PRIM,
+  SK_ENUM,
+  SK_STRING,
+  SK_BSTRING,
+  SK_STRUCT,
+  SK_SEQUENCE,
+  SK_ARRAY
+};
+
+struct sertype {
+  enum sertype_kind kind;
+  uint32_t size;                /**< size in CDR of a primitive or enum */
+  uint32_t max;                 /**< maximum value of an enum */
+  uint32_t bound;               /**< bound of a string or sequence, 0 if unbounded */
+  uint32_t dims;                /**< total number of elements of an array */
+  const void *node;             /**< struct or enum definition, array declarator */
+  const idl_type_spec_t *elem;  /**< element type of a sequence or array */
+};
+
+/* Only use for types for which get_sertype succeeded */
+static bool is_primitive(const struct sertype *st)
+{
+  return st->kind == SK_BOOL || st->kind == SK_PRIM;
+}
+
+/* The next array in the element type of an array (i.e., an array typedef), or NULL */
+static const idl_declarator_t *next_array(const idl_declarator_t *array)
+{
+  const idl_type_spec_t *type_spec = idl_type_spec(array);
+  for (; type_spec && (idl_is_alias(type_spec) || idl_is_forward(type_spec)); type_spec = idl_type_spec(type_spec)) {
+    if (idl_is_array(type_spec))
+      return type_spec;
+  }
+  return NULL;
+}
+
+static bool get_sertype(struct sertype *st, const idl_declarator_t *declarator, const idl_type_spec_t *type_spec)
+{
+  const idl_declarator_t *array = NULL;
+  memset(st, 0, sizeof(*st));
+  if (declarator && idl_is_array(declarator)) {
+    array = declarator;
+  } else {
+    for (; type_spec && (idl_is_alias(type_spec) || idl_is_forward(type_spec)); type_spec = idl_type_spec(type_spec)) {
+      if (idl_is_array(type_spec)) {
+        array = type_spec;
+        break;
+      }
+    }
+  }
+
+  /* arrays of array typedefs are squashed into a single array in the marshalling ops,
+     just like multi-dimensional arrays */
+  if (array) {
+    st->kind = SK_ARRAY;
+    st->node = array;
+    st->dims = 1;
+    for (const idl_declarator_t *a = array; a; a = next_array(a)) {
+      st->dims *= idl_array_size(a);
+      st->elem = idl_type_spec(a);
+    }
+    return true;
+  }
+
+  if (type_spec == NULL)
+    return false;
+
+  switch (idl_type(type_spec)) {
+    case IDL_BOOL:
+      st->kind = SK_BOOL;
+      st->size = 1;
+      break;
+    case IDL_CHAR: case IDL_OCTET: case IDL_INT8: case IDL_UINT8:
+      st->kind = SK_PRIM;
+      st->size = 1;
+      break;
+    case IDL_SHORT: case IDL_USHORT: case IDL_INT16: case IDL_UINT16:
+      st->kind = SK_PRIM;
+      st->size = 2;
+      break;
+    case IDL_LONG: case IDL_ULONG: case IDL_INT32: case IDL_UINT32: case IDL_FLOAT:
+      st->kind = SK_PRIM;
+      st->size = 4;
+      break;
+    case IDL_LLONG: case IDL_ULLONG: case IDL_INT64: case IDL_UINT64: case IDL_DOUBLE:
+      st->kind = SK_PRIM;
+      st->size = 8;
+      break;
+    case IDL_ENUM: {
+      const uint32_t bit_bound = idl_bound(type_spec);
+      st->kind = SK_ENUM;
+      st->size = (bit_bound > 16) ? 4 : (bit_bound > 8) ? 2 : 1;
+      st->max = idl_enum_max_value(type_spec);
+      st->node = type_spec;
+      break;
+    }
+    case IDL_STRING:
+      st->kind = idl_is_bounded(type_spec) ? SK_BSTRING : SK_STRING;
+      st->bound = idl_bound(type_spec);
+      break;
+    case IDL_STRUCT:
+      st->kind = SK_STRUCT;
+      st->node = type_spec;
+      break;
+    case IDL_SEQUENCE:
+      st->kind = SK_SEQUENCE;
+      st->bound = idl_bound(type_spec);
+      st->elem = idl_type_spec(type_spec);
+      break;
+    default:
+      return false;
+  }
+  return true;
+}
+
+struct visit {
+  const void *node;
+  const struct visit *up;
+};
+
+static bool supported_struct(const void *node, const struct visit *up);
+
+static bool supported_type(const struct sertype *st, const struct visit *up)
+{
+  struct sertype est;
+  switch (st->kind) {
+    case SK_STRUCT:
+      return supported_struct(st->node, up);
+    case SK_ARRAY:
+      return get_sertype(&est, NULL, st->elem) && supported_type(&est, up);
+    case SK_SEQUENCE:
+      /* elements that don't fit in the application-provided buffer must be skipped,
+         which isn't supported for collections */
+      if (!get_sertype(&est, NULL, st->elem) || est.kind == SK_SEQUENCE || est.kind == SK_ARRAY)
+        return false;
+      return supported_type(&est, up);
+    default:
+      return true;
+  }
+}
+
+static bool supported_struct(const void *node, const struct visit *up)
+{
+  const idl_struct_t *_struct = node;
+  const idl_member_t *member;
+  const idl_declarator_t *declarator;
+
+  if (!idl_is_extensible(node, IDL_FINAL) || _struct->inherit_spec || idl_is_empty(node))
+    return false;
+  for (const struct visit *v = up; v; v = v->up)
+    if (v->node == node)
+      return false;
+  const struct visit visit = { node, up };
+  IDL_FOREACH(member, _struct->members) {
+    if (idl_is_optional(&member->node) || idl_is_external(&member->node))
+      return false;
+    IDL_FOREACH(declarator, member->declarators) {
+      struct sertype st;
+      if (!get_sertype(&st, declarator, member->type_spec) || !supported_type(&st, &visit))
+        return false;
+    }
+  }
+  return true;
+}
+
+#define USES_ALLOCATOR    (1u << 0)
+#define USES_BSWAP        (1u << 1)
+#define USES_XCDR_VERSION (1u << 2)
+#define USES_NORMALIZE    (1u << 3) /* data, off and size */
+
+struct emitter {
+  FILE *fp;      /**< output, NULL for a dry run that only collects "uses" */
+  int indent;
+  uint32_t var;  /**< for generating unique names for local variables */
+  uint32_t uses; /**< which function arguments are used in the generated code */
+};
+
+static idl_retcode_t emit(struct emitter *e, const char *fmt, ...) idl_attribute_format_printf(2, 3);
+
+static idl_retcode_t emit(struct emitter *e, const char *fmt, ...)
+{
+  va_list ap;
+  int ret;
+  if (e->fp == NULL)
+    return IDL_RETCODE_OK;
+  if (idl_fprintf(e->fp, "%*s", 2 * e->indent, "") < 0)
+    return IDL_RETCODE_NO_MEMORY;
+  va_start(ap, fmt);
+  ret = idl_vfprintf(e->fp, fmt, ap);
+  va_end(ap);
+  if (ret < 0 || fputs("\n", e->fp) < 0)
+    return IDL_RETCODE_NO_MEMORY;
+  return IDL_RETCODE_OK;
+}
+
+#define EMIT(...) do { if ((ret = emit(__VA_ARGS__)) != IDL_RETCODE_OK) goto err; } while (0)
+
+/* "&x[0][0]" for a multi-dimensional array x */
+static char *array_base(const char *expr, const struct sertype *st)
+{
+  char *str, *tmp;
+  const idl_literal_t *literal;
+  if (idl_asprintf(&str, "&%s", expr) < 0)
+    return NULL;
+  for (const idl_declarator_t *array = st->node; array; array = next_array(array)) {
+    IDL_FOREACH(literal, array->const_expr) {
+      if (idl_asprintf(&tmp, "%s[0]", str) < 0) {
+        idl_free(str);
+        return NULL;
+      }
+      idl_free(str);
+      str = tmp;
+    }
+  }
+  return str;
+}
+
+/* Emits a loop for each dimension of the array and sets *elem to the expression for
+   the element, the indentation is increased for the body of the inner loop */
+static idl_retcode_t emit_array_loops(struct emitter *e, const char *expr, const struct sertype *st, char **elem)
+{
+  idl_retcode_t ret;
+  const idl_literal_t *literal;
+  char *tmp;
+  if (!(*elem = idl_strdup(expr)))
+    return IDL_RETCODE_NO_MEMORY;
+  for (const idl_declarator_t *array = st->node; array; array = next_array(array)) {
+    IDL_FOREACH(literal, array->const_expr) {
+      const uint32_t v = e->var++;
+      EMIT(e, "for (uint32_t i%1$"PRIu32" = 0; i%1$"PRIu32" < %2$"PRIu32"; i%1$"PRIu32"++)", v, literal->value.uint32);
+      e->indent++;
+      if (idl_asprintf(&tmp, "%s[i%"PRIu32"]", *elem, v) < 0)
+        { ret = IDL_RETCODE_NO_MEMORY; goto err; }
+      idl_free(*elem);
+      *elem = tmp;
+    }
+  }
+  return IDL_RETCODE_OK;
+err:
+  idl_free(*elem);
+  *elem = NULL;
+  return ret;
+}
+
+static void end_array_loops(struct emitter *e, const struct sertype *st)
+{
+  const idl_literal_t *literal;
+  for (const idl_declarator_t *array = st->node; array; array = next_array(array)) {
+    IDL_FOREACH(literal, array->const_expr)
+      e->indent--;
+  }
+}
+
+/*******************************************************************************************
+ **
+ **  Writing
+ **
+ *******************************************************************************************/
+
+static idl_retcode_t emit_write(struct emitter *e, const struct sertype *st, const char *expr)
+{
+  idl_retcode_t ret = IDL_RETCODE_OK;
+  char *type = NULL, *str = NULL;
+  struct sertype est;
+
+  switch (st->kind) {
+    case SK_BOOL:
+      EMIT(e, "dds_cdrstream_gen_put1 (os, allocator, (uint8_t) (%s != 0));", expr);
+      break;
+    case SK_PRIM:
+      EMIT(e, "dds_cdrstream_gen_put_prim (os, allocator, &%s, %"PRIu32");", expr, st->size);
+      break;
+    case SK_ENUM:
+      EMIT(e, "if (!dds_cdrstream_gen_put_enum (os, allocator, (uint32_t) %s, %"PRIu32", %"PRIu32"))", expr, st->size, st->max);
+      EMIT(e, "  return false;");
+      break;
+    case SK_STRING:
+    case SK_BSTRING:
+      EMIT(e, "dds_cdrstream_gen_put_string (os, allocator, %s);", expr);
+      break;
+    case SK_STRUCT:
+      if (IDL_PRINT(&type, print_type, st->node) < 0)
+        return IDL_RETCODE_NO_MEMORY;
+      EMIT(e, "if (!%s_gen_write (os, allocator, &%s))", type, expr);
+      EMIT(e, "  return false;");
+      break;
+    case SK_ARRAY: {
+      (void) get_sertype(&est, NULL, st->elem);
+      if (is_primitive(&est)) {
+        if (!(str = array_base(expr, st)))
+          return IDL_RETCODE_NO_MEMORY;
+        if (est.kind == SK_BOOL)
+          EMIT(e, "dds_cdrstream_gen_put_bool_array (os, allocator, %s, %"PRIu32");", str, st->dims);
+        else
+          EMIT(e, "dds_cdrstream_gen_put_prim_array (os, allocator, %s, %"PRIu32", %"PRIu32");", str, st->dims, est.size);
+      } else {
+        const uint32_t dh = e->var++;
+        EMIT(e, "{");
+        e->indent++;
+        EMIT(e, "const uint32_t dh%"PRIu32" = (os->m_xcdr_version == DDSI_RTPS_CDR_ENC_VERSION_2) ? dds_cdrstream_gen_dheader_begin (os, allocator) : 0;", dh);
+        if ((ret = emit_array_loops(e, expr, st, &str)) != IDL_RETCODE_OK)
+          goto err;
+        if ((ret = emit_write(e, &est, str)) != IDL_RETCODE_OK)
+          goto err;
+        end_array_loops(e, st);
+        EMIT(e, "if (dh%"PRIu32")", dh);
+        EMIT(e, "  dds_cdrstream_gen_dheader_end (os, dh%"PRIu32");", dh);
+        e->indent--;
+        EMIT(e, "}");
+      }
+      break;
+    }
+    case SK_SEQUENCE: {
+      const uint32_t n = e->var++;
+      (void) get_sertype(&est, NULL, st->elem);
+      EMIT(e, "{");
+      e->indent++;
+      EMIT(e, "const uint32_t n%"PRIu32" = %s._length;", n, expr);
+      if (st->bound)
+        EMIT(e, "if (n%1$"PRIu32" > %2$"PRIu32" || (n%1$"PRIu32" > 0 && %3$s._buffer == NULL))", n, st->bound, expr);
+      else
+        EMIT(e, "if (n%1$"PRIu32" > 0 && %2$s._buffer == NULL)", n, expr);
+      EMIT(e, "  return false;");
+      if (!is_primitive(&est))
+        EMIT(e, "const uint32_t dh%"PRIu32" = (os->m_xcdr_version == DDSI_RTPS_CDR_ENC_VERSION_2) ? dds_cdrstream_gen_dheader_begin (os, allocator) : 0;", n);
+      EMIT(e, "dds_cdrstream_gen_put4 (os, allocator, n%"PRIu32");", n);
+      if (est.kind == SK_BOOL) {
+        EMIT(e, "dds_cdrstream_gen_put_bool_array (os, allocator, %s._buffer, n%"PRIu32");", expr, n);
+      } else if (est.kind == SK_PRIM) {
+        /* no alignment if the sequence is empty */
+        EMIT(e, "if (n%"PRIu32" > 0)", n);
+        EMIT(e, "  dds_cdrstream_gen_put_prim_array (os, allocator, %s._buffer, n%"PRIu32", %"PRIu32");", expr, n, est.size);
+      } else {
+        const uint32_t i = e->var++;
+        if (idl_asprintf(&str, "%s._buffer[i%"PRIu32"]", expr, i) < 0)
+          return IDL_RETCODE_NO_MEMORY;
+        EMIT(e, "for (uint32_t i%1$"PRIu32" = 0; i%1$"PRIu32" < n%2$"PRIu32"; i%1$"PRIu32"++)", i, n);
+        e->indent++;
+        if ((ret = emit_write(e, &est, str)) != IDL_RETCODE_OK)
+          goto err;
+        e->indent--;
+        EMIT(e, "if (dh%"PRIu32")", n);
+        EMIT(e, "  dds_cdrstream_gen_dheader_end (os, dh%"PRIu32");", n);
+      }
+      e->indent--;
+      EMIT(e, "}");
+      break;
+    }
+  }
+
+err:
+  if (type)
+    idl_free(type);
+  if (str)
+    idl_free(str);
+  return ret;
+}
+
+/*******************************************************************************************
+ **
+ **  Reading
+ **
+ *******************************************************************************************/
+
+static idl_retcode_t emit_read(struct emitter *e, const struct sertype *st, const char *expr)
+{
+  idl_retcode_t ret = IDL_RETCODE_OK;
+  char *type = NULL, *str = NULL;
+  struct sertype est;
+
+  switch (st->kind) {
+    case SK_BOOL:
+    case SK_PRIM:
+      EMIT(e, "dds_cdrstream_gen_get_prim (is, &%s, %"PRIu32");", expr, st->size);
+      break;
+    case SK_ENUM:
+      if (IDL_PRINT(&type, print_type, st->node) < 0)
+        return IDL_RETCODE_NO_MEMORY;
+      EMIT(e, "%s = (%s) dds_cdrstream_gen_get_enum (is, %"PRIu32");", expr, type, st->size);
+      break;
+    case SK_STRING:
+      e->uses |= USES_ALLOCATOR;
+      EMIT(e, "%1$s = dds_cdrstream_gen_get_string (is, %1$s, allocator);", expr);
+      break;
+    case SK_BSTRING:
+      EMIT(e, "dds_cdrstream_gen_get_string_bound (is, %s, %"PRIu32");", expr, st->bound + 1);
+      break;
+    case SK_STRUCT:
+      e->uses |= USES_ALLOCATOR;
+      if (IDL_PRINT(&type, print_type, st->node) < 0)
+        return IDL_RETCODE_NO_MEMORY;
+      EMIT(e, "%s_gen_read (is, &%s, allocator);", type, expr);
+      break;
+    case SK_ARRAY: {
+      (void) get_sertype(&est, NULL, st->elem);
+      if (!is_primitive(&est)) {
+        EMIT(e, "if (is->m_xcdr_version == DDSI_RTPS_CDR_ENC_VERSION_2)");
+        EMIT(e, "  (void) dds_cdrstream_gen_get4 (is);");
+      }
+      if (is_primitive(&est) || est.kind == SK_ENUM) {
+        if (!(str = array_base(expr, st)))
+          return IDL_RETCODE_NO_MEMORY;
+        if (est.kind == SK_ENUM)
+          EMIT(e, "dds_cdrstream_gen_get_enum_array (is, (uint32_t *) %s, %"PRIu32", %"PRIu32");", str, st->dims, est.size);
+        else
+          EMIT(e, "dds_cdrstream_gen_get_prim_array (is, %s, %"PRIu32", %"PRIu32");", str, st->dims, est.size);
+      } else {
+        if ((ret = emit_array_loops(e, expr, st, &str)) != IDL_RETCODE_OK)
+          goto err;
+        if ((ret = emit_read(e, &est, str)) != IDL_RETCODE_OK)
+          goto err;
+        end_array_loops(e, st);
+      }
+      break;
+    }
+    case SK_SEQUENCE: {
+      const uint32_t n = e->var++;
+      e->uses |= USES_ALLOCATOR;
+      (void) get_sertype(&est, NULL, st->elem);
+      EMIT(e, "{");
+      e->indent++;
+      if (!is_primitive(&est)) {
+        EMIT(e, "if (is->m_xcdr_version == DDSI_RTPS_CDR_ENC_VERSION_2)");
+        EMIT(e, "  (void) dds_cdrstream_gen_get4 (is);");
+      }
+      EMIT(e, "const uint32_t n%"PRIu32" = dds_cdrstream_gen_get4 (is);", n);
+      EMIT(e, "if (n%"PRIu32" == 0)", n);
+      EMIT(e, "  %s._length = 0;", expr);
+      EMIT(e, "else");
+      EMIT(e, "{");
+      e->indent++;
+      /* string and struct elements may contain pointers, so newly allocated memory must be
+         zero-initialized, as in the interpreter */
+      EMIT(e, "const uint32_t m%1$"PRIu32" = dds_cdrstream_gen_seq_adjust (&%2$s, allocator, n%1$"PRIu32", sizeof (*%2$s._buffer), %3$s);",
+           n, expr, (est.kind == SK_STRING || est.kind == SK_STRUCT) ? "true" : "false");
+      switch (est.kind) {
+        case SK_BOOL:
+        case SK_PRIM:
+          EMIT(e, "dds_cdrstream_gen_get_prim_array (is, %s._buffer, m%"PRIu32", %"PRIu32");", expr, n, est.size);
+          EMIT(e, "is->m_index += (n%1$"PRIu32" - m%1$"PRIu32") * %2$"PRIu32";", n, est.size);
+          break;
+        case SK_ENUM:
+          EMIT(e, "dds_cdrstream_gen_get_enum_array (is, (uint32_t *) %s._buffer, m%"PRIu32", %"PRIu32");", expr, n, est.size);
+          EMIT(e, "is->m_index += (n%1$"PRIu32" - m%1$"PRIu32") * %2$"PRIu32";", n, est.size);
+          break;
+        case SK_STRING:
+        case SK_BSTRING:
+        case SK_STRUCT: {
+          const uint32_t i = e->var++;
+          if (idl_asprintf(&str, "%s._buffer[i%"PRIu32"]", expr, i) < 0)
+            return IDL_RETCODE_NO_MEMORY;
+          EMIT(e, "for (uint32_t i%1$"PRIu32" = 0; i%1$"PRIu32" < m%2$"PRIu32"; i%1$"PRIu32"++)", i, n);
+          e->indent++;
+          if ((ret = emit_read(e, &est, str)) != IDL_RETCODE_OK)
+            goto err;
+          e->indent--;
+          EMIT(e, "for (uint32_t i%1$"PRIu32" = m%2$"PRIu32"; i%1$"PRIu32" < n%2$"PRIu32"; i%1$"PRIu32"++)", i, n);
+          if (est.kind != SK_STRUCT)
+            EMIT(e, "  dds_cdrstream_gen_skip_string (is);");
+          else {
+            /* the input has been normalized already, so this only skips */
+            if (IDL_PRINT(&type, print_type, est.node) < 0)
+              { ret = IDL_RETCODE_NO_MEMORY; goto err; }
+            EMIT(e, "  (void) %s_gen_normalize ((char *) is->m_buffer, &is->m_index, is->m_size, false, is->m_xcdr_version);", type);
+          }
+          break;
+        }
+        case SK_SEQUENCE:
+        case SK_ARRAY:
+          assert(0);
+          break;
+      }
+      e->indent--;
+      EMIT(e, "}");
+      e->indent--;
+      EMIT(e, "}");
+      break;
+    }
+  }
+
+err:
+  if (type)
+    idl_free(type);
+  if (str)
+    idl_free(str);
+  return ret;
+}
+
+/*******************************************************************************************
+ **
+ **  Normalization (validation + byte swapping in-place)
+ **
+ *******************************************************************************************/
+
+static idl_retcode_t emit_normalize(struct emitter *e, const struct sertype *st, const char *size)
+{
+  idl_retcode_t ret = IDL_RETCODE_OK;
+  char *type = NULL;
+  struct sertype est;
+
+  e->uses |= USES_NORMALIZE;
+  switch (st->kind) {
+    case SK_BOOL:
+      EMIT(e, "if (!dds_cdrstream_gen_norm_bool_array (data, off, %s, 1))", size);
+      EMIT(e, "  return false;");
+      break;
+    case SK_PRIM:
+      e->uses |= USES_BSWAP | USES_XCDR_VERSION;
+      EMIT(e, "if (!dds_cdrstream_gen_norm_prim (data, off, %s, bswap, %"PRIu32", xcdr_version))", size, st->size);
+      EMIT(e, "  return false;");
+      break;
+    case SK_ENUM:
+      e->uses |= USES_BSWAP;
+      EMIT(e, "if (!dds_cdrstream_gen_norm_enum (data, off, %s, bswap, %"PRIu32", %"PRIu32"))", size, st->size, st->max);
+      EMIT(e, "  return false;");
+      break;
+    case SK_STRING:
+      e->uses |= USES_BSWAP;
+      EMIT(e, "if (!dds_cdrstream_gen_norm_string (data, off, %s, bswap, SIZE_MAX))", size);
+      EMIT(e, "  return false;");
+      break;
+    case SK_BSTRING:
+      e->uses |= USES_BSWAP;
+      EMIT(e, "if (!dds_cdrstream_gen_norm_string (data, off, %s, bswap, %"PRIu32"))", size, st->bound + 1);
+      EMIT(e, "  return false;");
+      break;
+    case SK_STRUCT:
+      e->uses |= USES_BSWAP | USES_XCDR_VERSION;
+      if (IDL_PRINT(&type, print_type, st->node) < 0)
+        return IDL_RETCODE_NO_MEMORY;
+      EMIT(e, "if (!%s_gen_normalize (data, off, %s, bswap, xcdr_version))", type, size);
+      EMIT(e, "  return false;");
+      break;
+    case SK_ARRAY:
+    case SK_SEQUENCE: {
+      /* the size is checked using "size1", which is the end of the collection if it
+         has a DHEADER, and else the same as the size passed in */
+      const uint32_t n = e->var++;
+      const char *size1 = size;
+      char size1buf[32];
+      (void) get_sertype(&est, NULL, st->elem);
+      if (st->kind == SK_ARRAY && est.kind == SK_BOOL) {
+        EMIT(e, "if (!dds_cdrstream_gen_norm_bool_array (data, off, %s, %"PRIu32"))", size, st->dims);
+        EMIT(e, "  return false;");
+        break;
+      } else if (st->kind == SK_ARRAY && est.kind == SK_PRIM) {
+        e->uses |= USES_BSWAP | USES_XCDR_VERSION;
+        EMIT(e, "if (!dds_cdrstream_gen_norm_prim_array (data, off, %s, bswap, %"PRIu32", %"PRIu32", xcdr_version))", size, st->dims, est.size);
+        EMIT(e, "  return false;");
+        break;
+      }
+
+      EMIT(e, "{");
+      e->indent++;
+      if (!is_primitive(&est)) {
+        e->uses |= USES_BSWAP | USES_XCDR_VERSION;
+        (void) idl_snprintf(size1buf, sizeof(size1buf), "sz%"PRIu32, n);
+        size1 = size1buf;
+        EMIT(e, "uint32_t %s = %s;", size1, size);
+        EMIT(e, "if (xcdr_version == DDSI_RTPS_CDR_ENC_VERSION_2 && !dds_cdrstream_gen_norm_dheader (&%s, data, off, %s, bswap))", size1, size);
+        EMIT(e, "  return false;");
+      }
+
+      char num[32];
+      if (st->kind == SK_ARRAY) {
+        (void) idl_snprintf(num, sizeof(num), "%"PRIu32, st->dims);
+      } else {
+        e->uses |= USES_BSWAP;
+        (void) idl_snprintf(num, sizeof(num), "n%"PRIu32, n);
+        EMIT(e, "uint32_t %s;", num);
+        EMIT(e, "if (!dds_cdrstream_gen_read_norm4 (&%s, data, off, %s, bswap))", num, size1);
+        EMIT(e, "  return false;");
+        if (st->bound) {
+          EMIT(e, "if (%s > %"PRIu32")", num, st->bound);
+          EMIT(e, "  return false;");
+        }
+      }
+
+      /* arrays of primitives have been handled above, for sequences an empty one doesn't
+         result in alignment for the elements */
+      switch (est.kind) {
+        case SK_BOOL:
+          /* booleans in sequences are validated like an enum with two values */
+          EMIT(e, "if (%1$s > 0 && !dds_cdrstream_gen_norm_enum_array (data, off, %2$s, bswap, %1$s, 1, 1))", num, size1);
+          EMIT(e, "  return false;");
+          break;
+        case SK_PRIM:
+          EMIT(e, "if (%1$s > 0 && !dds_cdrstream_gen_norm_prim_array (data, off, %2$s, bswap, %1$s, %3$"PRIu32", xcdr_version))", num, size1, est.size);
+          EMIT(e, "  return false;");
+          break;
+        case SK_ENUM:
+          if (st->kind == SK_SEQUENCE)
+            EMIT(e, "if (%1$s > 0 && !dds_cdrstream_gen_norm_enum_array (data, off, %2$s, bswap, %1$s, %3$"PRIu32", %4$"PRIu32"))", num, size1, est.size, est.max);
+          else
+            EMIT(e, "if (!dds_cdrstream_gen_norm_enum_array (data, off, %1$s, bswap, %2$s, %3$"PRIu32", %4$"PRIu32"))", size1, num, est.size, est.max);
+          EMIT(e, "  return false;");
+          break;
+        default: {
+          const uint32_t i = e->var++;
+          EMIT(e, "for (uint32_t i%1$"PRIu32" = 0; i%1$"PRIu32" < %2$s; i%1$"PRIu32"++)", i, num);
+          e->indent++;
+          if ((ret = emit_normalize(e, &est, size1)) != IDL_RETCODE_OK)
+            goto err;
+          e->indent--;
+          break;
+        }
+      }
+
+      if (!is_primitive(&est)) {
+        EMIT(e, "if (xcdr_version == DDSI_RTPS_CDR_ENC_VERSION_2 && *off != %s)", size1);
+        EMIT(e, "  return false;");
+      }
+      e->indent--;
+      EMIT(e, "}");
+      break;
+    }
+  }
+
+err:
+  if (type)
+    idl_free(type);
+  return ret;
+}
+
+/*******************************************************************************************
+ **
+ **  Functions for a struct
+ **
+ *******************************************************************************************/
+
+enum function {
+  FN_WRITE,
+  FN_READ,
+  FN_NORMALIZE
+};
+
+static idl_retcode_t emit_members(struct emitter *e, enum function fn, const idl_struct_t *_struct)
+{
+  idl_retcode_t ret = IDL_RETCODE_OK;
+  const idl_member_t *member;
+  const idl_declarator_t *declarator;
+  IDL_FOREACH(member, _struct->members) {
+    IDL_FOREACH(declarator, member->declarators) {
+      struct sertype st;
+      char *expr;
+      (void) get_sertype(&st, declarator, member->type_spec);
+      if (idl_asprintf(&expr, "sample->%s", idl_identifier(declarator)) < 0)
+        return IDL_RETCODE_NO_MEMORY;
+      switch (fn) {
+        case FN_WRITE: ret = emit_write(e, &st, expr); break;
+        case FN_READ: ret = emit_read(e, &st, expr); break;
+        case FN_NORMALIZE: ret = emit_normalize(e, &st, "size"); break;
+      }
+      idl_free(expr);
+      if (ret != IDL_RETCODE_OK)
+        return ret;
+    }
+  }
+  return IDL_RETCODE_OK;
+}
+
+static idl_retcode_t emit_function(FILE *fp, enum function fn, const idl_struct_t *_struct, const char *type)
+{
+  idl_retcode_t ret;
+  struct emitter e = { NULL, 1, 0, 0 };
+
+  /* dry run to find out which arguments remain unused */
+  if ((ret = emit_members(&e, fn, _struct)) != IDL_RETCODE_OK)
+    return ret;
+  const uint32_t uses = e.uses;
+  e.fp = fp;
+  e.var = 0;
+  switch (fn) {
+    case FN_WRITE:
+      if (idl_fprintf(fp, "static bool %s_gen_write (dds_ostream_t *os, const struct dds_cdrstream_allocator *allocator, const void *vsample)\n{\n", type) < 0)
+        return IDL_RETCODE_NO_MEMORY;
+      EMIT(&e, "const %s *sample = vsample;", type);
+      break;
+    case FN_READ:
+      if (idl_fprintf(fp, "static void %s_gen_read (dds_istream_t *is, void *vsample, const struct dds_cdrstream_allocator *allocator)\n{\n", type) < 0)
+        return IDL_RETCODE_NO_MEMORY;
+      EMIT(&e, "%s *sample = vsample;", type);
+      if (!(uses & USES_ALLOCATOR))
+        EMIT(&e, "(void) allocator;");
+      break;
+    case FN_NORMALIZE:
+      if (idl_fprintf(fp, "static bool %s_gen_normalize (char *data, uint32_t *off, uint32_t size, bool bswap, uint32_t xcdr_version)\n{\n", type) < 0)
+        return IDL_RETCODE_NO_MEMORY;
+      if (!(uses & USES_BSWAP))
+        EMIT(&e, "(void) bswap;");
+      if (!(uses & USES_XCDR_VERSION))
+        EMIT(&e, "(void) xcdr_version;");
+      break;
+  }
+  if ((ret = emit_members(&e, fn, _struct)) != IDL_RETCODE_OK)
+    return ret;
+  if (fn != FN_READ)
+    EMIT(&e, "return true;");
+  if (fputs("}\n\n", fp) < 0)
+    return IDL_RETCODE_NO_MEMORY;
+err:
+  return ret;
+}
+
+static bool is_emitted(const struct generator *generator, const void *node)
+{
+  for (size_t i = 0; i < generator->serializers.count; i++)
+    if (generator->serializers.nodes[i] == node)
+      return true;
+  return false;
+}
+
+static idl_retcode_t emit_struct_functions(struct generator *generator, const void *node);
+
+static idl_retcode_t emit_dependencies(struct generator *generator, const struct sertype *st)
+{
+  struct sertype est;
+  switch (st->kind) {
+    case SK_STRUCT:
+      return emit_struct_functions(generator, st->node);
+    case SK_ARRAY:
+    case SK_SEQUENCE:
+      (void) get_sertype(&est, NULL, st->elem);
+      return emit_dependencies(generator, &est);
+    default:
+      return IDL_RETCODE_OK;
+  }
+}
+
+/* Emits the functions for the struct after those of the structs it uses, the types
+   have been checked by supported_struct so there is no recursion */
+static idl_retcode_t emit_struct_functions(struct generator *generator, const void *node)
+{
+  idl_retcode_t ret;
+  const idl_struct_t *_struct = node;
+  const idl_member_t *member;
+  const idl_declarator_t *declarator;
+  char *type;
+
+  if (is_emitted(generator, node))
+    return IDL_RETCODE_OK;
+  IDL_FOREACH(member, _struct->members) {
+    IDL_FOREACH(declarator, member->declarators) {
+      struct sertype st;
+      (void) get_sertype(&st, declarator, member->type_spec);
+      if ((ret = emit_dependencies(generator, &st)) != IDL_RETCODE_OK)
+        return ret;
+    }
+  }
+
+  if (IDL_PRINT(&type, print_type, node) < 0)
+    return IDL_RETCODE_NO_MEMORY;
+  if ((ret = emit_function(generator->source.handle, FN_WRITE, _struct, type)) != IDL_RETCODE_OK ||
+      (ret = emit_function(generator->source.handle, FN_READ, _struct, type)) != IDL_RETCODE_OK ||
+      (ret = emit_function(generator->source.handle, FN_NORMALIZE, _struct, type)) != IDL_RETCODE_OK)
+    goto err;
+
+  const void **nodes = idl_realloc(generator->serializers.nodes, (generator->serializers.count + 1) * sizeof(*nodes));
+  if (nodes == NULL)
+    { ret = IDL_RETCODE_NO_MEMORY; goto err; }
+  nodes[generator->serializers.count++] = node;
+  generator->serializers.nodes = nodes;
+err:
+  idl_free(type);
+  return ret;
+}
+
+/*******************************************************************************************
+ **
+ **  Key extraction
+ **
+ *******************************************************************************************/
+
+static const struct key_meta_data *find_key(const struct descriptor *descriptor, const char *name)
+{
+  for (uint32_t k = 0; k < descriptor->n_keys; k++)
+    if (strcmp(descriptor->keys[k].name, name) == 0)
+      return &descriptor->keys[k];
+  return NULL;
+}
+
+/* Key extraction is only generated for keys that are top-level members of a primitive,
+   enum or string type, anything else is left to the interpreter */
+static bool supported_keys(const struct descriptor *descriptor)
+{
+  const idl_struct_t *_struct = (const idl_struct_t *)descriptor->topic;
+  const idl_member_t *member;
+  const idl_declarator_t *declarator;
+  uint32_t n_keys = 0;
+
+  if (descriptor->n_keys == 0)
+    return false;
+  for (uint32_t k = 0; k < descriptor->n_keys; k++)
+    if (descriptor->keys[k].n_order != 1)
+      return false;
+  IDL_FOREACH(member, _struct->members) {
+    IDL_FOREACH(declarator, member->declarators) {
+      struct sertype st;
+      if (!find_key(descriptor, idl_identifier(declarator)))
+        continue;
+      (void) get_sertype(&st, declarator, member->type_spec);
+      if (st.kind == SK_STRUCT || st.kind == SK_SEQUENCE || st.kind == SK_ARRAY)
+        return false;
+      n_keys++;
+    }
+  }
+  return n_keys == descriptor->n_keys;
+}
+
+static idl_retcode_t emit_key_members(struct emitter *e, const struct descriptor *descriptor)
+{
+  idl_retcode_t ret = IDL_RETCODE_OK;
+  const idl_struct_t *_struct = (const idl_struct_t *)descriptor->topic;
+  const idl_member_t *member;
+  const idl_declarator_t *declarator;
+  uint32_t keys_remaining = descriptor->n_keys;
+
+  /* the data has been normalized, so the normalize code only skips the members
+     that are not part of the key, and there is no need to look beyond the last key */
+  IDL_FOREACH(member, _struct->members) {
+    IDL_FOREACH(declarator, member->declarators) {
+      struct sertype st;
+      if (keys_remaining == 0)
+        return IDL_RETCODE_OK;
+      (void) get_sertype(&st, declarator, member->type_spec);
+      if (!find_key(descriptor, idl_identifier(declarator))) {
+        if ((ret = emit_normalize(e, &st, "size")) != IDL_RETCODE_OK)
+          return ret;
+        continue;
+      }
+      if (st.kind == SK_STRING || st.kind == SK_BSTRING)
+        EMIT(e, "dds_cdrstream_gen_copy_string (is, os, allocator);");
+      else
+        EMIT(e, "dds_cdrstream_gen_copy_prim (is, os, allocator, %"PRIu32");", st.size);
+      keys_remaining--;
+    }
+  }
+err:
+  return ret;
+}
+
+static idl_retcode_t emit_extract_key_function(FILE *fp, const struct descriptor *descriptor, const char *type)
+{
+  idl_retcode_t ret;
+  struct emitter e = { NULL, 1, 0, 0 };
+
+  if ((ret = emit_key_members(&e, descriptor)) != IDL_RETCODE_OK)
+    return ret;
+  const uint32_t uses = e.uses;
+  e.fp = fp;
+  e.var = 0;
+  if (idl_fprintf(fp, "static bool %s_gen_extract_key_from_data (dds_istream_t *is, dds_ostream_t *os, const struct dds_cdrstream_allocator *allocator)\n{\n", type) < 0)
+    return IDL_RETCODE_NO_MEMORY;
+  if (uses & USES_NORMALIZE) {
+    EMIT(&e, "char * const data = (char *) is->m_buffer;");
+    EMIT(&e, "uint32_t * const off = &is->m_index;");
+    EMIT(&e, "const uint32_t size = is->m_size;");
+  }
+  if (uses & USES_BSWAP)
+    EMIT(&e, "const bool bswap = false;");
+  if (uses & USES_XCDR_VERSION)
+    EMIT(&e, "const uint32_t xcdr_version = is->m_xcdr_version;");
+  if ((ret = emit_key_members(&e, descriptor)) != IDL_RETCODE_OK)
+    return ret;
+  EMIT(&e, "return true;");
+  if (fputs("}\n\n", fp) < 0)
+    return IDL_RETCODE_NO_MEMORY;
+err:
+  return ret;
+}
+
+idl_retcode_t generate_serializers(const idl_pstate_t *pstate, struct generator *generator, const struct descriptor *descriptor, bool *generated)
+{
+  idl_retcode_t ret;
+  FILE *fp = generator->source.handle;
+  char *type;
+  const char *fmt;
+
+  (void) pstate;
+  *generated = false;
+  if (!idl_is_struct(descriptor->topic) || !supported_struct(descriptor->topic, NULL))
+    return IDL_RETCODE_OK;
+  if ((ret = emit_struct_functions(generator, descriptor->topic)) != IDL_RETCODE_OK)
+    return ret;
+
+  if (IDL_PRINT(&type, print_type, descriptor->topic) < 0)
+    return IDL_RETCODE_NO_MEMORY;
+  const bool keys = supported_keys(descriptor);
+  if (keys && (ret = emit_extract_key_function(fp, descriptor, type)) != IDL_RETCODE_OK)
+    goto err;
+  fmt = "static const struct dds_cdrstream_gen_ops %1$s_gen_ops =\n{\n"
+        "  .write = %1$s_gen_write,\n"
+        "  .read = %1$s_gen_read,\n"
+        "  .normalize = %1$s_gen_normalize,\n";
+  if (idl_fprintf(fp, fmt, type) < 0)
+    { ret = IDL_RETCODE_NO_MEMORY; goto err; }
+  if (keys)
+    ret = (idl_fprintf(fp, "  .extract_key_from_data = %s_gen_extract_key_from_data\n};\n\n", type) < 0) ? IDL_RETCODE_NO_MEMORY : IDL_RETCODE_OK;
+  else
+    ret = (fputs("  .extract_key_from_data = NULL\n};\n\n", fp) < 0) ? IDL_RETCODE_NO_MEMORY : IDL_RETCODE_OK;
+  if (ret != IDL_RETCODE_OK)
+    goto err;
+  *generated = true;
+err:
+  idl_free(type);
+  return ret;
+}
@@ -0,0 +1,27 @@
+// Copyright(c) 2025 ZettaScale Technology and others
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License v. 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Eclipse Distribution License
+// v. 1.0 which is available at
+// http://www.eclipse.org/org/documents/edl-v10.php.
+//
+// SPDX-License-Identifier: EPL-2.0 OR BSD-3-Clause
+
+#ifndef SERIALIZERS_H
+#define SERIALIZERS_H
+
+#include <stdbool.h>
+
+#include "idl/processor.h"
+
+struct generator;
+struct descriptor;
+
+/* Generates type-specialised write, read, normalize and (if possible) key extraction
+   functions for the topic in the descriptor, plus those of all structs it depends on
+   that have not been generated before. Sets *generated to false without generating
+   anything if the topic type isn't supported, in which case the interpreter is used. */
+idl_retcode_t generate_serializers(const idl_pstate_t *pstate, struct generator *generator, const struct descriptor *descriptor, bool *generated);
+
+#endif /* SERIALIZERS_H */